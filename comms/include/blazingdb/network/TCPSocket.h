@@ -1,4 +1,6 @@
 #pragma once
+#include <algorithm>
+#include <atomic>
 #include <cstring>
 #include <functional>
 #include <iostream>
@@ -6,6 +8,7 @@
 #include <stdexcept>
 #include <string>
 #include <thread>
+#include <vector>
 #include "blazingdb/transport/common/macros.hpp"
 #include "blazingdb/transport/io/fd_reader_writer.h"
 
@@ -14,16 +17,29 @@
 namespace blazingdb {
 namespace network {
 
+/// \brief Multi-connection ZMQ server
+///
+/// A ROUTER socket accepts the REQ clients and a DEALER socket spreads their
+/// requests over num_workers REP sockets, one per worker thread. Every worker
+/// runs the handler, so several inbound messages are received and
+/// deserialized at the same time. A REQ client only has one request in
+/// flight, so the messages of one sender keep their order.
 class TCPServerSocket {
 public:
-  TCPServerSocket(int tcp_port) : context(1) {
+  TCPServerSocket(int tcp_port, int num_workers = 1)
+      : context(1),
+        num_workers{std::max(1, num_workers)},
+        workers_address{"inproc://blazingdb-server-workers-" +
+                        std::to_string(tcp_port)} {
     try {
-      socket = zmq::socket_t(context, ZMQ_REP);
+      frontend = zmq::socket_t(context, ZMQ_ROUTER);
+      backend = zmq::socket_t(context, ZMQ_DEALER);
       auto connection = "tcp://*:" + std::to_string(tcp_port);
       // std::cout << "listening: " << connection << std::endl;
       int linger = -1;
-      socket.setsockopt(ZMQ_LINGER, &linger, sizeof(linger));
-      socket.bind(connection);
+      frontend.setsockopt(ZMQ_LINGER, &linger, sizeof(linger));
+      frontend.bind(connection);
+      backend.bind(workers_address);
 
     } catch (std::exception &e) {
       std::cerr << e.what() << std::endl;
@@ -31,29 +47,47 @@ public:
   }
 
   void run(std::function<void(void *)> handler) {
-    while (context) {
-      if (socket.connected()) {
-        handler((void *)&socket);
+    std::vector<std::thread> workers;
+    for (int worker = 0; worker < num_workers; worker++) {
+      workers.emplace_back([this, handler]() {
+        try {
+          zmq::socket_t socket(context, ZMQ_REP);
+          int linger = 0;
+          socket.setsockopt(ZMQ_LINGER, &linger, sizeof(linger));
+          socket.connect(workers_address);
+          while (running) {
+            handler((void *)&socket);
+          }
+        } catch (std::exception &e) {
+          // the context was shut down
+        }
+      });
+    }
 
-        //        uint64_t more_part;
-        //        size_t more_size = sizeof(more_part);
-        //
-        //        socket.getsockopt(ZMQ_RCVMORE, &more_part, &more_size);
+    // returns when close() shuts the context down
+    zmq_proxy(static_cast<void *>(frontend), static_cast<void *>(backend),
+              nullptr);
 
-      } else {
-        break;
-      }
+    running = false;
+    for (auto &worker : workers) {
+      worker.join();
     }
+    frontend.close();
+    backend.close();
   }
+
   void close() {
-    socket.close();
-    context.close();
+    running = false;
+    zmq_ctx_shutdown(static_cast<void *>(context));
   }
 
 private:
   zmq::context_t context;
-  zmq::socket_t socket;
-  std::function<void(int)> handler;
+  zmq::socket_t frontend;
+  zmq::socket_t backend;
+  const int num_workers;
+  const std::string workers_address;
+  std::atomic<bool> running{true};
 };
 
 class TCPClientSocket {
@@ -0,0 +1,23 @@
+#pragma once
+
+#include <vector>
+
+namespace blazingdb {
+namespace transport {
+
+/// \brief Binomial broadcast tree over num_nodes nodes
+///
+/// Nodes are numbered by their position in a node list every participant
+/// agrees on, and the tree is laid out on the positions relative to the root.
+/// A broadcast reaches every node in ceil(log2(num_nodes)) rounds and no
+/// node, the root included, sends more than that many copies.
+///
+/// Children are returned biggest subtree first, so the copy that has the
+/// most work left behind it leaves first.
+std::vector<int> binomialTreeChildren(int num_nodes, int root, int self);
+
+// -1 for the root
+int binomialTreeParent(int num_nodes, int root, int self);
+
+}  // namespace transport
+}  // namespace blazingdb
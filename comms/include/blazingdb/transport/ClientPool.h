@@ -0,0 +1,141 @@
+#pragma once
+
+#include <chrono>
+#include <condition_variable>
+#include <cstdint>
+#include <deque>
+#include <functional>
+#include <future>
+#include <map>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <vector>
+#include "blazingdb/transport/Status.h"
+
+namespace zmq {
+class context_t;
+class socket_t;
+}  // namespace zmq
+
+namespace blazingdb {
+namespace transport {
+
+/// \brief Process-wide pool of client connections keyed by peer address
+///
+/// All the connections share one zmq context. A connection is lent for one
+/// request/reply exchange and goes back to the pool afterwards, so query
+/// steps and contexts reuse the sockets opened by the previous ones. The pool
+/// also owns the sender threads used by sendAsync, so callers do not start a
+/// thread per destination.
+class ClientPool {
+public:
+  struct Options {
+    // max sends in flight to one peer, further sends wait for a connection
+    int max_sends_per_peer{4};
+    // idle connections kept per peer
+    int max_idle_per_peer{4};
+    // idle connections older than this are closed instead of reused
+    std::chrono::milliseconds max_idle_time{std::chrono::minutes(5)};
+    // zmq heartbeat used to detect dead peers, 0 disables it
+    std::chrono::milliseconds heartbeat_interval{std::chrono::seconds(10)};
+    // a send or a reply that takes longer fails with EAGAIN and the
+    // connection is dropped, 0 waits forever
+    std::chrono::milliseconds send_timeout{std::chrono::minutes(1)};
+    std::chrono::milliseconds receive_timeout{std::chrono::minutes(5)};
+    // threads running the sendAsync tasks
+    int sender_threads{8};
+  };
+
+  struct Stats {
+    std::uint64_t connections_created{};
+    std::uint64_t connections_reused{};
+    std::uint64_t connections_discarded{};
+    std::uint64_t waits{};  // acquisitions blocked by max_sends_per_peer
+  };
+
+  /// \brief A pooled connection, lent for one request/reply exchange
+  class Connection {
+  public:
+    ~Connection();
+
+    void *fd();
+
+    // The exchange failed half way, the socket is closed instead of reused
+    void markBroken() { broken_ = true; }
+
+  private:
+    friend class ClientPool;
+
+    Connection(ClientPool *pool, const std::string &key,
+               std::unique_ptr<zmq::socket_t> socket);
+
+    ClientPool *pool_;
+    std::string key_;
+    std::unique_ptr<zmq::socket_t> socket_;
+    bool broken_{false};
+  };
+
+public:
+  static ClientPool &getInstance();
+
+  ClientPool();
+
+  ~ClientPool();
+
+  ClientPool(const ClientPool &) = delete;
+
+  ClientPool &operator=(const ClientPool &) = delete;
+
+  std::unique_ptr<Connection> acquire(const std::string &ip, int16_t port);
+
+  // Runs send on one of the sender threads of the pool
+  std::future<Status> sendAsync(std::function<Status()> send);
+
+  void setOptions(const Options &options);
+
+  Options options();
+
+  Stats stats();
+
+  // Closes every idle connection
+  void clear();
+
+private:
+  struct IdleSocket {
+    std::unique_ptr<zmq::socket_t> socket;
+    std::chrono::steady_clock::time_point since;
+  };
+
+  struct Peer {
+    std::deque<IdleSocket> idle;
+    int in_flight{0};
+    std::condition_variable condition_variable;
+  };
+
+  std::unique_ptr<zmq::socket_t> createSocket(const std::string &ip,
+                                              int16_t port);
+
+  void release(const std::string &key, std::unique_ptr<zmq::socket_t> socket,
+               bool broken);
+
+  void runSender();
+
+private:
+  std::unique_ptr<zmq::context_t> context_;
+
+  std::mutex mutex_;
+  std::map<std::string, Peer> peers_;
+  Options options_;
+  Stats stats_;
+
+  std::mutex tasks_mutex_;
+  std::condition_variable tasks_condition_variable_;
+  std::deque<std::packaged_task<Status()>> tasks_;
+  std::vector<std::thread> senders_;
+  bool stopping_{false};
+};
+
+}  // namespace transport
+}  // namespace blazingdb
@@ -18,6 +18,7 @@ struct ColumnTransport {
   int strings_data{};
   int strings_offsets{};
   int strings_nullmask{};
+  int32_t codec{};  // io::CodecType of the column buffers
 };
 
 }  // namespace transport
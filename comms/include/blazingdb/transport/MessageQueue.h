@@ -1,19 +1,25 @@
 #pragma once
 
+#include <chrono>
 #include <condition_variable>
+#include <deque>
 #include <mutex>
 #include <string>
-#include <vector>
+#include <unordered_map>
 #include "blazingdb/transport/Message.h"
 
 namespace blazingdb {
 namespace transport {
 
+/// \brief Messages received for one context, indexed by message token
+///
+/// Each token has its own FIFO and its own condition variable, so a
+/// putMessage only wakes the callers waiting for that token.
 class MessageQueue {
 public:
   MessageQueue() = default;
 
-  ~MessageQueue() = default;
+  ~MessageQueue();
 
   MessageQueue(MessageQueue&&) = delete;
 
@@ -26,17 +32,34 @@ public:
 public:
   std::shared_ptr<GPUMessage> getMessage(const std::string& messageToken);
 
+  /**
+   * Same as getMessage but gives up after timeout.
+   *
+   * @return  the message or nullptr when the timeout expires.
+   */
+  std::shared_ptr<GPUMessage> getMessage(const std::string& messageToken,
+                                         std::chrono::milliseconds timeout);
+
   void putMessage(std::shared_ptr<GPUMessage>& message);
 
+  std::size_t size();
+
 private:
-  std::shared_ptr<GPUMessage> getMessageQueue(const std::string& messageToken);
+  struct TokenQueue {
+    std::deque<std::shared_ptr<GPUMessage>> messages;
+    std::condition_variable condition_variable;
+    std::size_t waiters{0};
+  };
+
+  std::shared_ptr<GPUMessage> getMessageQueue(TokenQueue& token_queue,
+                                              const std::string& messageToken);
 
   void putMessageQueue(std::shared_ptr<GPUMessage>& message);
 
 private:
   std::mutex mutex_;
-  std::vector<std::shared_ptr<GPUMessage>> message_queue_;
-  std::condition_variable condition_variable_;
+  std::unordered_map<std::string, TokenQueue> message_queue_;
+  std::size_t size_{0};
 };
 
 }  // namespace transport
@@ -1,5 +1,6 @@
 #pragma once
 
+#include <chrono>
 #include <functional>
 #include <map>
 #include <memory>
@@ -91,6 +92,17 @@ public:
   virtual std::shared_ptr<GPUMessage> getMessage(
       const uint32_t context_token, const std::string &messageToken);
 
+  /**
+   * Same as getMessage but waits at most 'timeout' for the message.
+   *
+   * @param context_token  identifier for the message queue using ContextToken.
+   * @param timeout        max time to wait for the message.
+   * @return               the message or nullptr when the timeout expires.
+   */
+  virtual std::shared_ptr<GPUMessage> getMessage(
+      const uint32_t context_token, const std::string &messageToken,
+      std::chrono::milliseconds timeout);
+
   /**
    * It stores the message in the message queue and it uses the ContextToken to
    * select the queue. Each message queue works independently. Whether multiple
@@ -135,9 +147,12 @@ public:
   /**
    * Static function that creates a TCP server.
    *
+   * @param port         the port for the server.
+   * @param num_workers  number of messages received and deserialized
+   *                     concurrently.
    * @return  unique pointer of the TCP server.
    */
-  static std::unique_ptr<Server> TCP(unsigned short port);
+  static std::unique_ptr<Server> TCP(unsigned short port, int num_workers = 4);
 };
 
 }  // namespace transport
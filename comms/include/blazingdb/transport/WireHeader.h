@@ -0,0 +1,54 @@
+#pragma once
+
+#include <cstdint>
+#include <stdexcept>
+#include <string>
+#include <vector>
+#include "blazingdb/transport/Address.h"
+#include "blazingdb/transport/ColumnTransport.h"
+#include "blazingdb/transport/Message.h"
+
+namespace blazingdb {
+namespace transport {
+
+/// \brief Everything the server needs before the column buffers arrive
+struct MessageHeader {
+  Message::MetaData message;
+  Address::MetaData address;
+  std::vector<ColumnTransport> columns;
+  std::vector<int> buffer_sizes;
+};
+
+/// \brief Compact, versioned encoding of the MessageHeader
+///
+/// Layout: magic byte, version byte, a list of fields and a CRC-32C of
+/// everything before it (4 bytes, little endian). Each field starts with a
+/// varint key (tag << 1 | kind): kind 0 is followed by a varint value, kind 1
+/// by a varint length and that many bytes. Signed values are zigzag encoded,
+/// strings are sent without padding and columns are nested field lists.
+///
+/// Receivers skip the tags they do not know, so new fields can be added
+/// without bumping the version and mixed-version clusters keep working.
+/// kWireVersion only changes when a field changes meaning, and receivers
+/// reject headers newer than the version they implement.
+namespace wire {
+
+constexpr uint8_t kMagic = 0xB2;
+constexpr uint8_t kWireVersion = 1;
+
+class HeaderError : public std::runtime_error {
+public:
+  using std::runtime_error::runtime_error;
+};
+
+std::string encodeMessageHeader(const MessageHeader &header);
+
+// Throws HeaderError when the header is truncated, corrupt, from a newer
+// version or holds strings that do not fit the metadata structs
+MessageHeader decodeMessageHeader(const char *data, std::size_t size);
+
+uint32_t crc32c(const char *data, std::size_t size);
+
+}  // namespace wire
+}  // namespace transport
+}  // namespace blazingdb
@@ -0,0 +1,81 @@
+#pragma once
+#include <cstdint>
+#include <functional>
+#include <vector>
+#include "blazingdb/transport/io/codec.h"
+#include "blazingdb/transport/io/pinned_buffer_provider.h"
+
+namespace blazingdb {
+namespace transport {
+namespace io {
+
+/// \brief Header frame sent in front of every chunk payload frame
+///
+/// Chunks are written in the order their copies complete, the header tells
+/// the receiver where each one goes. size is the decoded size, the payload
+/// frame is smaller when the chunk is compressed.
+struct ChunkHeader {
+  int32_t buffer_index{};
+  int32_t codec{};  // CodecType of the payload
+  int64_t offset{};
+  int64_t size{};
+};
+
+// Copies size bytes from src to dst, e.g. device to host or host to host
+using copy_function =
+    std::function<void(char *dst, const char *src, std::size_t size)>;
+
+struct ChunkedTransferOptions {
+  // tasks staging chunks through the pinned buffers, run by the copy threads
+  // shared by the whole process
+  std::size_t copy_threads{4};
+  // chunks each copy thread can get ahead of the socket
+  std::size_t ring_capacity{4};
+  // 0 means the buffer size of the provider
+  std::size_t chunk_size{0};
+  // codec of every buffer, missing entries are not compressed
+  std::vector<BufferCodec> codecs;
+  // see CompressionOptions
+  bool adaptive{true};
+  double max_ratio{0.9};
+  // host memory for the chunks staged outside the provider, shared by all the
+  // transfers of the process. See writeBuffersChunked
+  std::size_t max_host_staging_bytes{std::size_t{256} << 20};
+};
+
+/// Sends the buffers as header/payload frame pairs, all of them with
+/// ZMQ_SNDMORE. The copy threads stage the chunks through the provider while
+/// the calling thread writes the staged chunks to the socket. The copy threads
+/// also compress the chunks with the codec of their buffer.
+///
+/// The payload frames borrow their staging buffer, which zmq returns to the
+/// provider once the message is sent, i.e. after the caller wrote its last
+/// frame. The provider must outlive it. Chunks are staged in memory of their
+/// own rather than waiting for a staging buffer to come back.
+///
+/// Once max_host_staging_bytes of that memory is lent, a transfer that has not
+/// staged any waits until other messages are sent and give theirs back. A
+/// transfer that already staged some can not wait, its own frames are only
+/// sent after it returns, so it goes over the limit to complete.
+void writeBuffersChunked(const std::vector<int> &bufferSizes,
+                         const std::vector<char *> &buffers,
+                         void *fileDescriptor, PinnedBufferProvider &provider,
+                         const copy_function &copy,
+                         const ChunkedTransferOptions &options = {});
+
+/// Receives the frames sent by writeBuffersChunked into destinations. The
+/// calling thread reads the socket into staging buffers while the copy threads
+/// decompress and move them to their destination. Throws on malformed
+/// headers or corrupt chunks.
+void readBuffersChunked(const std::vector<int> &bufferSizes,
+                        const std::vector<char *> &destinations,
+                        void *fileDescriptor, PinnedBufferProvider &provider,
+                        const copy_function &copy,
+                        const ChunkedTransferOptions &options = {});
+
+// Host staging memory currently lent to zmq by writeBuffersChunked
+std::size_t hostStagingBytesInUse();
+
+}  // namespace io
+}  // namespace transport
+}  // namespace blazingdb
@@ -0,0 +1,79 @@
+#pragma once
+#include <cstddef>
+#include <cstdint>
+#include <string>
+#include <vector>
+#include "blazingdb/transport/ColumnTransport.h"
+
+namespace blazingdb {
+namespace transport {
+namespace io {
+
+// Values travel on the wire (ColumnTransport::codec and ChunkHeader::codec)
+enum class CodecType : int32_t {
+  none = 0,
+  lz4 = 1,
+  zstd = 2,
+  rle = 3,  // run-length + frame-of-reference bit-packing of integers
+};
+
+/// \brief Compression stage applied to every chunk of a buffer
+///
+/// Codecs are stateless, the same instance is used by all copy threads.
+class Codec {
+public:
+  virtual ~Codec() = default;
+
+  virtual CodecType type() const = 0;
+
+  /// Encodes size bytes of src into dst. elementSize is the width of the
+  /// values in src, only used by integer codecs. Returns 0 when the encoded
+  /// chunk does not fit in capacity bytes.
+  virtual std::size_t encode(const char *src, std::size_t size, char *dst,
+                             std::size_t capacity, int elementSize) const = 0;
+
+  /// Decodes encodedSize bytes of src into exactly size bytes of dst. Throws
+  /// std::runtime_error on corrupt input.
+  virtual void decode(const char *src, std::size_t encodedSize, char *dst,
+                      std::size_t size) const = 0;
+};
+
+// Throws std::runtime_error for an unknown codec type
+const Codec &getCodec(CodecType type);
+
+struct BufferCodec {
+  CodecType type{CodecType::none};
+  int elementSize{1};
+};
+
+struct CompressionOptions {
+  // codec for the string columns, and for every column when bitpackFixedWidth
+  // is off. CodecType::none together with bitpackFixedWidth off disables
+  // compression.
+  CodecType codec{CodecType::none};
+  // fixed width columns use CodecType::rle
+  bool bitpackFixedWidth{false};
+  // chunks that do not shrink below maxRatio of their size travel raw and the
+  // rest of their buffer is not compressed
+  bool adaptive{true};
+  double maxRatio{0.9};
+};
+
+// "none", "lz4", "zstd", "rle" (fixed width columns only) or "auto" (rle for
+// the fixed width columns, lz4 for the strings). Throws std::invalid_argument
+// for anything else.
+CompressionOptions compressionOptionsFromString(const std::string &name);
+
+// Sets ColumnTransport::codec of every column following the options
+void assignCodecs(std::vector<ColumnTransport> &columns,
+                  const CompressionOptions &options);
+
+// Codec of every buffer referenced by columns, using the element width of
+// the data buffers for the integer codecs
+std::vector<BufferCodec> bufferCodecs(
+    const std::vector<ColumnTransport> &columns,
+    const std::vector<int> &bufferSizes);
+
+}  // namespace io
+}  // namespace transport
+}  // namespace blazingdb
@@ -12,10 +12,30 @@ namespace io {
 constexpr size_t NUMBER_RETRIES = 20;
 constexpr size_t FILE_RETRY_DELAY = 20;
 
+// Called by the transport once a buffer lent to writeToSocketZeroCopy is no
+// longer needed. Same signature as zmq_free_fn.
+using release_function = void (*)(void* data, void* hint);
+
+// Receives one frame directly into buf. Throws when the frame length is not
+// exactly nbyte.
 size_t readFromSocket(void* fileDescriptor, char* buf, size_t nbyte);
+
+// Sends nbyte bytes of buf as one frame. buf is copied, so it can be reused as
+// soon as the call returns.
 size_t writeToSocket(void* fileDescriptor, char* buf, size_t nbyte,
                      bool more = true);
 
+// Sends nbyte bytes of buf as one frame without copying it. buf must stay
+// valid until release(buf, hint) is called, possibly from a zmq I/O thread.
+// Frames of a multipart message are only flushed once its last frame is sent,
+// so buf stays borrowed at least until then.
+size_t writeToSocketZeroCopy(void* fileDescriptor, char* buf, size_t nbyte,
+                             release_function release, void* hint,
+                             bool more = true);
+
+// Drops the remaining frames of a partially read multipart message
+void discardPendingFrames(void* fileDescriptor);
+
 }  // namespace io
 }  // namespace transport
 }  // namespace blazingdb
@@ -0,0 +1,108 @@
+#pragma once
+#include <condition_variable>
+#include <cstdint>
+#include <deque>
+#include <memory>
+#include <mutex>
+#include <stack>
+
+namespace blazingdb {
+namespace transport {
+namespace io {
+
+struct PinnedBuffer {
+  std::size_t size;
+  char *data;
+};
+
+/// \brief Host memory backend used by the PinnedBufferProvider
+///
+/// The transport stages through CUDA memory (see makeCudaHostAllocator in
+/// reader_writer.h). Tests and benchmarks can plug in plain malloc so the pool
+/// runs on machines without a GPU.
+class HostAllocator {
+public:
+  virtual ~HostAllocator() = default;
+
+  virtual char *allocate(std::size_t size) = 0;
+
+  virtual void deallocate(char *data) = 0;
+};
+
+std::shared_ptr<HostAllocator> makeMallocHostAllocator();
+
+struct PinnedBufferProviderStats {
+  std::size_t bufferSize{};
+  std::size_t highWaterMark{};
+  std::size_t allocated{};  // buffers currently owned by the pool
+  std::size_t inUse{};      // buffers currently lent to callers
+  std::size_t peakInUse{};
+  std::size_t waiting{};  // callers currently blocked in getBuffer
+  std::uint64_t acquisitions{};
+  std::uint64_t waits{};  // acquisitions that had to block
+  std::uint64_t totalWaitNanos{};
+  std::uint64_t maxWaitNanos{};
+};
+
+/// \brief Bounded, long-lived pool of staging buffers
+///
+/// The pool starts with numBuffers buffers and grows lazily up to
+/// highWaterMark buffers. Once the high-water mark is reached getBuffer blocks
+/// until a buffer is returned. Blocked callers are served in arrival order.
+class PinnedBufferProvider {
+public:
+  /// @param highWaterMark  max buffers owned by the pool, 0 means numBuffers
+  PinnedBufferProvider(std::size_t sizeBuffers, std::size_t numBuffers,
+                       std::size_t highWaterMark,
+                       std::shared_ptr<HostAllocator> allocator);
+
+  ~PinnedBufferProvider();
+
+  PinnedBufferProvider(const PinnedBufferProvider &) = delete;
+
+  PinnedBufferProvider &operator=(const PinnedBufferProvider &) = delete;
+
+  PinnedBuffer *getBuffer();
+
+  // Same as getBuffer but returns nullptr instead of blocking, when every
+  // buffer is lent or other callers are already waiting for one
+  PinnedBuffer *tryGetBuffer();
+
+  void freeBuffer(PinnedBuffer *buffer);
+
+  std::size_t sizeBuffers();
+
+  std::size_t highWaterMark();
+
+  // Releases the idle buffers. Buffers still in use are kept and will be
+  // reused when they are returned.
+  void freeAll();
+
+  PinnedBufferProviderStats stats();
+
+private:
+  void grow();
+
+  PinnedBuffer *take();
+
+  void notifyNextWaiter();
+
+  std::mutex inUseMutex;
+
+  std::stack<PinnedBuffer *> buffers;
+
+  std::size_t bufferSize;
+
+  std::size_t maxBuffers;
+
+  std::shared_ptr<HostAllocator> allocator;
+
+  // blocked callers, served in arrival order
+  std::deque<std::condition_variable *> waiters;
+
+  PinnedBufferProviderStats counters;
+};
+
+}  // namespace io
+}  // namespace transport
+}  // namespace blazingdb
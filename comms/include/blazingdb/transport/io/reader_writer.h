@@ -4,47 +4,32 @@
 #include <stack>
 #include <vector>
 #include "blazingdb/transport/ColumnTransport.h"
+#include "blazingdb/transport/io/codec.h"
+#include "blazingdb/transport/io/pinned_buffer_provider.h"
 
 namespace blazingdb {
 namespace transport {
 namespace io {
 
-struct PinnedBuffer {
-  std::size_t size;
-  char *data;
-};
+// CUDA managed memory, used by the global provider
+std::shared_ptr<HostAllocator> makeCudaHostAllocator();
 
-class PinnedBufferProvider {
-public:
-  PinnedBufferProvider(std::size_t sizeBuffers, std::size_t numBuffers);
-
-  PinnedBuffer *getBuffer();
-
-  void freeBuffer(PinnedBuffer *buffer);
-
-  std::size_t sizeBuffers();
-
-  void freeAll();
-
-private:
-  void grow();
-
-  std::condition_variable cv;
-
-  std::mutex inUseMutex;
-
-  std::stack<PinnedBuffer *> buffers;
-
-  std::size_t bufferSize;
-};
 // Memory Pool
 PinnedBufferProvider &getPinnedBufferProvider();
 
-void setPinnedBufferProvider(std::size_t sizeBuffers, std::size_t numBuffers);
+// highWaterMark bounds how many buffers the pool may own, 0 means numBuffers
+void setPinnedBufferProvider(std::size_t sizeBuffers, std::size_t numBuffers,
+                             std::size_t highWaterMark = 0);
+
+// Compression of the column buffers sent from now on, none by default
+void setCompressionOptions(const CompressionOptions &options);
+
+CompressionOptions getCompressionOptions();
 
 std::vector<char *> readBuffersIntoGPUTCP(std::vector<int> bufferSizes,
                                           void *fileDescriptor, int gpuNum);
 
+// column_transport tells the codec of every buffer, see assignCodecs
 void writeBuffersFromGPUTCP(std::vector<ColumnTransport> &column_transport,
                             std::vector<int> bufferSizes,
                             std::vector<char *> buffers, void *fileDescriptor,
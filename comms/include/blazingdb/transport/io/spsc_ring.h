@@ -0,0 +1,68 @@
+#pragma once
+#include <atomic>
+#include <cstddef>
+#include <utility>
+#include <vector>
+
+namespace blazingdb {
+namespace transport {
+namespace io {
+
+/// \brief Bounded lock-free single-producer/single-consumer ring
+///
+/// try_push must only be called from one thread and try_pop from one other
+/// thread. Both return false instead of blocking, the caller decides how to
+/// wait.
+template <typename T>
+class SpscRing {
+public:
+  explicit SpscRing(std::size_t capacity) : slots_(capacity + 1) {}
+
+  SpscRing(const SpscRing &) = delete;
+
+  SpscRing &operator=(const SpscRing &) = delete;
+
+  // value is only moved from when the push succeeds
+  bool try_push(T &value) {
+    const std::size_t tail = tail_.load(std::memory_order_relaxed);
+    const std::size_t next = increment(tail);
+    if (next == head_.load(std::memory_order_acquire)) {
+      return false;
+    }
+    slots_[tail] = std::move(value);
+    tail_.store(next, std::memory_order_release);
+    return true;
+  }
+
+  bool try_pop(T &value) {
+    const std::size_t head = head_.load(std::memory_order_relaxed);
+    if (head == tail_.load(std::memory_order_acquire)) {
+      return false;
+    }
+    value = std::move(slots_[head]);
+    head_.store(increment(head), std::memory_order_release);
+    return true;
+  }
+
+  bool empty() const {
+    return head_.load(std::memory_order_acquire) ==
+           tail_.load(std::memory_order_acquire);
+  }
+
+  std::size_t capacity() const { return slots_.size() - 1; }
+
+private:
+  std::size_t increment(std::size_t index) const {
+    return index + 1 == slots_.size() ? 0 : index + 1;
+  }
+
+  std::vector<T> slots_;
+  // producer and consumer indexes live on different cache lines
+  std::atomic<std::size_t> head_{0};
+  char padding_[64 - sizeof(std::atomic<std::size_t>)];
+  std::atomic<std::size_t> tail_{0};
+};
+
+}  // namespace io
+}  // namespace transport
+}  // namespace blazingdb
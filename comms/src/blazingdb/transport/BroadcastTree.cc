@@ -0,0 +1,52 @@
+#include "blazingdb/transport/BroadcastTree.h"
+
+#include <stdexcept>
+#include <string>
+
+namespace blazingdb {
+namespace transport {
+
+namespace {
+
+// position of self in the tree, where the root is 0
+int relativeRank(int num_nodes, int root, int self) {
+  if (num_nodes <= 0 || root < 0 || root >= num_nodes || self < 0 ||
+      self >= num_nodes) {
+    throw std::out_of_range("broadcast tree: node " + std::to_string(self) +
+                            " or root " + std::to_string(root) +
+                            " out of " + std::to_string(num_nodes));
+  }
+  return (self - root + num_nodes) % num_nodes;
+}
+
+}  // namespace
+
+std::vector<int> binomialTreeChildren(int num_nodes, int root, int self) {
+  const int rank = relativeRank(num_nodes, root, self);
+
+  // rank r owns the ranks [r, r + 2^k) where 2^k is its lowest set bit (all
+  // of them for the root) and hands [r + 2^j, r + 2^(j+1)) to child r + 2^j
+  int span = 1;
+  while (span < num_nodes && (rank & span) == 0) {
+    span <<= 1;
+  }
+  std::vector<int> children;
+  for (int step = span >> 1; step > 0; step >>= 1) {
+    if (rank + step < num_nodes) {
+      children.push_back((rank + step + root) % num_nodes);
+    }
+  }
+  return children;
+}
+
+int binomialTreeParent(int num_nodes, int root, int self) {
+  const int rank = relativeRank(num_nodes, root, self);
+  if (rank == 0) {
+    return -1;
+  }
+  const int parent = rank & (rank - 1);  // clear the lowest set bit
+  return (parent + root) % num_nodes;
+}
+
+}  // namespace transport
+}  // namespace blazingdb
@@ -1,15 +1,43 @@
 #include "blazingdb/transport/Client.h"
+#include <blazingdb/io/Library/Metrics/MetricsRegistry.h>
 #include <cuda_runtime_api.h>
+#include <cerrno>
 #include <map>
 #include <numeric>
+#include <stdexcept>
 #include "blazingdb/network/TCPSocket.h"
+#include "blazingdb/transport/ClientPool.h"
 #include "blazingdb/transport/ColumnTransport.h"
 #include "blazingdb/transport/Status.h"
+#include "blazingdb/transport/WireHeader.h"
 #include "blazingdb/transport/io/reader_writer.h"
 
 namespace blazingdb {
 namespace transport {
 
+namespace {
+
+struct SendMetrics {
+  Library::Metrics::Counter& messages;
+  Library::Metrics::Counter& bytes;
+  Library::Metrics::Histogram& latency;
+};
+
+SendMetrics& sendMetrics() {
+  auto& registry = Library::Metrics::MetricsRegistry::getInstance();
+  static SendMetrics metrics{
+      registry.counter("blazing_shuffle_sent_messages_total",
+                       "Messages sent to other nodes"),
+      registry.counter(
+          "blazing_shuffle_sent_bytes_total",
+          "Bytes of the messages sent to other nodes, before compression"),
+      registry.histogram("blazing_shuffle_send_duration_seconds",
+                         "Time to send a message until its reply", {}, 1e-6)};
+  return metrics;
+}
+
+}  // namespace
+
 class Client::SendError : public std::exception {
 public:
   SendError(const std::string& original, const std::string& endpoint,
@@ -30,48 +58,64 @@ private:
   const std::string message_;
 };
 
-template <typename MetadataType>
-void write_metadata(void* file_descriptor, const MetadataType& metadata) {
-  blazingdb::transport::io::writeToSocket(file_descriptor, (char*)&metadata,
-                                          sizeof(MetadataType));
-}
-
 class ConcreteClientTCP : public ClientTCP {
 public:
   ConcreteClientTCP(const std::string& ip, int16_t port)
-      : client_socket{ip, port} {}
-  void Close() override { client_socket.close(); }
+      : ip_{ip}, port_{port} {}
+
+  // the connections belong to the ClientPool, there is nothing to close here
+  void Close() override {}
 
   void SetDevice(int gpuId) override { this->gpuId = gpuId; }
 
   Status Send(GPUMessage& message) override {
-    void* fd = client_socket.fd();
-    auto node = message.getSenderNode();
-    auto message_metadata = message.metadata();
+    auto connection = ClientPool::getInstance().acquire(ip_, port_);
+    try {
+      return SendMessage(connection->fd(), message);
+    } catch (const zmq::error_t& e) {
+      connection->markBroken();
+      if (e.num() == EAGAIN) {
+        throw std::runtime_error(
+            "transport::Client: " + ip_ + ":" + std::to_string(port_) +
+            " did not take the message or reply within the ClientPool "
+            "timeouts");
+      }
+      throw;
+    } catch (...) {
+      // a REQ socket that did not get its reply can not be used again
+      connection->markBroken();
+      throw;
+    }
+  }
 
-    // send message metadata
-    write_metadata(fd, message_metadata);
-    // send address metadata
-    write_metadata(fd, node->address()->metadata());
+protected:
+  Status SendMessage(void* fd, GPUMessage& message) {
+    SendMetrics& metrics = sendMetrics();
+    Library::Metrics::ScopedTimer timer(metrics.latency);
+    auto node = message.getSenderNode();
 
-    // send message content (gpu buffers)
-    std::vector<int> buffer_sizes;
     std::vector<char*> buffers;
-    std::vector<ColumnTransport> column_offsets;
-    std::tie(buffer_sizes, buffers, column_offsets) = message.GetRawColumns();
-
-    write_metadata(fd, (int32_t)column_offsets.size());
-    blazingdb::transport::io::writeToSocket(
-        fd, (char*)column_offsets.data(),
-        sizeof(ColumnTransport) * column_offsets.size());
-
-    write_metadata(fd, (int32_t)buffer_sizes.size());
-    blazingdb::transport::io::writeToSocket(fd, (char*)buffer_sizes.data(),
-                                            sizeof(int) * buffer_sizes.size());
+    MessageHeader header;
+    header.message = message.metadata();
+    header.address = node->address()->metadata();
+    std::tie(header.buffer_sizes, buffers, header.columns) =
+        message.GetRawColumns();
+    blazingdb::transport::io::assignCodecs(
+        header.columns, blazingdb::transport::io::getCompressionOptions());
+
+    // send message metadata, address metadata and column layout in one frame
+    std::string encoded_header = wire::encodeMessageHeader(header);
+    blazingdb::transport::io::writeToSocket(fd, &encoded_header[0],
+                                            encoded_header.size());
 
+    // send message content (gpu buffers)
     blazingdb::transport::io::writeBuffersFromGPUTCP(
-        column_offsets, buffer_sizes, buffers, fd, gpuId);
+        header.columns, header.buffer_sizes, buffers, fd, gpuId);
     blazingdb::transport::io::writeToSocket(fd, "OK", 2, false);
+    metrics.messages.increment();
+    metrics.bytes.increment(std::accumulate(header.buffer_sizes.begin(),
+                                            header.buffer_sizes.end(),
+                                            encoded_header.size()));
 
     zmq::socket_t* socket_ptr = (zmq::socket_t*)fd;
 
@@ -85,19 +129,19 @@ public:
     // receive the ok
     zmq::message_t local_message;
     auto success = socket_ptr->recv(local_message);
-    if (success.value() == false || local_message.size() == 0) {
+    // an empty result means ZMQ_RCVTIMEO expired, errno is EAGAIN
+    if (!success || local_message.size() == 0) {
       std::cerr << "Client:   throw zmq::error_t()" << std::endl;
       throw zmq::error_t();
     }
 
     std::string end_message(static_cast<char*>(local_message.data()),
                             local_message.size());
-    assert(end_message == "END");
-    return Status{true};
+    return Status{end_message == "END"};
   }
 
-protected:
-  blazingdb::network::TCPClientSocket client_socket;
+  const std::string ip_;
+  const int16_t port_;
   int gpuId{0};
 };
 
@@ -0,0 +1,206 @@
+#include "blazingdb/transport/ClientPool.h"
+
+#include <algorithm>
+#include <zmq.hpp>
+
+namespace blazingdb {
+namespace transport {
+
+namespace {
+
+// zmq recommends one I/O thread per gigabyte per second of traffic
+constexpr int CLIENT_POOL_IO_THREADS = 4;
+
+// zmq takes -1 for no timeout
+int timeoutOption(std::chrono::milliseconds timeout) {
+  return timeout.count() > 0 ? static_cast<int>(timeout.count()) : -1;
+}
+
+}  // namespace
+
+ClientPool::Connection::Connection(ClientPool *pool, const std::string &key,
+                                   std::unique_ptr<zmq::socket_t> socket)
+    : pool_{pool}, key_{key}, socket_{std::move(socket)} {}
+
+ClientPool::Connection::~Connection() {
+  pool_->release(key_, std::move(socket_), broken_);
+}
+
+void *ClientPool::Connection::fd() { return (void *)socket_.get(); }
+
+ClientPool &ClientPool::getInstance() {
+  static ClientPool instance;
+  return instance;
+}
+
+ClientPool::ClientPool()
+    : context_{new zmq::context_t(CLIENT_POOL_IO_THREADS)} {}
+
+ClientPool::~ClientPool() {
+  {
+    std::unique_lock<std::mutex> lock(tasks_mutex_);
+    stopping_ = true;
+  }
+  tasks_condition_variable_.notify_all();
+  for (auto &sender : senders_) {
+    sender.join();
+  }
+  // sockets must be closed before the context is terminated
+  clear();
+}
+
+std::unique_ptr<ClientPool::Connection> ClientPool::acquire(
+    const std::string &ip, int16_t port) {
+  const std::string key = ip + ":" + std::to_string(port);
+
+  std::unique_lock<std::mutex> lock(mutex_);
+  Peer &peer = peers_[key];
+  auto has_room = [this, &peer] {
+    return peer.in_flight < options_.max_sends_per_peer;
+  };
+  if (!has_room()) {
+    stats_.waits++;
+    peer.condition_variable.wait(lock, has_room);
+  }
+  peer.in_flight++;
+
+  // health check: drop the connections that were idle for too long, the peer
+  // may have been restarted in the meantime
+  const auto now = std::chrono::steady_clock::now();
+  while (!peer.idle.empty() &&
+         now - peer.idle.front().since > options_.max_idle_time) {
+    peer.idle.pop_front();
+    stats_.connections_discarded++;
+  }
+
+  std::unique_ptr<zmq::socket_t> socket;
+  if (!peer.idle.empty()) {
+    socket = std::move(peer.idle.back().socket);
+    peer.idle.pop_back();
+    stats_.connections_reused++;
+    return std::unique_ptr<Connection>(
+        new Connection(this, key, std::move(socket)));
+  }
+  lock.unlock();
+
+  try {
+    socket = createSocket(ip, port);
+  } catch (...) {
+    lock.lock();
+    peer.in_flight--;
+    peer.condition_variable.notify_one();
+    throw;
+  }
+
+  lock.lock();
+  stats_.connections_created++;
+  return std::unique_ptr<Connection>(
+      new Connection(this, key, std::move(socket)));
+}
+
+std::unique_ptr<zmq::socket_t> ClientPool::createSocket(const std::string &ip,
+                                                        int16_t port) {
+  std::unique_ptr<zmq::socket_t> socket{
+      new zmq::socket_t(*context_, ZMQ_REQ)};
+  // a pooled socket only goes back to the pool after the reply was received,
+  // so there is never pending data to wait for when it is closed
+  int linger = 0;
+  socket->setsockopt(ZMQ_LINGER, &linger, sizeof(linger));
+  // a peer that stops answering fails the exchange with EAGAIN instead of
+  // blocking the sender forever
+  const Options current = options();
+  int send_timeout = timeoutOption(current.send_timeout);
+  int receive_timeout = timeoutOption(current.receive_timeout);
+  socket->setsockopt(ZMQ_SNDTIMEO, &send_timeout, sizeof(send_timeout));
+  socket->setsockopt(ZMQ_RCVTIMEO, &receive_timeout, sizeof(receive_timeout));
+#ifdef ZMQ_HEARTBEAT_IVL
+  int heartbeat = static_cast<int>(current.heartbeat_interval.count());
+  if (heartbeat > 0) {
+    int heartbeat_timeout = 3 * heartbeat;
+    socket->setsockopt(ZMQ_HEARTBEAT_IVL, &heartbeat, sizeof(heartbeat));
+    socket->setsockopt(ZMQ_HEARTBEAT_TIMEOUT, &heartbeat_timeout,
+                       sizeof(heartbeat_timeout));
+  }
+#endif
+  socket->connect("tcp://" + ip + ":" + std::to_string(port));
+  return socket;
+}
+
+void ClientPool::release(const std::string &key,
+                         std::unique_ptr<zmq::socket_t> socket, bool broken) {
+  std::unique_lock<std::mutex> lock(mutex_);
+  Peer &peer = peers_[key];
+  peer.in_flight--;
+  if (!broken && socket &&
+      static_cast<int>(peer.idle.size()) < options_.max_idle_per_peer) {
+    peer.idle.push_back(
+        IdleSocket{std::move(socket), std::chrono::steady_clock::now()});
+  } else {
+    stats_.connections_discarded++;
+  }
+  peer.condition_variable.notify_one();
+}
+
+std::future<Status> ClientPool::sendAsync(std::function<Status()> send) {
+  std::packaged_task<Status()> task(std::move(send));
+  std::future<Status> result = task.get_future();
+  {
+    std::unique_lock<std::mutex> lock(tasks_mutex_);
+    if (senders_.empty()) {
+      const int sender_threads = std::max(1, options().sender_threads);
+      for (int i = 0; i < sender_threads; i++) {
+        senders_.emplace_back(&ClientPool::runSender, this);
+      }
+    }
+    tasks_.push_back(std::move(task));
+  }
+  tasks_condition_variable_.notify_one();
+  return result;
+}
+
+void ClientPool::runSender() {
+  while (true) {
+    std::packaged_task<Status()> task;
+    {
+      std::unique_lock<std::mutex> lock(tasks_mutex_);
+      tasks_condition_variable_.wait(
+          lock, [this] { return stopping_ || !tasks_.empty(); });
+      if (tasks_.empty()) {
+        return;
+      }
+      task = std::move(tasks_.front());
+      tasks_.pop_front();
+    }
+    // exceptions are stored in the future
+    task();
+  }
+}
+
+void ClientPool::setOptions(const Options &options) {
+  std::unique_lock<std::mutex> lock(mutex_);
+  options_ = options;
+  for (auto &peer : peers_) {
+    peer.second.condition_variable.notify_all();
+  }
+}
+
+ClientPool::Options ClientPool::options() {
+  std::unique_lock<std::mutex> lock(mutex_);
+  return options_;
+}
+
+ClientPool::Stats ClientPool::stats() {
+  std::unique_lock<std::mutex> lock(mutex_);
+  return stats_;
+}
+
+void ClientPool::clear() {
+  std::unique_lock<std::mutex> lock(mutex_);
+  for (auto &peer : peers_) {
+    stats_.connections_discarded += peer.second.idle.size();
+    peer.second.idle.clear();
+  }
+}
+
+}  // namespace transport
+}  // namespace blazingdb
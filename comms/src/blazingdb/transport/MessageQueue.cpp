@@ -1,46 +1,89 @@
 #include "blazingdb/transport/MessageQueue.h"
 #include <algorithm>
+#include <blazingdb/io/Library/Metrics/MetricsRegistry.h>
 #include <iostream>
 
 namespace blazingdb {
 namespace transport {
 
+namespace {
+
+// messages waiting in all the queues of the process
+Library::Metrics::Gauge &queuedMessages() {
+  static Library::Metrics::Gauge &gauge =
+      Library::Metrics::MetricsRegistry::getInstance().gauge(
+          "blazing_message_queue_messages",
+          "Messages received and not yet taken from their MessageQueue");
+  return gauge;
+}
+
+}  // namespace
+
+// the messages never taken leave the process gauge with the queue
+MessageQueue::~MessageQueue() { queuedMessages().sub(size_); }
+
 std::shared_ptr<GPUMessage> MessageQueue::getMessage(
     const std::string &messageToken) {
   std::unique_lock<std::mutex> lock(mutex_);
-  condition_variable_.wait(lock, [&, this] {
-    return std::any_of(this->message_queue_.cbegin(),
-                       this->message_queue_.cend(), [&](const auto &e) {
-                         return e->getMessageTokenValue() == messageToken;
-                       });
-  });
-
-  return getMessageQueue(messageToken);
+  TokenQueue &token_queue = message_queue_[messageToken];
+  token_queue.waiters++;
+  token_queue.condition_variable.wait(
+      lock, [&token_queue] { return !token_queue.messages.empty(); });
+  token_queue.waiters--;
+
+  return getMessageQueue(token_queue, messageToken);
+}
+
+std::shared_ptr<GPUMessage> MessageQueue::getMessage(
+    const std::string &messageToken, std::chrono::milliseconds timeout) {
+  std::unique_lock<std::mutex> lock(mutex_);
+  TokenQueue &token_queue = message_queue_[messageToken];
+  token_queue.waiters++;
+  bool ready = token_queue.condition_variable.wait_for(
+      lock, timeout, [&token_queue] { return !token_queue.messages.empty(); });
+  token_queue.waiters--;
+
+  if (!ready) {
+    if (token_queue.waiters == 0 && token_queue.messages.empty()) {
+      message_queue_.erase(messageToken);
+    }
+    return nullptr;
+  }
+  return getMessageQueue(token_queue, messageToken);
 }
 
 void MessageQueue::putMessage(std::shared_ptr<GPUMessage> &message) {
   std::unique_lock<std::mutex> lock(mutex_);
   putMessageQueue(message);
-  lock.unlock();
-  condition_variable_.notify_one();
+}
+
+std::size_t MessageQueue::size() {
+  std::unique_lock<std::mutex> lock(mutex_);
+  return size_;
 }
 
 std::shared_ptr<GPUMessage> MessageQueue::getMessageQueue(
-    const std::string &messageToken) {
-  auto it = std::partition(message_queue_.begin(), message_queue_.end(),
-                           [&messageToken](const auto &e) {
-                             return e->getMessageTokenValue() != messageToken;
-                           });
-  assert(it != message_queue_.end());
+    TokenQueue &token_queue, const std::string &messageToken) {
+  assert(!token_queue.messages.empty());
 
-  std::shared_ptr<GPUMessage> message = *it;
-  message_queue_.erase(it, it + 1);
+  std::shared_ptr<GPUMessage> message = token_queue.messages.front();
+  token_queue.messages.pop_front();
+  size_--;
+  queuedMessages().sub(1);
 
+  if (token_queue.waiters == 0 && token_queue.messages.empty()) {
+    message_queue_.erase(messageToken);
+  }
   return message;
 }
 
 void MessageQueue::putMessageQueue(std::shared_ptr<GPUMessage> &message) {
-  message_queue_.push_back(message);
+  TokenQueue &token_queue = message_queue_[message->getMessageTokenValue()];
+  token_queue.messages.push_back(message);
+  size_++;
+  queuedMessages().add(1);
+  // every waiter of this queue wants this token, so one wakeup is enough
+  token_queue.condition_variable.notify_one();
 }
 
 }  // namespace transport
@@ -3,6 +3,7 @@
 #include "blazingdb/network/TCPSocket.h"
 #include "blazingdb/transport/io/reader_writer.h"
 
+#include <blazingdb/io/Library/Metrics/MetricsRegistry.h>
 #include <cuda_runtime_api.h>
 #include <condition_variable>
 #include <deque>
@@ -16,6 +17,7 @@
 #include <vector>
 #include "blazingdb/network/TCPSocket.h"
 #include "blazingdb/transport/MessageQueue.h"
+#include "blazingdb/transport/WireHeader.h"
 
 namespace blazingdb {
 namespace transport {
@@ -51,6 +53,14 @@ std::shared_ptr<GPUMessage> Server::getMessage(
   return message_queue.getMessage(messageToken);
 }
 
+std::shared_ptr<GPUMessage> Server::getMessage(
+    const uint32_t context_token, const std::string &messageToken,
+    std::chrono::milliseconds timeout) {
+  std::shared_lock<std::shared_timed_mutex> lock(context_messages_mutex_);
+  MessageQueue &message_queue = context_messages_map_.at(context_token);
+  return message_queue.getMessage(messageToken, timeout);
+}
+
 void Server::putMessage(const uint32_t context_token,
                         std::shared_ptr<GPUMessage> &message) {
   std::shared_lock<std::shared_timed_mutex> lock(context_messages_mutex_);
@@ -76,19 +86,12 @@ Server::MakeCallback Server::getDeserializationFunction(
   return iterator->second;
 }
 
-template <typename MetadataType>
-MetadataType read_metadata(void *fd) {
-  MetadataType metadata;
-  blazingdb::transport::io::readFromSocket(fd, (char *)&metadata,
-                                           sizeof(MetadataType));
-  return metadata;
-}
-
 namespace {
 
 class ServerTCP : public Server {
 public:
-  ServerTCP(unsigned short port) : server_socket{port} {}
+  ServerTCP(unsigned short port, int num_workers)
+      : server_socket{port, num_workers} {}
 
   void SetDevice(int gpuId) override { this->gpuId = gpuId; }
 
@@ -109,43 +112,53 @@ private:
   int gpuId{0};
 };
 
+namespace {
+
+struct ReceiveMetrics {
+  Library::Metrics::Counter &messages;
+  Library::Metrics::Counter &bytes;
+};
+
+ReceiveMetrics &receiveMetrics() {
+  auto &registry = Library::Metrics::MetricsRegistry::getInstance();
+  static ReceiveMetrics metrics{
+      registry.counter("blazing_shuffle_received_messages_total",
+                       "Messages received from other nodes"),
+      registry.counter(
+          "blazing_shuffle_received_bytes_total",
+          "Bytes of the messages received from other nodes, decompressed")};
+  return metrics;
+}
+
+}  // namespace
+
 void connectionHandler(ServerTCP *server, void *socket, int gpuId) {
   try {
-    // use io reader to read the message
-    // READ these two values, end point should be fixed width string
-    // so you read sizeof(EndPointSizeInStruct) + sizeof(size_t)
-    // read that from the buffer to get these values
+    zmq::socket_t *socket_ptr = (zmq::socket_t *)socket;
 
-    // begin of message
-    Message::MetaData message_metadata =
-        read_metadata<Message::MetaData>(socket);
-    Address::MetaData address_metadata =
-        read_metadata<Address::MetaData>(socket);
+    // begin of message: metadata, sender address and column layout
+    zmq::message_t header_frame;
+    if (!socket_ptr->recv(&header_frame)) {
+      throw zmq::error_t();
+    }
+    MessageHeader header = wire::decodeMessageHeader(
+        (const char *)header_frame.data(), header_frame.size());
 
     // read columns (gpu buffers)
-    auto column_offset_size = read_metadata<int32_t>(socket);
-    std::vector<ColumnTransport> column_offsets(column_offset_size);
-    blazingdb::transport::io::readFromSocket(
-        socket, (char *)column_offsets.data(),
-        column_offset_size * sizeof(ColumnTransport));
-
-    auto buffer_sizes_size = read_metadata<int32_t>(socket);
-    std::vector<int> buffer_sizes(buffer_sizes_size);
-    blazingdb::transport::io::readFromSocket(
-        socket, (char *)buffer_sizes.data(), buffer_sizes_size * sizeof(int));
-
     std::vector<char *> raw_columns;
     raw_columns = blazingdb::transport::io::readBuffersIntoGPUTCP(
-        buffer_sizes, socket, gpuId);
-    zmq::socket_t *socket_ptr = (zmq::socket_t *)socket;
+        header.buffer_sizes, socket, gpuId);
+    receiveMetrics().messages.increment();
+    receiveMetrics().bytes.increment(
+        std::accumulate(header.buffer_sizes.begin(), header.buffer_sizes.end(),
+                        header_frame.size()));
 
     int data_past_topic{0};
     auto data_past_topic_size{sizeof(data_past_topic)};
     socket_ptr->getsockopt(ZMQ_RCVMORE, &data_past_topic,
                            &data_past_topic_size);
     if (data_past_topic == 0 || data_past_topic_size == 0) {
-      std::cerr << "Server: No data inside message." << std::endl;
-      return;
+      throw std::runtime_error("Server: No data inside message.");
     }
     // receive the ok
     zmq::message_t local_message;
@@ -160,18 +173,23 @@ void connectionHandler(ServerTCP *server, void *socket, int gpuId) {
     blazingdb::transport::io::writeToSocket(socket, "END", 3, false);
     // end of message
 
-    std::string messageToken = message_metadata.messageToken;
+    std::string messageToken = header.message.messageToken;
     auto deserialize_function = server->getDeserializationFunction(
         messageToken.substr(0, messageToken.find('_')));
     std::shared_ptr<GPUMessage> message = deserialize_function(
-        message_metadata, address_metadata, column_offsets, raw_columns);
+        header.message, header.address, header.columns, raw_columns);
     assert(message != nullptr);
     server->putMessage(message->metadata().contextToken, message);
 
     // TODO: write success
   } catch (const std::exception &exception) {
-    // std::cerr << "[ERROR] " << exception.what() << std::endl;
-    // TODO: write failure
+    std::cerr << "[ERROR] " << exception.what() << std::endl;
+    // the REP socket must answer before it can receive again
+    try {
+      blazingdb::transport::io::discardPendingFrames(socket);
+      blazingdb::transport::io::writeToSocket(socket, "ERROR", 5, false);
+    } catch (const std::exception &) {
+    }
   }
 }
 
@@ -187,8 +205,8 @@ void ServerTCP::Close() { this->server_socket.close(); }
 
 }  // namespace
 
-std::unique_ptr<Server> Server::TCP(unsigned short port) {
-  return std::unique_ptr<Server>(new ServerTCP(port));
+std::unique_ptr<Server> Server::TCP(unsigned short port, int num_workers) {
+  return std::unique_ptr<Server>(new ServerTCP(port, num_workers));
 }
 
 }  // namespace transport
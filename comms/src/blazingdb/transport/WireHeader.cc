@@ -0,0 +1,399 @@
+#include "blazingdb/transport/WireHeader.h"
+
+#include <array>
+#include <cstring>
+
+namespace blazingdb {
+namespace transport {
+namespace wire {
+
+namespace {
+
+enum Kind : uint64_t { kVarint = 0, kBytes = 1 };
+
+// MessageHeader fields
+enum HeaderTag : uint64_t {
+  kMessageToken = 1,
+  kContextToken = 2,
+  kTotalRowSize = 3,
+  kAddress = 4,
+  kColumn = 5,
+  kBufferSizes = 6,
+};
+
+// Address::MetaData fields
+enum AddressTag : uint64_t {
+  kAddressType = 1,
+  kAddressIp = 2,
+  kCommunicationPort = 3,
+  kProtocolPort = 4,
+};
+
+// ColumnTransport fields, buffer indexes default to -1 when missing
+enum ColumnTag : uint64_t {
+  kDtype = 1,
+  kSize = 2,
+  kNullCount = 3,
+  kTimeUnit = 4,
+  kColumnName = 5,
+  kData = 6,
+  kValid = 7,
+  kStringsData = 8,
+  kStringsOffsets = 9,
+  kStringsNullmask = 10,
+  kCodec = 11,
+};
+
+uint64_t zigzag(int64_t value) {
+  return ((uint64_t)value << 1) ^ (uint64_t)(value >> 63);
+}
+
+int64_t unzigzag(uint64_t value) {
+  return (int64_t)(value >> 1) ^ -(int64_t)(value & 1);
+}
+
+class Writer {
+public:
+  void putVarint(uint64_t value) {
+    while (value >= 0x80) {
+      out_.push_back((char)(value | 0x80));
+      value >>= 7;
+    }
+    out_.push_back((char)value);
+  }
+
+  void putUnsigned(uint64_t tag, uint64_t value) {
+    putVarint(tag << 1 | kVarint);
+    putVarint(value);
+  }
+
+  void putSigned(uint64_t tag, int64_t value) { putUnsigned(tag, zigzag(value)); }
+
+  // default values are not sent, the reader restores them
+  void putSigned(uint64_t tag, int64_t value, int64_t defaultValue) {
+    if (value != defaultValue) {
+      putSigned(tag, value);
+    }
+  }
+
+  void putBytes(uint64_t tag, const char *data, std::size_t size) {
+    putVarint(tag << 1 | kBytes);
+    putVarint(size);
+    out_.append(data, size);
+  }
+
+  void putString(uint64_t tag, const char *value, std::size_t capacity) {
+    putBytes(tag, value, strnlen(value, capacity));
+  }
+
+  void putRaw(const char *data, std::size_t size) { out_.append(data, size); }
+
+  std::string &str() { return out_; }
+
+private:
+  std::string out_;
+};
+
+class Reader {
+public:
+  Reader(const char *data, std::size_t size) : data_{data}, end_{data + size} {}
+
+  bool done() const { return data_ == end_; }
+
+  uint64_t getVarint() {
+    uint64_t value = 0;
+    for (int shift = 0; shift < 64; shift += 7) {
+      if (data_ == end_) {
+        throw HeaderError("wire header: truncated varint");
+      }
+      const uint8_t byte = *data_++;
+      value |= (uint64_t)(byte & 0x7F) << shift;
+      if ((byte & 0x80) == 0) {
+        return value;
+      }
+    }
+    throw HeaderError("wire header: varint too long");
+  }
+
+  // Reads the next field key, returns its tag
+  uint64_t getKey(Kind &kind) {
+    const uint64_t key = getVarint();
+    kind = (Kind)(key & 1);
+    return key >> 1;
+  }
+
+  Reader getBytes() {
+    const uint64_t size = getVarint();
+    if (size > (uint64_t)(end_ - data_)) {
+      throw HeaderError("wire header: truncated field");
+    }
+    Reader field{data_, (std::size_t)size};
+    data_ += size;
+    return field;
+  }
+
+  void skip(Kind kind) {
+    if (kind == kVarint) {
+      getVarint();
+    } else {
+      getBytes();
+    }
+  }
+
+  template <std::size_t N>
+  void copyString(char (&destination)[N]) {
+    const std::size_t size = end_ - data_;
+    if (size >= N) {
+      throw HeaderError("wire header: string of " + std::to_string(size) +
+                        " bytes does not fit in " + std::to_string(N));
+    }
+    std::memcpy(destination, data_, size);
+    destination[size] = '\0';
+    data_ = end_;
+  }
+
+private:
+  const char *data_;
+  const char *end_;
+};
+
+void expectKind(Kind kind, Kind expected) {
+  if (kind != expected) {
+    throw HeaderError("wire header: unexpected field kind");
+  }
+}
+
+template <typename T>
+T getSigned(Reader &reader, Kind kind) {
+  expectKind(kind, kVarint);
+  return (T)unzigzag(reader.getVarint());
+}
+
+void encodeAddress(Writer &writer, const Address::MetaData &address) {
+  Writer nested;
+  nested.putSigned(kAddressType, address.type);
+  nested.putString(kAddressIp, address.ip, sizeof(address.ip));
+  nested.putSigned(kCommunicationPort, address.comunication_port);
+  nested.putSigned(kProtocolPort, address.protocol_port);
+  writer.putBytes(kAddress, nested.str().data(), nested.str().size());
+}
+
+void encodeColumn(Writer &writer, const ColumnTransport &column) {
+  Writer nested;
+  nested.putSigned(kDtype, column.metadata.dtype, 0);
+  nested.putSigned(kSize, column.metadata.size, 0);
+  nested.putSigned(kNullCount, column.metadata.null_count, 0);
+  nested.putSigned(kTimeUnit, column.metadata.time_unit, 0);
+  nested.putString(kColumnName, column.metadata.col_name,
+                   sizeof(column.metadata.col_name));
+  nested.putSigned(kData, column.data, -1);
+  nested.putSigned(kValid, column.valid, -1);
+  nested.putSigned(kStringsData, column.strings_data, -1);
+  nested.putSigned(kStringsOffsets, column.strings_offsets, -1);
+  nested.putSigned(kStringsNullmask, column.strings_nullmask, -1);
+  nested.putSigned(kCodec, column.codec, 0);
+  writer.putBytes(kColumn, nested.str().data(), nested.str().size());
+}
+
+Address::MetaData decodeAddress(Reader reader) {
+  Address::MetaData address;
+  while (!reader.done()) {
+    Kind kind;
+    switch (reader.getKey(kind)) {
+      case kAddressType:
+        address.type = getSigned<int32_t>(reader, kind);
+        break;
+      case kAddressIp:
+        expectKind(kind, kBytes);
+        reader.getBytes().copyString(address.ip);
+        break;
+      case kCommunicationPort:
+        address.comunication_port = getSigned<int16_t>(reader, kind);
+        break;
+      case kProtocolPort:
+        address.protocol_port = getSigned<int16_t>(reader, kind);
+        break;
+      default:
+        reader.skip(kind);
+    }
+  }
+  return address;
+}
+
+ColumnTransport decodeColumn(Reader reader) {
+  ColumnTransport column;
+  column.data = column.valid = column.strings_data = column.strings_offsets =
+      column.strings_nullmask = -1;
+  while (!reader.done()) {
+    Kind kind;
+    switch (reader.getKey(kind)) {
+      case kDtype:
+        column.metadata.dtype = getSigned<int32_t>(reader, kind);
+        break;
+      case kSize:
+        column.metadata.size = getSigned<int32_t>(reader, kind);
+        break;
+      case kNullCount:
+        column.metadata.null_count = getSigned<int32_t>(reader, kind);
+        break;
+      case kTimeUnit:
+        column.metadata.time_unit = getSigned<int32_t>(reader, kind);
+        break;
+      case kColumnName:
+        expectKind(kind, kBytes);
+        reader.getBytes().copyString(column.metadata.col_name);
+        break;
+      case kData:
+        column.data = getSigned<int>(reader, kind);
+        break;
+      case kValid:
+        column.valid = getSigned<int>(reader, kind);
+        break;
+      case kStringsData:
+        column.strings_data = getSigned<int>(reader, kind);
+        break;
+      case kStringsOffsets:
+        column.strings_offsets = getSigned<int>(reader, kind);
+        break;
+      case kStringsNullmask:
+        column.strings_nullmask = getSigned<int>(reader, kind);
+        break;
+      case kCodec:
+        column.codec = getSigned<int32_t>(reader, kind);
+        break;
+      default:
+        reader.skip(kind);
+    }
+  }
+  return column;
+}
+
+const std::array<uint32_t, 256> &crc32cTable() {
+  static const std::array<uint32_t, 256> table = [] {
+    std::array<uint32_t, 256> table;
+    for (uint32_t i = 0; i < 256; i++) {
+      uint32_t crc = i;
+      for (int bit = 0; bit < 8; bit++) {
+        crc = crc & 1 ? (crc >> 1) ^ 0x82F63B78 : crc >> 1;
+      }
+      table[i] = crc;
+    }
+    return table;
+  }();
+  return table;
+}
+
+}  // namespace
+
+uint32_t crc32c(const char *data, std::size_t size) {
+  const auto &table = crc32cTable();
+  uint32_t crc = 0xFFFFFFFF;
+  for (std::size_t i = 0; i < size; i++) {
+    crc = table[(crc ^ (uint8_t)data[i]) & 0xFF] ^ (crc >> 8);
+  }
+  return ~crc;
+}
+
+std::string encodeMessageHeader(const MessageHeader &header) {
+  Writer writer;
+  const char preamble[] = {(char)kMagic, (char)kWireVersion};
+  writer.putRaw(preamble, sizeof(preamble));
+
+  writer.putString(kMessageToken, header.message.messageToken,
+                   sizeof(header.message.messageToken));
+  writer.putUnsigned(kContextToken, header.message.contextToken);
+  writer.putSigned(kTotalRowSize, header.message.total_row_size, 0);
+  encodeAddress(writer, header.address);
+  for (const auto &column : header.columns) {
+    encodeColumn(writer, column);
+  }
+  Writer sizes;
+  for (int size : header.buffer_sizes) {
+    sizes.putVarint(zigzag(size));
+  }
+  writer.putBytes(kBufferSizes, sizes.str().data(), sizes.str().size());
+
+  const uint32_t checksum = crc32c(writer.str().data(), writer.str().size());
+  const char trailer[] = {(char)checksum, (char)(checksum >> 8),
+                          (char)(checksum >> 16), (char)(checksum >> 24)};
+  writer.putRaw(trailer, sizeof(trailer));
+  return std::move(writer.str());
+}
+
+MessageHeader decodeMessageHeader(const char *data, std::size_t size) {
+  if (size < 2 + sizeof(uint32_t)) {
+    throw HeaderError("wire header: truncated header");
+  }
+  if ((uint8_t)data[0] != kMagic) {
+    throw HeaderError("wire header: bad magic");
+  }
+  if ((uint8_t)data[1] > kWireVersion) {
+    throw HeaderError("wire header: unsupported version " +
+                      std::to_string((uint8_t)data[1]));
+  }
+  const std::size_t body = size - sizeof(uint32_t);
+  const uint8_t *trailer = (const uint8_t *)data + body;
+  const uint32_t checksum = trailer[0] | trailer[1] << 8 | trailer[2] << 16 |
+                            (uint32_t)trailer[3] << 24;
+  if (crc32c(data, body) != checksum) {
+    throw HeaderError("wire header: checksum mismatch");
+  }
+
+  MessageHeader header;
+  Reader reader{data + 2, body - 2};
+  while (!reader.done()) {
+    Kind kind;
+    switch (reader.getKey(kind)) {
+      case kMessageToken:
+        expectKind(kind, kBytes);
+        reader.getBytes().copyString(header.message.messageToken);
+        break;
+      case kContextToken:
+        expectKind(kind, kVarint);
+        header.message.contextToken = (uint32_t)reader.getVarint();
+        break;
+      case kTotalRowSize:
+        header.message.total_row_size = getSigned<int32_t>(reader, kind);
+        break;
+      case kAddress:
+        expectKind(kind, kBytes);
+        header.address = decodeAddress(reader.getBytes());
+        break;
+      case kColumn:
+        expectKind(kind, kBytes);
+        header.columns.push_back(decodeColumn(reader.getBytes()));
+        break;
+      case kBufferSizes: {
+        expectKind(kind, kBytes);
+        Reader sizes = reader.getBytes();
+        while (!sizes.done()) {
+          const int64_t bufferSize = unzigzag(sizes.getVarint());
+          if (bufferSize < 0 || bufferSize > INT32_MAX) {
+            throw HeaderError("wire header: bad buffer size");
+          }
+          header.buffer_sizes.push_back((int)bufferSize);
+        }
+        break;
+      }
+      default:
+        reader.skip(kind);
+    }
+  }
+
+  const int num_buffers = header.buffer_sizes.size();
+  for (const auto &column : header.columns) {
+    for (int buffer : {column.data, column.valid, column.strings_data,
+                       column.strings_offsets, column.strings_nullmask}) {
+      if (buffer < -1 || buffer >= num_buffers) {
+        throw HeaderError("wire header: column references buffer " +
+                          std::to_string(buffer) + " of " +
+                          std::to_string(num_buffers));
+      }
+    }
+  }
+  return header;
+}
+
+}  // namespace wire
+}  // namespace transport
+}  // namespace blazingdb
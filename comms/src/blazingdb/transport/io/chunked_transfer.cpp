@@ -0,0 +1,675 @@
+#include "blazingdb/transport/io/chunked_transfer.h"
+
+#include <algorithm>
+#include <atomic>
+#include <condition_variable>
+#include <cstdlib>
+#include <deque>
+#include <exception>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <new>
+#include <stdexcept>
+#include <string>
+#include <thread>
+#include <zmq.hpp>
+#include "blazingdb/transport/io/fd_reader_writer.h"
+#include "blazingdb/transport/io/spsc_ring.h"
+
+namespace blazingdb {
+namespace transport {
+namespace io {
+
+namespace {
+
+// A chunk ready to be written. Its payload is lent to zmq, which calls
+// release once the frame is sent. Frames never sent release it here.
+struct StagedFrame {
+  StagedFrame() = default;
+
+  StagedFrame(const StagedFrame &) = delete;
+
+  StagedFrame &operator=(const StagedFrame &) = delete;
+
+  ~StagedFrame() {
+    if (release != nullptr) {
+      release(data, hint);
+    }
+  }
+
+  ChunkHeader header;
+  char *data{nullptr};
+  std::size_t size{0};
+  release_function release{nullptr};
+  void *hint{nullptr};
+};
+
+struct LentBuffer {
+  PinnedBufferProvider *provider;
+  PinnedBuffer *buffer;
+};
+
+void returnToProvider(void * /*data*/, void *hint) {
+  LentBuffer *lent = static_cast<LentBuffer *>(hint);
+  lent->provider->freeBuffer(lent->buffer);
+  delete lent;
+}
+
+/// \brief Host memory lent to zmq by the transfers of the process
+class HostStagingBudget {
+public:
+  static HostStagingBudget &getInstance() {
+    static HostStagingBudget instance;
+    return instance;
+  }
+
+  // Waits while limit is used up, unless nothing is lent or the transfer
+  // already took some, which it records in lent. Its workers check lent under
+  // the lock, so none of them waits once another one took memory.
+  void take(std::size_t size, std::size_t limit, std::atomic<bool> &lent) {
+    std::unique_lock<std::mutex> lock(mutex_);
+    cv_.wait(lock, [this, size, limit, &lent] {
+      return lent || in_use_ == 0 || in_use_ + size <= limit;
+    });
+    in_use_ += size;
+    const bool first = !lent.exchange(true);
+    lock.unlock();
+    if (first) {
+      cv_.notify_all();
+    }
+  }
+
+  void give(std::size_t size) {
+    {
+      std::lock_guard<std::mutex> lock(mutex_);
+      in_use_ -= size;
+    }
+    cv_.notify_all();
+  }
+
+  std::size_t inUse() {
+    std::lock_guard<std::mutex> lock(mutex_);
+    return in_use_;
+  }
+
+private:
+  std::mutex mutex_;
+  std::condition_variable cv_;
+  std::size_t in_use_{0};
+};
+
+struct HostAllocation {
+  std::size_t size;
+};
+
+void returnHostMemory(void *data, void *hint) {
+  HostAllocation *allocation = static_cast<HostAllocation *>(hint);
+  std::free(data);
+  HostStagingBudget::getInstance().give(allocation->size);
+  delete allocation;
+}
+
+// Allocates the payload of frame within the host staging budget. A transfer
+// waits for memory only while it has none lent, see writeBuffersChunked.
+void allocateHostMemory(StagedFrame &frame, std::size_t size,
+                        const ChunkedTransferOptions &options,
+                        std::atomic<bool> &lent_host_memory) {
+  HostStagingBudget &budget = HostStagingBudget::getInstance();
+  budget.take(size, options.max_host_staging_bytes, lent_host_memory);
+  std::unique_ptr<HostAllocation> allocation(new HostAllocation{size});
+  frame.data = static_cast<char *>(std::malloc(size));
+  if (frame.data == nullptr) {
+    budget.give(size);
+    throw std::bad_alloc();
+  }
+  frame.release = returnHostMemory;
+  frame.hint = allocation.release();
+}
+
+struct ReceivedChunk {
+  PinnedBuffer *staging{nullptr};
+  char *destination{nullptr};
+  std::size_t size{0};
+  // compressed payload, decoded into staging by the copy thread
+  CodecType codec{CodecType::none};
+  std::unique_ptr<zmq::message_t> encoded;
+};
+
+/// \brief Wakes the threads blocked on the rings of a transfer
+///
+/// Waiters check their condition again under the mutex before sleeping, so a
+/// notify that follows a push or a pop is never lost. Notifiers only take the
+/// mutex when somebody waits.
+class RingEvent {
+public:
+  template <typename Ready>
+  void wait(Ready ready) {
+    if (ready()) {
+      return;
+    }
+    std::unique_lock<std::mutex> lock(mutex_);
+    waiters_.fetch_add(1);
+    cv_.wait(lock, ready);
+    waiters_.fetch_sub(1);
+  }
+
+  void notify() {
+    // a read-modify-write, so it either sees the waiter or the waiter sees
+    // what the caller did before notifying
+    if (waiters_.fetch_add(0) > 0) {
+      { std::lock_guard<std::mutex> lock(mutex_); }
+      cv_.notify_all();
+    }
+  }
+
+private:
+  std::mutex mutex_;
+  std::condition_variable cv_;
+  std::atomic<std::size_t> waiters_{0};
+};
+
+/// \brief Copy threads shared by all the transfers of the process
+///
+/// Threads are started on demand, up to the number of cores, and wait for the
+/// next transfer once done. Transfers do not depend on their tasks starting:
+/// the calling threads stage or copy the chunks themselves when no copy thread
+/// took them yet.
+class CopyThreadPool {
+public:
+  static CopyThreadPool &getInstance() {
+    // never destroyed, its threads may still be waiting at exit
+    static CopyThreadPool *pool = new CopyThreadPool(std::max<std::size_t>(
+        4, std::thread::hardware_concurrency()));
+    return *pool;
+  }
+
+  void submit(std::function<void()> task) {
+    std::unique_lock<std::mutex> lock(mutex_);
+    tasks_.push_back(std::move(task));
+    if (idle_ < tasks_.size() && threads_ < max_threads_) {
+      std::thread(&CopyThreadPool::run, this).detach();
+      threads_++;
+    } else {
+      cv_.notify_one();
+    }
+  }
+
+private:
+  explicit CopyThreadPool(std::size_t max_threads)
+      : max_threads_{max_threads} {}
+
+  void run() {
+    std::unique_lock<std::mutex> lock(mutex_);
+    while (true) {
+      idle_++;
+      cv_.wait(lock, [this] { return !tasks_.empty(); });
+      idle_--;
+      std::function<void()> task = std::move(tasks_.front());
+      tasks_.pop_front();
+      lock.unlock();
+      try {
+        task();
+      } catch (...) {
+      }
+      lock.lock();
+    }
+  }
+
+  std::mutex mutex_;
+  std::condition_variable cv_;
+  std::deque<std::function<void()>> tasks_;
+  std::size_t max_threads_;
+  std::size_t threads_{0};
+  std::size_t idle_{0};
+};
+
+/// \brief Tasks of one transfer on the CopyThreadPool
+///
+/// wait() cancels the tasks that did not start yet and waits for the running
+/// ones, so that no task outlives the state of the transfer.
+class TaskGroup {
+public:
+  TaskGroup() : state_{std::make_shared<State>()} {}
+
+  TaskGroup(const TaskGroup &) = delete;
+
+  TaskGroup &operator=(const TaskGroup &) = delete;
+
+  ~TaskGroup() { wait(); }
+
+  void run(std::function<void()> task) {
+    std::shared_ptr<State> state = state_;
+    CopyThreadPool::getInstance().submit([state, task] {
+      {
+        std::lock_guard<std::mutex> lock(state->mutex);
+        if (state->cancelled) {
+          return;
+        }
+        state->running++;
+      }
+      task();
+      std::lock_guard<std::mutex> lock(state->mutex);
+      state->running--;
+      state->cv.notify_all();
+    });
+  }
+
+  void wait() {
+    std::unique_lock<std::mutex> lock(state_->mutex);
+    state_->cancelled = true;
+    state_->cv.wait(lock, [this] { return state_->running == 0; });
+  }
+
+private:
+  struct State {
+    std::mutex mutex;
+    std::condition_variable cv;
+    bool cancelled{false};
+    std::size_t running{0};
+  };
+
+  std::shared_ptr<State> state_;
+};
+
+std::size_t effectiveChunkSize(PinnedBufferProvider &provider,
+                               const ChunkedTransferOptions &options) {
+  std::size_t chunk_size = provider.sizeBuffers();
+  if (options.chunk_size > 0) {
+    chunk_size = std::min(chunk_size, options.chunk_size);
+  }
+  if (chunk_size == 0) {
+    throw std::runtime_error("chunked transfer: empty staging buffers");
+  }
+  return chunk_size;
+}
+
+// Copies a chunk to host memory and compresses it with codec. The frame
+// borrows a staging buffer when one is idle. It never waits for one: the
+// buffers lent to zmq only come back once the caller sent the last frame of
+// the message, after writeBuffersChunked returns.
+std::unique_ptr<StagedFrame> stageChunk(const ChunkHeader &job,
+                                        const char *source,
+                                        const BufferCodec &codec,
+                                        PinnedBufferProvider &provider,
+                                        const copy_function &copy,
+                                        const ChunkedTransferOptions &options,
+                                        std::atomic<bool> &incompressible,
+                                        std::atomic<bool> &lent_host_memory) {
+  std::unique_ptr<StagedFrame> frame(new StagedFrame);
+  frame->header = job;
+  frame->size = job.size;
+  std::unique_ptr<LentBuffer> lent(
+      new LentBuffer{&provider, provider.tryGetBuffer()});
+  if (lent->buffer != nullptr) {
+    frame->data = lent->buffer->data;
+    frame->release = returnToProvider;
+    frame->hint = lent.release();
+  } else {
+    allocateHostMemory(*frame, job.size, options, lent_host_memory);
+  }
+  copy(frame->data, source, job.size);
+
+  if (codec.type == CodecType::none) {
+    return frame;
+  }
+  // a compressed chunk has to be smaller than the raw one
+  const std::size_t capacity =
+      options.adaptive ? (std::size_t)(job.size * options.max_ratio)
+                       : job.size - 1;
+  std::size_t encoded_size = 0;
+  if (capacity > 0) {
+    std::unique_ptr<StagedFrame> encoded(new StagedFrame);
+    encoded->header = job;
+    encoded->header.codec = (int32_t)codec.type;
+    allocateHostMemory(*encoded, capacity, options, lent_host_memory);
+    encoded_size = getCodec(codec.type).encode(
+        frame->data, job.size, encoded->data, capacity, codec.elementSize);
+    if (encoded_size > 0) {
+      encoded->size = encoded_size;
+      // the raw chunk goes back to the provider right away
+      return encoded;
+    }
+  }
+  if (options.adaptive) {
+    incompressible = true;
+  }
+  return frame;
+}
+
+void writeStagedFrame(void *fileDescriptor, StagedFrame &frame) {
+  writeToSocket(fileDescriptor, (char *)&frame.header, sizeof(ChunkHeader));
+  // the message owns the payload from now on, even if the send fails
+  release_function release = frame.release;
+  frame.release = nullptr;
+  writeToSocketZeroCopy(fileDescriptor, frame.data, frame.size, release,
+                        frame.hint);
+}
+
+void unstageChunk(ReceivedChunk &chunk, const copy_function &copy) {
+  if (chunk.encoded) {
+    getCodec(chunk.codec).decode((const char *)chunk.encoded->data(),
+                                 chunk.encoded->size(), chunk.staging->data,
+                                 chunk.size);
+  }
+  copy(chunk.destination, chunk.staging->data, chunk.size);
+}
+
+void rethrowFirst(const std::vector<std::exception_ptr> &errors) {
+  for (auto &error : errors) {
+    if (error) {
+      std::rethrow_exception(error);
+    }
+  }
+}
+
+}  // namespace
+
+void writeBuffersChunked(const std::vector<int> &bufferSizes,
+                         const std::vector<char *> &buffers,
+                         void *fileDescriptor, PinnedBufferProvider &provider,
+                         const copy_function &copy,
+                         const ChunkedTransferOptions &options) {
+  const std::size_t chunk_size = effectiveChunkSize(provider, options);
+
+  std::vector<ChunkHeader> jobs;
+  for (std::size_t bufferIndex = 0; bufferIndex < bufferSizes.size();
+       bufferIndex++) {
+    for (int64_t offset = 0; offset < bufferSizes[bufferIndex];
+         offset += chunk_size) {
+      ChunkHeader job;
+      job.buffer_index = bufferIndex;
+      job.offset = offset;
+      job.size = std::min<int64_t>(chunk_size, bufferSizes[bufferIndex] - offset);
+      jobs.push_back(job);
+    }
+  }
+  if (jobs.empty()) {
+    return;
+  }
+
+  using Ring = SpscRing<std::unique_ptr<StagedFrame>>;
+  const std::size_t num_workers =
+      std::max<std::size_t>(1, std::min(options.copy_threads, jobs.size()));
+  std::vector<std::unique_ptr<Ring>> rings;
+  for (std::size_t worker = 0; worker < num_workers; worker++) {
+    rings.emplace_back(
+        new Ring(std::max<std::size_t>(1, options.ring_capacity)));
+  }
+  std::atomic<std::size_t> next_job{0};
+  std::atomic<bool> abort{false};
+  std::vector<std::exception_ptr> errors(num_workers + 1);
+  // adaptive mode: buffers whose chunks do not compress well are sent raw
+  std::unique_ptr<std::atomic<bool>[]> incompressible{
+      new std::atomic<bool>[bufferSizes.size()]};
+  for (std::size_t bufferIndex = 0; bufferIndex < bufferSizes.size();
+       bufferIndex++) {
+    incompressible[bufferIndex] = false;
+  }
+  RingEvent staged;  // a ring got a frame
+  RingEvent drained;  // a ring got room
+  // this transfer lent host staging memory, which only comes back after it
+  // returns, so it must not wait for more
+  std::atomic<bool> lent_host_memory{false};
+
+  auto stage = [&](std::size_t job_index) {
+    const ChunkHeader &job = jobs[job_index];
+    BufferCodec codec;
+    if ((std::size_t)job.buffer_index < options.codecs.size() &&
+        !incompressible[job.buffer_index]) {
+      codec = options.codecs[job.buffer_index];
+    }
+    return stageChunk(job, buffers[job.buffer_index] + job.offset, codec,
+                      provider, copy, options,
+                      incompressible[job.buffer_index], lent_host_memory);
+  };
+
+  // copy stage: workers pick chunks in any order and hand them to the writer
+  // through their own ring
+  TaskGroup workers;
+  for (std::size_t worker = 0; worker < num_workers; worker++) {
+    workers.run([&, worker]() {
+      try {
+        for (std::size_t job_index = next_job++;
+             job_index < jobs.size() && !abort; job_index = next_job++) {
+          std::unique_ptr<StagedFrame> frame = stage(job_index);
+          drained.wait(
+              [&] { return abort || rings[worker]->try_push(frame); });
+          if (frame) {
+            return;  // aborted
+          }
+          staged.notify();
+        }
+      } catch (...) {
+        errors[worker] = std::current_exception();
+        abort = true;
+        staged.notify();
+      }
+    });
+  }
+
+  // write stage: the calling thread drains the rings without holding any lock
+  try {
+    auto anyStaged = [&] {
+      for (auto &ring : rings) {
+        if (!ring->empty()) {
+          return true;
+        }
+      }
+      return false;
+    };
+    std::size_t written = 0;
+    while (written < jobs.size() && !abort) {
+      bool progress = false;
+      for (auto &ring : rings) {
+        std::unique_ptr<StagedFrame> frame;
+        while (ring->try_pop(frame)) {
+          drained.notify();
+          writeStagedFrame(fileDescriptor, *frame);
+          written++;
+          progress = true;
+        }
+      }
+      if (progress) {
+        continue;
+      }
+      // nothing staged: stage the next chunk here rather than wait for copy
+      // threads that may be busy with other transfers
+      const std::size_t job_index = next_job++;
+      if (job_index < jobs.size()) {
+        writeStagedFrame(fileDescriptor, *stage(job_index));
+        written++;
+        continue;
+      }
+      staged.wait([&] { return abort || anyStaged(); });
+    }
+  } catch (...) {
+    errors[num_workers] = std::current_exception();
+  }
+  abort = true;
+  drained.notify();
+  workers.wait();
+  rethrowFirst(errors);
+}
+
+void readBuffersChunked(const std::vector<int> &bufferSizes,
+                        const std::vector<char *> &destinations,
+                        void *fileDescriptor, PinnedBufferProvider &provider,
+                        const copy_function &copy,
+                        const ChunkedTransferOptions &options) {
+  int64_t total = 0;
+  for (int size : bufferSizes) {
+    total += size;
+  }
+  if (total == 0) {
+    return;
+  }
+
+  using Ring = SpscRing<ReceivedChunk>;
+  const std::size_t num_workers = std::max<std::size_t>(1, options.copy_threads);
+  std::vector<std::unique_ptr<Ring>> rings;
+  for (std::size_t worker = 0; worker < num_workers; worker++) {
+    rings.emplace_back(
+        new Ring(std::max<std::size_t>(1, options.ring_capacity)));
+  }
+  // chunks only go to the rings of the workers that started
+  std::unique_ptr<std::atomic<bool>[]> started{
+      new std::atomic<bool>[num_workers]};
+  for (std::size_t worker = 0; worker < num_workers; worker++) {
+    started[worker] = false;
+  }
+  std::atomic<bool> done{false};
+  std::atomic<bool> abort{false};
+  std::vector<std::exception_ptr> errors(num_workers + 1);
+  RingEvent received_event;  // a ring got a chunk, or the reader is done
+  RingEvent drained;  // a ring got room, or a worker started
+
+  TaskGroup workers;
+  for (std::size_t worker = 0; worker < num_workers; worker++) {
+    workers.run([&, worker]() {
+      started[worker] = true;
+      drained.notify();
+      while (true) {
+        ReceivedChunk chunk;
+        bool popped = false;
+        received_event.wait([&] {
+          popped = rings[worker]->try_pop(chunk);
+          return popped || done || abort;
+        });
+        if (!popped) {
+          if (rings[worker]->empty()) {
+            return;
+          }
+          continue;
+        }
+        drained.notify();
+        try {
+          if (!abort) {
+            unstageChunk(chunk, copy);
+          }
+        } catch (...) {
+          errors[worker] = std::current_exception();
+          abort = true;
+          drained.notify();
+        }
+        chunk.encoded.reset();
+        provider.freeBuffer(chunk.staging);
+      }
+    });
+  }
+
+  zmq::socket_t *socket = (zmq::socket_t *)fileDescriptor;
+  try {
+    std::size_t next_worker = 0;
+    int64_t received = 0;
+    while (received < total && !abort) {
+      ChunkHeader header;
+      readFromSocket(fileDescriptor, (char *)&header, sizeof(ChunkHeader));
+      if (header.buffer_index < 0 ||
+          header.buffer_index >= (int32_t)bufferSizes.size() ||
+          header.offset < 0 || header.size <= 0 ||
+          header.offset + header.size > bufferSizes[header.buffer_index] ||
+          received + header.size > total) {
+        throw std::runtime_error(
+            "readBuffersChunked: malformed chunk header for buffer " +
+            std::to_string(header.buffer_index) + " at offset " +
+            std::to_string(header.offset) + " with size " +
+            std::to_string(header.size));
+      }
+      char *destination = destinations[header.buffer_index] + header.offset;
+      const CodecType codec = (CodecType)header.codec;
+      const Codec &decoder = getCodec(codec);
+
+      std::unique_ptr<zmq::message_t> encoded;
+      if (codec != CodecType::none) {
+        encoded.reset(new zmq::message_t);
+        if (!socket->recv(encoded.get())) {
+          throw zmq::error_t();
+        }
+        if ((int64_t)encoded->size() >= header.size) {
+          throw std::runtime_error(
+              "readBuffersChunked: compressed chunk is not smaller");
+        }
+      }
+
+      if ((std::size_t)header.size > provider.sizeBuffers()) {
+        // the sender uses bigger chunks than our staging buffers
+        if (encoded) {
+          std::vector<char> decoded(header.size);
+          decoder.decode((const char *)encoded->data(), encoded->size(),
+                         decoded.data(), header.size);
+          copy(destination, decoded.data(), header.size);
+        } else {
+          zmq::message_t payload;
+          if (!socket->recv(&payload)) {
+            throw zmq::error_t();
+          }
+          if ((int64_t)payload.size() != header.size) {
+            throw std::runtime_error("readBuffersChunked: chunk size mismatch");
+          }
+          copy(destination, (const char *)payload.data(), header.size);
+        }
+      } else {
+        ReceivedChunk chunk;
+        chunk.staging = provider.getBuffer();
+        chunk.destination = destination;
+        chunk.size = header.size;
+        chunk.codec = codec;
+        chunk.encoded = std::move(encoded);
+        bool pushed = false;
+        try {
+          if (!chunk.encoded) {
+            readFromSocket(fileDescriptor, chunk.staging->data, chunk.size);
+          }
+          // hand the chunk to the first started copy thread with room, or
+          // copy it here when none started yet
+          drained.wait([&] {
+            bool any_started = false;
+            for (std::size_t i = 0; i < num_workers && !abort; i++) {
+              const std::size_t worker = (next_worker + i) % num_workers;
+              if (started[worker]) {
+                any_started = true;
+                if (rings[worker]->try_push(chunk)) {
+                  next_worker = (worker + 1) % num_workers;
+                  pushed = true;
+                  return true;
+                }
+              }
+            }
+            return abort || !any_started;
+          });
+          if (pushed) {
+            received_event.notify();
+          } else if (!abort) {
+            unstageChunk(chunk, copy);
+          }
+        } catch (...) {
+          if (!pushed) {
+            provider.freeBuffer(chunk.staging);
+          }
+          throw;
+        }
+        if (!pushed) {
+          chunk.encoded.reset();
+          provider.freeBuffer(chunk.staging);
+        }
+      }
+      received += header.size;
+    }
+  } catch (...) {
+    errors[num_workers] = std::current_exception();
+    abort = true;
+  }
+  done = true;
+  received_event.notify();
+  workers.wait();
+  rethrowFirst(errors);
+}
+
+std::size_t hostStagingBytesInUse() {
+  return HostStagingBudget::getInstance().inUse();
+}
+
+}  // namespace io
+}  // namespace transport
+}  // namespace blazingdb
@@ -0,0 +1,452 @@
+#include "blazingdb/transport/io/codec.h"
+
+#include <lz4.h>
+#include <zstd.h>
+#include <algorithm>
+#include <cstring>
+#include <limits>
+#include <stdexcept>
+#include <string>
+
+namespace blazingdb {
+namespace transport {
+namespace io {
+
+namespace {
+
+class NoneCodec : public Codec {
+public:
+  CodecType type() const override { return CodecType::none; }
+
+  std::size_t encode(const char *src, std::size_t size, char *dst,
+                     std::size_t capacity, int) const override {
+    if (size > capacity) {
+      return 0;
+    }
+    std::memcpy(dst, src, size);
+    return size;
+  }
+
+  void decode(const char *src, std::size_t encodedSize, char *dst,
+              std::size_t size) const override {
+    if (encodedSize != size) {
+      throw std::runtime_error("codec none: size mismatch");
+    }
+    std::memcpy(dst, src, size);
+  }
+};
+
+class Lz4Codec : public Codec {
+public:
+  CodecType type() const override { return CodecType::lz4; }
+
+  std::size_t encode(const char *src, std::size_t size, char *dst,
+                     std::size_t capacity, int) const override {
+    const std::size_t max = std::numeric_limits<int>::max();
+    if (size > max) {
+      return 0;
+    }
+    int encoded = LZ4_compress_default(src, dst, (int)size,
+                                       (int)std::min(capacity, max));
+    return encoded > 0 ? encoded : 0;
+  }
+
+  void decode(const char *src, std::size_t encodedSize, char *dst,
+              std::size_t size) const override {
+    const std::size_t max = std::numeric_limits<int>::max();
+    if (encodedSize > max || size > max ||
+        LZ4_decompress_safe(src, dst, (int)encodedSize, (int)size) !=
+            (int)size) {
+      throw std::runtime_error("codec lz4: corrupt chunk");
+    }
+  }
+};
+
+class ZstdCodec : public Codec {
+public:
+  CodecType type() const override { return CodecType::zstd; }
+
+  std::size_t encode(const char *src, std::size_t size, char *dst,
+                     std::size_t capacity, int) const override {
+    // level 1, the shuffle is bound by the network, not by the ratio
+    std::size_t encoded = ZSTD_compress(dst, capacity, src, size, 1);
+    return ZSTD_isError(encoded) ? 0 : encoded;
+  }
+
+  void decode(const char *src, std::size_t encodedSize, char *dst,
+              std::size_t size) const override {
+    std::size_t decoded = ZSTD_decompress(dst, size, src, encodedSize);
+    if (ZSTD_isError(decoded) || decoded != size) {
+      throw std::runtime_error("codec zstd: corrupt chunk");
+    }
+  }
+};
+
+/// \brief Run-length and frame-of-reference bit-packing of integers
+///
+/// Layout: one byte with the element width, then blocks until all the
+/// size / width elements are decoded, then the size % width trailing bytes.
+/// A block starts with a tag byte:
+///  - kRunTag: width bytes value, varint repeat count
+///  - 0..64:   bits per value, width bytes base, then up to kBlockLength
+///             values minus base packed with that many bits, LSB first
+/// Values are sign extended before taking the base, so small negative
+/// numbers pack as well as small positive ones.
+class RleCodec : public Codec {
+public:
+  CodecType type() const override { return CodecType::rle; }
+
+  std::size_t encode(const char *src, std::size_t size, char *dst,
+                     std::size_t capacity, int elementSize) const override {
+    switch (elementSize) {
+      case 2:
+        return encodeValues<2>(src, size, dst, capacity);
+      case 4:
+        return encodeValues<4>(src, size, dst, capacity);
+      case 8:
+        return encodeValues<8>(src, size, dst, capacity);
+      default:
+        return encodeValues<1>(src, size, dst, capacity);
+    }
+  }
+
+  void decode(const char *src, std::size_t encodedSize, char *dst,
+              std::size_t size) const override {
+    if (encodedSize < 1) {
+      corrupt();
+    }
+    switch (src[0]) {
+      case 1:
+        return decodeValues<1>(src, encodedSize, dst, size);
+      case 2:
+        return decodeValues<2>(src, encodedSize, dst, size);
+      case 4:
+        return decodeValues<4>(src, encodedSize, dst, size);
+      case 8:
+        return decodeValues<8>(src, encodedSize, dst, size);
+      default:
+        corrupt();
+    }
+  }
+
+private:
+  static constexpr std::size_t kBlockLength = 128;
+  static constexpr std::size_t kMinRun = 16;
+  static constexpr std::size_t kMaxVarint = 10;
+  static constexpr uint8_t kRunTag = 0xFF;
+
+  class BitWriter {
+  public:
+    explicit BitWriter(char *out) : out_{out} {}
+
+    void put(uint64_t value, int bits) {
+      if (bits == 0) {
+        return;
+      }
+      if (bits < 64) {
+        value &= (uint64_t{1} << bits) - 1;
+      }
+      accumulator_ |= value << filled_;
+      if (filled_ + bits >= 64) {
+        std::memcpy(out_, &accumulator_, sizeof(accumulator_));
+        out_ += sizeof(accumulator_);
+        accumulator_ = filled_ == 0 ? 0 : value >> (64 - filled_);
+        filled_ = filled_ + bits - 64;
+      } else {
+        filled_ += bits;
+      }
+    }
+
+    void flush() { std::memcpy(out_, &accumulator_, (filled_ + 7) / 8); }
+
+  private:
+    char *out_;
+    uint64_t accumulator_{0};
+    int filled_{0};
+  };
+
+  class BitReader {
+  public:
+    BitReader(const char *in, std::size_t size) : in_{in}, size_{size} {}
+
+    uint64_t get(int bits) {
+      if (bits == 0) {
+        return 0;
+      }
+      const std::size_t byte = position_ / 8;
+      const int shift = position_ % 8;
+      uint64_t word = 0;
+      std::memcpy(&word, in_ + byte, std::min<std::size_t>(8, size_ - byte));
+      uint64_t value = word >> shift;
+      if (shift > 0 && bits + shift > 64) {
+        value |= (uint64_t)(uint8_t)in_[byte + 8] << (64 - shift);
+      }
+      position_ += bits;
+      return bits < 64 ? value & ((uint64_t{1} << bits) - 1) : value;
+    }
+
+  private:
+    const char *in_;
+    std::size_t size_;
+    std::size_t position_{0};
+  };
+
+  template <int Width>
+  static uint64_t load(const char *data) {
+    uint64_t value = 0;
+    std::memcpy(&value, data, Width);
+    return value;
+  }
+
+  template <int Width>
+  static void store(char *data, uint64_t value) {
+    std::memcpy(data, &value, Width);
+  }
+
+  template <int Width>
+  static int64_t signExtend(uint64_t value) {
+    const int shift = 64 - 8 * Width;
+    return shift == 0 ? (int64_t)value : (int64_t)(value << shift) >> shift;
+  }
+
+  template <int Width>
+  static std::size_t encodeValues(const char *src, std::size_t size, char *dst,
+                                  std::size_t capacity) {
+    const std::size_t count = size / Width;
+    const std::size_t tail = size % Width;
+
+    std::size_t pos = 0;
+    if (capacity < 1) {
+      return 0;
+    }
+    dst[pos++] = (char)Width;
+
+    std::size_t i = 0;
+    while (i < count) {
+      const uint64_t value = load<Width>(src + i * Width);
+      std::size_t run = 1;
+      while (i + run < count && load<Width>(src + (i + run) * Width) == value) {
+        run++;
+      }
+      if (run >= kMinRun) {
+        if (pos + 1 + Width + kMaxVarint > capacity) {
+          return 0;
+        }
+        dst[pos++] = (char)kRunTag;
+        store<Width>(dst + pos, value);
+        pos += Width;
+        pos += putVarint(dst + pos, run);
+        i += run;
+        continue;
+      }
+
+      const std::size_t length = std::min(kBlockLength, count - i);
+      int64_t values[kBlockLength];
+      int64_t min = signExtend<Width>(value);
+      int64_t max = min;
+      for (std::size_t k = 0; k < length; k++) {
+        values[k] = signExtend<Width>(load<Width>(src + (i + k) * Width));
+        min = std::min(min, values[k]);
+        max = std::max(max, values[k]);
+      }
+      const uint64_t range = (uint64_t)max - (uint64_t)min;
+      const int bits = range == 0 ? 0 : 64 - __builtin_clzll(range);
+      const std::size_t packed = (length * bits + 7) / 8;
+      if (pos + 1 + Width + packed > capacity) {
+        return 0;
+      }
+      dst[pos++] = (char)bits;
+      store<Width>(dst + pos, (uint64_t)min);
+      pos += Width;
+      BitWriter writer(dst + pos);
+      for (std::size_t k = 0; k < length; k++) {
+        writer.put((uint64_t)values[k] - (uint64_t)min, bits);
+      }
+      writer.flush();
+      pos += packed;
+      i += length;
+    }
+
+    if (pos + tail > capacity) {
+      return 0;
+    }
+    std::memcpy(dst + pos, src + count * Width, tail);
+    return pos + tail;
+  }
+
+  template <int Width>
+  static void decodeValues(const char *src, std::size_t encodedSize, char *dst,
+                           std::size_t size) {
+    const std::size_t count = size / Width;
+    const std::size_t tail = size % Width;
+
+    std::size_t pos = 1;
+    std::size_t i = 0;
+    while (i < count) {
+      if (pos + 1 + Width > encodedSize) {
+        corrupt();
+      }
+      const uint8_t tag = src[pos++];
+      const uint64_t base = load<Width>(src + pos);
+      pos += Width;
+      if (tag == kRunTag) {
+        uint64_t run = 0;
+        pos += getVarint(src + pos, encodedSize - pos, run);
+        if (run == 0 || run > count - i) {
+          corrupt();
+        }
+        for (uint64_t k = 0; k < run; k++) {
+          store<Width>(dst + (i + k) * Width, base);
+        }
+        i += run;
+        continue;
+      }
+
+      if (tag > 64) {
+        corrupt();
+      }
+      const int bits = tag;
+      const std::size_t length = std::min(kBlockLength, count - i);
+      const std::size_t packed = (length * bits + 7) / 8;
+      if (pos + packed > encodedSize) {
+        corrupt();
+      }
+      BitReader reader(src + pos, packed);
+      for (std::size_t k = 0; k < length; k++) {
+        store<Width>(dst + (i + k) * Width, base + reader.get(bits));
+      }
+      pos += packed;
+      i += length;
+    }
+
+    if (pos + tail != encodedSize) {
+      corrupt();
+    }
+    std::memcpy(dst + count * Width, src + pos, tail);
+  }
+
+  static std::size_t putVarint(char *out, uint64_t value) {
+    std::size_t length = 0;
+    while (value >= 0x80) {
+      out[length++] = (char)(value | 0x80);
+      value >>= 7;
+    }
+    out[length++] = (char)value;
+    return length;
+  }
+
+  static std::size_t getVarint(const char *in, std::size_t available,
+                               uint64_t &value) {
+    value = 0;
+    for (std::size_t length = 0; length < std::min(available, kMaxVarint);
+         length++) {
+      const uint8_t byte = in[length];
+      value |= (uint64_t)(byte & 0x7F) << (7 * length);
+      if ((byte & 0x80) == 0) {
+        return length + 1;
+      }
+    }
+    corrupt();
+  }
+
+  [[noreturn]] static void corrupt() {
+    throw std::runtime_error("codec rle: corrupt chunk");
+  }
+};
+
+constexpr std::size_t RleCodec::kBlockLength;
+constexpr std::size_t RleCodec::kMinRun;
+constexpr std::size_t RleCodec::kMaxVarint;
+constexpr uint8_t RleCodec::kRunTag;
+
+int dataWidth(const ColumnTransport &column,
+              const std::vector<int> &bufferSizes) {
+  const int rows = column.metadata.size;
+  const int bytes = bufferSizes[column.data];
+  if (rows <= 0 || bytes % rows != 0) {
+    return 1;
+  }
+  return bytes / rows;
+}
+
+}  // namespace
+
+const Codec &getCodec(CodecType type) {
+  static const NoneCodec none;
+  static const Lz4Codec lz4;
+  static const ZstdCodec zstd;
+  static const RleCodec rle;
+  switch (type) {
+    case CodecType::none:
+      return none;
+    case CodecType::lz4:
+      return lz4;
+    case CodecType::zstd:
+      return zstd;
+    case CodecType::rle:
+      return rle;
+  }
+  throw std::runtime_error("unknown codec " + std::to_string((int32_t)type));
+}
+
+CompressionOptions compressionOptionsFromString(const std::string &name) {
+  CompressionOptions options;
+  if (name == "none") {
+  } else if (name == "lz4") {
+    options.codec = CodecType::lz4;
+  } else if (name == "zstd") {
+    options.codec = CodecType::zstd;
+  } else if (name == "rle") {
+    options.bitpackFixedWidth = true;
+  } else if (name == "auto") {
+    options.codec = CodecType::lz4;
+    options.bitpackFixedWidth = true;
+  } else {
+    throw std::invalid_argument("unknown transport codec \"" + name + "\"");
+  }
+  return options;
+}
+
+void assignCodecs(std::vector<ColumnTransport> &columns,
+                  const CompressionOptions &options) {
+  for (auto &column : columns) {
+    CodecType codec = options.codec;
+    if (column.strings_data == -1 && options.bitpackFixedWidth) {
+      codec = CodecType::rle;
+    }
+    column.codec = (int32_t)codec;
+  }
+}
+
+std::vector<BufferCodec> bufferCodecs(
+    const std::vector<ColumnTransport> &columns,
+    const std::vector<int> &bufferSizes) {
+  std::vector<BufferCodec> codecs(bufferSizes.size());
+  auto assign = [&codecs](int buffer, CodecType type, int elementSize) {
+    if (buffer >= 0 && buffer < (int)codecs.size()) {
+      codecs[buffer] = BufferCodec{type, elementSize};
+    }
+  };
+  for (auto &column : columns) {
+    const CodecType type = (CodecType)column.codec;
+    if (type == CodecType::none) {
+      continue;
+    }
+    int width = 1;
+    if (type == CodecType::rle && column.data >= 0 &&
+        column.data < (int)bufferSizes.size()) {
+      width = dataWidth(column, bufferSizes);
+    }
+    assign(column.data, type, width);
+    assign(column.valid, type, 1);
+    assign(column.strings_data, type, 1);
+    assign(column.strings_offsets, type,
+           type == CodecType::rle ? (int)sizeof(int) : 1);
+    assign(column.strings_nullmask, type, 1);
+  }
+  return codecs;
+}
+
+}  // namespace io
+}  // namespace transport
+}  // namespace blazingdb
@@ -4,6 +4,8 @@
 #include <cassert>
 #include <iostream>
 #include <queue>
+#include <stdexcept>
+#include <string>
 #include <thread>
 #include <zmq.hpp>
 #include "blazingdb/transport/ColumnTransport.h"
@@ -14,28 +16,56 @@ namespace io {
 
 size_t readFromSocket(void* fileDescriptor, char* buf, size_t nbyte) {
   zmq::socket_t* socket = (zmq::socket_t*)fileDescriptor;
-  zmq::message_t msg;
-  try {
-    socket->recv(&msg);
-    memcpy(buf, msg.data(), nbyte);
-  } catch (std::exception& e) {
-    // std::cerr << e.what() << std::endl;
+  // zmq_recv writes the frame straight into the caller buffer and reports the
+  // real frame length, even when it had to truncate it
+  int received;
+  do {
+    received = zmq_recv(static_cast<void*>(*socket), buf, nbyte, 0);
+  } while (received < 0 && zmq_errno() == EINTR);
+  if (received < 0) {
+    throw zmq::error_t();
   }
-  return nbyte;
+  if (static_cast<size_t>(received) != nbyte) {
+    throw std::runtime_error("readFromSocket: expected frame of " +
+                             std::to_string(nbyte) + " bytes but received " +
+                             std::to_string(received) + " bytes");
+  }
+  return static_cast<size_t>(received);
 }
 
 size_t writeToSocket(void* fileDescriptor, char* buf, size_t nbyte, bool more) {
   zmq::socket_t* socket = (zmq::socket_t*)fileDescriptor;
-  zmq::message_t message(nbyte);
-  try {
-    memcpy(message.data(), buf, nbyte);
-    socket->send(message, more ? ZMQ_SNDMORE : 0);
-  } catch (std::exception& e) {
-    // std::cerr << e.what() << std::endl;
+  zmq::message_t message(buf, nbyte);
+  if (!socket->send(message, more ? ZMQ_SNDMORE : 0)) {
+    throw zmq::error_t();
   }
   return nbyte;
 }
 
+size_t writeToSocketZeroCopy(void* fileDescriptor, char* buf, size_t nbyte,
+                             release_function release, void* hint, bool more) {
+  zmq::socket_t* socket = (zmq::socket_t*)fileDescriptor;
+  // the message borrows buf, zmq calls release once the frame left the
+  // process (or when the message is destroyed without being sent)
+  zmq::message_t message(buf, nbyte, release, hint);
+  if (!socket->send(message, more ? ZMQ_SNDMORE : 0)) {
+    throw zmq::error_t();
+  }
+  return nbyte;
+}
+
+void discardPendingFrames(void* fileDescriptor) {
+  zmq::socket_t* socket = (zmq::socket_t*)fileDescriptor;
+  int more = 0;
+  size_t more_size = sizeof(more);
+  socket->getsockopt(ZMQ_RCVMORE, &more, &more_size);
+  while (more) {
+    zmq::message_t message;
+    socket->recv(&message);
+    socket->getsockopt(ZMQ_RCVMORE, &more, &more_size);
+  }
+}
+
 }  // namespace io
 }  // namespace transport
 }  // namespace blazingdb
@@ -0,0 +1,195 @@
+#include "blazingdb/transport/io/pinned_buffer_provider.h"
+
+#include <algorithm>
+#include <blazingdb/io/Library/Metrics/MetricsRegistry.h>
+#include <chrono>
+#include <cstdlib>
+#include <new>
+
+namespace blazingdb {
+namespace transport {
+namespace io {
+
+namespace {
+
+class MallocHostAllocator : public HostAllocator {
+public:
+  char *allocate(std::size_t size) override {
+    char *data = static_cast<char *>(std::malloc(size));
+    if (data == nullptr) {
+      throw std::bad_alloc();
+    }
+    return data;
+  }
+
+  void deallocate(char *data) override { std::free(data); }
+};
+
+// occupancy of all the pools of the process
+struct PoolMetrics {
+  Library::Metrics::Gauge &allocated;
+  Library::Metrics::Gauge &inUse;
+  Library::Metrics::Gauge &waiting;
+  Library::Metrics::Histogram &wait;
+};
+
+PoolMetrics &poolMetrics() {
+  auto &registry = Library::Metrics::MetricsRegistry::getInstance();
+  static PoolMetrics metrics{
+      registry.gauge("blazing_pinned_buffers_allocated_bytes",
+                     "Bytes of the staging buffers owned by the pools"),
+      registry.gauge("blazing_pinned_buffers_in_use_bytes",
+                     "Bytes of the staging buffers lent to callers"),
+      registry.gauge("blazing_pinned_buffer_waiters",
+                     "Callers blocked until a staging buffer is returned"),
+      registry.histogram("blazing_pinned_buffer_wait_seconds",
+                         "Time blocked for a staging buffer, by the callers "
+                         "that had to wait",
+                         {}, 1e-6)};
+  return metrics;
+}
+
+}  // namespace
+
+std::shared_ptr<HostAllocator> makeMallocHostAllocator() {
+  return std::make_shared<MallocHostAllocator>();
+}
+
+PinnedBufferProvider::PinnedBufferProvider(
+    std::size_t sizeBuffers, std::size_t numBuffers, std::size_t highWaterMark,
+    std::shared_ptr<HostAllocator> allocator)
+    : bufferSize{sizeBuffers},
+      maxBuffers{std::max<std::size_t>(
+          1, highWaterMark == 0 ? numBuffers : highWaterMark)},
+      allocator{allocator} {
+  this->counters.bufferSize = this->bufferSize;
+  this->counters.highWaterMark = this->maxBuffers;
+  numBuffers = std::min(numBuffers, this->maxBuffers);
+  for (std::size_t bufferIndex = 0; bufferIndex < numBuffers; bufferIndex++) {
+    this->grow();
+  }
+}
+
+PinnedBufferProvider::~PinnedBufferProvider() { this->freeAll(); }
+
+PinnedBuffer *PinnedBufferProvider::getBuffer() {
+  std::unique_lock<std::mutex> lock(inUseMutex);
+  auto available = [this] {
+    return !this->buffers.empty() ||
+           this->counters.allocated < this->maxBuffers;
+  };
+  if (!this->waiters.empty() || !available()) {
+    // queue up behind the callers that are already blocked
+    std::condition_variable cv;
+    this->waiters.push_back(&cv);
+    auto start = std::chrono::steady_clock::now();
+    this->counters.waiting++;
+    poolMetrics().waiting.add(1);
+    cv.wait(lock, [this, &cv, &available] {
+      return this->waiters.front() == &cv && available();
+    });
+    this->counters.waiting--;
+    poolMetrics().waiting.sub(1);
+    this->waiters.pop_front();
+    std::uint64_t waitNanos =
+        std::chrono::duration_cast<std::chrono::nanoseconds>(
+            std::chrono::steady_clock::now() - start)
+            .count();
+    this->counters.waits++;
+    this->counters.totalWaitNanos += waitNanos;
+    this->counters.maxWaitNanos =
+        std::max(this->counters.maxWaitNanos, waitNanos);
+    poolMetrics().wait.record(waitNanos / 1000);
+  }
+  if (this->buffers.empty()) {
+    try {
+      this->grow();
+    } catch (...) {
+      this->notifyNextWaiter();
+      throw;
+    }
+  }
+  PinnedBuffer *temp = this->take();
+  // more than one buffer may have been returned while we were waiting
+  this->notifyNextWaiter();
+  return temp;
+}
+
+PinnedBuffer *PinnedBufferProvider::tryGetBuffer() {
+  std::unique_lock<std::mutex> lock(inUseMutex);
+  if (!this->waiters.empty()) {
+    return nullptr;
+  }
+  if (this->buffers.empty()) {
+    if (this->counters.allocated >= this->maxBuffers) {
+      return nullptr;
+    }
+    this->grow();
+  }
+  return this->take();
+}
+
+PinnedBuffer *PinnedBufferProvider::take() {
+  PinnedBuffer *temp = this->buffers.top();
+  this->buffers.pop();
+  this->counters.acquisitions++;
+  this->counters.inUse++;
+  poolMetrics().inUse.add(this->bufferSize);
+  this->counters.peakInUse =
+      std::max(this->counters.peakInUse, this->counters.inUse);
+  return temp;
+}
+
+void PinnedBufferProvider::notifyNextWaiter() {
+  if (!this->waiters.empty()) {
+    this->waiters.front()->notify_one();
+  }
+}
+
+void PinnedBufferProvider::grow() {
+  PinnedBuffer *buffer = new PinnedBuffer();
+  buffer->size = this->bufferSize;
+  try {
+    buffer->data = this->allocator->allocate(this->bufferSize);
+  } catch (...) {
+    delete buffer;
+    throw;
+  }
+  this->buffers.push(buffer);
+  this->counters.allocated++;
+  poolMetrics().allocated.add(this->bufferSize);
+}
+
+void PinnedBufferProvider::freeBuffer(PinnedBuffer *buffer) {
+  std::unique_lock<std::mutex> lock(inUseMutex);
+  this->buffers.push(buffer);
+  this->counters.inUse--;
+  poolMetrics().inUse.sub(this->bufferSize);
+  this->notifyNextWaiter();
+}
+
+void PinnedBufferProvider::freeAll() {
+  std::unique_lock<std::mutex> lock(inUseMutex);
+  while (false == this->buffers.empty()) {
+    PinnedBuffer *buffer = this->buffers.top();
+    this->allocator->deallocate(buffer->data);
+    delete buffer;
+    this->buffers.pop();
+    this->counters.allocated--;
+    poolMetrics().allocated.sub(this->bufferSize);
+  }
+  this->notifyNextWaiter();
+}
+
+std::size_t PinnedBufferProvider::sizeBuffers() { return this->bufferSize; }
+
+std::size_t PinnedBufferProvider::highWaterMark() { return this->maxBuffers; }
+
+PinnedBufferProviderStats PinnedBufferProvider::stats() {
+  std::unique_lock<std::mutex> lock(inUseMutex);
+  return this->counters;
+}
+
+}  // namespace io
+}  // namespace transport
+}  // namespace blazingdb
@@ -1,278 +1,115 @@
 #include "blazingdb/transport/io/reader_writer.h"
 #include <cuda.h>
 #include <cuda_runtime_api.h>
+#include "blazingdb/transport/io/chunked_transfer.h"
 #include "blazingdb/transport/io/fd_reader_writer.h"
 #include "rmm/rmm.h"
 
-#include <condition_variable>
-#include <iostream>
 #include <mutex>
-#include <stack>
-#include <thread>
+#include <new>
+#include <stdexcept>
+#include <string>
 #include <vector>
 
-#include <cassert>
-#include <queue>
 #include "blazingdb/transport/ColumnTransport.h"
 
 namespace blazingdb {
 namespace transport {
 namespace io {
 
-// numBuffers should be equal to number of threads
-PinnedBufferProvider::PinnedBufferProvider(std::size_t sizeBuffers,
-                                           std::size_t numBuffers) {
-  for (int bufferIndex = 0; bufferIndex < numBuffers; bufferIndex++) {
-    PinnedBuffer *buffer = new PinnedBuffer();
-    buffer->size = sizeBuffers;
-    this->bufferSize = sizeBuffers;
-    cudaError_t err = cudaMallocManaged((void **)&buffer->data, sizeBuffers);
+namespace {
+
+class CudaHostAllocator : public HostAllocator {
+public:
+  char *allocate(std::size_t size) override {
+    char *data = nullptr;
+    cudaError_t err = cudaMallocManaged((void **)&data, size);
     if (err != cudaSuccess) {
-      throw std::exception();
+      throw std::bad_alloc();
     }
-    this->buffers.push(buffer);
+    return data;
   }
-}
 
-// TODO: consider adding some kind of priority
-// based on when the request was made
-PinnedBuffer *PinnedBufferProvider::getBuffer() {
-  std::unique_lock<std::mutex> lock(inUseMutex);
-  if (this->buffers.empty()) {
-    // cv.wait(lock, [this] { return !this->buffers.empty(); });
-    // if wait fail use:
-    this->grow();
-  }
-  PinnedBuffer *temp = this->buffers.top();
-  this->buffers.pop();
-  return temp;
-}
+  void deallocate(char *data) override { cudaFree(data); }
+};
 
-void PinnedBufferProvider::grow() {
-  PinnedBuffer *buffer = new PinnedBuffer();
-  buffer->size = this->bufferSize;
-  cudaError_t err = cudaMallocManaged((void **)&buffer->data, this->bufferSize);
-  if (err != cudaSuccess) {
-    throw std::exception();
-  }
-  this->buffers.push(buffer);
+copy_function makeCudaCopy(int gpuNum, cudaMemcpyKind kind) {
+  return [gpuNum, kind](char *dst, const char *src, std::size_t size) {
+    cudaSetDevice(gpuNum);
+    // every copy thread uses its own stream so the copies overlap
+    cudaError_t err =
+        cudaMemcpyAsync(dst, src, size, kind, cudaStreamPerThread);
+    if (err == cudaSuccess) {
+      err = cudaStreamSynchronize(cudaStreamPerThread);
+    }
+    if (err != cudaSuccess) {
+      throw std::runtime_error(std::string("transport copy failed: ") +
+                               cudaGetErrorString(err));
+    }
+  };
 }
 
-void PinnedBufferProvider::freeBuffer(PinnedBuffer *buffer) {
-  std::unique_lock<std::mutex> lock(inUseMutex);
-  this->buffers.push(buffer);
-  cv.notify_one();
-}
+}  // namespace
 
-void PinnedBufferProvider::freeAll() {
-  std::unique_lock<std::mutex> lock(inUseMutex);
-  while (false == this->buffers.empty()) {
-    PinnedBuffer *buffer = this->buffers.top();
-    cudaFree(buffer->data);
-    delete buffer;
-    this->buffers.pop();
-  }
+std::shared_ptr<HostAllocator> makeCudaHostAllocator() {
+  return std::make_shared<CudaHostAllocator>();
 }
 
-std::size_t PinnedBufferProvider::sizeBuffers() { return this->bufferSize; }
-
 static std::shared_ptr<PinnedBufferProvider> global_instance{};
 
-void setPinnedBufferProvider(std::size_t sizeBuffers, std::size_t numBuffers) {
-  global_instance =
-      std::make_shared<PinnedBufferProvider>(sizeBuffers, numBuffers);
+// numBuffers should be equal to number of threads
+void setPinnedBufferProvider(std::size_t sizeBuffers, std::size_t numBuffers,
+                             std::size_t highWaterMark) {
+  global_instance = std::make_shared<PinnedBufferProvider>(
+      sizeBuffers, numBuffers, highWaterMark, makeCudaHostAllocator());
 }
 
 PinnedBufferProvider &getPinnedBufferProvider() { return *global_instance; }
 
+static std::mutex compression_mutex;
+static CompressionOptions compression_options{};
+
+void setCompressionOptions(const CompressionOptions &options) {
+  std::lock_guard<std::mutex> lock(compression_mutex);
+  compression_options = options;
+}
+
+CompressionOptions getCompressionOptions() {
+  std::lock_guard<std::mutex> lock(compression_mutex);
+  return compression_options;
+}
+
 void writeBuffersFromGPUTCP(std::vector<ColumnTransport> &column_transport,
                             std::vector<int> bufferSizes,
                             std::vector<char *> buffers, void *fileDescriptor,
                             int gpuNum) {
-  if (bufferSizes.size() == 0) {
-    return;
-  }
-  struct queue_item {
-    std::size_t bufferIndex{};
-    std::size_t chunkIndex{};
-    PinnedBuffer *chunk{nullptr};
-    std::size_t chunk_size{};
-
-    bool operator<(const queue_item &item) const {
-      if (bufferIndex == item.bufferIndex) {
-        return chunkIndex > item.chunkIndex;
-      } else {
-        return bufferIndex > item.bufferIndex;
-      }
-    }
-
-    bool operator==(const queue_item &item) const {
-      return ((bufferIndex == item.bufferIndex) &&
-              (chunkIndex == item.chunkIndex));
-    }
-  };
-  std::vector<std::thread> writeThreads(bufferSizes.size());
-  std::priority_queue<queue_item> writePairs;
-  std::condition_variable cv;
-  std::mutex writeMutex;
-  std::vector<std::thread> allocationThreads(bufferSizes.size());
-  std::vector<char *> tempReadAllocations(bufferSizes.size());
-  std::vector<std::thread> copyThreads(bufferSizes.size());
-  std::size_t amountWrittenTotalTotal = 0;
-
-  std::vector<queue_item> writeOrder;
-  for (size_t bufferIndex = 0; bufferIndex < bufferSizes.size();
-       bufferIndex++) {
-    std::size_t amountWrittenTotal = 0;
-    size_t chunkIndex = 0;
-    do {
-      writeOrder.push_back(
-          {.bufferIndex = bufferIndex, .chunkIndex = chunkIndex});
-      amountWrittenTotal += getPinnedBufferProvider().sizeBuffers();
-      chunkIndex++;
-    } while (amountWrittenTotal < bufferSizes[bufferIndex]);
-  }
-
-  // buffer is from gpu or is from cpu
-  for (size_t bufferIndex = 0; bufferIndex < bufferSizes.size();
-       bufferIndex++) {
-    copyThreads[bufferIndex] = std::thread(
-        [bufferIndex, &cv, &amountWrittenTotalTotal, &writeMutex, &buffers,
-         &writePairs, &writeOrder, &bufferSizes, &tempReadAllocations,
-         &allocationThreads, fileDescriptor, gpuNum]() {
-          cudaSetDevice(gpuNum);
-          std::size_t amountWrittenTotal = 0;
-          size_t chunkIndex = 0;
-          do {
-            PinnedBuffer *buffer = getPinnedBufferProvider().getBuffer();
-            std::size_t amountToWrite;
-            if ((bufferSizes[bufferIndex] - amountWrittenTotal) > buffer->size)
-              amountToWrite = buffer->size;
-            else
-              amountToWrite = bufferSizes[bufferIndex] - amountWrittenTotal;
-
-            cudaSetDevice(gpuNum);
-            cudaMemcpyAsync(buffer->data,
-                            buffers[bufferIndex] + amountWrittenTotal,
-                            amountToWrite, cudaMemcpyDeviceToHost, nullptr);
-            cudaStreamSynchronize(nullptr);
-            {
-              std::unique_lock<std::mutex> lock(writeMutex);
-              writePairs.push(queue_item{.bufferIndex = bufferIndex,
-                                         .chunkIndex = chunkIndex,
-                                         .chunk = buffer,
-                                         .chunk_size = amountToWrite});
-              chunkIndex++;
-              amountWrittenTotal += amountToWrite;
-              cv.notify_one();
-            }
-          } while (amountWrittenTotal < bufferSizes[bufferIndex]);
-          {
-            std::lock_guard<std::mutex> lock(writeMutex);
-            amountWrittenTotalTotal += amountWrittenTotal;
-          }
-        });
-  }
-
-  std::thread writeThread =
-      std::thread([fileDescriptor, &writePairs, &bufferSizes, writeOrder,
-                   &writeMutex, &cv] {
-        PinnedBuffer *buffer = nullptr;
-        std::size_t amountToWrite;
-        queue_item item;
-        std::size_t writeIndex = 0;
-        bool started = false;
-        do {
-          {
-            std::unique_lock<std::mutex> lock(writeMutex);
-            cv.wait(lock, [&writePairs, &writeOrder, writeIndex] {
-              return !writePairs.empty() &&
-                     writeOrder[writeIndex] == writePairs.top();
-            });
-            item = writePairs.top();
-            amountToWrite = item.chunk_size;
-            buffer = item.chunk;
-            started = false;
-            writePairs.pop();
-          }
-
-          if (buffer != nullptr) {
-            std::lock_guard<std::mutex> lock(writeMutex);
-            std::size_t amountWritten = writeToSocket(
-                fileDescriptor, (char *)buffer->data, amountToWrite);
-            writeIndex++;
-            if (amountWritten != amountToWrite) {
-              getPinnedBufferProvider().freeBuffer(buffer);
-              throw std::exception();
-            }
-            getPinnedBufferProvider().freeBuffer(buffer);
-          }
-        } while (writeIndex < writeOrder.size());
-      });
-
-  for (std::size_t threadIndex = 0; threadIndex < writeThreads.size();
-       threadIndex++) {
-    copyThreads[threadIndex].join();
-  }
-  {
-    std::unique_lock<std::mutex> lock(writeMutex);
-    writePairs.push({.bufferIndex = INT_MAX,
-                     .chunkIndex = INT_MAX,
-                     .chunk = nullptr,
-                     .chunk_size = amountWrittenTotalTotal});
-    cv.notify_one();
-  }
-  writeThread.join();
-  PinnedBuffer *buffer = getPinnedBufferProvider().getBuffer();
-  getPinnedBufferProvider().freeBuffer(buffer);
-  getPinnedBufferProvider().freeAll();
+  const CompressionOptions compression = getCompressionOptions();
+  ChunkedTransferOptions options;
+  options.codecs = bufferCodecs(column_transport, bufferSizes);
+  options.adaptive = compression.adaptive;
+  options.max_ratio = compression.maxRatio;
+  writeBuffersChunked(bufferSizes, buffers, fileDescriptor,
+                      getPinnedBufferProvider(),
+                      makeCudaCopy(gpuNum, cudaMemcpyDeviceToHost), options);
 }
 
 std::vector<char *> readBuffersIntoGPUTCP(std::vector<int> bufferSizes,
                                           void *fileDescriptor, int gpuNum) {
-  std::vector<std::thread> allocationThreads(bufferSizes.size());
-  std::vector<std::thread> readThreads(bufferSizes.size());
   std::vector<char *> tempReadAllocations(bufferSizes.size());
   for (int bufferIndex = 0; bufferIndex < bufferSizes.size(); bufferIndex++) {
     cudaSetDevice(gpuNum);
     RMM_ALLOC(reinterpret_cast<void **>(&tempReadAllocations[bufferIndex]),
               bufferSizes[bufferIndex], 0);
   }
-  for (int bufferIndex = 0; bufferIndex < bufferSizes.size(); bufferIndex++) {
-    std::vector<std::thread> copyThreads;
-    std::size_t amountReadTotal = 0;
-    do {
-      PinnedBuffer *buffer = getPinnedBufferProvider().getBuffer();
-      std::size_t amountToRead =
-          (bufferSizes[bufferIndex] - amountReadTotal) > buffer->size
-              ? buffer->size
-              : bufferSizes[bufferIndex] - amountReadTotal;
-
-      std::size_t amountRead =
-          readFromSocket(fileDescriptor, (char *)buffer->data, amountToRead);
-
-      assert(amountRead == amountToRead);
-      if (amountRead != amountToRead) {
-        getPinnedBufferProvider().freeBuffer(buffer);
-        throw std::exception();
-      }
-      copyThreads.push_back(std::thread(
-          [&tempReadAllocations, &bufferSizes, &allocationThreads, bufferIndex,
-           buffer, amountRead, amountReadTotal, gpuNum]() {
-            cudaSetDevice(gpuNum);
-            cudaMemcpyAsync(tempReadAllocations[bufferIndex] + amountReadTotal,
-                            buffer->data, amountRead, cudaMemcpyHostToDevice,
-                            nullptr);
-            getPinnedBufferProvider().freeBuffer(buffer);
-            cudaStreamSynchronize(nullptr);
-          }));
-      amountReadTotal += amountRead;
-
-    } while (amountReadTotal < bufferSizes[bufferIndex]);
-    for (std::size_t threadIndex = 0; threadIndex < copyThreads.size();
-         threadIndex++) {
-      copyThreads[threadIndex].join();
+  try {
+    readBuffersChunked(bufferSizes, tempReadAllocations, fileDescriptor,
+                       getPinnedBufferProvider(),
+                       makeCudaCopy(gpuNum, cudaMemcpyHostToDevice));
+  } catch (...) {
+    for (char *allocation : tempReadAllocations) {
+      RMM_FREE(allocation, 0);
     }
+    throw;
   }
 
   return tempReadAllocations;
@@ -0,0 +1,208 @@
+#include <blazingdb/network/TCPSocket.h>
+#include <blazingdb/transport/BroadcastTree.h>
+#include <blazingdb/transport/io/fd_reader_writer.h>
+
+#include <gtest/gtest.h>
+#include <sys/wait.h>
+#include <unistd.h>
+#include <atomic>
+#include <chrono>
+#include <cmath>
+#include <condition_variable>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <vector>
+
+namespace blazingdb {
+namespace transport {
+
+using blazingdb::network::TCPClientSocket;
+using blazingdb::network::TCPServerSocket;
+
+namespace {
+
+int treeDepth(int num_nodes, int root, int self) {
+  int depth = 0;
+  for (int node = self; node != root;
+       node = binomialTreeParent(num_nodes, root, node)) {
+    depth++;
+  }
+  return depth;
+}
+
+void receivePayload(void *socket, std::vector<char> &payload) {
+  int64_t size = 0;
+  io::readFromSocket(socket, (char *)&size, sizeof(size));
+  payload.resize(size);
+  io::readFromSocket(socket, payload.data(), payload.size());
+  io::writeToSocket(socket, (char *)"END", 3, false);
+}
+
+void sendPayload(int port, const std::vector<char> &payload) {
+  TCPClientSocket client("localhost", port);
+  int64_t size = payload.size();
+  io::writeToSocket(client.fd(), (char *)&size, sizeof(size));
+  io::writeToSocket(client.fd(), (char *)payload.data(), payload.size(),
+                    false);
+  char reply[3];
+  io::readFromSocket(client.fd(), reply, sizeof(reply));
+  client.close();
+}
+
+// like broadcastMessage in the engine: one concurrent send per destination
+void sendToAll(int base_port, const std::vector<int> &nodes,
+               const std::vector<char> &payload) {
+  std::vector<std::thread> sends;
+  for (int node : nodes) {
+    sends.emplace_back(
+        [base_port, node, &payload] { sendPayload(base_port + node, payload); });
+  }
+  for (auto &send : sends) {
+    send.join();
+  }
+}
+
+std::vector<int> childrenOf(bool tree, int num_nodes, int self) {
+  if (tree) {
+    return binomialTreeChildren(num_nodes, 0, self);
+  }
+  std::vector<int> children;
+  for (int node = 1; self == 0 && node < num_nodes; node++) {
+    children.push_back(node);
+  }
+  return children;
+}
+
+// Body of the forked nodes: wait for the payload, relay it to the children
+// and tell the root, which listens on base_port + num_nodes.
+int runNode(bool tree, int num_nodes, int self, int base_port) {
+  std::mutex mutex;
+  std::condition_variable condition_variable;
+  bool received = false;
+  std::vector<char> payload;
+
+  TCPServerSocket server(base_port + self);
+  std::thread server_thread([&] {
+    server.run([&](void *socket) {
+      std::vector<char> data;
+      receivePayload(socket, data);
+      std::lock_guard<std::mutex> lock(mutex);
+      payload = std::move(data);
+      received = true;
+      condition_variable.notify_all();
+    });
+  });
+
+  int status = 0;
+  {
+    std::unique_lock<std::mutex> lock(mutex);
+    if (!condition_variable.wait_for(lock, std::chrono::seconds(60),
+                                     [&received] { return received; })) {
+      status = 1;
+    }
+  }
+  if (status == 0) {
+    sendToAll(base_port, childrenOf(tree, num_nodes, self), payload);
+    sendPayload(base_port + num_nodes, {});
+  }
+  server.close();
+  server_thread.join();
+  return status;
+}
+
+// Seconds from the first send of the root to the last node reporting
+double timeToAllReceived(bool tree, int num_nodes, std::size_t payload_size,
+                         int base_port) {
+  std::vector<pid_t> children;
+  for (int node = 1; node < num_nodes; node++) {
+    pid_t pid = fork();
+    if (pid == 0) {
+      _exit(runNode(tree, num_nodes, node, base_port));
+    }
+    children.push_back(pid);
+  }
+
+  std::atomic<int> acks{0};
+  TCPServerSocket ack_server(base_port + num_nodes);
+  std::thread ack_thread([&ack_server, &acks] {
+    ack_server.run([&acks](void *socket) {
+      std::vector<char> ack;
+      receivePayload(socket, ack);
+      acks++;
+    });
+  });
+
+  const std::vector<char> payload(payload_size, 7);
+  auto start = std::chrono::steady_clock::now();
+  sendToAll(base_port, childrenOf(tree, num_nodes, 0), payload);
+  while (acks < num_nodes - 1 &&
+         std::chrono::steady_clock::now() - start < std::chrono::seconds(60)) {
+    std::this_thread::sleep_for(std::chrono::microseconds(100));
+  }
+  double seconds =
+      std::chrono::duration<double>(std::chrono::steady_clock::now() - start)
+          .count();
+  EXPECT_EQ(acks, num_nodes - 1);
+
+  ack_server.close();
+  ack_thread.join();
+  for (pid_t pid : children) {
+    int status = 0;
+    waitpid(pid, &status, 0);
+    EXPECT_TRUE(WIFEXITED(status) && WEXITSTATUS(status) == 0);
+  }
+  return seconds;
+}
+
+}  // namespace
+
+TEST(BroadcastTreeTest, ReachesEveryNodeOnce) {
+  for (int num_nodes = 1; num_nodes <= 70; num_nodes++) {
+    for (int root = 0; root < num_nodes; root++) {
+      std::vector<int> reached(num_nodes, 0);
+      reached[root] = 1;
+      int max_fan_out = 0;
+      for (int node = 0; node < num_nodes; node++) {
+        auto children = binomialTreeChildren(num_nodes, root, node);
+        max_fan_out = std::max<int>(max_fan_out, children.size());
+        for (int child : children) {
+          reached[child]++;
+          EXPECT_EQ(binomialTreeParent(num_nodes, root, child), node);
+        }
+      }
+      for (int node = 0; node < num_nodes; node++) {
+        EXPECT_EQ(reached[node], 1) << num_nodes << " " << root << " " << node;
+      }
+      const int rounds = std::ceil(std::log2(num_nodes));
+      EXPECT_LE(max_fan_out, rounds);
+      for (int node = 0; node < num_nodes; node++) {
+        EXPECT_LE(treeDepth(num_nodes, root, node), rounds);
+      }
+    }
+  }
+  EXPECT_EQ(binomialTreeParent(8, 3, 3), -1);
+  EXPECT_EQ(binomialTreeChildren(8, 0, 0), (std::vector<int>{4, 2, 1}));
+  EXPECT_THROW(binomialTreeChildren(4, 0, 4), std::out_of_range);
+}
+
+// Loopback harness: every node is a process with its own server socket. The
+// time until every node received the payload is recorded as test properties.
+// Disabled, run it with --gtest_also_run_disabled_tests
+TEST(BroadcastTreeTest, DISABLED_BenchmarkTimeToAllReceivedByClusterSize) {
+  const std::size_t payload_size = 32 << 20;
+  int base_port = 18600;
+  for (int num_nodes : {2, 4, 8, 16}) {
+    for (bool tree : {false, true}) {
+      double seconds =
+          timeToAllReceived(tree, num_nodes, payload_size, base_port);
+      base_port += num_nodes + 1;
+      RecordProperty("nodes_" + std::to_string(num_nodes) +
+                         (tree ? "_tree" : "_flat") + "_seconds",
+                     std::to_string(seconds));
+    }
+  }
+}
+
+}  // namespace transport
+}  // namespace blazingdb
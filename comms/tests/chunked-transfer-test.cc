@@ -0,0 +1,268 @@
+#include <blazingdb/transport/io/chunked_transfer.h>
+#include <blazingdb/transport/io/fd_reader_writer.h>
+#include <blazingdb/transport/io/spsc_ring.h>
+
+#include <gtest/gtest.h>
+#include <atomic>
+#include <chrono>
+#include <cstring>
+#include <random>
+#include <string>
+#include <thread>
+#include <vector>
+#include <zmq.hpp>
+
+#include "utils/InprocPair.h"
+
+namespace blazingdb {
+namespace transport {
+namespace io {
+
+namespace {
+
+// host memory mode: the pipeline runs with malloc staging and memcpy copies
+const copy_function host_copy = [](char *dst, const char *src,
+                                   std::size_t size) {
+  std::memcpy(dst, src, size);
+};
+
+std::vector<std::vector<char>> makeBuffers(const std::vector<int> &sizes) {
+  std::mt19937 generator(sizes.size());
+  std::vector<std::vector<char>> buffers;
+  for (int size : sizes) {
+    std::vector<char> buffer(size);
+    for (auto &value : buffer) {
+      value = static_cast<char>(generator());
+    }
+    buffers.push_back(std::move(buffer));
+  }
+  return buffers;
+}
+
+std::vector<char *> pointers(std::vector<std::vector<char>> &buffers) {
+  std::vector<char *> result;
+  for (auto &buffer : buffers) {
+    result.push_back(buffer.data());
+  }
+  return result;
+}
+
+// returns the seconds spent between the first chunk and the trailing frame
+double transfer(InprocPair &pair, const std::vector<int> &sizes,
+                PinnedBufferProvider &send_provider,
+                PinnedBufferProvider &receive_provider,
+                const ChunkedTransferOptions &options) {
+  auto sent = makeBuffers(sizes);
+  std::vector<std::vector<char>> received;
+  for (int size : sizes) {
+    received.emplace_back(size);
+  }
+
+  auto start = std::chrono::steady_clock::now();
+  std::thread reader([&] {
+    readBuffersChunked(sizes, pointers(received), (void *)&pair.receiver,
+                       receive_provider, host_copy, options);
+  });
+  writeBuffersChunked(sizes, pointers(sent), (void *)&pair.sender,
+                      send_provider, host_copy, options);
+  writeToSocket((void *)&pair.sender, (char *)"OK", 2, false);
+  reader.join();
+  char ok[2];
+  readFromSocket((void *)&pair.receiver, ok, sizeof(ok));
+  double seconds =
+      std::chrono::duration<double>(std::chrono::steady_clock::now() - start)
+          .count();
+
+  EXPECT_EQ(received, sent);
+  return seconds;
+}
+
+}  // namespace
+
+TEST(SpscRingTest, KeepsOrderAndCapacity) {
+  SpscRing<int> ring(3);
+  for (int i = 0; i < 3; i++) {
+    EXPECT_TRUE(ring.try_push(i));
+  }
+  int value = 3;
+  EXPECT_FALSE(ring.try_push(value));
+  for (int i = 0; i < 3; i++) {
+    EXPECT_TRUE(ring.try_pop(value));
+    EXPECT_EQ(value, i);
+  }
+  EXPECT_FALSE(ring.try_pop(value));
+  EXPECT_TRUE(ring.empty());
+}
+
+TEST(SpscRingTest, TransfersAcrossThreads) {
+  SpscRing<std::size_t> ring(8);
+  const std::size_t count = 100000;
+  std::thread producer([&ring, count] {
+    for (std::size_t i = 0; i < count; i++) {
+      std::size_t value = i;
+      while (!ring.try_push(value)) {
+        std::this_thread::yield();
+      }
+    }
+  });
+  for (std::size_t i = 0; i < count; i++) {
+    std::size_t value;
+    while (!ring.try_pop(value)) {
+      std::this_thread::yield();
+    }
+    ASSERT_EQ(value, i);
+  }
+  producer.join();
+}
+
+TEST(ChunkedTransferTest, ReassemblesBuffersOfAnySize) {
+  InprocPair pair("chunked-reassemble");
+  PinnedBufferProvider send_provider(1000, 2, 4, makeMallocHostAllocator());
+  PinnedBufferProvider receive_provider(1000, 2, 4, makeMallocHostAllocator());
+  ChunkedTransferOptions options;
+  options.copy_threads = 3;
+  options.ring_capacity = 2;
+
+  transfer(pair, {0, 1, 999, 1000, 1001, 25000, 0, 7}, send_provider,
+           receive_provider, options);
+  EXPECT_EQ(send_provider.stats().inUse, 0);
+  EXPECT_EQ(receive_provider.stats().inUse, 0);
+}
+
+TEST(ChunkedTransferTest, WorksWithSingleStagingBuffer) {
+  InprocPair pair("chunked-single-buffer");
+  PinnedBufferProvider send_provider(64, 1, 1, makeMallocHostAllocator());
+  PinnedBufferProvider receive_provider(64, 1, 1, makeMallocHostAllocator());
+
+  // the chunks lent to zmq only come back once "OK" is sent, the others are
+  // staged without waiting for the staging buffer
+  transfer(pair, {4096, 100, 3}, send_provider, receive_provider,
+           ChunkedTransferOptions{});
+  EXPECT_EQ(send_provider.stats().inUse, 0);
+  EXPECT_EQ(send_provider.stats().waits, 0);
+  EXPECT_EQ(receive_provider.stats().inUse, 0);
+}
+
+TEST(ChunkedTransferTest, BoundsHostStagingAcrossTransfers) {
+  InprocPair first("chunked-budget-first");
+  InprocPair second("chunked-budget-second");
+  PinnedBufferProvider first_provider(64, 1, 1, makeMallocHostAllocator());
+  PinnedBufferProvider second_provider(64, 1, 1, makeMallocHostAllocator());
+  PinnedBufferProvider first_receive_provider(64, 1, 1,
+                                              makeMallocHostAllocator());
+  PinnedBufferProvider second_receive_provider(64, 1, 1,
+                                               makeMallocHostAllocator());
+  ChunkedTransferOptions options;
+  options.max_host_staging_bytes = 100;
+
+  // the first transfer goes over the limit, it can not wait for its own chunks
+  std::vector<int> sizes = {1024};
+  auto first_sent = makeBuffers(sizes);
+  std::vector<std::vector<char>> first_received = {std::vector<char>(1024)};
+  std::thread first_reader([&] {
+    readBuffersChunked(sizes, pointers(first_received),
+                       (void *)&first.receiver, first_receive_provider,
+                       host_copy, options);
+  });
+  writeBuffersChunked(sizes, pointers(first_sent), (void *)&first.sender,
+                      first_provider, host_copy, options);
+  EXPECT_EQ(hostStagingBytesInUse(), 1024u - 64u);
+
+  // the second one waits until the first message is sent
+  std::atomic<bool> second_done{false};
+  std::thread second_sender([&] {
+    transfer(second, {1024}, second_provider, second_receive_provider,
+             options);
+    second_done = true;
+  });
+  std::this_thread::sleep_for(std::chrono::milliseconds(50));
+  EXPECT_FALSE(second_done);
+  writeToSocket((void *)&first.sender, (char *)"OK", 2, false);
+  first_reader.join();
+  char ok[2];
+  readFromSocket((void *)&first.receiver, ok, sizeof(ok));
+  second_sender.join();
+  EXPECT_TRUE(second_done);
+  EXPECT_EQ(first_received, first_sent);
+  EXPECT_EQ(hostStagingBytesInUse(), 0u);
+}
+
+TEST(ChunkedTransferTest, ReceiverAcceptsChunksBiggerThanItsBuffers) {
+  InprocPair pair("chunked-bigger-chunks");
+  PinnedBufferProvider send_provider(4096, 2, 2, makeMallocHostAllocator());
+  PinnedBufferProvider receive_provider(100, 1, 1, makeMallocHostAllocator());
+
+  transfer(pair, {10000, 50}, send_provider, receive_provider,
+           ChunkedTransferOptions{});
+}
+
+TEST(ChunkedTransferTest, SendsCompressedAndRawChunks) {
+  InprocPair pair("chunked-compressed");
+  PinnedBufferProvider send_provider(1000, 1, 2, makeMallocHostAllocator());
+  PinnedBufferProvider receive_provider(1000, 1, 2, makeMallocHostAllocator());
+  ChunkedTransferOptions options;
+  options.codecs = {BufferCodec{CodecType::lz4, 1},
+                    BufferCodec{CodecType::lz4, 1}};
+
+  // the zeros compress, the random bytes are sent raw
+  std::vector<std::vector<char>> sent = {std::vector<char>(5000, 0),
+                                         makeBuffers({5000})[0]};
+  std::vector<std::vector<char>> received(2, std::vector<char>(5000));
+  std::thread reader([&] {
+    readBuffersChunked({5000, 5000}, pointers(received),
+                       (void *)&pair.receiver, receive_provider, host_copy,
+                       options);
+  });
+  writeBuffersChunked({5000, 5000}, pointers(sent), (void *)&pair.sender,
+                      send_provider, host_copy, options);
+  writeToSocket((void *)&pair.sender, (char *)"OK", 2, false);
+  reader.join();
+  char ok[2];
+  readFromSocket((void *)&pair.receiver, ok, sizeof(ok));
+
+  EXPECT_EQ(received, sent);
+  EXPECT_EQ(send_provider.stats().inUse, 0);
+  EXPECT_EQ(receive_provider.stats().inUse, 0);
+}
+
+TEST(ChunkedTransferTest, RejectsMalformedHeader) {
+  InprocPair pair("chunked-malformed");
+  PinnedBufferProvider provider(64, 1, 1, makeMallocHostAllocator());
+
+  ChunkHeader header;
+  header.buffer_index = 0;
+  header.offset = 60;
+  header.size = 10;
+  char payload[10] = {};
+  writeToSocket((void *)&pair.sender, (char *)&header, sizeof(header));
+  writeToSocket((void *)&pair.sender, payload, sizeof(payload), false);
+
+  std::vector<char> destination(64);
+  std::vector<char *> destinations = {destination.data()};
+  EXPECT_THROW(readBuffersChunked({64}, destinations, (void *)&pair.receiver,
+                                  provider, host_copy),
+               std::runtime_error);
+  EXPECT_EQ(provider.stats().inUse, 0);
+}
+
+// Transfer bandwidth by chunk size, recorded as test properties. Disabled,
+// run it with --gtest_also_run_disabled_tests
+TEST(ChunkedTransferTest, DISABLED_BenchmarkThroughputByChunkSize) {
+  const std::vector<int> sizes(8, 16 << 20);  // 128 MiB per run
+  for (std::size_t chunk_size : {64 << 10, 256 << 10, 1 << 20, 4 << 20}) {
+    InprocPair pair("chunked-benchmark-" + std::to_string(chunk_size));
+    PinnedBufferProvider send_provider(chunk_size, 4, 8,
+                                       makeMallocHostAllocator());
+    PinnedBufferProvider receive_provider(chunk_size, 4, 8,
+                                          makeMallocHostAllocator());
+
+    double seconds = transfer(pair, sizes, send_provider, receive_provider,
+                              ChunkedTransferOptions{});
+    RecordProperty("chunk_size_" + std::to_string(chunk_size) + "_mib_per_s",
+                   std::to_string(8.0 * 16 / seconds));
+  }
+}
+
+}  // namespace io
+}  // namespace transport
+}  // namespace blazingdb
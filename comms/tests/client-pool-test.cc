@@ -0,0 +1,181 @@
+#include <blazingdb/network/TCPSocket.h>
+#include <blazingdb/transport/ClientPool.h>
+#include <blazingdb/transport/io/fd_reader_writer.h>
+
+#include <gtest/gtest.h>
+#include <atomic>
+#include <cerrno>
+#include <chrono>
+#include <thread>
+#include <zmq.hpp>
+
+namespace blazingdb {
+namespace transport {
+
+using blazingdb::transport::io::readFromSocket;
+using blazingdb::transport::io::writeToSocket;
+
+namespace {
+
+struct EchoServer {
+  EchoServer(int port) : socket{port, 2} {
+    thread = std::thread([this] {
+      socket.run([](void *fd) {
+        try {
+          int32_t value;
+          readFromSocket(fd, (char *)&value, sizeof(value));
+          writeToSocket(fd, (char *)&value, sizeof(value), false);
+        } catch (const std::exception &) {
+        }
+      });
+    });
+  }
+
+  ~EchoServer() {
+    socket.close();
+    thread.join();
+  }
+
+  blazingdb::network::TCPServerSocket socket;
+  std::thread thread;
+};
+
+// answers like EchoServer but only after delay
+struct SlowServer {
+  SlowServer(int port, std::chrono::milliseconds delay) : socket{port, 1} {
+    thread = std::thread([this, delay] {
+      socket.run([delay](void *fd) {
+        try {
+          int32_t value;
+          readFromSocket(fd, (char *)&value, sizeof(value));
+          std::this_thread::sleep_for(delay);
+          writeToSocket(fd, (char *)&value, sizeof(value), false);
+        } catch (const std::exception &) {
+        }
+      });
+    });
+  }
+
+  ~SlowServer() {
+    socket.close();
+    thread.join();
+  }
+
+  blazingdb::network::TCPServerSocket socket;
+  std::thread thread;
+};
+
+int32_t echo(ClientPool::Connection &connection, int32_t value) {
+  writeToSocket(connection.fd(), (char *)&value, sizeof(value), false);
+  int32_t reply = 0;
+  readFromSocket(connection.fd(), (char *)&reply, sizeof(reply));
+  return reply;
+}
+
+}  // namespace
+
+TEST(ClientPoolTest, ReusesConnectionsPerPeer) {
+  EchoServer server(18531);
+  ClientPool pool;
+
+  for (int32_t i = 0; i < 10; i++) {
+    auto connection = pool.acquire("localhost", 18531);
+    EXPECT_EQ(echo(*connection, i), i);
+  }
+
+  ClientPool::Stats stats = pool.stats();
+  EXPECT_EQ(stats.connections_created, 1);
+  EXPECT_EQ(stats.connections_reused, 9);
+}
+
+TEST(ClientPoolTest, BrokenConnectionsAreNotReused) {
+  EchoServer server(18532);
+  ClientPool pool;
+  {
+    auto connection = pool.acquire("localhost", 18532);
+    connection->markBroken();
+  }
+  auto connection = pool.acquire("localhost", 18532);
+  EXPECT_EQ(echo(*connection, 7), 7);
+
+  ClientPool::Stats stats = pool.stats();
+  EXPECT_EQ(stats.connections_created, 2);
+  EXPECT_EQ(stats.connections_discarded, 1);
+}
+
+TEST(ClientPoolTest, ExpiresIdleConnections) {
+  EchoServer server(18533);
+  ClientPool pool;
+  ClientPool::Options options;
+  options.max_idle_time = std::chrono::milliseconds(10);
+  pool.setOptions(options);
+
+  pool.acquire("localhost", 18533);
+  std::this_thread::sleep_for(std::chrono::milliseconds(30));
+  pool.acquire("localhost", 18533);
+
+  EXPECT_EQ(pool.stats().connections_created, 2);
+  EXPECT_EQ(pool.stats().connections_reused, 0);
+}
+
+TEST(ClientPoolTest, BoundsSendsPerPeer) {
+  EchoServer server(18534);
+  ClientPool pool;
+  ClientPool::Options options;
+  options.max_sends_per_peer = 1;
+  pool.setOptions(options);
+
+  auto first = pool.acquire("localhost", 18534);
+  std::atomic<bool> acquired{false};
+  std::thread second([&pool, &acquired] {
+    auto connection = pool.acquire("localhost", 18534);
+    acquired = true;
+  });
+  std::this_thread::sleep_for(std::chrono::milliseconds(50));
+  EXPECT_FALSE(acquired);
+  first.reset();
+  second.join();
+  EXPECT_TRUE(acquired);
+  EXPECT_EQ(pool.stats().waits, 1);
+}
+
+TEST(ClientPoolTest, ReplyTimeoutFailsTheExchange) {
+  SlowServer server(18536, std::chrono::milliseconds(200));
+  ClientPool pool;
+  ClientPool::Options options;
+  options.receive_timeout = std::chrono::milliseconds(20);
+  pool.setOptions(options);
+
+  {
+    auto connection = pool.acquire("localhost", 18536);
+    try {
+      echo(*connection, 7);
+      FAIL() << "the reply arrived before the timeout";
+    } catch (const zmq::error_t &e) {
+      EXPECT_EQ(e.num(), EAGAIN);
+      connection->markBroken();
+    }
+  }
+  EXPECT_EQ(pool.stats().connections_discarded, 1);
+}
+
+TEST(ClientPoolTest, SendAsyncRunsOnSenderThreads) {
+  EchoServer server(18535);
+  ClientPool pool;
+
+  std::vector<std::future<Status>> sends;
+  for (int32_t i = 0; i < 32; i++) {
+    sends.push_back(pool.sendAsync([&pool, i] {
+      auto connection = pool.acquire("localhost", 18535);
+      return Status{echo(*connection, i) == i};
+    }));
+  }
+  for (auto &send : sends) {
+    EXPECT_TRUE(send.get().IsOk());
+  }
+  EXPECT_LE(pool.stats().connections_created,
+            (std::uint64_t)pool.options().max_sends_per_peer);
+}
+
+}  // namespace transport
+}  // namespace blazingdb
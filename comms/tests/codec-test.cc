@@ -0,0 +1,297 @@
+#include <blazingdb/transport/io/chunked_transfer.h>
+#include <blazingdb/transport/io/codec.h>
+#include <blazingdb/transport/io/fd_reader_writer.h>
+
+#include <gtest/gtest.h>
+#include <chrono>
+#include <cstring>
+#include <random>
+#include <string>
+#include <thread>
+#include <vector>
+#include <zmq.hpp>
+
+namespace blazingdb {
+namespace transport {
+namespace io {
+
+namespace {
+
+const std::vector<CodecType> all_codecs = {CodecType::none, CodecType::lz4,
+                                           CodecType::zstd, CodecType::rle};
+
+template <typename T>
+std::vector<char> asBytes(const std::vector<T> &values) {
+  std::vector<char> bytes(values.size() * sizeof(T));
+  std::memcpy(bytes.data(), values.data(), bytes.size());
+  return bytes;
+}
+
+// synthetic shuffle buffers, like the ones GetRawColumns produces
+std::vector<char> lowCardinalityKeys(std::size_t rows) {
+  std::mt19937 generator(1);
+  std::vector<int32_t> keys(rows);
+  for (auto &key : keys) {
+    key = 1000 + generator() % 50;
+  }
+  return asBytes(keys);
+}
+
+std::vector<char> sortedKeys(std::size_t rows) {
+  std::vector<int64_t> keys(rows);
+  for (std::size_t i = 0; i < rows; i++) {
+    keys[i] = -5000 + (int64_t)(i / 300);
+  }
+  return asBytes(keys);
+}
+
+std::vector<char> stringOffsets(std::size_t rows) {
+  std::mt19937 generator(2);
+  std::vector<int32_t> offsets(rows + 1);
+  for (std::size_t i = 1; i <= rows; i++) {
+    offsets[i] = offsets[i - 1] + 3 + generator() % 12;
+  }
+  return asBytes(offsets);
+}
+
+std::vector<char> dictionaryStrings(std::size_t size) {
+  const std::vector<std::string> words = {"ASIA", "EUROPE", "AFRICA",
+                                          "AMERICA", "MIDDLE EAST"};
+  std::mt19937 generator(3);
+  std::vector<char> chars;
+  while (chars.size() < size) {
+    const std::string &word = words[generator() % words.size()];
+    chars.insert(chars.end(), word.begin(), word.end());
+  }
+  chars.resize(size);
+  return chars;
+}
+
+std::vector<char> randomBytes(std::size_t size) {
+  std::mt19937 generator(4);
+  std::vector<char> bytes(size);
+  for (auto &byte : bytes) {
+    byte = (char)generator();
+  }
+  return bytes;
+}
+
+std::size_t roundTrip(CodecType type, const std::vector<char> &input,
+                      int elementSize) {
+  const Codec &codec = getCodec(type);
+  std::vector<char> encoded(input.size() * 2 + 64);
+  std::size_t encodedSize = codec.encode(input.data(), input.size(),
+                                         encoded.data(), encoded.size(),
+                                         elementSize);
+  EXPECT_GT(encodedSize + input.empty(), 0u);
+  std::vector<char> decoded(input.size());
+  codec.decode(encoded.data(), encodedSize, decoded.data(), decoded.size());
+  EXPECT_EQ(decoded, input);
+  return encodedSize;
+}
+
+}  // namespace
+
+TEST(CodecTest, RoundTripsEveryCodec) {
+  const std::vector<std::vector<char>> inputs = {
+      {},
+      {7},
+      lowCardinalityKeys(1000),
+      sortedKeys(777),
+      stringOffsets(333),
+      dictionaryStrings(4099),
+      randomBytes(1001)};
+  for (CodecType type : all_codecs) {
+    for (const auto &input : inputs) {
+      for (int elementSize : {1, 2, 4, 8}) {
+        roundTrip(type, input, elementSize);
+      }
+    }
+  }
+}
+
+TEST(CodecTest, RlePacksIntegerEdgeCases) {
+  std::vector<int64_t> values = {INT64_MIN, INT64_MAX, 0, -1, 1};
+  values.insert(values.end(), 1000, 42);
+  for (int i = 0; i < 300; i++) {
+    values.push_back(i % 2 ? -i : i);
+  }
+  roundTrip(CodecType::rle, asBytes(values), 8);
+
+  std::vector<uint8_t> bytes;
+  for (int i = 0; i < 1000; i++) {
+    bytes.push_back(i % 256);
+  }
+  roundTrip(CodecType::rle, asBytes(bytes), 1);
+}
+
+TEST(CodecTest, RleShrinksIntegerColumns) {
+  auto keys = lowCardinalityKeys(100000);
+  EXPECT_LT(roundTrip(CodecType::rle, keys, 4), keys.size() / 4);
+
+  auto sorted = sortedKeys(100000);
+  EXPECT_LT(roundTrip(CodecType::rle, sorted, 8), sorted.size() / 50);
+}
+
+TEST(CodecTest, EncodeReportsWhenOutputDoesNotFit) {
+  auto input = randomBytes(4096);
+  std::vector<char> encoded(input.size());
+  for (CodecType type : all_codecs) {
+    EXPECT_EQ(getCodec(type).encode(input.data(), input.size(),
+                                    encoded.data(), input.size() / 2, 4),
+              0u);
+  }
+}
+
+TEST(CodecTest, DecodeRejectsCorruptChunks) {
+  auto input = lowCardinalityKeys(1000);
+  for (CodecType type :
+       {CodecType::lz4, CodecType::zstd, CodecType::rle}) {
+    const Codec &codec = getCodec(type);
+    std::vector<char> encoded(input.size() * 2);
+    std::size_t encodedSize = codec.encode(input.data(), input.size(),
+                                           encoded.data(), encoded.size(), 4);
+    std::vector<char> decoded(input.size());
+    EXPECT_THROW(codec.decode(encoded.data(), encodedSize / 2, decoded.data(),
+                              decoded.size()),
+                 std::runtime_error);
+    EXPECT_THROW(codec.decode(encoded.data(), encodedSize, decoded.data(),
+                              decoded.size() - 1),
+                 std::runtime_error);
+  }
+  EXPECT_THROW(getCodec((CodecType)99), std::runtime_error);
+}
+
+TEST(CodecTest, AssignsCodecsByColumnKind) {
+  ColumnTransport fixed{};
+  fixed.metadata.size = 10;
+  fixed.data = 0;
+  fixed.valid = 1;
+  fixed.strings_data = fixed.strings_offsets = fixed.strings_nullmask = -1;
+  ColumnTransport strings{};
+  strings.metadata.size = 10;
+  strings.data = strings.valid = strings.strings_nullmask = -1;
+  strings.strings_data = 2;
+  strings.strings_offsets = 3;
+  std::vector<ColumnTransport> columns = {fixed, strings};
+
+  assignCodecs(columns, compressionOptionsFromString("auto"));
+  EXPECT_EQ(columns[0].codec, (int32_t)CodecType::rle);
+  EXPECT_EQ(columns[1].codec, (int32_t)CodecType::lz4);
+
+  auto codecs = bufferCodecs(columns, {80, 2, 100, 44});
+  ASSERT_EQ(codecs.size(), 4u);
+  EXPECT_EQ(codecs[0].type, CodecType::rle);
+  EXPECT_EQ(codecs[0].elementSize, 8);
+  EXPECT_EQ(codecs[1].elementSize, 1);
+  EXPECT_EQ(codecs[2].type, CodecType::lz4);
+  EXPECT_EQ(codecs[3].type, CodecType::lz4);
+
+  assignCodecs(columns, compressionOptionsFromString("none"));
+  for (auto &codec : bufferCodecs(columns, {80, 2, 100, 44})) {
+    EXPECT_EQ(codec.type, CodecType::none);
+  }
+  EXPECT_THROW(compressionOptionsFromString("gzip"), std::invalid_argument);
+}
+
+TEST(CodecTest, ChunkedTransferCompressesAndSkipsPoorChunks) {
+  zmq::context_t context(1);
+  zmq::socket_t sender(context, ZMQ_PAIR);
+  zmq::socket_t receiver(context, ZMQ_PAIR);
+  receiver.bind("inproc://codec-chunked");
+  sender.connect("inproc://codec-chunked");
+
+  std::vector<std::vector<char>> sent = {lowCardinalityKeys(10000),
+                                         randomBytes(30000),
+                                         dictionaryStrings(20000)};
+  std::vector<int> sizes;
+  std::vector<char *> sources;
+  std::vector<std::vector<char>> received;
+  std::vector<char *> destinations;
+  for (auto &buffer : sent) {
+    sizes.push_back(buffer.size());
+    sources.push_back(buffer.data());
+    received.emplace_back(buffer.size());
+    destinations.push_back(received.back().data());
+  }
+  auto copy = [](char *dst, const char *src, std::size_t size) {
+    std::memcpy(dst, src, size);
+  };
+
+  ChunkedTransferOptions options;
+  options.codecs = {BufferCodec{CodecType::rle, 4},
+                    BufferCodec{CodecType::lz4, 1},
+                    BufferCodec{CodecType::zstd, 1}};
+  PinnedBufferProvider send_provider(4096, 2, 4, makeMallocHostAllocator());
+  PinnedBufferProvider receive_provider(4096, 2, 4, makeMallocHostAllocator());
+  std::thread reader([&] {
+    readBuffersChunked(sizes, destinations, (void *)&receiver,
+                       receive_provider, copy, options);
+  });
+  writeBuffersChunked(sizes, sources, (void *)&sender, send_provider, copy,
+                      options);
+  // the last frame sends the message and returns the lent staging buffers
+  writeToSocket((void *)&sender, (char *)"OK", 2, false);
+  reader.join();
+  char ok[2];
+  readFromSocket((void *)&receiver, ok, sizeof(ok));
+  EXPECT_EQ(send_provider.stats().inUse, 0);
+  EXPECT_EQ(received, sent);
+}
+
+// Ratio and encode/decode bandwidth of every codec on synthetic columns,
+// recorded as test properties. Disabled, run it with
+// --gtest_also_run_disabled_tests
+TEST(CodecTest, DISABLED_BenchmarkSyntheticColumns) {
+  const std::size_t rows = 4 << 20;
+  struct Input {
+    std::string name;
+    std::vector<char> data;
+    int elementSize;
+  };
+  const std::vector<Input> inputs = {
+      {"int32_low_cardinality", lowCardinalityKeys(rows), 4},
+      {"int64_sorted", sortedKeys(rows), 8},
+      {"string_offsets", stringOffsets(rows), 4},
+      {"dictionary_strings", dictionaryStrings(rows * 4), 1},
+      {"random", randomBytes(rows * 4), 1}};
+  const std::size_t chunk = 1 << 20;
+
+  for (const auto &input : inputs) {
+    for (CodecType type : all_codecs) {
+      const Codec &codec = getCodec(type);
+      std::vector<char> encoded(chunk * 2);
+      std::vector<char> decoded(chunk);
+      std::size_t encodedTotal = 0;
+      double encodeSeconds = 0;
+      double decodeSeconds = 0;
+      for (std::size_t offset = 0; offset < input.data.size();
+           offset += chunk) {
+        const std::size_t size = std::min(chunk, input.data.size() - offset);
+        auto start = std::chrono::steady_clock::now();
+        std::size_t encodedSize =
+            codec.encode(input.data.data() + offset, size, encoded.data(),
+                         encoded.size(), input.elementSize);
+        auto middle = std::chrono::steady_clock::now();
+        codec.decode(encoded.data(), encodedSize, decoded.data(), size);
+        auto end = std::chrono::steady_clock::now();
+        encodeSeconds += std::chrono::duration<double>(middle - start).count();
+        decodeSeconds += std::chrono::duration<double>(end - middle).count();
+        encodedTotal += encodedSize;
+      }
+      const double mib = input.data.size() / double(1 << 20);
+      const std::string prefix =
+          input.name + "_codec_" + std::to_string((int)type) + "_";
+      RecordProperty(prefix + "ratio",
+                     std::to_string(double(encodedTotal) / input.data.size()));
+      RecordProperty(prefix + "encode_mib_per_s",
+                     std::to_string(mib / encodeSeconds));
+      RecordProperty(prefix + "decode_mib_per_s",
+                     std::to_string(mib / decodeSeconds));
+    }
+  }
+}
+
+}  // namespace io
+}  // namespace transport
+}  // namespace blazingdb
@@ -0,0 +1,115 @@
+#include <blazingdb/transport/MessageQueue.h>
+
+#include <gtest/gtest.h>
+#include <chrono>
+#include <string>
+#include <thread>
+#include <vector>
+
+namespace blazingdb {
+namespace transport {
+
+namespace {
+
+class TokenMessage : public GPUMessage {
+public:
+  TokenMessage(const std::string &messageToken, std::shared_ptr<Node> &node)
+      : GPUMessage(messageToken, 0, node) {}
+
+  raw_buffer GetRawColumns() override { return raw_buffer{}; }
+};
+
+std::shared_ptr<GPUMessage> makeMessage(const std::string &messageToken) {
+  static std::shared_ptr<Node> node =
+      Node::Make(Address::TCP("1.2.3.4", 9999, 1234));
+  return std::make_shared<TokenMessage>(messageToken, node);
+}
+
+}  // namespace
+
+TEST(MessageQueueTest, ReturnsMessagesPerTokenInArrivalOrder) {
+  MessageQueue queue;
+  std::vector<std::shared_ptr<GPUMessage>> messages = {
+      makeMessage("a"), makeMessage("b"), makeMessage("a")};
+  for (auto &message : messages) {
+    queue.putMessage(message);
+  }
+  EXPECT_EQ(queue.size(), 3);
+
+  EXPECT_EQ(queue.getMessage("a"), messages[0]);
+  EXPECT_EQ(queue.getMessage("a"), messages[2]);
+  EXPECT_EQ(queue.getMessage("b"), messages[1]);
+  EXPECT_EQ(queue.size(), 0);
+}
+
+TEST(MessageQueueTest, WakesTheWaiterOfEachToken) {
+  MessageQueue queue;
+  const int ntokens = 8;
+  std::vector<std::shared_ptr<GPUMessage>> received(ntokens);
+  std::vector<std::thread> waiters;
+  for (int i = 0; i < ntokens; i++) {
+    waiters.emplace_back([&queue, &received, i] {
+      received[i] = queue.getMessage("token_" + std::to_string(i));
+    });
+  }
+  for (int i = ntokens - 1; i >= 0; i--) {
+    auto message = makeMessage("token_" + std::to_string(i));
+    queue.putMessage(message);
+  }
+  for (auto &waiter : waiters) {
+    waiter.join();
+  }
+  for (int i = 0; i < ntokens; i++) {
+    ASSERT_NE(received[i], nullptr);
+    EXPECT_EQ(received[i]->getMessageTokenValue(),
+              "token_" + std::to_string(i));
+  }
+}
+
+TEST(MessageQueueTest, TimedWaitReturnsNullWhenNothingArrives) {
+  MessageQueue queue;
+  auto other = makeMessage("other");
+  queue.putMessage(other);
+
+  auto start = std::chrono::steady_clock::now();
+  EXPECT_EQ(queue.getMessage("missing", std::chrono::milliseconds(20)),
+            nullptr);
+  EXPECT_GE(std::chrono::steady_clock::now() - start,
+            std::chrono::milliseconds(20));
+  EXPECT_EQ(queue.getMessage("other", std::chrono::milliseconds(20)), other);
+}
+
+// Messages per second by the number of queued messages, recorded as test
+// properties. Disabled, run it with --gtest_also_run_disabled_tests
+TEST(MessageQueueTest, DISABLED_BenchmarkThroughputByQueuedMessages) {
+  for (std::size_t queued : {1000, 10000, 100000}) {
+    MessageQueue queue;
+    std::vector<std::shared_ptr<GPUMessage>> messages;
+    messages.reserve(queued);
+    for (std::size_t i = 0; i < queued; i++) {
+      messages.push_back(makeMessage("partition_" + std::to_string(i)));
+    }
+
+    auto start = std::chrono::steady_clock::now();
+    std::thread consumer([&queue, queued] {
+      // consume in reverse so a linear scan would walk the whole queue
+      for (std::size_t i = queued; i > 0; i--) {
+        queue.getMessage("partition_" + std::to_string(i - 1));
+      }
+    });
+    for (auto &message : messages) {
+      queue.putMessage(message);
+    }
+    consumer.join();
+    double seconds = std::chrono::duration<double>(
+                         std::chrono::steady_clock::now() - start)
+                         .count();
+
+    EXPECT_EQ(queue.size(), 0);
+    RecordProperty("queued_" + std::to_string(queued) + "_messages_per_s",
+                   std::to_string(queued / seconds));
+  }
+}
+
+}  // namespace transport
+}  // namespace blazingdb
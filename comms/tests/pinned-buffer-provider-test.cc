@@ -0,0 +1,166 @@
+#include <blazingdb/transport/io/pinned_buffer_provider.h>
+
+#include <gtest/gtest.h>
+#include <atomic>
+#include <chrono>
+#include <cstring>
+#include <string>
+#include <thread>
+#include <vector>
+
+namespace blazingdb {
+namespace transport {
+namespace io {
+
+TEST(PinnedBufferProviderTest, GrowsLazilyUpToHighWaterMark) {
+  PinnedBufferProvider provider(1024, 1, 3, makeMallocHostAllocator());
+  EXPECT_EQ(provider.stats().allocated, 1);
+
+  std::vector<PinnedBuffer *> buffers;
+  for (int i = 0; i < 3; i++) {
+    buffers.push_back(provider.getBuffer());
+    EXPECT_EQ(buffers.back()->size, 1024);
+    std::memset(buffers.back()->data, i, buffers.back()->size);
+  }
+
+  PinnedBufferProviderStats stats = provider.stats();
+  EXPECT_EQ(stats.allocated, 3);
+  EXPECT_EQ(stats.inUse, 3);
+  EXPECT_EQ(stats.peakInUse, 3);
+  EXPECT_EQ(stats.waits, 0);
+
+  for (auto buffer : buffers) {
+    provider.freeBuffer(buffer);
+  }
+  EXPECT_EQ(provider.stats().inUse, 0);
+  EXPECT_EQ(provider.stats().allocated, 3);
+}
+
+TEST(PinnedBufferProviderTest, BlocksWhenExhausted) {
+  PinnedBufferProvider provider(64, 1, 1, makeMallocHostAllocator());
+  PinnedBuffer *buffer = provider.getBuffer();
+
+  std::atomic<bool> acquired{false};
+  std::thread waiter([&provider, &acquired] {
+    PinnedBuffer *other = provider.getBuffer();
+    acquired = true;
+    provider.freeBuffer(other);
+  });
+
+  std::this_thread::sleep_for(std::chrono::milliseconds(50));
+  EXPECT_FALSE(acquired);
+  provider.freeBuffer(buffer);
+  waiter.join();
+  EXPECT_TRUE(acquired);
+
+  PinnedBufferProviderStats stats = provider.stats();
+  EXPECT_EQ(stats.allocated, 1);
+  EXPECT_EQ(stats.acquisitions, 2);
+  EXPECT_EQ(stats.waits, 1);
+  EXPECT_GT(stats.totalWaitNanos, 0);
+}
+
+TEST(PinnedBufferProviderTest, TryGetBufferDoesNotBlock) {
+  PinnedBufferProvider provider(64, 0, 2, makeMallocHostAllocator());
+  PinnedBuffer *first = provider.tryGetBuffer();
+  PinnedBuffer *second = provider.tryGetBuffer();
+  ASSERT_NE(first, nullptr);
+  ASSERT_NE(second, nullptr);
+  EXPECT_EQ(provider.tryGetBuffer(), nullptr);
+  EXPECT_EQ(provider.stats().allocated, 2);
+
+  provider.freeBuffer(first);
+  PinnedBuffer *third = provider.tryGetBuffer();
+  EXPECT_EQ(third, first);
+  provider.freeBuffer(second);
+  provider.freeBuffer(third);
+
+  PinnedBufferProviderStats stats = provider.stats();
+  EXPECT_EQ(stats.acquisitions, 3);
+  EXPECT_EQ(stats.waits, 0);
+  EXPECT_EQ(stats.inUse, 0);
+}
+
+TEST(PinnedBufferProviderTest, ServesWaitersInArrivalOrder) {
+  PinnedBufferProvider provider(64, 1, 1, makeMallocHostAllocator());
+  PinnedBuffer *buffer = provider.getBuffer();
+
+  std::mutex orderMutex;
+  std::vector<int> order;
+  std::vector<std::thread> waiters;
+  for (int i = 0; i < 4; i++) {
+    waiters.emplace_back([&, i] {
+      PinnedBuffer *other = provider.getBuffer();
+      {
+        std::lock_guard<std::mutex> lock(orderMutex);
+        order.push_back(i);
+      }
+      provider.freeBuffer(other);
+    });
+    // make sure the waiters queue up one after the other
+    while (provider.stats().waiting < waiters.size()) {
+      std::this_thread::yield();
+    }
+  }
+  provider.freeBuffer(buffer);
+  for (auto &waiter : waiters) {
+    waiter.join();
+  }
+  EXPECT_EQ(order, std::vector<int>({0, 1, 2, 3}));
+}
+
+TEST(PinnedBufferProviderTest, FreeAllKeepsBuffersInUse) {
+  PinnedBufferProvider provider(64, 2, 2, makeMallocHostAllocator());
+  PinnedBuffer *buffer = provider.getBuffer();
+  provider.freeAll();
+  EXPECT_EQ(provider.stats().allocated, 1);
+  provider.freeBuffer(buffer);
+
+  PinnedBuffer *first = provider.getBuffer();
+  PinnedBuffer *second = provider.getBuffer();
+  EXPECT_EQ(provider.stats().allocated, 2);
+  provider.freeBuffer(first);
+  provider.freeBuffer(second);
+}
+
+// Acquire/release throughput of 16 threads by pool size, recorded as test
+// properties. Disabled, run it with --gtest_also_run_disabled_tests
+TEST(PinnedBufferProviderTest, DISABLED_BenchmarkContendedAcquireRelease) {
+  const std::size_t nthreads = 16;
+  const std::size_t iterations = 5000;
+  for (std::size_t highWaterMark : {1, 4, 16}) {
+    PinnedBufferProvider provider(4096, highWaterMark, highWaterMark,
+                                  makeMallocHostAllocator());
+    auto start = std::chrono::steady_clock::now();
+    std::vector<std::thread> threads;
+    for (std::size_t t = 0; t < nthreads; t++) {
+      threads.emplace_back([&provider, iterations] {
+        for (std::size_t i = 0; i < iterations; i++) {
+          PinnedBuffer *buffer = provider.getBuffer();
+          buffer->data[0] = 1;
+          provider.freeBuffer(buffer);
+        }
+      });
+    }
+    for (auto &thread : threads) {
+      thread.join();
+    }
+    auto elapsed = std::chrono::duration_cast<std::chrono::microseconds>(
+                       std::chrono::steady_clock::now() - start)
+                       .count();
+    PinnedBufferProviderStats stats = provider.stats();
+    EXPECT_EQ(stats.acquisitions, nthreads * iterations);
+    EXPECT_LE(stats.peakInUse, highWaterMark);
+    const std::string prefix =
+        "high_water_mark_" + std::to_string(highWaterMark) + "_";
+    RecordProperty(prefix + "ops_per_s",
+                   std::to_string(stats.acquisitions * 1e6 / (elapsed + 1)));
+    RecordProperty(prefix + "waits", std::to_string(stats.waits));
+    RecordProperty(prefix + "avg_wait_ns",
+                   std::to_string(stats.totalWaitNanos / (stats.waits + 1)));
+  }
+}
+
+}  // namespace io
+}  // namespace transport
+}  // namespace blazingdb
@@ -0,0 +1,107 @@
+#include <blazingdb/network/TCPSocket.h>
+#include <blazingdb/transport/io/fd_reader_writer.h>
+
+#include <gtest/gtest.h>
+#include <atomic>
+#include <chrono>
+#include <numeric>
+#include <string>
+#include <thread>
+#include <vector>
+
+namespace blazingdb {
+namespace network {
+
+using blazingdb::transport::io::readFromSocket;
+using blazingdb::transport::io::writeToSocket;
+
+namespace {
+
+// Reads one size-prefixed payload, adds its bytes to checksum and answers
+// END.
+void ingestHandler(void *socket, std::atomic<uint64_t> &bytes,
+                   std::atomic<uint64_t> &checksum) {
+  try {
+    int64_t size = 0;
+    readFromSocket(socket, (char *)&size, sizeof(size));
+    std::vector<char> payload(size);
+    readFromSocket(socket, payload.data(), payload.size());
+    checksum += std::accumulate(payload.begin(), payload.end(), uint64_t{0});
+    bytes += size;
+    writeToSocket(socket, (char *)"END", 3, false);
+  } catch (const std::exception &) {
+  }
+}
+
+void sendPayload(TCPClientSocket &client, std::vector<char> &payload) {
+  int64_t size = payload.size();
+  writeToSocket(client.fd(), (char *)&size, sizeof(size));
+  writeToSocket(client.fd(), payload.data(), payload.size(), false);
+  char reply[3];
+  readFromSocket(client.fd(), reply, sizeof(reply));
+}
+
+double runIngest(int port, int num_workers, int num_clients,
+                 int messages_per_client, std::size_t message_size) {
+  std::atomic<uint64_t> bytes{0};
+  std::atomic<uint64_t> checksum{0};
+  TCPServerSocket server(port, num_workers);
+  std::thread server_thread([&server, &bytes, &checksum] {
+    server.run([&bytes, &checksum](void *socket) {
+      ingestHandler(socket, bytes, checksum);
+    });
+  });
+
+  auto start = std::chrono::steady_clock::now();
+  std::vector<std::thread> clients;
+  for (int c = 0; c < num_clients; c++) {
+    clients.emplace_back([port, messages_per_client, message_size] {
+      TCPClientSocket client("localhost", port);
+      std::vector<char> payload(message_size, 1);
+      for (int m = 0; m < messages_per_client; m++) {
+        sendPayload(client, payload);
+      }
+      client.close();
+    });
+  }
+  for (auto &client : clients) {
+    client.join();
+  }
+  double seconds =
+      std::chrono::duration<double>(std::chrono::steady_clock::now() - start)
+          .count();
+
+  server.close();
+  server_thread.join();
+
+  const uint64_t expected =
+      uint64_t(num_clients) * messages_per_client * message_size;
+  EXPECT_EQ(bytes, expected);
+  EXPECT_EQ(checksum, expected);
+  return expected / seconds / (1 << 20);
+}
+
+}  // namespace
+
+TEST(TCPServerConcurrencyTest, ServesEveryClient) {
+  runIngest(18431, 4, 8, 16, 1 << 10);
+}
+
+// Ingest bandwidth by workers and clients, recorded as test properties.
+// Disabled, run it with --gtest_also_run_disabled_tests
+TEST(TCPServerConcurrencyTest, DISABLED_BenchmarkIngestBandwidthByClients) {
+  const std::size_t message_size = 16 << 20;
+  int port = 18432;
+  for (int num_workers : {1, 4}) {
+    for (int num_clients : {1, 2, 4, 8}) {
+      double bandwidth =
+          runIngest(port++, num_workers, num_clients, 8, message_size);
+      RecordProperty("workers_" + std::to_string(num_workers) + "_clients_" +
+                         std::to_string(num_clients) + "_mib_per_s",
+                     std::to_string(bandwidth));
+    }
+  }
+}
+
+}  // namespace network
+}  // namespace blazingdb
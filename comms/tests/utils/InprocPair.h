@@ -0,0 +1,34 @@
+#ifndef BLAZINGDB_INPROC_PAIR_H
+#define BLAZINGDB_INPROC_PAIR_H
+
+#include <string>
+#include <zmq.hpp>
+
+namespace blazingdb {
+namespace transport {
+namespace io {
+
+// two PAIR sockets connected in process, the fds the socket functions of
+// fd_reader_writer.h take
+struct InprocPair {
+  InprocPair(const std::string &name)
+      : context(1),
+        sender(context, ZMQ_PAIR),
+        receiver(context, ZMQ_PAIR) {
+    receiver.bind("inproc://" + name);
+    sender.connect("inproc://" + name);
+  }
+
+  void *senderFd() { return (void *)&sender; }
+  void *receiverFd() { return (void *)&receiver; }
+
+  zmq::context_t context;
+  zmq::socket_t sender;
+  zmq::socket_t receiver;
+};
+
+}  // namespace io
+}  // namespace transport
+}  // namespace blazingdb
+
+#endif  // BLAZINGDB_INPROC_PAIR_H
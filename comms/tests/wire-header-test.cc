@@ -0,0 +1,250 @@
+#include <blazingdb/transport/WireHeader.h>
+
+#include <gtest/gtest.h>
+#include <chrono>
+#include <cstring>
+#include <random>
+#include <string>
+
+namespace blazingdb {
+namespace transport {
+namespace wire {
+
+namespace {
+
+ColumnTransport makeColumn(const std::string &name, int data, int valid) {
+  ColumnTransport column{};
+  column.metadata.dtype = 3;
+  column.metadata.size = 1 << 20;
+  column.metadata.null_count = valid == -1 ? 0 : 17;
+  std::strcpy(column.metadata.col_name, name.c_str());
+  column.data = data;
+  column.valid = valid;
+  column.strings_data = column.strings_offsets = column.strings_nullmask = -1;
+  return column;
+}
+
+MessageHeader makeHeader(int num_columns) {
+  MessageHeader header;
+  std::strcpy(header.message.messageToken, "ColumnDataMessage_42");
+  header.message.contextToken = 123456;
+  header.message.total_row_size = -7;
+  header.address.type = Address::TCP_TYPE;
+  std::strcpy(header.address.ip, "192.168.100.200");
+  header.address.comunication_port = 9001;
+  header.address.protocol_port = -1;
+  for (int i = 0; i < num_columns; i++) {
+    int data = header.buffer_sizes.size();
+    header.buffer_sizes.push_back(8 << 20);
+    int valid = -1;
+    if (i % 2) {
+      valid = header.buffer_sizes.size();
+      header.buffer_sizes.push_back(1 << 17);
+    }
+    header.columns.push_back(makeColumn("col_" + std::to_string(i), data, valid));
+  }
+  ColumnTransport strings = makeColumn("names", -1, -1);
+  strings.strings_data = header.buffer_sizes.size();
+  strings.strings_offsets = strings.strings_data + 1;
+  strings.codec = 1;
+  header.buffer_sizes.push_back(0);
+  header.buffer_sizes.push_back(4);
+  header.columns.push_back(strings);
+  return header;
+}
+
+void expectEqual(const MessageHeader &actual, const MessageHeader &expected) {
+  EXPECT_STREQ(actual.message.messageToken, expected.message.messageToken);
+  EXPECT_EQ(actual.message.contextToken, expected.message.contextToken);
+  EXPECT_EQ(actual.message.total_row_size, expected.message.total_row_size);
+  EXPECT_TRUE(actual.address == expected.address);
+  EXPECT_EQ(actual.buffer_sizes, expected.buffer_sizes);
+  ASSERT_EQ(actual.columns.size(), expected.columns.size());
+  for (std::size_t i = 0; i < actual.columns.size(); i++) {
+    const auto &a = actual.columns[i];
+    const auto &e = expected.columns[i];
+    EXPECT_EQ(a.metadata.dtype, e.metadata.dtype);
+    EXPECT_EQ(a.metadata.size, e.metadata.size);
+    EXPECT_EQ(a.metadata.null_count, e.metadata.null_count);
+    EXPECT_EQ(a.metadata.time_unit, e.metadata.time_unit);
+    EXPECT_STREQ(a.metadata.col_name, e.metadata.col_name);
+    EXPECT_EQ(a.data, e.data);
+    EXPECT_EQ(a.valid, e.valid);
+    EXPECT_EQ(a.strings_data, e.strings_data);
+    EXPECT_EQ(a.strings_offsets, e.strings_offsets);
+    EXPECT_EQ(a.strings_nullmask, e.strings_nullmask);
+    EXPECT_EQ(a.codec, e.codec);
+  }
+}
+
+// Recomputes the trailing checksum after the test edited the body
+void reseal(std::string &encoded) {
+  encoded.resize(encoded.size() - 4);
+  uint32_t checksum = crc32c(encoded.data(), encoded.size());
+  for (int i = 0; i < 4; i++) {
+    encoded.push_back((char)(checksum >> (8 * i)));
+  }
+}
+
+std::size_t rawSize(const MessageHeader &header) {
+  return sizeof(Message::MetaData) + sizeof(Address::MetaData) +
+         2 * sizeof(int32_t) + header.columns.size() * sizeof(ColumnTransport) +
+         header.buffer_sizes.size() * sizeof(int);
+}
+
+}  // namespace
+
+TEST(WireHeaderTest, RoundTrips) {
+  for (int num_columns : {0, 1, 5, 64}) {
+    MessageHeader header = makeHeader(num_columns);
+    std::string encoded = encodeMessageHeader(header);
+    expectEqual(decodeMessageHeader(encoded.data(), encoded.size()), header);
+  }
+}
+
+TEST(WireHeaderTest, IsSmallerThanTheRawStructs) {
+  MessageHeader header = makeHeader(4);
+  std::string encoded = encodeMessageHeader(header);
+  EXPECT_LT(encoded.size() * 4, rawSize(header));
+}
+
+TEST(WireHeaderTest, SkipsUnknownFields) {
+  MessageHeader header = makeHeader(2);
+  std::string encoded = encodeMessageHeader(header);
+  // a newer sender appends a varint field 100 and a bytes field 101
+  encoded.resize(encoded.size() - 4);
+  encoded += std::string{(char)0xC8, 0x01, 0x05};
+  encoded += std::string{(char)0xCB, 0x01, 0x03, 'a', 'b', 'c'};
+  encoded += "1234";
+  reseal(encoded);
+  expectEqual(decodeMessageHeader(encoded.data(), encoded.size()), header);
+}
+
+TEST(WireHeaderTest, RejectsNewerVersionsAndCorruption) {
+  std::string encoded = encodeMessageHeader(makeHeader(2));
+
+  std::string newer = encoded;
+  newer[1] = kWireVersion + 1;
+  reseal(newer);
+  EXPECT_THROW(decodeMessageHeader(newer.data(), newer.size()), HeaderError);
+
+  std::string flipped = encoded;
+  flipped[encoded.size() / 2] ^= 0x10;
+  EXPECT_THROW(decodeMessageHeader(flipped.data(), flipped.size()),
+               HeaderError);
+
+  EXPECT_THROW(decodeMessageHeader(encoded.data(), 3), HeaderError);
+}
+
+TEST(WireHeaderTest, RejectsStringsThatDoNotFit) {
+  MessageHeader header = makeHeader(0);
+  std::string encoded = encodeMessageHeader(header);
+  // replace the token with a 200 bytes one
+  const std::size_t token_size = std::strlen(header.message.messageToken);
+  std::string longer = encoded.substr(0, 2) + std::string{0x03, (char)0xC8, 0x01} +
+                       std::string(200, 'x') +
+                       encoded.substr(4 + token_size);
+  reseal(longer);
+  EXPECT_THROW(decodeMessageHeader(longer.data(), longer.size()), HeaderError);
+}
+
+// Mutation fuzzer: decoding arbitrary bytes must either succeed or throw
+// HeaderError, never crash or hang. Mutated headers are resealed so the
+// mutations reach the field parser instead of stopping at the checksum.
+TEST(WireHeaderTest, FuzzDecoder) {
+  std::mt19937 generator(2020);
+  const std::string seed = encodeMessageHeader(makeHeader(6));
+  std::size_t accepted = 0;
+  const int iterations = 200000;
+  for (int i = 0; i < iterations; i++) {
+    std::string input = seed;
+    const int mutations = 1 + generator() % 8;
+    for (int m = 0; m < mutations; m++) {
+      const std::size_t position = generator() % input.size();
+      switch (generator() % 5) {
+        case 0:
+          input[position] ^= 1 << (generator() % 8);
+          break;
+        case 1:
+          input[position] = (char)generator();
+          break;
+        case 2:
+          input.erase(position, 1 + generator() % 8);
+          break;
+        case 3:
+          input.insert(position, 1 + generator() % 8, (char)generator());
+          break;
+        case 4:
+          input.resize(position);
+          break;
+      }
+      if (input.empty()) {
+        input.push_back((char)generator());
+      }
+    }
+    if (generator() % 4 && input.size() >= 6) {
+      reseal(input);
+    }
+    try {
+      decodeMessageHeader(input.data(), input.size());
+      accepted++;
+    } catch (const HeaderError &) {
+    }
+  }
+  // random bytes too
+  for (int i = 0; i < 20000; i++) {
+    std::string input(generator() % 64, '\0');
+    for (auto &byte : input) {
+      byte = (char)generator();
+    }
+    try {
+      decodeMessageHeader(input.data(), input.size());
+    } catch (const HeaderError &) {
+    }
+  }
+  RecordProperty("accepted_mutated_headers", accepted);
+}
+
+// Encoded size and encode/decode time per message by number of columns,
+// recorded as test properties. Disabled, run it with
+// --gtest_also_run_disabled_tests
+TEST(WireHeaderTest, DISABLED_BenchmarkEncodeDecodePerMessage) {
+  for (int num_columns : {1, 8, 64}) {
+    MessageHeader header = makeHeader(num_columns);
+    const int iterations = 100000 / num_columns;
+
+    std::size_t encoded_size = 0;
+    auto start = std::chrono::steady_clock::now();
+    for (int i = 0; i < iterations; i++) {
+      encoded_size += encodeMessageHeader(header).size();
+    }
+    auto middle = std::chrono::steady_clock::now();
+    std::string encoded = encodeMessageHeader(header);
+    std::size_t decoded_columns = 0;
+    for (int i = 0; i < iterations; i++) {
+      decoded_columns +=
+          decodeMessageHeader(encoded.data(), encoded.size()).columns.size();
+    }
+    auto end = std::chrono::steady_clock::now();
+    EXPECT_EQ(decoded_columns, std::size_t(iterations) * (num_columns + 1));
+
+    const std::string prefix =
+        "columns_" + std::to_string(num_columns + 1) + "_";
+    RecordProperty(prefix + "bytes", std::to_string(encoded_size / iterations));
+    RecordProperty(prefix + "raw_bytes", std::to_string(rawSize(header)));
+    RecordProperty(
+        prefix + "encode_ns",
+        std::to_string(
+            std::chrono::duration<double, std::nano>(middle - start).count() /
+            iterations));
+    RecordProperty(
+        prefix + "decode_ns",
+        std::to_string(
+            std::chrono::duration<double, std::nano>(end - middle).count() /
+            iterations));
+  }
+}
+
+}  // namespace wire
+}  // namespace transport
+}  // namespace blazingdb
@@ -0,0 +1,129 @@
+#include <blazingdb/transport/io/fd_reader_writer.h>
+
+#include <gtest/gtest.h>
+#include <atomic>
+#include <chrono>
+#include <string>
+#include <numeric>
+#include <thread>
+#include <vector>
+#include <zmq.hpp>
+
+#include "utils/InprocPair.h"
+
+namespace blazingdb {
+namespace transport {
+namespace io {
+
+namespace {
+
+void countRelease(void * /*data*/, void *hint) {
+  static_cast<std::atomic<int> *>(hint)->fetch_add(1);
+}
+
+}  // namespace
+
+TEST(ZeroCopySocketTest, SendsBorrowedBufferAndReleasesIt) {
+  InprocPair pair("zero-copy-release");
+  std::vector<char> payload(1 << 20);
+  std::iota(payload.begin(), payload.end(), 0);
+  std::atomic<int> released{0};
+
+  writeToSocketZeroCopy(pair.senderFd(), payload.data(), payload.size(),
+                        countRelease, &released, false);
+
+  std::vector<char> received(payload.size());
+  EXPECT_EQ(readFromSocket(pair.receiverFd(), received.data(), received.size()),
+            payload.size());
+  EXPECT_EQ(received, payload);
+
+  // inproc releases the borrowed buffer when the receiver drops the frame
+  auto deadline = std::chrono::steady_clock::now() + std::chrono::seconds(5);
+  while (released == 0 && std::chrono::steady_clock::now() < deadline) {
+    std::this_thread::yield();
+  }
+  EXPECT_EQ(released, 1);
+}
+
+TEST(ZeroCopySocketTest, MultipartFramesKeepTheirBoundaries) {
+  InprocPair pair("zero-copy-multipart");
+  int32_t header = 42;
+  std::vector<char> body(3000, 'x');
+
+  writeToSocket(pair.senderFd(), (char *)&header, sizeof(header));
+  writeToSocketZeroCopy(pair.senderFd(), body.data(), body.size(), nullptr,
+                        nullptr, false);
+
+  int32_t received_header = 0;
+  readFromSocket(pair.receiverFd(), (char *)&received_header,
+                 sizeof(received_header));
+  EXPECT_EQ(received_header, header);
+
+  std::vector<char> received_body(body.size());
+  readFromSocket(pair.receiverFd(), received_body.data(), received_body.size());
+  EXPECT_EQ(received_body, body);
+}
+
+TEST(ZeroCopySocketTest, RejectsFrameLengthMismatch) {
+  InprocPair pair("zero-copy-mismatch");
+  std::vector<char> payload(128, 'a');
+
+  writeToSocket(pair.senderFd(), payload.data(), payload.size(), false);
+  std::vector<char> too_small(64);
+  EXPECT_THROW(readFromSocket(pair.receiverFd(), too_small.data(),
+                              too_small.size()),
+               std::runtime_error);
+
+  writeToSocket(pair.senderFd(), payload.data(), payload.size(), false);
+  std::vector<char> too_large(256);
+  EXPECT_THROW(readFromSocket(pair.receiverFd(), too_large.data(),
+                              too_large.size()),
+               std::runtime_error);
+}
+
+TEST(ZeroCopySocketTest, DiscardsPendingFrames) {
+  InprocPair pair("zero-copy-discard");
+  char frame[16] = {};
+  writeToSocket(pair.senderFd(), frame, sizeof(frame));
+  writeToSocket(pair.senderFd(), frame, sizeof(frame));
+  writeToSocket(pair.senderFd(), frame, sizeof(frame), false);
+  writeToSocket(pair.senderFd(), frame, 4, false);
+
+  readFromSocket(pair.receiverFd(), frame, sizeof(frame));
+  discardPendingFrames(pair.receiverFd());
+  EXPECT_EQ(readFromSocket(pair.receiverFd(), frame, 4), 4);
+}
+
+// Send bandwidth of 8 MiB frames copied and zero-copy, recorded as test
+// properties. Disabled, run it with --gtest_also_run_disabled_tests
+TEST(ZeroCopySocketTest, DISABLED_BenchmarkCopyVersusZeroCopy) {
+  InprocPair pair("zero-copy-benchmark");
+  const std::size_t chunk = 8 << 20;
+  const int iterations = 64;
+  std::vector<char> payload(chunk, 'z');
+  std::vector<char> received(chunk);
+
+  auto run = [&](bool zeroCopy) {
+    auto start = std::chrono::steady_clock::now();
+    for (int i = 0; i < iterations; i++) {
+      if (zeroCopy) {
+        writeToSocketZeroCopy(pair.senderFd(), payload.data(), chunk, nullptr,
+                              nullptr, false);
+      } else {
+        writeToSocket(pair.senderFd(), payload.data(), chunk, false);
+      }
+      readFromSocket(pair.receiverFd(), received.data(), chunk);
+    }
+    double seconds = std::chrono::duration<double>(
+                         std::chrono::steady_clock::now() - start)
+                         .count();
+    return (double)chunk * iterations / seconds / (1 << 30);
+  };
+
+  RecordProperty("copy_gib_per_s", std::to_string(run(false)));
+  RecordProperty("zero_copy_gib_per_s", std::to_string(run(true)));
+}
+
+}  // namespace io
+}  // namespace transport
+}  // namespace blazingdb
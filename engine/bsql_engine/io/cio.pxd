@@ -235,10 +235,15 @@ cdef extern from "../include/io/io.h":
         string bucketName
         bool useDefaultAdcJsonFile
         string adcJsonFile
+    cdef struct Local:
+        short readMode
+        short mmapAdvice
+        int ioUringQueueDepth
+        bool directIo
     pair[bool, string] registerFileSystemHDFS(HDFS hdfs, string root, string authority) except +raiseRegisterFileSystemHDFSError
     pair[bool, string] registerFileSystemGCS( GCS gcs, string root, string authority) except +raiseRegisterFileSystemGCSError
     pair[bool, string] registerFileSystemS3( S3 s3, string root, string authority) except +raiseRegisterFileSystemS3Error
-    pair[bool, string] registerFileSystemLocal(  string root, string authority) except +raiseRegisterFileSystemLocalError
+    pair[bool, string] registerFileSystemLocal( Local local, string root, string authority) except +raiseRegisterFileSystemLocalError
     TableSchema parseSchema(vector[string] files, string file_format_hint, vector[string] arg_keys, vector[string] arg_values, vector[pair[string,gdf_dtype]] types) except +raiseParseSchemaError
     TableSchema parseMetadata(vector[string] files, pair[int,int] offsets, TableSchema schema, string file_format_hint, vector[string] arg_keys, vector[string] arg_values, vector[pair[string,gdf_dtype]] types) except +raiseParseSchemaError
 
@@ -262,6 +267,21 @@ cdef extern from "../include/engine/engine.h":
             vector[vector[int]] table_columns
         TableScanInfo getTableScanInfo(string logicalPlan)
 
+        cdef struct QueryProfileStep:
+            string name
+            string category
+            int query_step
+            int query_substep
+            long start_us
+            long duration_us
+            long rows_in
+            long rows
+            long bytes
+            vector[string] arg_keys
+            vector[string] arg_values
+        void startQueryProfile(int ctxToken)
+        vector[QueryProfileStep] getQueryProfile(int ctxToken)
+
 cdef extern from "../include/engine/initialize.h":
     cdef void initialize(int ralId, int gpuId, string network_iface_name, string ralHost, int ralCommunicationPort, bool singleNode) except +raiseInitializeError
     cdef void finalize() except +raiseFinalizeError
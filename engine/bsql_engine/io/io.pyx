@@ -100,6 +100,13 @@ cdef cio.TableScanInfo getTableScanInfoPython(string logicalPlan):
     temp = cio.getTableScanInfo(logicalPlan)
     return temp
 
+cdef void startQueryProfilePython(int ctxToken):
+    cio.startQueryProfile(ctxToken)
+
+cdef vector[cio.QueryProfileStep] getQueryProfilePython(int ctxToken):
+    temp = cio.getQueryProfile(ctxToken)
+    return temp
+
 cdef void initializePython(int ralId, int gpuId, string network_iface_name, string ralHost, int ralCommunicationPort, bool singleNode) except *:
     cio.initialize( ralId,  gpuId, network_iface_name,  ralHost,  ralCommunicationPort, singleNode)
 
@@ -110,6 +117,7 @@ cpdef pair[bool, string] registerFileSystemCaller(fs, root, authority):
     cdef HDFS hdfs
     cdef S3 s3
     cdef GCS gcs
+    cdef Local local
     if fs['type'] == 'hdfs':
         hdfs.host = str.encode(fs['host'])
         hdfs.port = fs['port']
@@ -138,7 +146,19 @@ cpdef pair[bool, string] registerFileSystemCaller(fs, root, authority):
         gcs.adcJsonFile = str.encode(fs['adc_json_file'])
         return cio.registerFileSystemGCS( gcs,  str.encode(root), str.encode(authority))
     if fs['type'] == 'local':
-        return cio.registerFileSystemLocal( str.encode( root), str.encode(authority))
+        read_modes = {'': 0, 'pread': 1, 'mmap': 2, 'io_uring': 3}
+        mmap_advices = {'normal': 1, 'sequential': 2, 'random': 3, 'willneed': 4}
+        read_mode = fs['read_mode']
+        if read_mode not in read_modes:
+            raise ValueError('Invalid local read mode: ' + read_mode)
+        mmap_advice = fs['mmap_advice']
+        if mmap_advice not in mmap_advices:
+            raise ValueError('Invalid local mmap advice: ' + mmap_advice)
+        local.readMode = read_modes[read_mode]
+        local.mmapAdvice = mmap_advices[mmap_advice]
+        local.ioUringQueueDepth = fs['io_uring_queue_depth']
+        local.directIo = fs['direct_io']
+        return cio.registerFileSystemLocal( local, str.encode( root), str.encode(authority))
 
 cpdef initializeCaller(int ralId, int gpuId, string network_iface_name, string ralHost, int ralCommunicationPort, bool singleNode):
     initializePython( ralId,  gpuId, network_iface_name,  ralHost,  ralCommunicationPort, singleNode)
@@ -269,11 +289,13 @@ cpdef runQueryCaller(int masterIndex,  tcpMetadata,  tables,  vector[int] fileTy
 
     tableIndex = 0
     for tableName in tables:
-      string_values_cpp.empty()
-      uri_values_cpp.empty()
+      string_values_cpp.clear()
+      uri_values_cpp.clear()
+      is_string_column.clear()
       for uri_value in tables[tableName].uri_values:
         cur_uri_values.clear()
         cur_string_values.clear()
+        cur_is_string_column.clear()
         for column_tuple in uri_value:
           key = column_tuple[0]
           value = column_tuple[1]
@@ -384,11 +406,12 @@ cpdef runSkipDataCaller(int masterIndex,  tcpMetadata,  table_obj,  vector[int]
     tableName, table = table_obj
 
     tableIndex = 0
-    string_values_cpp.empty()
-    uri_values_cpp.empty()
+    string_values_cpp.clear()
+    uri_values_cpp.clear()
     for uri_value in table.uri_values:
       cur_uri_values.clear()
       cur_string_values.clear()
+      cur_is_string_column.clear()
       for column_tuple in uri_value:
         key = column_tuple[0]
         value = column_tuple[1]
@@ -474,4 +497,26 @@ cpdef getTableScanInfoCaller(logicalPlan):
           relational_algebra_steps[table_name]['table_scans'] = [scan_string,]
           relational_algebra_steps[table_name]['table_columns'] = [table_columns,]
 
-    return relational_algebra_steps
\ No newline at end of file
+    return relational_algebra_steps
+
+cpdef startQueryProfileCaller(int ctxToken):
+    startQueryProfilePython(ctxToken)
+
+cpdef getQueryProfileCaller(int ctxToken):
+    temp = getQueryProfilePython(ctxToken)
+
+    steps = []
+    for step in temp:
+        steps.append({
+            'name': step.name.decode('utf-8'),
+            'category': step.category.decode('utf-8'),
+            'query_step': step.query_step,
+            'query_substep': step.query_substep,
+            'start_us': step.start_us,
+            'duration_us': step.duration_us,
+            'rows_in': step.rows_in,
+            'rows': step.rows,
+            'bytes': step.bytes,
+            'args': {key.decode('utf-8'): value.decode('utf-8') for key, value in zip(step.arg_keys, step.arg_values)}
+        })
+    return steps
@@ -57,3 +57,23 @@ ResultSet runSkipData(int32_t masterIndex,
 	std::vector<std::vector<std::map<std::string, std::string>>> string_values,
 	std::vector<std::vector<std::map<std::string, bool>>> is_column_string);
 
+// a span of a profiled query, its start in microseconds since the epoch and -1 for the rows and bytes not known
+struct QueryProfileStep {
+	std::string name;
+	std::string category;
+	int32_t query_step;
+	int32_t query_substep;
+	int64_t start_us;
+	int64_t duration_us;
+	int64_t rows_in;
+	int64_t rows;
+	int64_t bytes;
+	std::vector<std::string> arg_keys;
+	std::vector<std::string> arg_values;
+};
+
+// keeps the spans of the query ctxToken that this node runs from now on, until getQueryProfile
+void startQueryProfile(int32_t ctxToken);
+
+// the spans of the query ctxToken this node ran since startQueryProfile, it stops keeping them
+std::vector<QueryProfileStep> getQueryProfile(int32_t ctxToken);
@@ -58,6 +58,13 @@ struct GCS {
 	std::string adcJsonFile;
 };
 
+struct Local {
+	short readMode;	// 0 reads with the mode of the BLAZING_LOCAL_READ_MODE env var
+	short mmapAdvice;
+	int ioUringQueueDepth;
+	bool directIo;
+};
+
 
 #define parquetFileType 0
 #define orcFileType 1
@@ -84,4 +91,4 @@ TableSchema parseMetadata(std::vector<std::string> files,
 std::pair<bool, std::string> registerFileSystemHDFS(HDFS hdfs, std::string root, std::string authority);
 std::pair<bool, std::string> registerFileSystemGCS(GCS gcs, std::string root, std::string authority);
 std::pair<bool, std::string> registerFileSystemS3(S3 s3, std::string root, std::string authority);
-std::pair<bool, std::string> registerFileSystemLocal(std::string root, std::string authority);
+std::pair<bool, std::string> registerFileSystemLocal(Local local, std::string root, std::string authority);
@@ -18,6 +18,7 @@
 #include "ResultSetRepository.h"
 #include "Traits/RuntimeTraits.h"
 #include "Utils.cuh"
+#include "communication/CommunicationData.h"
 #include "communication/network/Server.h"
 #include "config/GPUManager.cuh"
 #include "cuDF/safe_nvcategory_gather.hpp"
@@ -30,6 +31,8 @@
 #include "operators/JoinOperator.h"
 #include "operators/OrderBy.h"
 #include "utilities/CommonOperations.h"
+#include "utilities/OperatorMetrics.h"
+#include "utilities/QueryTrace.h"
 #include "utilities/RalColumn.h"
 #include "utilities/StringUtils.h"
 #include <cudf/legacy/filling.hpp>
@@ -471,7 +474,7 @@ void process_filter(Context * context, blazing_frame & input, std::string query_
 		ral::traits::get_dtype_size_in_bytes(GDF_BOOL8),
 		"");
 
-	Library::Logging::Logger().logInfo(
+	BLAZING_LOG_INFO(
 		timer.logDuration(*context, "Filter part 1 initialize stencil", "num rows", input.get_num_rows_in_table(0)));
 	timer.reset();
 
@@ -482,7 +485,7 @@ void process_filter(Context * context, blazing_frame & input, std::string query_
 
 	evaluate_expression(input, conditional_expression, stencil);
 
-	Library::Logging::Logger().logInfo(
+	BLAZING_LOG_INFO(
 		timer.logDuration(*context, "Filter part 2 evaluate expression", "num rows", input.get_num_rows_in_table(0)));
 	timer.reset();
 
@@ -509,7 +512,7 @@ void process_filter(Context * context, blazing_frame & input, std::string query_
 		input.set_column(i, temp);
 	}
 
-	Library::Logging::Logger().logInfo(
+	BLAZING_LOG_INFO(
 		timer.logDuration(*context, "Filter part 3 apply_boolean_mask", "num rows", input.get_num_rows_in_table(0)));
 	timer.reset();
 }
@@ -596,7 +599,7 @@ blazing_frame evaluate_split_query(std::vector<std::vector<gdf_column_cpp>> inpu
 			result_frame = ral::operators::process_join(queryContext, left_frame, query[0]);
 			std::string extraInfo =
 				"left_side_num_rows:" + std::to_string(numLeft) + ":right_side_num_rows:" + std::to_string(numRight);
-			Library::Logging::Logger().logInfo(blazing_timer.logDuration(*queryContext,
+			BLAZING_LOG_INFO(blazing_timer.logDuration(*queryContext,
 				"evaluate_split_query process_join",
 				"num rows result",
 				result_frame.get_num_rows_in_table(0),
@@ -612,7 +615,7 @@ blazing_frame evaluate_split_query(std::vector<std::vector<gdf_column_cpp>> inpu
 			result_frame = process_union(left_frame, right_frame, query[0]);
 			std::string extraInfo =
 				"left_side_num_rows:" + std::to_string(numLeft) + ":right_side_num_rows:" + std::to_string(numRight);
-			Library::Logging::Logger().logInfo(blazing_timer.logDuration(*queryContext,
+			BLAZING_LOG_INFO(blazing_timer.logDuration(*queryContext,
 				"evaluate_split_query process_union",
 				"num rows result",
 				result_frame.get_num_rows_in_table(0),
@@ -635,7 +638,7 @@ blazing_frame evaluate_split_query(std::vector<std::vector<gdf_column_cpp>> inpu
 		if(is_project(query[0])) {
 			blazing_timer.reset();  // doing a reset before to not include other calls to evaluate_split_query
 			execute_project_plan(child_frame, query[0]);
-			Library::Logging::Logger().logInfo(blazing_timer.logDuration(*queryContext,
+			BLAZING_LOG_INFO(blazing_timer.logDuration(*queryContext,
 				"evaluate_split_query process_project",
 				"num rows",
 				child_frame.get_num_rows_in_table(0)));
@@ -644,7 +647,7 @@ blazing_frame evaluate_split_query(std::vector<std::vector<gdf_column_cpp>> inpu
 		} else if(ral::operators::is_aggregate(query[0])) {
 			blazing_timer.reset();  // doing a reset before to not include other calls to evaluate_split_query
 			ral::operators::process_aggregate(child_frame, query[0], queryContext);
-			Library::Logging::Logger().logInfo(blazing_timer.logDuration(*queryContext,
+			BLAZING_LOG_INFO(blazing_timer.logDuration(*queryContext,
 				"evaluate_split_query process_aggregate",
 				"num rows",
 				child_frame.get_num_rows_in_table(0)));
@@ -653,14 +656,14 @@ blazing_frame evaluate_split_query(std::vector<std::vector<gdf_column_cpp>> inpu
 		} else if(ral::operators::is_sort(query[0])) {
 			blazing_timer.reset();  // doing a reset before to not include other calls to evaluate_split_query
 			ral::operators::process_sort(child_frame, query[0], queryContext);
-			Library::Logging::Logger().logInfo(blazing_timer.logDuration(
+			BLAZING_LOG_INFO(blazing_timer.logDuration(
 				*queryContext, "evaluate_split_query process_sort", "num rows", child_frame.get_num_rows_in_table(0)));
 			blazing_timer.reset();
 			return child_frame;
 		} else if(is_filter(query[0])) {
 			blazing_timer.reset();  // doing a reset before to not include other calls to evaluate_split_query
 			process_filter(queryContext, child_frame, query[0]);
-			Library::Logging::Logger().logInfo(blazing_timer.logDuration(*queryContext,
+			BLAZING_LOG_INFO(blazing_timer.logDuration(*queryContext,
 				"evaluate_split_query process_filter",
 				"num rows",
 				child_frame.get_num_rows_in_table(0)));
@@ -673,6 +676,15 @@ blazing_frame evaluate_split_query(std::vector<std::vector<gdf_column_cpp>> inpu
 	}
 }
 
+// the relational step a span runs and what it outputs, that EXPLAIN ANALYZE shows next to the plan
+void set_span_output(ral::utilities::trace_span & span, const std::string & relational_step, blazing_frame & frame) {
+	if(span.is_active()) {
+		span.set_arg("relational_step", relational_step);
+		span.set_rows(frame.get_num_rows_in_table(0));
+		span.set_bytes(ral::utilities::getTableSizeInBytes(frame.get_table(0)));
+	}
+}
+
 blazing_frame evaluate_split_query(std::vector<ral::io::data_loader> input_loaders,
 	std::vector<ral::io::Schema> schemas,
 	std::vector<std::string> table_names,
@@ -694,6 +706,7 @@ blazing_frame evaluate_split_query(std::vector<ral::io::data_loader> input_loade
 			size_t table_index = get_table_index(table_names, extract_table_name(query[0]));
 			if(is_bindable_scan(query[0])) {
 				blazing_timer.reset();  // doing a reset before to not include other calls to evaluate_split_query
+				ral::utilities::trace_span load_span(*queryContext, "scan", "load_data " + table_names[table_index]);
 				std::string project_string = get_named_expression(query[0], "projects");
 				std::vector<std::string> project_string_split =
 					get_expressions_from_expression_list(project_string, true);
@@ -707,12 +720,21 @@ blazing_frame evaluate_split_query(std::vector<ral::io::data_loader> input_loade
 					projections.push_back(std::stoull(project_string_split[i]));
 				}
 
+				ral::io::data_loader loader = input_loaders[table_index];
+				if(is_filtered_bindable_scan(query[0])) {
+					// the hive partitions the filter rejects are dropped before their files are opened
+					loader = loader.prune_partitions(*queryContext,
+						clean_calcite_expression(get_filter_expression(query[0])),
+						projections,
+						schemas[table_index]);
+				}
+
 				// This is for the count(*) case, we don't want to load all the columns
 				if(projections.size() == 0 && aliases_string_split.size() == 1) {
 					projections.push_back(0);
 				}
 
-				input_loaders[table_index].load_data(*queryContext, input_table, projections, schemas[table_index]);
+				loader.load_data(*queryContext, input_table, projections, schemas[table_index]);
 
 				// Setting the aliases only when is not an empty set
 				for(size_t col_idx = 0; col_idx < aliases_string_split.size(); col_idx++) {
@@ -723,14 +745,24 @@ blazing_frame evaluate_split_query(std::vector<ral::io::data_loader> input_loade
 					}
 				}
 				int num_rows = input_table.size() > 0 ? input_table[0].size() : 0;
-				Library::Logging::Logger().logInfo(
+				ral::utilities::record_operator_rows("scan", 0, num_rows);
+				load_span.set_rows(num_rows);
+				load_span.set_bytes(ral::utilities::getTableSizeInBytes(input_table));
+				load_span.set_arg("relational_step", query[0]);
+				load_span.end();
+				BLAZING_LOG_INFO(
 					blazing_timer.logDuration(*queryContext, "evaluate_split_query load_data", "num rows", num_rows));
 				blazing_timer.reset();
 
 				if(is_filtered_bindable_scan(query[0])) {
+					ral::utilities::trace_span filter_span(*queryContext, "operator", "filter");
 					scan_frame.add_table(input_table);
 					process_filter(queryContext, scan_frame, query[0]);
-					Library::Logging::Logger().logInfo(blazing_timer.logDuration(*queryContext,
+					ral::utilities::record_operator_rows("filter", num_rows, scan_frame.get_num_rows_in_table(0));
+					filter_span.set_rows_in(num_rows);
+					set_span_output(filter_span, query[0], scan_frame);
+					filter_span.end();
+					BLAZING_LOG_INFO(blazing_timer.logDuration(*queryContext,
 						"evaluate_split_query process_filter",
 						"num rows",
 						scan_frame.get_num_rows_in_table(0)));
@@ -740,9 +772,15 @@ blazing_frame evaluate_split_query(std::vector<ral::io::data_loader> input_loade
 				}
 			} else {
 				blazing_timer.reset();  // doing a reset before to not include other calls to evaluate_split_query
+				ral::utilities::trace_span load_span(*queryContext, "scan", "load_data " + table_names[table_index]);
 				input_loaders[table_index].load_data(*queryContext, input_table, {}, schemas[table_index]);
 				int num_rows = input_table.size() > 0 ? input_table[0].size() : 0;
-				Library::Logging::Logger().logInfo(
+				ral::utilities::record_operator_rows("scan", 0, num_rows);
+				load_span.set_rows(num_rows);
+				load_span.set_bytes(ral::utilities::getTableSizeInBytes(input_table));
+				load_span.set_arg("relational_step", query[0]);
+				load_span.end();
+				BLAZING_LOG_INFO(
 					blazing_timer.logDuration(*queryContext, "evaluate_split_query load_data", "num rows", num_rows));
 				blazing_timer.reset();
 			}
@@ -789,22 +827,36 @@ blazing_frame evaluate_split_query(std::vector<ral::io::data_loader> input_loade
 		blazing_frame result_frame;
 		if(ral::operators::is_join(query[0])) {
 			blazing_timer.reset();  // doing a reset before to not include other calls to evaluate_split_query
+			ral::utilities::trace_span join_span(*queryContext, "operator", "join");
 			// we know that left and right are dataframes we want to join together
 			int numLeft = left_frame.get_num_rows_in_table(0);
 			int numRight = right_frame.get_num_rows_in_table(0);
 			left_frame.add_table(right_frame.get_table(0));
 			///left_frame.consolidate_tables();
+			const std::string relational_step = query[0];
 			std::string new_join_statement, filter_statement;
 			StringUtil::findAndReplaceAll(query[0], "IS NOT DISTINCT FROM", "=");
 			split_inequality_join_into_join_and_filter(query[0], new_join_statement, filter_statement);
 			result_frame = ral::operators::process_join(queryContext, left_frame, new_join_statement);
+			ral::utilities::record_operator_rows("join", numLeft + numRight, result_frame.get_num_rows_in_table(0));
+			join_span.set_rows_in(numLeft + numRight);
+			set_span_output(join_span, relational_step, result_frame);
+			join_span.set_arg("left_rows", std::to_string(numLeft));
+			join_span.set_arg("right_rows", std::to_string(numRight));
+			join_span.end();
 			std::string extraInfo = "left_side_num_rows:" + std::to_string(numLeft) + ":right_side_num_rows:" + std::to_string(numRight);
-			Library::Logging::Logger().logInfo(blazing_timer.logDuration(*queryContext, "evaluate_split_query process_join", "num rows result", result_frame.get_num_rows_in_table(0), extraInfo));
+			BLAZING_LOG_INFO(blazing_timer.logDuration(*queryContext, "evaluate_split_query process_join", "num rows result", result_frame.get_num_rows_in_table(0), extraInfo));
 			blazing_timer.reset();
 			queryContext->incrementQueryStep();
 			if (filter_statement != ""){
+				ral::utilities::trace_span filter_span(*queryContext, "operator", "inequality join filter");
+				int join_rows = result_frame.get_num_rows_in_table(0);
 				process_filter(queryContext, result_frame,filter_statement);
-				Library::Logging::Logger().logInfo(blazing_timer.logDuration(*queryContext, "evaluate_split_query inequality join process_filter", "num rows", result_frame.get_num_rows_in_table(0)));
+				ral::utilities::record_operator_rows("filter", join_rows, result_frame.get_num_rows_in_table(0));
+				filter_span.set_rows_in(join_rows);
+				set_span_output(filter_span, relational_step, result_frame);
+				filter_span.end();
+				BLAZING_LOG_INFO(blazing_timer.logDuration(*queryContext, "evaluate_split_query inequality join process_filter", "num rows", result_frame.get_num_rows_in_table(0)));
 				blazing_timer.reset();
 				queryContext->incrementQueryStep();
 			}
@@ -815,10 +867,15 @@ blazing_frame evaluate_split_query(std::vector<ral::io::data_loader> input_loade
 			// return right_frame;//!!
 			int numLeft = left_frame.get_num_rows_in_table(0);
 			int numRight = right_frame.get_num_rows_in_table(0);
+			ral::utilities::trace_span union_span(*queryContext, "operator", "union");
 			result_frame = process_union(left_frame, right_frame, query[0]);
+			ral::utilities::record_operator_rows("union", numLeft + numRight, result_frame.get_num_rows_in_table(0));
+			union_span.set_rows_in(numLeft + numRight);
+			set_span_output(union_span, query[0], result_frame);
+			union_span.end();
 			std::string extraInfo =
 				"left_side_num_rows:" + std::to_string(numLeft) + ":right_side_num_rows:" + std::to_string(numRight);
-			Library::Logging::Logger().logInfo(blazing_timer.logDuration(*queryContext,
+			BLAZING_LOG_INFO(blazing_timer.logDuration(*queryContext,
 				"evaluate_split_query process_union",
 				"num rows result",
 				result_frame.get_num_rows_in_table(0),
@@ -841,8 +898,14 @@ blazing_frame evaluate_split_query(std::vector<ral::io::data_loader> input_loade
 		// process self
 		if(is_project(query[0])) {
 			blazing_timer.reset();  // doing a reset before to not include other calls to evaluate_split_query
+			ral::utilities::trace_span project_span(*queryContext, "operator", "project");
+			int child_rows = child_frame.get_num_rows_in_table(0);
 			execute_project_plan(child_frame, query[0]);
-			Library::Logging::Logger().logInfo(blazing_timer.logDuration(*queryContext,
+			ral::utilities::record_operator_rows("project", child_rows, child_frame.get_num_rows_in_table(0));
+			project_span.set_rows_in(child_rows);
+			set_span_output(project_span, query[0], child_frame);
+			project_span.end();
+			BLAZING_LOG_INFO(blazing_timer.logDuration(*queryContext,
 				"evaluate_split_query process_project",
 				"num rows",
 				child_frame.get_num_rows_in_table(0)));
@@ -851,8 +914,14 @@ blazing_frame evaluate_split_query(std::vector<ral::io::data_loader> input_loade
 			return child_frame;
 		} else if(ral::operators::is_aggregate(query[0])) {
 			blazing_timer.reset();  // doing a reset before to not include other calls to evaluate_split_query
+			ral::utilities::trace_span aggregate_span(*queryContext, "operator", "aggregate");
+			int child_rows = child_frame.get_num_rows_in_table(0);
 			ral::operators::process_aggregate(child_frame, query[0], queryContext);
-			Library::Logging::Logger().logInfo(blazing_timer.logDuration(*queryContext,
+			ral::utilities::record_operator_rows("aggregate", child_rows, child_frame.get_num_rows_in_table(0));
+			aggregate_span.set_rows_in(child_rows);
+			set_span_output(aggregate_span, query[0], child_frame);
+			aggregate_span.end();
+			BLAZING_LOG_INFO(blazing_timer.logDuration(*queryContext,
 				"evaluate_split_query process_aggregate",
 				"num rows",
 				child_frame.get_num_rows_in_table(0)));
@@ -861,16 +930,28 @@ blazing_frame evaluate_split_query(std::vector<ral::io::data_loader> input_loade
 			return child_frame;
 		} else if(ral::operators::is_sort(query[0])) {
 			blazing_timer.reset();  // doing a reset before to not include other calls to evaluate_split_query
+			ral::utilities::trace_span sort_span(*queryContext, "operator", "sort");
+			int child_rows = child_frame.get_num_rows_in_table(0);
 			ral::operators::process_sort(child_frame, query[0], queryContext);
-			Library::Logging::Logger().logInfo(blazing_timer.logDuration(
+			ral::utilities::record_operator_rows("sort", child_rows, child_frame.get_num_rows_in_table(0));
+			sort_span.set_rows_in(child_rows);
+			set_span_output(sort_span, query[0], child_frame);
+			sort_span.end();
+			BLAZING_LOG_INFO(blazing_timer.logDuration(
 				*queryContext, "evaluate_split_query process_sort", "num rows", child_frame.get_num_rows_in_table(0)));
 			blazing_timer.reset();
 			queryContext->incrementQueryStep();
 			return child_frame;
 		} else if(is_filter(query[0])) {
 			blazing_timer.reset();  // doing a reset before to not include other calls to evaluate_split_query
+			ral::utilities::trace_span filter_span(*queryContext, "operator", "filter");
+			int child_rows = child_frame.get_num_rows_in_table(0);
 			process_filter(queryContext, child_frame, query[0]);
-			Library::Logging::Logger().logInfo(blazing_timer.logDuration(*queryContext,
+			ral::utilities::record_operator_rows("filter", child_rows, child_frame.get_num_rows_in_table(0));
+			filter_span.set_rows_in(child_rows);
+			set_span_output(filter_span, query[0], child_frame);
+			filter_span.end();
+			BLAZING_LOG_INFO(blazing_timer.logDuration(*queryContext,
 				"evaluate_split_query process_filter",
 				"num rows",
 				child_frame.get_num_rows_in_table(0)));
@@ -884,6 +965,15 @@ blazing_frame evaluate_split_query(std::vector<ral::io::data_loader> input_loade
 	}
 }
 
+// writes the spans of the query when BLAZING_TRACE_DIR is set
+void write_query_trace(const Context & queryContext) {
+	auto & recorder = ral::utilities::query_trace_recorder::getInstance();
+	if(recorder.is_enabled()) {
+		int node_index = queryContext.getNodeIndex(ral::communication::CommunicationData::getInstance().getSelfNode());
+		recorder.write(queryContext.getContextToken(), node_index);
+	}
+}
+
 query_token_t evaluate_query(std::vector<ral::io::data_loader> input_loaders,
 	std::vector<ral::io::Schema> schemas,
 	std::vector<std::string> table_names,
@@ -901,7 +991,10 @@ query_token_t evaluate_query(std::vector<ral::io::data_loader> input_loaders,
 
 		try {
 			Context context = queryContext;
+			ral::utilities::trace_span query_span(context, "query", "query");
 			blazing_frame output_frame = evaluate_split_query(input_loaders, schemas, table_names, splitted, &context);
+			query_span.set_rows(output_frame.get_num_rows_in_table(0));
+			query_span.end();
 
 			// REMOVE any columns that were ipcd to put into the result set
 			for(size_t index = 0; index < output_frame.get_size_column(); index++) {
@@ -912,11 +1005,11 @@ query_token_t evaluate_query(std::vector<ral::io::data_loader> input_loaders,
 				}
 			}
 			double duration = blazing_timer.getDuration();
-			Library::Logging::Logger().logInfo(blazing_timer.logDuration(queryContext, "Query Execution Done"));
+			BLAZING_LOG_INFO(blazing_timer.logDuration(queryContext, "Query Execution Done"));
 
 			result_set_repository::get_instance().update_token(token, output_frame, duration);
 
-			Library::Logging::Logger().logInfo(blazing_timer.logDuration(queryContext, "Query Done"));
+			BLAZING_LOG_INFO(blazing_timer.logDuration(queryContext, "Query Done"));
 		} catch(const std::exception & e) {
 			std::cerr << "evaluate_split_query error => " << e.what() << '\n';
 			try {
@@ -926,6 +1019,7 @@ query_token_t evaluate_query(std::vector<ral::io::data_loader> input_loaders,
 			}
 		}
 
+		write_query_trace(queryContext);
 		ral::communication::network::Server::getInstance().deregisterContext(queryContext.getContextToken());
 	});
 
@@ -948,7 +1042,8 @@ blazing_frame evaluate_query(
 
 		CodeTimer blazing_timer;
 
-		Library::Logging::Logger().logInfo(blazing_timer.logDuration(queryContext, "\"Query Start\n" + logicalPlan + "\""));
+		BLAZING_LOG_INFO(blazing_timer.logDuration(queryContext, "\"Query Start\n" + logicalPlan + "\""));
+		ral::utilities::trace_span query_span(queryContext, "query", "query");
 
 		std::vector<std::string> splitted = StringUtil::split(logicalPlan, "\n");
 		if (splitted[splitted.size() - 1].length() == 0) {
@@ -979,12 +1074,18 @@ blazing_frame evaluate_query(
 			}
 
 			double duration = blazing_timer.getDuration();
-			Library::Logging::Logger().logInfo(blazing_timer.logDuration(queryContext, "Query Execution Done"));
+			BLAZING_LOG_INFO(blazing_timer.logDuration(queryContext, "Query Execution Done"));
 
+			query_span.set_rows(output_frame.get_num_rows_in_table(0));
+			query_span.end();
+			write_query_trace(queryContext);
 			return output_frame;
 		} catch(const std::exception& e) {
 			std::string err = "ERROR: in evaluate_split_query " + std::string(e.what());
-			Library::Logging::Logger().logError(ral::utilities::buildLogString(std::to_string(queryContext.getContextToken()), std::to_string(queryContext.getQueryStep()), std::to_string(queryContext.getQuerySubstep()), err));
+			BLAZING_LOG_ERROR(ral::utilities::buildLogString(std::to_string(queryContext.getContextToken()), std::to_string(queryContext.getQueryStep()), std::to_string(queryContext.getQuerySubstep()), err));
+			query_span.set_arg("error", e.what());
+			query_span.end();
+			write_query_trace(queryContext);
 			throw;
 		}
 }
@@ -194,7 +194,7 @@ static int64_t scale_to_64_bit_return_bytes(gdf_scalar input){
 		*data_return_ptr = input.data.fp64;
 	}
 	else {
-		Library::Logging::Logger().logError(ral::utilities::buildLogString("", "", "", "ERROR: data type not found in scale_to_64_bit_return_bytes"));
+		BLAZING_LOG_ERROR(ral::utilities::buildLogString("", "", "", "ERROR: data type not found in scale_to_64_bit_return_bytes"));
 		data_return = 0;
 	}
 
@@ -2,14 +2,13 @@
 #include "config/GPUManager.cuh"
 #include <blazingdb/manager/Manager.h>
 #include <blazingdb/transport/Client.h>
+#include <blazingdb/transport/ClientPool.h>
 #include <blazingdb/transport/api.h>
 
 namespace ral {
 namespace communication {
 namespace network {
 
-// static std::map<std::pair<std::string, int16_t>, std::shared_ptr<blazingdb::transport::Client> > ral_clients;
-
 // concurrent::send
 blazingdb::transport::Status Client::send(const Node & node, GPUMessage & message) {
 	const auto & metadata = node.address()->metadata();
@@ -17,12 +16,13 @@ blazingdb::transport::Status Client::send(const Node & node, GPUMessage & messag
 	return ral_client->Send(message);
 }
 
-void Client::closeConnections() {
-	// for (auto& c : ral_clients) {
-	//   ral_clients[c.first]->Close();
-	// }
+std::future<blazingdb::transport::Status> Client::sendAsync(const Node & node, std::shared_ptr<GPUMessage> message) {
+	return blazingdb::transport::ClientPool::getInstance().sendAsync(
+		[node, message]() { return Client::send(node, *message); });
 }
 
+void Client::closeConnections() { blazingdb::transport::ClientPool::getInstance().clear(); }
+
 
 blazingdb::transport::Status Client::sendNodeData(std::string ip, int16_t port, Message & message) {
 	auto client = blazingdb::manager::Manager::MakeClient(ip, port);
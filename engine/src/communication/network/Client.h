@@ -3,6 +3,7 @@
 #include <blazingdb/manager/NodeDataMessage.h>
 #include <blazingdb/transport/Message.h>
 #include <blazingdb/transport/Status.h>
+#include <future>
 #include <memory>
 
 namespace ral {
@@ -19,6 +20,9 @@ public:
 public:
 	static Status send(const Node & node, GPUMessage & message);
 
+	// runs the send on the sender threads of the transport ClientPool
+	static std::future<Status> sendAsync(const Node & node, std::shared_ptr<GPUMessage> message);
+
 	static Status sendNodeData(std::string ip, int16_t port, Message & message);
 
 	static void closeConnections();
@@ -42,6 +42,15 @@ std::shared_ptr<GPUMessage> Server::getMessage(
 	return comm_server->getMessage(token_value, messageToken);
 }
 
+std::shared_ptr<GPUMessage> Server::getMessage(
+	const ContextToken & token_value, const MessageTokenType & messageToken, std::chrono::milliseconds timeout) {
+	return comm_server->getMessage(token_value, messageToken, timeout);
+}
+
+void Server::setMessageTimeout(std::chrono::milliseconds timeout) { message_timeout = timeout; }
+
+std::chrono::milliseconds Server::getMessageTimeout() const { return message_timeout; }
+
 void Server::setEndPoints() {
 	// message SampleToNodeMasterMessage
 	{
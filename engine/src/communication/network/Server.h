@@ -2,6 +2,7 @@
 
 #include <blazingdb/transport/Message.h>
 #include <blazingdb/transport/Server.h>
+#include <chrono>
 #include <thread>
 
 namespace ral {
@@ -34,6 +35,14 @@ public:
 public:
 	std::shared_ptr<GPUMessage> getMessage(const ContextToken & token_value, const MessageTokenType & messageToken);
 
+	// Same as getMessage but returns nullptr when the message did not arrive within timeout
+	std::shared_ptr<GPUMessage> getMessage(
+		const ContextToken & token_value, const MessageTokenType & messageToken, std::chrono::milliseconds timeout);
+
+	// How long the distribution primitives wait for the message of another node
+	void setMessageTimeout(std::chrono::milliseconds timeout);
+	std::chrono::milliseconds getMessageTimeout() const;
+
 private:
 	Server(Server &&) = delete;
 
@@ -49,6 +58,7 @@ private:
 private:
 	std::thread thread;
 	std::shared_ptr<CommServer> comm_server;
+	std::chrono::milliseconds message_timeout{std::chrono::minutes(10)};
 
 private:
 	static unsigned short port_;
@@ -14,6 +14,7 @@
 #include "../io/data_provider/DummyProvider.h"
 #include "../io/data_provider/UriDataProvider.h"
 #include "../skip_data/SkipDataProcessor.h"
+#include "../utilities/QueryTrace.h"
 #include "communication/network/Server.h"
 #include <numeric>
 
@@ -310,3 +311,29 @@ TableScanInfo getTableScanInfo(std::string logicalPlan){
 	getTableScanInfo(logicalPlan, relational_algebra_steps, table_names, table_columns);
 	return TableScanInfo{relational_algebra_steps, table_names, table_columns};
 }
+
+void startQueryProfile(int32_t ctxToken) {
+	ral::utilities::query_trace_recorder::getInstance().profile_query(ctxToken);
+}
+
+std::vector<QueryProfileStep> getQueryProfile(int32_t ctxToken) {
+	std::vector<QueryProfileStep> steps;
+	for(auto & event : ral::utilities::query_trace_recorder::getInstance().take_events(ctxToken)) {
+		QueryProfileStep step;
+		step.name = event.name;
+		step.category = event.category;
+		step.query_step = event.query_step;
+		step.query_substep = event.query_substep;
+		step.start_us = event.start_us;
+		step.duration_us = event.duration_us;
+		step.rows_in = event.rows_in;
+		step.rows = event.rows;
+		step.bytes = event.bytes;
+		for(auto & arg : event.args) {
+			step.arg_keys.push_back(arg.first);
+			step.arg_values.push_back(arg.second);
+		}
+		steps.push_back(step);
+	}
+	return steps;
+}
@@ -12,6 +12,7 @@
 
 
 #include <algorithm>
+#include <chrono>
 #include <cuda_runtime.h>
 #include <memory>
 #include <thread>
@@ -26,6 +27,7 @@
 #include <blazingdb/io/Library/Logging/FileOutput.h>
 #include <blazingdb/io/Library/Logging/Logger.h>
 #include "blazingdb/io/Library/Logging/ServiceLogging.h"
+#include <blazingdb/io/Library/Metrics/PrometheusExporter.h>
 #include "utilities/StringUtils.h"
 
 #include "Traits/RuntimeTraits.h"
@@ -38,6 +40,8 @@
 #include "communication/network/Client.h"
 #include "communication/network/Server.h"
 #include <blazingdb/manager/Context.h>
+#include "io/data_parser/metadata/parquet_metadata_cache.h"
+#include "utilities/QueryTrace.h"
 
 
 std::string get_ip(const std::string & iface_name = "eth0") {
@@ -94,11 +98,76 @@ void initialize(int ralId,
 	auto nthread = 4;
 	blazingdb::transport::io::setPinnedBufferProvider(0.1 * total_gpu_mem_size, nthread);
 
+	// none, lz4, zstd, rle or auto, see blazingdb::transport::io::compressionOptionsFromString
+	const char * env_transport_codec = std::getenv("BLAZING_TRANSPORT_CODEC");
+	if(env_transport_codec != nullptr) {
+		blazingdb::transport::io::setCompressionOptions(
+			blazingdb::transport::io::compressionOptionsFromString(env_transport_codec));
+		initLogMsg = initLogMsg + "BLAZING_TRANSPORT_CODEC is set to: " + env_transport_codec + ", ";
+	}
+
+	// bytes of parquet footers kept across queries, 0 disables the cache
+	const char * env_parquet_metadata_cache = std::getenv("BLAZING_PARQUET_METADATA_CACHE_BYTES");
+	if(env_parquet_metadata_cache != nullptr) {
+		ral::io::parquet_metadata_cache::getInstance().set_capacity(std::stoull(env_parquet_metadata_cache));
+		initLogMsg = initLogMsg + "BLAZING_PARQUET_METADATA_CACHE_BYTES is set to: " + env_parquet_metadata_cache + ", ";
+	}
+
+	// a Chrome trace JSON file per query and node is written there, see scripts/merge_traces.py
+	const char * env_trace_dir = std::getenv("BLAZING_TRACE_DIR");
+	if(env_trace_dir != nullptr) {
+		ral::utilities::query_trace_recorder::getInstance().set_output_directory(env_trace_dir);
+		initLogMsg = initLogMsg + "BLAZING_TRACE_DIR is set to: " + env_trace_dir + ", ";
+	}
+
+	// the metrics of the process in the Prometheus text format, served on BLAZING_METRICS_PORT + ralId so the RALs of
+	// a host do not collide, and/or rewritten in BLAZING_METRICS_DIR/ral_<ralId>.prom
+	auto & metricsExporter = Library::Metrics::PrometheusExporter::getInstance();
+	const char * env_metrics_port = std::getenv("BLAZING_METRICS_PORT");
+	if(env_metrics_port != nullptr) {
+		const char * env_metrics_address = std::getenv("BLAZING_METRICS_ADDRESS");
+		std::string metrics_address = env_metrics_address == nullptr ? "127.0.0.1" : env_metrics_address;
+		try {
+			int metrics_port = metricsExporter.startServer(std::stoi(env_metrics_port) + ralId, metrics_address);
+			initLogMsg = initLogMsg + "metrics served on: " + metrics_address + ":" + std::to_string(metrics_port) +
+						 "/metrics, ";
+		} catch(const std::exception & e) {
+			initLogMsg = initLogMsg + "metrics not served: " + e.what() + ", ";
+		}
+	}
+	const char * env_metrics_dir = std::getenv("BLAZING_METRICS_DIR");
+	if(env_metrics_dir != nullptr) {
+		const char * env_metrics_interval = std::getenv("BLAZING_METRICS_INTERVAL_MS");
+		std::chrono::milliseconds metrics_interval(
+			env_metrics_interval == nullptr ? 15000 : std::stoll(env_metrics_interval));
+		std::string metrics_path = std::string(env_metrics_dir) + "/ral_" + std::to_string(ralId) + ".prom";
+		try {
+			metricsExporter.startFileWriter(metrics_path, metrics_interval);
+			initLogMsg = initLogMsg + "metrics written to: " + metrics_path + ", ";
+		} catch(const std::exception & e) {
+			initLogMsg = initLogMsg + "metrics not written: " + e.what() + ", ";
+		}
+	}
+
+	// TRACE, DEBUG, INFO (the default), WARN, ERROR or FATAL, read by Library::Logging when it is loaded
+	const char * env_log_level = std::getenv("BLAZING_LOG_LEVEL");
+	if(env_log_level != nullptr) {
+		initLogMsg = initLogMsg + "BLAZING_LOG_LEVEL is set to: " + env_log_level + ", ";
+	}
+
 	auto & communicationData = ral::communication::CommunicationData::getInstance();
 	communicationData.initialize(ralId, "1.1.1.1", 0, ralHost, ralCommunicationPort, 0);
 
 	ral::communication::network::Server::start(ralCommunicationPort);
 
+	// how long a node waits for the shuffle messages of the others before the query fails
+	const char * env_message_timeout = std::getenv("BLAZING_MESSAGE_TIMEOUT_MS");
+	if(env_message_timeout != nullptr) {
+		ral::communication::network::Server::getInstance().setMessageTimeout(
+			std::chrono::milliseconds(std::stoll(env_message_timeout)));
+		initLogMsg = initLogMsg + "BLAZING_MESSAGE_TIMEOUT_MS is set to: " + env_message_timeout + ", ";
+	}
+
 	if(singleNode == true) {
 		ral::communication::network::Server::getInstance().close();
 	}
@@ -111,7 +180,7 @@ void initialize(int ralId,
 	Library::Logging::ServiceLogging::getInstance().setLogOutput(output);
 	Library::Logging::ServiceLogging::getInstance().setNodeIdentifier(ralId);
 	
-	Library::Logging::Logger().logTrace(ral::utilities::buildLogString("0","0","0",
+	BLAZING_LOG_INFO(ral::utilities::buildLogString("0","0","0",
 		initLogMsg));
 
 	// Init AWS S3 ... TODO see if we need to call shutdown and avoid leaks from s3 percy
@@ -121,6 +190,8 @@ void initialize(int ralId,
 void finalize() {
 	ral::communication::network::Client::closeConnections();
 	ral::communication::network::Server::getInstance().close();
+	// writes the metrics file a last time
+	Library::Metrics::PrometheusExporter::getInstance().stop();
 	cudaDeviceReset();
 	exit(0);
 }
@@ -15,6 +15,7 @@
 #include <blazingdb/io/FileSystem/FileSystemManager.h>
 #include <blazingdb/io/FileSystem/HadoopFileSystem.h>
 #include <blazingdb/io/FileSystem/S3FileSystem.h>
+#include <blazingdb/io/Util/GlobPattern.h>
 
 // #include <blazingdb/io/Library/Logging/TcpOutput.h>
 // #include "blazingdb/io/Library/Network/NormalSyncSocket.h"
@@ -50,6 +51,19 @@ TableSchema parseSchema(std::vector<std::string> files,
 	for(auto file_path : files) {
 		uris.push_back(Uri{file_path});
 	}
+
+	// the table is made of the files as they are now: forget the statuses and listings cached under the deepest
+	// directory of each path without wildcards, e.g. of files another process added or rewrote since
+	auto fs_manager = BlazingContext::getInstance()->getFileSystemManager();
+	for(const Uri & uri : uris) {
+		const std::string literal_prefix = GlobPattern(uri.getPath().toString()).getLiteralPrefix();
+		const size_t slash = literal_prefix.rfind('/');
+		if(fs_manager && slash != std::string::npos) {
+			const Path directory(literal_prefix.substr(0, slash + 1), false);
+			fs_manager->invalidate(Uri(uri.getScheme(), uri.getAuthority(), directory));
+		}
+	}
+
 	auto provider = std::make_shared<ral::io::uri_data_provider>(uris);
 	auto loader = std::make_shared<ral::io::data_loader>(parser, provider);
 
@@ -234,7 +248,13 @@ std::pair<bool, std::string> registerFileSystemS3(S3 s3, std::string root, std::
 		s3.sessionToken);
 	return registerFileSystem(fileSystemConnection, root, authority);
 }
-std::pair<bool, std::string> registerFileSystemLocal(std::string root, std::string authority) {
+std::pair<bool, std::string> registerFileSystemLocal(Local local, std::string root, std::string authority) {
 	FileSystemConnection fileSystemConnection = FileSystemConnection(FileSystemType::LOCAL);
+	if(local.readMode != (short) LocalFileSystemConnection::ReadMode::UNDEFINED) {
+		fileSystemConnection = FileSystemConnection((LocalFileSystemConnection::ReadMode) local.readMode,
+			(LocalFileSystemConnection::MmapAdvice) local.mmapAdvice,
+			local.ioUringQueueDepth,
+			local.directIo);
+	}
 	return registerFileSystem(fileSystemConnection, root, authority);
 }
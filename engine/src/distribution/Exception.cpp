@@ -11,5 +11,14 @@ MessageMismatchException createMessageMismatchException(
 	return MessageMismatchException(std::move(message));
 }
 
+MessageTimeoutException::MessageTimeoutException(std::string && message) : BaseRalException{std::move(message)} {}
+
+MessageTimeoutException createMessageTimeoutException(
+	const char * function, const std::string & expected, std::chrono::milliseconds timeout) {
+	std::string message{"[ERROR][" + std::string{function} + "][expected:" + expected + "][not received within " +
+						std::to_string(timeout.count()) + " ms]"};
+	return MessageTimeoutException(std::move(message));
+}
+
 }  // namespace distribution
 }  // namespace ral
@@ -2,6 +2,7 @@
 #define BLAZINGDB_RAL_DISTRIBUTION_EXCEPTION_H
 
 #include "exception/RalException.h"
+#include <chrono>
 
 namespace ral {
 namespace distribution {
@@ -14,6 +15,14 @@ public:
 MessageMismatchException createMessageMismatchException(
 	const char * function, const std::string & expected, const std::string & obtained);
 
+class MessageTimeoutException : public ral::exception::BaseRalException {
+public:
+	MessageTimeoutException(std::string && message);
+};
+
+MessageTimeoutException createMessageTimeoutException(
+	const char * function, const std::string & expected, std::chrono::milliseconds timeout);
+
 }  // namespace distribution
 }  // namespace ral
 
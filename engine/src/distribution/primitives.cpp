@@ -20,10 +20,14 @@
 #include "utilities/TableWrapper.h"
 #include <algorithm>
 #include <blazingdb/io/Library/Logging/Logger.h>
+#include <blazingdb/transport/BroadcastTree.h>
 #include <cassert>
+#include <chrono>
 #include <cmath>
+#include <future>
 #include <cudf/legacy/table.hpp>
 #include <iostream>
+#include <iterator>
 #include <memory>
 #include <numeric>
 #include <types.hpp>
@@ -33,6 +37,7 @@
 #include "cudf/legacy/search.hpp"
 
 #include "utilities/CommonOperations.h"
+#include "utilities/QueryTrace.h"
 
 namespace ral {
 namespace distribution {
@@ -114,6 +119,24 @@ void normalizeSamples(std::vector<NodeSamples> & samples) {
 namespace ral {
 namespace distribution {
 
+namespace {
+
+// Waits for the next message_id message of the context. A node that failed or never sends would otherwise block the
+// query forever, so the wait is bounded by the server message timeout.
+std::shared_ptr<ral::communication::network::GPUMessage> receiveMessage(
+	const uint32_t context_token, const std::string & message_id, const char * function) {
+	using ral::communication::network::Server;
+
+	const std::chrono::milliseconds timeout = Server::getInstance().getMessageTimeout();
+	auto message = Server::getInstance().getMessage(context_token, message_id, timeout);
+	if(message == nullptr) {
+		throw createMessageTimeoutException(function, message_id, timeout);
+	}
+	return message;
+}
+
+}  // namespace
+
 void sendSamplesToMaster(const Context & context, std::vector<gdf_column_cpp> & samples, std::size_t total_row_size) {
 	using MessageFactory = ral::communication::messages::Factory;
 	using SampleToNodeMasterMessage = ral::communication::messages::SampleToNodeMasterMessage;
@@ -135,10 +158,15 @@ void sendSamplesToMaster(const Context & context, std::vector<gdf_column_cpp> &
 
 	// Send message to master
 	using Client = ral::communication::network::Client;
-	Library::Logging::Logger().logTrace(ral::utilities::buildLogString(std::to_string(context_token),
+	BLAZING_LOG_TRACE(ral::utilities::buildLogString(std::to_string(context_token),
 		std::to_string(context.getQueryStep()),
 		std::to_string(context.getQuerySubstep()),
 		"About to send sendSamplesToMaster message"));
+	ral::utilities::trace_span send_span(context, "shuffle", "send samples");
+	send_span.set_rows(samples.size() > 0 ? samples[0].size() : 0);
+	send_span.set_bytes(ral::utilities::getTableSizeInBytes(samples));
+	send_span.set_arg("message_id", message_id);
+	send_span.set_arg("to", std::to_string(context.getNodeIndex(master_node)));
 	Client::send(master_node, *message);
 }
 
@@ -154,7 +182,8 @@ std::vector<NodeSamples> collectSamples(const Context & context) {
 	size_t size = context.getWorkerNodes().size();
 	std::vector<bool> received(context.getTotalNodes(), false);
 	for(int k = 0; k < size; ++k) {
-		auto message = Server::getInstance().getMessage(context_token, message_id);
+		ral::utilities::trace_span receive_span(context, "shuffle", "receive samples");
+		auto message = receiveMessage(context_token, message_id, __FUNCTION__);
 
 		if(message->getMessageTokenValue() != message_id) {
 			throw createMessageMismatchException(__FUNCTION__, message_id, message->getMessageTokenValue());
@@ -164,13 +193,15 @@ std::vector<NodeSamples> collectSamples(const Context & context) {
 		auto node = message->getSenderNode();
 		int node_idx = context.getNodeIndex(*node);
 		if(received[node_idx]) {
-			Library::Logging::Logger().logError(ral::utilities::buildLogString(std::to_string(context_token),
+			BLAZING_LOG_ERROR(ral::utilities::buildLogString(std::to_string(context_token),
 				std::to_string(context.getQueryStep()),
 				std::to_string(context.getQuerySubstep()),
 				"ERROR: Already received collectSamples from node " + std::to_string(node_idx)));
 		}
 		nodeSamples.emplace_back(concreteMessage->getTotalRowSize(), *node, concreteMessage->getSamples());
 		received[node_idx] = true;
+		receive_span.set_arg("message_id", message_id);
+		receive_span.set_arg("from", std::to_string(node_idx));
 	}
 
 	return nodeSamples;
@@ -299,7 +330,7 @@ void distributePartitionPlan(const Context & context, std::vector<gdf_column_cpp
 
 	auto node = CommunicationData::getInstance().getSharedSelfNode();
 	auto message = Factory::createPartitionPivotsMessage(message_id, context_token, node, pivots);
-	broadcastMessage(context.getWorkerNodes(), message);
+	treeBroadcastMessage(context.getAllNodes(), message);
 }
 
 std::vector<gdf_column_cpp> getPartitionPlan(const Context & context) {
@@ -310,12 +341,15 @@ std::vector<gdf_column_cpp> getPartitionPlan(const Context & context) {
 	const uint32_t context_token = context.getContextToken();
 	const std::string message_id = PartitionPivotsMessage::MessageID() + "_" + std::to_string(context_comm_token);
 
-	auto message = Server::getInstance().getMessage(context_token, message_id);
+	auto message = receiveMessage(context_token, message_id, __FUNCTION__);
 
 	if(message->getMessageTokenValue() != message_id) {
 		throw createMessageMismatchException(__FUNCTION__, message_id, message->getMessageTokenValue());
 	}
 
+	// the master sent the plan through a broadcast tree
+	treeBroadcastMessage(context.getAllNodes(), message);
+
 	auto concreteMessage = std::static_pointer_cast<PartitionPivotsMessage>(message);
 
 	return concreteMessage->getColumns();
@@ -530,20 +564,30 @@ void distributePartitions(const Context & context, std::vector<NodeColumns> & pa
 	const std::string message_id = ColumnDataMessage::MessageID() + "_" + std::to_string(context_comm_token);
 
 	auto self_node = CommunicationData::getInstance().getSharedSelfNode();
-	std::vector<std::thread> threads;
+	ral::utilities::trace_span send_span(context, "shuffle", "send partitions");
+	std::vector<std::future<Client::Status>> sends;
+	std::string destinations;
+	int64_t rows = 0;
+	int64_t bytes = 0;
 	for(auto & nodeColumn : partitions) {
 		if(nodeColumn.getNode() == *self_node) {
 			continue;
 		}
-		std::vector<gdf_column_cpp> columns = nodeColumn.getColumns();
-		auto destination_node = nodeColumn.getNode();
-		threads.push_back(std::thread([message_id, context_token, self_node, destination_node, columns]() mutable {
-			auto message = Factory::createColumnDataMessage(message_id, context_token, self_node, columns);
-			Client::send(destination_node, *message);
-		}));
+		if(send_span.is_active()) {
+			std::vector<gdf_column_cpp> columns = nodeColumn.getColumns();
+			destinations += (destinations.empty() ? "" : ",") + std::to_string(context.getNodeIndex(nodeColumn.getNode()));
+			rows += columns.size() > 0 ? columns[0].size() : 0;
+			bytes += ral::utilities::getTableSizeInBytes(columns);
+		}
+		auto message = Factory::createColumnDataMessage(message_id, context_token, self_node, nodeColumn.getColumns());
+		sends.push_back(Client::sendAsync(nodeColumn.getNode(), message));
 	}
-	for(size_t i = 0; i < threads.size(); i++) {
-		threads[i].join();
+	send_span.set_rows(rows);
+	send_span.set_bytes(bytes);
+	send_span.set_arg("message_id", message_id);
+	send_span.set_arg("to", destinations);
+	for(auto & send : sends) {
+		send.get();
 	}
 }
 
@@ -552,8 +596,9 @@ std::vector<NodeColumns> collectPartitions(const Context & context) {
 	return collectSomePartitions(context, num_partitions);
 }
 
-std::vector<NodeColumns> collectSomePartitions(const Context & context, int num_partitions) {
+std::vector<NodeColumns> collectSomePartitions(const Context & context, int num_partitions, bool relay_broadcast) {
 	using ral::communication::messages::ColumnDataMessage;
+	using ral::communication::network::Client;
 	using ral::communication::network::Server;
 
 	// Get the numbers of rals in the query
@@ -568,41 +613,63 @@ std::vector<NodeColumns> collectSomePartitions(const Context & context, int num_
 	const uint32_t context_token = context.getContextToken();
 	const std::string message_id = ColumnDataMessage::MessageID() + "_" + std::to_string(context_comm_token);
 
+	std::vector<std::future<Client::Status>> relays;
 	while(0 < num_partitions) {
-		auto message = Server::getInstance().getMessage(context_token, message_id);
+		ral::utilities::trace_span receive_span(context, "shuffle", "receive partition");
+		auto message = receiveMessage(context_token, message_id, __FUNCTION__);
 		num_partitions--;
 
 		if(message->getMessageTokenValue() != message_id) {
 			throw createMessageMismatchException(__FUNCTION__, message_id, message->getMessageTokenValue());
 		}
 
+		if(relay_broadcast) {
+			auto sends = sendToBroadcastTreeChildren(context.getAllNodes(), message);
+			std::move(sends.begin(), sends.end(), std::back_inserter(relays));
+		}
+
 		auto column_message = std::static_pointer_cast<ColumnDataMessage>(message);
 		auto node = message->getSenderNode();
 		int node_idx = context.getNodeIndex(*node);
 		if(received[node_idx]) {
-			Library::Logging::Logger().logError(ral::utilities::buildLogString(std::to_string(context_token),
+			BLAZING_LOG_ERROR(ral::utilities::buildLogString(std::to_string(context_token),
 				std::to_string(context.getQueryStep()),
 				std::to_string(context.getQuerySubstep()),
 				"ERROR: Already received collectSomePartitions from node " + std::to_string(node_idx)));
 		}
 		node_columns.emplace_back(*node, column_message->getColumns());
 		received[node_idx] = true;
+		if(receive_span.is_active()) {
+			const std::vector<gdf_column_cpp> & columns = node_columns.back().getColumns();
+			receive_span.set_rows(columns.size() > 0 ? columns[0].size() : 0);
+			receive_span.set_bytes(ral::utilities::getTableSizeInBytes(columns));
+			receive_span.set_arg("message_id", message_id);
+			receive_span.set_arg("from", std::to_string(node_idx));
+		}
+	}
+	for(auto & relay : relays) {
+		relay.get();
 	}
 	return node_columns;
 }
 
 void scatterData(const Context & context, std::vector<gdf_column_cpp> & table) {
 	using ral::communication::CommunicationData;
+	using ral::communication::messages::ColumnDataMessage;
+	using ral::communication::messages::Factory;
 
-	std::vector<NodeColumns> array_node_columns;
-	auto nodes = context.getAllNodes();
-	for(std::size_t i = 0; i < nodes.size(); ++i) {
-		if(!(*(nodes[i].get()) == CommunicationData::getInstance().getSelfNode())) {
-			std::vector<gdf_column_cpp> columns = table;
-			array_node_columns.emplace_back(*nodes[i], std::move(columns));
-		}
-	}
-	distributePartitions(context, array_node_columns);
+	const uint32_t context_comm_token = context.getContextCommunicationToken();
+	const uint32_t context_token = context.getContextToken();
+	const std::string message_id = ColumnDataMessage::MessageID() + "_" + std::to_string(context_comm_token);
+
+	auto self_node = CommunicationData::getInstance().getSharedSelfNode();
+	ral::utilities::trace_span send_span(context, "shuffle", "scatter");
+	send_span.set_rows(table.size() > 0 ? table[0].size() : 0);
+	send_span.set_bytes(ral::utilities::getTableSizeInBytes(table));
+	send_span.set_arg("message_id", message_id);
+	send_span.set_arg("to", "all");
+	auto message = Factory::createColumnDataMessage(message_id, context_token, self_node, table);
+	treeBroadcastMessage(context.getAllNodes(), message);
 }
 
 void sortedMerger(std::vector<NodeColumns> & columns,
@@ -810,7 +877,7 @@ std::vector<gdf_size_type> collectRowSize(const Context & context) {
 
 	int self_node_idx = context.getNodeIndex(CommunicationData::getInstance().getSelfNode());
 	for(gdf_size_type i = 0; i < num_nodes - 1; ++i) {
-		auto message = Server::getInstance().getMessage(context_token, message_id);
+		auto message = receiveMessage(context_token, message_id, __FUNCTION__);
 		if(message->getMessageTokenValue() != message_id) {
 			throw createMessageMismatchException(__FUNCTION__, message_id, message->getMessageTokenValue());
 		}
@@ -819,7 +886,7 @@ std::vector<gdf_size_type> collectRowSize(const Context & context) {
 		int node_idx = context.getNodeIndex(*node);
 		assert(node_idx >= 0);
 		if(received[node_idx]) {
-			Library::Logging::Logger().logError(ral::utilities::buildLogString(std::to_string(context_token),
+			BLAZING_LOG_ERROR(ral::utilities::buildLogString(std::to_string(context_token),
 				std::to_string(context.getQueryStep()),
 				std::to_string(context.getQuerySubstep()),
 				"ERROR: Already received collectRowSize from node " + std::to_string(node_idx)));
@@ -871,7 +938,7 @@ void collectLeftRightNumRows(const Context & context,
 
 	int self_node_idx = context.getNodeIndex(CommunicationData::getInstance().getSelfNode());
 	for(gdf_size_type i = 0; i < num_nodes - 1; ++i) {
-		auto message = Server::getInstance().getMessage(context_token, message_id);
+		auto message = receiveMessage(context_token, message_id, __FUNCTION__);
 		if(message->getMessageTokenValue() != message_id) {
 			throw createMessageMismatchException(__FUNCTION__, message_id, message->getMessageTokenValue());
 		}
@@ -889,7 +956,7 @@ void collectLeftRightNumRows(const Context & context,
 		int node_idx = context.getNodeIndex(*node);
 		assert(node_idx >= 0);
 		if(received[node_idx]) {
-			Library::Logging::Logger().logError(ral::utilities::buildLogString(std::to_string(context_token),
+			BLAZING_LOG_ERROR(ral::utilities::buildLogString(std::to_string(context_token),
 				std::to_string(context.getQueryStep()),
 				std::to_string(context.getQuerySubstep()),
 				"ERROR: Already received collectLeftRightNumRows from node " + std::to_string(node_idx)));
@@ -1033,17 +1100,46 @@ std::vector<NodeColumns> generateJoinPartitions(
 }
 
 
+std::vector<std::future<communication::network::Client::Status>> sendToBroadcastTreeChildren(
+	const std::vector<std::shared_ptr<Node>> & nodes, std::shared_ptr<communication::messages::Message> message) {
+	using ral::communication::CommunicationData;
+	using ral::communication::network::Client;
+
+	auto nodeIndex = [&nodes](const Node & node) {
+		auto it = std::find_if(
+			nodes.cbegin(), nodes.cend(), [&node](const std::shared_ptr<Node> & n) { return *n == node; });
+		if(it == nodes.cend()) {
+			throw std::runtime_error("treeBroadcastMessage: node is not part of the broadcast");
+		}
+		return static_cast<int>(std::distance(nodes.cbegin(), it));
+	};
+	const int root = nodeIndex(*message->getSenderNode());
+	const int self = nodeIndex(CommunicationData::getInstance().getSelfNode());
+
+	std::vector<std::future<Client::Status>> sends;
+	for(int child : blazingdb::transport::binomialTreeChildren(nodes.size(), root, self)) {
+		sends.push_back(Client::sendAsync(*nodes[child], message));
+	}
+	return sends;
+}
+
+void treeBroadcastMessage(
+	const std::vector<std::shared_ptr<Node>> & nodes, std::shared_ptr<communication::messages::Message> message) {
+	for(auto & send : sendToBroadcastTreeChildren(nodes, message)) {
+		send.get();
+	}
+}
+
 void broadcastMessage(
 	std::vector<std::shared_ptr<Node>> nodes, std::shared_ptr<communication::messages::Message> message) {
-	std::vector<std::thread> threads(nodes.size());
-	for(size_t i = 0; i < nodes.size(); i++) {
-		std::shared_ptr<Node> node = nodes[i];
-		threads[i] = std::thread([node, message]() {
-			ral::communication::network::Client::send(*node, *message);
-		});
+	using ral::communication::network::Client;
+
+	std::vector<std::future<Client::Status>> sends;
+	for(auto & node : nodes) {
+		sends.push_back(Client::sendAsync(*node, message));
 	}
-	for(size_t i = 0; i < threads.size(); i++) {
-		threads[i].join();
+	for(auto & send : sends) {
+		send.get();
 	}
 }
 
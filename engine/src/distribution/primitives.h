@@ -5,8 +5,10 @@
 #include "GDFColumn.cuh"
 #include "blazingdb/manager/Context.h"
 #include "communication/factory/MessageFactory.h"
+#include "communication/network/Client.h"
 #include "distribution/NodeColumns.h"
 #include "distribution/NodeSamples.h"
+#include <future>
 #include <vector>
 
 namespace ral {
@@ -83,9 +85,13 @@ std::vector<NodeColumns> partitionData(const Context & context,
 void distributePartitions(const Context & context, std::vector<NodeColumns> & partitions);
 
 std::vector<NodeColumns> collectPartitions(const Context & context);
-std::vector<NodeColumns> collectSomePartitions(const Context & context, int num_partitions);
+// relay_broadcast forwards every partition received from scatterData to the children of this node in the
+// broadcast tree of its sender
+std::vector<NodeColumns> collectSomePartitions(
+	const Context & context, int num_partitions, bool relay_broadcast = false);
 
-// this functions sends the data in table to all nodes except itself
+// this functions sends the data in table to all nodes except itself, through treeBroadcastMessage. The receivers
+// must collect it with relay_broadcast set.
 void scatterData(const Context & context, std::vector<gdf_column_cpp> & table);
 
 void sortedMerger(std::vector<NodeColumns> & columns,
@@ -111,6 +117,16 @@ void collectLeftRightNumRows(const Context & context,
 void broadcastMessage(
 	std::vector<std::shared_ptr<Node>> nodes, std::shared_ptr<communication::messages::Message> message);
 
+// Sends message to the children of this node in the binomial tree over nodes rooted at the message sender.
+// The sender calls it to start the broadcast and every receiver calls it again on the received message, so
+// no node sends more than log2(nodes) copies. nodes must be in the same order on every node.
+void treeBroadcastMessage(
+	const std::vector<std::shared_ptr<Node>> & nodes, std::shared_ptr<communication::messages::Message> message);
+
+// non-blocking form of treeBroadcastMessage, the caller waits for the returned sends
+std::vector<std::future<communication::network::Client::Status>> sendToBroadcastTreeChildren(
+	const std::vector<std::shared_ptr<Node>> & nodes, std::shared_ptr<communication::messages::Message> message);
+
 }  // namespace distribution
 }  // namespace ral
 
@@ -3,8 +3,11 @@
 #include "Traits/RuntimeTraits.h"
 #include "config/GPUManager.cuh"
 #include "cudf/legacy/filling.hpp"
+#include "data_provider/UriDataProvider.h"
 #include "rmm/thrust_rmm_allocator.h"
+#include "skip_data/partition_pruning.hpp"
 #include "utilities/CommonOperations.h"
+#include "utilities/QueryTrace.h"
 #include "utilities/StringUtils.h"
 #include <CodeTimer.h>
 #include <blazingdb/io/Library/Logging/Logger.h>
@@ -36,6 +39,7 @@ void data_loader::load_data(const Context & context,
 	std::vector<data_handle> files;
 
 	// iterates through files and parses them into columns
+	ral::utilities::trace_span open_span(context, "scan", "open files");
 	while(this->provider->has_next()) {
 		// std::cout<<"pushing back files!"<<std::endl;
 		// a file handle that we can use in case errors occur to tell the user which file had parsing issues
@@ -43,6 +47,8 @@ void data_loader::load_data(const Context & context,
 		files.push_back(this->provider->get_next());
 	}
 	// std::cout<<"pushed back"<<std::endl;
+	open_span.set_arg("files", std::to_string(files.size()));
+	open_span.end();
 
 	columns_per_file.resize(files.size());
 	// TODO NOTE percy c.gonzales rommel fix our concurrent reads here (better use of thread)
@@ -52,6 +58,8 @@ void data_loader::load_data(const Context & context,
 	for(int file_index = 0; file_index < files.size(); file_index++) {
 		threads.push_back(std::thread([&, file_index]() {
 			// std::cout<<"starting file thread"<<std::endl;
+			ral::utilities::trace_span parse_span(context, "scan", "parse file");
+			parse_span.set_arg("file", user_readable_file_handles[file_index]);
 			std::vector<gdf_column_cpp> converted_data;
 			// std::cout<<"converted data"<<std::endl;
 
@@ -60,7 +68,7 @@ void data_loader::load_data(const Context & context,
 				// std::cout<<"file is "<< user_readable_file_handles[file_index]<<" with uri
 				// "<<files[file_index].uri.getPath().toString()<<std::endl;
 				Schema fileSchema = schema.fileSchema(file_index);
-				parser->parse(files[file_index].fileHandle,
+				parser->parse(files[file_index],
 					user_readable_file_handles[file_index],
 					converted_data,
 					fileSchema,
@@ -95,8 +103,10 @@ void data_loader::load_data(const Context & context,
 				}
 
 				columns_per_file[file_index] = converted_data;
+				parse_span.set_rows(converted_data.size() > 0 ? converted_data[0].size() : 0);
+				parse_span.set_bytes(ral::utilities::getTableSizeInBytes(converted_data));
 			} else {
-				Library::Logging::Logger().logError(ral::utilities::buildLogString(
+				BLAZING_LOG_ERROR(ral::utilities::buildLogString(
 					"", "", "", "ERROR: Was unable to open " + user_readable_file_handles[file_index]));
 			}
 		}));
@@ -104,14 +114,14 @@ void data_loader::load_data(const Context & context,
 
 	std::for_each(threads.begin(), threads.end(), [](std::thread & this_thread) { this_thread.join(); });
 	// std::cout<<"finished loading!"<<std::endl;
-	Library::Logging::Logger().logInfo(timer.logDuration(context, "data_loader::load_data part 1 parse"));
+	BLAZING_LOG_INFO(timer.logDuration(context, "data_loader::load_data part 1 parse"));
 	timer.reset();
 
 	// checking if any errors occurred
 	std::vector<std::string> provider_errors = this->provider->get_errors();
 	if(provider_errors.size() != 0) {
 		for(size_t error_index = 0; error_index < provider_errors.size(); error_index++) {
-			Library::Logging::Logger().logError(
+			BLAZING_LOG_ERROR(
 				ral::utilities::buildLogString("", "", "", "ERROR: " + provider_errors[error_index]));
 		}
 	}
@@ -139,22 +149,59 @@ void data_loader::load_data(const Context & context,
 
 	} else {  // we have more than one file so we need to concatenate
 			  // std::cout<<"concatting!"<<std::endl;
+		ral::utilities::trace_span concat_span(context, "scan", "concat files");
 		columns = ral::utilities::concatTables(columns_per_file);
 		// std::cout<<"concatted!"<<std::endl;
 	}
 
-	Library::Logging::Logger().logInfo(timer.logDuration(context, "data_loader::load_data part 2 concat"));
+	BLAZING_LOG_INFO(timer.logDuration(context, "data_loader::load_data part 2 concat"));
 	timer.reset();
 }
 
+data_loader data_loader::prune_partitions(const Context & context,
+	const std::string & filter_expression,
+	const std::vector<size_t> & column_indices,
+	const Schema & schema) {
+	CodeTimer timer;
+	timer.reset();
+	ral::utilities::trace_span prune_span(context, "scan", "prune_partitions");
+
+	std::vector<bool> in_file = schema.get_in_file();
+	auto provider = std::dynamic_pointer_cast<uri_data_provider>(this->provider);
+	if(provider == nullptr || std::find(in_file.begin(), in_file.end(), false) == in_file.end()) {
+		return *this;
+	}
+
+	std::vector<std::string> column_names = schema.get_names();
+	if(column_indices.size() > 0) {
+		std::vector<std::string> projected_names;
+		for(size_t column_index : column_indices) {
+			projected_names.push_back(column_names[column_index]);
+		}
+		column_names = projected_names;
+	}
+
+	ral::skip_data::partition_filter filter(filter_expression, column_names);
+	if(!filter.is_valid()) {
+		return *this;
+	}
+	std::shared_ptr<uri_data_provider> pruned_provider =
+		provider->prune_partitions([&filter](const data_handle & partition) { return filter.can_skip(partition); });
+
+	BLAZING_LOG_INFO(timer.logDuration(context,
+		"data_loader::prune_partitions",
+		"num partitions",
+		provider->get_num_uris(),
+		"num partitions pruned",
+		provider->get_num_uris() - pruned_provider->get_num_uris()));
+	prune_span.set_arg("partitions", std::to_string(provider->get_num_uris()));
+	prune_span.set_arg("partitions_pruned", std::to_string(provider->get_num_uris() - pruned_provider->get_num_uris()));
+	return data_loader(this->parser, pruned_provider);
+}
+
 void data_loader::get_schema(Schema & schema, std::vector<std::pair<std::string, gdf_dtype>> non_file_columns) {
-	std::vector<std::shared_ptr<arrow::io::RandomAccessFile>> files;
-	bool firstIteration = true;
 	std::vector<data_handle> handles = this->provider->get_all();
-	for(auto handle : handles) {
-		files.push_back(handle.fileHandle);
-	}
-	this->parser->parse_schema(files, schema);
+	this->parser->parse_schema(handles, schema);
 
 	for(auto handle : handles) {
 		schema.add_file(handle.uri.toString(true));
@@ -166,16 +213,8 @@ void data_loader::get_schema(Schema & schema, std::vector<std::pair<std::string,
 }
 
 void data_loader::get_metadata(Metadata & metadata, std::vector<std::pair<std::string, gdf_dtype>> non_file_columns) {
-	std::vector<std::shared_ptr<arrow::io::RandomAccessFile>> files;
-	// std::vector<std::string> user_readable_file_handles;
-
-	bool firstIteration = true;
 	std::vector<data_handle> handles = this->provider->get_all();
-	for(auto handle : handles) {
-		files.push_back(handle.fileHandle);
-		// user_readable_file_handles.push_back(handle.uri.toString());
-	}
-	if (this->parser->get_metadata(files,  metadata) == false) {
+	if (this->parser->get_metadata(handles,  metadata) == false) {
 		throw std::runtime_error("No metadata for this data file");
 	}
 	//TODO, non_file_columns hive feature, @percy
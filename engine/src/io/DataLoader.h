@@ -52,6 +52,17 @@ public:
 		const std::vector<size_t> & column_indices,
 		const Schema & schema);
 
+	/**
+	 * returns a loader over the hive partitions whose partition values may pass the filter of a BindableTableScan,
+	 * the other partitions are dropped before any of their files is listed or opened
+	 * @param filter_expression the filter of the scan, as cleaned by clean_calcite_expression
+	 * @param column_indices the projections of the scan, the filter refers to the projected columns
+	 */
+	data_loader prune_partitions(const Context & context,
+		const std::string & filter_expression,
+		const std::vector<size_t> & column_indices,
+		const Schema & schema);
+
 	void get_schema(Schema & schema, std::vector<std::pair<std::string, gdf_dtype>> non_file_columns);
 
 	void get_metadata(Metadata & metadata, std::vector<std::pair<std::string, gdf_dtype>> non_file_columns);
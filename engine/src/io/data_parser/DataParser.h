@@ -10,6 +10,7 @@
 
 #include "../Metadata.h"
 #include "../Schema.h"
+#include "../data_provider/DataProvider.h"
 #include "GDFColumn.cuh"
 #include "arrow/io/interfaces.h"
 #include <memory>
@@ -38,6 +39,34 @@ public:
 	virtual bool get_metadata(std::vector<std::shared_ptr<arrow::io::RandomAccessFile>> files, ral::io::Metadata & metadata) {
 		return false;
 	}
+
+	/**
+	 * The data_handle versions also know the uri of each file. Parsers override them to reuse what they read from
+	 * a file across queries, the others just parse the files.
+	 */
+	virtual void parse(data_handle handle,
+		const std::string & user_readable_file_handle,
+		std::vector<gdf_column_cpp> & columns,
+		const Schema & schema,
+		std::vector<size_t> column_indices) {
+		parse(handle.fileHandle, user_readable_file_handle, columns, schema, column_indices);
+	}
+
+	virtual void parse_schema(std::vector<data_handle> handles, ral::io::Schema & schema) {
+		std::vector<std::shared_ptr<arrow::io::RandomAccessFile>> files;
+		for(auto & handle : handles) {
+			files.push_back(handle.fileHandle);
+		}
+		parse_schema(files, schema);
+	}
+
+	virtual bool get_metadata(std::vector<data_handle> handles, ral::io::Metadata & metadata) {
+		std::vector<std::shared_ptr<arrow::io::RandomAccessFile>> files;
+		for(auto & handle : handles) {
+			files.push_back(handle.fileHandle);
+		}
+		return get_metadata(files, metadata);
+	}
 };
 
 } /* namespace io */
@@ -1,8 +1,10 @@
 
 #include "metadata/parquet_metadata.h"
+#include "metadata/parquet_metadata_cache.h"
 
 #include "ParquetParser.h"
 #include "config/GPUManager.cuh"
+#include <blazingdb/io/FileSystem/CoalescingReadableFile.h>
 #include <blazingdb/io/Util/StringUtil.h>
 #include <cudf/legacy/column.hpp>
 #include <cudf/legacy/io_functions.hpp>
@@ -146,29 +148,109 @@ constexpr std::pair<gdf_dtype, gdf_dtype_extra_info> to_dtype(parquet::Type::typ
 	return std::make_pair(GDF_invalid, gdf_dtype_extra_info{TIME_UNIT_NONE});
 }
 
-void parquet_parser::parse_schema(
-	std::vector<std::shared_ptr<arrow::io::RandomAccessFile>> files, ral::io::Schema & schema_out) {
+namespace {
+
+std::vector<data_handle> to_handles(const std::vector<std::shared_ptr<arrow::io::RandomAccessFile>> & files) {
+	std::vector<data_handle> handles(files.size());
+	for(size_t file_index = 0; file_index < files.size(); file_index++) {
+		handles[file_index].fileHandle = files[file_index];
+	}
+	return handles;
+}
+
+// The byte ranges the cudf reader will read: the footer and the chunks of the requested columns in every row group
+std::vector<ReadRange> get_planned_reads(const parquet::FileMetaData & file_metadata,
+	int64_t file_size,
+	const Schema & schema,
+	const std::vector<size_t> & column_indices) {
+	std::vector<ReadRange> ranges;
+	// the footer, its length and the magic number
+	const int64_t footer_size = file_metadata.size() + 8;
+	ranges.push_back(ReadRange{std::max<int64_t>(0, file_size - footer_size), footer_size});
+
+	std::vector<int> leaf_indices;
+	for(size_t column_index : column_indices) {
+		const int leaf_index = file_metadata.schema()->ColumnIndex(schema.get_name(column_index));
+		if(leaf_index >= 0) {
+			leaf_indices.push_back(leaf_index);
+		}
+	}
+	for(int row_group_index = 0; row_group_index < file_metadata.num_row_groups(); row_group_index++) {
+		std::unique_ptr<parquet::RowGroupMetaData> row_group = file_metadata.RowGroup(row_group_index);
+		for(int leaf_index : leaf_indices) {
+			std::unique_ptr<parquet::ColumnChunkMetaData> column_chunk = row_group->ColumnChunk(leaf_index);
+			const int64_t offset = column_chunk->has_dictionary_page() && column_chunk->dictionary_page_offset() > 0
+									   ? column_chunk->dictionary_page_offset()
+									   : column_chunk->data_page_offset();
+			ranges.push_back(ReadRange{offset, column_chunk->total_compressed_size()});
+		}
+	}
+	return ranges;
+}
 
-	std::vector<size_t> num_row_groups(files.size());
-	std::thread threads[files.size()];
-	for(int file_index = 0; file_index < files.size(); file_index++) {
+// Reads the footers in parallel, handles with a uri go through the process-wide cache
+std::vector<std::shared_ptr<parquet::FileMetaData>> get_files_metadata(const std::vector<data_handle> & handles) {
+	std::vector<std::shared_ptr<parquet::FileMetaData>> files_metadata(handles.size());
+	std::vector<std::thread> threads(handles.size());
+	for(size_t file_index = 0; file_index < handles.size(); file_index++) {
 		threads[file_index] = std::thread([&, file_index]() {
-			std::unique_ptr<parquet::ParquetFileReader> parquet_reader =
-				parquet::ParquetFileReader::Open(files[file_index]);
-			std::shared_ptr<parquet::FileMetaData> file_metadata = parquet_reader->metadata();
-			const parquet::SchemaDescriptor * schema = file_metadata->schema();
-			num_row_groups[file_index] = file_metadata->num_row_groups();
-			parquet_reader->Close();
+			parquet_file_key key;
+			if(make_parquet_file_key(handles[file_index], key)) {
+				files_metadata[file_index] =
+					parquet_metadata_cache::getInstance().get(key, handles[file_index].fileHandle);
+			} else {
+				std::unique_ptr<parquet::ParquetFileReader> parquet_reader =
+					parquet::ParquetFileReader::Open(handles[file_index].fileHandle);
+				files_metadata[file_index] = parquet_reader->metadata();
+				parquet_reader->Close();
+			}
 		});
 	}
 
-	for(int file_index = 0; file_index < files.size(); file_index++) {
+	for(size_t file_index = 0; file_index < handles.size(); file_index++) {
 		threads[file_index].join();
 	}
+	return files_metadata;
+}
+
+}  // namespace
+
+void parquet_parser::parse(data_handle handle,
+	const std::string & user_readable_file_handle,
+	std::vector<gdf_column_cpp> & columns_out,
+	const Schema & schema,
+	std::vector<size_t> column_indices) {
+	// the cudf reader does one ReadAt per column chunk, on object stores each one would be a request
+	auto coalescing_file = std::dynamic_pointer_cast<CoalescingReadableFile>(handle.fileHandle);
+	parquet_file_key key;
+	if(coalescing_file != nullptr && make_parquet_file_key(handle, key)) {
+		if(column_indices.size() == 0) {
+			column_indices.resize(schema.get_num_columns());
+			std::iota(column_indices.begin(), column_indices.end(), 0);
+		}
+		std::shared_ptr<parquet::FileMetaData> file_metadata =
+			parquet_metadata_cache::getInstance().get(key, coalescing_file);
+		coalescing_file->WillNeed(get_planned_reads(*file_metadata, key.size, schema, column_indices));
+	}
+
+	parse(handle.fileHandle, user_readable_file_handle, columns_out, schema, column_indices);
+}
+
+void parquet_parser::parse_schema(
+	std::vector<std::shared_ptr<arrow::io::RandomAccessFile>> files, ral::io::Schema & schema_out) {
+	parse_schema(to_handles(files), schema_out);
+}
+
+void parquet_parser::parse_schema(std::vector<data_handle> handles, ral::io::Schema & schema_out) {
+	std::vector<std::shared_ptr<parquet::FileMetaData>> files_metadata = get_files_metadata(handles);
+	std::vector<size_t> num_row_groups(files_metadata.size());
+	for(size_t file_index = 0; file_index < files_metadata.size(); file_index++) {
+		num_row_groups[file_index] = files_metadata[file_index]->num_row_groups();
+	}
 
 	cudf::io::parquet::reader_options pq_args;
 	pq_args.strings_to_categorical = false;
-	cudf::io::parquet::reader cudf_parquet_reader(files[0], pq_args);
+	cudf::io::parquet::reader cudf_parquet_reader(handles[0].fileHandle, pq_args);
 	cudf::table table_out = cudf_parquet_reader.read_rows(0, 1);
 
 
@@ -193,30 +275,18 @@ void parquet_parser::parse_schema(
 
 
 bool parquet_parser::get_metadata(std::vector<std::shared_ptr<arrow::io::RandomAccessFile>> files, ral::io::Metadata & metadata){
-	std::vector<size_t> num_row_groups(files.size());
-	std::thread threads[files.size()];
-	std::vector<std::unique_ptr<parquet::ParquetFileReader>> parquet_readers(files.size());
-	for(int file_index = 0; file_index < files.size(); file_index++) {
-		threads[file_index] = std::thread([&, file_index]() {
-		  parquet_readers[file_index] =
-			  parquet::ParquetFileReader::Open(files[file_index]);
-		  std::shared_ptr<parquet::FileMetaData> file_metadata = parquet_readers[file_index]->metadata();
-		  const parquet::SchemaDescriptor * schema = file_metadata->schema();
-		  num_row_groups[file_index] = file_metadata->num_row_groups();
-		});
-	}
-
-	for(int file_index = 0; file_index < files.size(); file_index++) {
-		threads[file_index].join();
-	}
+	return get_metadata(to_handles(files), metadata);
+}
 
-	size_t total_num_row_groups =
-		std::accumulate(num_row_groups.begin(), num_row_groups.end(), size_t(0));
+bool parquet_parser::get_metadata(std::vector<data_handle> handles, ral::io::Metadata & metadata){
+	std::vector<std::shared_ptr<parquet::FileMetaData>> files_metadata = get_files_metadata(handles);
 
-	std::vector<gdf_column_cpp> minmax_metadata_table = get_minmax_metadata(parquet_readers, total_num_row_groups, metadata.offset());
-	for (auto &reader : parquet_readers) {
-		reader->Close();
+	size_t total_num_row_groups = 0;
+	for(auto & file_metadata : files_metadata) {
+		total_num_row_groups += file_metadata->num_row_groups();
 	}
+
+	std::vector<gdf_column_cpp> minmax_metadata_table = get_minmax_metadata(files_metadata, total_num_row_groups, metadata.offset());
 	metadata.metadata_ =  minmax_metadata_table;
 	return true;
 }
@@ -32,6 +32,18 @@ public:
 
 	bool get_metadata(std::vector<std::shared_ptr<arrow::io::RandomAccessFile>> files, ral::io::Metadata & metadata);
 
+	// plans the reads of the column chunks before parsing, when the file can coalesce them
+	void parse(data_handle handle,
+		const std::string & user_readable_file_handle,
+		std::vector<gdf_column_cpp> & columns_out,
+		const Schema & schema,
+		std::vector<size_t> column_indices_requested);
+
+	// read the footers through parquet_metadata_cache
+	void parse_schema(std::vector<data_handle> handles, Schema & schema);
+
+	bool get_metadata(std::vector<data_handle> handles, ral::io::Metadata & metadata);
+
 };
 
 } /* namespace io */
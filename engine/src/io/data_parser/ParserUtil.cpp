@@ -53,7 +53,7 @@ void get_columns_that_were_already_loaded(const std::vector<size_t> & column_ind
 		}
 		if(!already_parsed_before) {
 			if(column_name != columns[newly_parsed_col_idx].name()) {
-				Library::Logging::Logger().logError(ral::utilities::buildLogString(
+				BLAZING_LOG_ERROR(ral::utilities::buildLogString(
 					"", "", "", "ERROR: logic error when trying to use already loaded columns in ParquetParser"));
 			}
 			columns_out.push_back(columns[newly_parsed_col_idx]);
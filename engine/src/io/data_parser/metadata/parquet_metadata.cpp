@@ -255,16 +255,16 @@ void set_gdf_column(gdf_column_cpp &p_column, std::basic_string<char> &vector, u
 }
 
 std::vector<gdf_column_cpp> get_minmax_metadata(
-	std::vector<std::unique_ptr<parquet::ParquetFileReader>> &parquet_readers,
+	const std::vector<std::shared_ptr<parquet::FileMetaData>> &files_metadata,
 	size_t total_num_row_groups, int metadata_offset) {
 
-	if (parquet_readers.size() == 0)
+	if (files_metadata.size() == 0)
 		return {};
 
 	std::vector<std::vector<int64_t>> minmax_metadata_table;
 	std::vector<gdf_column_cpp> minmax_metadata_gdf_table;
 
-	std::shared_ptr<parquet::FileMetaData> file_metadata = parquet_readers[0]->metadata();
+	std::shared_ptr<parquet::FileMetaData> file_metadata = files_metadata[0];
 
 	// initialize minmax_metadata_table
 	// T(min, max), (file_handle, row_group)
@@ -276,8 +276,7 @@ std::vector<gdf_column_cpp> get_minmax_metadata(
 
 	if (num_row_groups > 0) {
 		auto row_group_index = 0;
-		auto groupReader = parquet_readers[0]->RowGroup(row_group_index);
-		auto *rowGroupMetadata = groupReader->metadata();
+		auto rowGroupMetadata = file_metadata->RowGroup(row_group_index);
 		for (int colIndex = 0; colIndex < file_metadata->num_columns(); colIndex++) {
 			const parquet::ColumnDescriptor *column = schema->Column(colIndex);
 			auto columnMetaData = rowGroupMetadata->ColumnChunk(colIndex);
@@ -303,18 +302,17 @@ std::vector<gdf_column_cpp> get_minmax_metadata(
 	}
 
 	size_t file_index = 0;
-	std::vector<std::thread> threads(parquet_readers.size());
+	std::vector<std::thread> threads(files_metadata.size());
 	std::mutex guard;
-	for (size_t file_index = 0; file_index < parquet_readers.size(); file_index++){
-		threads[file_index] = std::thread([&guard, metadata_offset,  &parquet_readers, file_index, &minmax_metadata_table ](){
-		  std::shared_ptr<parquet::FileMetaData> file_metadata = parquet_readers[file_index]->metadata();
+	for (size_t file_index = 0; file_index < files_metadata.size(); file_index++){
+		threads[file_index] = std::thread([&guard, metadata_offset,  &files_metadata, file_index, &minmax_metadata_table ](){
+		  std::shared_ptr<parquet::FileMetaData> file_metadata = files_metadata[file_index];
 
 		  int num_row_groups = file_metadata->num_row_groups();
 		  const parquet::SchemaDescriptor *schema = file_metadata->schema();
 
 		  for (int row_group_index = 0; row_group_index < num_row_groups; row_group_index++) {
-			  auto groupReader = parquet_readers[file_index]->RowGroup(row_group_index);
-			  auto *rowGroupMetadata = groupReader->metadata();
+			  auto rowGroupMetadata = file_metadata->RowGroup(row_group_index);
 			  for (int colIndex = 0; colIndex < file_metadata->num_columns();
 				   colIndex++) {
 				  const parquet::ColumnDescriptor *column = schema->Column(colIndex);
@@ -340,7 +338,7 @@ std::vector<gdf_column_cpp> get_minmax_metadata(
 		});
 	}
 
-	for (size_t file_index = 0; file_index < parquet_readers.size(); file_index++){
+	for (size_t file_index = 0; file_index < files_metadata.size(); file_index++){
 		threads[file_index].join();
 	}
 
@@ -0,0 +1,145 @@
+#include "parquet_metadata_cache.h"
+
+#include <parquet/file_reader.h>
+
+#include <blazingdb/io/Config/BlazingContext.h>
+#include <blazingdb/io/FileSystem/FileSystemManager.h>
+#include <blazingdb/io/Library/Logging/Logger.h>
+#include <blazingdb/io/Util/StringUtil.h>
+
+#include "utilities/QueryTrace.h"
+
+namespace ral {
+namespace io {
+
+std::string parquet_file_key::to_string() const {
+	return StringUtil::makeCacheKey({uri, std::to_string(size), std::to_string(modification_time), etag});
+}
+
+bool make_parquet_file_key(const data_handle & handle, parquet_file_key & key) {
+	if(handle.uri.isEmpty() || !handle.uri.isValid()) {
+		return false;
+	}
+	try {
+		// a cached status could still describe the file before it was rewritten, and so serve its old footer
+		const FileStatus status =
+			BlazingContext::getInstance()->getFileSystemManager()->refreshFileStatus(handle.uri);
+		key.uri = handle.uri.toString(true);
+		key.size = status.getFileSize();
+		key.modification_time = status.getModificationTime();
+		key.etag = status.getETag();
+		return true;
+	} catch(const std::exception & e) {
+		BLAZING_LOG_WARN(
+			"parquet_metadata_cache: could not get the status of " + handle.uri.toString() + ": " + e.what());
+		return false;
+	}
+}
+
+parquet_metadata_cache & parquet_metadata_cache::getInstance() {
+	static parquet_metadata_cache instance;
+	return instance;
+}
+
+parquet_metadata_cache::parquet_metadata_cache(std::size_t capacity_bytes) : capacity_bytes(capacity_bytes) {}
+
+std::shared_ptr<parquet::FileMetaData> parquet_metadata_cache::get(
+	const parquet_file_key & key, std::shared_ptr<arrow::io::RandomAccessFile> file) {
+	std::shared_ptr<parquet::FileMetaData> metadata = this->find(key);
+	if(metadata != nullptr) {
+		return metadata;
+	}
+
+	ral::utilities::trace_span fetch_span("metadata", "fetch parquet footer");
+	std::unique_ptr<parquet::ParquetFileReader> parquet_reader = parquet::ParquetFileReader::Open(file);
+	metadata = parquet_reader->metadata();
+	parquet_reader->Close();
+	fetch_span.set_bytes(metadata->size());
+	fetch_span.end();
+
+	this->put(key, metadata);
+	return metadata;
+}
+
+std::shared_ptr<parquet::FileMetaData> parquet_metadata_cache::find(const parquet_file_key & key) {
+	std::lock_guard<std::mutex> lock(this->mutex);
+	auto it = this->index.find(key.to_string());
+	if(it == this->index.end()) {
+		this->miss_count++;
+		return nullptr;
+	}
+	this->hit_count++;
+	this->entries.splice(this->entries.begin(), this->entries, it->second);
+	return it->second->metadata;
+}
+
+void parquet_metadata_cache::put(const parquet_file_key & key, std::shared_ptr<parquet::FileMetaData> metadata) {
+	const std::size_t bytes = metadata->size();
+	std::string cache_key = key.to_string();
+
+	std::lock_guard<std::mutex> lock(this->mutex);
+	if(bytes > this->capacity_bytes) {
+		return;
+	}
+	auto it = this->index.find(cache_key);
+	if(it != this->index.end()) {
+		this->used_bytes -= it->second->bytes;
+		this->entries.erase(it->second);
+		this->index.erase(it);
+	}
+	this->entries.push_front(entry{cache_key, std::move(metadata), bytes});
+	this->index.emplace(std::move(cache_key), this->entries.begin());
+	this->used_bytes += bytes;
+	this->evict_to_capacity();
+}
+
+void parquet_metadata_cache::evict_to_capacity() {
+	while(this->used_bytes > this->capacity_bytes) {
+		const entry & last = this->entries.back();
+		this->used_bytes -= last.bytes;
+		this->index.erase(last.key);
+		this->entries.pop_back();
+		this->eviction_count++;
+	}
+}
+
+void parquet_metadata_cache::set_capacity(std::size_t capacity_bytes) {
+	std::lock_guard<std::mutex> lock(this->mutex);
+	this->capacity_bytes = capacity_bytes;
+	this->evict_to_capacity();
+}
+
+void parquet_metadata_cache::clear() {
+	std::lock_guard<std::mutex> lock(this->mutex);
+	this->entries.clear();
+	this->index.clear();
+	this->used_bytes = 0;
+}
+
+std::size_t parquet_metadata_cache::hits() const {
+	std::lock_guard<std::mutex> lock(this->mutex);
+	return this->hit_count;
+}
+
+std::size_t parquet_metadata_cache::misses() const {
+	std::lock_guard<std::mutex> lock(this->mutex);
+	return this->miss_count;
+}
+
+std::size_t parquet_metadata_cache::evictions() const {
+	std::lock_guard<std::mutex> lock(this->mutex);
+	return this->eviction_count;
+}
+
+std::size_t parquet_metadata_cache::size_bytes() const {
+	std::lock_guard<std::mutex> lock(this->mutex);
+	return this->used_bytes;
+}
+
+std::size_t parquet_metadata_cache::num_entries() const {
+	std::lock_guard<std::mutex> lock(this->mutex);
+	return this->entries.size();
+}
+
+} /* namespace io */
+} /* namespace ral */
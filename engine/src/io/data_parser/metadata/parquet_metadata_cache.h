@@ -0,0 +1,95 @@
+#ifndef BLAZINGDB_RAL_SRC_IO_DATA_PARSER_METADATA_PARQUET_METADATA_CACHE_H_
+#define BLAZINGDB_RAL_SRC_IO_DATA_PARSER_METADATA_PARQUET_METADATA_CACHE_H_
+
+#include <cstddef>
+#include <list>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <unordered_map>
+
+#include <arrow/io/interfaces.h>
+#include <parquet/metadata.h>
+
+#include "io/data_provider/DataProvider.h"
+
+namespace ral {
+namespace io {
+
+/**
+ * Identifies one version of a file. A rewritten file gets a different key, so its old footer is never served.
+ * modification_time and etag stay empty for the file systems that do not report them.
+ */
+struct parquet_file_key {
+	std::string uri;
+	unsigned long long size = 0;
+	unsigned long long modification_time = 0;
+	std::string etag;
+
+	std::string to_string() const;
+};
+
+/**
+ * Builds the key of a data handle from a fresh file status reported by its file system.
+ * Returns false when the handle has no uri or its status can not be read, those files are not cached.
+ */
+bool make_parquet_file_key(const data_handle & handle, parquet_file_key & key);
+
+/**
+ * Process-wide LRU cache of parquet footers. It is bounded by the serialized size of the footers it holds, so a
+ * query over thousands of files only pays for their footers (one ranged read each on S3) the first time.
+ */
+class parquet_metadata_cache {
+public:
+	static constexpr std::size_t DEFAULT_CAPACITY_BYTES = 256 * 1024 * 1024;
+
+	static parquet_metadata_cache & getInstance();
+
+	explicit parquet_metadata_cache(std::size_t capacity_bytes = DEFAULT_CAPACITY_BYTES);
+
+	/**
+	 * Returns the footer of file, reading it when key is not cached. Concurrent misses on the same key may both
+	 * read the footer, the last one is kept.
+	 */
+	std::shared_ptr<parquet::FileMetaData> get(
+		const parquet_file_key & key, std::shared_ptr<arrow::io::RandomAccessFile> file);
+
+	// Returns nullptr when key is not cached
+	std::shared_ptr<parquet::FileMetaData> find(const parquet_file_key & key);
+
+	void put(const parquet_file_key & key, std::shared_ptr<parquet::FileMetaData> metadata);
+
+	// a capacity of 0 disables the cache
+	void set_capacity(std::size_t capacity_bytes);
+	void clear();
+
+	std::size_t hits() const;
+	std::size_t misses() const;
+	std::size_t evictions() const;
+	std::size_t size_bytes() const;
+	std::size_t num_entries() const;
+
+private:
+	struct entry {
+		std::string key;
+		std::shared_ptr<parquet::FileMetaData> metadata;
+		std::size_t bytes;
+	};
+
+	// must be called with mutex held
+	void evict_to_capacity();
+
+	mutable std::mutex mutex;
+	std::list<entry> entries;  // most recently used first
+	std::unordered_map<std::string, std::list<entry>::iterator> index;
+	std::size_t capacity_bytes;
+	std::size_t used_bytes = 0;
+	std::size_t hit_count = 0;
+	std::size_t miss_count = 0;
+	std::size_t eviction_count = 0;
+};
+
+} /* namespace io */
+} /* namespace ral */
+
+#endif	// BLAZINGDB_RAL_SRC_IO_DATA_PARSER_METADATA_PARQUET_METADATA_CACHE_H_
@@ -11,6 +11,7 @@
 #include "Config/BlazingContext.h"
 #include "ExceptionHandling/BlazingException.h"
 #include "arrow/status.h"
+#include <blazingdb/io/Util/FileUtil.h>
 #include <blazingdb/io/Util/StringUtil.h>
 #include <iostream>
 
@@ -100,6 +101,8 @@ data_handle uri_data_provider::get_next() {
 		FileStatus fileStatus;
 		auto current_uri = this->file_uris[this->current_file];
 		const bool hasWildcard = current_uri.getPath().hasWildcard();
+		std::string parent_path = current_uri.getPath().getParentPath().toString();
+		const bool hasWildcardFolders = FileUtilv2::filePathContainsWildcards(parent_path);
 		Uri target_uri = current_uri;
 
 		try {
@@ -110,7 +113,10 @@ data_handle uri_data_provider::get_next() {
 				target_uri = Uri(current_uri.getScheme(), current_uri.getAuthority(), final_path);
 			}
 
-			if(fs_manager && fs_manager->exists(target_uri)) {
+			if(hasWildcardFolders) {
+				// e.g. /folder0/year=*/month=*/*.parquet, the folders are listed level by level below
+				fileStatus = FileStatus(target_uri, FileType::DIRECTORY, 0);
+			} else if(fs_manager && fs_manager->exists(target_uri)) {
 				fileStatus = BlazingContext::getInstance()->getFileSystemManager()->getFileStatus(target_uri);
 			} else {
 				throw std::runtime_error(
@@ -137,7 +143,9 @@ data_handle uri_data_provider::get_next() {
 		}
 
 		if(fileStatus.isDirectory()) {
-			if(hasWildcard) {
+			if(hasWildcardFolders) {
+				this->directory_uris = FileUtilv2::getFilesWithWildcard(current_uri);
+			} else if(hasWildcard) {
 				const std::string wildcard = current_uri.getPath().getResourceName();
 
 				this->directory_uris =
@@ -196,5 +204,33 @@ data_handle uri_data_provider::get_first() {
 
 std::vector<std::string> uri_data_provider::get_errors() { return this->errors; }
 
+size_t uri_data_provider::get_num_uris() const { return this->file_uris.size(); }
+
+std::shared_ptr<uri_data_provider> uri_data_provider::prune_partitions(
+	const std::function<bool(const data_handle &)> & can_skip) const {
+	if(this->uri_scalars.size() == 0) {
+		return std::make_shared<uri_data_provider>(this->file_uris);
+	}
+
+	std::vector<Uri> uris;
+	std::vector<std::map<std::string, gdf_scalar>> uri_scalars;
+	std::vector<std::map<std::string, std::string>> string_scalars;
+	std::vector<std::map<std::string, bool>> is_column_string;
+	for(size_t file_index = 0; file_index < this->file_uris.size(); file_index++) {
+		data_handle partition;
+		partition.uri = this->file_uris[file_index];
+		partition.column_values = this->uri_scalars[file_index];
+		partition.string_values = this->string_scalars[file_index];
+		partition.is_column_string = this->is_column_string[file_index];
+		if(!can_skip(partition)) {
+			uris.push_back(this->file_uris[file_index]);
+			uri_scalars.push_back(this->uri_scalars[file_index]);
+			string_scalars.push_back(this->string_scalars[file_index]);
+			is_column_string.push_back(this->is_column_string[file_index]);
+		}
+	}
+	return std::make_shared<uri_data_provider>(uris, uri_scalars, string_scalars, is_column_string);
+}
+
 } /* namespace io */
 } /* namespace ral */
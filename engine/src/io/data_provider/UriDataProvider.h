@@ -11,6 +11,7 @@
 #include "DataProvider.h"
 #include <arrow/io/interfaces.h>
 #include <blazingdb/io/FileSystem/Uri.h>
+#include <functional>
 #include <vector>
 
 #include <memory>
@@ -67,6 +68,18 @@ public:
 	 */
 	size_t get_file_index();
 
+	/**
+	 * returns the number of uris, a uri can be a directory or a wildcard with many files
+	 */
+	size_t get_num_uris() const;
+
+	/**
+	 * returns a provider over the uris that can_skip does not skip, it gets a handle per uri holding only the
+	 * partition values of the uri (see uri_scalars), so nothing is listed or opened
+	 */
+	std::shared_ptr<uri_data_provider> prune_partitions(
+		const std::function<bool(const data_handle &)> & can_skip) const;
+
 private:
 	/**
 	 * stores the list of uris that will be used by the provider
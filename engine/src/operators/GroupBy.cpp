@@ -155,7 +155,7 @@ void distributed_groupby_without_aggregations(
 	size_t rowSize = input.get_num_rows_in_table(0);
 
 	std::vector<gdf_column_cpp> selfSamples = ral::distribution::sampling::generateSample(group_columns, 0.1);
-	Library::Logging::Logger().logInfo(
+	BLAZING_LOG_INFO(
 		timer.logDuration(queryContext, "distributed_groupby_without_aggregations part 0 generateSample"));
 	timer.reset();
 
@@ -164,7 +164,7 @@ void distributed_groupby_without_aggregations(
 		[](Context & queryContext, std::vector<gdf_column_cpp> & input, const std::vector<int> & group_column_indices) {
 			static CodeTimer timer2;
 			std::vector<gdf_column_cpp> result = groupby_without_aggregations(input, group_column_indices);
-			Library::Logging::Logger().logInfo(timer.logDuration(
+			BLAZING_LOG_INFO(timer.logDuration(
 				queryContext, "distributed_groupby_without_aggregations part 1 async groupby_without_aggregations"));
 			timer.reset();
 			return result;
@@ -184,7 +184,7 @@ void distributed_groupby_without_aggregations(
 		queryContext.incrementQuerySubstep();
 		ral::distribution::distributePartitionPlan(queryContext, partitionPlan);
 
-		Library::Logging::Logger().logInfo(timer.logDuration(queryContext,
+		BLAZING_LOG_INFO(timer.logDuration(queryContext,
 			"distributed_groupby_without_aggregations part 1 collectSamples generatePartitionPlansGroupBy "
 			"distributePartitionPlan"));
 		timer.reset();
@@ -195,7 +195,7 @@ void distributed_groupby_without_aggregations(
 		queryContext.incrementQuerySubstep();
 		partitionPlan = ral::distribution::getPartitionPlan(queryContext);
 
-		Library::Logging::Logger().logInfo(timer.logDuration(
+		BLAZING_LOG_INFO(timer.logDuration(
 			queryContext, "distributed_groupby_without_aggregations part 1 sendSamplesToMaster getPartitionPlan"));
 		timer.reset();
 	}
@@ -209,7 +209,7 @@ void distributed_groupby_without_aggregations(
 
 	std::vector<ral::distribution::NodeColumns> partitions =
 		ral::distribution::partitionData(queryContext, groupedTable, group_column_indices, partitionPlan, false);
-	Library::Logging::Logger().logInfo(
+	BLAZING_LOG_INFO(
 		timer.logDuration(queryContext, "distributed_groupby_without_aggregations part 2 partitionData"));
 	timer.reset();
 
@@ -223,13 +223,13 @@ void distributed_groupby_without_aggregations(
 	// Could "it" iterator be partitions.end()?
 	partitionsToMerge.push_back(*it);
 
-	Library::Logging::Logger().logInfo(timer.logDuration(
+	BLAZING_LOG_INFO(timer.logDuration(
 		queryContext, "distributed_groupby_without_aggregations part 3 distributePartitions collectPartitions"));
 	timer.reset();
 
 	ral::distribution::groupByWithoutAggregationsMerger(partitionsToMerge, group_column_indices, input);
 
-	Library::Logging::Logger().logInfo(timer.logDuration(
+	BLAZING_LOG_INFO(timer.logDuration(
 		queryContext, "distributed_groupby_without_aggregations part 4 groupByWithoutAggregationsMerger"));
 	timer.reset();
 }
@@ -533,7 +533,7 @@ void distributed_aggregations_with_groupby(Context & queryContext,
 	size_t rowSize = input.get_num_rows_in_table(0);
 
 	std::vector<gdf_column_cpp> selfSamples = ral::distribution::sampling::generateSample(group_columns, 0.1);
-	Library::Logging::Logger().logInfo(
+	BLAZING_LOG_INFO(
 		timer.logDuration(queryContext, "distributed_aggregations_with_groupby part 0 generateSample"));
 	timer.reset();
 
@@ -551,7 +551,7 @@ void distributed_aggregations_with_groupby(Context & queryContext,
 				aggregation_types,
 				aggregation_input_expressions,
 				aggregation_column_assigned_aliases);
-			Library::Logging::Logger().logInfo(
+			BLAZING_LOG_INFO(
 				timer.logDuration(queryContext, "distributed_aggregations_with_groupby async compute_aggregations"));
 			timer.reset();
 			return result;
@@ -574,7 +574,7 @@ void distributed_aggregations_with_groupby(Context & queryContext,
 		queryContext.incrementQuerySubstep();
 		ral::distribution::distributePartitionPlan(queryContext, partitionPlan);
 
-		Library::Logging::Logger().logInfo(timer.logDuration(queryContext,
+		BLAZING_LOG_INFO(timer.logDuration(queryContext,
 			"distributed_aggregations_with_groupby part 1 collectSamples generatePartitionPlansGroupBy "
 			"distributePartitionPlan"));
 		timer.reset();
@@ -584,7 +584,7 @@ void distributed_aggregations_with_groupby(Context & queryContext,
 
 		queryContext.incrementQuerySubstep();
 		partitionPlan = ral::distribution::getPartitionPlan(queryContext);
-		Library::Logging::Logger().logInfo(timer.logDuration(
+		BLAZING_LOG_INFO(timer.logDuration(
 			queryContext, "distributed_aggregations_with_groupby part 1 sendSamplesToMaster getPartitionPlan"));
 		timer.reset();
 	}
@@ -601,7 +601,7 @@ void distributed_aggregations_with_groupby(Context & queryContext,
 
 	std::vector<ral::distribution::NodeColumns> partitions =
 		ral::distribution::partitionData(queryContext, aggregatedTable, groupColumnIndices, partitionPlan, false);
-	Library::Logging::Logger().logInfo(
+	BLAZING_LOG_INFO(
 		timer.logDuration(queryContext, "distributed_aggregations_with_groupby part 2 partitionData"));
 	timer.reset();
 
@@ -615,13 +615,13 @@ void distributed_aggregations_with_groupby(Context & queryContext,
 	// Could "it" iterator be partitions.end()?
 	partitionsToMerge.push_back(*it);
 
-	Library::Logging::Logger().logInfo(timer.logDuration(
+	BLAZING_LOG_INFO(timer.logDuration(
 		queryContext, "distributed_aggregations_with_groupby part 3 distributePartitions collectPartitions"));
 	timer.reset();
 
 	aggregationsMerger(partitionsToMerge, groupColumnIndices, aggregation_types, input);
 
-	Library::Logging::Logger().logInfo(
+	BLAZING_LOG_INFO(
 		timer.logDuration(queryContext, "distributed_aggregations_with_groupby part 4 aggregationsMerger"));
 	timer.reset();
 }
@@ -642,7 +642,7 @@ void distributed_aggregations_without_groupby(Context & queryContext,
 		aggregation_input_expressions,
 		aggregation_column_assigned_aliases);
 
-	Library::Logging::Logger().logInfo(
+	BLAZING_LOG_INFO(
 		timer.logDuration(queryContext, "distributed_aggregations_without_groupby part 1 compute_aggregations"));
 	timer.reset();
 
@@ -655,7 +655,7 @@ void distributed_aggregations_without_groupby(Context & queryContext,
 		std::vector<int> groupColumnIndices(group_column_indices.size());
 		std::iota(groupColumnIndices.begin(), groupColumnIndices.end(), 0);
 		aggregationsMerger(partitionsToMerge, groupColumnIndices, aggregation_types, input);
-		Library::Logging::Logger().logInfo(timer.logDuration(
+		BLAZING_LOG_INFO(timer.logDuration(
 			queryContext, "distributed_aggregations_without_groupby part 2 collectPartitions aggregationsMerger"));
 		timer.reset();
 	} else {
@@ -673,7 +673,7 @@ void distributed_aggregations_without_groupby(Context & queryContext,
 		queryContext.incrementQuerySubstep();
 		ral::distribution::distributePartitions(queryContext, selfPartition);
 
-		Library::Logging::Logger().logInfo(
+		BLAZING_LOG_INFO(
 			timer.logDuration(queryContext, "distributed_aggregations_without_groupby part 2 distributePartitions"));
 		timer.reset();
 	}
@@ -167,13 +167,13 @@ LocalJoinOperator::LocalJoinOperator(Context * context) : JoinOperator(context)
 blazing_frame LocalJoinOperator::operator()(blazing_frame & input, const std::string & query) {
 	// Evaluate join
 	evaluate_join(input, query);
-	Library::Logging::Logger().logInfo(timer_.logDuration(*context_, "LocalJoinOperator part 1 evaluate_join"));
+	BLAZING_LOG_INFO(timer_.logDuration(*context_, "LocalJoinOperator part 1 evaluate_join"));
 	timer_.reset();
 
 	// Materialize columns
 	bool is_inner_join = get_named_expression(query, "joinType") == INNER_JOIN;
 	materialize_column(input, is_inner_join);
-	Library::Logging::Logger().logInfo(timer_.logDuration(*context_, "LocalJoinOperator part 2 materialize_column"));
+	BLAZING_LOG_INFO(timer_.logDuration(*context_, "LocalJoinOperator part 2 materialize_column"));
 	timer_.reset();
 
 	return input;
@@ -190,19 +190,19 @@ blazing_frame DistributedJoinOperator::operator()(blazing_frame & frame, const s
 	} else {
 		frame = process_hash_based_distribution(frame, query);
 	}
-	Library::Logging::Logger().logInfo(
+	BLAZING_LOG_INFO(
 		timer_.logDuration(*context_, "DistributedJoinOperator part 1 process_distribution"));
 	timer_.reset();
 
 	// Evaluate join
 	evaluate_join(frame, query);
-	Library::Logging::Logger().logInfo(timer_.logDuration(*context_, "DistributedJoinOperator part 2 evaluate_join"));
+	BLAZING_LOG_INFO(timer_.logDuration(*context_, "DistributedJoinOperator part 2 evaluate_join"));
 	timer_.reset();
 
 	// Materialize columns
 	bool is_inner_join = get_named_expression(query, "joinType") == INNER_JOIN;
 	materialize_column(frame, is_inner_join);
-	Library::Logging::Logger().logInfo(
+	BLAZING_LOG_INFO(
 		timer_.logDuration(*context_, "DistributedJoinOperator part 3 materialize_column"));
 	timer_.reset();
 
@@ -297,7 +297,7 @@ blazing_frame DistributedJoinOperator::process_distribution(blazing_frame & fram
 		int num_to_collect = 0;
 		std::vector<gdf_column_cpp> data_to_scatter;
 		if(scatter_left) {
-			Library::Logging::Logger().logTrace(
+			BLAZING_LOG_TRACE(
 				ral::utilities::buildLogString(std::to_string(context_->getContextToken()),
 					std::to_string(context_->getQueryStep()),
 					std::to_string(context_->getQuerySubstep()),
@@ -312,7 +312,7 @@ blazing_frame DistributedJoinOperator::process_distribution(blazing_frame & fram
 				}
 			}
 		} else {
-			Library::Logging::Logger().logTrace(
+			BLAZING_LOG_TRACE(
 				ral::utilities::buildLogString(std::to_string(context_->getContextToken()),
 					std::to_string(context_->getQueryStep()),
 					std::to_string(context_->getQuerySubstep()),
@@ -332,7 +332,7 @@ blazing_frame DistributedJoinOperator::process_distribution(blazing_frame & fram
 		std::vector<gdf_column_cpp> cluster_shared_table;
 		if(num_to_collect > 0) {
 			std::vector<NodeColumns> collected_partitions =
-				ral::distribution::collectSomePartitions(*context_, num_to_collect);
+				ral::distribution::collectSomePartitions(*context_, num_to_collect, true);
 			cluster_shared_table = concat_columns(data_to_scatter, collected_partitions);
 		} else {
 			cluster_shared_table = data_to_scatter;
@@ -348,7 +348,7 @@ blazing_frame DistributedJoinOperator::process_distribution(blazing_frame & fram
 		return join_frame;
 
 	} else {
-		Library::Logging::Logger().logTrace(ral::utilities::buildLogString(std::to_string(context_->getContextToken()),
+		BLAZING_LOG_TRACE(ral::utilities::buildLogString(std::to_string(context_->getContextToken()),
 			std::to_string(context_->getQueryStep()),
 			std::to_string(context_->getQuerySubstep()),
 			"join process_distribution hash based distribution"));
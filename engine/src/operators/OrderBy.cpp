@@ -120,7 +120,7 @@ void sort(const Context & queryContext,
 		index_col.get_gdf_column(),
 		&context));
 
-	Library::Logging::Logger().logInfo(timer.logDuration(queryContext, "sort part 1 gdf_order_by"));
+	BLAZING_LOG_INFO(timer.logDuration(queryContext, "sort part 1 gdf_order_by"));
 	timer.reset();
 
 	for(int i = 0; i < sortedTable.size(); i++) {
@@ -129,7 +129,7 @@ void sort(const Context & queryContext,
 		sortedTable[i].update_null_count();
 	}
 
-	Library::Logging::Logger().logInfo(timer.logDuration(queryContext, "sort part 2 materialize_column"));
+	BLAZING_LOG_INFO(timer.logDuration(queryContext, "sort part 2 materialize_column"));
 	timer.reset();
 }
 
@@ -198,7 +198,7 @@ void distributed_sort(Context & queryContext,
 
 	std::vector<gdf_column_cpp> selfSamples = ral::distribution::sampling::generateSample(cols, 0.1);
 
-	Library::Logging::Logger().logInfo(timer.logDuration(queryContext, "distributed_sort part 1 generateSample"));
+	BLAZING_LOG_INFO(timer.logDuration(queryContext, "distributed_sort part 1 generateSample"));
 	timer.reset();
 
 	std::thread sortThread{[](Context & queryContext,
@@ -208,7 +208,7 @@ void distributed_sort(Context & queryContext,
 							   std::vector<gdf_column_cpp> & sortedTable) {
 							   static CodeTimer timer2;
 							   sort(queryContext, input, rawCols, sortOrderTypes, sortedTable);
-							   Library::Logging::Logger().logInfo(
+							   BLAZING_LOG_INFO(
 								   timer2.logDuration(queryContext, "distributed_sort part 2 async sort"));
 							   timer2.reset();
 						   },
@@ -230,7 +230,7 @@ void distributed_sort(Context & queryContext,
 		queryContext.incrementQuerySubstep();
 		ral::distribution::distributePartitionPlan(queryContext, partitionPlan);
 
-		Library::Logging::Logger().logInfo(timer.logDuration(
+		BLAZING_LOG_INFO(timer.logDuration(
 			queryContext, "distributed_sort part 2 collectSamples generatePartitionPlans distributePartitionPlan"));
 	} else {
 		queryContext.incrementQuerySubstep();
@@ -239,7 +239,7 @@ void distributed_sort(Context & queryContext,
 		queryContext.incrementQuerySubstep();
 		partitionPlan = ral::distribution::getPartitionPlan(queryContext);
 
-		Library::Logging::Logger().logInfo(
+		BLAZING_LOG_INFO(
 			timer.logDuration(queryContext, "distributed_sort part 2 sendSamplesToMaster getPartitionPlan"));
 	}
 
@@ -253,14 +253,14 @@ void distributed_sort(Context & queryContext,
 
 	std::vector<ral::distribution::NodeColumns> partitions = ral::distribution::partitionData(
 		queryContext, sortedTable, sortColIndices, partitionPlan, true, sortOrderTypes);
-	Library::Logging::Logger().logInfo(timer.logDuration(queryContext, "distributed_sort part 3 partitionData"));
+	BLAZING_LOG_INFO(timer.logDuration(queryContext, "distributed_sort part 3 partitionData"));
 	timer.reset();
 
 	queryContext.incrementQuerySubstep();
 	ral::distribution::distributePartitions(queryContext, partitions);
 	std::vector<ral::distribution::NodeColumns> partitionsToMerge = ral::distribution::collectPartitions(queryContext);
 
-	Library::Logging::Logger().logInfo(
+	BLAZING_LOG_INFO(
 		timer.logDuration(queryContext, "distributed_sort part 4 distributePartitions collectPartitions"));
 	timer.reset();
 
@@ -271,7 +271,7 @@ void distributed_sort(Context & queryContext,
 	partitionsToMerge.push_back(*it);
 
 	ral::distribution::sortedMerger(partitionsToMerge, sortOrderTypes, sortColIndices, input);
-	Library::Logging::Logger().logInfo(timer.logDuration(queryContext, "distributed_sort part 5 sortedMerger"));
+	BLAZING_LOG_INFO(timer.logDuration(queryContext, "distributed_sort part 5 sortedMerger"));
 	timer.reset();
 }
 
@@ -0,0 +1,355 @@
+#include "partition_pruning.hpp"
+#include "parser/expression_utils.hpp"
+#include "utils.hpp"
+#include <algorithm>
+#include <blazingdb/io/Util/StringUtil.h>
+#include <cerrno>
+#include <cmath>
+#include <cstdlib>
+
+namespace ral {
+namespace skip_data {
+
+namespace {
+
+enum class value_type { UNKNOWN, BOOL, NUMBER, STRING };
+
+// integers are kept exact, a double does not hold every int64 (e.g. the
+// nanosecond timestamps past 2^53), it is used only when a float is involved
+struct value {
+  value_type type = value_type::UNKNOWN;
+  bool boolean = false;
+  bool is_integer = false;
+  int64_t integer = 0;
+  double number = 0;
+  std::string string;
+};
+
+value make_bool(bool boolean) {
+  value result;
+  result.type = value_type::BOOL;
+  result.boolean = boolean;
+  return result;
+}
+
+value make_number(double number) {
+  value result;
+  result.type = value_type::NUMBER;
+  result.number = number;
+  return result;
+}
+
+value make_integer(int64_t integer) {
+  value result;
+  result.type = value_type::NUMBER;
+  result.is_integer = true;
+  result.integer = integer;
+  result.number = static_cast<double>(integer);
+  return result;
+}
+
+// the digits of the mantissa of a number literal, without the leading and
+// trailing zeros
+size_t count_significant_digits(const std::string &token) {
+  std::string digits;
+  for (char c : token.substr(0, token.find_first_of("eE"))) {
+    if (c >= '0' && c <= '9') {
+      digits += c;
+    }
+  }
+  size_t first = digits.find_first_not_of('0');
+  return first == std::string::npos ? 0 : digits.find_last_not_of('0') - first + 1;
+}
+
+// unknown when the literal is out of the range of an int64, or is a float a
+// double may not hold closely enough to be compared with an integer: one with
+// more than 15 significant digits or past 2^53
+value make_number_literal(const std::string &token) {
+  errno = 0;
+  char *end = nullptr;
+  if (token.find_first_of(".eE") == std::string::npos) {
+    long long integer = std::strtoll(token.c_str(), &end, 10);
+    return errno == ERANGE || *end != '\0' ? value() : make_integer(integer);
+  }
+  double number = std::strtod(token.c_str(), &end);
+  if (errno == ERANGE || *end != '\0' || count_significant_digits(token) > 15 ||
+      std::fabs(number) >= 9007199254740992.0) {
+    return value();
+  }
+  return make_number(number);
+}
+
+// the number as a double, false when it is an integer a double can't hold
+bool to_double(const value &operand, double &number) {
+  if (!operand.is_integer) {
+    number = operand.number;
+    return true;
+  }
+  number = static_cast<double>(operand.integer);
+  // 2^63 is out of the range of an int64
+  return number >= -9223372036854775808.0 && number < 9223372036854775808.0 &&
+         static_cast<int64_t>(number) == operand.integer;
+}
+
+value make_string(const std::string &string) {
+  value result;
+  result.type = value_type::STRING;
+  result.string = string;
+  return result;
+}
+
+// dates and timestamps are left unknown, they are not compared here
+value scalar_value(const gdf_scalar &scalar) {
+  if (!scalar.is_valid) {
+    return value();
+  }
+  switch (scalar.dtype) {
+  case GDF_BOOL8:
+    return make_bool(scalar.data.si08 != 0);
+  case GDF_INT8:
+    return make_integer(scalar.data.si08);
+  case GDF_INT16:
+    return make_integer(scalar.data.si16);
+  case GDF_INT32:
+    return make_integer(scalar.data.si32);
+  case GDF_INT64:
+    return make_integer(scalar.data.si64);
+  case GDF_FLOAT32:
+    return make_number(scalar.data.fp32);
+  case GDF_FLOAT64:
+    return make_number(scalar.data.fp64);
+  default:
+    return value();
+  }
+}
+
+// 'it''s' => it's
+std::string unquote(const std::string &token) {
+  std::string result = token.substr(1, token.size() - 2);
+  StringUtil::findAndReplaceAll(result, "''", "'");
+  return result;
+}
+
+bool is_zero(const value &operand) {
+  return operand.is_integer ? operand.integer == 0 : operand.number == 0;
+}
+
+bool is_true(const value &operand) {
+  return (operand.type == value_type::BOOL && operand.boolean) ||
+         (operand.type == value_type::NUMBER && !is_zero(operand));
+}
+
+bool is_false(const value &operand) {
+  return (operand.type == value_type::BOOL && !operand.boolean) ||
+         (operand.type == value_type::NUMBER && is_zero(operand));
+}
+
+// an int64 against a double without converting the int64, that may not fit
+int compare_exactly(int64_t integer, double number, bool &comparable) {
+  if (std::isnan(number)) {
+    comparable = false;
+    return 0;
+  }
+  if (number >= 9223372036854775808.0) {
+    return -1;
+  }
+  if (number < -9223372036854775808.0) {
+    return 1;
+  }
+  const double whole = std::trunc(number);
+  const int64_t truncated = static_cast<int64_t>(whole);
+  if (integer != truncated) {
+    return (integer > truncated) - (integer < truncated);
+  }
+  return (0 > number - whole) - (0 < number - whole);
+}
+
+// -1, 0 or 1, sets comparable to false when the operands can't be compared
+int compare(const value &left, const value &right, bool &comparable) {
+  comparable = left.type == right.type && left.type != value_type::UNKNOWN;
+  if (!comparable) {
+    return 0;
+  }
+  if (left.type == value_type::STRING) {
+    int result = left.string.compare(right.string);
+    return (result > 0) - (result < 0);
+  }
+  if (left.type == value_type::BOOL) {
+    return (left.boolean > right.boolean) - (left.boolean < right.boolean);
+  }
+  if (left.is_integer && right.is_integer) {
+    return (left.integer > right.integer) - (left.integer < right.integer);
+  }
+  if (left.is_integer || right.is_integer) {
+    return left.is_integer ? compare_exactly(left.integer, right.number, comparable)
+                           : -compare_exactly(right.integer, left.number, comparable);
+  }
+  return (left.number > right.number) - (left.number < right.number);
+}
+
+// +, - or * of two numbers, unknown when an integer overflows or can't be mixed
+// with a float exactly
+value arithmetic(const std::string &op, const value &left, const value &right) {
+  if (left.is_integer && right.is_integer) {
+    int64_t result;
+    bool overflow = op == "+"   ? __builtin_add_overflow(left.integer, right.integer, &result)
+                    : op == "-" ? __builtin_sub_overflow(left.integer, right.integer, &result)
+                                : __builtin_mul_overflow(left.integer, right.integer, &result);
+    return overflow ? value() : make_integer(result);
+  }
+  double left_number, right_number;
+  if (!to_double(left, left_number) || !to_double(right, right_number)) {
+    return value();
+  }
+  if (op == "+") return make_number(left_number + right_number);
+  if (op == "-") return make_number(left_number - right_number);
+  return make_number(left_number * right_number);
+}
+
+} // namespace
+
+struct partition_filter::node {
+  std::string token;
+  std::vector<std::shared_ptr<node>> operands;
+  int column_index = -1;
+  value literal;
+};
+
+namespace {
+
+using node_ptr = std::shared_ptr<partition_filter::node>;
+
+// parses the prefix expression starting at tokens[index], null when it uses
+// something whose number of operands is not known
+node_ptr parse(const std::vector<std::string> &tokens, size_t &index) {
+  if (index >= tokens.size()) {
+    return nullptr;
+  }
+  auto current = std::make_shared<partition_filter::node>();
+  current->token = tokens[index++];
+  const std::string &token = current->token;
+
+  size_t num_operands = 0;
+  if (is_var_column(token)) {
+    current->column_index = get_id(token);
+    if (current->column_index < 0) {
+      return nullptr;
+    }
+  } else if (is_literal(token)) {
+    if (is_bool(token)) {
+      current->literal = make_bool(token == "true");
+    } else if (is_number(token)) {
+      current->literal = make_number_literal(token);
+    } else if (is_string(token)) {
+      current->literal = make_string(unquote(token));
+    }
+    // null, dates and timestamps stay unknown
+  } else if (is_binary_operator_token(token)) {
+    num_operands = 2;
+  } else if (is_unary_operator_token(token)) {
+    num_operands = 1;
+  } else {
+    return nullptr;
+  }
+
+  for (size_t i = 0; i < num_operands; i++) {
+    node_ptr operand = parse(tokens, index);
+    if (operand == nullptr) {
+      return nullptr;
+    }
+    current->operands.push_back(operand);
+  }
+  return current;
+}
+
+value evaluate(const partition_filter::node &current,
+               const std::vector<std::string> &column_names,
+               const ral::io::data_handle &partition) {
+  if (current.column_index >= 0) {
+    if (static_cast<size_t>(current.column_index) >= column_names.size()) {
+      return value();
+    }
+    const std::string &name = column_names[current.column_index];
+    auto string_flag = partition.is_column_string.find(name);
+    if (string_flag != partition.is_column_string.end() && string_flag->second) {
+      auto string_value = partition.string_values.find(name);
+      return string_value != partition.string_values.end() ? make_string(string_value->second) : value();
+    }
+    auto column_value = partition.column_values.find(name);
+    // a column read from the file
+    return column_value != partition.column_values.end() ? scalar_value(column_value->second) : value();
+  }
+  if (current.operands.empty()) {
+    return current.literal;
+  }
+
+  const std::string &op = current.token;
+  const value left = evaluate(*current.operands[0], column_names, partition);
+  if (current.operands.size() == 1) {
+    if (op == "NOT") {
+      return is_true(left) ? make_bool(false) : is_false(left) ? make_bool(true) : value();
+    }
+    return value();
+  }
+  const value right = evaluate(*current.operands[1], column_names, partition);
+
+  if (op == "AND") {
+    if (is_false(left) || is_false(right)) {
+      return make_bool(false);
+    }
+    return is_true(left) && is_true(right) ? make_bool(true) : value();
+  }
+  if (op == "OR") {
+    if (is_true(left) || is_true(right)) {
+      return make_bool(true);
+    }
+    return is_false(left) && is_false(right) ? make_bool(false) : value();
+  }
+
+  bool comparable = false;
+  if (op == "=" || op == "<>" || op == "<" || op == "<=" || op == ">" || op == ">=") {
+    int result = compare(left, right, comparable);
+    if (!comparable) {
+      return value();
+    }
+    if (op == "=") return make_bool(result == 0);
+    if (op == "<>") return make_bool(result != 0);
+    if (op == "<") return make_bool(result < 0);
+    if (op == "<=") return make_bool(result <= 0);
+    if (op == ">") return make_bool(result > 0);
+    return make_bool(result >= 0);
+  }
+
+  if (left.type == value_type::NUMBER && right.type == value_type::NUMBER &&
+      (op == "+" || op == "-" || op == "*")) {
+    return arithmetic(op, left, right);
+  }
+  return value();
+}
+
+} // namespace
+
+partition_filter::partition_filter(const std::string &filter_expression,
+                                   const std::vector<std::string> &column_names)
+    : column_names(column_names) {
+  std::vector<std::string> tokens = StringUtil::splitNotInQuotes(filter_expression, " ");
+  tokens.erase(std::remove(tokens.begin(), tokens.end(), ""), tokens.end());
+
+  size_t index = 0;
+  this->root = parse(tokens, index);
+  if (index != tokens.size()) {
+    this->root = nullptr;
+  }
+}
+
+bool partition_filter::is_valid() const { return this->root != nullptr; }
+
+bool partition_filter::can_skip(const ral::io::data_handle &partition) const {
+  if (this->root == nullptr) {
+    return false;
+  }
+  return is_false(evaluate(*this->root, this->column_names, partition));
+}
+
+} // namespace skip_data
+} // namespace ral
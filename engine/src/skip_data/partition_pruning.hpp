@@ -0,0 +1,43 @@
+#pragma once
+
+#include "io/data_provider/DataProvider.h"
+#include <memory>
+#include <string>
+#include <vector>
+
+namespace ral {
+namespace skip_data {
+
+/**
+ * The filter of a BindableTableScan evaluated on the host against the hive
+ * partition values of a file (the columns that are not in the file, see
+ * data_handle::column_values and data_handle::string_values), so whole
+ * partitions are dropped before any of their files is opened.
+ *
+ * The columns read from the files are unknown here, so the filter is evaluated
+ * with three valued logic: a partition is skipped only when the filter is false
+ * whatever those columns hold, e.g. "AND = $3 2019 > $0 5" skips the partitions
+ * whose $3 is not 2019. Operators not supported here evaluate to unknown.
+ */
+class partition_filter {
+public:
+  // filter_expression is a cleaned filter in prefix order (see
+  // clean_calcite_expression), the $n refer to column_names
+  partition_filter(const std::string &filter_expression,
+                   const std::vector<std::string> &column_names);
+
+  // whether the filter could be parsed, otherwise nothing is skipped
+  bool is_valid() const;
+
+  // whether no row of the partition can pass the filter
+  bool can_skip(const ral::io::data_handle &partition) const;
+
+  struct node;
+
+private:
+  std::shared_ptr<node> root;
+  std::vector<std::string> column_names;
+};
+
+} // namespace skip_data
+} // namespace ral
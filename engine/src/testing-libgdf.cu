@@ -575,7 +575,7 @@ static result_pair executeFileSystemPlanService (uint64_t accessToken, Buffer&&
     uint32_t ctxToken = static_cast<uint32_t>(rawCommContext.token);
     Context queryContext{ctxToken, contextNodes, contextNodes[rawCommContext.masterIndex], ""};
     Library::Logging::ServiceLogging::getInstance().setNodeIdentifier(queryContext.getNodeIndex(ral::communication::CommunicationData::getInstance().getSelfNode())); // TODO we only need to do this once. Lets change this once we ral synching system
-    Library::Logging::Logger().logInfo(timer.logDuration(queryContext, "\"Query Start\n" + requestPayload.statement() + "\""));
+    BLAZING_LOG_INFO(timer.logDuration(queryContext, "\"Query Start\n" + requestPayload.statement() + "\""));
     
     ral::communication::network::Server::getInstance().registerContext(ctxToken);
     resultToken = requestPayload.resultToken();
@@ -28,7 +28,7 @@ std::vector<gdf_column_cpp> concatTables(const std::vector<std::vector<gdf_colum
 				columnsToConcatArray.resize(num_columns);
 			} else {
 				if(table.size() != num_columns) {
-					Library::Logging::Logger().logError(
+					BLAZING_LOG_ERROR(
 						buildLogString("", "", "", "ERROR: tables being concatenated are not the same size"));
 				}
 				assert(table.size() == num_columns);
@@ -126,7 +126,7 @@ std::vector<gdf_column_cpp> normalizeColumnTypes(std::vector<gdf_column_cpp> col
 			if(columns[j].dtype() == common_type && columns[j].dtype_info().time_unit == common_info.time_unit) {
 				columns_out[j] = columns[j];
 			} else {
-				Library::Logging::Logger().logWarn(buildLogString("",
+				BLAZING_LOG_WARN(buildLogString("",
 					"",
 					"",
 					"WARNING: normalizeColumnTypes casting " + std::to_string(columns[j].get_gdf_column()->dtype) +
@@ -140,7 +140,7 @@ std::vector<gdf_column_cpp> normalizeColumnTypes(std::vector<gdf_column_cpp> col
 		} else if(columns[j].dtype() == common_type) {
 			columns_out[j] = columns[j];
 		} else {
-			Library::Logging::Logger().logWarn(buildLogString("",
+			BLAZING_LOG_WARN(buildLogString("",
 				"",
 				"",
 				"WARNING: normalizeColumnTypes casting " + std::to_string(columns[j].get_gdf_column()->dtype) + " to " +
@@ -155,5 +155,13 @@ std::vector<gdf_column_cpp> normalizeColumnTypes(std::vector<gdf_column_cpp> col
 	return columns_out;
 }
 
+std::size_t getTableSizeInBytes(const std::vector<gdf_column_cpp> & table) {
+	std::size_t bytes = 0;
+	for(const gdf_column_cpp & column : table) {
+		bytes += ral::traits::get_data_size_in_bytes(column);
+	}
+	return bytes;
+}
+
 }  // namespace utilities
 }  // namespace ral
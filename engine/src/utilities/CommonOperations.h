@@ -12,6 +12,9 @@ namespace utilities {
 std::vector<gdf_column_cpp> concatTables(const std::vector<std::vector<gdf_column_cpp>> & tables);
 std::vector<gdf_column_cpp> normalizeColumnTypes(std::vector<gdf_column_cpp> columns);
 
+// bytes of device memory the data of the columns take, without their valid masks
+std::size_t getTableSizeInBytes(const std::vector<gdf_column_cpp> & table);
+
 
 }  // namespace utilities
 }  // namespace ral
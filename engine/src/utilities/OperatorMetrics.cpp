@@ -0,0 +1,21 @@
+#include "utilities/OperatorMetrics.h"
+
+#include <blazingdb/io/Library/Metrics/MetricsRegistry.h>
+
+namespace ral {
+namespace utilities {
+
+void record_operator_rows(const std::string & operator_name, int64_t rows_in, int64_t rows_out) {
+	// once per operator of a query, the registry lookup is negligible next to the operator
+	auto & registry = Library::Metrics::MetricsRegistry::getInstance();
+	const Library::Metrics::Labels labels = {{"operator", operator_name}};
+	Library::Metrics::Counter & rows_in_counter =
+		registry.counter("blazing_operator_rows_in_total", "Rows taken by the query operators", labels);
+	Library::Metrics::Counter & rows_out_counter =
+		registry.counter("blazing_operator_rows_out_total", "Rows produced by the query operators", labels);
+	rows_in_counter.increment(rows_in > 0 ? rows_in : 0);
+	rows_out_counter.increment(rows_out > 0 ? rows_out : 0);
+}
+
+}  // namespace utilities
+}  // namespace ral
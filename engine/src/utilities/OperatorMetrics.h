@@ -0,0 +1,19 @@
+#ifndef BLAZINGDB_RAL_UTILITIES_OPERATORMETRICS_H
+#define BLAZINGDB_RAL_UTILITIES_OPERATORMETRICS_H
+
+#include <cstdint>
+#include <string>
+
+namespace ral {
+namespace utilities {
+
+/**
+ * Adds the rows an operator of a query took and produced to the process counters blazing_operator_rows_in_total and
+ * blazing_operator_rows_out_total, labeled with the operator (scan, filter, join...). A scan has no rows in.
+ */
+void record_operator_rows(const std::string & operator_name, int64_t rows_in, int64_t rows_out);
+
+}  // namespace utilities
+}  // namespace ral
+
+#endif  // BLAZINGDB_RAL_UTILITIES_OPERATORMETRICS_H
@@ -0,0 +1,242 @@
+#include "utilities/QueryTrace.h"
+
+#include <cstdio>
+#include <fstream>
+#include <sstream>
+#include <sys/syscall.h>
+#include <unistd.h>
+
+namespace ral {
+namespace utilities {
+
+namespace {
+
+// the innermost span open on this thread
+thread_local trace_span * current_span = nullptr;
+
+long get_thread_id() { return static_cast<long>(syscall(SYS_gettid)); }
+
+void append_json_string(std::ostringstream & out, const std::string & value) {
+	out << '"';
+	for(char c : value) {
+		switch(c) {
+		case '"': out << "\\\""; break;
+		case '\\': out << "\\\\"; break;
+		case '\n': out << "\\n"; break;
+		case '\r': out << "\\r"; break;
+		case '\t': out << "\\t"; break;
+		default:
+			if(static_cast<unsigned char>(c) < 0x20) {
+				char escaped[8];
+				std::snprintf(escaped, sizeof(escaped), "\\u%04x", c);
+				out << escaped;
+			} else {
+				out << c;
+			}
+		}
+	}
+	out << '"';
+}
+
+}  // namespace
+
+query_trace_recorder & query_trace_recorder::getInstance() {
+	static query_trace_recorder recorder;
+	return recorder;
+}
+
+query_trace_recorder::query_trace_recorder() : enabled(false), num_profiled_queries(0) {}
+
+void query_trace_recorder::set_output_directory(const std::string & directory) {
+	std::lock_guard<std::mutex> lock(this->mutex);
+	this->directory = directory;
+	this->enabled = !directory.empty();
+	if(!this->enabled) {
+		for(auto it = this->events.begin(); it != this->events.end();) {
+			it = this->profiled_queries.count(it->first) > 0 ? std::next(it) : this->events.erase(it);
+		}
+	}
+}
+
+void query_trace_recorder::profile_query(uint32_t context_token) {
+	std::lock_guard<std::mutex> lock(this->mutex);
+	if(this->profiled_queries.insert(context_token).second) {
+		this->num_profiled_queries++;
+	}
+}
+
+bool query_trace_recorder::is_recording(uint32_t context_token) const {
+	if(is_enabled()) {
+		return true;
+	}
+	if(this->num_profiled_queries.load(std::memory_order_relaxed) == 0) {
+		return false;
+	}
+	std::lock_guard<std::mutex> lock(this->mutex);
+	return this->profiled_queries.count(context_token) > 0;
+}
+
+void query_trace_recorder::record(uint32_t context_token, trace_event && event) {
+	std::lock_guard<std::mutex> lock(this->mutex);
+	if(this->enabled || this->profiled_queries.count(context_token) > 0) {
+		this->events[context_token].push_back(std::move(event));
+	}
+}
+
+std::vector<trace_event> query_trace_recorder::get_events(uint32_t context_token) const {
+	std::lock_guard<std::mutex> lock(this->mutex);
+	auto it = this->events.find(context_token);
+	return it == this->events.end() ? std::vector<trace_event>() : it->second;
+}
+
+std::vector<trace_event> query_trace_recorder::take_events(uint32_t context_token) {
+	std::lock_guard<std::mutex> lock(this->mutex);
+	if(this->profiled_queries.erase(context_token) > 0) {
+		this->num_profiled_queries--;
+	}
+	std::vector<trace_event> query_events;
+	auto it = this->events.find(context_token);
+	if(it != this->events.end()) {
+		query_events = std::move(it->second);
+		this->events.erase(it);
+	}
+	return query_events;
+}
+
+std::string query_trace_recorder::to_json(uint32_t context_token, int node_index) const {
+	std::vector<trace_event> query_events = get_events(context_token);
+
+	std::ostringstream out;
+	out << "{\"traceEvents\":[\n";
+	out << "{\"name\":\"process_name\",\"ph\":\"M\",\"pid\":" << node_index << ",\"args\":{\"name\":\"node "
+		<< node_index << "\"}}";
+	for(const trace_event & event : query_events) {
+		out << ",\n{\"name\":";
+		append_json_string(out, event.name);
+		out << ",\"cat\":";
+		append_json_string(out, event.category);
+		out << ",\"ph\":\"X\",\"ts\":" << event.start_us << ",\"dur\":" << event.duration_us
+			<< ",\"pid\":" << node_index << ",\"tid\":" << event.thread_id << ",\"args\":{\"query_step\":"
+			<< event.query_step << ",\"query_substep\":" << event.query_substep;
+		if(event.rows_in >= 0) {
+			out << ",\"rows_in\":" << event.rows_in;
+		}
+		if(event.rows >= 0) {
+			out << ",\"rows\":" << event.rows;
+		}
+		if(event.bytes >= 0) {
+			out << ",\"bytes\":" << event.bytes;
+		}
+		for(const auto & arg : event.args) {
+			out << ',';
+			append_json_string(out, arg.first);
+			out << ':';
+			append_json_string(out, arg.second);
+		}
+		out << "}}";
+	}
+	out << "\n],\"displayTimeUnit\":\"ms\",\"otherData\":{\"context_token\":" << context_token
+		<< ",\"node_index\":" << node_index << "}}\n";
+	return out.str();
+}
+
+std::string query_trace_recorder::write(uint32_t context_token, int node_index) {
+	std::string path;
+	{
+		std::lock_guard<std::mutex> lock(this->mutex);
+		if(!this->enabled) {
+			return "";
+		}
+		path = this->directory + "/query_" + std::to_string(context_token) + "_node_" + std::to_string(node_index) +
+			   ".json";
+	}
+
+	std::string json = to_json(context_token, node_index);
+	bool profiled;
+	{
+		std::lock_guard<std::mutex> lock(this->mutex);
+		profiled = this->profiled_queries.count(context_token) > 0;
+	}
+	if(!profiled) {
+		discard(context_token);
+	}
+
+	std::ofstream file(path, std::ios::out | std::ios::trunc);
+	file << json;
+	file.close();
+	return file ? path : "";
+}
+
+void query_trace_recorder::discard(uint32_t context_token) {
+	std::lock_guard<std::mutex> lock(this->mutex);
+	this->events.erase(context_token);
+}
+
+trace_span::trace_span(const Context & context, const char * category, std::string name)
+	: active(false), context_token(0), parent(nullptr) {
+	if(query_trace_recorder::getInstance().is_recording(context.getContextToken())) {
+		event.category = category;
+		event.name = std::move(name);
+		begin(context.getContextToken(), context.getQueryStep(), context.getQuerySubstep());
+	}
+}
+
+trace_span::trace_span(uint32_t context_token,
+	uint32_t query_step,
+	uint32_t query_substep,
+	const char * category,
+	std::string name)
+	: active(false), context_token(0), parent(nullptr) {
+	if(query_trace_recorder::getInstance().is_recording(context_token)) {
+		event.category = category;
+		event.name = std::move(name);
+		begin(context_token, query_step, query_substep);
+	}
+}
+
+trace_span::trace_span(const char * category, std::string name) : active(false), context_token(0), parent(nullptr) {
+	// the parent is open only when its query is recorded
+	if(current_span != nullptr) {
+		event.category = category;
+		event.name = std::move(name);
+		begin(current_span->context_token, current_span->event.query_step, current_span->event.query_substep);
+	}
+}
+
+trace_span::~trace_span() { end(); }
+
+void trace_span::begin(uint32_t context_token, uint32_t query_step, uint32_t query_substep) {
+	this->context_token = context_token;
+	event.query_step = query_step;
+	event.query_substep = query_substep;
+	event.thread_id = get_thread_id();
+	event.start_us = std::chrono::duration_cast<std::chrono::microseconds>(
+		std::chrono::system_clock::now().time_since_epoch())
+						 .count();
+	start = std::chrono::steady_clock::now();
+	parent = current_span;
+	current_span = this;
+	active = true;
+}
+
+void trace_span::set_arg(const std::string & key, const std::string & value) {
+	if(active) {
+		event.args.emplace_back(key, value);
+	}
+}
+
+void trace_span::end() {
+	if(!active) {
+		return;
+	}
+	active = false;
+	if(current_span == this) {
+		current_span = parent;
+	}
+	event.duration_us =
+		std::chrono::duration_cast<std::chrono::microseconds>(std::chrono::steady_clock::now() - start).count();
+	query_trace_recorder::getInstance().record(context_token, std::move(event));
+}
+
+}  // namespace utilities
+}  // namespace ral
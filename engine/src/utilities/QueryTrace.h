@@ -0,0 +1,138 @@
+#ifndef BLAZINGDB_RAL_UTILITIES_QUERYTRACE_H
+#define BLAZINGDB_RAL_UTILITIES_QUERYTRACE_H
+
+#include <atomic>
+#include <blazingdb/manager/Context.h>
+#include <chrono>
+#include <cstdint>
+#include <map>
+#include <mutex>
+#include <set>
+#include <string>
+#include <utility>
+#include <vector>
+
+namespace ral {
+namespace utilities {
+
+using Context = blazingdb::manager::Context;
+
+/**
+ * A finished span of a query. Its start is in microseconds since the epoch, so the traces of all the nodes share a
+ * timeline (up to the skew of their clocks, see scripts/merge_traces.py).
+ */
+struct trace_event {
+	std::string name;
+	const char * category = "";
+	uint32_t query_step = 0;
+	uint32_t query_substep = 0;
+	long thread_id = 0;
+	int64_t start_us = 0;
+	int64_t duration_us = 0;
+	int64_t rows_in = -1;  // -1 when not known
+	int64_t rows = -1;
+	int64_t bytes = -1;
+	std::vector<std::pair<std::string, std::string>> args;
+};
+
+/**
+ * Keeps the spans of the running queries by context token and writes each query as a Chrome trace JSON file, that
+ * chrome://tracing and Perfetto open. Nothing is kept until an output directory is set (BLAZING_TRACE_DIR), except
+ * for the queries profiled one by one (EXPLAIN ANALYZE), whose spans are kept until take_events.
+ */
+class query_trace_recorder {
+public:
+	static query_trace_recorder & getInstance();
+
+	query_trace_recorder();
+
+	// an empty directory disables the tracing
+	void set_output_directory(const std::string & directory);
+
+	bool is_enabled() const { return enabled.load(std::memory_order_relaxed); }
+
+	// keeps the spans of the query from now on, even when the tracing is disabled
+	void profile_query(uint32_t context_token);
+
+	// whether the spans of the query are kept
+	bool is_recording(uint32_t context_token) const;
+
+	void record(uint32_t context_token, trace_event && event);
+
+	std::vector<trace_event> get_events(uint32_t context_token) const;
+
+	// the spans of the query, forgetting them and whether it was profiled
+	std::vector<trace_event> take_events(uint32_t context_token);
+
+	// the spans of the query as a Chrome trace, node_index is its pid
+	std::string to_json(uint32_t context_token, int node_index) const;
+
+	/**
+	 * Writes <directory>/query_<context_token>_node_<node_index>.json and forgets the spans of the query, unless it is
+	 * profiled. Returns the path written, empty when the tracing is disabled or the file can not be written.
+	 */
+	std::string write(uint32_t context_token, int node_index);
+
+	void discard(uint32_t context_token);
+
+private:
+	std::atomic<bool> enabled;
+	std::atomic<size_t> num_profiled_queries;  // spares the lock to the spans of the queries not profiled
+	mutable std::mutex mutex;
+	std::string directory;
+	std::set<uint32_t> profiled_queries;
+	std::map<uint32_t, std::vector<trace_event>> events;
+};
+
+/**
+ * Times a span of a query from its construction until end() or its destruction, e.g.
+ *   trace_span span(context, "operator", "process_join");
+ *   ...
+ *   span.set_rows(result_frame.get_num_rows_in_table(0));
+ * Spans nest by time on each thread. The constructor without a context makes a child of the innermost span open on
+ * the calling thread, and does nothing when there is none. All of it does nothing when the query is not recorded.
+ */
+class trace_span {
+public:
+	trace_span(const Context & context, const char * category, std::string name);
+
+	trace_span(uint32_t context_token,
+		uint32_t query_step,
+		uint32_t query_substep,
+		const char * category,
+		std::string name);
+
+	trace_span(const char * category, std::string name);
+
+	~trace_span();
+
+	trace_span(const trace_span &) = delete;
+
+	trace_span & operator=(const trace_span &) = delete;
+
+	bool is_active() const { return active; }
+
+	void set_rows_in(int64_t rows_in) { event.rows_in = rows_in; }
+
+	void set_rows(int64_t rows) { event.rows = rows; }
+
+	void set_bytes(int64_t bytes) { event.bytes = bytes; }
+
+	void set_arg(const std::string & key, const std::string & value);
+
+	void end();
+
+private:
+	void begin(uint32_t context_token, uint32_t query_step, uint32_t query_substep);
+
+	bool active;
+	uint32_t context_token;
+	trace_event event;
+	std::chrono::steady_clock::time_point start;
+	trace_span * parent;
+};
+
+}  // namespace utilities
+}  // namespace ral
+
+#endif  // BLAZINGDB_RAL_UTILITIES_QUERYTRACE_H
@@ -0,0 +1,112 @@
+#include <gtest/gtest.h>
+
+#include <cstdio>
+#include <memory>
+#include <string>
+
+#include "io/data_parser/metadata/parquet_metadata_cache.h"
+
+#include <arrow/io/file.h>
+
+#include <parquet/api/reader.h>
+#include <parquet/api/writer.h>
+
+using ral::io::parquet_file_key;
+using ral::io::parquet_metadata_cache;
+
+struct ParquetMetadataCacheTest : public ::testing::Test {
+  ParquetMetadataCacheTest() : filename("/tmp/parquet_metadata_cache_test.parquet") {}
+
+  void SetUp() final {
+    std::shared_ptr<::arrow::io::FileOutputStream> stream;
+    PARQUET_THROW_NOT_OK(::arrow::io::FileOutputStream::Open(filename, &stream));
+
+    ::parquet::schema::NodeVector fields;
+    fields.push_back(::parquet::schema::PrimitiveNode::Make(
+        "int32_field", ::parquet::Repetition::REQUIRED, ::parquet::Type::INT32,
+        ::parquet::ConvertedType::NONE));
+    auto schema = std::static_pointer_cast<::parquet::schema::GroupNode>(
+        ::parquet::schema::GroupNode::Make(
+            "schema", ::parquet::Repetition::REQUIRED, fields));
+
+    std::shared_ptr<::parquet::ParquetFileWriter> file_writer =
+        ::parquet::ParquetFileWriter::Open(stream, schema);
+    for (std::int32_t group = 0; group < 3; group++) {
+      ::parquet::RowGroupWriter *row_group_writer = file_writer->AppendRowGroup();
+      auto *int32_writer =
+          static_cast<::parquet::Int32Writer *>(row_group_writer->NextColumn());
+      int32_writer->WriteBatch(1, nullptr, nullptr, &group);
+    }
+    file_writer->Close();
+    PARQUET_THROW_NOT_OK(stream->Close());
+  }
+
+  void TearDown() final { std::remove(filename.c_str()); }
+
+  std::shared_ptr<::arrow::io::RandomAccessFile> open() {
+    std::shared_ptr<::arrow::io::ReadableFile> file;
+    PARQUET_THROW_NOT_OK(::arrow::io::ReadableFile::Open(filename, &file));
+    return file;
+  }
+
+  parquet_file_key key(const std::string &uri, unsigned long long modification_time) {
+    parquet_file_key key;
+    key.uri = uri;
+    key.size = 100;
+    key.modification_time = modification_time;
+    return key;
+  }
+
+  const std::string filename;
+};
+
+TEST_F(ParquetMetadataCacheTest, ServesRepeatedReadsFromMemory) {
+  parquet_metadata_cache cache;
+
+  auto first = cache.get(key("file:///a.parquet", 1), open());
+  EXPECT_EQ(first->num_row_groups(), 3);
+  EXPECT_EQ(cache.misses(), 1);
+
+  // a null file would crash if the footer was read again
+  auto second = cache.get(key("file:///a.parquet", 1), nullptr);
+  EXPECT_EQ(second.get(), first.get());
+  EXPECT_EQ(cache.hits(), 1);
+  EXPECT_EQ(cache.size_bytes(), first->size());
+}
+
+TEST_F(ParquetMetadataCacheTest, RewrittenFilesMiss) {
+  parquet_metadata_cache cache;
+
+  cache.get(key("file:///a.parquet", 1), open());
+  cache.get(key("file:///a.parquet", 2), open());
+  auto etag_key = key("file:///a.parquet", 2);
+  etag_key.etag = "\"abc\"";
+  cache.get(etag_key, open());
+
+  EXPECT_EQ(cache.hits(), 0);
+  EXPECT_EQ(cache.misses(), 3);
+  EXPECT_EQ(cache.num_entries(), 3);
+}
+
+TEST_F(ParquetMetadataCacheTest, EvictsLeastRecentlyUsed) {
+  parquet_metadata_cache cache;
+  const std::size_t footer_size = cache.get(key("file:///probe", 0), open())->size();
+  cache.clear();
+  cache.set_capacity(2 * footer_size);
+
+  cache.get(key("file:///a.parquet", 0), open());
+  cache.get(key("file:///b.parquet", 0), open());
+  EXPECT_NE(cache.find(key("file:///a.parquet", 0)), nullptr);
+  cache.get(key("file:///c.parquet", 0), open());
+
+  EXPECT_EQ(cache.evictions(), 1);
+  EXPECT_NE(cache.find(key("file:///a.parquet", 0)), nullptr);
+  EXPECT_EQ(cache.find(key("file:///b.parquet", 0)), nullptr);
+  EXPECT_NE(cache.find(key("file:///c.parquet", 0)), nullptr);
+  EXPECT_LE(cache.size_bytes(), 2 * footer_size);
+
+  cache.set_capacity(0);
+  EXPECT_EQ(cache.num_entries(), 0);
+  cache.get(key("file:///a.parquet", 0), open());
+  EXPECT_EQ(cache.num_entries(), 0);
+}
@@ -0,0 +1,130 @@
+#include <gtest/gtest.h>
+
+#include <map>
+#include <string>
+#include <vector>
+
+#include "io/data_provider/UriDataProvider.h"
+#include "skip_data/partition_pruning.hpp"
+
+using ral::io::data_handle;
+using ral::io::uri_data_provider;
+using ral::skip_data::partition_filter;
+
+// the partitions the filter keeps, with how many it pruned when it fails
+#define EXPECT_KEPT(filter_expression, expected)                                 \
+  do {                                                                           \
+    size_t kept = prune(filter_expression);                                      \
+    EXPECT_EQ(kept, expected) << "\"" << filter_expression << "\": pruned "       \
+                              << uris.size() - kept << " of " << uris.size()     \
+                              << " files listed";                                \
+  } while (0)
+
+// a table with the columns value (in the files), year and region (partitions)
+struct PartitionPruningTest : public ::testing::Test {
+  PartitionPruningTest() : column_names({"value", "year", "region"}) {}
+
+  void SetUp() final {
+    for (int year = 2016; year <= 2020; year++) {
+      for (std::string region : {"eu", "us"}) {
+        uris.push_back(Uri("/tmp/table/year=" + std::to_string(year) + "/region=" + region + "/*"));
+        uri_scalars.push_back({{"year", int32_scalar(year)}});
+        string_scalars.push_back({{"region", region}});
+        is_column_string.push_back({{"year", false}, {"region", true}});
+      }
+    }
+  }
+
+  static gdf_scalar int64_scalar(int64_t value) {
+    gdf_scalar scalar;
+    scalar.data.si64 = value;
+    scalar.dtype = GDF_INT64;
+    scalar.is_valid = true;
+    return scalar;
+  }
+
+  static gdf_scalar int32_scalar(int32_t value) {
+    gdf_scalar scalar;
+    scalar.data.si32 = value;
+    scalar.dtype = GDF_INT32;
+    scalar.is_valid = true;
+    return scalar;
+  }
+
+  data_handle partition(size_t index) {
+    data_handle handle;
+    handle.column_values = uri_scalars[index];
+    handle.string_values = string_scalars[index];
+    handle.is_column_string = is_column_string[index];
+    return handle;
+  }
+
+  // the number of partitions the filter keeps
+  size_t prune(const std::string &filter_expression) {
+    partition_filter filter(filter_expression, column_names);
+    uri_data_provider provider(uris, uri_scalars, string_scalars, is_column_string);
+    auto pruned = provider.prune_partitions(
+        [&filter](const data_handle &partition) { return filter.can_skip(partition); });
+    return pruned->get_num_uris();
+  }
+
+  std::vector<std::string> column_names;
+  std::vector<Uri> uris;
+  std::vector<std::map<std::string, gdf_scalar>> uri_scalars;
+  std::vector<std::map<std::string, std::string>> string_scalars;
+  std::vector<std::map<std::string, bool>> is_column_string;
+};
+
+TEST_F(PartitionPruningTest, PrunesOnPartitionValues) {
+  EXPECT_KEPT("= $1 2019", 2);
+  EXPECT_KEPT(">= $1 2018", 6);
+  EXPECT_KEPT("AND = $1 2019 = $2 'us'", 1);
+  EXPECT_KEPT("OR = $1 2016 = $2 'eu'", 6);
+  EXPECT_KEPT("NOT = $2 'eu'", 5);
+  EXPECT_KEPT("= + $1 1 2020", 2);
+  EXPECT_KEPT("= $1 1999", 0);
+}
+
+TEST_F(PartitionPruningTest, KeepsWhatDependsOnFileColumns) {
+  // the value column is only known after reading the files
+  EXPECT_KEPT("> $0 5", uris.size());
+  EXPECT_KEPT("OR = $1 2019 > $0 5", uris.size());
+  EXPECT_KEPT("AND = $1 2019 > $0 5", 2);
+  EXPECT_KEPT("NOT AND = $1 2019 > $0 5", uris.size());
+  // operators not evaluated on the host keep everything
+  EXPECT_KEPT("= MOD $1 2 0", uris.size());
+  EXPECT_KEPT("LIKE $2 'u%'", uris.size());
+}
+
+TEST_F(PartitionPruningTest, InvalidFiltersKeepEverything) {
+  partition_filter filter("AND = $1 2019", column_names);
+  EXPECT_FALSE(filter.is_valid());
+  EXPECT_FALSE(filter.can_skip(partition(0)));
+
+  partition_filter unknown("UNKNOWN_OP $1", column_names);
+  EXPECT_FALSE(unknown.is_valid());
+  EXPECT_KEPT("= $1 2019 2020", uris.size());
+}
+
+TEST_F(PartitionPruningTest, NullPartitionValuesAreKept) {
+  uri_scalars[0]["year"].is_valid = false;
+  partition_filter filter("= $1 2019", column_names);
+  EXPECT_FALSE(filter.can_skip(partition(0)));
+  EXPECT_TRUE(filter.can_skip(partition(1)));
+}
+
+TEST_F(PartitionPruningTest, ComparesInt64PartitionValuesExactly) {
+  // 2^53 and 2^53 + 1 are the same double
+  for (size_t index = 0; index < uris.size(); index++) {
+    uri_scalars[index]["year"] = int64_scalar(9007199254740992LL + (index % 2));
+  }
+  EXPECT_KEPT("<> $1 9007199254740993", 5);
+  EXPECT_KEPT("< $1 9007199254740993", 5);
+  EXPECT_KEPT("= $1 9007199254740993", 5);
+  EXPECT_KEPT("= - $1 1 9007199254740991", 5);
+  // a float or a literal out of the int64 range can't be compared exactly
+  EXPECT_KEPT("< $1 9007199254740993.0", uris.size());
+  EXPECT_KEPT("< $1 1.5", 0);
+  EXPECT_KEPT("= $1 99999999999999999999", uris.size());
+  EXPECT_KEPT("= * $1 9007199254740992 0", uris.size());
+}
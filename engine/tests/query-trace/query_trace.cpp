@@ -0,0 +1,150 @@
+#include <gtest/gtest.h>
+
+#include <cstdio>
+#include <fstream>
+#include <sstream>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include "utilities/QueryTrace.h"
+
+using ral::utilities::query_trace_recorder;
+using ral::utilities::trace_event;
+using ral::utilities::trace_span;
+
+struct QueryTraceTest : public ::testing::Test {
+  void SetUp() final { query_trace_recorder::getInstance().set_output_directory("/tmp"); }
+
+  void TearDown() final { query_trace_recorder::getInstance().set_output_directory(""); }
+
+  const trace_event &find(const std::vector<trace_event> &events, const std::string &name) {
+    for (const trace_event &event : events) {
+      if (event.name == name) {
+        return event;
+      }
+    }
+    throw std::runtime_error("no span " + name);
+  }
+};
+
+TEST_F(QueryTraceTest, RecordsNestedSpans) {
+  {
+    trace_span query(7, 0, 0, "query", "query");
+    {
+      trace_span load(7, 1, 0, "scan", "load_data");
+      load.set_rows(100);
+      load.set_bytes(800);
+      // a child of the innermost span of this thread
+      trace_span fetch("metadata", "fetch parquet footer");
+      EXPECT_TRUE(fetch.is_active());
+    }
+    std::thread worker([]() {
+      // no span open on this thread
+      trace_span orphan("metadata", "orphan");
+      EXPECT_FALSE(orphan.is_active());
+      trace_span parse(7, 1, 2, "scan", "parse file");
+      parse.set_arg("file", "/data/\"a\".parquet");
+    });
+    worker.join();
+  }
+
+  std::vector<trace_event> events = query_trace_recorder::getInstance().get_events(7);
+  ASSERT_EQ(events.size(), 4);
+  const trace_event &query = find(events, "query");
+  const trace_event &load = find(events, "load_data");
+  const trace_event &fetch = find(events, "fetch parquet footer");
+  const trace_event &parse = find(events, "parse file");
+
+  EXPECT_EQ(load.rows, 100);
+  EXPECT_EQ(load.bytes, 800);
+  EXPECT_EQ(query.rows, -1);
+  EXPECT_EQ(fetch.query_step, 1);
+  EXPECT_EQ(parse.query_substep, 2);
+  EXPECT_EQ(load.thread_id, query.thread_id);
+  EXPECT_NE(parse.thread_id, query.thread_id);
+
+  // the children are inside their parents
+  EXPECT_GE(load.start_us, query.start_us);
+  EXPECT_LE(load.start_us + load.duration_us, query.start_us + query.duration_us);
+  EXPECT_GE(fetch.start_us, load.start_us);
+  EXPECT_LE(fetch.start_us + fetch.duration_us, load.start_us + load.duration_us);
+
+  std::string json = query_trace_recorder::getInstance().to_json(7, 3);
+  EXPECT_NE(json.find("\"name\":\"process_name\",\"ph\":\"M\",\"pid\":3"), std::string::npos);
+  EXPECT_NE(json.find("\"name\":\"load_data\",\"cat\":\"scan\",\"ph\":\"X\""), std::string::npos);
+  EXPECT_NE(json.find("\"rows\":100,\"bytes\":800"), std::string::npos);
+  EXPECT_NE(json.find("\"file\":\"/data/\\\"a\\\".parquet\""), std::string::npos);
+  query_trace_recorder::getInstance().discard(7);
+}
+
+TEST_F(QueryTraceTest, WritesAndForgetsTheQuery) {
+  {
+    trace_span query(8, 0, 0, "query", "query");
+  }
+  trace_span other(9, 0, 0, "query", "query");
+  other.end();
+
+  std::string path = query_trace_recorder::getInstance().write(8, 1);
+  EXPECT_EQ(path, "/tmp/query_8_node_1.json");
+  EXPECT_TRUE(query_trace_recorder::getInstance().get_events(8).empty());
+  EXPECT_EQ(query_trace_recorder::getInstance().get_events(9).size(), 1);
+
+  std::ifstream file(path);
+  std::stringstream contents;
+  contents << file.rdbuf();
+  EXPECT_EQ(contents.str().find("{\"traceEvents\":["), 0);
+  EXPECT_NE(contents.str().find("\"otherData\":{\"context_token\":8,\"node_index\":1}"), std::string::npos);
+  std::remove(path.c_str());
+  query_trace_recorder::getInstance().discard(9);
+}
+
+TEST_F(QueryTraceTest, DisabledSpansDoNothing) {
+  query_trace_recorder::getInstance().set_output_directory("");
+  {
+    trace_span query(10, 0, 0, "query", "query");
+    EXPECT_FALSE(query.is_active());
+    trace_span child("scan", "child");
+    EXPECT_FALSE(child.is_active());
+  }
+  EXPECT_TRUE(query_trace_recorder::getInstance().get_events(10).empty());
+  EXPECT_EQ(query_trace_recorder::getInstance().write(10, 0), "");
+}
+
+TEST_F(QueryTraceTest, ProfilesAQueryWithoutTracing) {
+  query_trace_recorder::getInstance().set_output_directory("");
+  query_trace_recorder::getInstance().profile_query(11);
+  EXPECT_TRUE(query_trace_recorder::getInstance().is_recording(11));
+  EXPECT_FALSE(query_trace_recorder::getInstance().is_recording(12));
+  {
+    trace_span query(11, 0, 0, "query", "query");
+    trace_span filter(11, 1, 0, "operator", "filter");
+    filter.set_rows_in(100);
+    filter.set_rows(40);
+    trace_span shuffle("shuffle", "send");
+    EXPECT_TRUE(shuffle.is_active());
+    trace_span other(12, 0, 0, "query", "query");
+    EXPECT_FALSE(other.is_active());
+  }
+
+  std::vector<trace_event> events = query_trace_recorder::getInstance().take_events(11);
+  ASSERT_EQ(events.size(), 3);
+  EXPECT_EQ(find(events, "filter").rows_in, 100);
+  EXPECT_EQ(find(events, "filter").rows, 40);
+  EXPECT_EQ(find(events, "send").query_step, 1);
+
+  // taken once, and not kept afterwards
+  EXPECT_TRUE(query_trace_recorder::getInstance().take_events(11).empty());
+  EXPECT_FALSE(query_trace_recorder::getInstance().is_recording(11));
+}
+
+TEST_F(QueryTraceTest, KeepsAProfiledQueryItWrites) {
+  query_trace_recorder::getInstance().profile_query(13);
+  {
+    trace_span query(13, 0, 0, "query", "query");
+  }
+  std::string path = query_trace_recorder::getInstance().write(13, 0);
+  EXPECT_EQ(path, "/tmp/query_13_node_0.json");
+  std::remove(path.c_str());
+  EXPECT_EQ(query_trace_recorder::getInstance().take_events(13).size(), 1);
+}
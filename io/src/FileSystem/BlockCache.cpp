@@ -0,0 +1,495 @@
+/*
+ * Copyright 2017 BlazingDB, Inc.
+ */
+
+#include "BlockCache.h"
+
+#include <algorithm>
+#include <cctype>
+#include <cerrno>
+#include <cstdlib>
+#include <cstring>
+#include <ctime>
+#include <sstream>
+#include <stdexcept>
+#include <thread>
+
+#include <dirent.h>
+#include <fcntl.h>
+#include <sys/file.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+#include "Library/Logging/Logger.h"
+#include "Util/EnvUtil.h"
+#include "Util/StringUtil.h"
+
+namespace Logging = Library::Logging;
+
+namespace {
+
+const char BLOCK_MAGIC[8] = {'B', 'Z', 'B', 'L', 'O', 'C', 'K', '1'};
+const int64_t DATA_ALIGNMENT = 4096;
+
+// Starts every block file, followed by the key and then the data at dataOffset
+struct BlockFileHeader {
+	char magic[8];
+	uint64_t keyLength;
+	uint64_t dataOffset;
+	uint64_t dataLength;
+};
+
+std::string errorMessage(const std::string & what, const std::string & path) {
+	return what + " " + path + ": " + std::strerror(errno);
+}
+
+bool makeDirectories(const std::string & directory) {
+	for(size_t slash = directory.find('/', 1);; slash = directory.find('/', slash + 1)) {
+		const std::string parent = directory.substr(0, slash);
+		if(mkdir(parent.c_str(), 0755) != 0 && errno != EEXIST) {
+			return false;
+		}
+		if(slash == std::string::npos) {
+			return true;
+		}
+	}
+}
+
+bool writeFully(int fd, const uint8_t * data, int64_t nbytes) {
+	while(nbytes > 0) {
+		const ssize_t written = ::write(fd, data, nbytes);
+		if(written < 0 && errno == EINTR) {
+			continue;
+		}
+		if(written <= 0) {
+			return false;
+		}
+		data += written;
+		nbytes -= written;
+	}
+	return true;
+}
+
+bool readFully(int fd, uint8_t * data, int64_t nbytes, int64_t offset) {
+	while(nbytes > 0) {
+		const ssize_t bytesRead = ::pread(fd, data, nbytes, offset);
+		if(bytesRead < 0 && errno == EINTR) {
+			continue;
+		}
+		if(bytesRead <= 0) {
+			return false;
+		}
+		data += bytesRead;
+		nbytes -= bytesRead;
+		offset += bytesRead;
+	}
+	return true;
+}
+
+// Copies [offset, offset + nbytes) of block to out
+int64_t copySlice(const arrow::Buffer & block, int64_t offset, int64_t nbytes, uint8_t * out) {
+	const int64_t available = std::max<int64_t>(0, std::min(nbytes, block.size() - offset));
+	if(available > 0) {
+		std::memcpy(out, block.data() + offset, available);
+	}
+	return available;
+}
+
+}  // namespace
+
+BlockCacheOptions BlockCacheOptions::fromEnvironment() {
+	BlockCacheOptions options;
+	const char * directory = std::getenv("BLAZING_BLOCK_CACHE_DIR");
+	options.directory = directory == nullptr ? "" : directory;
+	options.capacityBytes = std::max<int64_t>(0, EnvUtil::getInt("BLAZING_BLOCK_CACHE_BYTES", options.capacityBytes));
+	options.blockSize = std::max<int64_t>(4096, EnvUtil::getInt("BLAZING_BLOCK_CACHE_BLOCK_SIZE", options.blockSize));
+	options.syncWrites = EnvUtil::getInt("BLAZING_BLOCK_CACHE_SYNC", options.syncWrites) != 0;
+	return options;
+}
+
+std::string BlockKey::toString() const {
+	return StringUtil::makeCacheKey(
+		{this->uri, this->version, std::to_string(this->fileSize), std::to_string(this->blockIndex)});
+}
+
+double BlockCacheStats::hitRatio() const {
+	const int64_t reads = this->hits + this->misses;
+	return reads == 0 ? 0 : double(this->hits) / reads;
+}
+
+std::shared_ptr<BlockCache> BlockCache::open(const BlockCacheOptions & options) {
+	if(options.directory.empty()) {
+		return nullptr;
+	}
+	try {
+		return std::make_shared<BlockCache>(options);
+	} catch(const std::exception & e) {
+		Logging::Logger().logWarn(std::string("Block cache disabled: ") + e.what());
+		return nullptr;
+	}
+}
+
+BlockCache::BlockCache(const BlockCacheOptions & options)
+	: options(options), lockFd(-1), usedBytes(0), evictions(0) {
+	if(!makeDirectories(this->options.directory)) {
+		throw std::runtime_error(errorMessage("could not create", this->options.directory));
+	}
+	const std::string lockPath = this->options.directory + "/lock";
+	this->lockFd = ::open(lockPath.c_str(), O_RDWR | O_CREAT | O_CLOEXEC, 0644);
+	if(this->lockFd < 0) {
+		throw std::runtime_error(errorMessage("could not open", lockPath));
+	}
+	if(flock(this->lockFd, LOCK_EX | LOCK_NB) != 0) {
+		const bool inUse = errno == EWOULDBLOCK;
+		const std::string message = errorMessage("could not lock", lockPath);
+		::close(this->lockFd);
+		if(inUse) {
+			throw std::runtime_error(
+				this->options.directory + " is in use by another process, remote files are read without the cache");
+		}
+		throw std::runtime_error(message);
+	}
+	this->loadIndex();
+}
+
+BlockCache::~BlockCache() {
+	// the next process loads the blocks in the order of their modification times, oldest first
+	struct timespec now;
+	clock_gettime(CLOCK_REALTIME, &now);
+	const int64_t nowNanoseconds = int64_t(now.tv_sec) * 1000000000 + now.tv_nsec;
+	int64_t age = 0;
+	for(const Entry & entry : this->entries) {
+		const int64_t time = nowNanoseconds - age;
+		struct timespec times[2];
+		times[0].tv_sec = 0;
+		times[0].tv_nsec = UTIME_OMIT;
+		times[1].tv_sec = time / 1000000000;
+		times[1].tv_nsec = time % 1000000000;
+		utimensat(AT_FDCWD, entry.path.c_str(), times, 0);
+		age += 1000;
+	}
+	::close(this->lockFd);
+}
+
+std::string BlockCache::blockPath(const std::string & key) const {
+	// 128 bits of hash, the name of a block never collides in practice
+	const size_t first = std::hash<std::string>()(key);
+	const size_t second = std::hash<std::string>()(key + "\n" + std::to_string(first));
+	char name[64];
+	snprintf(name, sizeof(name), "%02x/%016zx%016zx.blk", unsigned(first & 0xff), first, second);
+	return this->options.directory + "/" + name;
+}
+
+void BlockCache::loadIndex() {
+	struct LoadedEntry {
+		Entry entry;
+		int64_t modificationTime;
+	};
+	std::vector<LoadedEntry> loaded;
+
+	DIR * directory = opendir(this->options.directory.c_str());
+	if(directory == nullptr) {
+		throw std::runtime_error(errorMessage("could not list", this->options.directory));
+	}
+	std::vector<std::string> subdirectories;
+	for(dirent * item = readdir(directory); item != nullptr; item = readdir(directory)) {
+		const std::string name = item->d_name;
+		if(name.size() == 2 && std::isxdigit(name[0]) && std::isxdigit(name[1])) {
+			subdirectories.push_back(this->options.directory + "/" + name);
+		}
+	}
+	closedir(directory);
+
+	for(const std::string & subdirectory : subdirectories) {
+		DIR * blocks = opendir(subdirectory.c_str());
+		if(blocks == nullptr) {
+			continue;
+		}
+		for(dirent * item = readdir(blocks); item != nullptr; item = readdir(blocks)) {
+			const std::string name = item->d_name;
+			if(name == "." || name == "..") {
+				continue;
+			}
+			const std::string path = subdirectory + "/" + name;
+			bool valid = false;
+			const int fd = ::open(path.c_str(), O_RDONLY | O_CLOEXEC);
+			struct stat status;
+			BlockFileHeader header;
+			if(fd >= 0 && name.size() > 4 && name.compare(name.size() - 4, 4, ".blk") == 0 &&
+				fstat(fd, &status) == 0 && readFully(fd, (uint8_t *) &header, sizeof(header), 0) &&
+				std::memcmp(header.magic, BLOCK_MAGIC, sizeof(BLOCK_MAGIC)) == 0 &&
+				header.keyLength < uint64_t(DATA_ALIGNMENT) && int64_t(header.dataOffset + header.dataLength) == status.st_size) {
+				std::string key(header.keyLength, '\0');
+				if(readFully(fd, (uint8_t *) &key[0], header.keyLength, sizeof(header)) && this->blockPath(key) == path) {
+					Entry entry{key, key.substr(0, key.find('\n')), path, int64_t(header.dataOffset),
+						int64_t(header.dataLength), int64_t(status.st_size)};
+					loaded.push_back(LoadedEntry{entry, int64_t(status.st_mtim.tv_sec) * 1000000000 + status.st_mtim.tv_nsec});
+					valid = true;
+				}
+			}
+			if(fd >= 0) {
+				::close(fd);
+			}
+			if(!valid) {
+				// temporary files of fills interrupted by a crash, or foreign files
+				unlink(path.c_str());
+			}
+		}
+		closedir(blocks);
+	}
+
+	std::sort(loaded.begin(), loaded.end(), [](const LoadedEntry & a, const LoadedEntry & b) {
+		return a.modificationTime > b.modificationTime;
+	});
+	std::lock_guard<std::mutex> lock(this->mutex);
+	for(LoadedEntry & item : loaded) {
+		this->usedBytes += item.entry.bytes;
+		this->entries.push_back(std::move(item.entry));
+		this->index[this->entries.back().key] = std::prev(this->entries.end());
+	}
+	this->evictToCapacity();
+	Logging::Logger().logInfo("Block cache at " + this->options.directory + " loaded " +
+							  std::to_string(this->entries.size()) + " blocks, " + std::to_string(this->usedBytes) +
+							  " bytes");
+}
+
+void BlockCache::insert(Entry entry) {
+	std::lock_guard<std::mutex> lock(this->mutex);
+	auto it = this->index.find(entry.key);
+	if(it != this->index.end()) {
+		this->usedBytes -= it->second->bytes;
+		this->entries.erase(it->second);
+		this->index.erase(it);
+	}
+	this->usedBytes += entry.bytes;
+	this->entries.push_front(std::move(entry));
+	this->index[this->entries.front().key] = this->entries.begin();
+	this->evictToCapacity();
+}
+
+void BlockCache::evictToCapacity() {
+	while(this->usedBytes > this->options.capacityBytes && !this->entries.empty()) {
+		const Entry & last = this->entries.back();
+		// readers that already opened or mapped the block keep reading it
+		unlink(last.path.c_str());
+		this->usedBytes -= last.bytes;
+		this->index.erase(last.key);
+		this->entries.pop_back();
+		this->evictions++;
+	}
+}
+
+arrow::Status BlockCache::readCached(
+	const Entry & entry, int64_t offset, int64_t nbytes, int64_t * bytesRead, uint8_t * out) {
+	const int64_t available = std::max<int64_t>(0, std::min(nbytes, entry.dataLength - offset));
+	const int fd = ::open(entry.path.c_str(), O_RDONLY | O_CLOEXEC);
+	if(fd < 0) {
+		return arrow::Status::IOError(errorMessage("could not open", entry.path));
+	}
+	arrow::Status status = arrow::Status::OK();
+	if(!readFully(fd, out, available, entry.dataOffset + offset)) {
+		status = arrow::Status::IOError(errorMessage("could not read", entry.path));
+	}
+	::close(fd);
+	*bytesRead = available;
+	return status;
+}
+
+arrow::Status BlockCache::writeBlock(
+	const std::string & key, const std::string & uri, const arrow::Buffer & block, Entry * entry) {
+	const std::string path = this->blockPath(key);
+	if(!makeDirectories(path.substr(0, path.rfind('/')))) {
+		return arrow::Status::IOError(errorMessage("could not create the directory of", path));
+	}
+	std::ostringstream tmpPath;
+	tmpPath << path << ".tmp." << std::this_thread::get_id();
+
+	BlockFileHeader header;
+	std::memcpy(header.magic, BLOCK_MAGIC, sizeof(BLOCK_MAGIC));
+	header.keyLength = key.size();
+	header.dataOffset = (sizeof(header) + key.size() + DATA_ALIGNMENT - 1) / DATA_ALIGNMENT * DATA_ALIGNMENT;
+	header.dataLength = block.size();
+	std::vector<uint8_t> prefix(header.dataOffset, 0);
+	std::memcpy(prefix.data(), &header, sizeof(header));
+	std::memcpy(prefix.data() + sizeof(header), key.data(), key.size());
+
+	const int fd = ::open(tmpPath.str().c_str(), O_WRONLY | O_CREAT | O_TRUNC | O_CLOEXEC, 0644);
+	if(fd < 0) {
+		return arrow::Status::IOError(errorMessage("could not create", tmpPath.str()));
+	}
+	bool ok = writeFully(fd, prefix.data(), prefix.size()) && writeFully(fd, block.data(), block.size());
+	if(ok && this->options.syncWrites) {
+		ok = fdatasync(fd) == 0;
+	}
+	ok = ::close(fd) == 0 && ok;
+	// the block appears complete or not at all
+	if(!ok || rename(tmpPath.str().c_str(), path.c_str()) != 0) {
+		const std::string message = errorMessage("could not write", tmpPath.str());
+		unlink(tmpPath.str().c_str());
+		return arrow::Status::IOError(message);
+	}
+
+	*entry = Entry{key, uri, path, int64_t(header.dataOffset), int64_t(header.dataLength),
+		int64_t(header.dataOffset + header.dataLength)};
+	return arrow::Status::OK();
+}
+
+BlockCacheStats & BlockCache::stats(const std::string & fileSystem) {
+	std::lock_guard<std::mutex> lock(this->mutex);
+	std::shared_ptr<BlockCacheStats> & stats = this->fileSystemStats[fileSystem];
+	if(stats == nullptr) {
+		stats = std::make_shared<BlockCacheStats>();
+	}
+	return *stats;
+}
+
+arrow::Status BlockCache::read(const std::string & fileSystem,
+	const BlockKey & key,
+	int64_t blockLength,
+	int64_t offset,
+	int64_t nbytes,
+	const FillFunction & fill,
+	int64_t * bytesRead,
+	uint8_t * out) {
+	BlockCacheStats & fileSystemStats = this->stats(fileSystem);
+	const std::string cacheKey = key.toString();
+	std::shared_ptr<Fill> ownFill;
+
+	while(ownFill == nullptr) {
+		std::unique_lock<std::mutex> lock(this->mutex);
+		auto it = this->index.find(cacheKey);
+		if(it != this->index.end()) {
+			this->entries.splice(this->entries.begin(), this->entries, it->second);
+			const Entry entry = *it->second;
+			lock.unlock();
+
+			if(this->readCached(entry, offset, nbytes, bytesRead, out).ok()) {
+				fileSystemStats.hits++;
+				fileSystemStats.hitBytes += *bytesRead;
+				return arrow::Status::OK();
+			}
+			// evicted in the meantime, fill it again
+			lock.lock();
+			auto stale = this->index.find(cacheKey);
+			if(stale != this->index.end() && stale->second->path == entry.path) {
+				this->usedBytes -= stale->second->bytes;
+				this->entries.erase(stale->second);
+				this->index.erase(stale);
+			}
+			continue;
+		}
+
+		auto inFlight = this->fills.find(cacheKey);
+		if(inFlight != this->fills.end()) {
+			std::shared_ptr<Fill> otherFill = inFlight->second;
+			this->filled.wait(lock, [&otherFill]() { return otherFill->done; });
+			if(!otherFill->status.ok()) {
+				return otherFill->status;
+			}
+			// the filled block is not changed anymore, copy it unlocked
+			std::shared_ptr<arrow::Buffer> block = otherFill->block;
+			lock.unlock();
+			*bytesRead = copySlice(*block, offset, nbytes, out);
+			fileSystemStats.hits++;
+			fileSystemStats.hitBytes += *bytesRead;
+			return arrow::Status::OK();
+		}
+
+		ownFill = std::make_shared<Fill>();
+		this->fills[cacheKey] = ownFill;
+	}
+
+	std::shared_ptr<arrow::Buffer> block;
+	arrow::Status status = fill(&block);
+	{
+		std::lock_guard<std::mutex> lock(this->mutex);
+		ownFill->status = status;
+		ownFill->block = block;
+		ownFill->done = true;
+		if(!status.ok()) {
+			this->fills.erase(cacheKey);
+		}
+	}
+	this->filled.notify_all();
+	if(!status.ok()) {
+		return status;
+	}
+	fileSystemStats.misses++;
+	fileSystemStats.missBytes += block->size();
+
+	const int64_t size = block->size();
+	*bytesRead = copySlice(*block, offset, nbytes, out);
+
+	// readers of the block are served from memory until it is on disk
+	Entry entry;
+	arrow::Status writeStatus = arrow::Status::OK();
+	if(size == blockLength) {
+		writeStatus = this->writeBlock(cacheKey, key.uri, *block, &entry);
+		if(writeStatus.ok()) {
+			this->insert(entry);
+		} else {
+			Logging::Logger().logWarn("Block cache: " + writeStatus.ToString());
+		}
+	}
+	std::lock_guard<std::mutex> lock(this->mutex);
+	this->fills.erase(cacheKey);
+	return arrow::Status::OK();
+}
+
+bool BlockCache::contains(const BlockKey & key) const {
+	std::lock_guard<std::mutex> lock(this->mutex);
+	return this->index.count(key.toString()) > 0;
+}
+
+void BlockCache::invalidate(const std::string & uri) {
+	std::lock_guard<std::mutex> lock(this->mutex);
+	for(auto it = this->entries.begin(); it != this->entries.end();) {
+		if(it->uri == uri) {
+			unlink(it->path.c_str());
+			this->usedBytes -= it->bytes;
+			this->index.erase(it->key);
+			it = this->entries.erase(it);
+		} else {
+			++it;
+		}
+	}
+}
+
+int64_t BlockCache::getUsedBytes() const {
+	std::lock_guard<std::mutex> lock(this->mutex);
+	return this->usedBytes;
+}
+
+int64_t BlockCache::getNumBlocks() const {
+	std::lock_guard<std::mutex> lock(this->mutex);
+	return this->entries.size();
+}
+
+std::shared_ptr<BlockCacheStats> BlockCache::getStats(const std::string & fileSystem) const {
+	std::lock_guard<std::mutex> lock(this->mutex);
+	auto it = this->fileSystemStats.find(fileSystem);
+	return it == this->fileSystemStats.end() ? nullptr : it->second;
+}
+
+std::vector<std::string> BlockCache::getFileSystems() const {
+	std::lock_guard<std::mutex> lock(this->mutex);
+	std::vector<std::string> fileSystems;
+	for(const auto & item : this->fileSystemStats) {
+		fileSystems.push_back(item.first);
+	}
+	return fileSystems;
+}
+
+std::string BlockCache::toString() const {
+	std::string description = "used_bytes=" + std::to_string(this->getUsedBytes()) +
+							  " blocks=" + std::to_string(this->getNumBlocks()) +
+							  " evictions=" + std::to_string(this->evictions);
+	for(const std::string & fileSystem : this->getFileSystems()) {
+		std::shared_ptr<BlockCacheStats> stats = this->getStats(fileSystem);
+		description += " " + fileSystem + ":hit_ratio=" + std::to_string(stats->hitRatio()) +
+					   ",hits=" + std::to_string(stats->hits) + ",misses=" + std::to_string(stats->misses) +
+					   ",hit_bytes=" + std::to_string(stats->hitBytes) +
+					   ",miss_bytes=" + std::to_string(stats->missBytes);
+	}
+	return description;
+}
@@ -0,0 +1,146 @@
+/*
+ * Copyright 2017 BlazingDB, Inc.
+ */
+
+#ifndef _BZ_BLOCK_CACHE_H_
+#define _BZ_BLOCK_CACHE_H_
+
+#include <atomic>
+#include <condition_variable>
+#include <cstdint>
+#include <functional>
+#include <list>
+#include <map>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+#include "arrow/buffer.h"
+#include "arrow/status.h"
+
+struct BlockCacheOptions {
+	// Empty disables the cache. Only one process at a time uses a directory: the others find it locked and read
+	// the remote files without the cache, so every process of a host (e.g. every worker) needs its own directory.
+	std::string directory;
+	int64_t capacityBytes = 64LL * 1024 * 1024 * 1024;  // disk budget, block headers included
+	int64_t blockSize = 4 * 1024 * 1024;				   // files are cached in aligned blocks of this size
+	bool syncWrites = true;  // fdatasync blocks before publishing them, so a crash never leaves a torn block
+
+	// Reads BLAZING_BLOCK_CACHE_DIR, BLAZING_BLOCK_CACHE_BYTES, BLAZING_BLOCK_CACHE_BLOCK_SIZE and
+	// BLAZING_BLOCK_CACHE_SYNC
+	static BlockCacheOptions fromEnvironment();
+};
+
+// Identifies one block of one version of a remote file
+struct BlockKey {
+	std::string uri;
+	std::string version;  // the ETag or the modification time, a rewritten file gets new keys
+	int64_t fileSize = 0;
+	int64_t blockIndex = 0;
+
+	std::string toString() const;
+};
+
+// Counters of the reads of one file system through the cache
+struct BlockCacheStats {
+	std::atomic<int64_t> hits{0};		// block reads served from disk or from a fill in flight
+	std::atomic<int64_t> misses{0};		// block reads that had to fetch the block
+	std::atomic<int64_t> hitBytes{0};
+	std::atomic<int64_t> missBytes{0};  // bytes fetched from the remote file system to fill blocks
+
+	double hitRatio() const;
+};
+
+/**
+ * Block level disk cache of remote files (e.g. on a local NVMe drive), shared by all the files of the process.
+ *
+ * Every block is one file holding a header with its full key and the data. Blocks are written to a temporary file
+ * and renamed into place, so the directory itself is the crash-safe metadata: on open the index is rebuilt from the
+ * headers (oldest first, by modification time), incomplete blocks are deleted and the blocks over the budget are
+ * evicted. Blocks are evicted least recently used first. The recency is kept in memory and written to the
+ * modification times of the blocks when the cache is destroyed. Concurrent misses on one block do a single fetch, the
+ * other readers wait for it. A directory is used by one process at a time (it is locked with flock), open returns
+ * nullptr in the others.
+ */
+class BlockCache {
+public:
+	// Fetches the whole block, the cache only keeps blocks of the expected length
+	using FillFunction = std::function<arrow::Status(std::shared_ptr<arrow::Buffer> * block)>;
+
+	// Returns nullptr when options.directory is empty, can not be used or is locked by another process
+	static std::shared_ptr<BlockCache> open(const BlockCacheOptions & options);
+
+	explicit BlockCache(const BlockCacheOptions & options);
+	~BlockCache();
+
+	/**
+	 * Copies [offset, offset + nbytes) of the block of key, which is blockLength bytes long, to out. Hits are read
+	 * from disk, misses are filled with fill and written to disk. bytesRead is shorter than nbytes when the block is
+	 * shorter than expected. fileSystem only names the stats the read counts in.
+	 */
+	arrow::Status read(const std::string & fileSystem,
+		const BlockKey & key,
+		int64_t blockLength,
+		int64_t offset,
+		int64_t nbytes,
+		const FillFunction & fill,
+		int64_t * bytesRead,
+		uint8_t * out);
+
+	// Whether the block of key is on disk, a read of it may still miss if it is evicted in the meantime
+	bool contains(const BlockKey & key) const;
+
+	// Drops every block of uri, whatever its version
+	void invalidate(const std::string & uri);
+
+	const BlockCacheOptions & getOptions() const { return options; }
+	int64_t getUsedBytes() const;
+	int64_t getNumBlocks() const;
+	int64_t getEvictions() const { return evictions; }
+
+	// nullptr when nothing was read from fileSystem yet
+	std::shared_ptr<BlockCacheStats> getStats(const std::string & fileSystem) const;
+	std::vector<std::string> getFileSystems() const;
+	std::string toString() const;
+
+private:
+	struct Entry {
+		std::string key;
+		std::string uri;
+		std::string path;
+		int64_t dataOffset;
+		int64_t dataLength;
+		int64_t bytes;  // on disk
+	};
+
+	struct Fill {
+		bool done = false;
+		arrow::Status status;
+		std::shared_ptr<arrow::Buffer> block;
+	};
+
+	std::string blockPath(const std::string & key) const;
+	void loadIndex();
+	void insert(Entry entry);
+	void evictToCapacity();
+	arrow::Status readCached(const Entry & entry, int64_t offset, int64_t nbytes, int64_t * bytesRead, uint8_t * out);
+	arrow::Status writeBlock(
+		const std::string & key, const std::string & uri, const arrow::Buffer & block, Entry * entry);
+	BlockCacheStats & stats(const std::string & fileSystem);
+
+	const BlockCacheOptions options;
+	int lockFd;
+
+	mutable std::mutex mutex;  // guards everything below
+	std::condition_variable filled;
+	std::list<Entry> entries;  // most recently used first
+	std::unordered_map<std::string, std::list<Entry>::iterator> index;
+	std::unordered_map<std::string, std::shared_ptr<Fill>> fills;  // in flight, by key
+	std::map<std::string, std::shared_ptr<BlockCacheStats>> fileSystemStats;
+	int64_t usedBytes;
+	std::atomic<int64_t> evictions;
+};
+
+#endif /* _BZ_BLOCK_CACHE_H_ */
@@ -0,0 +1,166 @@
+/*
+ * Copyright 2017 BlazingDB, Inc.
+ */
+
+#include "BlockCachedReadableFile.h"
+
+#include <algorithm>
+#include <atomic>
+#include <vector>
+
+#include <arrow/memory_pool.h>
+
+#include "ExceptionHandling/BlazingThread.h"
+
+namespace {
+
+// Blocks of one read fetched at the same time
+const size_t MAX_CONCURRENT_FILLS = 16;
+
+}  // namespace
+
+BlockCachedReadableFile::BlockCachedReadableFile(std::shared_ptr<arrow::io::RandomAccessFile> file,
+	std::shared_ptr<BlockCache> cache,
+	const std::string & fileSystem,
+	const std::string & uri,
+	int64_t size,
+	const std::string & version)
+	: file(file), cache(cache), fileSystem(fileSystem), uri(uri), size(size), version(version), position(0) {}
+
+BlockKey BlockCachedReadableFile::getBlockKey(int64_t blockIndex) const {
+	BlockKey key;
+	key.uri = this->uri;
+	key.version = this->version;
+	key.fileSize = this->size;
+	key.blockIndex = blockIndex;
+	return key;
+}
+
+arrow::Status BlockCachedReadableFile::readBlock(
+	int64_t blockIndex, int64_t offset, int64_t nbytes, int64_t * bytesRead, uint8_t * out) {
+	const int64_t blockSize = this->cache->getOptions().blockSize;
+	const int64_t blockLength = std::min(blockSize, this->size - blockIndex * blockSize);
+	auto fill = [this, blockIndex, blockSize, blockLength](std::shared_ptr<arrow::Buffer> * block) {
+		return this->file->ReadAt(blockIndex * blockSize, blockLength, block);
+	};
+	return this->cache->read(
+		this->fileSystem, this->getBlockKey(blockIndex), blockLength, offset, nbytes, fill, bytesRead, out);
+}
+
+arrow::Status BlockCachedReadableFile::ReadAt(int64_t position, int64_t nbytes, std::shared_ptr<arrow::Buffer> * out) {
+	const int64_t end = std::min(this->size, position + nbytes);
+	std::shared_ptr<arrow::ResizableBuffer> buffer;
+	ARROW_RETURN_NOT_OK(
+		AllocateResizableBuffer(arrow::default_memory_pool(), std::max<int64_t>(0, end - position), &buffer));
+	int64_t bytesRead = 0;
+	ARROW_RETURN_NOT_OK(this->ReadAt(position, end - position, &bytesRead, buffer->mutable_data()));
+	ARROW_RETURN_NOT_OK(buffer->Resize(bytesRead));
+	*out = buffer;
+	return arrow::Status::OK();
+}
+
+arrow::Status BlockCachedReadableFile::ReadAt(int64_t position, int64_t nbytes, int64_t * bytesRead, void * buffer) {
+	struct BlockRead {
+		int64_t blockIndex;
+		int64_t offset;
+		int64_t nbytes;
+		uint8_t * out;
+		int64_t bytesRead;
+		arrow::Status status;
+	};
+
+	const int64_t blockSize = this->cache->getOptions().blockSize;
+	const int64_t end = std::min(this->size, position + nbytes);
+	*bytesRead = 0;
+	if(position >= end) {
+		return arrow::Status::OK();
+	}
+
+	// the blocks missing from the cache first, so they are the ones fetched concurrently
+	std::vector<BlockRead> reads;
+	size_t numMissing = 0;
+	for(int64_t current = position; current < end;) {
+		const int64_t blockIndex = current / blockSize;
+		const int64_t blockEnd = std::min(end, (blockIndex + 1) * blockSize);
+		reads.push_back(BlockRead{blockIndex,
+			current % blockSize,
+			blockEnd - current,
+			static_cast<uint8_t *>(buffer) + (current - position),
+			0,
+			arrow::Status::OK()});
+		current = blockEnd;
+	}
+	for(size_t i = 0; i < reads.size(); i++) {
+		if(!this->cache->contains(this->getBlockKey(reads[i].blockIndex))) {
+			std::swap(reads[i], reads[numMissing]);
+			numMissing++;
+		}
+	}
+
+	// every block is still single-flight in the cache, a block another reader is filling is waited for
+	std::atomic<size_t> next(0);
+	auto readBlocks = [this, &reads, &next]() {
+		for(size_t i = next++; i < reads.size(); i = next++) {
+			BlockRead & read = reads[i];
+			read.status = this->readBlock(read.blockIndex, read.offset, read.nbytes, &read.bytesRead, read.out);
+		}
+	};
+	std::vector<BlazingThread> fillers;
+	for(size_t i = 1; i < std::min(numMissing, MAX_CONCURRENT_FILLS); i++) {
+		fillers.emplace_back(readBlocks);
+	}
+	readBlocks();
+	for(auto & filler : fillers) {
+		filler.join();
+	}
+
+	std::sort(reads.begin(), reads.end(), [](const BlockRead & a, const BlockRead & b) {
+		return a.blockIndex < b.blockIndex;
+	});
+	for(const BlockRead & read : reads) {
+		ARROW_RETURN_NOT_OK(read.status);
+		*bytesRead += read.bytesRead;
+		if(read.bytesRead < read.nbytes) {
+			// the file is shorter than its status said
+			break;
+		}
+	}
+	return arrow::Status::OK();
+}
+
+arrow::Status BlockCachedReadableFile::Read(int64_t nbytes, int64_t * bytesRead, void * buffer) {
+	int64_t position = 0;
+	this->Tell(&position);
+	ARROW_RETURN_NOT_OK(this->ReadAt(position, nbytes, bytesRead, buffer));
+	return this->Seek(position + *bytesRead);
+}
+
+arrow::Status BlockCachedReadableFile::Read(int64_t nbytes, std::shared_ptr<arrow::Buffer> * out) {
+	int64_t position = 0;
+	this->Tell(&position);
+	ARROW_RETURN_NOT_OK(this->ReadAt(position, nbytes, out));
+	return this->Seek(position + (*out)->size());
+}
+
+arrow::Status BlockCachedReadableFile::Seek(int64_t position) {
+	std::lock_guard<std::mutex> lock(this->mutex);
+	this->position = position;
+	return arrow::Status::OK();
+}
+
+arrow::Status BlockCachedReadableFile::Tell(int64_t * position) const {
+	std::lock_guard<std::mutex> lock(this->mutex);
+	*position = this->position;
+	return arrow::Status::OK();
+}
+
+arrow::Status BlockCachedReadableFile::GetSize(int64_t * size) {
+	*size = this->size;
+	return arrow::Status::OK();
+}
+
+arrow::Status BlockCachedReadableFile::Close() { return this->file->Close(); }
+
+bool BlockCachedReadableFile::closed() const { return this->file->closed(); }
+
+bool BlockCachedReadableFile::supports_zero_copy() const { return false; }
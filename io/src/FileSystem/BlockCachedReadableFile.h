@@ -0,0 +1,71 @@
+/*
+ * Copyright 2017 BlazingDB, Inc.
+ */
+
+#ifndef _BZ_BLOCK_CACHED_READABLE_FILE_H_
+#define _BZ_BLOCK_CACHED_READABLE_FILE_H_
+
+#include <memory>
+#include <mutex>
+#include <string>
+
+#include "arrow/buffer.h"
+#include "arrow/io/interfaces.h"
+#include "arrow/status.h"
+
+#include "FileSystem/BlockCache.h"
+
+/**
+ * Wraps a remote file to read it through a BlockCache. Reads are split in the blocks of the cache, every block is
+ * fetched from the wrapped file once per version of the file (identified by its ETag or modification time). The
+ * blocks of one read missing from the cache are fetched concurrently.
+ * FileSystemManager::openReadable wraps S3, GCS and HDFS files in it when BLAZING_BLOCK_CACHE_DIR is set.
+ */
+class BlockCachedReadableFile : public arrow::io::RandomAccessFile {
+public:
+	// fileSystem names the stats of the cache the reads count in, size and version are the ones of the file status
+	BlockCachedReadableFile(std::shared_ptr<arrow::io::RandomAccessFile> file,
+		std::shared_ptr<BlockCache> cache,
+		const std::string & fileSystem,
+		const std::string & uri,
+		int64_t size,
+		const std::string & version);
+
+	arrow::Status Close() override;
+	bool closed() const override;
+
+	arrow::Status GetSize(int64_t * size) override;
+
+	arrow::Status Read(int64_t nbytes, int64_t * bytesRead, void * buffer) override;
+	arrow::Status Read(int64_t nbytes, std::shared_ptr<arrow::Buffer> * out) override;
+
+	arrow::Status ReadAt(int64_t position, int64_t nbytes, int64_t * bytesRead, void * buffer) override;
+	arrow::Status ReadAt(int64_t position, int64_t nbytes, std::shared_ptr<arrow::Buffer> * out) override;
+
+	bool supports_zero_copy() const override;
+
+	arrow::Status Seek(int64_t position) override;
+	arrow::Status Tell(int64_t * position) const override;
+
+	std::shared_ptr<arrow::io::RandomAccessFile> getWrappedFile() const { return file; }
+
+private:
+	BlockKey getBlockKey(int64_t blockIndex) const;
+
+	// Copies [offset, offset + nbytes) of the block blockIndex to out
+	arrow::Status readBlock(int64_t blockIndex, int64_t offset, int64_t nbytes, int64_t * bytesRead, uint8_t * out);
+
+	std::shared_ptr<arrow::io::RandomAccessFile> file;
+	std::shared_ptr<BlockCache> cache;
+	const std::string fileSystem;
+	const std::string uri;
+	const int64_t size;
+	const std::string version;
+
+	mutable std::mutex mutex;  // guards position
+	int64_t position;
+
+	ARROW_DISALLOW_COPY_AND_ASSIGN(BlockCachedReadableFile);
+};
+
+#endif /* _BZ_BLOCK_CACHED_READABLE_FILE_H_ */
@@ -0,0 +1,309 @@
+/*
+ * Copyright 2017 BlazingDB, Inc.
+ */
+
+#include "CoalescingReadableFile.h"
+
+#include <algorithm>
+#include <cstring>
+#include <string>
+
+#include <arrow/memory_pool.h>
+
+#include "Util/EnvUtil.h"
+
+CoalescingOptions CoalescingOptions::forFileSystemType(FileSystemType fileSystemType) {
+	CoalescingOptions options;
+	if(fileSystemType == FileSystemType::LOCAL || fileSystemType == FileSystemType::NFS4) {
+		options.holeSizeLimit = 8 * 1024;
+	}
+	options.holeSizeLimit =
+		std::max<int64_t>(0, EnvUtil::getInt("BLAZING_READ_COALESCE_HOLE_SIZE", options.holeSizeLimit));
+	options.rangeSizeLimit =
+		std::max<int64_t>(1, EnvUtil::getInt("BLAZING_READ_COALESCE_RANGE_SIZE", options.rangeSizeLimit));
+	options.concurrency =
+		std::max<int64_t>(1, EnvUtil::getInt("BLAZING_READ_COALESCE_CONCURRENCY", options.concurrency));
+	options.bufferSizeLimit =
+		std::max<int64_t>(1, EnvUtil::getInt("BLAZING_READ_COALESCE_BUFFER_SIZE", options.bufferSizeLimit));
+	return options;
+}
+
+std::vector<ReadRange> coalesceReadRanges(
+	std::vector<ReadRange> ranges, int64_t holeSizeLimit, int64_t rangeSizeLimit) {
+	ranges.erase(
+		std::remove_if(ranges.begin(), ranges.end(), [](const ReadRange & range) { return range.length <= 0; }),
+		ranges.end());
+	std::sort(ranges.begin(), ranges.end(), [](const ReadRange & a, const ReadRange & b) {
+		return a.offset < b.offset;
+	});
+
+	std::vector<ReadRange> coalesced;
+	for(const ReadRange & range : ranges) {
+		if(!coalesced.empty()) {
+			ReadRange & last = coalesced.back();
+			const int64_t lastEnd = last.offset + last.length;
+			const int64_t end = std::max(lastEnd, range.offset + range.length);
+			// overlapping ranges are always merged, so no byte is fetched twice
+			if(range.offset < lastEnd ||
+				(range.offset - lastEnd <= holeSizeLimit && end - last.offset <= rangeSizeLimit)) {
+				last.length = end - last.offset;
+				continue;
+			}
+		}
+		coalesced.push_back(range);
+	}
+	return coalesced;
+}
+
+CoalescingReadableFile::CoalescingReadableFile(
+	std::shared_ptr<arrow::io::RandomAccessFile> file, const CoalescingOptions & options, int64_t size)
+	: file(file), options(options), size(size), activeFetchers(0), heldBytes(0), closing(false), position(0),
+	  fetchRequests(0), plannedBytes(0),
+	  fetchedBytes(0), hits(0), misses(0) {}
+
+CoalescingReadableFile::~CoalescingReadableFile() { this->joinFetchers(); }
+
+arrow::Status CoalescingReadableFile::WillNeed(const std::vector<ReadRange> & ranges) {
+	std::vector<ReadRange> coalesced =
+		coalesceReadRanges(ranges, this->options.holeSizeLimit, this->options.rangeSizeLimit);
+
+	std::lock_guard<std::mutex> lock(this->mutex);
+	std::vector<ReadRange> added;
+	for(const ReadRange & range : coalesced) {
+		// skip the bytes already planned by a previous call
+		int64_t start = range.offset;
+		const int64_t end = range.offset + range.length;
+		auto it = this->fetches.upper_bound(start);
+		if(it != this->fetches.begin()) {
+			--it;
+		}
+		for(; it != this->fetches.end() && it->first < end; ++it) {
+			const ReadRange & existing = it->second->range;
+			if(existing.offset + existing.length <= start) {
+				continue;
+			}
+			if(existing.offset > start) {
+				added.push_back(ReadRange{start, existing.offset - start});
+			}
+			start = std::max(start, existing.offset + existing.length);
+		}
+		if(start < end) {
+			added.push_back(ReadRange{start, end - start});
+		}
+	}
+	for(const ReadRange & range : added) {
+		auto fetch = std::make_shared<Fetch>();
+		fetch->range = range;
+		fetch->unreadBytes = 0;
+		this->fetches.emplace(range.offset, fetch);
+		this->pending.push_back(fetch);
+	}
+
+	for(const ReadRange & range : ranges) {
+		if(range.length <= 0) {
+			continue;
+		}
+		this->plannedBytes += range.length;
+		const int64_t end = range.offset + range.length;
+		auto it = this->fetches.upper_bound(range.offset);
+		if(it != this->fetches.begin()) {
+			--it;
+		}
+		for(; it != this->fetches.end() && it->first < end; ++it) {
+			const ReadRange & fetched = it->second->range;
+			const int64_t overlap =
+				std::min(end, fetched.offset + fetched.length) - std::max(range.offset, fetched.offset);
+			if(overlap > 0) {
+				it->second->unreadBytes += overlap;
+			}
+		}
+	}
+
+	const int fetchersNeeded =
+		std::min<int64_t>(this->options.concurrency - this->activeFetchers, this->pending.size());
+	for(int i = 0; i < fetchersNeeded; i++) {
+		this->activeFetchers++;
+		this->fetchers.emplace_back(&CoalescingReadableFile::fetchPending, this);
+	}
+	return arrow::Status::OK();
+}
+
+void CoalescingReadableFile::fetchPending() {
+	std::unique_lock<std::mutex> lock(this->mutex);
+	while(true) {
+		// the next range waits for the buffers read so far to be released
+		this->fetched.wait(lock, [this]() {
+			return this->closing || this->pending.empty() || this->fitsBufferSizeLimit(*this->pending.front());
+		});
+		if(this->closing || this->pending.empty()) {
+			break;
+		}
+		std::shared_ptr<Fetch> fetch = this->pending.front();
+		this->pending.pop_front();
+		this->fetch(lock, fetch);
+	}
+	this->activeFetchers--;
+}
+
+void CoalescingReadableFile::fetch(std::unique_lock<std::mutex> & lock, const std::shared_ptr<Fetch> & fetch) {
+	fetch->started = true;
+	this->heldBytes += fetch->range.length;
+	lock.unlock();
+
+	std::shared_ptr<arrow::Buffer> buffer;
+	arrow::Status status = this->file->ReadAt(fetch->range.offset, fetch->range.length, &buffer);
+	this->fetchRequests++;
+	if(status.ok()) {
+		this->fetchedBytes += buffer->size();
+	}
+
+	lock.lock();
+	if(!status.ok()) {
+		this->heldBytes -= fetch->range.length;
+	}
+	fetch->status = status;
+	fetch->buffer = buffer;
+	fetch->done = true;
+	this->fetched.notify_all();
+}
+
+bool CoalescingReadableFile::fitsBufferSizeLimit(const Fetch & fetch) const {
+	return this->heldBytes == 0 || this->heldBytes + fetch.range.length <= this->options.bufferSizeLimit;
+}
+
+std::shared_ptr<CoalescingReadableFile::Fetch> CoalescingReadableFile::findFetched(int64_t position, int64_t nbytes) {
+	std::unique_lock<std::mutex> lock(this->mutex);
+	auto it = this->fetches.upper_bound(position);
+	if(it == this->fetches.begin()) {
+		return nullptr;
+	}
+	--it;
+	std::shared_ptr<Fetch> fetch = it->second;
+	if(position + nbytes > fetch->range.offset + fetch->range.length) {
+		return nullptr;
+	}
+
+	if(!fetch->started && !fetch->done) {
+		// rather than wait behind the other ranges or for buffers to be released
+		this->pending.erase(std::find(this->pending.begin(), this->pending.end(), fetch));
+		this->fetch(lock, fetch);
+	}
+	this->fetched.wait(lock, [&fetch]() { return fetch->done; });
+	if(!fetch->status.ok()) {
+		// let the wrapped file read it again and report the error if it fails again
+		this->fetches.erase(fetch->range.offset);
+		return nullptr;
+	}
+	return fetch;
+}
+
+void CoalescingReadableFile::markRead(const std::shared_ptr<Fetch> & fetch, int64_t nbytes) {
+	std::lock_guard<std::mutex> lock(this->mutex);
+	fetch->unreadBytes -= nbytes;
+	if(fetch->unreadBytes <= 0) {
+		auto it = this->fetches.find(fetch->range.offset);
+		if(it != this->fetches.end() && it->second == fetch) {
+			this->fetches.erase(it);
+			this->heldBytes -= fetch->range.length;
+			this->fetched.notify_all();
+		}
+	}
+}
+
+void CoalescingReadableFile::joinFetchers() {
+	std::vector<BlazingThread> fetchers;
+	{
+		std::lock_guard<std::mutex> lock(this->mutex);
+		this->closing = true;
+		// the readers waiting for a discarded range read it from the wrapped file
+		for(auto & fetch : this->pending) {
+			fetch->status = arrow::Status::IOError("Fetch of planned range cancelled");
+			fetch->done = true;
+		}
+		this->pending.clear();
+		this->fetched.notify_all();
+		fetchers = std::move(this->fetchers);
+	}
+	for(auto & fetcher : fetchers) {
+		fetcher.join();
+	}
+}
+
+arrow::Status CoalescingReadableFile::ReadAt(int64_t position, int64_t nbytes, std::shared_ptr<arrow::Buffer> * out) {
+	std::shared_ptr<Fetch> fetch = this->findFetched(position, nbytes);
+	if(fetch == nullptr) {
+		this->misses++;
+		return this->file->ReadAt(position, nbytes, out);
+	}
+
+	// the fetch is shorter than planned when the file ends inside it
+	const int64_t offset = std::min(position - fetch->range.offset, fetch->buffer->size());
+	const int64_t available = std::min(nbytes, fetch->buffer->size() - offset);
+	*out = arrow::SliceBuffer(fetch->buffer, offset, available);
+	this->hits++;
+	this->markRead(fetch, available);
+	return arrow::Status::OK();
+}
+
+arrow::Status CoalescingReadableFile::ReadAt(int64_t position, int64_t nbytes, int64_t * bytesRead, void * buffer) {
+	std::shared_ptr<Fetch> fetch = this->findFetched(position, nbytes);
+	if(fetch == nullptr) {
+		this->misses++;
+		return this->file->ReadAt(position, nbytes, bytesRead, buffer);
+	}
+
+	const int64_t offset = std::min(position - fetch->range.offset, fetch->buffer->size());
+	*bytesRead = std::min(nbytes, fetch->buffer->size() - offset);
+	std::memcpy(buffer, fetch->buffer->data() + offset, *bytesRead);
+	this->hits++;
+	this->markRead(fetch, *bytesRead);
+	return arrow::Status::OK();
+}
+
+arrow::Status CoalescingReadableFile::Read(int64_t nbytes, int64_t * bytesRead, void * buffer) {
+	int64_t position = 0;
+	this->Tell(&position);
+	ARROW_RETURN_NOT_OK(this->ReadAt(position, nbytes, bytesRead, buffer));
+	return this->Seek(position + *bytesRead);
+}
+
+arrow::Status CoalescingReadableFile::Read(int64_t nbytes, std::shared_ptr<arrow::Buffer> * out) {
+	int64_t position = 0;
+	this->Tell(&position);
+	ARROW_RETURN_NOT_OK(this->ReadAt(position, nbytes, out));
+	return this->Seek(position + (*out)->size());
+}
+
+arrow::Status CoalescingReadableFile::Seek(int64_t position) {
+	std::lock_guard<std::mutex> lock(this->mutex);
+	this->position = position;
+	return arrow::Status::OK();
+}
+
+arrow::Status CoalescingReadableFile::Tell(int64_t * position) const {
+	std::lock_guard<std::mutex> lock(this->mutex);
+	*position = this->position;
+	return arrow::Status::OK();
+}
+
+arrow::Status CoalescingReadableFile::GetSize(int64_t * size) {
+	if(this->size < 0) {
+		return this->file->GetSize(size);
+	}
+	*size = this->size;
+	return arrow::Status::OK();
+}
+
+arrow::Status CoalescingReadableFile::Close() {
+	this->joinFetchers();
+	{
+		std::lock_guard<std::mutex> lock(this->mutex);
+		this->fetches.clear();
+		this->heldBytes = 0;
+	}
+	return this->file->Close();
+}
+
+bool CoalescingReadableFile::closed() const { return this->file->closed(); }
+
+bool CoalescingReadableFile::supports_zero_copy() const { return this->file->supports_zero_copy(); }
@@ -0,0 +1,132 @@
+/*
+ * Copyright 2017 BlazingDB, Inc.
+ */
+
+#ifndef _BZ_COALESCING_READABLE_FILE_H_
+#define _BZ_COALESCING_READABLE_FILE_H_
+
+#include <atomic>
+#include <condition_variable>
+#include <deque>
+#include <map>
+#include <memory>
+#include <mutex>
+#include <vector>
+
+#include "arrow/buffer.h"
+#include "arrow/io/interfaces.h"
+#include "arrow/status.h"
+
+#include "ExceptionHandling/BlazingThread.h"
+#include "FileSystem/FileSystemType.h"
+
+struct CoalescingOptions {
+	int64_t holeSizeLimit = 1024 * 1024;		// planned ranges closer than this are fetched with one request
+	int64_t rangeSizeLimit = 32 * 1024 * 1024;  // ranges are not merged past this size
+	int concurrency = 8;						// merged ranges fetched at the same time
+	int64_t bufferSizeLimit = 256 * 1024 * 1024;  // bytes being fetched or held, a bigger range is fetched alone
+
+	// Defaults for the latency of each file system: small holes are worth reading on local disks, on object stores
+	// reading 1 MiB costs about as much as one more round trip. The env vars BLAZING_READ_COALESCE_HOLE_SIZE,
+	// BLAZING_READ_COALESCE_RANGE_SIZE, BLAZING_READ_COALESCE_CONCURRENCY and BLAZING_READ_COALESCE_BUFFER_SIZE
+	// override them
+	static CoalescingOptions forFileSystemType(FileSystemType fileSystemType);
+};
+
+struct ReadRange {
+	int64_t offset;
+	int64_t length;
+};
+
+// Sorts ranges, drops the empty ones and merges the ones that overlap or are separated by at most holeSizeLimit
+// bytes, as long as the merged range stays under rangeSizeLimit
+std::vector<ReadRange> coalesceReadRanges(
+	std::vector<ReadRange> ranges, int64_t holeSizeLimit, int64_t rangeSizeLimit);
+
+/**
+ * Wraps a file to serve a batch of small reads known in advance (e.g. the column chunks of a parquet file) with a
+ * few large ones. FileSystemManager::openReadable returns files wrapped in it.
+ *
+ * WillNeed plans ranges: they are coalesced and fetched in the background, concurrently. A ReadAt fully inside a
+ * planned range waits for its fetch and is served as a slice of the fetched buffer, without a request. Any other read
+ * goes to the wrapped file. Buffers are released once all the planned bytes in them were read.
+ *
+ * The ranges being fetched and the buffers not released yet add up to at most bufferSizeLimit bytes, the next ranges
+ * are fetched as buffers are released. A read of a range nobody fetches yet fetches it right away.
+ */
+class CoalescingReadableFile : public arrow::io::RandomAccessFile {
+public:
+	// size is the one of the file status when known, to answer GetSize without asking the wrapped file
+	CoalescingReadableFile(
+		std::shared_ptr<arrow::io::RandomAccessFile> file, const CoalescingOptions & options, int64_t size = -1);
+	~CoalescingReadableFile();
+
+	arrow::Status WillNeed(const std::vector<ReadRange> & ranges);
+
+	arrow::Status Close() override;
+	bool closed() const override;
+
+	arrow::Status GetSize(int64_t * size) override;
+
+	arrow::Status Read(int64_t nbytes, int64_t * bytesRead, void * buffer) override;
+	arrow::Status Read(int64_t nbytes, std::shared_ptr<arrow::Buffer> * out) override;
+
+	arrow::Status ReadAt(int64_t position, int64_t nbytes, int64_t * bytesRead, void * buffer) override;
+	arrow::Status ReadAt(int64_t position, int64_t nbytes, std::shared_ptr<arrow::Buffer> * out) override;
+
+	bool supports_zero_copy() const override;
+
+	arrow::Status Seek(int64_t position) override;
+	arrow::Status Tell(int64_t * position) const override;
+
+	std::shared_ptr<arrow::io::RandomAccessFile> getWrappedFile() const { return file; }
+
+	int64_t getFetchRequests() const { return fetchRequests; }  // coalesced requests sent for planned ranges
+	int64_t getPlannedBytes() const { return plannedBytes; }
+	int64_t getFetchedBytes() const { return fetchedBytes; }  // minus the planned bytes, the holes read
+	int64_t getHits() const { return hits; }				  // reads served from fetched buffers
+	int64_t getMisses() const { return misses; }			  // reads sent to the wrapped file
+
+private:
+	struct Fetch {
+		ReadRange range;
+		int64_t unreadBytes;  // planned bytes not read yet
+		bool started = false;
+		bool done = false;
+		arrow::Status status;
+		std::shared_ptr<arrow::Buffer> buffer;
+	};
+
+	void fetchPending();
+	// Fetches a pending range with the lock released
+	void fetch(std::unique_lock<std::mutex> & lock, const std::shared_ptr<Fetch> & fetch);
+	bool fitsBufferSizeLimit(const Fetch & fetch) const;
+	// Returns the fetch holding [position, position + nbytes), waiting for it, or nullptr
+	std::shared_ptr<Fetch> findFetched(int64_t position, int64_t nbytes);
+	void markRead(const std::shared_ptr<Fetch> & fetch, int64_t nbytes);
+	void joinFetchers();
+
+	std::shared_ptr<arrow::io::RandomAccessFile> file;
+	const CoalescingOptions options;
+	const int64_t size;  // -1 when unknown
+
+	mutable std::mutex mutex;  // guards everything below
+	std::condition_variable fetched;
+	std::map<int64_t, std::shared_ptr<Fetch>> fetches;  // by offset, never overlapping
+	std::deque<std::shared_ptr<Fetch>> pending;		  // planned and not started yet
+	std::vector<BlazingThread> fetchers;
+	int activeFetchers;
+	int64_t heldBytes;  // of the ranges started and not released yet
+	bool closing;
+	int64_t position;
+
+	std::atomic<int64_t> fetchRequests;
+	std::atomic<int64_t> plannedBytes;
+	std::atomic<int64_t> fetchedBytes;
+	std::atomic<int64_t> hits;
+	std::atomic<int64_t> misses;
+
+	ARROW_DISALLOW_COPY_AND_ASSIGN(CoalescingReadableFile);
+};
+
+#endif /* _BZ_COALESCING_READABLE_FILE_H_ */
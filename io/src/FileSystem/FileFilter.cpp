@@ -5,8 +5,6 @@
 
 #include "FileFilter.h"
 
-#include <fnmatch.h>
-
 // BEGIN FilesFilter
 
 bool FilesFilter::operator()(const FileStatus & fileStatus) const { return fileStatus.isFile(); }
@@ -22,15 +20,13 @@ bool DirsFilter::operator()(const FileStatus & fileStatus) const { return fileSt
 // BEGIN WildcardFilter
 
 bool WildcardFilter::match(const std::string & input, const std::string & wildcard) {
-	const int flags = FNM_EXTMATCH;
-	const int match = fnmatch(wildcard.c_str(), input.c_str(), flags);
-	return (match == 0);
+	return GlobPattern(wildcard).matches(input);
 }
 
-WildcardFilter::WildcardFilter(const std::string & wildcard) : wildcard(wildcard) {}
+WildcardFilter::WildcardFilter(const std::string & wildcard) : wildcard(wildcard), glob(wildcard) {}
 
 bool WildcardFilter::operator()(const FileStatus & fileStatus) const {
-	return WildcardFilter::match(fileStatus.getUri().getPath().toString(), this->wildcard);
+	return this->glob.matches(fileStatus.getUri().getPath().toString());
 }
 
 // END WildcardFilter
@@ -38,7 +34,7 @@ bool WildcardFilter::operator()(const FileStatus & fileStatus) const {
 // BEGIN FileTypeWildcardFilter
 
 FileTypeWildcardFilter::FileTypeWildcardFilter(FileType fileType, const std::string & wildcard)
-	: fileType(fileType), wildcard(wildcard) {}
+	: fileType(fileType), wildcard(wildcard), wildcardFilter(wildcard) {}
 
 bool FileTypeWildcardFilter::operator()(const FileStatus & fileStatus) const {
 	FileFilter fileFilter;
@@ -53,10 +49,8 @@ bool FileTypeWildcardFilter::operator()(const FileStatus & fileStatus) const {
 	} break;
 	}
 
-	WildcardFilter wildcardFilter(wildcard);
-
 	const bool matchFileFilter = fileFilter(fileStatus);
-	const bool matchWildcardFilter = wildcardFilter(fileStatus);
+	const bool matchWildcardFilter = this->wildcardFilter(fileStatus);
 	const bool match = (matchFileFilter && matchWildcardFilter);
 
 	return match;
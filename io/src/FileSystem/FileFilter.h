@@ -9,6 +9,7 @@
 #include <functional>
 
 #include "FileSystem/FileStatus.h"
+#include "Util/GlobPattern.h"
 
 using FileFilter = std::function<bool(const FileStatus & fileStatus)>;
 
@@ -23,6 +24,7 @@ struct DirsFilter : FileFilterFunctor {
 };
 
 struct WildcardFilter : FileFilterFunctor {
+	// Compiles the wildcard on every call, listings should compile it once with GlobPattern
 	static bool match(const std::string & input, const std::string & wildcard);
 
 	WildcardFilter(const std::string & wildcard);
@@ -30,6 +32,7 @@ struct WildcardFilter : FileFilterFunctor {
 	bool operator()(const FileStatus & fileStatus) const;
 
 	std::string wildcard;
+	GlobPattern glob;
 };
 
 struct FileTypeWildcardFilter : FileFilterFunctor {
@@ -39,6 +42,7 @@ struct FileTypeWildcardFilter : FileFilterFunctor {
 
 	FileType fileType;
 	std::string wildcard;
+	WildcardFilter wildcardFilter;
 };
 
 struct FileOrFolderFilter : FileFilterFunctor {
@@ -15,6 +15,11 @@ class FileStatus {
 public:
 	FileStatus();
 	FileStatus(const Uri & uri, FileType fileType, unsigned long long fileSize);
+	FileStatus(const Uri & uri,
+		FileType fileType,
+		unsigned long long fileSize,
+		unsigned long long modificationTime,
+		const std::string & etag);
 	FileStatus(const FileStatus & other);
 	FileStatus(FileStatus && other);
 	~FileStatus();
@@ -23,6 +28,12 @@ public:
 	FileType getFileType() const noexcept;
 	unsigned long long getFileSize() const noexcept;
 
+	// Nanoseconds since the epoch, 0 when the file system does not report it
+	unsigned long long getModificationTime() const noexcept;
+
+	// Entity tag of the object store (S3 ETag, GCS etag), empty for the other file systems
+	std::string getETag() const noexcept;
+
 	// Helpers
 	bool isFile() const noexcept;
 	bool isDirectory() const noexcept;
@@ -41,7 +52,6 @@ public:
 
 	 unsigned long long getBlockSize() const noexcept;
 
-	 unsigned long long getModificationTime() const noexcept;
 	 unsigned long long getAccessTime() const noexcept;
 
 	 std::string getOwner() const noexcept;
@@ -52,6 +62,8 @@ private:
 	Uri uri;
 	FileType fileType;
 	unsigned long long fileSize;
+	unsigned long long modificationTime;
+	std::string etag;
 };
 
 #endif /* _BLAZING_FILE_STATUS_H_ */
@@ -217,6 +217,105 @@ bool verifyConnectionProperties(const std::string & projectId,
 
 }  // END namespace GoogleCloudStorageConnection
 
+namespace LocalFileSystemConnection {
+
+const std::string readModeName(ReadMode readMode) {
+	switch(readMode) {
+	case ReadMode::PREAD: return "pread"; break;
+	case ReadMode::MMAP: return "mmap"; break;
+	case ReadMode::IO_URING: return "io_uring"; break;
+	}
+
+	return "UNDEFINED";
+}
+
+ReadMode readModeFromName(const std::string & readModeName) {
+	if(readModeName == "pread") {
+		return ReadMode::PREAD;
+	}
+
+	if(readModeName == "mmap") {
+		return ReadMode::MMAP;
+	}
+
+	if(readModeName == "io_uring") {
+		return ReadMode::IO_URING;
+	}
+
+	return ReadMode::UNDEFINED;
+}
+
+const std::string mmapAdviceName(MmapAdvice mmapAdvice) {
+	switch(mmapAdvice) {
+	case MmapAdvice::NORMAL: return "normal"; break;
+	case MmapAdvice::SEQUENTIAL: return "sequential"; break;
+	case MmapAdvice::RANDOM: return "random"; break;
+	case MmapAdvice::WILLNEED: return "willneed"; break;
+	}
+
+	return "UNDEFINED";
+}
+
+MmapAdvice mmapAdviceFromName(const std::string & mmapAdviceName) {
+	if(mmapAdviceName == "normal") {
+		return MmapAdvice::NORMAL;
+	}
+
+	if(mmapAdviceName == "sequential") {
+		return MmapAdvice::SEQUENTIAL;
+	}
+
+	if(mmapAdviceName == "random") {
+		return MmapAdvice::RANDOM;
+	}
+
+	if(mmapAdviceName == "willneed") {
+		return MmapAdvice::WILLNEED;
+	}
+
+	return MmapAdvice::UNDEFINED;
+}
+
+const std::string connectionPropertyName(ConnectionProperty connectionProperty) {
+	switch(connectionProperty) {
+	case ConnectionProperty::READ_MODE: return "local.read_mode"; break;
+	case ConnectionProperty::MMAP_ADVICE: return "local.mmap_advice"; break;
+	case ConnectionProperty::IO_URING_QUEUE_DEPTH: return "local.io_uring_queue_depth"; break;
+	case ConnectionProperty::DIRECT_IO: return "local.direct_io"; break;
+	}
+
+	return "UNDEFINED";
+}
+
+const std::string connectionPropertyEnvName(ConnectionProperty connectionProperty) {
+	std::string property = "BLAZING_";
+	property += connectionPropertyName(connectionProperty);
+	property = StringUtil::replace(property, ".", "_");
+	property = StringUtil::toUpper(property);
+
+	return property;
+}
+
+// returns false if some argument is invalid, true otherwise
+bool verifyConnectionProperties(ReadMode readMode, MmapAdvice mmapAdvice, int ioUringQueueDepth) {
+	if(readMode == ReadMode::UNDEFINED) {
+		return false;
+	}
+
+	if(mmapAdvice == MmapAdvice::UNDEFINED) {
+		return false;
+	}
+
+	// io_uring_setup accepts up to 4096 entries
+	if(ioUringQueueDepth <= 0 || ioUringQueueDepth > 4096) {
+		return false;
+	}
+
+	return true;
+}
+
+}  // END namespace LocalFileSystemConnection
+
 // BEGIN FileSystemConnection
 
 FileSystemConnection::FileSystemConnection() : fileSystemType(FileSystemType::UNDEFINED) {}
@@ -233,6 +332,30 @@ FileSystemConnection::FileSystemConnection(FileSystemType fileSystemType) {
 	this->fileSystemType = fileSystemType;
 }
 
+FileSystemConnection::FileSystemConnection(LocalFileSystemConnection::ReadMode readMode,
+	LocalFileSystemConnection::MmapAdvice mmapAdvice,
+	int ioUringQueueDepth,
+	bool directIo) {
+	using namespace LocalFileSystemConnection;
+
+	const bool valid = verifyConnectionProperties(readMode, mmapAdvice, ioUringQueueDepth);
+
+	if(valid == false) {
+		this->invalidate();
+		return;
+	}
+
+	// NOTE never change this insertion order
+	const std::map<std::string, std::string> connectionProperties = {
+		{connectionPropertyName(ConnectionProperty::READ_MODE), readModeName(readMode)},
+		{connectionPropertyName(ConnectionProperty::MMAP_ADVICE), mmapAdviceName(mmapAdvice)},
+		{connectionPropertyName(ConnectionProperty::IO_URING_QUEUE_DEPTH), std::to_string(ioUringQueueDepth)},
+		{connectionPropertyName(ConnectionProperty::DIRECT_IO), directIo ? "true" : "false"}};
+
+	this->fileSystemType = FileSystemType::LOCAL;
+	this->connectionProperties = std::move(connectionProperties);
+}
+
 FileSystemConnection::FileSystemConnection(const std::string & host,
 	int port,
 	const std::string & user,
@@ -342,7 +465,8 @@ FileSystemConnection::FileSystemConnection(const std::string & fileSystemConnect
 			return;
 		}
 
-		if(requireConnectionProperties()) {
+		// the properties of a local file system are optional
+		if(requireConnectionProperties() || (fileSystemTypeSplit[1].empty() == false)) {
 			const std::vector<std::string> connectionPropertiesSplit = StringUtil::split(fileSystemTypeSplit[1], ",");
 
 			for(const std::string & property : connectionPropertiesSplit) {
@@ -440,6 +564,28 @@ const std::string FileSystemConnection::getConnectionProperty(
 	return this->connectionProperties.at(propertyName);
 }
 
+const std::string FileSystemConnection::getConnectionProperty(
+	LocalFileSystemConnection::ConnectionProperty connectionProperty) const noexcept {
+	using namespace LocalFileSystemConnection;
+
+	if(this->isValid() == false) {
+		return std::string();
+	}
+
+	if(this->fileSystemType != FileSystemType::LOCAL) {
+		return std::string();
+	}
+
+	// a local connection can have no properties at all
+	const auto property = this->connectionProperties.find(connectionPropertyName(connectionProperty));
+
+	if(property == this->connectionProperties.end()) {
+		return std::string();
+	}
+
+	return property->second;
+}
+
 std::string FileSystemConnection::toString() const {
 	if(this->fileSystemType == FileSystemType::UNDEFINED) {
 		return std::string();
@@ -65,6 +65,32 @@ const std::string connectionPropertyName(ConnectionProperty connectionProperty);
 const std::string connectionPropertyEnvName(ConnectionProperty connectionProperty);  // format: BLAZING_GCS_PROPERTY
 }  // namespace GoogleCloudStorageConnection
 
+namespace LocalFileSystemConnection {
+enum class ReadMode : char {
+	UNDEFINED,
+	PREAD,	   // synchronous pread on an arrow::io::ReadableFile
+	MMAP,	   // arrow::io::MemoryMappedFile, for hot datasets that fit in the page cache
+	IO_URING  // reads split and submitted in batches to an io_uring
+};
+
+enum class MmapAdvice : char { UNDEFINED, NORMAL, SEQUENTIAL, RANDOM, WILLNEED };
+
+enum class ConnectionProperty : char {
+	UNDEFINED,
+	READ_MODE,			   // values can be "pread", "mmap" or "io_uring"
+	MMAP_ADVICE,		   // madvise hint of mapped files: "normal", "sequential", "random" or "willneed"
+	IO_URING_QUEUE_DEPTH,  // numeric value, reads in flight per thread
+	DIRECT_IO			   // "true" to open the files read with io_uring with O_DIRECT
+};
+
+const std::string readModeName(ReadMode readMode);
+ReadMode readModeFromName(const std::string & readModeName);
+const std::string mmapAdviceName(MmapAdvice mmapAdvice);
+MmapAdvice mmapAdviceFromName(const std::string & mmapAdviceName);
+const std::string connectionPropertyName(ConnectionProperty connectionProperty);	 // format: local.property
+const std::string connectionPropertyEnvName(ConnectionProperty connectionProperty);  // format: BLAZING_LOCAL_PROPERTY
+}  // namespace LocalFileSystemConnection
+
 // NOTE Immutable class
 class FileSystemConnection {
 public:
@@ -82,6 +108,19 @@ public:
 	 */
 	FileSystemConnection(FileSystemType fileSystemType);
 
+	/**
+	 * @brief Constructs a local file system connection that reads its files with the given mode
+	 *
+	 * Local file systems registered without a read mode use the BLAZING_LOCAL_* env vars, or pread.
+	 *
+	 * @note
+	 * If some argument is invalid then will construct an invalid FileSystemConnection
+	 */
+	FileSystemConnection(LocalFileSystemConnection::ReadMode readMode,
+		LocalFileSystemConnection::MmapAdvice mmapAdvice = LocalFileSystemConnection::MmapAdvice::WILLNEED,
+		int ioUringQueueDepth = 32,
+		bool directIo = false);
+
 	/**
 	 * @brief Constructs a Hadoop File System connection
 	 *
@@ -163,6 +202,10 @@ public:
 	const std::string getConnectionProperty(GoogleCloudStorageConnection::ConnectionProperty connectionProperty) const
 		noexcept;
 
+	// is property is not present or the instance is invalid and not LOCAL then return empty string
+	const std::string getConnectionProperty(LocalFileSystemConnection::ConnectionProperty connectionProperty) const
+		noexcept;
+
 	std::string toString() const;  // json format
 
 	FileSystemConnection & operator=(const FileSystemConnection & other);
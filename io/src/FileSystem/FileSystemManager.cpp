@@ -7,10 +7,44 @@
 
 #include "private/FileSystemManager_p.h"
 
+#include <algorithm>
+#include <atomic>
+#include <cctype>
 #include <iostream>
 
 #include "Library/Logging/Logger.h"
+#include "Library/Metrics/MetricsRegistry.h"
 namespace Logging = Library::Logging;
+namespace Metrics = Library::Metrics;
+
+namespace {
+
+enum FileSystemOperation { EXISTS, GET_FILE_STATUS, LIST, OPEN_READABLE, OPEN_WRITEABLE, NUM_OPERATIONS };
+
+const int NUM_FILE_SYSTEM_TYPES = static_cast<int>(FileSystemType::GOOGLE_CLOUD_STORAGE) + 1;
+
+// Latency of the calls that reach the file systems, by operation and file system type. Each histogram is looked up in
+// the registry the first time it is used, so timing a call then costs two clock reads
+Metrics::Histogram & operationLatency(FileSystemOperation operation, const Uri & uri) {
+	static std::atomic<Metrics::Histogram *> histograms[NUM_OPERATIONS][NUM_FILE_SYSTEM_TYPES];
+	const int type = std::min<int>(static_cast<int>(uri.getFileSystemType()), NUM_FILE_SYSTEM_TYPES - 1);
+	Metrics::Histogram * histogram = histograms[operation][type].load(std::memory_order_acquire);
+	if(histogram == nullptr) {
+		static const char * operations[NUM_OPERATIONS] = {
+			"exists", "get_file_status", "list", "open_readable", "open_writeable"};
+		std::string fileSystem = fileSystemTypeName(static_cast<FileSystemType>(type));
+		std::transform(fileSystem.begin(), fileSystem.end(), fileSystem.begin(), ::tolower);
+		// the registry returns the same histogram to the threads racing here
+		histogram = &Metrics::MetricsRegistry::getInstance().histogram("blazing_filesystem_operation_duration_seconds",
+			"Latency of the file system calls (exists, status, list, open)",
+			{{"filesystem", fileSystem}, {"operation", operations[operation]}},
+			1e-6);
+		histograms[operation][type].store(histogram, std::memory_order_release);
+	}
+	return *histogram;
+}
+
+}  // namespace
 
 FileSystemManager::FileSystemManager() : pimpl(new FileSystemManager::Private()) {
 	// NOTE setup default local connection
@@ -51,29 +85,45 @@ bool FileSystemManager::deregisterFileSystem(const std::string & authority) {
 	return this->pimpl->deregisterFileSystem(authority);
 }
 
-bool FileSystemManager::exists(const Uri & uri) const { return this->pimpl->exists(uri); }
+bool FileSystemManager::exists(const Uri & uri) const {
+	Metrics::ScopedTimer timer(operationLatency(EXISTS, uri));
+	return this->pimpl->exists(uri);
+}
+
+FileStatus FileSystemManager::getFileStatus(const Uri & uri) const {
+	Metrics::ScopedTimer timer(operationLatency(GET_FILE_STATUS, uri));
+	return this->pimpl->getFileStatus(uri);
+}
 
-FileStatus FileSystemManager::getFileStatus(const Uri & uri) const { return this->pimpl->getFileStatus(uri); }
+FileStatus FileSystemManager::refreshFileStatus(const Uri & uri) const {
+	Metrics::ScopedTimer timer(operationLatency(GET_FILE_STATUS, uri));
+	return this->pimpl->refreshFileStatus(uri);
+}
 
 std::vector<FileStatus> FileSystemManager::list(const Uri & uri, const FileFilter & filter) const {
+	Metrics::ScopedTimer timer(operationLatency(LIST, uri));
 	return this->pimpl->list(uri, filter);
 }
 
 std::vector<FileStatus> FileSystemManager::list(
 	const Uri & uri, FileType fileType, const std::string & wildcard) const {
+	Metrics::ScopedTimer timer(operationLatency(LIST, uri));
 	return this->pimpl->list(uri, fileType, wildcard);
 }
 
 std::vector<Uri> FileSystemManager::list(const Uri & uri, const std::string & wildcard) const {
+	Metrics::ScopedTimer timer(operationLatency(LIST, uri));
 	return this->pimpl->list(uri, wildcard);
 }
 
 std::vector<std::string> FileSystemManager::listResourceNames(
 	const Uri & uri, FileType fileType, const std::string & wildcard) const {
+	Metrics::ScopedTimer timer(operationLatency(LIST, uri));
 	return this->pimpl->listResourceNames(uri, fileType, wildcard);
 }
 
 std::vector<std::string> FileSystemManager::listResourceNames(const Uri & uri, const std::string & wildcard) const {
+	Metrics::ScopedTimer timer(operationLatency(LIST, uri));
 	return this->pimpl->listResourceNames(uri, wildcard);
 }
 
@@ -88,9 +138,17 @@ bool FileSystemManager::truncateFile(const Uri & uri, const long long length) co
 }
 
 std::shared_ptr<arrow::io::RandomAccessFile> FileSystemManager::openReadable(const Uri & uri) const {
+	Metrics::ScopedTimer timer(operationLatency(OPEN_READABLE, uri));
 	return this->pimpl->openReadable(uri);
 }
 
 std::shared_ptr<arrow::io::OutputStream> FileSystemManager::openWriteable(const Uri & uri) const {
+	Metrics::ScopedTimer timer(operationLatency(OPEN_WRITEABLE, uri));
 	return this->pimpl->openWriteable(uri);
 }
+
+void FileSystemManager::invalidate(const Uri & uri) const { this->pimpl->invalidate(uri); }
+
+void FileSystemManager::invalidateAll() const { this->pimpl->invalidateAll(); }
+
+std::shared_ptr<BlockCache> FileSystemManager::getBlockCache() const { return this->pimpl->getBlockCache(); }
@@ -10,6 +10,7 @@
 
 #include "arrow/io/interfaces.h"
 
+#include "FileSystem/BlockCache.h"
 #include "FileSystem/FileFilter.h"
 #include "FileSystem/FileSystemEntity.h"
 
@@ -26,6 +27,8 @@ public:
 	// Query
 	bool exists(const Uri & uri) const;
 	FileStatus getFileStatus(const Uri & uri) const;
+	// Asks the file system for the status even when it is cached, e.g. to tell a rewritten file apart
+	FileStatus refreshFileStatus(const Uri & uri) const;
 
 	// List
 	std::vector<FileStatus> list(const Uri & uri, const FileFilter & filter) const;
@@ -45,6 +48,15 @@ public:
 	std::shared_ptr<arrow::io::RandomAccessFile> openReadable(const Uri & uri) const;
 	std::shared_ptr<arrow::io::OutputStream> openWriteable(const Uri & uri) const;
 
+	// Caches
+	// Statuses and listings of remote file systems (S3, GCS, HDFS) are trusted for BLAZING_METADATA_CACHE_TTL_MS (0
+	// disables them), local ones are never cached. The operations above invalidate what they change, changes made by
+	// other processes can be made visible sooner with invalidate
+	void invalidate(const Uri & uri) const;  // the file or directory, what is under it and the listings above it
+	void invalidateAll() const;
+	// The disk cache of remote files (see BLAZING_BLOCK_CACHE_DIR), nullptr when disabled
+	std::shared_ptr<BlockCache> getBlockCache() const;
+
 private:
 	class Private;
 	const std::unique_ptr<Private> pimpl;  // private implementation
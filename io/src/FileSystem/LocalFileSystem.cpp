@@ -7,13 +7,16 @@
 
 #include "private/LocalFileSystem_p.h"
 
-LocalFileSystem::LocalFileSystem(const Path & root) : pimpl(new LocalFileSystem::Private(root)) {}
+LocalFileSystem::LocalFileSystem(const Path & root)
+	: pimpl(new LocalFileSystem::Private(FileSystemConnection(FileSystemType::LOCAL), root)) {}
+
+LocalFileSystem::LocalFileSystem(const FileSystemConnection & fileSystemConnection, const Path & root)
+	: pimpl(new LocalFileSystem::Private(fileSystemConnection, root)) {}
 
 LocalFileSystem::~LocalFileSystem() {}
 
 FileSystemConnection LocalFileSystem::getFileSystemConnection() const noexcept {
-	// alwayes returns a fiexed connection string
-	return FileSystemConnection(FileSystemType::LOCAL);
+	return this->pimpl->fileSystemConnection;
 }
 
 Path LocalFileSystem::getRoot() const noexcept { return this->pimpl->root; }
@@ -34,8 +37,8 @@ std::vector<FileStatus> LocalFileSystem::list(const Uri & uri, const FileFilter
 }
 
 std::vector<FileStatus> LocalFileSystem::list(const Uri & uri, FileType fileType, const std::string & wildcard) const {
-	FileTypeWildcardFilter filter(fileType, wildcard);
-	return this->list(uri, filter);
+	const std::vector<FileStatus> result = this->pimpl->list(uri, fileType, wildcard);
+	return result;
 }
 
 std::vector<Uri> LocalFileSystem::list(const Uri & uri, const std::string & wildcard) const {
@@ -13,6 +13,8 @@
 class LocalFileSystem : public FileSystemInterface {
 public:
 	LocalFileSystem(const Path & root = Path("/"));
+	// The connection only chooses how files are read, see LocalFileSystemConnection
+	LocalFileSystem(const FileSystemConnection & fileSystemConnection, const Path & root = Path("/"));
 	virtual ~LocalFileSystem();
 
 	FileSystemType getFileSystemType() const noexcept { return FileSystemType::LOCAL; }
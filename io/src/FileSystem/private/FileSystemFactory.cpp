@@ -18,7 +18,7 @@ std::unique_ptr<FileSystemInterface> FileSystemFactory::createFileSystem(
 
 	switch(fileSystemType) {
 	case FileSystemType::LOCAL: {
-		fileSystem = std::unique_ptr<LocalFileSystem>(new LocalFileSystem(root));
+		fileSystem = std::unique_ptr<LocalFileSystem>(new LocalFileSystem(fileSystemConnection, root));
 	} break;
 
 	case FileSystemType::HDFS: {
@@ -8,13 +8,32 @@
 #include <iostream>
 
 #include "ExceptionHandling/BlazingException.h"
+#include "FileSystem/BlockCachedReadableFile.h"
+#include "FileSystem/CoalescingReadableFile.h"
 #include "FileSystemFactory.h"
 #include "Library/Logging/Logger.h"
 #include "Util/FileUtil.h"
+#include "Util/StringUtil.h"
 
 namespace Logging = Library::Logging;
 
-FileSystemManager::Private::Private() {}
+namespace {
+
+std::string listingKey(const Uri & uri, const std::string & kind, const std::string & wildcard) {
+	return StringUtil::makeCacheKey({uri.toString(true), kind, wildcard});
+}
+
+bool isRemoteFileSystem(FileSystemType fileSystemType) {
+	return fileSystemType == FileSystemType::S3 || fileSystemType == FileSystemType::GOOGLE_CLOUD_STORAGE ||
+		   fileSystemType == FileSystemType::HDFS;
+}
+
+}  // namespace
+
+FileSystemManager::Private::Private()
+	: fileStatuses(MetadataCacheOptions::fromEnvironment()), statusListings(MetadataCacheOptions::fromEnvironment()),
+	  uriListings(MetadataCacheOptions::fromEnvironment()), nameListings(MetadataCacheOptions::fromEnvironment()),
+	  blockCache(BlockCache::open(BlockCacheOptions::fromEnvironment())) {}
 
 FileSystemManager::Private::~Private() {}
 
@@ -86,6 +105,7 @@ bool FileSystemManager::Private::deregisterFileSystem(const std::string & author
 
 	const int fileSystemId = this->fileSystemIds[authority];
 
+	this->invalidateAll();
 	this->roots.erase(authority);
 	this->fileSystemIds.erase(authority);
 
@@ -115,6 +135,10 @@ bool FileSystemManager::Private::exists(const Uri & uri) const {
 	try {
 		const int fileSystemId = this->verifyFileSystemUri(uri);
 
+		FileStatus status;
+		if(this->cachesMetadata(fileSystemId) && this->fileStatuses.get(uri.toString(true), &status)) {
+			return true;
+		}
 		const auto ret = this->fileSystems.at(fileSystemId)->exists(uri);
 
 		return ret;
@@ -135,12 +159,31 @@ FileStatus FileSystemManager::Private::getFileStatus(const Uri & uri) const {
 
 		// TODO check fileSystemId ... manage error cases
 
+		FileStatus status;
+		if(this->cachesMetadata(fileSystemId) && this->fileStatuses.get(uri.toString(true), &status)) {
+			return status;
+		}
+		return this->refreshFileStatus(uri);
+	} catch(const std::exception & e) {
+		std::string uriStr = uri.toString();
+		Logging::Logger().logError("Caught error in getFileStatus with Uri: " + uriStr);
+		throw;
+	}
+}
+
+FileStatus FileSystemManager::Private::refreshFileStatus(const Uri & uri) const {
+	try {
+		const int fileSystemId = this->verifyFileSystemUri(uri);
+
 		const auto ret = this->fileSystems.at(fileSystemId)->getFileStatus(uri);
+		if(this->cachesMetadata(fileSystemId)) {
+			this->fileStatuses.put(uri.toString(true), ret);
+		}
 
 		return ret;
 	} catch(const std::exception & e) {
 		std::string uriStr = uri.toString();
-		Logging::Logger().logError("Caught error in getFileStatus with Uri: " + uriStr);
+		Logging::Logger().logError("Caught error in refreshFileStatus with Uri: " + uriStr);
 		throw;
 	}
 }
@@ -175,7 +218,20 @@ std::vector<FileStatus> FileSystemManager::Private::list(
 
 		// TODO check fileSystemId ... manage error cases
 
+		const bool cached = this->cachesMetadata(fileSystemId);
+		const std::string key = listingKey(uri, "statuses " + std::to_string(int(fileType)), wildcard);
+		std::vector<FileStatus> statuses;
+		if(cached && this->statusListings.get(key, &statuses)) {
+			return statuses;
+		}
 		const auto ret = this->fileSystems.at(fileSystemId)->list(uri, fileType, wildcard);
+		if(cached) {
+			this->statusListings.put(key, ret);
+			// planning usually asks for the status of every listed file next
+			for(const FileStatus & status : ret) {
+				this->fileStatuses.put(status.getUri().toString(true), status);
+			}
+		}
 
 		return ret;
 	} catch(const std::exception & e) {
@@ -194,7 +250,16 @@ std::vector<Uri> FileSystemManager::Private::list(const Uri & uri, const std::st
 
 		// TODO check fileSystemId ... manage error cases
 
+		const bool cached = this->cachesMetadata(fileSystemId);
+		const std::string key = listingKey(uri, "uris", wildcard);
+		std::vector<Uri> uris;
+		if(cached && this->uriListings.get(key, &uris)) {
+			return uris;
+		}
 		const auto ret = this->fileSystems.at(fileSystemId)->list(uri, wildcard);
+		if(cached) {
+			this->uriListings.put(key, ret);
+		}
 
 		return ret;
 	} catch(const std::exception & e) {
@@ -214,7 +279,16 @@ std::vector<std::string> FileSystemManager::Private::listResourceNames(
 
 		// TODO check fileSystemId ... manage error cases
 
+		const bool cached = this->cachesMetadata(fileSystemId);
+		const std::string key = listingKey(uri, "names " + std::to_string(int(fileType)), wildcard);
+		std::vector<std::string> names;
+		if(cached && this->nameListings.get(key, &names)) {
+			return names;
+		}
 		const auto ret = this->fileSystems.at(fileSystemId)->listResourceNames(uri, fileType, wildcard);
+		if(cached) {
+			this->nameListings.put(key, ret);
+		}
 
 		return ret;
 	} catch(const std::exception & e) {
@@ -234,7 +308,16 @@ std::vector<std::string> FileSystemManager::Private::listResourceNames(
 
 		// TODO check fileSystemId ... manage error cases
 
+		const bool cached = this->cachesMetadata(fileSystemId);
+		const std::string key = listingKey(uri, "names", wildcard);
+		std::vector<std::string> names;
+		if(cached && this->nameListings.get(key, &names)) {
+			return names;
+		}
 		const auto ret = this->fileSystems.at(fileSystemId)->listResourceNames(uri, wildcard);
+		if(cached) {
+			this->nameListings.put(key, ret);
+		}
 
 		return ret;
 	} catch(const std::exception & e) {
@@ -254,6 +337,7 @@ bool FileSystemManager::Private::makeDirectory(const Uri & uri) const {
 		// TODO check fileSystemId ... manage error cases
 
 		const auto ret = this->fileSystems.at(fileSystemId)->makeDirectory(uri);
+		this->invalidate(uri);
 
 		return ret;
 	} catch(const std::exception & e) {
@@ -273,9 +357,11 @@ bool FileSystemManager::Private::remove(const Uri & uri) const {
 		// TODO check fileSystemId ... manage error cases
 
 		const auto ret = this->fileSystems.at(fileSystemId)->remove(uri);
+		this->invalidate(uri);
 
 		return ret;
 	} catch(BlazingFileNotFoundException & e) {
+		this->invalidate(uri);
 		return true;
 	} catch(const std::exception & e) {
 		std::string uriStr = uri.toString();
@@ -303,10 +389,13 @@ bool FileSystemManager::Private::move(const Uri & src, const Uri & dst) const {
 			// TODO when we implement the copy operation in the FileSystemManager, we can replace the manual copy step
 			// and replace with a general copy
 			FileUtilv2::copyFile(src, dst);
+			this->invalidate(dst);
 			return remove(src);
 
 		} else {
 			const auto ret = this->fileSystems.at(fileSystemIdSrc)->move(src, dst);
+			this->invalidate(src);
+			this->invalidate(dst);
 			return ret;
 		}
 
@@ -329,6 +418,7 @@ bool FileSystemManager::Private::truncateFile(const Uri & uri, long long length)
 		// TODO check fileSystemId ... manage error cases
 
 		const auto ret = this->fileSystems.at(fileSystemId)->truncateFile(uri, length);
+		this->invalidate(uri);
 
 		return ret;
 	} catch(const std::exception & e) {
@@ -347,9 +437,40 @@ std::shared_ptr<arrow::io::RandomAccessFile> FileSystemManager::Private::openRea
 
 		// TODO check fileSystemId ... manage error cases
 
-		const auto ret = this->fileSystems.at(fileSystemId)->openReadable(uri);
+		const auto & fileSystem = this->fileSystems.at(fileSystemId);
+		std::shared_ptr<arrow::io::RandomAccessFile> file = fileSystem->openReadable(uri);
+		if(file == nullptr) {
+			return file;
+		}
 
-		return ret;
+		const FileSystemType fileSystemType = fileSystem->getFileSystemType();
+		const bool isRemote = isRemoteFileSystem(fileSystemType);
+		// the size of remote files comes from one status asked now, not the cached one: a file rewritten since it was
+		// cached would be read with a stale size (e.g. missing its footer) and its blocks cached under the old version.
+		// The fresh status refreshes the cache and answers every GetSize of the file. Local files answer GetSize
+		// themselves.
+		FileStatus status;
+		int64_t size = -1;
+		if(isRemote) {
+			status = this->refreshFileStatus(uri);
+			size = status.getFileSize();
+		}
+
+		if(this->blockCache != nullptr && isRemote) {
+			std::string version = status.getETag();
+			if(version.empty() && status.getModificationTime() != 0) {
+				version = std::to_string(status.getModificationTime());
+			}
+			// without a version a rewritten file could not be told apart, so it is not cached
+			if(!version.empty()) {
+				file = std::make_shared<BlockCachedReadableFile>(
+					file, this->blockCache, uri.getAuthority(), uri.toString(), status.getFileSize(), version);
+			}
+		}
+
+		// readers that know their reads in advance plan them with CoalescingReadableFile::WillNeed
+		return std::make_shared<CoalescingReadableFile>(
+			file, CoalescingOptions::forFileSystemType(fileSystemType), size);
 	} catch(const std::exception & e) {
 		std::string uriStr = uri.toString();
 		Logging::Logger().logError("Caught error in openReadable with Uri: " + uriStr);
@@ -367,7 +488,9 @@ std::shared_ptr<arrow::io::OutputStream> FileSystemManager::Private::openWriteab
 
 		// TODO check fileSystemId ... manage error cases
 
+		// a status asked for before the stream is closed stays cached with the old size until it expires
 		const auto ret = this->fileSystems.at(fileSystemId)->openWriteable(uri);
+		this->invalidate(uri);
 
 		return ret;
 	} catch(const std::exception & e) {
@@ -377,8 +500,40 @@ std::shared_ptr<arrow::io::OutputStream> FileSystemManager::Private::openWriteab
 	}
 }
 
+void FileSystemManager::Private::invalidate(const Uri & uri) const {
+	const std::string key = uri.toString(true);
+	// the file or everything under the directory (and the files sharing the prefix, which is harmless)
+	this->fileStatuses.erasePrefix(key);
+	// the listings of the directories above it and below it
+	auto isStale = [&key](const std::string & listingKey) {
+		const std::string directory = listingKey.substr(0, listingKey.find('\n'));
+		return key.compare(0, directory.size(), directory) == 0 || directory.compare(0, key.size(), key) == 0;
+	};
+	this->statusListings.eraseIf(isStale);
+	this->uriListings.eraseIf(isStale);
+	this->nameListings.eraseIf(isStale);
+
+	// blocks are keyed by the version of the file, this only frees the space of the old ones sooner
+	if(this->blockCache != nullptr) {
+		this->blockCache->invalidate(uri.toString());
+	}
+}
+
+void FileSystemManager::Private::invalidateAll() const {
+	this->fileStatuses.clear();
+	this->statusListings.clear();
+	this->uriListings.clear();
+	this->nameListings.clear();
+}
+
 // Private stuff
 
+// Local and NFS metadata is cheap to ask for and can be changed by anyone at any time, a cached status would hide a
+// rewritten file (and the footer cached under its status) until it expires
+bool FileSystemManager::Private::cachesMetadata(int fileSystemId) const {
+	return isRemoteFileSystem(this->fileSystems.at(fileSystemId)->getFileSystemType());
+}
+
 int FileSystemManager::Private::verifyFileSystemUri(const Uri & uri) const {
 	try {
 		const int fileSystemId = this->fileSystemIds.at(uri.getAuthority());
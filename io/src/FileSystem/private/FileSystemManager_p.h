@@ -10,8 +10,10 @@
 #include <string>
 #include <vector>
 
+#include "FileSystem/BlockCache.h"
 #include "FileSystem/FileSystemInterface.h"
 #include "FileSystem/FileSystemManager.h"
+#include "MetadataCache.h"
 
 // Composite pattern but we don't need to use FileSystemInterface as base class
 class FileSystemManager::Private {
@@ -25,6 +27,7 @@ public:
 	// Query
 	bool exists(const Uri & uri) const;
 	FileStatus getFileStatus(const Uri & uri) const;
+	FileStatus refreshFileStatus(const Uri & uri) const;
 
 	// List
 	std::vector<FileStatus> list(const Uri & uri, const FileFilter & filter) const;
@@ -44,13 +47,24 @@ public:
 	std::shared_ptr<arrow::io::RandomAccessFile> openReadable(const Uri & uri) const;
 	std::shared_ptr<arrow::io::OutputStream> openWriteable(const Uri & uri) const;
 
+	// Caches
+	void invalidate(const Uri & uri) const;
+	void invalidateAll() const;
+	std::shared_ptr<BlockCache> getBlockCache() const { return blockCache; }
+
 private:
 	int verifyFileSystemUri(const Uri & uri) const;  // returns FileSystem id if ok, -1 otherwise
+	bool cachesMetadata(int fileSystemId) const;
 
 private:
 	std::map<std::string, Path> roots;								// <authority, root>
 	std::map<std::string, int> fileSystemIds;						// <authority, fs id>
 	std::vector<std::unique_ptr<FileSystemInterface>> fileSystems;  // [fs id] = fs
+	mutable MetadataCache<FileStatus> fileStatuses;					// <uri, status>
+	mutable MetadataCache<std::vector<FileStatus>> statusListings;  // <directory uri, kind, wildcard>
+	mutable MetadataCache<std::vector<Uri>> uriListings;
+	mutable MetadataCache<std::vector<std::string>> nameListings;
+	std::shared_ptr<BlockCache> blockCache;  // of remote files, nullptr when disabled
 };
 
 #endif /* _FILESYSTEM_MANAGER_PRIVATE_H_ */
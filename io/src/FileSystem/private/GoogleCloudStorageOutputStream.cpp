@@ -5,178 +5,210 @@
 
 #include "GoogleCloudStorageOutputStream.h"
 
-#include <memory.h>
-
-#include <arrow/memory_pool.h>
-
-#include <FileSystem/private/GoogleCloudStorageReadableFile.h>
+#include <algorithm>
+#include <chrono>
+#include <functional>
+#include <random>
+#include <sstream>
 
 #include "arrow/buffer.h"
-#include <istream>
-#include <streambuf>
-
-#include "ExceptionHandling/BlazingException.h"
 
 #include "Library/Logging/Logger.h"
 
 namespace Logging = Library::Logging;
 
-// TODO: handle the situation when not all data is read
-// const Aws::String FAILED_UPLOAD = "failed-upload";
+namespace {
+
+// GCS composes at most 32 objects per request
+const size_t MAX_COMPOSE_SOURCES = 32;
+
+bool isTransient(const google::cloud::Status & status) {
+	switch(status.code()) {
+	case google::cloud::StatusCode::kUnavailable:
+	case google::cloud::StatusCode::kDeadlineExceeded:
+	case google::cloud::StatusCode::kResourceExhausted:
+	case google::cloud::StatusCode::kInternal:
+	case google::cloud::StatusCode::kAborted: return true;
+	default: return false;
+	}
+}
+
+// Tells apart the temporary objects of uploads of the same key
+std::string newUploadId() {
+	std::random_device device;
+	std::mt19937_64 generator(device() ^ std::chrono::steady_clock::now().time_since_epoch().count());
+	std::ostringstream uploadId;
+	uploadId << std::hex << generator();
+	return uploadId.str();
+}
+
+}  // namespace
+
+// GCS has no multipart upload like S3: every part is uploaded as a temporary object, then the parts are composed into
+// the object and deleted
 class GoogleCloudStorageOutputStream::GoogleCloudStorageOutputStreamImpl {
 public:
-	//~GoogleCloudStorageOutputStreamImpl();
-	GoogleCloudStorageOutputStreamImpl(
-		const std::string & bucketName, const std::string & objectKey, std::shared_ptr<gcs::Client> gcsClient);
+	GoogleCloudStorageOutputStreamImpl(const std::string & bucketName,
+		const std::string & objectKey,
+		std::shared_ptr<gcs::Client> gcsClient,
+		const MultipartUploadOptions & uploadOptions,
+		const RetryOptions & retryOptions);
 
 	arrow::Status close();
 	arrow::Status write(const void * buffer, int64_t nbytes);
-	arrow::Status write(const void * buffer, int64_t nbytes, int64_t * bytes_written);
 	arrow::Status flush();
 	arrow::Status tell(int64_t * position) const;
+	bool closed() const;
 
 private:
+	std::string getTemporaryObjectName(const std::string & suffix) const;
+
+	arrow::Status uploadPart(
+		int partNumber, const std::shared_ptr<arrow::Buffer> & data, std::string * partTag, bool * retryable);
+	arrow::Status completeUpload(const std::vector<std::string> & partTags);
+	arrow::Status compose(const std::vector<std::string> & sources, const std::string & destination);
+	void deleteObjects(const std::vector<std::string> & objectNames);
+
 	std::shared_ptr<gcs::Client> gcsClient;
 	std::string bucket;
 	std::string key;
+	std::string uploadId;
 
-	//		Aws::String uploadId;
-
-	//		std::vector<Aws::GoogleCloudStorage::Model::CompletedPart> completedParts; //just an etag (for response) and a
-	//part number
-	size_t currentPart;
-	int64_t written;
-};
-
-struct membuf : std::streambuf {
-	membuf(char const * base, size_t size) {
-		char * p(const_cast<char *>(base));
-		this->setg(p, p, p + size);
-	}
-};
-
-struct imemstream : virtual membuf, std::iostream {
-	imemstream(char const * base, size_t size)
-		: membuf(base, size), std::iostream(static_cast<std::streambuf *>(this)) {}
+	// last, so an upload not closed is stopped and aborted while the client still exists
+	std::unique_ptr<MultipartUploader> uploader;
 };
 
 GoogleCloudStorageOutputStream::GoogleCloudStorageOutputStreamImpl::GoogleCloudStorageOutputStreamImpl(
-	const std::string & bucketName, const std::string & objectKey, std::shared_ptr<gcs::Client> gcsClient) {
+	const std::string & bucketName,
+	const std::string & objectKey,
+	std::shared_ptr<gcs::Client> gcsClient,
+	const MultipartUploadOptions & uploadOptions,
+	const RetryOptions & retryOptions) {
 	this->bucket = bucketName;
 	this->key = objectKey;
 	this->gcsClient = gcsClient;
+	this->uploadId = newUploadId();
+
+	using namespace std::placeholders;
+	this->uploader.reset(
+		new MultipartUploader(std::bind(&GoogleCloudStorageOutputStreamImpl::uploadPart, this, _1, _2, _3, _4),
+			std::bind(&GoogleCloudStorageOutputStreamImpl::completeUpload, this, _1),
+			std::bind(&GoogleCloudStorageOutputStreamImpl::deleteObjects, this, _1),
+			uploadOptions,
+			retryOptions));
+}
 
-	currentPart = 1;
-	written = 0;
-
-	//    Aws::GoogleCloudStorage::Model::CreateMultipartUploadRequest request;
-	//	request.SetBucket(bucket);
-	//	request.SetKey(key);
-	//    Aws::GoogleCloudStorage::Model::CreateMultipartUploadOutcome createMultipartUploadOutcome =
-	//    GoogleCloudStorageClient->CreateMultipartUpload(request);
-	//	if (createMultipartUploadOutcome.IsSuccess()) {
-	//		this->uploadId = createMultipartUploadOutcome.GetResult().GetUploadId();
-	//	} else {
-	//        Logging::Logger().logError("Failed to create Aws::GoogleCloudStorage::Model::CreateMultipartUploadOutcome
-	//        for bucket: " + bucketName + " and key: " + objectKey);
-	//		bool shouldRetry = createMultipartUploadOutcome.GetError().ShouldRetry();
-	//		if (shouldRetry){
-	//			Logging::Logger().logError(createMultipartUploadOutcome.GetError().GetExceptionName() + " : " +
-	//createMultipartUploadOutcome.GetError().GetMessage() + "  SHOULD RETRY"); 		} else {
-	//			Logging::Logger().logError(createMultipartUploadOutcome.GetError().GetExceptionName() + " : " +
-	//createMultipartUploadOutcome.GetError().GetMessage() + "  SHOULD NOT RETRY");
-	//		}
-	//        throw BlazingGoogleCloudStorageException("Failed to create
-	//        Aws::GoogleCloudStorage::Model::CreateMultipartUploadOutcome. Problem was " +
-	//        createMultipartUploadOutcome.GetError().GetExceptionName() + " : " +
-	//        createMultipartUploadOutcome.GetError().GetMessage());
-	//		this->uploadId = FAILED_UPLOAD;
-	//	}
-
-	// start upload here
+std::string GoogleCloudStorageOutputStream::GoogleCloudStorageOutputStreamImpl::getTemporaryObjectName(
+	const std::string & suffix) const {
+	return this->key + ".bzpart-" + this->uploadId + "-" + suffix;
+}
+
+arrow::Status GoogleCloudStorageOutputStream::GoogleCloudStorageOutputStreamImpl::uploadPart(
+	int partNumber, const std::shared_ptr<arrow::Buffer> & data, std::string * partTag, bool * retryable) {
+	const std::string objectName = this->getTemporaryObjectName(std::to_string(partNumber));
+	google::cloud::StatusOr<gcs::ObjectMetadata> metadata = this->gcsClient->InsertObject(
+		this->bucket, objectName, std::string(reinterpret_cast<const char *>(data->data()), data->size()));
+	if(metadata) {
+		*partTag = objectName;
+		return arrow::Status::OK();
+	}
+
+	*retryable = isTransient(metadata.status());
+	return arrow::Status::IOError("Had a trouble uploading part " + std::to_string(partNumber) + " on file " +
+								  this->bucket + "/" + this->key + ". Problem was " + metadata.status().message());
+}
+
+arrow::Status GoogleCloudStorageOutputStream::GoogleCloudStorageOutputStreamImpl::compose(
+	const std::vector<std::string> & sources, const std::string & destination) {
+	std::vector<gcs::ComposeSourceObject> sourceObjects;
+	for(const std::string & source : sources) {
+		sourceObjects.push_back(gcs::ComposeSourceObject{source, google::cloud::optional<std::int64_t>(),
+			google::cloud::optional<std::int64_t>()});
+	}
+
+	google::cloud::StatusOr<gcs::ObjectMetadata> metadata =
+		this->gcsClient->ComposeObject(this->bucket, sourceObjects, destination);
+	if(!metadata) {
+		return arrow::Status::IOError("Error composing " + this->bucket + "/" + destination +
+									  ". Problem was " + metadata.status().message());
+	}
+	return arrow::Status::OK();
+}
+
+arrow::Status GoogleCloudStorageOutputStream::GoogleCloudStorageOutputStreamImpl::completeUpload(
+	const std::vector<std::string> & partTags) {
+	// compose in rounds, each one reduces the sources 32 times, until they fit in the final object
+	std::vector<std::string> sources = partTags;
+	std::vector<std::string> intermediates;
+	arrow::Status status;
+	for(int round = 1; status.ok() && sources.size() > MAX_COMPOSE_SOURCES; round++) {
+		std::vector<std::string> composed;
+		for(size_t begin = 0; status.ok() && begin < sources.size(); begin += MAX_COMPOSE_SOURCES) {
+			const size_t end = std::min(sources.size(), begin + MAX_COMPOSE_SOURCES);
+			const std::vector<std::string> group(sources.begin() + begin, sources.begin() + end);
+			const std::string destination =
+				this->getTemporaryObjectName("c" + std::to_string(round) + "-" + std::to_string(composed.size()));
+			status = this->compose(group, destination);
+			composed.push_back(destination);
+			intermediates.push_back(destination);
+		}
+		sources = composed;
+	}
+	if(status.ok()) {
+		status = this->compose(sources, this->key);
+	}
+
+	this->deleteObjects(intermediates);
+	if(!status.ok()) {
+		// the parts are deleted by the abort
+		Logging::Logger().logError("In closing outputstream. " + status.ToString());
+		return status;
+	}
+	this->deleteObjects(partTags);
+	return status;
+}
+
+void GoogleCloudStorageOutputStream::GoogleCloudStorageOutputStreamImpl::deleteObjects(
+	const std::vector<std::string> & objectNames) {
+	for(const std::string & objectName : objectNames) {
+		const google::cloud::Status status = this->gcsClient->DeleteObject(this->bucket, objectName);
+		if(!status.ok() && status.code() != google::cloud::StatusCode::kNotFound) {
+			Logging::Logger().logWarn("Failed to delete the temporary object " + this->bucket + "/" + objectName +
+									  ". Problem was " + status.message());
+		}
+	}
 }
 
 arrow::Status GoogleCloudStorageOutputStream::GoogleCloudStorageOutputStreamImpl::write(
 	const void * buffer, int64_t nbytes) {
-	//    Aws::GoogleCloudStorage::Model::UploadPartRequest uploadPartRequest;
-	//	uploadPartRequest.SetBucket(bucket);
-	//	uploadPartRequest.SetKey(key);
-	//	uploadPartRequest.SetPartNumber(currentPart);
-	//	uploadPartRequest.SetUploadId(uploadId);
-	//	//char * tempBuffer = (char *) buffer;
-
-	//	//std::shared_ptr<imemstream> membuffer =  std::make_shared<imemstream>(new );
-	//	//   imemstream membuffer((char *) buffer,nbytes);
-
-	////    std::shared_ptr<imemstream> memBufferPtr
-	//	uploadPartRequest.SetBody(std::make_shared < imemstream > ((char *) buffer, nbytes));
-
-	//	// uploadPart1Request.SetContentMD5(HashingUtils::Base64Encode(md5OfStream));
-
-	//	uploadPartRequest.SetContentLength(nbytes);
-
-	//	written += nbytes;
-	//    Aws::GoogleCloudStorage::Model::UploadPartOutcome uploadOutcome =
-	//    GoogleCloudStorageClient->UploadPart(uploadPartRequest);
-	//	if (uploadOutcome.IsSuccess()) {
-	//        Aws::GoogleCloudStorage::Model::CompletedPart completedPart;
-	//		completedPart.SetETag(uploadOutcome.GetResult().GetETag());
-	//		completedPart.SetPartNumber(currentPart);
-	//		this->completedParts.push_back(completedPart);
-	//		currentPart++;
-	//		return arrow::Status::OK();
-	//	} else {
-	//		Logging::Logger().logError("In Write: Uploading part " + std::to_string(currentPart) + " on file " +
-	//this->bucket + "/" + key + ". Problem was " + uploadOutcome.GetError().GetExceptionName() + " : " +
-	//uploadOutcome.GetError().GetMessage()); 		return arrow::Status::IOError("Had a trouble uploading part " +
-	//std::to_string(currentPart) + " on file " + this->bucket + "/" + key + ". Problem was " +
-	//uploadOutcome.GetError().GetExceptionName() + " : " + uploadOutcome.GetError().GetMessage());
-	//	}
+	return this->uploader->Write(buffer, nbytes);
 }
 
 arrow::Status GoogleCloudStorageOutputStream::GoogleCloudStorageOutputStreamImpl::flush() {
-	// flush is a pass through in all reality
-	// we are making each write send the contents for now for simplicity of design
-	return arrow::Status::OK();
+	return this->uploader->Flush();
 }
 
 arrow::Status GoogleCloudStorageOutputStream::GoogleCloudStorageOutputStreamImpl::close() {
-	//	//flush the buffer
-	//	flush();
-	//    Aws::GoogleCloudStorage::Model::CompleteMultipartUploadRequest completeMultipartUploadRequest;
-
-	//	completeMultipartUploadRequest.SetBucket(bucket);
-	//	completeMultipartUploadRequest.SetKey(key);
-	//	completeMultipartUploadRequest.SetUploadId(uploadId);
-
-	//    Aws::GoogleCloudStorage::Model::CompletedMultipartUpload completedMultipartUpload;
-	//	completedMultipartUpload.SetParts(completedParts);
-	//	completeMultipartUploadRequest.WithMultipartUpload(completedMultipartUpload);
-
-	//    Aws::GoogleCloudStorage::Model::CompleteMultipartUploadOutcome completeMultipartUploadOutcome =
-	//    GoogleCloudStorageClient->CompleteMultipartUpload(completeMultipartUploadRequest);
-	//	if (completeMultipartUploadOutcome.IsSuccess()) {
-	//		return arrow::Status::OK();
-	//	} else {
-	//		Logging::Logger().logError("In closing outputstream. Problem was " +
-	//completeMultipartUploadOutcome.GetError().GetExceptionName() + " : " +
-	//completeMultipartUploadOutcome.GetError().GetMessage()); 		return arrow::Status::IOError("Error closing
-	//outputstream. Problem was " + completeMultipartUploadOutcome.GetError().GetExceptionName() + " : " +
-	//completeMultipartUploadOutcome.GetError().GetMessage());
-
-	//	}
-	////	GoogleCloudStorageClient->CompleteMultipartUpload(uploadCompleteRequest);
+	return this->uploader->Close();
 }
 
 arrow::Status GoogleCloudStorageOutputStream::GoogleCloudStorageOutputStreamImpl::tell(int64_t * position) const {
-	*position = written;
+	return this->uploader->Tell(position);
+}
+
+bool GoogleCloudStorageOutputStream::GoogleCloudStorageOutputStreamImpl::closed() const {
+	return this->uploader->closed();
 }
 
 // BEGIN GoogleCloudStorageOutputStream
 
-GoogleCloudStorageOutputStream::GoogleCloudStorageOutputStream(
-	const std::string & bucketName, const std::string & objectKey, std::shared_ptr<gcs::Client> gcsClient)
-	: impl_(new GoogleCloudStorageOutputStream::GoogleCloudStorageOutputStreamImpl(bucketName, objectKey, gcsClient)) {}
+GoogleCloudStorageOutputStream::GoogleCloudStorageOutputStream(const std::string & bucketName,
+	const std::string & objectKey,
+	std::shared_ptr<gcs::Client> gcsClient,
+	const MultipartUploadOptions & uploadOptions,
+	const RetryOptions & retryOptions)
+	: impl_(new GoogleCloudStorageOutputStream::GoogleCloudStorageOutputStreamImpl(
+		  bucketName, objectKey, gcsClient, uploadOptions, retryOptions)) {}
 
 GoogleCloudStorageOutputStream::~GoogleCloudStorageOutputStream() {}
 
@@ -190,11 +222,6 @@ arrow::Status GoogleCloudStorageOutputStream::Flush() { return this->impl_->flus
 
 arrow::Status GoogleCloudStorageOutputStream::Tell(int64_t * position) const { return this->impl_->tell(position); }
 
-bool GoogleCloudStorageOutputStream::closed() const {
-	// Since every file interaction is a request, then the file is never really open. This function is necesary due to
-	// the Apache Arrow interface starting with v12. Depending on who or what uses this function, we may want this to
-	// always return false??
-	return true;
-}
+bool GoogleCloudStorageOutputStream::closed() const { return this->impl_->closed(); }
 
 // END GoogleCloudStorageOutputStream
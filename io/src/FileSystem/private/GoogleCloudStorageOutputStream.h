@@ -11,12 +11,20 @@
 
 #include "google/cloud/storage/client.h"
 
+#include "MultipartUploader.h"
+#include "RetryPolicy.h"
+
 namespace gcs = google::cloud::storage;
 
 class GoogleCloudStorageOutputStream : public arrow::io::OutputStream {
 public:
-	GoogleCloudStorageOutputStream(
-		const std::string & bucketName, const std::string & objectKey, std::shared_ptr<gcs::Client> gcsClient);
+	// Full parts of uploadOptions.partSize are uploaded in the background while the next ones are written, Close
+	// composes them into the object
+	GoogleCloudStorageOutputStream(const std::string & bucketName,
+		const std::string & objectKey,
+		std::shared_ptr<gcs::Client> gcsClient,
+		const MultipartUploadOptions & uploadOptions = MultipartUploadOptions(),
+		const RetryOptions & retryOptions = RetryOptions());
 	~GoogleCloudStorageOutputStream();
 
 	arrow::Status Close() override;
@@ -27,9 +35,6 @@ public:
 	bool closed() const override;
 
 private:
-	// so we want to store the data that we are writing from there into some
-	// buffer that then gets uploaded  we would like to avoid making allocations
-	// so the buffer can be reusable
 	class GoogleCloudStorageOutputStreamImpl;
 	std::unique_ptr<GoogleCloudStorageOutputStreamImpl> impl_;
 
@@ -8,36 +8,93 @@
 #include <istream>
 #include <streambuf>
 
-#include "arrow/buffer.h"
-#include <arrow/memory_pool.h>
-
 #include "Util/StringUtil.h"
 
 #include "Library/Logging/Logger.h"
 
 namespace Logging = Library::Logging;
 
-// TODO: handle the situation when not all data is read
+namespace {
+
+bool isTransient(const google::cloud::Status & status) {
+	switch(status.code()) {
+	case google::cloud::StatusCode::kUnavailable:
+	case google::cloud::StatusCode::kDeadlineExceeded:
+	case google::cloud::StatusCode::kResourceExhausted:
+	case google::cloud::StatusCode::kInternal:
+	case google::cloud::StatusCode::kAborted: return true;
+	default: return false;
+	}
+}
+
+// One ranged object read, the end of gcs::ReadRange is exclusive
+arrow::Status readObjectRange(gcs::Client & gcsClient,
+	const std::string & bucketName,
+	const std::string & key,
+	int64_t position,
+	int64_t nbytes,
+	int64_t * bytesRead,
+	const OutputFunction & output,
+	bool * retryable) {
+	auto results = gcsClient.ReadObject(bucketName, key, gcs::ReadRange(position, position + nbytes));
+	*bytesRead = 0;
+	if(results.status().ok()) {
+		uint8_t * out = output();
+		if(out == nullptr) {
+			// another attempt of this range answered first
+			return arrow::Status::OK();
+		}
+		results.read((char *) out, nbytes);
+		*bytesRead = results.gcount();
+	}
+
+	if(!results.status().ok()) {
+		*bytesRead = 0;
+		if(results.status().code() == google::cloud::StatusCode::kOutOfRange) {
+			// the range starts at or past the end of the object
+			return arrow::Status::OK();
+		}
+
+		*retryable = isTransient(results.status());
+		if(!*retryable) {
+			Logging::Logger().logError("GoogleCloudStorageReadableFile, ReadObject failed for bucketName: " +
+									   bucketName + " key " + key + " " + results.status().message() +
+									   "  SHOULD NOT RETRY");
+		}
+		return arrow::Status::IOError("Error: " + results.status().message() + " with " + key);
+	}
+	return arrow::Status::OK();
+}
+
+}  // namespace
 
 GoogleCloudStorageReadableFile::~GoogleCloudStorageReadableFile() {}
 
-GoogleCloudStorageReadableFile::GoogleCloudStorageReadableFile(
-	std::shared_ptr<gcs::Client> gcsClient, std::string bucketName, std::string key) {
+GoogleCloudStorageReadableFile::GoogleCloudStorageReadableFile(std::shared_ptr<gcs::Client> gcsClient,
+	std::string bucketName,
+	std::string key,
+	const RangedReadOptions & readOptions,
+	const RetryOptions & retryOptions)
+	: reader(makeRetryingFetch(
+				 [gcsClient, bucketName, key](int64_t position,
+					 int64_t nbytes,
+					 int64_t * bytesRead,
+					 const OutputFunction & output,
+					 bool * retryable) {
+					 return readObjectRange(*gcsClient, bucketName, key, position, nbytes, bytesRead, output, retryable);
+				 },
+				 retryOptions,
+				 RequestLatencyStats::forFileSystem("gcs")),
+		  readOptions) {
 	this->key = key;
 	this->bucketName = bucketName;
 	this->gcsClient = gcsClient;
-	position = 0;
 	valid = true;
 }
 
-arrow::Status GoogleCloudStorageReadableFile::Seek(int64_t position) {
-	this->position = position;
-	return arrow::Status::OK();
-}
-arrow::Status GoogleCloudStorageReadableFile::Tell(int64_t * position) const {
-	*position = this->position;
-	return arrow::Status::OK();
-}
+arrow::Status GoogleCloudStorageReadableFile::Seek(int64_t position) { return this->reader.Seek(position); }
+
+arrow::Status GoogleCloudStorageReadableFile::Tell(int64_t * position) const { return this->reader.Tell(position); }
 
 arrow::Status GoogleCloudStorageReadableFile::Close() {
 	// because each read is its own request we really dont have to do this
@@ -73,215 +130,21 @@ arrow::Status GoogleCloudStorageReadableFile::GetSize(int64_t * size) {
 }
 
 arrow::Status GoogleCloudStorageReadableFile::Read(int64_t nbytes, int64_t * bytesRead, void * buffer) {
-	auto results = this->gcsClient->ReadObject(this->bucketName, key, gcs::ReadRange(position, position + nbytes));
-
-	if(!results.status().ok()) {
-		// TODO: Make bad arrow status here
-		Logging::Logger().logWarn(
-			"GoogleCloudStorageReadableFile::Read, GetObject failed for bucketName: " + bucketName + " key " + key);
-
-		// TODO percy retry logic
-		// bool shouldRetry = results.GetError().ShouldRetry();
-
-		//        if (shouldRetry){
-		//            Logging::Logger().logTrace("retrying");
-		//            return this->Read(nbytes, bytesRead, buffer);
-		//        } else {
-		//            *bytesRead = 0;
-		//            Logging::Logger().logError(results.GetError().GetExceptionName() + " : " +
-		//            results.GetError().GetMessage() + "  SHOULD NOT RETRY");
-		//        }
-
-		return arrow::Status::IOError("Error: " + results.status().message() + " with " + this->key);
-	} else {
-		// TODO percy this doesnt work so we would need to read all the content in order to get the size ... costly!
-		// results.seekg (0, results.end);
-		// int length = results.tellg();
-		// results.seekg (0, results.beg);
-		// std::cout << "OKKKKKKKKKKKKKKKKKKKKKKKKKKKKKKKKY : " << length  << std::endl;
-
-		// TODO percy will asume gsc can read all the content
-		// so we avoid read first all the stuff only to get its size (results.gcount() doesnt work)
-		*bytesRead = nbytes;
-		//*bytesRead = nbytes < *bytesRead ? nbytes : *bytesRead;
-		results.read((char *) buffer, *bytesRead);
-
-		// NOTE percy check for badbit also the user should never read more bytes than the result content size
-		if(results.bad()) {
-			*bytesRead = 0;
-		}
-
-		position += *bytesRead;
-		return arrow::Status::OK();
-	}
+	return this->reader.Read(nbytes, bytesRead, buffer);
 }
 
 arrow::Status GoogleCloudStorageReadableFile::Read(int64_t nbytes, std::shared_ptr<arrow::Buffer> * out) {
-	//	std::cout<<"GoogleCloudStorageReadableFile::Read " + std::to_string(nbytes)<<std::endl;
-	auto results = this->gcsClient->ReadObject(this->bucketName, key, gcs::ReadRange(position, position + nbytes));
-
-	if(!results.status().ok()) {
-		// TODO: Make bad arrow status here
-
-		Logging::Logger().logWarn(
-			"GoogleCloudStorageReadableFile::Read, GetObject failed for bucketName: " + bucketName + " key " + key);
-		// TODO percy
-		//        bool shouldRetry = results.GetError().ShouldRetry();
-		//        if (shouldRetry){
-		//            Logging::Logger().logTrace("retrying");
-		//            return this->Read(nbytes, out);
-		//        } else {
-		//            Logging::Logger().logError(results.GetError().GetExceptionName() + " : " +
-		//            results.GetError().GetMessage() + "  SHOULD NOT RETRY");
-		//        }
-
-		return arrow::Status::IOError("Error: " + results.status().message() + " with " + this->key);
-	} else {
-		// old implementation
-		/*
-std::shared_ptr<arrow::ResizableBuffer> buffer;
-AllocateResizableBuffer(arrow::default_memory_pool(), nbytes, &buffer);
-
-int64_t bytesRead = results.GetResult().GetContentLength();
-
-memcpy(buffer->mutable_data(), results.GetResult().GetBody().rdbuf(), bytesRead);
-
-position += bytesRead;
-*out = buffer;
-return arrow::Status::OK();
-*/
-
-		// TODO percy will asume gsc can read all the content
-		// so we avoid read first all the stuff only to get its size (results.gcount() doesnt work)
-		int64_t bytesRead = nbytes;  // results.gcount();
-		// bytesRead = nbytes < bytesRead ? nbytes : bytesRead;
-		position += bytesRead;
-		// if (bytesRead < nbytes){
-		//    Logging::Logger().logError("Did not read all the bytes at GoogleCloudStorageReadableFile::ReadAt(int64_t
-		//    position, int64_t nbytes, std::shared_ptr<arrow::Buffer>* out)");
-		//}
-		//		results.GetResult().GetBody().read((char*)(out->get()->mutable_data()), bytesRead);
-
-		std::shared_ptr<arrow::ResizableBuffer> buffer;
-		AllocateResizableBuffer(arrow::default_memory_pool(), nbytes, &buffer);
-
-		results.read((char *) (buffer->mutable_data()), bytesRead);
-
-		// NOTE percy check for badbit also the user should never read more bytes than the result content size
-		if(results.bad()) {
-			bytesRead = 0;
-		} else {
-			*out = buffer;
-		}
-
-		return arrow::Status::OK();
-	}
+	return this->reader.Read(nbytes, out);
 }
 
 arrow::Status GoogleCloudStorageReadableFile::ReadAt(
 	int64_t position, int64_t nbytes, int64_t * bytesRead, void * buffer) {
-	//	std::cout<<"GoogleCloudStorageReadableFile::ReadAt " + std::to_string(nbytes)<<std::endl;
-
-	auto results = this->gcsClient->ReadObject(this->bucketName, key, gcs::ReadRange(position, position + nbytes));
-
-	if(!results.status().ok()) {
-		// TODO: Make bad arrow status here
-
-		Logging::Logger().logWarn(
-			"GoogleCloudStorageReadableFile::ReadAt, GetObject failed for bucketName: " + bucketName + " key " + key);
-
-		// TODO percy
-		//        bool shouldRetry = results.GetError().ShouldRetry();
-		//        if (shouldRetry){
-		//            Logging::Logger().logTrace("retrying");
-		//            return this->ReadAt(position, nbytes, bytesRead, buffer);
-		//        } else {
-		//            *bytesRead = 0;
-		//            Logging::Logger().logError(results.GetError().GetExceptionName() + " : " +
-		//            results.GetError().GetMessage() + "  SHOULD NOT RETRY");
-		//        }
-
-		return arrow::Status::IOError("Error: " + results.status().message() + " with " + this->key);
-	} else {
-		// TODO percy will asume gsc can read all the content
-		// so we avoid read first all the stuff only to get its size (results.gcount() doesnt work)
-		*bytesRead = nbytes;
-		//*bytesRead = nbytes < *bytesRead ? nbytes : *bytesRead;
-		this->position = position + *bytesRead;
-		results.read((char *) buffer, *bytesRead);
-
-		// NOTE percy check for badbit also the user should never read more bytes than the result content size
-		if(results.bad()) {
-			*bytesRead = 0;
-		}
-
-		return arrow::Status::OK();
-	}
+	return this->reader.ReadAt(position, nbytes, bytesRead, buffer);
 }
 
 arrow::Status GoogleCloudStorageReadableFile::ReadAt(
 	int64_t position, int64_t nbytes, std::shared_ptr<arrow::Buffer> * out) {
-	//	std::cout<<"GoogleCloudStorageReadableFile::ReadAt " + std::to_string(nbytes)<<std::endl;
-
-	auto results = this->gcsClient->ReadObject(this->bucketName, key, gcs::ReadRange(position, position + nbytes));
-
-	if(!results.status().ok()) {
-		// TODO: Make bad arrow status here
-
-		Logging::Logger().logWarn(
-			"GoogleCloudStorageReadableFile::ReadAt, GetObject failed for bucketName: " + bucketName + " key " + key);
-		// TODO percy
-		//        bool shouldRetry = results.GetError().ShouldRetry();
-		//        if (shouldRetry){
-		//            Logging::Logger().logTrace("retrying");
-		//            return this->ReadAt(position, nbytes, out);
-		//        } else {
-		//            Logging::Logger().logError(results.GetError().GetExceptionName() + " : " +
-		//            results.GetError().GetMessage() + "  SHOULD NOT RETRY");
-		//        }
-
-		return arrow::Status::IOError("Error: " + results.status().message() + " with " + this->key);
-	} else {
-		// old implementation
-		/*
-		//byutes read should always be full amount
-		//should almost always be nBytes
-		std::shared_ptr<arrow::ResizableBuffer> buffer;
-		AllocateResizableBuffer(arrow::default_memory_pool(), nbytes, &buffer);
-
-		int64_t bytesRead = nbytes;
-
-		memcpy(buffer->mutable_data(), results.GetResult().GetBody().rdbuf(), bytesRead);
-
-		*out = buffer;
-		return arrow::Status::OK();
-		*/
-
-		// TODO percy will asume gsc can read all the content
-		// so we avoid read first all the stuff only to get its size (results.gcount() doesnt work)
-		int64_t bytesRead = nbytes;  // results.gcount();
-		// bytesRead = nbytes < bytesRead ? nbytes : bytesRead;
-		this->position = position + nbytes;
-		// if (bytesRead < nbytes){
-		//    Logging::Logger().logError("Did not read all the bytes at GoogleCloudStorageReadableFile::ReadAt(int64_t
-		//    position, int64_t nbytes, std::shared_ptr<arrow::Buffer>* out)");
-		//}
-		//		results.GetResult().GetBody().read((char*)(out->get()->mutable_data()), bytesRead);
-
-		std::shared_ptr<arrow::ResizableBuffer> buffer;
-		AllocateResizableBuffer(arrow::default_memory_pool(), nbytes, &buffer);
-
-		results.read((char *) (buffer->mutable_data()), bytesRead);
-
-		// NOTE percy check for badbit also the user should never read more bytes than the result content size
-		if(results.bad()) {
-			bytesRead = 0;
-		} else {
-			*out = buffer;
-		}
-
-		return arrow::Status::OK();
-	}
+	return this->reader.ReadAt(position, nbytes, out);
 }
 
 bool GoogleCloudStorageReadableFile::supports_zero_copy() const { return false; }
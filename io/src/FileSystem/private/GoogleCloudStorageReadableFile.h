@@ -11,11 +11,20 @@
 
 #include "google/cloud/storage/client.h"
 
+#include "RangedReader.h"
+#include "RetryPolicy.h"
+
 namespace gcs = google::cloud::storage;
 
+// Every read is one or more ranged object reads, see RangedReader, retried and hedged as set by the RetryOptions.
+// ReadAt can be called from several threads at once.
 class GoogleCloudStorageReadableFile : public arrow::io::RandomAccessFile {
 public:
-	GoogleCloudStorageReadableFile(std::shared_ptr<gcs::Client> gcsClient, std::string bucket, std::string key);
+	GoogleCloudStorageReadableFile(std::shared_ptr<gcs::Client> gcsClient,
+		std::string bucket,
+		std::string key,
+		const RangedReadOptions & readOptions = RangedReadOptions(),
+		const RetryOptions & retryOptions = RetryOptions());
 	~GoogleCloudStorageReadableFile();
 
 	arrow::Status Close() override;
@@ -43,7 +52,7 @@ private:
 	std::shared_ptr<gcs::Client> gcsClient;
 	std::string bucketName;
 	std::string key;
-	size_t position;
+	RangedReader reader;
 	bool valid;
 
 	ARROW_DISALLOW_COPY_AND_ASSIGN(GoogleCloudStorageReadableFile);
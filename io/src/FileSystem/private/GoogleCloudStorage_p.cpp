@@ -59,6 +59,9 @@ bool GoogleCloudStorage::Private::connect(const FileSystemConnection & fileSyste
 	auto connConf = opts->set_project_id(projectId);
 
 	this->gcsClient = std::make_shared<gcs::Client>(connConf);
+	this->readOptions = RangedReadOptions::fromEnvironment("BLAZING_GCS");
+	this->retryOptions = RetryOptions::fromEnvironment("BLAZING_GCS");
+	this->uploadOptions = MultipartUploadOptions::fromEnvironment("BLAZING_GCS");
 
 	const std::string bucket = this->getBucketName();
 	bool validBucket = false;
@@ -159,7 +162,9 @@ FileStatus GoogleCloudStorage::Private::getFileStatus(const Uri & uri) const {
 			const FileStatus fileStatus(uri, fileType, contentLength);
 			return fileStatus;
 		} else {  // is probably a file (e.g. application/octet-stream or text/x-python and so on ...
-			const FileStatus fileStatus(uri, FileType::FILE, contentLength);
+			const auto updated = std::chrono::duration_cast<std::chrono::nanoseconds>(
+				objectMetadata->updated().time_since_epoch());
+			const FileStatus fileStatus(uri, FileType::FILE, contentLength, updated.count(), objectMetadata->etag());
 			return fileStatus;
 		}
 	} else {
@@ -167,6 +172,16 @@ FileStatus GoogleCloudStorage::Private::getFileStatus(const Uri & uri) const {
 	}
 }
 
+// Narrows the listing of a folder to the keys a wildcard over full paths can match: the literal prefix of the
+// wildcard when it is inside the folder, e.g. data/year= for /data/year=*/*.parquet
+static std::string getListingPrefix(const Path & folderPath, const std::string & wildcard) {
+	const std::string folder = folderPath.toString(true);
+	const std::string literalPrefix = GlobPattern(wildcard).getLiteralPrefix();
+	const bool insideFolder = folder.back() == '/' && literalPrefix.size() > folder.size() &&
+							  StringUtil::beginsWith(literalPrefix, folder);
+	return insideFolder ? literalPrefix.substr(1) : folder.substr(1);
+}
+
 std::vector<FileStatus> GoogleCloudStorage::Private::list(const Uri & uri, const FileFilter & filter) const {
 	//	std::vector<FileStatus> response;
 
@@ -306,11 +321,13 @@ std::vector<Uri> GoogleCloudStorage::Private::list(const Uri & uri, const std::s
 	const std::string objectKey = folderPath.toString(true).substr(1, folderPath.toString(true).size());
 	const std::string bucket = this->getBucketName();
 
-	auto objectsOutcome = this->gcsClient->ListObjects(bucket, gcs::Prefix(objectKey));
+	const std::string listingPrefix = getListingPrefix(folderPath, (uriWithRoot.getPath() + wildcard).toString(true));
+	auto objectsOutcome = this->gcsClient->ListObjects(bucket, gcs::Prefix(listingPrefix));
 
 	if(objectsOutcome.begin() != objectsOutcome.end()) {
 		const Path wildcardPath = uriWithRoot.getPath() + wildcard;
 		const std::string finalWildcard = wildcardPath.toString(true);
+		const GlobPattern glob(finalWildcard);
 
 		for(auto && object_metadata : objectsOutcome) {
 			// WARNING TODO percy there is no folders concept in S# ... we should change Path::isFile::bool to
@@ -319,7 +336,7 @@ std::vector<Uri> GoogleCloudStorage::Private::list(const Uri & uri, const std::s
 								  .getPathWithNormalizedFolderConvention();  // TODO percy avoid hardcoded string
 
 			if(path != folderPath) {
-				const bool pass = WildcardFilter::match(path.toString(true), finalWildcard);
+				const bool pass = glob.matches(path.toString(true));
 
 				if(pass) {
 					const Uri entry(uri.getScheme(), uri.getAuthority(), path);
@@ -490,11 +507,13 @@ std::vector<std::string> GoogleCloudStorage::Private::listResourceNames(
 	// TODO percy see how gcs manage the delimiters
 	// request.WithDelimiter("/"); //NOTE percy since we control how to create files in S3 we should use this convention
 
-	auto objectsOutcome = this->gcsClient->ListObjects(bucket, gcs::Prefix(objectKey));
+	const std::string listingPrefix = getListingPrefix(folderPath, (uriWithRoot.getPath() + wildcard).toString(true));
+	auto objectsOutcome = this->gcsClient->ListObjects(bucket, gcs::Prefix(listingPrefix));
 
 	if(objectsOutcome.begin() != objectsOutcome.end()) {
 		const Path wildcardPath = Path(uriWithRoot.getPath() + wildcard);
 		const std::string finalWildcard = wildcardPath.toString(true);
+		const GlobPattern glob(finalWildcard);
 
 		for(auto && object_metadata : objectsOutcome) {
 			// WARNING TODO percy there is no folders concept in S# ... we should change Path::isFile::bool to
@@ -504,7 +523,7 @@ std::vector<std::string> GoogleCloudStorage::Private::listResourceNames(
 
 			if(path != folderPath) {
 				const Uri entry(uri.getScheme(), uri.getAuthority(), path);
-				const bool pass = WildcardFilter::match(path.toString(true), finalWildcard);
+				const bool pass = glob.matches(path.toString(true));
 
 				if(pass) {
 					response.push_back(entry.getPath().getResourceName());
@@ -772,22 +791,23 @@ bool GoogleCloudStorage::Private::openReadable(
 	const std::string objectKey = path.toString(true).substr(1, path.toString(true).size());
 	const std::string bucketName = this->getBucketName();
 	// TODO: S3ReadableFile currentl has no validity check add it and throw errors here
-	*file = std::make_shared<GoogleCloudStorageReadableFile>(this->gcsClient, bucketName, objectKey);
+	*file = std::make_shared<GoogleCloudStorageReadableFile>(
+		this->gcsClient, bucketName, objectKey, this->readOptions, this->retryOptions);
 	return (*file)->isValid();
 }
 
 bool GoogleCloudStorage::Private::openWriteable(
 	const Uri & uri, std::shared_ptr<GoogleCloudStorageOutputStream> * file) const {
-	//	if (uri.isValid() == false) {
-	//		throw BlazingInvalidPathException(uri);
-	//	}
+	if(uri.isValid() == false) {
+		throw BlazingInvalidPathException(uri);
+	}
 
-	//	const Uri uriWithRoot(uri.getScheme(), uri.getAuthority(), this->root + uri.getPath().toString());
-	//	const Path path = uriWithRoot.getPath();
-	//	const std::string objectKey = path.toString(true).substr(1, path.toString(true).size());
-	//	const std::string bucketName = this->getBucketName();
-	//	//TODO: S3Outputstream currentl has no validity check add it and throw errors here
-	//	*file = std::make_shared < S3OutputStream > (bucketName, objectKey, this->s3Client);
+	const Uri uriWithRoot(uri.getScheme(), uri.getAuthority(), this->root + uri.getPath().toString());
+	const Path path = uriWithRoot.getPath();
+	const std::string objectKey = path.toString(true).substr(1, path.toString(true).size());
+	const std::string bucketName = this->getBucketName();
+	*file = std::make_shared<GoogleCloudStorageOutputStream>(
+		bucketName, objectKey, this->gcsClient, this->uploadOptions, this->retryOptions);
 
 	return true;
 }
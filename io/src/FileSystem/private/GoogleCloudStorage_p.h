@@ -59,6 +59,9 @@ private:
 	FileSystemConnection fileSystemConnection;
 	std::shared_ptr<gcs::Client> gcsClient;
 	std::string regionName;
+	RangedReadOptions readOptions;
+	RetryOptions retryOptions;
+	MultipartUploadOptions uploadOptions;
 };
 
 #endif /* _GOOGLECLOUDSTORAGE_FILE_SYSTEM_PRIVATE_H_ */
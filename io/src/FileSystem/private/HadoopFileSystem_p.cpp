@@ -229,12 +229,13 @@ std::vector<Uri> HadoopFileSystem::Private::list(const Uri & uri, const std::str
 		const std::string auth = host + ":" + port;
 		const Uri finalWildcardUri(FileSystemType::HDFS, auth, finalWildcardPath);
 		const std::string finalWildcard = finalWildcardUri.toString(true);
+		const GlobPattern glob(finalWildcard);
 		const std::string ignore = finalWildcardUri.getScheme() + "://" + auth;
 
 		if(this->root.isRoot()) {  // if root is '/' then we don't need to replace the uris to relative paths
 			for(auto hdfsPathInfo : listing) {
 				const std::string fpath = hdfsPathInfo.name;
-				const bool pass = WildcardFilter::match(fpath, finalWildcard);
+				const bool pass = glob.matches(fpath);
 
 				if(pass) {
 					const std::string onlyPath = StringUtil::replace(fpath, ignore, "");
@@ -245,7 +246,7 @@ std::vector<Uri> HadoopFileSystem::Private::list(const Uri & uri, const std::str
 		} else {  // if root is not '/' then we need to replace the uris to relative paths
 			for(auto hdfsPathInfo : listing) {
 				const std::string fpath = hdfsPathInfo.name;
-				const bool pass = WildcardFilter::match(fpath, finalWildcard);  // filter must use the full path
+				const bool pass = glob.matches(fpath);  // filter must use the full path
 
 				if(pass) {
 					const std::string onlyPath = StringUtil::replace(fpath, ignore, "");
@@ -343,10 +344,11 @@ std::vector<std::string> HadoopFileSystem::Private::listResourceNames(
 	if(status.ok()) {
 		const Path wildcardPath = uriWithRoot.getPath() + wildcard;
 		const std::string finalWildcard = wildcardPath.toString(true);
+		const GlobPattern glob(finalWildcard);
 
 		if(this->root.isRoot()) {  // if root is '/' then we don't need to replace the uris to relative paths
 			for(auto hdfsPathInfo : listing) {
-				const bool pass = WildcardFilter::match(hdfsPathInfo.name, finalWildcard);
+				const bool pass = glob.matches(hdfsPathInfo.name);
 
 				if(pass) {
 					const Uri listedPath(uri.getScheme(), uri.getAuthority(), hdfsPathInfo.name);
@@ -356,7 +358,7 @@ std::vector<std::string> HadoopFileSystem::Private::listResourceNames(
 		} else {  // if root is not '/' then we need to replace the uris to relative paths
 			for(auto hdfsPathInfo : listing) {
 				const bool pass =
-					WildcardFilter::match(hdfsPathInfo.name, finalWildcard);  // filter must use the full path
+					glob.matches(hdfsPathInfo.name);  // filter must use the full path
 
 				if(pass) {
 					const Path fullPath(hdfsPathInfo.name);
@@ -0,0 +1,476 @@
+/*
+ * Copyright 2017 BlazingDB, Inc.
+ */
+
+#include "IoUringReadableFile.h"
+
+#include <algorithm>
+#include <cerrno>
+#include <cstdlib>
+#include <cstring>
+#include <deque>
+#include <vector>
+
+#include <fcntl.h>
+#include <linux/io_uring.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <sys/syscall.h>
+#include <sys/uio.h>
+#include <unistd.h>
+
+#include <arrow/memory_pool.h>
+
+#include "Library/Logging/Logger.h"
+namespace Logging = Library::Logging;
+
+namespace {
+
+// Covers the logical block size of any device, O_DIRECT offsets, lengths and buffers are multiples of it
+const int64_t DIRECT_IO_ALIGNMENT = 4096;
+
+int64_t alignDown(int64_t value) { return value & ~(DIRECT_IO_ALIGNMENT - 1); }
+
+int64_t alignUp(int64_t value) { return alignDown(value + DIRECT_IO_ALIGNMENT - 1); }
+
+bool isAligned(int64_t value) { return (value & (DIRECT_IO_ALIGNMENT - 1)) == 0; }
+
+// Memory aligned for O_DIRECT, released with the buffer
+class AlignedBuffer : public arrow::Buffer {
+public:
+	AlignedBuffer(uint8_t * memory, int64_t size) : arrow::Buffer(memory, size), memory(memory) {}
+	~AlignedBuffer() { std::free(this->memory); }
+
+	uint8_t * getMemory() const { return memory; }
+
+private:
+	uint8_t * memory;
+};
+
+arrow::Status allocateAligned(int64_t size, std::shared_ptr<AlignedBuffer> * out) {
+	void * memory = nullptr;
+	if(posix_memalign(&memory, DIRECT_IO_ALIGNMENT, std::max(size, DIRECT_IO_ALIGNMENT)) != 0) {
+		return arrow::Status::OutOfMemory("Failed to allocate ", size, " aligned bytes");
+	}
+	*out = std::make_shared<AlignedBuffer>(static_cast<uint8_t *>(memory), size);
+	return arrow::Status::OK();
+}
+
+struct ReadRequest {
+	uint8_t * data;
+	int64_t offset;
+	int64_t length;
+	int64_t done;  // bytes read
+	struct iovec iov;
+};
+
+// Whether the request needs no more reads, fileSize is the one the file had when it was opened
+bool isComplete(const ReadRequest & request, int64_t fileSize) {
+	return request.done >= request.length || request.offset + request.done >= fileSize;
+}
+
+// Moves a short read back to an aligned offset, a direct read can not resume in the middle of a block
+void resumeAfterShortRead(ReadRequest & request, bool directIo) {
+	if(directIo) {
+		request.done = alignDown(request.done);
+	}
+}
+
+arrow::Status preadRequests(int fd, std::vector<ReadRequest> & requests, int64_t fileSize, bool directIo) {
+	for(ReadRequest & request : requests) {
+		while(!isComplete(request, fileSize)) {
+			const ssize_t bytesRead =
+				pread(fd, request.data + request.done, request.length - request.done, request.offset + request.done);
+			if(bytesRead < 0) {
+				if(errno == EINTR) {
+					continue;
+				}
+				return arrow::Status::IOError("Failed to read local file: ", std::strerror(errno));
+			}
+			if(bytesRead == 0) {
+				break;  // the file is shorter than when it was opened
+			}
+			request.done += bytesRead;
+			if(!isComplete(request, fileSize)) {
+				resumeAfterShortRead(request, directIo);
+			}
+		}
+	}
+	return arrow::Status::OK();
+}
+
+// Minimal io_uring over the raw system calls: one submission and one completion queue mapped from the kernel
+class IoUring {
+public:
+	// Returns nullptr when io_uring is not available, errno tells why
+	static std::unique_ptr<IoUring> create(unsigned entries) {
+		io_uring_params params;
+		std::memset(&params, 0, sizeof(params));
+		const int ringFd = syscall(__NR_io_uring_setup, entries, &params);
+		if(ringFd < 0) {
+			return nullptr;
+		}
+
+		std::unique_ptr<IoUring> ring(new IoUring(ringFd, entries));
+		ring->submissionEntries = params.sq_entries;
+		ring->submissionRingSize = params.sq_off.array + params.sq_entries * sizeof(unsigned);
+		ring->completionRingSize = params.cq_off.cqes + params.cq_entries * sizeof(io_uring_cqe);
+		ring->sharedRing = (params.features & IORING_FEAT_SINGLE_MMAP) != 0;
+		if(ring->sharedRing) {
+			ring->submissionRingSize = std::max(ring->submissionRingSize, ring->completionRingSize);
+		}
+
+		ring->submissionRing = mmap(nullptr,
+			ring->submissionRingSize,
+			PROT_READ | PROT_WRITE,
+			MAP_SHARED | MAP_POPULATE,
+			ringFd,
+			IORING_OFF_SQ_RING);
+		if(ring->submissionRing == MAP_FAILED) {
+			return nullptr;
+		}
+		if(ring->sharedRing) {
+			ring->completionRing = ring->submissionRing;
+		} else {
+			ring->completionRing = mmap(nullptr,
+				ring->completionRingSize,
+				PROT_READ | PROT_WRITE,
+				MAP_SHARED | MAP_POPULATE,
+				ringFd,
+				IORING_OFF_CQ_RING);
+			if(ring->completionRing == MAP_FAILED) {
+				return nullptr;
+			}
+		}
+		ring->sqesSize = params.sq_entries * sizeof(io_uring_sqe);
+		void * sqes =
+			mmap(nullptr, ring->sqesSize, PROT_READ | PROT_WRITE, MAP_SHARED | MAP_POPULATE, ringFd, IORING_OFF_SQES);
+		if(sqes == MAP_FAILED) {
+			return nullptr;
+		}
+		ring->sqes = static_cast<io_uring_sqe *>(sqes);
+
+		char * submission = static_cast<char *>(ring->submissionRing);
+		ring->submissionTail = reinterpret_cast<unsigned *>(submission + params.sq_off.tail);
+		ring->submissionMask = reinterpret_cast<unsigned *>(submission + params.sq_off.ring_mask);
+		ring->submissionArray = reinterpret_cast<unsigned *>(submission + params.sq_off.array);
+		char * completion = static_cast<char *>(ring->completionRing);
+		ring->completionHead = reinterpret_cast<unsigned *>(completion + params.cq_off.head);
+		ring->completionTail = reinterpret_cast<unsigned *>(completion + params.cq_off.tail);
+		ring->completionMask = reinterpret_cast<unsigned *>(completion + params.cq_off.ring_mask);
+		ring->cqes = reinterpret_cast<io_uring_cqe *>(completion + params.cq_off.cqes);
+		return ring;
+	}
+
+	~IoUring() {
+		if(this->sqes != nullptr) {
+			munmap(this->sqes, this->sqesSize);
+		}
+		if(this->completionRing != MAP_FAILED && !this->sharedRing) {
+			munmap(this->completionRing, this->completionRingSize);
+		}
+		if(this->submissionRing != MAP_FAILED) {
+			munmap(this->submissionRing, this->submissionRingSize);
+		}
+		close(this->ringFd);
+	}
+
+	unsigned getRequestedEntries() const { return requestedEntries; }
+
+	// Reads every request, resubmitting the short reads, until each one is complete or hits the end of the file
+	arrow::Status read(int fd, std::vector<ReadRequest> & requests, int64_t fileSize, bool directIo) {
+		std::deque<size_t> queue;
+		for(size_t i = 0; i < requests.size(); i++) {
+			if(!isComplete(requests[i], fileSize)) {
+				queue.push_back(i);
+			}
+		}
+
+		unsigned inFlight = 0;
+		unsigned unsubmitted = 0;  // queued to the kernel and not consumed yet
+		int error = 0;
+		while(true) {
+			unsigned tail = *this->submissionTail;
+			while(error == 0 && !queue.empty() && inFlight + unsubmitted < this->submissionEntries) {
+				ReadRequest & request = requests[queue.front()];
+				request.iov.iov_base = request.data + request.done;
+				request.iov.iov_len = request.length - request.done;
+
+				const unsigned index = tail & *this->submissionMask;
+				io_uring_sqe & sqe = this->sqes[index];
+				std::memset(&sqe, 0, sizeof(sqe));
+				sqe.opcode = IORING_OP_READV;
+				sqe.fd = fd;
+				sqe.off = request.offset + request.done;
+				sqe.addr = reinterpret_cast<uint64_t>(&request.iov);
+				sqe.len = 1;
+				sqe.user_data = queue.front();
+				this->submissionArray[index] = index;
+				queue.pop_front();
+				tail++;
+				unsubmitted++;
+			}
+			__atomic_store_n(this->submissionTail, tail, __ATOMIC_RELEASE);
+			if(inFlight + unsubmitted == 0) {
+				break;
+			}
+
+			// submits the batch and waits for the first completion with one system call
+			const int submitted =
+				syscall(__NR_io_uring_enter, this->ringFd, unsubmitted, 1, IORING_ENTER_GETEVENTS, nullptr, 0);
+			if(submitted < 0) {
+				if(errno == EINTR) {
+					continue;
+				}
+				if(inFlight == 0) {
+					// nothing can write in the buffers anymore, the ring is dropped with the requests it still holds
+					this->broken = true;
+					return arrow::Status::IOError("Failed to submit io_uring reads: ", std::strerror(errno));
+				}
+				error = errno;
+			} else {
+				inFlight += submitted;
+				unsubmitted -= submitted;
+			}
+
+			unsigned head = *this->completionHead;
+			const unsigned completionTail = __atomic_load_n(this->completionTail, __ATOMIC_ACQUIRE);
+			for(; head != completionTail; head++) {
+				const io_uring_cqe & cqe = this->cqes[head & *this->completionMask];
+				ReadRequest & request = requests[cqe.user_data];
+				inFlight--;
+				if(cqe.res < 0) {
+					if(cqe.res == -EAGAIN || cqe.res == -EINTR) {
+						queue.push_back(cqe.user_data);
+					} else if(error == 0) {
+						error = -cqe.res;
+					}
+				} else if(cqe.res > 0) {
+					request.done += cqe.res;
+					if(!isComplete(request, fileSize)) {
+						resumeAfterShortRead(request, directIo);
+						queue.push_back(cqe.user_data);
+					}
+				}
+				// a read of 0 bytes is the end of a file shorter than when it was opened
+			}
+			__atomic_store_n(this->completionHead, head, __ATOMIC_RELEASE);
+
+			if(error != 0 && inFlight == 0) {
+				this->broken = unsubmitted > 0;
+				return arrow::Status::IOError("Failed to read local file with io_uring: ", std::strerror(error));
+			}
+		}
+		return arrow::Status::OK();
+	}
+
+	bool isBroken() const { return broken; }
+
+private:
+	IoUring(int ringFd, unsigned requestedEntries) : ringFd(ringFd), requestedEntries(requestedEntries) {}
+
+	const int ringFd;
+	const unsigned requestedEntries;
+	unsigned submissionEntries = 0;
+	bool sharedRing = false;
+	bool broken = false;
+
+	void * submissionRing = MAP_FAILED;
+	size_t submissionRingSize = 0;
+	void * completionRing = MAP_FAILED;
+	size_t completionRingSize = 0;
+	io_uring_sqe * sqes = nullptr;
+	size_t sqesSize = 0;
+
+	unsigned * submissionTail = nullptr;
+	unsigned * submissionMask = nullptr;
+	unsigned * submissionArray = nullptr;
+	unsigned * completionHead = nullptr;
+	unsigned * completionTail = nullptr;
+	unsigned * completionMask = nullptr;
+	io_uring_cqe * cqes = nullptr;
+};
+
+// The ring of the calling thread, nullptr when it can not be created
+IoUring * threadRing(unsigned entries) {
+	thread_local std::unique_ptr<IoUring> ring;
+	if(ring == nullptr || ring->isBroken() || ring->getRequestedEntries() != entries) {
+		ring.reset();
+		ring = IoUring::create(entries);
+	}
+	return ring.get();
+}
+
+}  // namespace
+
+bool IoUringReadableFile::isSupported() {
+	static const bool supported = (IoUring::create(1) != nullptr);
+	return supported;
+}
+
+arrow::Status IoUringReadableFile::Open(
+	const std::string & path, const IoUringOptions & options, std::shared_ptr<IoUringReadableFile> * file) {
+	bool directIo = options.directIo;
+	int fd = open(path.c_str(), O_RDONLY | O_CLOEXEC | (directIo ? O_DIRECT : 0));
+	if(fd < 0 && directIo && errno == EINVAL) {
+		// e.g. tmpfs
+		Logging::Logger().logWarn("O_DIRECT is not supported for " + path + ", reading it through the page cache");
+		directIo = false;
+		fd = open(path.c_str(), O_RDONLY | O_CLOEXEC);
+	}
+	if(fd < 0) {
+		return arrow::Status::IOError("Failed to open local file ", path, ": ", std::strerror(errno));
+	}
+
+	struct stat status;
+	if(fstat(fd, &status) != 0) {
+		const int fstatError = errno;
+		close(fd);
+		return arrow::Status::IOError("Failed to stat local file ", path, ": ", std::strerror(fstatError));
+	}
+
+	static std::once_flag unsupportedWarning;
+	if(!isSupported()) {
+		std::call_once(unsupportedWarning, []() {
+			Logging::Logger().logWarn("io_uring is not available, local files will be read with pread");
+		});
+	}
+
+	file->reset(new IoUringReadableFile(fd, status.st_size, options, directIo));
+	return arrow::Status::OK();
+}
+
+IoUringReadableFile::IoUringReadableFile(int fd, int64_t size, const IoUringOptions & options, bool directIo)
+	: fd(fd), size(size), options(options), directIo(directIo), isClosed(false), position(0) {}
+
+IoUringReadableFile::~IoUringReadableFile() { this->Close(); }
+
+arrow::Status IoUringReadableFile::readFully(int64_t position, int64_t nbytes, uint8_t * out, int64_t * bytesRead) {
+	int64_t requestSize = std::max<int64_t>(1, this->options.requestSize);
+	if(this->directIo) {
+		requestSize = alignUp(requestSize);
+	}
+	std::vector<ReadRequest> requests;
+	for(int64_t offset = position; offset < position + nbytes; offset += requestSize) {
+		ReadRequest request;
+		request.data = out + (offset - position);
+		request.offset = offset;
+		request.length = std::min(requestSize, position + nbytes - offset);
+		request.done = 0;
+		requests.push_back(request);
+	}
+
+	IoUring * ring = isSupported() ? threadRing(std::max(1, this->options.queueDepth)) : nullptr;
+	const arrow::Status status = (ring != nullptr) ? ring->read(this->fd, requests, this->size, this->directIo)
+												   : preadRequests(this->fd, requests, this->size, this->directIo);
+	ARROW_RETURN_NOT_OK(status);
+
+	// the bytes read up to the first request that hit the end of the file
+	*bytesRead = 0;
+	for(const ReadRequest & request : requests) {
+		*bytesRead += std::min(request.done, request.length);
+		if(request.done < request.length) {
+			break;
+		}
+	}
+	return arrow::Status::OK();
+}
+
+arrow::Status IoUringReadableFile::ReadAt(int64_t position, int64_t nbytes, std::shared_ptr<arrow::Buffer> * out) {
+	if(this->closed()) {
+		return arrow::Status::Invalid("Operation on closed file");
+	}
+	if(position < 0 || nbytes < 0) {
+		return arrow::Status::Invalid("Invalid read position ", position, " or size ", nbytes);
+	}
+	nbytes = std::max<int64_t>(0, std::min(nbytes, this->size - position));
+
+	int64_t bytesRead = 0;
+	if(!this->directIo) {
+		std::shared_ptr<arrow::ResizableBuffer> buffer;
+		ARROW_RETURN_NOT_OK(AllocateResizableBuffer(arrow::default_memory_pool(), nbytes, &buffer));
+		ARROW_RETURN_NOT_OK(this->readFully(position, nbytes, buffer->mutable_data(), &bytesRead));
+		ARROW_RETURN_NOT_OK(buffer->Resize(bytesRead));
+		*out = buffer;
+		return arrow::Status::OK();
+	}
+
+	const int64_t start = alignDown(position);
+	const int64_t end = alignUp(position + nbytes);
+	std::shared_ptr<AlignedBuffer> buffer;
+	ARROW_RETURN_NOT_OK(allocateAligned(end - start, &buffer));
+	ARROW_RETURN_NOT_OK(this->readFully(start, end - start, buffer->getMemory(), &bytesRead));
+	const int64_t available = std::max<int64_t>(0, std::min(nbytes, bytesRead - (position - start)));
+	*out = arrow::SliceBuffer(buffer, position - start, available);
+	return arrow::Status::OK();
+}
+
+arrow::Status IoUringReadableFile::ReadAt(int64_t position, int64_t nbytes, int64_t * bytesRead, void * buffer) {
+	if(this->closed()) {
+		return arrow::Status::Invalid("Operation on closed file");
+	}
+	if(position < 0 || nbytes < 0) {
+		return arrow::Status::Invalid("Invalid read position ", position, " or size ", nbytes);
+	}
+	nbytes = std::max<int64_t>(0, std::min(nbytes, this->size - position));
+
+	const bool aligned =
+		isAligned(position) && isAligned(nbytes) && isAligned(reinterpret_cast<int64_t>(buffer));
+	if(!this->directIo || aligned) {
+		return this->readFully(position, nbytes, static_cast<uint8_t *>(buffer), bytesRead);
+	}
+
+	// read through an aligned buffer
+	std::shared_ptr<arrow::Buffer> out;
+	ARROW_RETURN_NOT_OK(this->ReadAt(position, nbytes, &out));
+	std::memcpy(buffer, out->data(), out->size());
+	*bytesRead = out->size();
+	return arrow::Status::OK();
+}
+
+arrow::Status IoUringReadableFile::Read(int64_t nbytes, int64_t * bytesRead, void * buffer) {
+	int64_t position = 0;
+	this->Tell(&position);
+	ARROW_RETURN_NOT_OK(this->ReadAt(position, nbytes, bytesRead, buffer));
+	return this->Seek(position + *bytesRead);
+}
+
+arrow::Status IoUringReadableFile::Read(int64_t nbytes, std::shared_ptr<arrow::Buffer> * out) {
+	int64_t position = 0;
+	this->Tell(&position);
+	ARROW_RETURN_NOT_OK(this->ReadAt(position, nbytes, out));
+	return this->Seek(position + (*out)->size());
+}
+
+arrow::Status IoUringReadableFile::Seek(int64_t position) {
+	if(position < 0) {
+		return arrow::Status::Invalid("Invalid position ", position);
+	}
+	std::lock_guard<std::mutex> lock(this->mutex);
+	this->position = position;
+	return arrow::Status::OK();
+}
+
+arrow::Status IoUringReadableFile::Tell(int64_t * position) const {
+	std::lock_guard<std::mutex> lock(this->mutex);
+	*position = this->position;
+	return arrow::Status::OK();
+}
+
+arrow::Status IoUringReadableFile::GetSize(int64_t * size) {
+	*size = this->size;
+	return arrow::Status::OK();
+}
+
+arrow::Status IoUringReadableFile::Close() {
+	if(!this->isClosed.exchange(true)) {
+		if(close(this->fd) != 0) {
+			return arrow::Status::IOError("Failed to close local file: ", std::strerror(errno));
+		}
+	}
+	return arrow::Status::OK();
+}
+
+bool IoUringReadableFile::closed() const { return this->isClosed; }
+
+bool IoUringReadableFile::supports_zero_copy() const { return false; }
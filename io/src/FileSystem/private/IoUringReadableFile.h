@@ -0,0 +1,78 @@
+/*
+ * Copyright 2017 BlazingDB, Inc.
+ */
+
+#ifndef _BZ_IO_URING_READABLE_FILE_H_
+#define _BZ_IO_URING_READABLE_FILE_H_
+
+#include <atomic>
+#include <cstdint>
+#include <memory>
+#include <mutex>
+#include <string>
+
+#include "arrow/buffer.h"
+#include "arrow/io/interfaces.h"
+#include "arrow/status.h"
+
+struct IoUringOptions {
+	int queueDepth = 32;			  // reads in flight per thread
+	int64_t requestSize = 1024 * 1024;  // reads are split in requests of this size
+	bool directIo = false;			  // bypass the page cache, when the file system supports O_DIRECT
+};
+
+/**
+ * Local file read through io_uring: every ReadAt is split in requestSize reads which are submitted queueDepth at a
+ * time with one system call, and reaped as they complete. Each thread has its own ring, so concurrent reads of the
+ * same or other files don't wait for each other.
+ *
+ * With directIo reads bypass the page cache, they are widened to aligned offsets and read into aligned buffers, then
+ * sliced. When the kernel does not allow io_uring (old kernels, seccomp in containers) reads fall back to pread.
+ */
+class IoUringReadableFile : public arrow::io::RandomAccessFile {
+public:
+	static arrow::Status Open(
+		const std::string & path, const IoUringOptions & options, std::shared_ptr<IoUringReadableFile> * file);
+
+	// Whether io_uring can be used by this process
+	static bool isSupported();
+
+	~IoUringReadableFile();
+
+	arrow::Status Close() override;
+	bool closed() const override;
+
+	arrow::Status GetSize(int64_t * size) override;
+
+	arrow::Status Read(int64_t nbytes, int64_t * bytesRead, void * buffer) override;
+	arrow::Status Read(int64_t nbytes, std::shared_ptr<arrow::Buffer> * out) override;
+
+	arrow::Status ReadAt(int64_t position, int64_t nbytes, int64_t * bytesRead, void * buffer) override;
+	arrow::Status ReadAt(int64_t position, int64_t nbytes, std::shared_ptr<arrow::Buffer> * out) override;
+
+	bool supports_zero_copy() const override;
+
+	arrow::Status Seek(int64_t position) override;
+	arrow::Status Tell(int64_t * position) const override;
+
+	bool isDirectIo() const { return directIo; }
+
+private:
+	IoUringReadableFile(int fd, int64_t size, const IoUringOptions & options, bool directIo);
+
+	// Reads [position, position + nbytes) into out, which must be aligned like the range when directIo
+	arrow::Status readFully(int64_t position, int64_t nbytes, uint8_t * out, int64_t * bytesRead);
+
+	int fd;
+	const int64_t size;
+	const IoUringOptions options;
+	const bool directIo;
+	std::atomic<bool> isClosed;
+
+	mutable std::mutex mutex;  // guards position
+	int64_t position;
+
+	ARROW_DISALLOW_COPY_AND_ASSIGN(IoUringReadableFile);
+};
+
+#endif /* _BZ_IO_URING_READABLE_FILE_H_ */
@@ -0,0 +1,107 @@
+/*
+ * Copyright 2017 BlazingDB, Inc.
+ */
+
+#include "LocalDirectory.h"
+
+#include <cerrno>
+#include <cstring>
+#include <memory>
+
+#include <dirent.h>
+#include <fcntl.h>
+#include <sys/stat.h>
+#include <sys/syscall.h>
+#include <unistd.h>
+
+namespace {
+
+// Record returned by getdents64, glibc does not declare it
+struct LinuxDirent64 {
+	uint64_t d_ino;
+	int64_t d_off;
+	unsigned short d_reclen;
+	unsigned char d_type;
+	char d_name[256];  // d_reclen long in fact, never indexed past the name
+};
+
+const size_t DIRENTS_BUFFER_SIZE = 256 * 1024;  // a few thousand entries per system call
+
+FileType toFileType(mode_t mode) {
+	switch(mode & S_IFMT) {
+	case S_IFDIR: return FileType::DIRECTORY;
+	case S_IFREG: return FileType::FILE;
+	default: return FileType::UNDEFINED;
+	}
+}
+
+void setStatus(const struct stat & status, LocalDirectoryEntry * entry) {
+	entry->fileType = toFileType(status.st_mode);
+	entry->fileSize = status.st_size;
+	entry->modificationTime = status.st_mtim.tv_sec * 1000000000ULL + status.st_mtim.tv_nsec;
+	entry->hasStatus = true;
+}
+
+}  // namespace
+
+bool readLocalDirectory(
+	const std::string & directory, const LocalStatusFilter & needsStatus, std::vector<LocalDirectoryEntry> * entries) {
+	const int fd = open(directory.c_str(), O_RDONLY | O_DIRECTORY | O_CLOEXEC);
+	if(fd < 0) {
+		return false;
+	}
+
+	std::unique_ptr<char[]> buffer(new char[DIRENTS_BUFFER_SIZE]);
+	for(;;) {
+		const long bytesRead = syscall(SYS_getdents64, fd, buffer.get(), DIRENTS_BUFFER_SIZE);
+		if(bytesRead < 0 && errno == EINTR) {
+			continue;
+		}
+		if(bytesRead < 0) {
+			const int error = errno;
+			close(fd);
+			errno = error;
+			return false;
+		}
+		if(bytesRead == 0) {
+			break;
+		}
+
+		for(long offset = 0; offset < bytesRead;) {
+			const LinuxDirent64 * dirent = reinterpret_cast<const LinuxDirent64 *>(buffer.get() + offset);
+			offset += dirent->d_reclen;
+			const char * name = dirent->d_name;
+			if(name[0] == '.' && (name[1] == '\0' || (name[1] == '.' && name[2] == '\0'))) {
+				continue;
+			}
+
+			LocalDirectoryEntry entry;
+			entry.name = name;
+			struct stat status;
+			switch(dirent->d_type) {
+			case DT_REG: entry.fileType = FileType::FILE; break;
+			case DT_DIR: entry.fileType = FileType::DIRECTORY; break;
+			case DT_LNK: entry.isSymlink = true; break;
+			case DT_UNKNOWN:
+				// file systems that do not fill d_type
+				if(fstatat(fd, name, &status, AT_SYMLINK_NOFOLLOW) == 0) {
+					entry.isSymlink = S_ISLNK(status.st_mode);
+					if(!entry.isSymlink) {
+						setStatus(status, &entry);
+					}
+				}
+				break;
+			default: entry.fileType = FileType::UNDEFINED; break;
+			}
+
+			// symlinks are followed, like stat does in LocalFileSystem::getFileStatus
+			if(!entry.hasStatus && (entry.isSymlink || (needsStatus && needsStatus(entry))) &&
+				fstatat(fd, name, &status, 0) == 0) {
+				setStatus(status, &entry);
+			}
+			entries->push_back(std::move(entry));
+		}
+	}
+	close(fd);
+	return true;
+}
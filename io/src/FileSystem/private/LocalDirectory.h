@@ -0,0 +1,36 @@
+/*
+ * Copyright 2017 BlazingDB, Inc.
+ */
+
+#ifndef SRC_FILESYSTEM_PRIVATE_LOCALDIRECTORY_H_
+#define SRC_FILESYSTEM_PRIVATE_LOCALDIRECTORY_H_
+
+#include <functional>
+#include <string>
+#include <vector>
+
+#include "FileSystem/FileSystemType.h"
+
+struct LocalDirectoryEntry {
+	std::string name;  // relative to the listed directory
+	FileType fileType = FileType::UNDEFINED;
+	bool isSymlink = false;  // the type and the status are the ones of the target
+	bool hasStatus = false;  // fileSize and modificationTime were read
+	unsigned long long fileSize = 0;
+	unsigned long long modificationTime = 0;  // nanoseconds since the epoch
+};
+
+// Tells which entries need their size and modification time, called with the name and the type of the entry
+using LocalStatusFilter = std::function<bool(const LocalDirectoryEntry & entry)>;
+
+/**
+ * Lists a directory with batched getdents64 calls. The type of the entries comes from d_type, an fstatat relative to
+ * the directory is done only for symlinks (which are followed), for the entries of file systems that do not fill
+ * d_type and for the ones needsStatus (when set) asks for. "." and ".." are skipped.
+ *
+ * Returns false, with errno set, when the directory can not be opened or read.
+ */
+bool readLocalDirectory(
+	const std::string & directory, const LocalStatusFilter & needsStatus, std::vector<LocalDirectoryEntry> * entries);
+
+#endif /* SRC_FILESYSTEM_PRIVATE_LOCALDIRECTORY_H_ */
@@ -5,8 +5,14 @@
 
 #include "LocalFileSystem_p.h"
 
+#include <algorithm>
+#include <thread>
+
+#include "LocalDirectory.h"
+
 #include "ExceptionHandling/BlazingThread.h"
 #include <chrono>
+#include <cstdlib>
 #include <cstring>
 #include <iostream>
 
@@ -17,6 +23,7 @@
 #include <fcntl.h>  // O_RDONLY
 #include <stdio.h>
 #include <stdlib.h>
+#include <sys/mman.h>
 #include <sys/stat.h>
 #include <sys/syscall.h>
 #include <unistd.h>  // read
@@ -39,7 +46,63 @@ namespace Logging = Library::Logging;
 #define FILE_PERMISSION_BITS_MODE 0600
 #endif
 
-LocalFileSystem::Private::Private(const Path & root) : root(root) {}
+namespace {
+
+// The property of the connection, else its env var
+std::string getReadProperty(
+	const FileSystemConnection & fileSystemConnection, LocalFileSystemConnection::ConnectionProperty property) {
+	const std::string value = fileSystemConnection.getConnectionProperty(property);
+	if(value.empty() == false) {
+		return value;
+	}
+	const char * envValue = std::getenv(LocalFileSystemConnection::connectionPropertyEnvName(property).c_str());
+	return (envValue == nullptr) ? std::string() : std::string(envValue);
+}
+
+// Hints the kernel how the whole mapping of file will be read, the buffer read at 0 is the start of the mapping
+void adviseMapping(const std::shared_ptr<arrow::io::MemoryMappedFile> & file,
+	LocalFileSystemConnection::MmapAdvice mmapAdvice,
+	const std::string & path) {
+	using LocalFileSystemConnection::MmapAdvice;
+
+	int advice = MADV_NORMAL;
+	switch(mmapAdvice) {
+	case MmapAdvice::SEQUENTIAL: advice = MADV_SEQUENTIAL; break;
+	case MmapAdvice::RANDOM: advice = MADV_RANDOM; break;
+	case MmapAdvice::WILLNEED: advice = MADV_WILLNEED; break;
+	default: return;
+	}
+
+	int64_t size = 0;
+	std::shared_ptr<arrow::Buffer> mapping;
+	if(!file->GetSize(&size).ok() || size == 0 || !file->ReadAt(0, size, &mapping).ok()) {
+		return;
+	}
+	if(madvise(const_cast<uint8_t *>(mapping->data()), mapping->size(), advice) != 0) {
+		Logging::Logger().logWarn("madvise failed for " + path + ": " + std::string(std::strerror(errno)));
+	}
+}
+
+}  // namespace
+
+LocalFileSystem::Private::Private(const FileSystemConnection & fileSystemConnection, const Path & root)
+	: root(root), fileSystemConnection(fileSystemConnection) {
+	using namespace LocalFileSystemConnection;
+
+	this->readMode = readModeFromName(getReadProperty(fileSystemConnection, ConnectionProperty::READ_MODE));
+	if(this->readMode == ReadMode::UNDEFINED) {
+		this->readMode = ReadMode::PREAD;
+	}
+	this->mmapAdvice = mmapAdviceFromName(getReadProperty(fileSystemConnection, ConnectionProperty::MMAP_ADVICE));
+	if(this->mmapAdvice == MmapAdvice::UNDEFINED) {
+		this->mmapAdvice = MmapAdvice::WILLNEED;
+	}
+	const std::string queueDepth = getReadProperty(fileSystemConnection, ConnectionProperty::IO_URING_QUEUE_DEPTH);
+	if(queueDepth.empty() == false) {
+		this->ioUringOptions.queueDepth = std::max(1, std::min(4096, std::stoi(queueDepth)));
+	}
+	this->ioUringOptions.directIo = (getReadProperty(fileSystemConnection, ConnectionProperty::DIRECT_IO) == "true");
+}
 
 inline void openDirExceptions(Uri uri) {
 	switch(errno) {
@@ -128,7 +191,10 @@ FileStatus LocalFileSystem::Private::getFileStatus(const Uri & uri) const {
 		default: fileType = FileType::UNDEFINED; break;
 		}
 
-		return FileStatus(uri, fileType, stat_buf.st_size);
+		const unsigned long long modificationTime =
+			stat_buf.st_mtim.tv_sec * 1000000000ULL + stat_buf.st_mtim.tv_nsec;
+
+		return FileStatus(uri, fileType, stat_buf.st_size, modificationTime, "");
 	} else {
 		switch(errno) {
 		case EACCES: throw BlazingInvalidPermissionsFileException(uri);
@@ -151,7 +217,23 @@ FileStatus LocalFileSystem::Private::getFileStatus(const Uri & uri) const {
 	return FileStatus();
 }
 
-// TODO percy list: reuse duplicated code in all list methods
+namespace {
+
+// "/dir" and "/dir/" => "/dir/", the full path of an entry is the prefix followed by its name
+std::string directoryPrefix(const Path & path) {
+	std::string prefix = path.toString(true);
+	if(prefix.empty() || prefix.back() != '/') {
+		prefix += '/';
+	}
+	return prefix;
+}
+
+bool anyStatus(const LocalDirectoryEntry &) { return true; }
+
+}  // namespace
+
+// The list methods read the directory with getdents64 and filter by d_type and name first, the entries are stat'ed
+// (relative to the directory) only when their status is part of the result
 
 std::vector<FileStatus> LocalFileSystem::Private::list(const Uri & uri, const FileFilter & filter) const {
 	std::vector<FileStatus> response;
@@ -163,65 +245,47 @@ std::vector<FileStatus> LocalFileSystem::Private::list(const Uri & uri, const Fi
 	const Uri uriWithRoot(uri.getScheme(), uri.getAuthority(), this->root + uri.getPath().toString());
 	const Path path = uriWithRoot.getPath();
 
-	DIR * dirp = opendir(path.toString().c_str());
-
-	if(dirp) {
-		struct dirent * entry;
+	// the filter can look at anything in the status
+	std::vector<LocalDirectoryEntry> entries;
+	if(readLocalDirectory(path.toString(), anyStatus, &entries) == false) {
+		openDirExceptions(uri);
+		return response;
+	}
 
-		if(this->root.isRoot()) {  // if root is '/' then we don't need to replace the uris to relative paths
-			while((entry = readdir(dirp)) != NULL) {
-				const std::string name(entry->d_name);
-				const bool skip = (name == ".") || ((name == ".."));
+	// if root is '/' then we don't need to replace the uris to relative paths
+	const Path & listedPath = this->root.isRoot() ? path : uri.getPath();
 
-				if(skip) {
-					continue;
-				}
+	for(const LocalDirectoryEntry & entry : entries) {
+		if(entry.hasStatus == false) {  // removed meanwhile, or a broken symlink
+			continue;
+		}
 
-				const Path listedPath = path + name;
-				const FileStatus fileStatus = this->getFileStatus(Uri(uri.getScheme(), uri.getAuthority(), listedPath));
-				const bool pass = filter(fileStatus);
+		const FileStatus fileStatus(Uri(uri.getScheme(), uri.getAuthority(), listedPath + entry.name),
+			entry.fileType,
+			entry.fileSize,
+			entry.modificationTime,
+			"");
 
-				if(pass) {
-					response.push_back(fileStatus);
-				}
+		if(this->root.isRoot()) {
+			if(filter(fileStatus)) {
+				response.push_back(fileStatus);
 			}
-		} else {  // if root is not '/' then we need to replace the uris to relative paths
-			while((entry = readdir(dirp)) != NULL) {
-				const std::string name(entry->d_name);
-				const bool skip = (name == ".") || ((name == ".."));
-
-				if(skip) {
-					continue;
-				}
-
-				const Path fullPath = path + name;
-				const Uri fullUri(uri.getScheme(), uri.getAuthority(), fullPath);
-
-				const Path relativePath = fullPath.replaceParentPath(uriWithRoot.getPath(), uri.getPath());
-				const Uri relativeUri(uri.getScheme(), uri.getAuthority(), relativePath);
+		} else {
+			const FileStatus fullFileStatus(
+				Uri(uri.getScheme(), uri.getAuthority(), path + entry.name), entry.fileType, entry.fileSize);
 
-				const FileStatus relativeFileStatus = this->getFileStatus(relativeUri);
-				const FileStatus fullFileStatus(
-					fullUri, relativeFileStatus.getFileType(), relativeFileStatus.getFileSize());
-
-				const bool pass = filter(fullFileStatus);  // filter must use the full path
-
-				if(pass) {
-					response.push_back(relativeFileStatus);
-				}
+			if(filter(fullFileStatus)) {  // filter must use the full path
+				response.push_back(fileStatus);
 			}
 		}
-
-		closedir(dirp);
-	} else {
-		openDirExceptions(uri);
 	}
 
 	return response;
 }
 
-std::vector<Uri> LocalFileSystem::Private::list(const Uri & uri, const std::string & wildcard) const {
-	std::vector<Uri> response;
+std::vector<FileStatus> LocalFileSystem::Private::list(
+	const Uri & uri, FileType fileType, const std::string & wildcard) const {
+	std::vector<FileStatus> response;
 
 	if(uri.isValid() == false) {
 		throw BlazingInvalidPathException(uri);
@@ -229,56 +293,62 @@ std::vector<Uri> LocalFileSystem::Private::list(const Uri & uri, const std::stri
 
 	const Uri uriWithRoot(uri.getScheme(), uri.getAuthority(), this->root + uri.getPath().toString());
 	const Path path = uriWithRoot.getPath();
+	const std::string prefix = directoryPrefix(path);
 
-	DIR * dirp = opendir(path.toString().c_str());
+	// same as FileTypeWildcardFilter, the wildcard must match the full path
+	const GlobPattern glob(wildcard);
+	auto pass = [&prefix, fileType, &glob](const LocalDirectoryEntry & entry) {
+		return entry.fileType == fileType && glob.matches(prefix + entry.name);
+	};
 
-	if(dirp) {
-		const Path wildcardPath = uriWithRoot.getPath() + wildcard;
-		const std::string finalWildcard = wildcardPath.toString(true);
+	std::vector<LocalDirectoryEntry> entries;
+	if(readLocalDirectory(path.toString(), pass, &entries) == false) {
+		openDirExceptions(uri);
+		return response;
+	}
 
-		struct dirent * entry;
+	const Path & listedPath = this->root.isRoot() ? path : uri.getPath();
 
-		if(this->root.isRoot()) {  // if root is '/' then we don't need to replace the uris to relative paths
-			while((entry = readdir(dirp)) != NULL) {
-				const std::string name(entry->d_name);
-				const bool skip = (name == ".") || ((name == ".."));
+	for(const LocalDirectoryEntry & entry : entries) {
+		if(entry.hasStatus && pass(entry)) {
+			response.push_back(FileStatus(Uri(uri.getScheme(), uri.getAuthority(), listedPath + entry.name),
+				entry.fileType,
+				entry.fileSize,
+				entry.modificationTime,
+				""));
+		}
+	}
 
-				if(skip) {
-					continue;
-				}
+	return response;
+}
 
-				const Path fullPath = path + name;
-				const bool pass = WildcardFilter::match(fullPath.toString(true), finalWildcard);
+std::vector<Uri> LocalFileSystem::Private::list(const Uri & uri, const std::string & wildcard) const {
+	std::vector<Uri> response;
 
-				if(pass) {
-					response.push_back(Uri(uri.getScheme(), uri.getAuthority(), fullPath));
-				}
-			}
-		} else {  // if root is not '/' then we need to replace the uris to relative paths
-			while((entry = readdir(dirp)) != NULL) {
-				const std::string name(entry->d_name);
-				const bool skip = (name == ".") || ((name == ".."));
+	if(uri.isValid() == false) {
+		throw BlazingInvalidPathException(uri);
+	}
 
-				if(skip) {
-					continue;
-				}
+	const Uri uriWithRoot(uri.getScheme(), uri.getAuthority(), this->root + uri.getPath().toString());
+	const Path path = uriWithRoot.getPath();
 
-				const Path fullPath = path + name;
-				const bool pass =
-					WildcardFilter::match(fullPath.toString(true), finalWildcard);  // filter must use the full path
+	// only the names are needed
+	std::vector<LocalDirectoryEntry> entries;
+	if(readLocalDirectory(path.toString(), nullptr, &entries) == false) {
+		openDirExceptions(uri);
+		return response;
+	}
 
-				if(pass) {
-					const Path relativePath = fullPath.replaceParentPath(uriWithRoot.getPath(), uri.getPath());
-					const Uri relativeUri(uri.getScheme(), uri.getAuthority(), relativePath);
+	const Path wildcardPath = uriWithRoot.getPath() + wildcard;
+	const std::string finalWildcard = wildcardPath.toString(true);
+	const GlobPattern glob(finalWildcard);
+	const std::string prefix = directoryPrefix(path);
+	const Path & listedPath = this->root.isRoot() ? path : uri.getPath();
 
-					response.push_back(relativeUri);
-				}
-			}
+	for(const LocalDirectoryEntry & entry : entries) {
+		if(glob.matches(prefix + entry.name)) {  // filter must use the full path
+			response.push_back(Uri(uri.getScheme(), uri.getAuthority(), listedPath + entry.name));
 		}
-
-		closedir(dirp);
-	} else {
-		openDirExceptions(uri);
 	}
 
 	return response;
@@ -293,65 +363,24 @@ std::vector<std::string> LocalFileSystem::Private::listResourceNames(
 	}
 
 	const Uri uriWithRoot(uri.getScheme(), uri.getAuthority(), this->root + uri.getPath().toString());
-	const Path path = uri.getPath();
-
-	DIR * dirp = opendir(path.toString().c_str());
-
-	if(dirp) {
-		const Path wildcardPath = uriWithRoot.getPath() + wildcard;
-		const std::string finalWildcard = wildcardPath.toString(true);
-
-		struct dirent * entry;
-
-		if(this->root.isRoot()) {  // if root is '/' then we don't need to replace the uris to relative paths
-			while((entry = readdir(dirp)) != NULL) {
-				const std::string name(entry->d_name);
-				const bool skip = (name == ".") || ((name == ".."));
-
-				if(skip) {
-					continue;
-				}
-
-				const Path listedPath = path + name;
-				const FileStatus fileStatus = this->getFileStatus(Uri(uri.getScheme(), uri.getAuthority(), listedPath));
-				const FileTypeWildcardFilter filter(fileType, finalWildcard);
-				const bool pass = filter(fileStatus);
-
-				if(pass) {
-					response.push_back(name);
-				}
-			}
-		} else {  // if root is not '/' then we need to replace the uris to relative paths
-			while((entry = readdir(dirp)) != NULL) {
-				const std::string name(entry->d_name);
-				const bool skip = (name == ".") || ((name == ".."));
-
-				if(skip) {
-					continue;
-				}
-
-				const Path fullPath = uri.getPath() + name;
-				const Uri fullUri(uri.getScheme(), uri.getAuthority(), fullPath);
-
-				const Path relativePath = fullPath.replaceParentPath(uriWithRoot.getPath(), uri.getPath());
-				const Uri relativeUri(uri.getScheme(), uri.getAuthority(), relativePath);
+	const Path path = uriWithRoot.getPath();
 
-				const FileStatus relativeFileStatus = this->getFileStatus(relativeUri);
-				const FileStatus fullFileStatus(
-					fullUri, relativeFileStatus.getFileType(), relativeFileStatus.getFileSize());
+	// the type comes from d_type, no status is needed
+	std::vector<LocalDirectoryEntry> entries;
+	if(readLocalDirectory(path.toString(), nullptr, &entries) == false) {
+		openDirExceptions(uri);
+		return response;
+	}
 
-				const FileTypeWildcardFilter filter(fileType, finalWildcard);
-				const bool pass = filter(relativeFileStatus);  // filter must use the full path
+	const Path wildcardPath = uriWithRoot.getPath() + wildcard;
+	const std::string finalWildcard = wildcardPath.toString(true);
+	const GlobPattern glob(finalWildcard);
+	const std::string prefix = directoryPrefix(path);
 
-				if(pass) {
-					response.push_back(name);
-				}
-			}
+	for(const LocalDirectoryEntry & entry : entries) {
+		if(entry.fileType == fileType && glob.matches(prefix + entry.name)) {
+			response.push_back(entry.name);
 		}
-
-		closedir(dirp);
-	} else {
-		openDirExceptions(uri);
 	}
 
 	return response;
@@ -368,52 +397,21 @@ std::vector<std::string> LocalFileSystem::Private::listResourceNames(
 	const Uri uriWithRoot(uri.getScheme(), uri.getAuthority(), this->root + uri.getPath().toString());
 	const Path path = uriWithRoot.getPath();
 
-	DIR * dirp = opendir(path.toString().c_str());
-
-	if(dirp) {
-		const Path wildcardPath = uriWithRoot.getPath() + wildcard;
-		const std::string finalWildcard = wildcardPath.toString(true);
-
-		struct dirent * entry;
-
-		if(this->root.isRoot()) {  // if root is '/' then we don't need to replace the uris to relative paths
-			while((entry = readdir(dirp)) != NULL) {
-				const std::string name(entry->d_name);
-				const bool skip = (name == ".") || ((name == ".."));
-
-				if(skip) {
-					continue;
-				}
-
-				const bool pass = WildcardFilter::match(name, finalWildcard);
-
-				if(pass) {
-					response.push_back(name);
-				}
-			}
-		} else {  // if root is not '/' then we need to replace the uris to relative paths
-			while((entry = readdir(dirp)) != NULL) {
-				const std::string name(entry->d_name);
-				const bool skip = (name == ".") || ((name == ".."));
-
-				if(skip) {
-					continue;
-				}
-
-				const Path fullPath = uri.getPath() + name;
+	std::vector<LocalDirectoryEntry> entries;
+	if(readLocalDirectory(path.toString(), nullptr, &entries) == false) {
+		openDirExceptions(uri);
+		return response;
+	}
 
-				const bool pass =
-					WildcardFilter::match(fullPath.toString(true), finalWildcard);  // filter must use the full path
+	const Path wildcardPath = uriWithRoot.getPath() + wildcard;
+	const std::string finalWildcard = wildcardPath.toString(true);
+	const GlobPattern glob(finalWildcard);
+	const std::string prefix = directoryPrefix(path);
 
-				if(pass) {
-					response.push_back(name);
-				}
-			}
+	for(const LocalDirectoryEntry & entry : entries) {
+		if(glob.matches(prefix + entry.name)) {  // filter must use the full path
+			response.push_back(entry.name);
 		}
-
-		closedir(dirp);
-	} else {
-		openDirExceptions(uri);
 	}
 
 	return response;
@@ -744,11 +742,32 @@ std::shared_ptr<arrow::io::RandomAccessFile> LocalFileSystem::Private::openReada
 	const Uri uriWithRoot(uri.getScheme(), uri.getAuthority(), this->root + uri.getPath().toString());
 	const Path path = uriWithRoot.getPath();
 
-	std::shared_ptr<arrow::io::ReadableFile> readableFile;
-	if(!arrow::io::ReadableFile::Open(path.toString(), &readableFile).ok()) {
-		throw BlazingFileSystemException("Unable to open " + uriWithRoot.toString() + " for reading");
+	switch(this->readMode) {
+	case LocalFileSystemConnection::ReadMode::MMAP: {
+		std::shared_ptr<arrow::io::MemoryMappedFile> mappedFile;
+		if(!arrow::io::MemoryMappedFile::Open(path.toString(), arrow::io::FileMode::READ, &mappedFile).ok()) {
+			throw BlazingFileSystemException("Unable to map " + uriWithRoot.toString() + " for reading");
+		}
+		adviseMapping(mappedFile, this->mmapAdvice, path.toString());
+		return mappedFile;
+	}
+
+	case LocalFileSystemConnection::ReadMode::IO_URING: {
+		std::shared_ptr<IoUringReadableFile> ioUringFile;
+		if(!IoUringReadableFile::Open(path.toString(), this->ioUringOptions, &ioUringFile).ok()) {
+			throw BlazingFileSystemException("Unable to open " + uriWithRoot.toString() + " for reading");
+		}
+		return ioUringFile;
+	}
+
+	default: {
+		std::shared_ptr<arrow::io::ReadableFile> readableFile;
+		if(!arrow::io::ReadableFile::Open(path.toString(), &readableFile).ok()) {
+			throw BlazingFileSystemException("Unable to open " + uriWithRoot.toString() + " for reading");
+		}
+		return readableFile;
+	}
 	}
-	return readableFile;
 }
 
 std::shared_ptr<arrow::io::OutputStream> LocalFileSystem::Private::openWriteable(const Uri & uri) const {
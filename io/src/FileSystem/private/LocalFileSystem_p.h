@@ -8,9 +8,11 @@
 
 #include "FileSystem/LocalFileSystem.h"
 
+#include "IoUringReadableFile.h"
+
 class LocalFileSystem::Private {
 public:
-	Private(const Path & root);
+	Private(const FileSystemConnection & fileSystemConnection, const Path & root);
 
 	// Query
 	bool exists(const Uri & uri) const;
@@ -18,6 +20,7 @@ public:
 
 	// List
 	std::vector<FileStatus> list(const Uri & uri, const FileFilter & filter) const;
+	std::vector<FileStatus> list(const Uri & uri, FileType fileType, const std::string & wildcard = "*") const;
 	std::vector<Uri> list(const Uri & uri, const std::string & wildcard = "*") const;
 	std::vector<std::string> listResourceNames(
 		const Uri & uri, FileType fileType, const std::string & wildcard = "*") const;
@@ -36,6 +39,12 @@ public:
 public:
 	// State
 	Path root;
+	FileSystemConnection fileSystemConnection;
+
+	// How files are read: the properties of the connection, else the BLAZING_LOCAL_* env vars, else pread
+	LocalFileSystemConnection::ReadMode readMode;
+	LocalFileSystemConnection::MmapAdvice mmapAdvice;
+	IoUringOptions ioUringOptions;
 };
 
 #endif /* _LOCAL_FILE_SYSTEM_PRIVATE_H_ */
@@ -0,0 +1,16 @@
+/*
+ * Copyright 2017 BlazingDB, Inc.
+ */
+
+#include "MetadataCache.h"
+
+#include <algorithm>
+
+#include "Util/EnvUtil.h"
+
+MetadataCacheOptions MetadataCacheOptions::fromEnvironment() {
+	MetadataCacheOptions options;
+	options.ttlMs = std::max<int64_t>(0, EnvUtil::getInt("BLAZING_METADATA_CACHE_TTL_MS", options.ttlMs));
+	options.maxEntries = std::max<int64_t>(1, EnvUtil::getInt("BLAZING_METADATA_CACHE_ENTRIES", options.maxEntries));
+	return options;
+}
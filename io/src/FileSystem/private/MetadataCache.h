@@ -0,0 +1,112 @@
+/*
+ * Copyright 2017 BlazingDB, Inc.
+ */
+
+#ifndef SRC_FILESYSTEM_PRIVATE_METADATACACHE_H_
+#define SRC_FILESYSTEM_PRIVATE_METADATACACHE_H_
+
+#include <atomic>
+#include <chrono>
+#include <cstdint>
+#include <map>
+#include <mutex>
+#include <string>
+
+struct MetadataCacheOptions {
+	int64_t ttlMs = 30000;		 // how long a status or a listing is trusted, 0 disables the cache
+	size_t maxEntries = 1 << 20;  // per cache, expired entries are dropped first and then everything
+
+	// Overrides the defaults with the env vars BLAZING_METADATA_CACHE_TTL_MS and BLAZING_METADATA_CACHE_ENTRIES
+	static MetadataCacheOptions fromEnvironment();
+};
+
+/**
+ * Values of the metadata of a file system (file statuses, listings) by uri, trusted for a fixed time. Writes done
+ * through FileSystemManager erase the entries they make stale, changes made by other processes are seen once the
+ * entries expire. Thread safe.
+ */
+template <typename Value>
+class MetadataCache {
+public:
+	explicit MetadataCache(const MetadataCacheOptions & options) : options(options), hits(0), misses(0) {}
+
+	bool get(const std::string & key, Value * value) {
+		if(this->options.ttlMs <= 0) {
+			return false;
+		}
+		std::lock_guard<std::mutex> lock(this->mutex);
+		auto it = this->entries.find(key);
+		if(it == this->entries.end() || it->second.expiration <= Clock::now()) {
+			this->misses++;
+			return false;
+		}
+		*value = it->second.value;
+		this->hits++;
+		return true;
+	}
+
+	void put(const std::string & key, const Value & value) {
+		if(this->options.ttlMs <= 0) {
+			return;
+		}
+		const Clock::time_point now = Clock::now();
+		std::lock_guard<std::mutex> lock(this->mutex);
+		if(this->entries.size() >= this->options.maxEntries && this->entries.count(key) == 0) {
+			for(auto it = this->entries.begin(); it != this->entries.end();) {
+				it = it->second.expiration <= now ? this->entries.erase(it) : std::next(it);
+			}
+			if(this->entries.size() >= this->options.maxEntries) {
+				this->entries.clear();
+			}
+		}
+		Entry & entry = this->entries[key];
+		entry.value = value;
+		entry.expiration = now + std::chrono::milliseconds(this->options.ttlMs);
+	}
+
+	// Erases the keys starting with prefix
+	void erasePrefix(const std::string & prefix) {
+		std::lock_guard<std::mutex> lock(this->mutex);
+		auto it = this->entries.lower_bound(prefix);
+		while(it != this->entries.end() && it->first.compare(0, prefix.size(), prefix) == 0) {
+			it = this->entries.erase(it);
+		}
+	}
+
+	template <typename Predicate>
+	void eraseIf(Predicate predicate) {
+		std::lock_guard<std::mutex> lock(this->mutex);
+		for(auto it = this->entries.begin(); it != this->entries.end();) {
+			it = predicate(it->first) ? this->entries.erase(it) : std::next(it);
+		}
+	}
+
+	void clear() {
+		std::lock_guard<std::mutex> lock(this->mutex);
+		this->entries.clear();
+	}
+
+	size_t size() const {
+		std::lock_guard<std::mutex> lock(this->mutex);
+		return this->entries.size();
+	}
+
+	int64_t getHits() const { return hits; }
+	int64_t getMisses() const { return misses; }
+
+private:
+	using Clock = std::chrono::steady_clock;
+
+	struct Entry {
+		Value value;
+		Clock::time_point expiration;
+	};
+
+	const MetadataCacheOptions options;
+	mutable std::mutex mutex;
+	std::map<std::string, Entry> entries;  // ordered, to erase the ones under a directory
+	std::atomic<int64_t> hits;
+	std::atomic<int64_t> misses;
+};
+
+#endif /* SRC_FILESYSTEM_PRIVATE_METADATACACHE_H_ */
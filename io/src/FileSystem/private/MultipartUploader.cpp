@@ -0,0 +1,266 @@
+/*
+ * Copyright 2017 BlazingDB, Inc.
+ */
+
+#include "MultipartUploader.h"
+
+#include <algorithm>
+#include <cstring>
+#include <exception>
+#include <thread>
+
+#include <arrow/memory_pool.h>
+
+#include "Library/Logging/Logger.h"
+#include "Util/EnvUtil.h"
+
+namespace Logging = Library::Logging;
+
+MultipartUploadOptions MultipartUploadOptions::fromEnvironment(const std::string & prefix) {
+	MultipartUploadOptions options;
+	options.partSize = std::max<int64_t>(1, EnvUtil::getInt(prefix + "_UPLOAD_PART_SIZE", options.partSize));
+	options.maxInFlightParts =
+		std::max<int64_t>(1, EnvUtil::getInt(prefix + "_UPLOAD_MAX_IN_FLIGHT_PARTS", options.maxInFlightParts));
+	options.maxBufferedBytes =
+		std::max<int64_t>(0, EnvUtil::getInt(prefix + "_UPLOAD_MAX_BUFFERED_BYTES", options.maxBufferedBytes));
+	return options;
+}
+
+MultipartUploader::MultipartUploader(UploadPartFunction uploadPart,
+	CompleteFunction complete,
+	AbortFunction abort,
+	const MultipartUploadOptions & options,
+	const RetryOptions & retryOptions)
+	: uploadPart(uploadPart), complete(complete), abort(abort), options(options), retryOptions(retryOptions),
+	  currentPartSize(0), nextPartNumber(1), inFlightParts(0), bufferedBytes(0), stopping(false), isClosed(false),
+	  written(0), peakInFlightParts(0), peakBufferedBytes(0) {}
+
+MultipartUploader::~MultipartUploader() {
+	std::unique_lock<std::mutex> lock(this->mutex);
+	if(this->isClosed) {
+		return;
+	}
+	this->isClosed = true;
+	if(this->error.ok()) {
+		this->error = arrow::Status::IOError("The upload was destroyed before being closed");
+	}
+	for(const Part & dropped : this->pending) {
+		this->bufferedBytes -= dropped.data->size();
+	}
+	this->pending.clear();
+	this->waitForUploads(lock);
+	this->stopUploaders(lock);
+	const std::vector<std::string> partTags = this->getPartTags();
+	lock.unlock();
+
+	Logging::Logger().logWarn("MultipartUploader: aborting an upload of " + std::to_string(this->written) +
+							  " bytes that was not closed");
+	this->abort(partTags);
+}
+
+arrow::Status MultipartUploader::Write(const void * data, int64_t nbytes) {
+	const uint8_t * source = static_cast<const uint8_t *>(data);
+	while(nbytes > 0) {
+		{
+			std::lock_guard<std::mutex> lock(this->mutex);
+			if(this->isClosed) {
+				return arrow::Status::Invalid("Operation on closed stream");
+			}
+			ARROW_RETURN_NOT_OK(this->error);
+		}
+
+		// only the writer touches the current part, the uploaders keep going while it is copied
+		if(this->currentPart == nullptr) {
+			ARROW_RETURN_NOT_OK(
+				AllocateResizableBuffer(arrow::default_memory_pool(), this->options.partSize, &this->currentPart));
+			this->currentPartSize = 0;
+		}
+		const int64_t copied = std::min(nbytes, this->options.partSize - this->currentPartSize);
+		std::memcpy(this->currentPart->mutable_data() + this->currentPartSize, source, copied);
+		this->currentPartSize += copied;
+		source += copied;
+		nbytes -= copied;
+
+		std::unique_lock<std::mutex> lock(this->mutex);
+		this->written += copied;
+		if(this->currentPartSize == this->options.partSize) {
+			ARROW_RETURN_NOT_OK(this->submitCurrentPart(lock));
+		}
+	}
+	return arrow::Status::OK();
+}
+
+arrow::Status MultipartUploader::submitCurrentPart(std::unique_lock<std::mutex> & lock) {
+	if(this->currentPart == nullptr) {
+		// an empty object is one empty part
+		ARROW_RETURN_NOT_OK(AllocateResizableBuffer(arrow::default_memory_pool(), 0, &this->currentPart));
+		this->currentPartSize = 0;
+	}
+	if(this->currentPart->size() != this->currentPartSize) {
+		ARROW_RETURN_NOT_OK(this->currentPart->Resize(this->currentPartSize));
+	}
+	std::shared_ptr<arrow::Buffer> data = this->currentPart;
+	this->currentPart.reset();
+	this->currentPartSize = 0;
+
+	// backpressure, a part larger than the budget still goes alone
+	this->changed.wait(lock, [this, &data]() {
+		return !this->error.ok() || this->bufferedBytes == 0 ||
+			   this->bufferedBytes + data->size() <= this->options.maxBufferedBytes;
+	});
+	ARROW_RETURN_NOT_OK(this->error);
+
+	this->pending.push_back(Part{this->nextPartNumber++, data});
+	this->bufferedBytes += data->size();
+	this->peakBufferedBytes = std::max(this->peakBufferedBytes, this->bufferedBytes);
+	if(static_cast<int>(this->uploaders.size()) < this->options.maxInFlightParts) {
+		this->uploaders.emplace_back(&MultipartUploader::uploadPending, this);
+	}
+	this->changed.notify_all();
+	return arrow::Status::OK();
+}
+
+void MultipartUploader::uploadPending() {
+	std::unique_lock<std::mutex> lock(this->mutex);
+	while(true) {
+		this->changed.wait(lock, [this]() { return !this->pending.empty() || this->stopping; });
+		if(this->pending.empty()) {
+			return;
+		}
+		const Part part = this->pending.front();
+		this->pending.pop_front();
+		this->inFlightParts++;
+		this->peakInFlightParts = std::max<int64_t>(this->peakInFlightParts, this->inFlightParts);
+		lock.unlock();
+
+		std::string partTag;
+		const arrow::Status status = this->uploadWithRetries(part, &partTag);
+
+		lock.lock();
+		this->inFlightParts--;
+		this->bufferedBytes -= part.data->size();
+		if(status.ok()) {
+			this->partTags[part.number] = partTag;
+		} else if(this->error.ok()) {
+			// the upload is lost, the parts not started yet are dropped
+			this->error = status;
+			for(const Part & dropped : this->pending) {
+				this->bufferedBytes -= dropped.data->size();
+			}
+			this->pending.clear();
+		}
+		this->changed.notify_all();
+	}
+}
+
+arrow::Status MultipartUploader::uploadWithRetries(const Part & part, std::string * partTag) {
+	for(int attempt = 1;; attempt++) {
+		bool retryable = false;
+		arrow::Status status;
+		try {
+			status = this->uploadPart(part.number, part.data, partTag, &retryable);
+		} catch(const std::exception & e) {
+			status = arrow::Status::IOError(e.what());
+		}
+		if(status.ok()) {
+			return status;
+		}
+		if(!retryable || attempt >= this->retryOptions.maxAttempts) {
+			Logging::Logger().logError("MultipartUploader: part " + std::to_string(part.number) + " failed after " +
+									   std::to_string(attempt) + " attempts: " + status.ToString());
+			return status;
+		}
+
+		const std::chrono::milliseconds backoff = jitteredBackoff(this->retryOptions, attempt);
+		Logging::Logger().logWarn("MultipartUploader: retrying part " + std::to_string(part.number) + " in " +
+								  std::to_string(backoff.count()) + "ms after: " + status.ToString());
+		std::this_thread::sleep_for(backoff);
+	}
+}
+
+void MultipartUploader::waitForUploads(std::unique_lock<std::mutex> & lock) {
+	this->changed.wait(lock, [this]() { return this->pending.empty() && this->inFlightParts == 0; });
+}
+
+void MultipartUploader::stopUploaders(std::unique_lock<std::mutex> & lock) {
+	this->stopping = true;
+	this->changed.notify_all();
+	std::vector<BlazingThread> uploaders = std::move(this->uploaders);
+	this->uploaders.clear();
+	lock.unlock();
+	for(auto & uploader : uploaders) {
+		uploader.join();
+	}
+	lock.lock();
+}
+
+std::vector<std::string> MultipartUploader::getPartTags() const {
+	std::vector<std::string> partTags;
+	for(const auto & partTag : this->partTags) {
+		partTags.push_back(partTag.second);
+	}
+	return partTags;
+}
+
+arrow::Status MultipartUploader::Flush() {
+	std::unique_lock<std::mutex> lock(this->mutex);
+	this->waitForUploads(lock);
+	return this->error;
+}
+
+arrow::Status MultipartUploader::Close() {
+	std::unique_lock<std::mutex> lock(this->mutex);
+	if(this->isClosed) {
+		return arrow::Status::OK();
+	}
+	this->isClosed = true;
+
+	if(this->error.ok() && (this->currentPartSize > 0 || this->nextPartNumber == 1)) {
+		const arrow::Status submitted = this->submitCurrentPart(lock);
+		if(!submitted.ok() && this->error.ok()) {
+			this->error = submitted;
+		}
+	}
+	this->waitForUploads(lock);
+	this->stopUploaders(lock);
+	const std::vector<std::string> partTags = this->getPartTags();
+	const arrow::Status error = this->error;
+	lock.unlock();
+
+	if(!error.ok()) {
+		this->abort(partTags);
+		return error;
+	}
+	const arrow::Status status = this->complete(partTags);
+	if(!status.ok()) {
+		Logging::Logger().logError("MultipartUploader: failed to complete the upload: " + status.ToString());
+		this->abort(partTags);
+	}
+	return status;
+}
+
+arrow::Status MultipartUploader::Tell(int64_t * position) const {
+	std::lock_guard<std::mutex> lock(this->mutex);
+	*position = this->written;
+	return arrow::Status::OK();
+}
+
+bool MultipartUploader::closed() const {
+	std::lock_guard<std::mutex> lock(this->mutex);
+	return this->isClosed;
+}
+
+int64_t MultipartUploader::getUploadedParts() const {
+	std::lock_guard<std::mutex> lock(this->mutex);
+	return this->partTags.size();
+}
+
+int64_t MultipartUploader::getPeakInFlightParts() const {
+	std::lock_guard<std::mutex> lock(this->mutex);
+	return this->peakInFlightParts;
+}
+
+int64_t MultipartUploader::getPeakBufferedBytes() const {
+	std::lock_guard<std::mutex> lock(this->mutex);
+	return this->peakBufferedBytes;
+}
@@ -0,0 +1,114 @@
+/*
+ * Copyright 2017 BlazingDB, Inc.
+ */
+
+#ifndef SRC_FILESYSTEM_PRIVATE_MULTIPARTUPLOADER_H_
+#define SRC_FILESYSTEM_PRIVATE_MULTIPARTUPLOADER_H_
+
+#include <condition_variable>
+#include <cstdint>
+#include <deque>
+#include <functional>
+#include <map>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <vector>
+
+#include "arrow/buffer.h"
+#include "arrow/status.h"
+
+#include "ExceptionHandling/BlazingThread.h"
+#include "RetryPolicy.h"
+
+// Tuning of the uploads done by the object store output streams
+struct MultipartUploadOptions {
+	int64_t partSize = 16 * 1024 * 1024;		   // size of every part but the last one, S3 needs at least 5 MiB
+	int maxInFlightParts = 4;					   // parts uploaded at the same time
+	int64_t maxBufferedBytes = 128 * 1024 * 1024;  // Write blocks while the full parts not uploaded yet hold this much
+
+	// Overrides the defaults with the env vars <prefix>_UPLOAD_PART_SIZE, <prefix>_UPLOAD_MAX_IN_FLIGHT_PARTS and
+	// <prefix>_UPLOAD_MAX_BUFFERED_BYTES (e.g. prefix BLAZING_S3)
+	static MultipartUploadOptions fromEnvironment(const std::string & prefix);
+};
+
+/**
+ * Implements the write side of arrow::io::OutputStream on top of the requests of a multipart upload (e.g. the
+ * UploadPart and CompleteMultipartUpload of S3).
+ *
+ * Write copies into the current part. Full parts are uploaded in the background, up to maxInFlightParts at a time,
+ * and Write blocks while the parts waiting or in flight hold maxBufferedBytes. Parts failing with a retryable error
+ * are retried with jittered backoff as set by the RetryOptions. Once a part fails for good the upload stops, the next
+ * Write or Close returns its error and the uploaded parts are aborted. Close uploads the last part, waits for all of
+ * them and completes the upload.
+ */
+class MultipartUploader {
+public:
+	// Uploads the part partNumber (from 1) and sets the tag the completion needs (e.g. the ETag of the part). Sets
+	// retryable when the failure is transient. Parts are uploaded from several threads at once
+	using UploadPartFunction = std::function<arrow::Status(
+		int partNumber, const std::shared_ptr<arrow::Buffer> & data, std::string * partTag, bool * retryable)>;
+	// Assembles the object from the tags of all its parts, in part order
+	using CompleteFunction = std::function<arrow::Status(const std::vector<std::string> & partTags)>;
+	// Discards the parts of an upload that will never complete
+	using AbortFunction = std::function<void(const std::vector<std::string> & partTags)>;
+
+	MultipartUploader(UploadPartFunction uploadPart,
+		CompleteFunction complete,
+		AbortFunction abort,
+		const MultipartUploadOptions & options = MultipartUploadOptions(),
+		const RetryOptions & retryOptions = RetryOptions());
+	// An upload not closed is aborted
+	~MultipartUploader();
+
+	arrow::Status Write(const void * data, int64_t nbytes);
+	// Waits for the full parts, the current part is uploaded when full or on Close, since parts have a minimum size
+	arrow::Status Flush();
+	arrow::Status Close();
+	arrow::Status Tell(int64_t * position) const;
+	bool closed() const;
+
+	const MultipartUploadOptions & getOptions() const { return options; }
+	int64_t getUploadedParts() const;
+	int64_t getPeakInFlightParts() const;
+	int64_t getPeakBufferedBytes() const;
+
+private:
+	struct Part {
+		int number;
+		std::shared_ptr<arrow::Buffer> data;
+	};
+
+	// Hands the current part to the uploaders, waiting while too many bytes are buffered
+	arrow::Status submitCurrentPart(std::unique_lock<std::mutex> & lock);
+	void uploadPending();
+	arrow::Status uploadWithRetries(const Part & part, std::string * partTag);
+	void waitForUploads(std::unique_lock<std::mutex> & lock);
+	void stopUploaders(std::unique_lock<std::mutex> & lock);
+	std::vector<std::string> getPartTags() const;
+
+	UploadPartFunction uploadPart;
+	CompleteFunction complete;
+	AbortFunction abort;
+	const MultipartUploadOptions options;
+	const RetryOptions retryOptions;
+
+	mutable std::mutex mutex;  // guards everything below
+	std::condition_variable changed;
+	std::shared_ptr<arrow::ResizableBuffer> currentPart;
+	int64_t currentPartSize;
+	int nextPartNumber;
+	std::deque<Part> pending;
+	std::vector<BlazingThread> uploaders;
+	int inFlightParts;
+	int64_t bufferedBytes;  // of the parts pending and in flight
+	std::map<int, std::string> partTags;
+	arrow::Status error;  // of the first part that failed for good
+	bool stopping;
+	bool isClosed;
+	int64_t written;
+	int64_t peakInFlightParts;
+	int64_t peakBufferedBytes;
+};
+
+#endif /* SRC_FILESYSTEM_PRIVATE_MULTIPARTUPLOADER_H_ */
@@ -0,0 +1,260 @@
+/*
+ * Copyright 2017 BlazingDB, Inc.
+ */
+
+#include "RangedReader.h"
+
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <condition_variable>
+#include <cstring>
+#include <deque>
+#include <exception>
+
+#include <arrow/memory_pool.h>
+
+#include "ExceptionHandling/BlazingThread.h"
+#include "Util/EnvUtil.h"
+
+namespace {
+
+// Threads that fetch the parts of the reads of every file, at most MAX_THREADS of them. Like the AttemptThreads of the
+// retry policy, an idle thread is reused instead of starting one per part and threads idle for a while exit. Never
+// destroyed, so a thread finishing a task at exit does not outlive it
+class PartThreads {
+public:
+	static const size_t MAX_THREADS = 64;
+
+	static PartThreads & getInstance() {
+		static PartThreads * instance = new PartThreads();
+		return *instance;
+	}
+
+	// the task may wait in the queue while all the threads are busy
+	void run(std::function<void()> task) {
+		std::lock_guard<std::mutex> lock(this->mutex);
+		this->tasks.push_back(std::move(task));
+		if(this->tasks.size() <= this->idle) {
+			this->available.notify_one();
+		} else if(this->threads < MAX_THREADS) {
+			this->threads++;
+			BlazingThread([this]() { this->work(); }).detach();
+		}
+	}
+
+private:
+	void work() {
+		std::unique_lock<std::mutex> lock(this->mutex);
+		for(;;) {
+			while(!this->tasks.empty()) {
+				std::function<void()> task = std::move(this->tasks.front());
+				this->tasks.pop_front();
+				lock.unlock();
+				task();
+				lock.lock();
+			}
+			this->idle++;
+			const bool woken =
+				this->available.wait_for(lock, std::chrono::seconds(10), [this]() { return !this->tasks.empty(); });
+			this->idle--;
+			if(!woken) {
+				this->threads--;
+				return;
+			}
+		}
+	}
+
+	std::mutex mutex;
+	std::condition_variable available;
+	std::deque<std::function<void()>> tasks;
+	size_t idle = 0;
+	size_t threads = 0;
+};
+
+// The part fetching tasks of one read. The read waits for the tasks that started, the ones still queued when it is
+// done return without touching it
+struct PartHelpers {
+	std::mutex mutex;
+	std::condition_variable finished;
+	bool done = false;
+	int running = 0;
+	std::exception_ptr error;
+};
+
+// Fetches [position, position + nbytes) in parts of options.partSize, up to options.concurrency at a time. The calling
+// thread fetches parts too, so a read makes progress even when all the PartThreads are busy
+arrow::Status fetchInParts(const RangedReader::FetchFunction & fetch,
+	const RangedReadOptions & options,
+	int64_t position,
+	int64_t nbytes,
+	int64_t * bytesRead,
+	uint8_t * out) {
+	if(nbytes <= 0) {
+		*bytesRead = 0;
+		return arrow::Status::OK();
+	}
+	if(nbytes <= options.partSize || options.concurrency <= 1) {
+		return fetch(position, nbytes, bytesRead, out);
+	}
+
+	const int64_t numParts = (nbytes + options.partSize - 1) / options.partSize;
+	std::vector<int64_t> partBytesRead(numParts, 0);
+	std::vector<arrow::Status> partStatus(numParts);
+	std::atomic<int64_t> nextPart(0);
+
+	auto fetchParts = [&]() {
+		for(int64_t part = nextPart++; part < numParts; part = nextPart++) {
+			const int64_t offset = part * options.partSize;
+			const int64_t size = std::min(options.partSize, nbytes - offset);
+			partStatus[part] = fetch(position + offset, size, &partBytesRead[part], out + offset);
+		}
+	};
+
+	const int64_t numTasks = std::min<int64_t>(options.concurrency, numParts) - 1;
+	auto helpers = std::make_shared<PartHelpers>();
+	for(int64_t i = 0; i < numTasks; i++) {
+		PartThreads::getInstance().run([helpers, &fetchParts]() {
+			{
+				std::lock_guard<std::mutex> lock(helpers->mutex);
+				if(helpers->done) {
+					return;
+				}
+				helpers->running++;
+			}
+			std::exception_ptr error;
+			try {
+				fetchParts();
+			} catch(...) {
+				error = std::current_exception();
+			}
+			{
+				std::lock_guard<std::mutex> lock(helpers->mutex);
+				helpers->running--;
+				if(error && !helpers->error) {
+					helpers->error = error;
+				}
+			}
+			helpers->finished.notify_all();
+		});
+	}
+	fetchParts();
+	{
+		std::unique_lock<std::mutex> lock(helpers->mutex);
+		helpers->done = true;
+		helpers->finished.wait(lock, [&helpers]() { return helpers->running == 0; });
+		if(helpers->error) {
+			std::rethrow_exception(helpers->error);
+		}
+	}
+
+	// the object may end inside the range, the parts after the first short one are past the end
+	*bytesRead = 0;
+	for(int64_t part = 0; part < numParts; part++) {
+		if(!partStatus[part].ok()) {
+			return partStatus[part];
+		}
+		*bytesRead += partBytesRead[part];
+		if(partBytesRead[part] < std::min(options.partSize, nbytes - part * options.partSize)) {
+			break;
+		}
+	}
+	return arrow::Status::OK();
+}
+
+}  // namespace
+
+RangedReadOptions RangedReadOptions::fromEnvironment(const std::string & prefix) {
+	RangedReadOptions options;
+	options.partSize = std::max<int64_t>(1, EnvUtil::getInt(prefix + "_READ_PART_SIZE", options.partSize));
+	options.concurrency = std::max<int64_t>(1, EnvUtil::getInt(prefix + "_READ_CONCURRENCY", options.concurrency));
+	options.readAheadSize = std::max<int64_t>(0, EnvUtil::getInt(prefix + "_READ_AHEAD_SIZE", options.readAheadSize));
+	return options;
+}
+
+RangedReader::RangedReader(FetchFunction fetch, const RangedReadOptions & options)
+	: fetch(fetch), options(options), position(0), readAheadPosition(0) {}
+
+arrow::Status RangedReader::Read(int64_t nbytes, int64_t * bytesRead, void * out) {
+	std::lock_guard<std::mutex> lock(this->mutex);
+	uint8_t * destination = static_cast<uint8_t *>(out);
+	int64_t copied = 0;
+
+	const int64_t readAheadEnd = this->readAheadPosition + this->readAhead.size();
+	if(this->position >= this->readAheadPosition && this->position < readAheadEnd) {
+		copied = std::min(nbytes, readAheadEnd - this->position);
+		std::memcpy(destination, this->readAhead.data() + (this->position - this->readAheadPosition), copied);
+	}
+
+	const int64_t remaining = nbytes - copied;
+	if(remaining > 0 && remaining >= this->options.readAheadSize) {
+		// too large to be worth buffering
+		int64_t fetched = 0;
+		const arrow::Status status = fetchInParts(
+			this->fetch, this->options, this->position + copied, remaining, &fetched, destination + copied);
+		if(!status.ok()) {
+			return status;
+		}
+		copied += fetched;
+	} else if(remaining > 0) {
+		int64_t fetched = 0;
+		this->readAhead.resize(this->options.readAheadSize);
+		this->readAheadPosition = this->position + copied;
+		const arrow::Status status = fetchInParts(this->fetch,
+			this->options,
+			this->readAheadPosition,
+			this->options.readAheadSize,
+			&fetched,
+			this->readAhead.data());
+		if(!status.ok()) {
+			this->readAhead.clear();
+			return status;
+		}
+		this->readAhead.resize(fetched);
+		const int64_t served = std::min(remaining, fetched);
+		std::memcpy(destination + copied, this->readAhead.data(), served);
+		copied += served;
+	}
+
+	this->position += copied;
+	*bytesRead = copied;
+	return arrow::Status::OK();
+}
+
+arrow::Status RangedReader::Read(int64_t nbytes, std::shared_ptr<arrow::Buffer> * out) {
+	std::shared_ptr<arrow::ResizableBuffer> buffer;
+	ARROW_RETURN_NOT_OK(AllocateResizableBuffer(arrow::default_memory_pool(), nbytes, &buffer));
+
+	int64_t bytesRead = 0;
+	ARROW_RETURN_NOT_OK(this->Read(nbytes, &bytesRead, buffer->mutable_data()));
+	ARROW_RETURN_NOT_OK(buffer->Resize(bytesRead));
+	*out = buffer;
+	return arrow::Status::OK();
+}
+
+arrow::Status RangedReader::ReadAt(int64_t position, int64_t nbytes, int64_t * bytesRead, void * out) const {
+	return fetchInParts(this->fetch, this->options, position, nbytes, bytesRead, static_cast<uint8_t *>(out));
+}
+
+arrow::Status RangedReader::ReadAt(int64_t position, int64_t nbytes, std::shared_ptr<arrow::Buffer> * out) const {
+	std::shared_ptr<arrow::ResizableBuffer> buffer;
+	ARROW_RETURN_NOT_OK(AllocateResizableBuffer(arrow::default_memory_pool(), nbytes, &buffer));
+
+	int64_t bytesRead = 0;
+	ARROW_RETURN_NOT_OK(this->ReadAt(position, nbytes, &bytesRead, buffer->mutable_data()));
+	ARROW_RETURN_NOT_OK(buffer->Resize(bytesRead));
+	*out = buffer;
+	return arrow::Status::OK();
+}
+
+arrow::Status RangedReader::Seek(int64_t position) {
+	std::lock_guard<std::mutex> lock(this->mutex);
+	this->position = position;
+	return arrow::Status::OK();
+}
+
+arrow::Status RangedReader::Tell(int64_t * position) const {
+	std::lock_guard<std::mutex> lock(this->mutex);
+	*position = this->position;
+	return arrow::Status::OK();
+}
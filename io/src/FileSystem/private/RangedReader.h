@@ -0,0 +1,67 @@
+/*
+ * Copyright 2017 BlazingDB, Inc.
+ */
+
+#ifndef SRC_FILESYSTEM_PRIVATE_RANGEDREADER_H_
+#define SRC_FILESYSTEM_PRIVATE_RANGEDREADER_H_
+
+#include <cstdint>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <vector>
+
+#include "arrow/buffer.h"
+#include "arrow/status.h"
+
+// Tuning of the ranged reads done by the object store readable files
+struct RangedReadOptions {
+	int64_t partSize = 8 * 1024 * 1024;		  // reads larger than this are split in parts fetched in parallel
+	int concurrency = 8;					  // parts of one read fetched at the same time
+	int64_t readAheadSize = 4 * 1024 * 1024;  // minimum fetched by a sequential Read, 0 disables the read-ahead
+
+	// Overrides the defaults with the env vars <prefix>_READ_PART_SIZE, <prefix>_READ_CONCURRENCY and
+	// <prefix>_READ_AHEAD_SIZE (e.g. prefix BLAZING_S3)
+	static RangedReadOptions fromEnvironment(const std::string & prefix);
+};
+
+/**
+ * Implements the read side of arrow::io::RandomAccessFile on top of a function that fetches one byte range (e.g. a
+ * ranged GET).
+ *
+ * ReadAt is thread safe and does not move the position, so readers can fetch several column chunks of one file at
+ * the same time. Read and ReadAt split ranges larger than the part size and fetch the parts in parallel. Read serves
+ * small sequential reads from a read-ahead buffer.
+ */
+class RangedReader {
+public:
+	// Fetches up to nbytes at position into out. bytesRead is only less than nbytes at the end of the object, and a
+	// position at or past the end of the object reads 0 bytes
+	using FetchFunction =
+		std::function<arrow::Status(int64_t position, int64_t nbytes, int64_t * bytesRead, uint8_t * out)>;
+
+	RangedReader(FetchFunction fetch, const RangedReadOptions & options);
+
+	arrow::Status Read(int64_t nbytes, int64_t * bytesRead, void * out);
+	arrow::Status Read(int64_t nbytes, std::shared_ptr<arrow::Buffer> * out);
+
+	arrow::Status ReadAt(int64_t position, int64_t nbytes, int64_t * bytesRead, void * out) const;
+	arrow::Status ReadAt(int64_t position, int64_t nbytes, std::shared_ptr<arrow::Buffer> * out) const;
+
+	arrow::Status Seek(int64_t position);
+	arrow::Status Tell(int64_t * position) const;
+
+	const RangedReadOptions & getOptions() const { return options; }
+
+private:
+	FetchFunction fetch;
+	const RangedReadOptions options;
+
+	mutable std::mutex mutex;  // guards the position and the read-ahead buffer
+	int64_t position;
+	std::vector<uint8_t> readAhead;
+	int64_t readAheadPosition;  // object offset of readAhead[0]
+};
+
+#endif /* SRC_FILESYSTEM_PRIVATE_RANGEDREADER_H_ */
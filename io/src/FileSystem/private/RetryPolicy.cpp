@@ -0,0 +1,356 @@
+/*
+ * Copyright 2017 BlazingDB, Inc.
+ */
+
+#include "RetryPolicy.h"
+
+#include <algorithm>
+#include <chrono>
+#include <condition_variable>
+#include <deque>
+#include <map>
+#include <memory>
+#include <mutex>
+#include <random>
+#include <thread>
+#include <vector>
+
+#include "ExceptionHandling/BlazingThread.h"
+#include "Library/Logging/Logger.h"
+#include "Library/Metrics/MetricsRegistry.h"
+#include "Util/EnvUtil.h"
+
+namespace Logging = Library::Logging;
+
+namespace {
+
+using Clock = std::chrono::steady_clock;
+
+int64_t elapsedMicros(Clock::time_point start) {
+	return std::chrono::duration_cast<std::chrono::microseconds>(Clock::now() - start).count();
+}
+
+// Runs attempt without throwing, so a hedged attempt always reports back
+arrow::Status runAttempt(const AttemptFunction & attempt,
+	int64_t position,
+	int64_t nbytes,
+	int64_t * bytesRead,
+	const OutputFunction & output,
+	bool * retryable) {
+	try {
+		return attempt(position, nbytes, bytesRead, output, retryable);
+	} catch(const std::exception & e) {
+		*bytesRead = 0;
+		*retryable = false;
+		return arrow::Status::IOError(e.what());
+	}
+}
+
+// Threads that run the attempts of the hedged reads. An idle thread is reused instead of starting one per attempt,
+// threads idle for a while exit. Never destroyed, attempts can outlive the reads that started them
+class AttemptThreads {
+public:
+	static AttemptThreads & getInstance() {
+		static AttemptThreads * instance = new AttemptThreads();
+		return *instance;
+	}
+
+	void run(std::function<void()> task) {
+		std::lock_guard<std::mutex> lock(this->mutex);
+		this->tasks.push_back(std::move(task));
+		if(this->tasks.size() <= this->idle) {
+			this->available.notify_one();
+		} else {
+			BlazingThread([this]() { this->work(); }).detach();
+		}
+	}
+
+private:
+	void work() {
+		std::unique_lock<std::mutex> lock(this->mutex);
+		for(;;) {
+			while(!this->tasks.empty()) {
+				std::function<void()> task = std::move(this->tasks.front());
+				this->tasks.pop_front();
+				lock.unlock();
+				task();
+				lock.lock();
+			}
+			this->idle++;
+			const bool woken =
+				this->available.wait_for(lock, std::chrono::seconds(10), [this]() { return !this->tasks.empty(); });
+			this->idle--;
+			if(!woken) {
+				return;
+			}
+		}
+	}
+
+	std::mutex mutex;
+	std::condition_variable available;
+	std::deque<std::function<void()>> tasks;
+	size_t idle = 0;
+};
+
+// The attempts racing for one range. They all write straight to the output of the read, the first one whose
+// response arrives claims it and the others stop without writing
+struct HedgedRace {
+	std::mutex mutex;
+	std::condition_variable finished;
+	uint8_t * out = nullptr;  // reset when the read returns, so the attempts still running never write to it
+	int launched = 0;
+	int finishedAttempts = 0;
+	int writer = -1;  // the attempt writing to out
+	int winner = -1;
+	int64_t bytesRead = 0;
+	arrow::Status status;  // of the last failure
+	bool retryable = true;
+};
+
+class RetryingFetch {
+public:
+	RetryingFetch(AttemptFunction attempt, const RetryOptions & options, RequestLatencyStats & stats)
+		: attempt(attempt), options(options), stats(&stats) {}
+
+	arrow::Status operator()(int64_t position, int64_t nbytes, int64_t * bytesRead, uint8_t * out) const {
+		const Clock::time_point deadline = Clock::now() + std::chrono::milliseconds(this->options.deadlineMs);
+		arrow::Status status;
+
+		for(int attemptNumber = 1;; attemptNumber++) {
+			bool retryable = false;
+			status = this->hedgedAttempt(position, nbytes, bytesRead, out, &retryable);
+			if(status.ok()) {
+				return status;
+			}
+			if(!retryable || attemptNumber >= this->options.maxAttempts) {
+				break;
+			}
+
+			const std::chrono::milliseconds backoff = jitteredBackoff(this->options, attemptNumber);
+			if(Clock::now() + backoff >= deadline) {
+				break;
+			}
+			Logging::Logger().logWarn("Ranged read of " + std::to_string(nbytes) + " bytes at " +
+									  std::to_string(position) + " failed (" + status.ToString() + "), attempt " +
+									  std::to_string(attemptNumber + 1) + " in " + std::to_string(backoff.count()) +
+									  "ms");
+			this->stats->retries++;
+			std::this_thread::sleep_for(backoff);
+		}
+
+		this->stats->failures++;
+		*bytesRead = 0;
+		return status;
+	}
+
+private:
+	// Hedging threshold for a request of nbytes in microseconds, -1 when it should not be hedged
+	int64_t hedgeDelay(int64_t nbytes) const {
+		if(this->options.hedgePercentile <= 0 || this->stats->getSamples(nbytes) < this->options.hedgeMinSamples) {
+			return -1;
+		}
+		return std::max(this->options.hedgeMinDelayMs * 1000,
+			this->stats->latencyPercentile(this->options.hedgePercentile, nbytes));
+	}
+
+	arrow::Status timedAttempt(
+		int64_t position, int64_t nbytes, int64_t * bytesRead, const OutputFunction & output, bool * retryable) const {
+		const Clock::time_point start = Clock::now();
+		this->stats->requests++;
+		const arrow::Status status = runAttempt(this->attempt, position, nbytes, bytesRead, output, retryable);
+		if(status.ok()) {
+			this->stats->recordLatency(nbytes, elapsedMicros(start));
+		}
+		return status;
+	}
+
+	arrow::Status hedgedAttempt(
+		int64_t position, int64_t nbytes, int64_t * bytesRead, uint8_t * out, bool * retryable) const {
+		const int64_t delay = this->hedgeDelay(nbytes);
+		if(delay < 0) {
+			return this->timedAttempt(position, nbytes, bytesRead, [out]() { return out; }, retryable);
+		}
+
+		auto race = std::make_shared<HedgedRace>();
+		race->out = out;
+		RetryingFetch self = *this;
+		auto launch = [race, self, position, nbytes](int contender) {
+			race->launched++;
+			AttemptThreads::getInstance().run([race, self, position, nbytes, contender]() {
+				bool denied = false;
+				auto output = [race, contender, &denied]() -> uint8_t * {
+					std::lock_guard<std::mutex> lock(race->mutex);
+					if(race->out == nullptr || race->winner >= 0 || race->writer >= 0) {
+						denied = true;
+						return nullptr;
+					}
+					race->writer = contender;
+					return race->out;
+				};
+				int64_t bytesRead = 0;
+				bool retryable = false;
+				const arrow::Status status = self.timedAttempt(position, nbytes, &bytesRead, output, &retryable);
+
+				std::lock_guard<std::mutex> lock(race->mutex);
+				race->finishedAttempts++;
+				// an attempt that read nothing (e.g. past the end of the file) answers too, unless another one writes
+				const bool answers = race->writer == contender || (race->writer < 0 && !denied);
+				if(race->writer == contender) {
+					race->writer = -1;
+				}
+				if(status.ok() && answers && race->winner < 0) {
+					race->winner = contender;
+					race->bytesRead = bytesRead;
+				} else if(!status.ok()) {
+					race->status = status;
+					race->retryable = retryable;
+				}
+				race->finished.notify_all();
+			});
+		};
+
+		std::unique_lock<std::mutex> lock(race->mutex);
+		launch(0);
+		auto done = [&race]() { return race->winner >= 0 || race->finishedAttempts == race->launched; };
+		// the hedge is only started when the first attempt is slow
+		if(!race->finished.wait_for(lock, std::chrono::microseconds(delay), done)) {
+			this->stats->hedges++;
+			launch(1);
+		}
+		race->finished.wait(lock, done);
+		race->out = nullptr;
+
+		if(race->winner < 0) {
+			*bytesRead = 0;
+			*retryable = race->retryable;
+			return race->status;
+		}
+		if(race->winner > 0) {
+			this->stats->hedgeWins++;
+		}
+		*bytesRead = race->bytesRead;
+		return arrow::Status::OK();
+	}
+
+	AttemptFunction attempt;
+	RetryOptions options;
+	RequestLatencyStats * stats;
+};
+
+}  // namespace
+
+std::chrono::milliseconds jitteredBackoff(const RetryOptions & options, int failedAttempts) {
+	thread_local std::mt19937_64 generator(std::random_device{}());
+	const int shift = std::min(failedAttempts - 1, 30);
+	const int64_t backoff = std::min(options.maxBackoffMs, options.initialBackoffMs << shift);
+	std::uniform_int_distribution<int64_t> distribution(0, std::max<int64_t>(0, backoff));
+	return std::chrono::milliseconds(distribution(generator));
+}
+
+RetryOptions RetryOptions::fromEnvironment(const std::string & prefix) {
+	RetryOptions options;
+	options.maxAttempts =
+		std::max<int64_t>(1, EnvUtil::getInt(prefix + "_RETRY_MAX_ATTEMPTS", int64_t(options.maxAttempts)));
+	options.initialBackoffMs =
+		std::max<int64_t>(0, EnvUtil::getInt(prefix + "_RETRY_INITIAL_BACKOFF_MS", options.initialBackoffMs));
+	options.maxBackoffMs =
+		std::max<int64_t>(0, EnvUtil::getInt(prefix + "_RETRY_MAX_BACKOFF_MS", options.maxBackoffMs));
+	options.deadlineMs = std::max<int64_t>(0, EnvUtil::getInt(prefix + "_RETRY_DEADLINE_MS", options.deadlineMs));
+	options.hedgePercentile =
+		std::min(1.0, std::max(0.0, EnvUtil::getDouble(prefix + "_HEDGE_PERCENTILE", options.hedgePercentile)));
+	options.hedgeMinDelayMs =
+		std::max<int64_t>(0, EnvUtil::getInt(prefix + "_HEDGE_MIN_DELAY_MS", options.hedgeMinDelayMs));
+	return options;
+}
+
+RequestLatencyStats & RequestLatencyStats::forFileSystem(const std::string & name) {
+	// leaked on purpose, detached hedged requests can still be running at exit
+	static std::mutex * mutex = new std::mutex();
+	static auto * fileSystems = new std::map<std::string, std::unique_ptr<RequestLatencyStats>>();
+
+	std::lock_guard<std::mutex> lock(*mutex);
+	std::unique_ptr<RequestLatencyStats> & stats = (*fileSystems)[name];
+	if(stats == nullptr) {
+		auto & registry = Library::Metrics::MetricsRegistry::getInstance();
+		const Library::Metrics::Labels labels = {{"filesystem", name}};
+		const char * sizeLabels[NUM_SIZE_CLASSES] = {"64KiB", "1MiB", "16MiB", "larger"};
+		Histograms exportedLatencies;
+		for(int size = 0; size < NUM_SIZE_CLASSES; size++) {
+			exportedLatencies[size] = &registry.histogram("blazing_filesystem_request_duration_seconds",
+				"Latency of the ranged read requests to the object stores, hedges included, by request size",
+				{{"filesystem", name}, {"size", sizeLabels[size]}},
+				1e-6);
+		}
+		stats.reset(new RequestLatencyStats(exportedLatencies));
+
+		RequestLatencyStats * exported = stats.get();
+		registry.counterFunction("blazing_filesystem_requests_total",
+			"Ranged read requests sent, hedges included",
+			labels,
+			[exported]() { return double(exported->requests); });
+		registry.counterFunction("blazing_filesystem_request_retries_total",
+			"Ranged read attempts after a failed one",
+			labels,
+			[exported]() { return double(exported->retries); });
+		registry.counterFunction("blazing_filesystem_request_hedges_total",
+			"Duplicate ranged read requests sent because the first one was slow",
+			labels,
+			[exported]() { return double(exported->hedges); });
+		registry.counterFunction("blazing_filesystem_request_failures_total",
+			"Ranged reads that failed after all their attempts",
+			labels,
+			[exported]() { return double(exported->failures); });
+	}
+	return *stats;
+}
+
+RequestLatencyStats::RequestLatencyStats() : ownedHistograms(new Library::Metrics::Histogram[NUM_SIZE_CLASSES]) {
+	for(int size = 0; size < NUM_SIZE_CLASSES; size++) {
+		this->histograms[size] = &this->ownedHistograms[size];
+	}
+}
+
+RequestLatencyStats::RequestLatencyStats(const Histograms & exported) : histograms(exported) {}
+
+int RequestLatencyStats::sizeClass(int64_t nbytes) {
+	if(nbytes <= (64 << 10)) {
+		return 0;
+	} else if(nbytes <= (1 << 20)) {
+		return 1;
+	} else if(nbytes <= (16 << 20)) {
+		return 2;
+	}
+	return 3;
+}
+
+void RequestLatencyStats::recordLatency(int64_t nbytes, int64_t micros) {
+	this->histograms[sizeClass(nbytes)]->record(micros);
+}
+
+int64_t RequestLatencyStats::latencyPercentile(double percentile, int64_t nbytes) const {
+	return this->histograms[sizeClass(nbytes)]->getPercentile(percentile);
+}
+
+int64_t RequestLatencyStats::latencyPercentile(double percentile) const {
+	return Library::Metrics::Histogram::getPercentile(
+		std::vector<const Library::Metrics::Histogram *>(this->histograms.begin(), this->histograms.end()),
+		percentile);
+}
+
+int64_t RequestLatencyStats::getSamples(int64_t nbytes) const {
+	return this->histograms[sizeClass(nbytes)]->getCount();
+}
+
+std::string RequestLatencyStats::toString() const {
+	return "requests=" + std::to_string(this->requests) + " retries=" + std::to_string(this->retries) +
+		   " hedges=" + std::to_string(this->hedges) + " hedge_wins=" + std::to_string(this->hedgeWins) +
+		   " failures=" + std::to_string(this->failures) +
+		   " p50_us=" + std::to_string(this->latencyPercentile(0.5)) +
+		   " p99_us=" + std::to_string(this->latencyPercentile(0.99)) +
+		   " p999_us=" + std::to_string(this->latencyPercentile(0.999));
+}
+
+RangedReader::FetchFunction makeRetryingFetch(
+	AttemptFunction attempt, const RetryOptions & options, RequestLatencyStats & stats) {
+	return RetryingFetch(attempt, options, stats);
+}
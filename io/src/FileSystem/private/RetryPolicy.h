@@ -0,0 +1,105 @@
+/*
+ * Copyright 2017 BlazingDB, Inc.
+ */
+
+#ifndef SRC_FILESYSTEM_PRIVATE_RETRYPOLICY_H_
+#define SRC_FILESYSTEM_PRIVATE_RETRYPOLICY_H_
+
+#include <array>
+#include <atomic>
+#include <chrono>
+#include <cstdint>
+#include <functional>
+#include <memory>
+#include <string>
+
+#include "arrow/status.h"
+
+#include "Library/Metrics/Histogram.h"
+
+#include "RangedReader.h"
+
+// How the object store readable files retry and hedge their ranged reads
+struct RetryOptions {
+	int maxAttempts = 5;			 // attempts of one range, counting the first one
+	int64_t initialBackoffMs = 50;	 // the backoff doubles after every failed attempt, each sleep is a random
+	int64_t maxBackoffMs = 5000;	 // value between 0 and the backoff (full jitter)
+	int64_t deadlineMs = 120000;	 // no attempt starts this long after the first one
+	double hedgePercentile = 0.95;	 // a duplicate request is sent when an attempt takes longer than this percentile
+									 // of the latencies seen for requests of its size, 0 disables the hedging
+	int64_t hedgeMinDelayMs = 10;	 // never hedge earlier than this
+	int64_t hedgeMinSamples = 100;	 // latencies needed before the percentile is trusted
+
+	// Overrides the defaults with the env vars <prefix>_RETRY_MAX_ATTEMPTS, <prefix>_RETRY_INITIAL_BACKOFF_MS,
+	// <prefix>_RETRY_MAX_BACKOFF_MS, <prefix>_RETRY_DEADLINE_MS, <prefix>_HEDGE_PERCENTILE and
+	// <prefix>_HEDGE_MIN_DELAY_MS (e.g. prefix BLAZING_S3)
+	static RetryOptions fromEnvironment(const std::string & prefix);
+};
+
+// Random sleep before the attempt after failedAttempts failed ones: between 0 and
+// min(maxBackoffMs, initialBackoffMs * 2^(failedAttempts - 1)) (full jitter)
+std::chrono::milliseconds jitteredBackoff(const RetryOptions & options, int failedAttempts);
+
+/**
+ * Request counters and latency histograms of one file system (e.g. "s3" or "gcs"), shared by all its files.
+ *
+ * Latencies are kept in a Metrics::Histogram per request size class, since an 8 MiB part is expected to take much
+ * longer than a footer read. Everything is lock free. The stats of the file systems are exported to the
+ * MetricsRegistry, as blazing_filesystem_request_* with a filesystem label, the latencies also with a size label.
+ */
+class RequestLatencyStats {
+public:
+	static const int NUM_SIZE_CLASSES = 4;  // up to 64 KiB, 1 MiB, 16 MiB and larger
+
+	// Never destroyed, so in flight hedged requests can keep using it
+	static RequestLatencyStats & forFileSystem(const std::string & name);
+
+	void recordLatency(int64_t nbytes, int64_t micros);
+
+	// Upper bound of the latency percentile (0 < percentile <= 1) in microseconds, -1 without samples. The first
+	// overload only considers requests of the size class of nbytes
+	int64_t latencyPercentile(double percentile, int64_t nbytes) const;
+	int64_t latencyPercentile(double percentile) const;
+	int64_t getSamples(int64_t nbytes) const;
+
+	std::string toString() const;
+
+	std::atomic<int64_t> requests{0};	 // requests sent, hedges included
+	std::atomic<int64_t> retries{0};	 // attempts after a failed one
+	std::atomic<int64_t> hedges{0};		 // duplicate requests sent because the first one was slow
+	std::atomic<int64_t> hedgeWins{0};	 // hedges that finished before the request they duplicated
+	std::atomic<int64_t> failures{0};	 // reads that failed after all their attempts
+
+	// Not exported, it owns its histograms
+	RequestLatencyStats();
+
+private:
+	using Histograms = std::array<Library::Metrics::Histogram *, NUM_SIZE_CLASSES>;
+
+	// Records in histograms of the MetricsRegistry
+	explicit RequestLatencyStats(const Histograms & exported);
+
+	static int sizeClass(int64_t nbytes);
+
+	std::unique_ptr<Library::Metrics::Histogram[]> ownedHistograms;
+	Histograms histograms;
+};
+
+// Where an attempt writes the bytes it read, called once its response arrived. nullptr when another attempt of the
+// same range already answered the read: the attempt then returns without writing anything
+using OutputFunction = std::function<uint8_t *()>;
+
+// One ranged request. Sets retryable when a failure is transient (throttling, timeouts, 5xx) and worth another
+// attempt. It can be called from several threads and a hedged call can outlive the read that started it, so it must
+// only capture things it owns (e.g. shared_ptrs to the client, copies of the bucket and key) and only write to the
+// buffer returned by output
+using AttemptFunction = std::function<arrow::Status(
+	int64_t position, int64_t nbytes, int64_t * bytesRead, const OutputFunction & output, bool * retryable)>;
+
+// Wraps attempt into a RangedReader fetch that retries with jittered exponential backoff within the attempt and
+// deadline caps, and hedges attempts slower than the options.hedgePercentile latency of stats. With hedging on, stats
+// must outlive the requests, as the ones from forFileSystem do
+RangedReader::FetchFunction makeRetryingFetch(
+	AttemptFunction attempt, const RetryOptions & options, RequestLatencyStats & stats);
+
+#endif /* SRC_FILESYSTEM_PRIVATE_RETRYPOLICY_H_ */
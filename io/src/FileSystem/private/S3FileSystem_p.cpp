@@ -48,6 +48,7 @@
 #include "Util/StringUtil.h"
 
 #include "ExceptionHandling/BlazingThread.h"
+#include <algorithm>
 #include <chrono>
 
 #include "Library/Logging/Logger.h"
@@ -166,6 +167,14 @@ bool S3FileSystem::Private::connect(const FileSystemConnection & fileSystemConne
 	clientConfig.connectTimeoutMs = 60000;
 	clientConfig.requestTimeoutMs = 30000;
 
+	// every read of a file can have readOptions.concurrency GETs in flight and files are read in parallel
+	this->readOptions = RangedReadOptions::fromEnvironment("BLAZING_S3");
+	this->retryOptions = RetryOptions::fromEnvironment("BLAZING_S3");
+	// and every file written has uploadOptions.maxInFlightParts PUTs in flight
+	this->uploadOptions = MultipartUploadOptions::fromEnvironment("BLAZING_S3");
+	clientConfig.maxConnections = std::max<unsigned>(clientConfig.maxConnections,
+		4 * this->readOptions.concurrency + this->uploadOptions.maxInFlightParts);
+
 	this->s3Client = std::make_shared<Aws::S3::S3Client>(credentials, clientConfig);
 
 	// TODO NOTE This code is when we need to support client side encryption (currently only support server side
@@ -310,7 +319,8 @@ FileStatus S3FileSystem::Private::getFileStatus(const Uri & uri) const {
 			const FileStatus fileStatus(uri, FileType::DIRECTORY, contentLength);
 			return fileStatus;
 		} else {
-			const FileStatus fileStatus(uri, FileType::FILE, contentLength);
+			const unsigned long long modificationTime = result.GetLastModified().Millis() * 1000000ULL;
+			const FileStatus fileStatus(uri, FileType::FILE, contentLength, modificationTime, result.GetETag());
 			return fileStatus;
 		}
 	} else {
@@ -348,6 +358,16 @@ FileStatus S3FileSystem::Private::getFileStatus(const Uri & uri) const {
 	}
 }
 
+// Narrows the listing of a folder to the keys a wildcard over full paths can match: the literal prefix of the
+// wildcard when it is inside the folder, e.g. data/year= for /data/year=*/*.parquet
+static std::string getListingPrefix(const Path & folderPath, const std::string & wildcard) {
+	const std::string folder = folderPath.toString(true);
+	const std::string literalPrefix = GlobPattern(wildcard).getLiteralPrefix();
+	const bool insideFolder = folder.back() == '/' && literalPrefix.size() > folder.size() &&
+							  StringUtil::beginsWith(literalPrefix, folder);
+	return insideFolder ? literalPrefix.substr(1) : folder.substr(1);
+}
+
 std::vector<FileStatus> S3FileSystem::Private::list(const Uri & uri, const FileFilter & filter) const {
 	std::vector<FileStatus> response;
 
@@ -384,7 +404,11 @@ std::vector<FileStatus> S3FileSystem::Private::list(const Uri & uri, const FileF
 
 				if(path != folderPath) {
 					const Uri entry(uri.getScheme(), uri.getAuthority(), path);
-					const FileStatus fileStatus(entry, FileType::FILE, s3Object.GetSize());
+					const FileStatus fileStatus(entry,
+						FileType::FILE,
+						s3Object.GetSize(),
+						s3Object.GetLastModified().Millis() * 1000000ULL,
+						s3Object.GetETag());
 					const bool pass = filter(fileStatus);
 
 					if(pass) {
@@ -493,13 +517,14 @@ std::vector<Uri> S3FileSystem::Private::list(const Uri & uri, const std::string
 	Aws::S3::Model::ListObjectsV2Request request;
 	request.WithBucket(bucket);
 	request.WithDelimiter("/");  // NOTE percy since we control how to create files in S3 we should use this convention
-	request.WithPrefix(objectKey);
+	request.WithPrefix(getListingPrefix(folderPath, (uriWithRoot.getPath() + wildcard).toString(true)));
 
 	auto objectsOutcome = this->s3Client->ListObjectsV2(request);
 
 	if(objectsOutcome.IsSuccess()) {
 		const Path wildcardPath = uriWithRoot.getPath() + wildcard;
 		const std::string finalWildcard = wildcardPath.toString(true);
+		const GlobPattern glob(finalWildcard);
 
 		if(this->root.isRoot()) {  // if root is '/' then we don't need to replace the uris to relative paths
 			const Aws::Vector<Aws::S3::Model::Object> objects = objectsOutcome.GetResult().GetContents();
@@ -510,7 +535,7 @@ std::vector<Uri> S3FileSystem::Private::list(const Uri & uri, const std::string
 				const Path path("/" + s3Object.GetKey(), true);  // TODO percy avoid hardcoded string
 
 				if(path != folderPath) {
-					const bool pass = WildcardFilter::match(path.toString(true), finalWildcard);
+					const bool pass = glob.matches(path.toString(true));
 					if(pass) {
 						const Uri entry(uri.getScheme(), uri.getAuthority(), path);
 						response.push_back(entry);
@@ -524,7 +549,7 @@ std::vector<Uri> S3FileSystem::Private::list(const Uri & uri, const std::string
 				// WARNING TODO percy there is no folders concept in S# ... we should change Path::isFile::bool to
 				// Path::ObjectType::Unkwnow,DIR,FILE,SYMLIN,ETC
 				const Path path("/" + s3Folder.GetPrefix(), true);  // TODO percy avoid hardcoded string
-				const bool pass = WildcardFilter::match(path.toString(true), finalWildcard);
+				const bool pass = glob.matches(path.toString(true));
 
 				if(pass) {
 					const Uri entry(uri.getScheme(), uri.getAuthority(), path);
@@ -541,7 +566,7 @@ std::vector<Uri> S3FileSystem::Private::list(const Uri & uri, const std::string
 
 				if(fullPath != folderPath) {
 					const bool pass =
-						WildcardFilter::match(fullPath.toString(true), finalWildcard);  // filter must use the full path
+						glob.matches(fullPath.toString(true));  // filter must use the full path
 
 					if(pass) {
 						const Path relativePath = fullPath.replaceParentPath(uriWithRoot.getPath(), uri.getPath());
@@ -559,7 +584,7 @@ std::vector<Uri> S3FileSystem::Private::list(const Uri & uri, const std::string
 				// Path::ObjectType::Unkwnow,DIR,FILE,SYMLIN,ETC
 				const Path fullPath("/" + s3Folder.GetPrefix(), true);  // TODO percy avoid hardcoded string
 				const bool pass =
-					WildcardFilter::match(fullPath.toString(true), finalWildcard);  // filter must use the full path
+					glob.matches(fullPath.toString(true));  // filter must use the full path
 
 				if(pass) {
 					const Path relativePath = fullPath.replaceParentPath(uriWithRoot.getPath(), uri.getPath());
@@ -608,7 +633,7 @@ std::vector<std::string> S3FileSystem::Private::listResourceNames(
 	Aws::S3::Model::ListObjectsV2Request request;
 	request.WithBucket(bucket);
 	request.WithDelimiter("/");  // NOTE percy since we control how to create files in S3 we should use this convention
-	request.WithPrefix(objectKey);
+	request.WithPrefix(getListingPrefix(folderPath, (uriWithRoot.getPath() + wildcard).toString(true)));
 
 	auto objectsOutcome = this->s3Client->ListObjectsV2(request);
 
@@ -744,6 +769,7 @@ std::vector<std::string> S3FileSystem::Private::listResourceNames(const Uri & ur
 	if(objectsOutcome.IsSuccess()) {
 		const Path wildcardPath = uriWithRoot.getPath() + wildcard;
 		const std::string finalWildcard = wildcardPath.toString(true);
+		const GlobPattern glob(finalWildcard);
 
 		if(this->root.isRoot()) {  // if root is '/' then we don't need to replace the uris to relative paths
 			Aws::Vector<Aws::S3::Model::Object> objects = objectsOutcome.GetResult().GetContents();
@@ -755,7 +781,7 @@ std::vector<std::string> S3FileSystem::Private::listResourceNames(const Uri & ur
 
 				if(path != folderPath) {
 					const Uri entry(uri.getScheme(), uri.getAuthority(), path);
-					const bool pass = WildcardFilter::match(uri.toString(true), finalWildcard);
+					const bool pass = glob.matches(uri.toString(true));
 
 					if(pass) {
 						response.push_back(entry.getPath().getResourceName());
@@ -772,7 +798,7 @@ std::vector<std::string> S3FileSystem::Private::listResourceNames(const Uri & ur
 
 				if(path != folderPath) {
 					const Uri entry(uri.getScheme(), uri.getAuthority(), path);
-					const bool pass = WildcardFilter::match(uri.toString(true), finalWildcard);
+					const bool pass = glob.matches(uri.toString(true));
 
 					if(pass) {
 						response.push_back(entry.getPath().getResourceName());
@@ -790,7 +816,7 @@ std::vector<std::string> S3FileSystem::Private::listResourceNames(const Uri & ur
 				if(fullPath != folderPath) {
 					const Uri fullUri(uri.getScheme(), uri.getAuthority(), fullPath);
 					const bool pass =
-						WildcardFilter::match(fullUri.toString(true), finalWildcard);  // filter must use the full path
+						glob.matches(fullUri.toString(true));  // filter must use the full path
 
 					if(pass) {
 						response.push_back(
@@ -810,7 +836,7 @@ std::vector<std::string> S3FileSystem::Private::listResourceNames(const Uri & ur
 				if(fullPath != folderPath) {
 					const Uri fullUri(uri.getScheme(), uri.getAuthority(), fullPath);
 					const bool pass =
-						WildcardFilter::match(fullUri.toString(true), finalWildcard);  // filter must use the full path
+						glob.matches(fullUri.toString(true));  // filter must use the full path
 
 					if(pass) {
 						response.push_back(
@@ -1083,7 +1109,7 @@ bool S3FileSystem::Private::openReadable(const Uri & uri, std::shared_ptr<S3Read
 	const std::string objectKey = path.toString(true).substr(1, path.toString(true).size());
 	const std::string bucketName = this->getBucketName();
 	// TODO: S3ReadableFile currentl has no validity check add it and throw errors here
-	*file = std::make_shared<S3ReadableFile>(this->s3Client, bucketName, objectKey);
+	*file = std::make_shared<S3ReadableFile>(this->s3Client, bucketName, objectKey, this->readOptions, this->retryOptions);
 	return (*file)->isValid();
 }
 
@@ -1097,7 +1123,8 @@ bool S3FileSystem::Private::openWriteable(const Uri & uri, std::shared_ptr<S3Out
 	const std::string objectKey = path.toString(true).substr(1, path.toString(true).size());
 	const std::string bucketName = this->getBucketName();
 	// TODO: S3Outputstream currentl has no validity check add it and throw errors here
-	*file = std::make_shared<S3OutputStream>(bucketName, objectKey, this->s3Client);
+	*file = std::make_shared<S3OutputStream>(
+		bucketName, objectKey, this->s3Client, this->uploadOptions, this->retryOptions);
 
 	return true;
 }
@@ -66,6 +66,9 @@ private:
 	FileSystemConnection fileSystemConnection;
 	std::shared_ptr<Aws::S3::S3Client> s3Client;
 	std::string regionName;
+	RangedReadOptions readOptions;
+	RetryOptions retryOptions;
+	MultipartUploadOptions uploadOptions;
 };
 
 #endif /* _S3_FILE_SYSTEM_PRIVATE_H_ */
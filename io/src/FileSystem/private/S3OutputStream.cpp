@@ -20,6 +20,7 @@
 #include <aws/s3/model/BucketLocationConstraint.h>
 #include <aws/s3/model/GetBucketLocationRequest.h>
 
+#include <aws/s3/model/AbortMultipartUploadRequest.h>
 #include <aws/s3/model/CompleteMultipartUploadRequest.h>
 #include <aws/s3/model/CreateMultipartUploadRequest.h>
 #include <aws/s3/model/Object.h>
@@ -30,6 +31,7 @@
 
 #include "arrow/buffer.h"
 #include <istream>
+#include <functional>
 #include <streambuf>
 
 #include "ExceptionHandling/BlazingException.h"
@@ -37,30 +39,35 @@
 #include "Library/Logging/Logger.h"
 namespace Logging = Library::Logging;
 
-// TODO: handle the situation when not all data is read
 const Aws::String FAILED_UPLOAD = "failed-upload";
 class S3OutputStream::S3OutputStreamImpl {
 public:
-	//~S3OutputStreamImpl();
-	S3OutputStreamImpl(
-		const std::string & bucketName, const std::string & objectKey, std::shared_ptr<Aws::S3::S3Client> s3Client);
+	S3OutputStreamImpl(const std::string & bucketName,
+		const std::string & objectKey,
+		std::shared_ptr<Aws::S3::S3Client> s3Client,
+		const MultipartUploadOptions & uploadOptions,
+		const RetryOptions & retryOptions);
 
 	arrow::Status close();
 	arrow::Status write(const void * buffer, int64_t nbytes);
-	arrow::Status write(const void * buffer, int64_t nbytes, int64_t * bytes_written);
 	arrow::Status flush();
 	arrow::Status tell(int64_t * position) const;
+	bool closed() const;
 
 private:
+	arrow::Status uploadPart(
+		int partNumber, const std::shared_ptr<arrow::Buffer> & data, std::string * partTag, bool * retryable);
+	arrow::Status completeUpload(const std::vector<std::string> & partTags);
+	void abortUpload();
+
 	std::shared_ptr<Aws::S3::S3Client> s3Client;
 	std::string bucket;
 	std::string key;
 
 	Aws::String uploadId;
 
-	std::vector<Aws::S3::Model::CompletedPart> completedParts;  // just an etag (for response) and a part number
-	size_t currentPart;
-	int64_t written;
+	// last, so an upload not closed is stopped and aborted while the client and the upload id still exist
+	std::unique_ptr<MultipartUploader> uploader;
 };
 
 struct membuf : std::streambuf {
@@ -75,15 +82,15 @@ struct imemstream : virtual membuf, std::iostream {
 		: membuf(base, size), std::iostream(static_cast<std::streambuf *>(this)) {}
 };
 
-S3OutputStream::S3OutputStreamImpl::S3OutputStreamImpl(
-	const std::string & bucketName, const std::string & objectKey, std::shared_ptr<Aws::S3::S3Client> s3Client) {
+S3OutputStream::S3OutputStreamImpl::S3OutputStreamImpl(const std::string & bucketName,
+	const std::string & objectKey,
+	std::shared_ptr<Aws::S3::S3Client> s3Client,
+	const MultipartUploadOptions & uploadOptions,
+	const RetryOptions & retryOptions) {
 	this->bucket = bucketName;
 	this->key = objectKey;
 	this->s3Client = s3Client;
 
-	currentPart = 1;
-	written = 0;
-
 	Aws::S3::Model::CreateMultipartUploadRequest request;
 	request.SetBucket(bucket);
 	request.SetKey(key);
@@ -108,57 +115,46 @@ S3OutputStream::S3OutputStreamImpl::S3OutputStreamImpl(
 		this->uploadId = FAILED_UPLOAD;
 	}
 
-	// start upload here
+	using namespace std::placeholders;
+	this->uploader.reset(new MultipartUploader(std::bind(&S3OutputStreamImpl::uploadPart, this, _1, _2, _3, _4),
+		std::bind(&S3OutputStreamImpl::completeUpload, this, _1),
+		std::bind(&S3OutputStreamImpl::abortUpload, this),
+		uploadOptions,
+		retryOptions));
 }
 
-arrow::Status S3OutputStream::S3OutputStreamImpl::write(const void * buffer, int64_t nbytes) {
+arrow::Status S3OutputStream::S3OutputStreamImpl::uploadPart(
+	int partNumber, const std::shared_ptr<arrow::Buffer> & data, std::string * partTag, bool * retryable) {
 	Aws::S3::Model::UploadPartRequest uploadPartRequest;
 	uploadPartRequest.SetBucket(bucket);
 	uploadPartRequest.SetKey(key);
-	uploadPartRequest.SetPartNumber(currentPart);
+	uploadPartRequest.SetPartNumber(partNumber);
 	uploadPartRequest.SetUploadId(uploadId);
-	// char * tempBuffer = (char *) buffer;
-
-	// std::shared_ptr<imemstream> membuffer =  std::make_shared<imemstream>(new );
-	//   imemstream membuffer((char *) buffer,nbytes);
-
-	//    std::shared_ptr<imemstream> memBufferPtr
-	uploadPartRequest.SetBody(std::make_shared<imemstream>((char *) buffer, nbytes));
-
-	// uploadPart1Request.SetContentMD5(HashingUtils::Base64Encode(md5OfStream));
+	uploadPartRequest.SetBody(std::make_shared<imemstream>((const char *) data->data(), data->size()));
+	uploadPartRequest.SetContentLength(data->size());
 
-	uploadPartRequest.SetContentLength(nbytes);
-
-	written += nbytes;
 	Aws::S3::Model::UploadPartOutcome uploadOutcome = s3Client->UploadPart(uploadPartRequest);
 	if(uploadOutcome.IsSuccess()) {
-		Aws::S3::Model::CompletedPart completedPart;
-		completedPart.SetETag(uploadOutcome.GetResult().GetETag());
-		completedPart.SetPartNumber(currentPart);
-		this->completedParts.push_back(completedPart);
-		currentPart++;
+		*partTag = uploadOutcome.GetResult().GetETag().c_str();
 		return arrow::Status::OK();
-	} else {
-		Logging::Logger().logError("In Write: Uploading part " + std::to_string(currentPart) + " on file " +
-								   this->bucket + "/" + key + ". Problem was " +
-								   uploadOutcome.GetError().GetExceptionName() + " : " +
-								   uploadOutcome.GetError().GetMessage());
-		return arrow::Status::IOError("Had a trouble uploading part " + std::to_string(currentPart) + " on file " +
-									  this->bucket + "/" + key + ". Problem was " +
-									  uploadOutcome.GetError().GetExceptionName() + " : " +
-									  uploadOutcome.GetError().GetMessage());
 	}
-}
 
-arrow::Status S3OutputStream::S3OutputStreamImpl::flush() {
-	// flush is a pass through in all reality
-	// we are making each write send the contents for now for simplicity of design
-	return arrow::Status::OK();
+	*retryable = uploadOutcome.GetError().ShouldRetry();
+	return arrow::Status::IOError("Had a trouble uploading part " + std::to_string(partNumber) + " on file " +
+								  this->bucket + "/" + key + ". Problem was " +
+								  uploadOutcome.GetError().GetExceptionName() + " : " +
+								  uploadOutcome.GetError().GetMessage());
 }
 
-arrow::Status S3OutputStream::S3OutputStreamImpl::close() {
-	// flush the buffer
-	flush();
+arrow::Status S3OutputStream::S3OutputStreamImpl::completeUpload(const std::vector<std::string> & partTags) {
+	Aws::Vector<Aws::S3::Model::CompletedPart> completedParts;
+	for(size_t i = 0; i < partTags.size(); i++) {
+		Aws::S3::Model::CompletedPart completedPart;
+		completedPart.SetETag(partTags[i].c_str());
+		completedPart.SetPartNumber(i + 1);
+		completedParts.push_back(completedPart);
+	}
+
 	Aws::S3::Model::CompleteMultipartUploadRequest completeMultipartUploadRequest;
 
 	completeMultipartUploadRequest.SetBucket(bucket);
@@ -181,16 +177,46 @@ arrow::Status S3OutputStream::S3OutputStreamImpl::close() {
 									  completeMultipartUploadOutcome.GetError().GetExceptionName() + " : " +
 									  completeMultipartUploadOutcome.GetError().GetMessage());
 	}
-	//	s3Client->CompleteMultipartUpload(uploadCompleteRequest);
 }
 
-arrow::Status S3OutputStream::S3OutputStreamImpl::tell(int64_t * position) const { *position = written; }
+void S3OutputStream::S3OutputStreamImpl::abortUpload() {
+	// otherwise the uploaded parts are kept (and billed) until a lifecycle rule removes them
+	Aws::S3::Model::AbortMultipartUploadRequest abortMultipartUploadRequest;
+	abortMultipartUploadRequest.SetBucket(bucket);
+	abortMultipartUploadRequest.SetKey(key);
+	abortMultipartUploadRequest.SetUploadId(uploadId);
+
+	Aws::S3::Model::AbortMultipartUploadOutcome abortMultipartUploadOutcome =
+		s3Client->AbortMultipartUpload(abortMultipartUploadRequest);
+	if(!abortMultipartUploadOutcome.IsSuccess()) {
+		Logging::Logger().logError("Failed to abort the upload of " + this->bucket + "/" + key + ". Problem was " +
+								   abortMultipartUploadOutcome.GetError().GetExceptionName() + " : " +
+								   abortMultipartUploadOutcome.GetError().GetMessage());
+	}
+}
+
+arrow::Status S3OutputStream::S3OutputStreamImpl::write(const void * buffer, int64_t nbytes) {
+	return this->uploader->Write(buffer, nbytes);
+}
+
+arrow::Status S3OutputStream::S3OutputStreamImpl::flush() { return this->uploader->Flush(); }
+
+arrow::Status S3OutputStream::S3OutputStreamImpl::close() { return this->uploader->Close(); }
+
+arrow::Status S3OutputStream::S3OutputStreamImpl::tell(int64_t * position) const {
+	return this->uploader->Tell(position);
+}
+
+bool S3OutputStream::S3OutputStreamImpl::closed() const { return this->uploader->closed(); }
 
 // BEGIN S3OutputStream
 
-S3OutputStream::S3OutputStream(
-	const std::string & bucketName, const std::string & objectKey, std::shared_ptr<Aws::S3::S3Client> s3Client)
-	: impl_(new S3OutputStream::S3OutputStreamImpl(bucketName, objectKey, s3Client)) {}
+S3OutputStream::S3OutputStream(const std::string & bucketName,
+	const std::string & objectKey,
+	std::shared_ptr<Aws::S3::S3Client> s3Client,
+	const MultipartUploadOptions & uploadOptions,
+	const RetryOptions & retryOptions)
+	: impl_(new S3OutputStream::S3OutputStreamImpl(bucketName, objectKey, s3Client, uploadOptions, retryOptions)) {}
 
 S3OutputStream::~S3OutputStream() {}
 
@@ -202,11 +228,6 @@ arrow::Status S3OutputStream::Flush() { return this->impl_->flush(); }
 
 arrow::Status S3OutputStream::Tell(int64_t * position) const { return this->impl_->tell(position); }
 
-bool S3OutputStream::closed() const {
-	// Since every file interaction is a request, then the file is never really open. This function is necesary due to
-	// the Apache Arrow interface starting with v12. Depending on who or what uses this function, we may want this to
-	// always return false??
-	return true;
-}
+bool S3OutputStream::closed() const { return this->impl_->closed(); }
 
 // END S3OutputStream
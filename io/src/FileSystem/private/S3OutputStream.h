@@ -12,10 +12,17 @@
 
 #include "aws/s3/S3Client.h"
 
+#include "MultipartUploader.h"
+#include "RetryPolicy.h"
+
 class S3OutputStream : public arrow::io::OutputStream {
 public:
-	S3OutputStream(
-		const std::string & bucketName, const std::string & objectKey, std::shared_ptr<Aws::S3::S3Client> s3Client);
+	// Full parts of uploadOptions.partSize are uploaded in the background while the next ones are written
+	S3OutputStream(const std::string & bucketName,
+		const std::string & objectKey,
+		std::shared_ptr<Aws::S3::S3Client> s3Client,
+		const MultipartUploadOptions & uploadOptions = MultipartUploadOptions(),
+		const RetryOptions & retryOptions = RetryOptions());
 	~S3OutputStream();
 
 	arrow::Status Close() override;
@@ -26,9 +33,6 @@ public:
 	bool closed() const override;
 
 private:
-	// so we want to store the data that we are writing from there into some
-	// buffer that then gets uploaded  we would like to avoid making allocations
-	// so the buffer can be reusable
 	class S3OutputStreamImpl;
 	std::unique_ptr<S3OutputStreamImpl> impl_;
 
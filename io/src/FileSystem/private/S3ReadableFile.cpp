@@ -8,6 +8,7 @@
 
 #include "aws/s3/model/HeadObjectRequest.h"
 #include <aws/core/Aws.h>
+#include <aws/core/http/HttpResponse.h>
 #include <aws/s3/model/GetObjectRequest.h>
 #include <istream>
 #include <streambuf>
@@ -20,27 +21,89 @@
 #include "Library/Logging/Logger.h"
 namespace Logging = Library::Logging;
 
-// TODO: handle the situation when not all data is read
+namespace {
+
+// One ranged GET, the end of the range is inclusive
+arrow::Status getObjectRange(const Aws::S3::S3Client & s3Client,
+	const std::string & bucketName,
+	const std::string & key,
+	int64_t position,
+	int64_t nbytes,
+	int64_t * bytesRead,
+	const OutputFunction & output,
+	bool * retryable) {
+	Aws::S3::Model::GetObjectRequest object_request;
 
-S3ReadableFile::~S3ReadableFile() {}
+	object_request.SetBucket(bucketName);
+	object_request.SetKey(key);
+	object_request.SetRange("bytes=" + std::to_string(position) + "-" + std::to_string(position + nbytes - 1));
+
+	auto results = s3Client.GetObject(object_request);
+
+	if(!results.IsSuccess()) {
+		*bytesRead = 0;
+		if(results.GetError().GetResponseCode() == Aws::Http::HttpResponseCode::REQUESTED_RANGE_NOT_SATISFIABLE) {
+			// the range starts at or past the end of the object
+			return arrow::Status::OK();
+		}
 
+		// throttling (SlowDown), timeouts and 5xx responses are retryable
+		*retryable = results.GetError().ShouldRetry();
+		if(!*retryable) {
+			Logging::Logger().logError("S3ReadableFile, GetObject failed for bucketName: " + bucketName + " key " +
+									   key + " " + results.GetError().GetExceptionName() + " : " +
+									   results.GetError().GetMessage() + "  SHOULD NOT RETRY");
+		}
+		return arrow::Status::IOError(results.GetError().GetExceptionName() + " : " + results.GetError().GetMessage());
+	}
 
-S3ReadableFile::S3ReadableFile(std::shared_ptr<Aws::S3::S3Client> s3Client, std::string bucketName, std::string key) {
+	uint8_t * out = output();
+	if(out == nullptr) {
+		// another attempt of this range answered first
+		return arrow::Status::OK();
+	}
+	const int64_t contentLength = results.GetResult().GetContentLength();
+	*bytesRead = nbytes < contentLength ? nbytes : contentLength;
+	auto & body = results.GetResult().GetBody();
+	body.read((char *) out, *bytesRead);
+	if(body.gcount() < *bytesRead) {
+		// the connection was dropped in the middle of the body
+		*bytesRead = 0;
+		*retryable = true;
+		return arrow::Status::IOError("S3ReadableFile, the body of " + key + " ended before its content length");
+	}
+	return arrow::Status::OK();
+}
+
+}  // namespace
+
+S3ReadableFile::~S3ReadableFile() {}
+
+S3ReadableFile::S3ReadableFile(std::shared_ptr<Aws::S3::S3Client> s3Client,
+	std::string bucketName,
+	std::string key,
+	const RangedReadOptions & readOptions,
+	const RetryOptions & retryOptions)
+	: reader(makeRetryingFetch(
+				 [s3Client, bucketName, key](int64_t position,
+					 int64_t nbytes,
+					 int64_t * bytesRead,
+					 const OutputFunction & output,
+					 bool * retryable) {
+					 return getObjectRange(*s3Client, bucketName, key, position, nbytes, bytesRead, output, retryable);
+				 },
+				 retryOptions,
+				 RequestLatencyStats::forFileSystem("s3")),
+		  readOptions) {
 	this->key = key;
 	this->bucketName = bucketName;
 	this->s3Client = s3Client;
-	position = 0;
 	valid = true;
 }
 
-arrow::Status S3ReadableFile::Seek(int64_t position) {
-	this->position = position;
-	return arrow::Status::OK();
-}
-arrow::Status S3ReadableFile::Tell(int64_t * position) const {
-	*position = this->position;
-	return arrow::Status::OK();
-}
+arrow::Status S3ReadableFile::Seek(int64_t position) { return this->reader.Seek(position); }
+
+arrow::Status S3ReadableFile::Tell(int64_t * position) const { return this->reader.Tell(position); }
 
 arrow::Status S3ReadableFile::Close() {
 	// because each read is its own request we really dont have to do this
@@ -77,197 +140,19 @@ arrow::Status S3ReadableFile::GetSize(int64_t * size) {
 }
 
 arrow::Status S3ReadableFile::Read(int64_t nbytes, int64_t * bytesRead, void * buffer) {
-	//	std::cout<<"S3ReadableFile::Read " + std::to_string(nbytes)<<std::endl;
-	Aws::S3::Model::GetObjectRequest object_request;
-
-	object_request.SetBucket(bucketName);
-	object_request.SetKey(key);
-	object_request.SetRange("bytes=" + std::to_string(position) + "-" + std::to_string(position + nbytes));
-
-	auto results = this->s3Client->GetObject(object_request);
-
-	if(!results.IsSuccess()) {
-		// TODO: Make bad arrow status here
-		Logging::Logger().logWarn(
-			"S3ReadableFile::Read, GetObject failed for bucketName: " + bucketName + " key " + key);
-		bool shouldRetry = results.GetError().ShouldRetry();
-
-		if(shouldRetry) {
-			Logging::Logger().logTrace("retrying");
-			return this->Read(nbytes, bytesRead, buffer);
-		} else {
-			*bytesRead = 0;
-			Logging::Logger().logError(
-				results.GetError().GetExceptionName() + " : " + results.GetError().GetMessage() + "  SHOULD NOT RETRY");
-		}
-
-		return arrow::Status::IOError(results.GetError().GetExceptionName() + " : " + results.GetError().GetMessage());
-	} else {
-		*bytesRead = results.GetResult().GetContentLength();
-		*bytesRead = nbytes < *bytesRead ? nbytes : *bytesRead;
-		results.GetResult().GetBody().read((char *) buffer, *bytesRead);
-		position += *bytesRead;
-		return arrow::Status::OK();
-	}
+	return this->reader.Read(nbytes, bytesRead, buffer);
 }
 
 arrow::Status S3ReadableFile::Read(int64_t nbytes, std::shared_ptr<arrow::Buffer> * out) {
-	//	std::cout<<"S3ReadableFile::Read " + std::to_string(nbytes)<<std::endl;
-	Aws::S3::Model::GetObjectRequest object_request;
-
-	object_request.SetBucket(bucketName);
-	object_request.SetKey(key);
-	object_request.SetRange("bytes=" + std::to_string(position) + "-" + std::to_string(position + nbytes));
-
-	auto results = this->s3Client->GetObject(object_request);
-
-	if(!results.IsSuccess()) {
-		// TODO: Make bad arrow status here
-
-		Logging::Logger().logWarn(
-			"S3ReadableFile::Read, GetObject failed for bucketName: " + bucketName + " key " + key);
-		bool shouldRetry = results.GetError().ShouldRetry();
-		if(shouldRetry) {
-			Logging::Logger().logTrace("retrying");
-			return this->Read(nbytes, out);
-		} else {
-			Logging::Logger().logError(
-				results.GetError().GetExceptionName() + " : " + results.GetError().GetMessage() + "  SHOULD NOT RETRY");
-		}
-
-		return arrow::Status::IOError(results.GetError().GetExceptionName() + " : " + results.GetError().GetMessage());
-	} else {
-		// old implementation
-		/*
-std::shared_ptr<arrow::ResizableBuffer> buffer;
-AllocateResizableBuffer(arrow::default_memory_pool(), nbytes, &buffer);
-
-int64_t bytesRead = results.GetResult().GetContentLength();
-
-memcpy(buffer->mutable_data(), results.GetResult().GetBody().rdbuf(), bytesRead);
-
-position += bytesRead;
-*out = buffer;
-return arrow::Status::OK();
-*/
-
-		int64_t bytesRead = results.GetResult().GetContentLength();
-		bytesRead = nbytes < bytesRead ? nbytes : bytesRead;
-		position += bytesRead;
-		if(bytesRead < nbytes) {
-			Logging::Logger().logError(
-				"Did not read all the bytes at S3ReadableFile::ReadAt(int64_t position, int64_t nbytes, "
-				"std::shared_ptr<arrow::Buffer>* out)");
-		}
-		//		results.GetResult().GetBody().read((char*)(out->get()->mutable_data()), bytesRead);
-
-		std::shared_ptr<arrow::ResizableBuffer> buffer;
-		AllocateResizableBuffer(arrow::default_memory_pool(), nbytes, &buffer);
-
-		results.GetResult().GetBody().read((char *) (buffer->mutable_data()), bytesRead);
-		*out = buffer;
-
-		return arrow::Status::OK();
-	}
+	return this->reader.Read(nbytes, out);
 }
 
 arrow::Status S3ReadableFile::ReadAt(int64_t position, int64_t nbytes, int64_t * bytesRead, void * buffer) {
-	//	std::cout<<"S3ReadableFile::ReadAt " + std::to_string(nbytes)<<std::endl;
-
-	Aws::S3::Model::GetObjectRequest object_request;
-
-	object_request.SetBucket(bucketName);
-	object_request.SetKey(key);
-	object_request.SetRange("bytes=" + std::to_string(position) + "-" + std::to_string(position + nbytes));
-
-	auto results = this->s3Client->GetObject(object_request);
-
-	if(!results.IsSuccess()) {
-		// TODO: Make bad arrow status here
-
-		Logging::Logger().logWarn(
-			"S3ReadableFile::ReadAt, GetObject failed for bucketName: " + bucketName + " key " + key);
-		bool shouldRetry = results.GetError().ShouldRetry();
-		if(shouldRetry) {
-			Logging::Logger().logTrace("retrying");
-			return this->ReadAt(position, nbytes, bytesRead, buffer);
-		} else {
-			*bytesRead = 0;
-			Logging::Logger().logError(
-				results.GetError().GetExceptionName() + " : " + results.GetError().GetMessage() + "  SHOULD NOT RETRY");
-		}
-
-		return arrow::Status::IOError(results.GetError().GetExceptionName() + " : " + results.GetError().GetMessage());
-	} else {
-		*bytesRead = results.GetResult().GetContentLength();
-		*bytesRead = nbytes < *bytesRead ? nbytes : *bytesRead;
-		this->position = position + *bytesRead;
-		results.GetResult().GetBody().read((char *) buffer, *bytesRead);
-
-		return arrow::Status::OK();
-	}
+	return this->reader.ReadAt(position, nbytes, bytesRead, buffer);
 }
 
 arrow::Status S3ReadableFile::ReadAt(int64_t position, int64_t nbytes, std::shared_ptr<arrow::Buffer> * out) {
-	//	std::cout<<"S3ReadableFile::ReadAt " + std::to_string(nbytes)<<std::endl;
-
-	Aws::S3::Model::GetObjectRequest object_request;
-
-	object_request.SetBucket(bucketName);
-	object_request.SetKey(key);
-	object_request.SetRange("bytes=" + std::to_string(position) + "-" + std::to_string(position + nbytes));
-
-	auto results = this->s3Client->GetObject(object_request);
-
-	if(!results.IsSuccess()) {
-		// TODO: Make bad arrow status here
-
-		Logging::Logger().logWarn(
-			"S3ReadableFile::ReadAt, GetObject failed for bucketName: " + bucketName + " key " + key);
-		bool shouldRetry = results.GetError().ShouldRetry();
-		if(shouldRetry) {
-			Logging::Logger().logTrace("retrying");
-			return this->ReadAt(position, nbytes, out);
-		} else {
-			Logging::Logger().logError(
-				results.GetError().GetExceptionName() + " : " + results.GetError().GetMessage() + "  SHOULD NOT RETRY");
-		}
-
-		return arrow::Status::IOError(results.GetError().GetExceptionName() + " : " + results.GetError().GetMessage());
-	} else {
-		// old implementation
-		/*
-		//byutes read should always be full amount
-		//should almost always be nBytes
-		std::shared_ptr<arrow::ResizableBuffer> buffer;
-		AllocateResizableBuffer(arrow::default_memory_pool(), nbytes, &buffer);
-
-		int64_t bytesRead = nbytes;
-
-		memcpy(buffer->mutable_data(), results.GetResult().GetBody().rdbuf(), bytesRead);
-
-		*out = buffer;
-		return arrow::Status::OK();
-		*/
-
-		int64_t bytesRead = results.GetResult().GetContentLength();
-		bytesRead = nbytes < bytesRead ? nbytes : bytesRead;
-		this->position = position + nbytes;
-		if(bytesRead < nbytes) {
-			Logging::Logger().logError(
-				"Did not read all the bytes at S3ReadableFile::ReadAt(int64_t position, int64_t nbytes, "
-				"std::shared_ptr<arrow::Buffer>* out)");
-		}
-		//		results.GetResult().GetBody().read((char*)(out->get()->mutable_data()), bytesRead);
-
-		std::shared_ptr<arrow::ResizableBuffer> buffer;
-		AllocateResizableBuffer(arrow::default_memory_pool(), nbytes, &buffer);
-
-		results.GetResult().GetBody().read((char *) (buffer->mutable_data()), bytesRead);
-		*out = buffer;
-
-		return arrow::Status::OK();
-	}
+	return this->reader.ReadAt(position, nbytes, out);
 }
 
 bool S3ReadableFile::supports_zero_copy() const { return false; }
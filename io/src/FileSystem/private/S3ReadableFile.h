@@ -12,9 +12,18 @@
 #include <aws/core/utils/memory/stl/AWSString.h>
 #include <aws/s3/S3Client.h>
 
+#include "RangedReader.h"
+#include "RetryPolicy.h"
+
+// Every read is one or more ranged GETs, see RangedReader, retried and hedged as set by the RetryOptions. ReadAt can
+// be called from several threads at once.
 class S3ReadableFile : public arrow::io::RandomAccessFile {
 public:
-	S3ReadableFile(std::shared_ptr<Aws::S3::S3Client> s3Client, std::string bucket, std::string key);
+	S3ReadableFile(std::shared_ptr<Aws::S3::S3Client> s3Client,
+		std::string bucket,
+		std::string key,
+		const RangedReadOptions & readOptions = RangedReadOptions(),
+		const RetryOptions & retryOptions = RetryOptions());
 	~S3ReadableFile();
 
 	arrow::Status Close() override;
@@ -42,7 +51,7 @@ private:
 	std::shared_ptr<Aws::S3::S3Client> s3Client;
 	std::string bucketName;
 	std::string key;
-	size_t position;
+	RangedReader reader;
 	bool valid;
 
 	ARROW_DISALLOW_COPY_AND_ASSIGN(S3ReadableFile);
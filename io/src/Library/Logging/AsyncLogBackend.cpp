@@ -0,0 +1,185 @@
+#include "Library/Logging/AsyncLogBackend.h"
+#include "Library/Logging/GenericOutput.h"
+#include <cstdlib>
+#include <cstring>
+#include <ctime>
+#include <iostream>
+#include <time.h>
+
+namespace Library {
+namespace Logging {
+AsyncLogOptions AsyncLogOptions::fromEnvironment() {
+	AsyncLogOptions options;
+	const char * capacity = std::getenv("BLAZING_LOG_QUEUE_CAPACITY");
+	if(capacity != nullptr && std::strtoll(capacity, nullptr, 10) > 0) {
+		options.capacity = std::strtoll(capacity, nullptr, 10);
+	}
+	const char * overflowPolicy = std::getenv("BLAZING_LOG_OVERFLOW_POLICY");
+	if(overflowPolicy != nullptr && std::string(overflowPolicy) == "block") {
+		options.overflowPolicy = LogOverflowPolicy::BLOCK;
+	}
+	return options;
+}
+
+AsyncLogBackend::AsyncLogBackend(GenericOutput * sink, const AsyncLogOptions & options)
+	: options(options), ring(options.capacity), sink(sink), writerIdle(false), stopping(false), writtenRecords(0),
+	  dropped(0), reportedDropped(0), lastNodeInd(0), cachedSecond(-1) {
+	writer = std::thread(&AsyncLogBackend::run, this);
+}
+
+AsyncLogBackend::~AsyncLogBackend() {
+	{
+		std::unique_lock<std::mutex> lock(mutex);
+		stopping = true;
+		wake.notify_one();
+	}
+	if(writer.joinable()) {
+		writer.join();
+	}
+	delete sink;
+}
+
+void AsyncLogBackend::push(LogRecord && record) {
+	if(ring.tryPush(std::move(record))) {
+		// without a lock the writer can miss this and find the record after idleWait
+		if(writerIdle.load()) {
+			wakeWriter();
+		}
+		return;
+	}
+
+	if(options.overflowPolicy == LogOverflowPolicy::DROP) {
+		dropped.fetch_add(1, std::memory_order_relaxed);
+		return;
+	}
+	while(!ring.tryPush(std::move(record))) {
+		wakeWriter();
+		std::this_thread::yield();
+	}
+}
+
+void AsyncLogBackend::flush() {
+	if(std::this_thread::get_id() == writer.get_id()) {
+		return;  // a sink logging, it would wait for itself
+	}
+	const size_t pushed = ring.getPushed();
+	std::unique_lock<std::mutex> lock(mutex);
+	wake.notify_one();
+	written.wait(lock, [this, pushed]() { return writtenRecords.load() >= pushed; });
+}
+
+void AsyncLogBackend::setSink(GenericOutput * value) {
+	flush();
+	std::unique_lock<std::mutex> lock(sinkMutex);
+	if(sink != value) {
+		delete sink;
+		sink = value;
+	}
+}
+
+std::time_t AsyncLogBackend::coarseNow() {
+#ifdef CLOCK_REALTIME_COARSE
+	struct timespec now;
+	if(clock_gettime(CLOCK_REALTIME_COARSE, &now) == 0) {
+		return now.tv_sec;
+	}
+#endif
+	return std::time(nullptr);
+}
+
+void AsyncLogBackend::wakeWriter() { wake.notify_one(); }
+
+void AsyncLogBackend::run() {
+	while(true) {
+		if(writeBatch() > 0) {
+			continue;
+		}
+		// a push claimed but not finished yet keeps the writer going
+		if(stopping && ring.getPopped() == ring.getPushed()) {
+			break;
+		}
+
+		std::unique_lock<std::mutex> lock(mutex);
+		writerIdle = true;
+		wake.wait_for(lock, options.idleWait, [this]() { return stopping || ring.getPopped() != ring.getPushed(); });
+		writerIdle = false;
+	}
+}
+
+size_t AsyncLogBackend::writeBatch() {
+	batch.clear();
+
+	size_t lines = 0;
+	const uint64_t droppedNow = dropped.load(std::memory_order_relaxed);
+	if(droppedNow != reportedDropped) {
+		LogRecord report;
+		report.time = coarseNow();
+		report.nodeInd = lastNodeInd;
+		report.level = "WARN";
+		report.message = "AsyncLogBackend: " + std::to_string(droppedNow - reportedDropped) +
+						 " log records were dropped because the log queue was full";
+		format(report, batch);
+		reportedDropped = droppedNow;
+		lines++;
+	}
+
+	size_t records = 0;
+	LogRecord record;
+	while(batch.size() < options.maxBatchBytes && ring.tryPop(record)) {
+		format(record, batch);
+		records++;
+	}
+	if(batch.empty()) {
+		return 0;
+	}
+
+	{
+		std::unique_lock<std::mutex> lock(sinkMutex);
+		try {
+			if(sink != nullptr) {
+				sink->write(batch);
+			}
+		} catch(const std::exception & e) {
+			std::cerr << "AsyncLogBackend: failed to write " << records << " log records: " << e.what() << std::endl;
+		}
+	}
+
+	if(records > 0) {
+		writtenRecords.fetch_add(records);
+		{ std::unique_lock<std::mutex> lock(mutex); }
+		written.notify_all();
+	}
+	return lines + records;
+}
+
+void AsyncLogBackend::format(const LogRecord & record, std::string & out) {
+	if(record.level == nullptr) {
+		out += record.message;
+		out += '\n';
+		return;
+	}
+
+	lastNodeInd = record.nodeInd;
+	if(!record.datetime.empty()) {
+		out += record.datetime;
+	} else {
+		if(record.time != cachedSecond) {
+			struct tm local;
+			char datetime[32];
+			localtime_r(&record.time, &local);
+			std::strftime(datetime, sizeof(datetime), "%FT%TZ", &local);
+			cachedDatetime = datetime;
+			cachedSecond = record.time;
+		}
+		out += cachedDatetime;
+	}
+	out += '|';
+	out += std::to_string(record.nodeInd);
+	out += '|';
+	out += record.level;
+	out += '|';
+	out += record.message;
+	out += '\n';
+}
+}  // namespace Logging
+}  // namespace Library
@@ -0,0 +1,104 @@
+#ifndef SRC_LIBRARY_LOGGING_ASYNCLOGBACKEND_H_
+#define SRC_LIBRARY_LOGGING_ASYNCLOGBACKEND_H_
+
+#include "Library/Logging/LogRingBuffer.h"
+#include <atomic>
+#include <chrono>
+#include <condition_variable>
+#include <cstdint>
+#include <mutex>
+#include <string>
+#include <thread>
+
+namespace Library {
+namespace Logging {
+class GenericOutput;
+
+// What a log call does when the queue is full
+enum class LogOverflowPolicy {
+	DROP,  // the record is dropped and counted, the writer logs how many were dropped
+	BLOCK  // the call waits for the writer to make room
+};
+
+struct AsyncLogOptions {
+	size_t capacity = 64 * 1024;					 // records queued, rounded up to a power of two
+	size_t maxBatchBytes = 1024 * 1024;				 // the writer hands the sink batches up to this size
+	std::chrono::milliseconds idleWait{20};			 // the writer sleeps up to this long when there is nothing to write
+	LogOverflowPolicy overflowPolicy = LogOverflowPolicy::DROP;
+
+	// Overrides the defaults with the env vars BLAZING_LOG_QUEUE_CAPACITY and BLAZING_LOG_OVERFLOW_POLICY (drop or
+	// block)
+	static AsyncLogOptions fromEnvironment();
+};
+
+/**
+ * Log calls push their record in a LogRingBuffer without locks and return, a background writer pops the records,
+ * formats them and hands them to the sink (a GenericOutput) in batches, so the sink is flushed once per batch instead
+ * of once per line. Records only carry the coarse wall clock second, the writer formats each second once.
+ */
+class AsyncLogBackend {
+public:
+	// takes ownership of the sink
+	AsyncLogBackend(GenericOutput * sink, const AsyncLogOptions & options = AsyncLogOptions());
+
+	// writes what is queued, then stops the writer and deletes the sink
+	~AsyncLogBackend();
+
+	AsyncLogBackend(const AsyncLogBackend &) = delete;
+
+	AsyncLogBackend & operator=(const AsyncLogBackend &) = delete;
+
+public:
+	void push(LogRecord && record);
+
+	// waits until the records pushed before are written
+	void flush();
+
+	// writes the queued records to the current sink, then replaces and deletes it
+	void setSink(GenericOutput * sink);
+
+	uint64_t getDroppedRecords() const { return dropped.load(std::memory_order_relaxed); }
+
+	const AsyncLogOptions & getOptions() const { return options; }
+
+	// the wall clock in seconds, as cheap as the kernel allows
+	static std::time_t coarseNow();
+
+private:
+	void run();
+
+	// pops up to maxBatchBytes and writes them, returns the number of records written
+	size_t writeBatch();
+
+	void format(const LogRecord & record, std::string & out);
+
+	void wakeWriter();
+
+private:
+	const AsyncLogOptions options;
+	LogRingBuffer ring;
+
+	std::mutex sinkMutex;  // held while writing, guards sink
+	GenericOutput * sink;
+
+	std::mutex mutex;  // guards the waits below
+	std::condition_variable wake;
+	std::condition_variable written;
+	std::atomic<bool> writerIdle;
+	std::atomic<bool> stopping;
+	std::atomic<size_t> writtenRecords;  // positions of the ring popped and written
+	std::atomic<uint64_t> dropped;
+
+	// only used by the writer
+	uint64_t reportedDropped;
+	int lastNodeInd;
+	std::time_t cachedSecond;
+	std::string cachedDatetime;
+	std::string batch;
+
+	std::thread writer;
+};
+}  // namespace Logging
+}  // namespace Library
+
+#endif
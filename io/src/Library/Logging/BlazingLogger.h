@@ -59,7 +59,7 @@ public:
 	void logFatal(const std::string & logdata);
 
 private:
-	void buildLogData(LoggingLevel level, const std::string & logdata);
+	void buildLogData(LoggingLevel level, std::string logdata);
 
 	void sendDataToService(const std::string & logdata);
 };
@@ -24,6 +24,11 @@ void CoutOutput::flush(
 	std::cout << datetime << "|" << nodeInd << "|" << level << "|" << log << std::endl;
 }
 
+void CoutOutput::write(const std::string & lines) {
+	std::unique_lock<std::mutex> lock(mutex);
+	std::cout << lines << std::flush;
+}
+
 // void CoutOutput::setNodeIdentifier(const unsigned int nodeInd){
 // 	Logging::Logger().logInfo("Node index is " + std::to_string(nodeInd));
 // }
@@ -44,6 +44,12 @@ void FileOutput::flush(
 	file << datetime << "|" << nodeInd << "|" << level << "|" << log << std::endl;
 }
 
+void FileOutput::write(const std::string & lines) {
+	std::unique_lock<std::mutex> lock(mutex);
+	file << lines;
+	file.flush();
+}
+
 // void FileOutput::setNodeIdentifier(const unsigned int nodeInd){
 // 	Logging::Logger().logInfo("Node index is " + std::to_string(nodeInd));
 // }
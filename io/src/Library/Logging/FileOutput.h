@@ -30,6 +30,8 @@ public:
 	void flush(
 		const int nodeInd, const std::string & datetime, const std::string & level, const std::string & log) override;
 
+	void write(const std::string & lines) override;
+
 	// void setNodeIdentifier(const unsigned int nodeInd) override;
 
 private:
@@ -16,6 +16,9 @@ public:
 	virtual void flush(
 		const int nodeInd, const std::string & datetime, const std::string & level, const std::string & log) = 0;
 
+	// a batch of formatted lines, each one ending in '\n', written by the AsyncLogBackend writer
+	virtual void write(const std::string & lines) = 0;
+
 	// virtual void setNodeIdentifier(const unsigned int nodeInd) = 0;
 };
 }  // namespace Logging
@@ -0,0 +1,66 @@
+#include "Library/Logging/LogRingBuffer.h"
+
+namespace Library {
+namespace Logging {
+namespace {
+size_t roundUpToPowerOfTwo(size_t value) {
+	size_t power = 2;
+	while(power < value) {
+		power <<= 1;
+	}
+	return power;
+}
+}  // namespace
+
+LogRingBuffer::LogRingBuffer(size_t capacity)
+	: mask(roundUpToPowerOfTwo(capacity) - 1), cells(new Cell[mask + 1]), enqueuePosition(0), dequeuePosition(0) {
+	for(size_t position = 0; position <= mask; position++) {
+		cells[position].sequence.store(position, std::memory_order_relaxed);
+	}
+}
+
+bool LogRingBuffer::tryPush(LogRecord && record) {
+	size_t position = enqueuePosition.load(std::memory_order_relaxed);
+	Cell * cell;
+	while(true) {
+		cell = &cells[position & mask];
+		const size_t sequence = cell->sequence.load(std::memory_order_acquire);
+		const std::ptrdiff_t difference = static_cast<std::ptrdiff_t>(sequence - position);
+		if(difference == 0) {
+			if(enqueuePosition.compare_exchange_weak(position, position + 1, std::memory_order_relaxed)) {
+				break;
+			}
+		} else if(difference < 0) {
+			return false;  // the cell still holds the record pushed one lap ago
+		} else {
+			position = enqueuePosition.load(std::memory_order_relaxed);
+		}
+	}
+	cell->record = std::move(record);
+	cell->sequence.store(position + 1, std::memory_order_release);
+	return true;
+}
+
+bool LogRingBuffer::tryPop(LogRecord & record) {
+	size_t position = dequeuePosition.load(std::memory_order_relaxed);
+	Cell * cell;
+	while(true) {
+		cell = &cells[position & mask];
+		const size_t sequence = cell->sequence.load(std::memory_order_acquire);
+		const std::ptrdiff_t difference = static_cast<std::ptrdiff_t>(sequence - (position + 1));
+		if(difference == 0) {
+			if(dequeuePosition.compare_exchange_weak(position, position + 1, std::memory_order_relaxed)) {
+				break;
+			}
+		} else if(difference < 0) {
+			return false;  // empty, or the push of this position did not finish yet
+		} else {
+			position = dequeuePosition.load(std::memory_order_relaxed);
+		}
+	}
+	record = std::move(cell->record);
+	cell->sequence.store(position + mask + 1, std::memory_order_release);
+	return true;
+}
+}  // namespace Logging
+}  // namespace Library
@@ -0,0 +1,64 @@
+#ifndef SRC_LIBRARY_LOGGING_LOGRINGBUFFER_H_
+#define SRC_LIBRARY_LOGGING_LOGRINGBUFFER_H_
+
+#include <atomic>
+#include <cstddef>
+#include <ctime>
+#include <memory>
+#include <string>
+
+namespace Library {
+namespace Logging {
+struct LogRecord {
+	std::time_t time = 0;		   // coarse wall clock, formatted by the writer
+	int nodeInd = 0;
+	const char * level = nullptr;  // null for the lines logged as they are
+	std::string datetime;		   // when the caller formatted it already
+	std::string message;
+};
+
+/**
+ * Bounded queue of log records that many threads push to and the writer pops from without locks. Every cell has a
+ * sequence number telling whether it is free for the push of a position or filled for its pop, so a push only claims
+ * a position with one compare and swap and moves the record in.
+ */
+class LogRingBuffer {
+public:
+	// the capacity is rounded up to a power of two
+	explicit LogRingBuffer(size_t capacity);
+
+	LogRingBuffer(const LogRingBuffer &) = delete;
+
+	LogRingBuffer & operator=(const LogRingBuffer &) = delete;
+
+public:
+	// moves the record in, false when the queue is full and then the record is left as it was
+	bool tryPush(LogRecord && record);
+
+	bool tryPop(LogRecord & record);
+
+	// positions claimed by the pushes and the pops so far
+	size_t getPushed() const { return enqueuePosition.load(std::memory_order_acquire); }
+
+	size_t getPopped() const { return dequeuePosition.load(std::memory_order_acquire); }
+
+	size_t getCapacity() const { return mask + 1; }
+
+private:
+	struct Cell {
+		std::atomic<size_t> sequence;
+		LogRecord record;
+	};
+
+	const size_t mask;
+	std::unique_ptr<Cell[]> cells;
+	// padded so the pushes and the pops do not share a cache line (alignas on heap objects needs C++17)
+	char enqueuePadding[64];
+	std::atomic<size_t> enqueuePosition;
+	char dequeuePadding[64 - sizeof(std::atomic<size_t>)];
+	std::atomic<size_t> dequeuePosition;
+};
+}  // namespace Logging
+}  // namespace Library
+
+#endif
@@ -2,6 +2,7 @@
 #define SRC_LIBRARY_LOGGING_LOGGER_H_
 
 #include "Library/Logging/BlazingLogger.h"
+#include "Library/Logging/LoggingLevel.h"
 
 namespace Library {
 namespace Logging {
@@ -9,4 +10,39 @@ BlazingLogger Logger();
 }
 }  // namespace Library
 
+// The message is only built when its level is enabled, e.g.
+//   BLAZING_LOG_INFO(timer.logDuration(context, "step"));
+// does not call logDuration when INFO is below the logging level.
+#define BLAZING_LOG(level, method, ...)                                                                                \
+	do {                                                                                                               \
+		if(::Library::Logging::isLoggingLevelEnabled(level)) {                                                         \
+			::Library::Logging::Logger().method(__VA_ARGS__);                                                          \
+		}                                                                                                              \
+	} while(0)
+
+// Defining BLAZING_LOG_STRIP_TRACE_DEBUG compiles the TRACE and DEBUG statements out, their messages still have to
+// compile so the variables they use are not reported as unused
+#ifdef BLAZING_LOG_STRIP_TRACE_DEBUG
+#define BLAZING_LOG_TRACE(...)                                                                                         \
+	do {                                                                                                               \
+		if(false) {                                                                                                    \
+			::Library::Logging::Logger().logTrace(__VA_ARGS__);                                                        \
+		}                                                                                                              \
+	} while(0)
+#define BLAZING_LOG_DEBUG(...)                                                                                         \
+	do {                                                                                                               \
+		if(false) {                                                                                                    \
+			::Library::Logging::Logger().logDebug(__VA_ARGS__);                                                        \
+		}                                                                                                              \
+	} while(0)
+#else
+#define BLAZING_LOG_TRACE(...) BLAZING_LOG(::Library::Logging::LoggingLevel::TRACE, logTrace, __VA_ARGS__)
+#define BLAZING_LOG_DEBUG(...) BLAZING_LOG(::Library::Logging::LoggingLevel::DEBUG, logDebug, __VA_ARGS__)
+#endif
+
+#define BLAZING_LOG_INFO(...) BLAZING_LOG(::Library::Logging::LoggingLevel::INFO, logInfo, __VA_ARGS__)
+#define BLAZING_LOG_WARN(...) BLAZING_LOG(::Library::Logging::LoggingLevel::WARN, logWarn, __VA_ARGS__)
+#define BLAZING_LOG_ERROR(...) BLAZING_LOG(::Library::Logging::LoggingLevel::ERROR, logError, __VA_ARGS__)
+#define BLAZING_LOG_FATAL(...) BLAZING_LOG(::Library::Logging::LoggingLevel::FATAL, logFatal, __VA_ARGS__)
+
 #endif
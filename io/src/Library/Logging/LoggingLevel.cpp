@@ -1,7 +1,32 @@
 #include "Library/Logging/LoggingLevel.h"
+#include <cstdlib>
+#include <string>
 
 namespace Library {
 namespace Logging {
+namespace {
+int initialSeverity() {
+	const char * value = std::getenv("BLAZING_LOG_LEVEL");
+	if(value != nullptr) {
+		for(LoggingLevel level : {LoggingLevel::TRACE,
+				LoggingLevel::DEBUG,
+				LoggingLevel::INFO,
+				LoggingLevel::WARN,
+				LoggingLevel::ERROR,
+				LoggingLevel::FATAL}) {
+			if(std::string(value) == getLevelName(level)) {
+				return getLevelSeverity(level);
+			}
+		}
+	}
+	return getLevelSeverity(LoggingLevel::INFO);
+}
+}  // namespace
+
+namespace detail {
+std::atomic<int> minimumSeverity(initialSeverity());
+}  // namespace detail
+
 const char * getLevelName(LoggingLevel level) {
 	switch(level) {
 	case LoggingLevel::INFO: return "INFO";
@@ -13,5 +38,18 @@ const char * getLevelName(LoggingLevel level) {
 	}
 	return "";
 }
+
+void setLoggingLevel(LoggingLevel level) { detail::minimumSeverity = getLevelSeverity(level); }
+
+LoggingLevel getLoggingLevel() {
+	switch(detail::minimumSeverity.load()) {
+	case 0: return LoggingLevel::TRACE;
+	case 1: return LoggingLevel::DEBUG;
+	case 2: return LoggingLevel::INFO;
+	case 3: return LoggingLevel::WARN;
+	case 4: return LoggingLevel::ERROR;
+	}
+	return LoggingLevel::FATAL;
+}
 }  // namespace Logging
 }  // namespace Library
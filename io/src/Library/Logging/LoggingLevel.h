@@ -1,11 +1,37 @@
 #ifndef SRC_LIBRARY_LOGGING_LOGGINGLEVEL_H_
 #define SRC_LIBRARY_LOGGING_LOGGINGLEVEL_H_
 
+#include <atomic>
+
 namespace Library {
 namespace Logging {
 enum class LoggingLevel { INFO, WARN, TRACE, DEBUG, ERROR, FATAL };
 
 const char * getLevelName(LoggingLevel level);
+
+// TRACE < DEBUG < INFO < WARN < ERROR < FATAL
+constexpr int getLevelSeverity(LoggingLevel level) {
+	return level == LoggingLevel::TRACE
+			   ? 0
+			   : level == LoggingLevel::DEBUG
+					 ? 1
+					 : level == LoggingLevel::INFO ? 2
+												   : level == LoggingLevel::WARN ? 3 : level == LoggingLevel::ERROR ? 4 : 5;
+}
+
+namespace detail {
+extern std::atomic<int> minimumSeverity;
+}  // namespace detail
+
+// The levels below this one are discarded, INFO unless the env var BLAZING_LOG_LEVEL names another level
+void setLoggingLevel(LoggingLevel level);
+
+LoggingLevel getLoggingLevel();
+
+// what the BLAZING_LOG_* macros check before building the message
+inline bool isLoggingLevelEnabled(LoggingLevel level) {
+	return getLevelSeverity(level) >= detail::minimumSeverity.load(std::memory_order_relaxed);
+}
 }  // namespace Logging
 }  // namespace Library
 
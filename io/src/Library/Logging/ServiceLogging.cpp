@@ -1,45 +1,60 @@
 #include "Library/Logging/ServiceLogging.h"
 #include "CoutOutput.h"
+#include "Library/Logging/AsyncLogBackend.h"
 #include "Library/Logging/GenericOutput.h"
 #include <stdlib.h>
 
 namespace Library {
 namespace Logging {
 ServiceLogging::ServiceLogging() {
-	auto value = new Library::Logging::CoutOutput();
-	this->output = value;
+	this->backend.reset(new AsyncLogBackend(new Library::Logging::CoutOutput(), AsyncLogOptions::fromEnvironment()));
 	srand(time(NULL));
-	this->nodeInd = (unsigned int) ((rand() + 1) * 1000);  // times 1000 so that it is obvious that its not an actual
-														   // nodeInd but a temporary unique id
+	this->nodeInd = (rand() % 1000000 + 1) * 1000;  // times 1000 so that it is obvious that its not an actual nodeInd
+													// but a temporary unique id
 }
 
 ServiceLogging::~ServiceLogging() {
-	if(output) {
-		delete output;
-		output = nullptr;
-	}
+	// writes what is still queued
+	this->backend.reset();
 }
 
-void ServiceLogging::setLogData(std::string && data) { output->flush(data); }
+void ServiceLogging::setLogData(std::string && data) {
+	LogRecord record;
+	record.message = std::move(data);
+	this->backend->push(std::move(record));
+}
 
-void ServiceLogging::setLogData(const std::string & data) { output->flush(data); }
+void ServiceLogging::setLogData(const std::string & data) {
+	LogRecord record;
+	record.message = data;
+	this->backend->push(std::move(record));
+}
 
 void ServiceLogging::setLogData(const std::string & datetime, const std::string & level, const std::string & message) {
-	output->flush(this->nodeInd, datetime, level, message);
+	this->setLogData(datetime + "|" + std::to_string(this->nodeInd) + "|" + level + "|" + message);
 }
 
-void ServiceLogging::setLogOutput(GenericOutput * value) {
-	if(output) {
-		delete output;
+void ServiceLogging::setLogData(LoggingLevel level, std::string && message) {
+	LogRecord record;
+	record.time = AsyncLogBackend::coarseNow();
+	record.nodeInd = this->nodeInd;
+	record.level = getLevelName(level);
+	record.message = std::move(message);
+	this->backend->push(std::move(record));
+	if(level == LoggingLevel::FATAL) {
+		this->backend->flush();
 	}
-	output = value;
 }
 
+void ServiceLogging::setLogOutput(GenericOutput * value) { this->backend->setSink(value); }
+
 void ServiceLogging::setNodeIdentifier(const int nodeInd) {
 	std::string message = "Node index " + std::to_string(nodeInd) + " was using temporary node index identifier " +
 						  std::to_string(this->nodeInd);
 	this->nodeInd = nodeInd;
-	this->output->flush(message);
+	this->setLogData(std::move(message));
 }
+
+void ServiceLogging::flush() { this->backend->flush(); }
 }  // namespace Logging
 }  // namespace Library
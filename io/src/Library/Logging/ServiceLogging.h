@@ -1,12 +1,19 @@
 #ifndef SRC_LIBRARY_LOGGING_SERVICELOGGING_H_
 #define SRC_LIBRARY_LOGGING_SERVICELOGGING_H_
 
+#include "Library/Logging/LoggingLevel.h"
+#include <atomic>
+#include <memory>
 #include <string>
 
 namespace Library {
 namespace Logging {
+class AsyncLogBackend;
 class GenericOutput;
 
+/**
+ * Queues the log data in an AsyncLogBackend, the output set with setLogOutput is written in the background.
+ */
 class ServiceLogging {
 private:
 	ServiceLogging();
@@ -35,13 +42,21 @@ public:
 
 	void setLogData(const std::string & datetime, const std::string & level, const std::string & message);
 
+	// timestamped by the backend, FATAL waits until it is written
+	void setLogData(LoggingLevel level, std::string && message);
+
 	void setLogOutput(GenericOutput * output);
 
 	void setNodeIdentifier(const int nodeInd);
 
+	// waits until the data logged before is written
+	void flush();
+
+	AsyncLogBackend & getBackend() { return *backend; }
+
 private:
-	GenericOutput * output{nullptr};
-	int nodeInd;
+	std::unique_ptr<AsyncLogBackend> backend;
+	std::atomic<int> nodeInd;
 };
 }  // namespace Logging
 }  // namespace Library
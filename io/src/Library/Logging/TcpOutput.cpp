@@ -52,6 +52,20 @@ void TcpOutput::flush(
 	doOnProducer(datetime + "|" + std::to_string(nodeInd) + "|" + level + "|" + log);
 }
 
+void TcpOutput::write(const std::string & lines) {
+	std::unique_lock<std::mutex> lock(mutex);
+
+	size_t begin = 0;
+	while(begin < lines.size()) {
+		size_t end = lines.find('\n', begin);
+		end = (end == std::string::npos) ? lines.size() : end + 1;
+		deque.push_back(lines.substr(begin, end - begin));
+		begin = end;
+	}
+	isReady = true;
+	condition.notify_one();
+}
+
 // void TcpOutput::setNodeIdentifier(const unsigned int nodeInd) {
 
 // 	std::string message = "Node index " + std::to_string(nodeInd) + " was using temporary node index identifier " +
@@ -117,7 +131,8 @@ void TcpOutput::processLogData() {
 	while(!deque.empty()) {
 		auto & log = deque.front();
 		counter += log.length();
-		if(maxBufferSize < counter) {
+		// a line longer than maxBufferSize is sent alone, waiting for room would never end
+		if(maxBufferSize < counter && !buffer.empty()) {
 			isDataReadyToSend = true;
 			break;
 		}
@@ -0,0 +1,25 @@
+#include "Library/Metrics/Counter.h"
+
+namespace Library {
+namespace Metrics {
+size_t getThreadShard() {
+	static std::atomic<size_t> nextShard(0);
+	thread_local size_t shard = nextShard.fetch_add(1, std::memory_order_relaxed);
+	return shard;
+}
+
+Counter::Counter() {
+	for(Shard & shard : shards) {
+		shard.value.store(0, std::memory_order_relaxed);
+	}
+}
+
+uint64_t Counter::getValue() const {
+	uint64_t value = 0;
+	for(const Shard & shard : shards) {
+		value += shard.value.load(std::memory_order_relaxed);
+	}
+	return value;
+}
+}  // namespace Metrics
+}  // namespace Library
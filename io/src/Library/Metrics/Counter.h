@@ -0,0 +1,46 @@
+#ifndef SRC_LIBRARY_METRICS_COUNTER_H_
+#define SRC_LIBRARY_METRICS_COUNTER_H_
+
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+
+namespace Library {
+namespace Metrics {
+// the shard of the calling thread, threads get the shards round robin the first time they ask
+size_t getThreadShard();
+
+/**
+ * Monotonic counter that many threads increment without sharing a cache line. Every thread adds to its own shard and
+ * the shards are only summed when the counter is read, which is rare (a scrape).
+ */
+class Counter {
+public:
+	static const size_t NUM_SHARDS = 16;
+
+	Counter();
+
+	Counter(const Counter &) = delete;
+
+	Counter & operator=(const Counter &) = delete;
+
+public:
+	void increment(uint64_t value = 1) {
+		shards[getThreadShard() % NUM_SHARDS].value.fetch_add(value, std::memory_order_relaxed);
+	}
+
+	uint64_t getValue() const;
+
+private:
+	// 64 bytes apart, so two shards never share a cache line (alignas on heap objects needs C++17)
+	struct Shard {
+		std::atomic<uint64_t> value;
+		char padding[64 - sizeof(std::atomic<uint64_t>)];
+	};
+
+	Shard shards[NUM_SHARDS];
+};
+}  // namespace Metrics
+}  // namespace Library
+
+#endif
@@ -0,0 +1,33 @@
+#ifndef SRC_LIBRARY_METRICS_GAUGE_H_
+#define SRC_LIBRARY_METRICS_GAUGE_H_
+
+#include <atomic>
+#include <cstdint>
+
+namespace Library {
+namespace Metrics {
+// A value that goes up and down, e.g. the messages waiting in a queue
+class Gauge {
+public:
+	Gauge() : value(0) {}
+
+	Gauge(const Gauge &) = delete;
+
+	Gauge & operator=(const Gauge &) = delete;
+
+public:
+	void set(int64_t newValue) { value.store(newValue, std::memory_order_relaxed); }
+
+	void add(int64_t delta) { value.fetch_add(delta, std::memory_order_relaxed); }
+
+	void sub(int64_t delta) { value.fetch_sub(delta, std::memory_order_relaxed); }
+
+	int64_t getValue() const { return value.load(std::memory_order_relaxed); }
+
+private:
+	std::atomic<int64_t> value;
+};
+}  // namespace Metrics
+}  // namespace Library
+
+#endif
@@ -0,0 +1,96 @@
+#include "Library/Metrics/Histogram.h"
+#include <algorithm>
+#include <cmath>
+#include <limits>
+
+namespace Library {
+namespace Metrics {
+Histogram::Histogram() : sum(0) {
+	for(auto & bucket : buckets) {
+		bucket.store(0, std::memory_order_relaxed);
+	}
+}
+
+int Histogram::getBucket(int64_t value) {
+	// the buckets end at their upper bound, so the powers of two are the last value of a bucket
+	if(value <= 8) {
+		return std::max<int64_t>(0, value);
+	}
+	// 8 buckets between consecutive powers of two
+	const int64_t offset = value - 1;
+	const int exponent = 63 - __builtin_clzll(offset);
+	const int subBucket = (offset >> (exponent - 3)) & 7;
+	return (exponent - 2) * 8 + subBucket + 1;
+}
+
+int64_t Histogram::getBucketLowerBound(int bucket) {
+	if(bucket <= 8) {
+		return bucket;
+	}
+	const int exponent = (bucket - 1) / 8 + 2;
+	return (int64_t((8 + (bucket - 1) % 8)) << (exponent - 3)) + 1;
+}
+
+void Histogram::record(int64_t value) {
+	buckets[getBucket(value)].fetch_add(1, std::memory_order_relaxed);
+	sum.fetch_add(std::max<int64_t>(0, value), std::memory_order_relaxed);
+}
+
+uint64_t Histogram::getCount() const {
+	uint64_t count = 0;
+	for(const auto & bucket : buckets) {
+		count += bucket.load(std::memory_order_relaxed);
+	}
+	return count;
+}
+
+int64_t Histogram::getPercentile(double percentile) const { return getPercentile({this}, percentile); }
+
+int64_t Histogram::getPercentile(const std::vector<const Histogram *> & histograms, double percentile) {
+	uint64_t total = 0;
+	for(const Histogram * histogram : histograms) {
+		total += histogram->getCount();
+	}
+	if(total == 0) {
+		return -1;
+	}
+	const uint64_t target = std::max<uint64_t>(1, std::ceil(percentile * total));
+	uint64_t count = 0;
+	for(int bucket = 0; bucket < NUM_BUCKETS; bucket++) {
+		for(const Histogram * histogram : histograms) {
+			count += histogram->buckets[bucket].load(std::memory_order_relaxed);
+		}
+		if(count >= target) {
+			return bucket + 1 < NUM_BUCKETS ? getBucketLowerBound(bucket + 1) - 1 : std::numeric_limits<int64_t>::max();
+		}
+	}
+	return std::numeric_limits<int64_t>::max();
+}
+
+std::vector<std::pair<int64_t, uint64_t>> Histogram::getCumulativeCounts() const {
+	uint64_t snapshot[NUM_BUCKETS];
+	uint64_t total = 0;
+	for(int bucket = 0; bucket < NUM_BUCKETS; bucket++) {
+		snapshot[bucket] = buckets[bucket].load(std::memory_order_relaxed);
+		total += snapshot[bucket];
+	}
+
+	std::vector<std::pair<int64_t, uint64_t>> counts;
+	uint64_t count = 0;
+	int bucket = 0;
+	for(int exponent = 0; exponent < 63 && total > 0; exponent++) {
+		// the powers of two end a bucket, the count of the values up to one is exact
+		const int64_t bound = int64_t(1) << exponent;
+		for(; bucket < getBucket(bound + 1); bucket++) {
+			count += snapshot[bucket];
+		}
+		counts.emplace_back(bound, count);
+		if(count == total) {
+			break;
+		}
+	}
+	counts.emplace_back(std::numeric_limits<int64_t>::max(), total);
+	return counts;
+}
+}  // namespace Metrics
+}  // namespace Library
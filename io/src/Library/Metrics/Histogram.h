@@ -0,0 +1,78 @@
+#ifndef SRC_LIBRARY_METRICS_HISTOGRAM_H_
+#define SRC_LIBRARY_METRICS_HISTOGRAM_H_
+
+#include <atomic>
+#include <chrono>
+#include <cstdint>
+#include <utility>
+#include <vector>
+
+namespace Library {
+namespace Metrics {
+/**
+ * Distribution of integer values (e.g. latencies in microseconds) in log-linear buckets, 8 per power of two, so any
+ * value is known within 12.5% from 0 up to the int64 range, with a fixed 4 KiB of counters and no configuration.
+ * Recording is one relaxed increment of the bucket and one of the sum, no locks.
+ */
+class Histogram {
+public:
+	static const int NUM_BUCKETS = 489;
+
+	Histogram();
+
+	Histogram(const Histogram &) = delete;
+
+	Histogram & operator=(const Histogram &) = delete;
+
+public:
+	// negative values are recorded as 0
+	void record(int64_t value);
+
+	uint64_t getCount() const;
+
+	int64_t getSum() const { return sum.load(std::memory_order_relaxed); }
+
+	// Upper bound of the bucket holding the percentile (0 < percentile <= 1), -1 without values
+	int64_t getPercentile(double percentile) const;
+
+	// Same as getPercentile, over the values of all the histograms
+	static int64_t getPercentile(const std::vector<const Histogram *> & histograms, double percentile);
+
+	/**
+	 * The counts of the values up to 1, 2, 4, 8... as (bound, count) pairs, up to the first power of two not below
+	 * the largest value recorded, then (INT64_MAX, total) for all of them. All read from one snapshot of the buckets.
+	 */
+	std::vector<std::pair<int64_t, uint64_t>> getCumulativeCounts() const;
+
+	static int getBucket(int64_t value);
+
+	// the smallest value of the bucket, the bucket holds the values below the lower bound of the next one
+	static int64_t getBucketLowerBound(int bucket);
+
+private:
+	std::atomic<uint64_t> buckets[NUM_BUCKETS];
+	std::atomic<int64_t> sum;
+};
+
+// Records the microseconds from its construction to its destruction
+class ScopedTimer {
+public:
+	explicit ScopedTimer(Histogram & histogram) : histogram(histogram), start(std::chrono::steady_clock::now()) {}
+
+	~ScopedTimer() {
+		histogram.record(
+			std::chrono::duration_cast<std::chrono::microseconds>(std::chrono::steady_clock::now() - start).count());
+	}
+
+	ScopedTimer(const ScopedTimer &) = delete;
+
+	ScopedTimer & operator=(const ScopedTimer &) = delete;
+
+private:
+	Histogram & histogram;
+	std::chrono::steady_clock::time_point start;
+};
+}  // namespace Metrics
+}  // namespace Library
+
+#endif
@@ -0,0 +1,176 @@
+#include "Library/Metrics/MetricsRegistry.h"
+#include <cmath>
+#include <cstdio>
+#include <limits>
+#include <stdexcept>
+
+namespace Library {
+namespace Metrics {
+namespace {
+const char * getTypeName(int type) {
+	static const char * names[] = {"counter", "gauge", "histogram"};
+	return names[type];
+}
+
+std::string escape(const std::string & value, bool quotes) {
+	std::string escaped;
+	escaped.reserve(value.size());
+	for(char c : value) {
+		if(c == '\\') {
+			escaped += "\\\\";
+		} else if(c == '\n') {
+			escaped += "\\n";
+		} else if(c == '"' && quotes) {
+			escaped += "\\\"";
+		} else {
+			escaped += c;
+		}
+	}
+	return escaped;
+}
+
+// a="x",b="y"
+std::string renderLabels(const Labels & labels) {
+	std::string rendered;
+	for(const auto & label : labels) {
+		if(!rendered.empty()) {
+			rendered += ',';
+		}
+		rendered += label.first + "=\"" + escape(label.second, true) + "\"";
+	}
+	return rendered;
+}
+
+std::string formatValue(double value) {
+	if(std::isinf(value)) {
+		return value > 0 ? "+Inf" : "-Inf";
+	}
+	if(std::isnan(value)) {
+		return "NaN";
+	}
+	char formatted[32];
+	if(value == std::floor(value) && std::fabs(value) < 1e15) {
+		std::snprintf(formatted, sizeof(formatted), "%.0f", value);
+	} else {
+		std::snprintf(formatted, sizeof(formatted), "%.9g", value);
+	}
+	return formatted;
+}
+
+void appendSample(
+	std::string & out, const std::string & name, const std::string & labels, const std::string & value) {
+	out += name;
+	if(!labels.empty()) {
+		out += '{';
+		out += labels;
+		out += '}';
+	}
+	out += ' ';
+	out += value;
+	out += '\n';
+}
+}  // namespace
+
+MetricsRegistry & MetricsRegistry::getInstance() {
+	// leaked on purpose, threads still running at exit can keep incrementing their metrics
+	static MetricsRegistry * registry = new MetricsRegistry();
+	return *registry;
+}
+
+MetricsRegistry::Series & MetricsRegistry::getSeries(
+	const std::string & name, const std::string & help, MetricType type, const Labels & labels, double unitScale) {
+	auto it = families.find(name);
+	if(it == families.end()) {
+		Family family;
+		family.type = type;
+		family.help = help;
+		family.unitScale = unitScale;
+		it = families.emplace(name, std::move(family)).first;
+	} else if(it->second.type != type) {
+		throw std::logic_error("MetricsRegistry: the metric " + name + " is a " +
+							   getTypeName(static_cast<int>(it->second.type)) + ", not a " +
+							   getTypeName(static_cast<int>(type)));
+	}
+	return it->second.series[renderLabels(labels)];
+}
+
+Counter & MetricsRegistry::counter(const std::string & name, const std::string & help, const Labels & labels) {
+	std::lock_guard<std::mutex> lock(mutex);
+	Series & series = getSeries(name, help, MetricType::COUNTER, labels, 1.0);
+	if(series.counter == nullptr) {
+		series.counter.reset(new Counter());
+	}
+	return *series.counter;
+}
+
+Gauge & MetricsRegistry::gauge(const std::string & name, const std::string & help, const Labels & labels) {
+	std::lock_guard<std::mutex> lock(mutex);
+	Series & series = getSeries(name, help, MetricType::GAUGE, labels, 1.0);
+	if(series.gauge == nullptr) {
+		series.gauge.reset(new Gauge());
+	}
+	return *series.gauge;
+}
+
+Histogram & MetricsRegistry::histogram(
+	const std::string & name, const std::string & help, const Labels & labels, double unitScale) {
+	std::lock_guard<std::mutex> lock(mutex);
+	Series & series = getSeries(name, help, MetricType::HISTOGRAM, labels, unitScale);
+	if(series.histogram == nullptr) {
+		series.histogram.reset(new Histogram());
+	}
+	return *series.histogram;
+}
+
+void MetricsRegistry::counterFunction(
+	const std::string & name, const std::string & help, const Labels & labels, std::function<double()> function) {
+	std::lock_guard<std::mutex> lock(mutex);
+	getSeries(name, help, MetricType::COUNTER, labels, 1.0).function = std::move(function);
+}
+
+void MetricsRegistry::gaugeFunction(
+	const std::string & name, const std::string & help, const Labels & labels, std::function<double()> function) {
+	std::lock_guard<std::mutex> lock(mutex);
+	getSeries(name, help, MetricType::GAUGE, labels, 1.0).function = std::move(function);
+}
+
+std::string MetricsRegistry::toPrometheusText() const {
+	std::lock_guard<std::mutex> lock(mutex);
+	std::string out;
+	for(const auto & namedFamily : families) {
+		const std::string & name = namedFamily.first;
+		const Family & family = namedFamily.second;
+		out += "# HELP " + name + " " + escape(family.help, false) + "\n";
+		out += "# TYPE " + name + " " + getTypeName(static_cast<int>(family.type)) + "\n";
+
+		for(const auto & labeledSeries : family.series) {
+			const std::string & labels = labeledSeries.first;
+			const Series & series = labeledSeries.second;
+			if(series.function) {
+				appendSample(out, name, labels, formatValue(series.function()));
+			} else if(series.counter != nullptr) {
+				appendSample(out, name, labels, std::to_string(series.counter->getValue()));
+			} else if(series.gauge != nullptr) {
+				appendSample(out, name, labels, std::to_string(series.gauge->getValue()));
+			} else if(series.histogram != nullptr) {
+				const std::string separator = labels.empty() ? "" : ",";
+				uint64_t total = 0;
+				for(const auto & bucket : series.histogram->getCumulativeCounts()) {
+					const double bound = bucket.first == std::numeric_limits<int64_t>::max()
+											 ? std::numeric_limits<double>::infinity()
+											 : bucket.first * family.unitScale;
+					appendSample(out,
+						name + "_bucket",
+						labels + separator + "le=\"" + formatValue(bound) + "\"",
+						std::to_string(bucket.second));
+					total = bucket.second;
+				}
+				appendSample(out, name + "_sum", labels, formatValue(series.histogram->getSum() * family.unitScale));
+				appendSample(out, name + "_count", labels, std::to_string(total));
+			}
+		}
+	}
+	return out;
+}
+}  // namespace Metrics
+}  // namespace Library
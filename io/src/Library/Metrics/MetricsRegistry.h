@@ -0,0 +1,90 @@
+#ifndef SRC_LIBRARY_METRICS_METRICSREGISTRY_H_
+#define SRC_LIBRARY_METRICS_METRICSREGISTRY_H_
+
+#include "Library/Metrics/Counter.h"
+#include "Library/Metrics/Gauge.h"
+#include "Library/Metrics/Histogram.h"
+#include <functional>
+#include <map>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <utility>
+#include <vector>
+
+namespace Library {
+namespace Metrics {
+using Labels = std::vector<std::pair<std::string, std::string>>;
+
+/**
+ * The metrics of the process, rendered in the Prometheus text format. A metric is found or created by its name and
+ * labels, which takes a lock, so the hot paths look theirs up once and keep the reference, e.g.
+ *   static Counter & sentBytes = MetricsRegistry::getInstance().counter("blazing_shuffle_sent_bytes_total", "...");
+ *   sentBytes.increment(nbytes);
+ * The metrics are never removed, the references stay valid for the life of the process.
+ */
+class MetricsRegistry {
+public:
+	static MetricsRegistry & getInstance();
+
+	MetricsRegistry() = default;
+
+	MetricsRegistry(const MetricsRegistry &) = delete;
+
+	MetricsRegistry & operator=(const MetricsRegistry &) = delete;
+
+public:
+	// throw std::logic_error when the name was registered with another type
+	Counter & counter(const std::string & name, const std::string & help, const Labels & labels = Labels());
+
+	Gauge & gauge(const std::string & name, const std::string & help, const Labels & labels = Labels());
+
+	// the values are exposed multiplied by unitScale, e.g. microseconds recorded and 1e-6 to expose seconds
+	Histogram & histogram(const std::string & name,
+		const std::string & help,
+		const Labels & labels = Labels(),
+		double unitScale = 1.0);
+
+	/**
+	 * Metrics whose value is read from somewhere else at every scrape, e.g. the stats of a pool. The function replaces
+	 * the one registered before with the same name and labels, it must stay callable for the life of the process and
+	 * must not register metrics.
+	 */
+	void counterFunction(
+		const std::string & name, const std::string & help, const Labels & labels, std::function<double()> function);
+
+	void gaugeFunction(
+		const std::string & name, const std::string & help, const Labels & labels, std::function<double()> function);
+
+	// the Prometheus text exposition format, version 0.0.4
+	std::string toPrometheusText() const;
+
+private:
+	enum class MetricType { COUNTER, GAUGE, HISTOGRAM };
+
+	struct Series {
+		std::unique_ptr<Counter> counter;
+		std::unique_ptr<Gauge> gauge;
+		std::unique_ptr<Histogram> histogram;
+		std::function<double()> function;
+	};
+
+	struct Family {
+		MetricType type;
+		std::string help;
+		double unitScale;
+		std::map<std::string, Series> series;  // by their rendered labels
+	};
+
+	// the series of the name and labels, created empty, with the lock held
+	Series & getSeries(
+		const std::string & name, const std::string & help, MetricType type, const Labels & labels, double unitScale);
+
+private:
+	mutable std::mutex mutex;
+	std::map<std::string, Family> families;
+};
+}  // namespace Metrics
+}  // namespace Library
+
+#endif
@@ -0,0 +1,198 @@
+#include "Library/Metrics/PrometheusExporter.h"
+#include <arpa/inet.h>
+#include <cerrno>
+#include <cstdio>
+#include <cstring>
+#include <fstream>
+#include <netinet/in.h>
+#include <poll.h>
+#include <stdexcept>
+#include <sys/socket.h>
+#include <sys/time.h>
+#include <unistd.h>
+
+namespace Library {
+namespace Metrics {
+namespace {
+const int ACCEPT_POLL_MILLIS = 200;  // how often the server checks whether it was stopped
+const size_t MAX_REQUEST_BYTES = 8192;
+
+bool sendAll(int connection, const std::string & data) {
+	size_t sent = 0;
+	while(sent < data.size()) {
+		const ssize_t result = ::send(connection, data.data() + sent, data.size() - sent, MSG_NOSIGNAL);
+		if(result < 0 && errno == EINTR) {
+			continue;
+		}
+		if(result <= 0) {
+			return false;
+		}
+		sent += result;
+	}
+	return true;
+}
+
+std::string makeResponse(const std::string & status, const std::string & contentType, const std::string & body) {
+	return "HTTP/1.1 " + status + "\r\nContent-Type: " + contentType +
+		   "\r\nContent-Length: " + std::to_string(body.size()) + "\r\nConnection: close\r\n\r\n" + body;
+}
+}  // namespace
+
+PrometheusExporter & PrometheusExporter::getInstance() {
+	static PrometheusExporter exporter;
+	return exporter;
+}
+
+PrometheusExporter::PrometheusExporter(MetricsRegistry & registry)
+	: registry(registry), stopping(false), serverSocket(-1), port(0), fileInterval(0) {}
+
+PrometheusExporter::~PrometheusExporter() { stop(); }
+
+int PrometheusExporter::startServer(int requestedPort, const std::string & address) {
+	if(server.joinable()) {
+		throw std::runtime_error("PrometheusExporter: the server is running already on port " + std::to_string(port));
+	}
+
+	sockaddr_in socketAddress;
+	std::memset(&socketAddress, 0, sizeof(socketAddress));
+	socketAddress.sin_family = AF_INET;
+	socketAddress.sin_port = htons(requestedPort);
+	if(inet_pton(AF_INET, address.c_str(), &socketAddress.sin_addr) != 1) {
+		throw std::runtime_error("PrometheusExporter: invalid address " + address);
+	}
+
+	const int listening = ::socket(AF_INET, SOCK_STREAM | SOCK_CLOEXEC, 0);
+	if(listening < 0) {
+		throw std::runtime_error(std::string("PrometheusExporter: socket failed: ") + std::strerror(errno));
+	}
+	const int reuse = 1;
+	setsockopt(listening, SOL_SOCKET, SO_REUSEADDR, &reuse, sizeof(reuse));
+	if(::bind(listening, reinterpret_cast<sockaddr *>(&socketAddress), sizeof(socketAddress)) != 0 ||
+		::listen(listening, 16) != 0) {
+		const std::string error = std::strerror(errno);
+		::close(listening);
+		throw std::runtime_error("PrometheusExporter: can not listen on " + address + ":" +
+								 std::to_string(requestedPort) + ": " + error);
+	}
+
+	socklen_t length = sizeof(socketAddress);
+	getsockname(listening, reinterpret_cast<sockaddr *>(&socketAddress), &length);
+	serverSocket = listening;
+	port = ntohs(socketAddress.sin_port);
+	stopping = false;
+	server = std::thread(&PrometheusExporter::serve, this);
+	return port;
+}
+
+void PrometheusExporter::startFileWriter(const std::string & path, std::chrono::milliseconds interval) {
+	if(fileWriter.joinable()) {
+		throw std::runtime_error("PrometheusExporter: the metrics are written already to " + filePath);
+	}
+	filePath = path;
+	fileInterval = interval;
+	stopping = false;
+	fileWriter = std::thread(&PrometheusExporter::writeFiles, this);
+}
+
+void PrometheusExporter::stop() {
+	{
+		std::unique_lock<std::mutex> lock(mutex);
+		stopping = true;
+		wake.notify_all();
+	}
+	if(server.joinable()) {
+		server.join();
+	}
+	if(fileWriter.joinable()) {
+		fileWriter.join();
+	}
+	if(serverSocket >= 0) {
+		::close(serverSocket);
+		serverSocket = -1;
+	}
+	port = 0;
+}
+
+void PrometheusExporter::serve() {
+	while(!stopping) {
+		pollfd listening;
+		listening.fd = serverSocket;
+		listening.events = POLLIN;
+		if(::poll(&listening, 1, ACCEPT_POLL_MILLIS) <= 0) {
+			continue;
+		}
+		const int connection = ::accept4(serverSocket, nullptr, nullptr, SOCK_CLOEXEC);
+		if(connection < 0) {
+			continue;
+		}
+		// a client that never sends its request does not hold the server
+		timeval timeout{1, 0};
+		setsockopt(connection, SOL_SOCKET, SO_RCVTIMEO, &timeout, sizeof(timeout));
+		setsockopt(connection, SOL_SOCKET, SO_SNDTIMEO, &timeout, sizeof(timeout));
+		answer(connection);
+		::close(connection);
+	}
+}
+
+void PrometheusExporter::answer(int connection) const {
+	std::string request;
+	char buffer[1024];
+	while(request.find("\r\n\r\n") == std::string::npos && request.size() < MAX_REQUEST_BYTES) {
+		const ssize_t received = ::recv(connection, buffer, sizeof(buffer), 0);
+		if(received < 0 && errno == EINTR) {
+			continue;
+		}
+		if(received <= 0) {
+			break;
+		}
+		request.append(buffer, received);
+	}
+
+	// GET /metrics HTTP/1.1
+	const size_t methodEnd = request.find(' ');
+	const size_t targetEnd = methodEnd == std::string::npos ? std::string::npos : request.find(' ', methodEnd + 1);
+	if(targetEnd == std::string::npos) {
+		sendAll(connection, makeResponse("400 Bad Request", "text/plain", "bad request\n"));
+		return;
+	}
+	const std::string method = request.substr(0, methodEnd);
+	std::string target = request.substr(methodEnd + 1, targetEnd - methodEnd - 1);
+	target = target.substr(0, target.find('?'));
+
+	if(method != "GET") {
+		sendAll(connection, makeResponse("405 Method Not Allowed", "text/plain", "only GET is supported\n"));
+	} else if(target != "/metrics") {
+		sendAll(connection, makeResponse("404 Not Found", "text/plain", "the metrics are served on /metrics\n"));
+	} else {
+		sendAll(connection,
+			makeResponse("200 OK", "text/plain; version=0.0.4; charset=utf-8", registry.toPrometheusText()));
+	}
+}
+
+bool PrometheusExporter::writeFile(const std::string & path) const {
+	const std::string temporaryPath = path + ".tmp";
+	{
+		std::ofstream file(temporaryPath, std::ios::out | std::ios::trunc);
+		file << registry.toPrometheusText();
+		file.close();
+		if(!file) {
+			std::remove(temporaryPath.c_str());
+			return false;
+		}
+	}
+	return std::rename(temporaryPath.c_str(), path.c_str()) == 0;
+}
+
+void PrometheusExporter::writeFiles() {
+	std::unique_lock<std::mutex> lock(mutex);
+	while(!stopping) {
+		lock.unlock();
+		writeFile(filePath);
+		lock.lock();
+		wake.wait_for(lock, fileInterval, [this]() { return stopping.load(); });
+	}
+	lock.unlock();
+	writeFile(filePath);
+}
+}  // namespace Metrics
+}  // namespace Library
@@ -0,0 +1,75 @@
+#ifndef SRC_LIBRARY_METRICS_PROMETHEUSEXPORTER_H_
+#define SRC_LIBRARY_METRICS_PROMETHEUSEXPORTER_H_
+
+#include "Library/Metrics/MetricsRegistry.h"
+#include <atomic>
+#include <chrono>
+#include <condition_variable>
+#include <mutex>
+#include <string>
+#include <thread>
+
+namespace Library {
+namespace Metrics {
+/**
+ * Exposes a MetricsRegistry to Prometheus, through a small HTTP server answering GET /metrics, or through a file
+ * rewritten periodically (for the textfile collector of the node exporter). The file is written next to its path
+ * and renamed over it, so a reader never sees half of it.
+ */
+class PrometheusExporter {
+public:
+	static PrometheusExporter & getInstance();
+
+	explicit PrometheusExporter(MetricsRegistry & registry = MetricsRegistry::getInstance());
+
+	// stops the server and the file writer
+	~PrometheusExporter();
+
+	PrometheusExporter(const PrometheusExporter &) = delete;
+
+	PrometheusExporter & operator=(const PrometheusExporter &) = delete;
+
+public:
+	/**
+	 * Serves the metrics on address:port from a background thread, port 0 picks a free one. Returns the port
+	 * listened on. Throws std::runtime_error when the socket can not be bound or the server is running already.
+	 */
+	int startServer(int port, const std::string & address = "127.0.0.1");
+
+	// rewrites path with the metrics every interval, and once more when stopped
+	void startFileWriter(const std::string & path, std::chrono::milliseconds interval = std::chrono::seconds(15));
+
+	void stop();
+
+	// the port of the running server, 0 when there is none
+	int getPort() const { return port.load(); }
+
+	// writes the metrics to path through a temporary file, false when it fails
+	bool writeFile(const std::string & path) const;
+
+private:
+	void serve();
+
+	void answer(int connection) const;
+
+	void writeFiles();
+
+private:
+	MetricsRegistry & registry;
+
+	std::atomic<bool> stopping;
+
+	int serverSocket;
+	std::atomic<int> port;
+	std::thread server;
+
+	std::mutex mutex;  // guards the waits of the file writer
+	std::condition_variable wake;
+	std::string filePath;
+	std::chrono::milliseconds fileInterval;
+	std::thread fileWriter;
+};
+}  // namespace Metrics
+}  // namespace Library
+
+#endif
@@ -0,0 +1,47 @@
+/*
+ * Copyright 2017 BlazingDB, Inc.
+ */
+
+#include "EnvUtil.h"
+
+#include <cstdlib>
+#include <stdexcept>
+
+#include "Library/Logging/Logger.h"
+
+namespace Logging = Library::Logging;
+
+namespace {
+
+template <typename T, typename Parse>
+T getValue(const std::string & name, T defaultValue, Parse parse) {
+	const char * envValue = std::getenv(name.c_str());
+	if(envValue == nullptr) {
+		return defaultValue;
+	}
+	const std::string value(envValue);
+	try {
+		size_t parsed = 0;
+		T result = parse(value, &parsed);
+		if(parsed == value.size()) {
+			return result;
+		}
+	} catch(const std::logic_error &) {
+		// std::invalid_argument or std::out_of_range
+	}
+	Logging::Logger().logWarn(
+		"Ignoring malformed " + name + "=\"" + value + "\", using the default " + std::to_string(defaultValue));
+	return defaultValue;
+}
+
+}  // namespace
+
+int64_t EnvUtil::getInt(const std::string & name, int64_t defaultValue) {
+	return getValue<int64_t>(
+		name, defaultValue, [](const std::string & value, size_t * parsed) { return std::stoll(value, parsed); });
+}
+
+double EnvUtil::getDouble(const std::string & name, double defaultValue) {
+	return getValue<double>(
+		name, defaultValue, [](const std::string & value, size_t * parsed) { return std::stod(value, parsed); });
+}
@@ -0,0 +1,26 @@
+/*
+ * Copyright 2017 BlazingDB, Inc.
+ */
+
+#ifndef SRC_UTIL_ENVUTIL_H_
+#define SRC_UTIL_ENVUTIL_H_
+
+#include <cstdint>
+#include <string>
+
+/**
+ * Numeric settings read from environment variables.
+ *
+ * These are read while building file systems and caches, where a typo must not take the process down, so a value
+ * that is not a number as a whole (e.g. "8M" or "") is logged as a warning and the default is used instead.
+ */
+class EnvUtil {
+public:
+	// defaultValue when name is not set or is not an integer
+	static int64_t getInt(const std::string & name, int64_t defaultValue);
+
+	// defaultValue when name is not set or is not a number
+	static double getDouble(const std::string & name, double defaultValue);
+};
+
+#endif /* SRC_UTIL_ENVUTIL_H_ */
@@ -1,9 +1,13 @@
 #include "FileUtil.h"
 
 #include "ExceptionHandling/BlazingThread.h"
+#include <algorithm>
+#include <atomic>
 #include <cerrno>
 #include <chrono>
+#include <exception>
 #include <fstream>
+#include <functional>
 #include <iostream>
 #include <string.h>
 
@@ -23,6 +27,7 @@
 
 #include "FileSystem/Path.h"
 #include "FileSystem/Uri.h"
+#include "Util/GlobPattern.h"
 #include "Util/StringUtil.h"
 
 #include "Config/BlazingContext.h"
@@ -41,27 +46,112 @@ bool FileUtilv2::filePathContainsWildcards(std::string & filePath) {
 }
 
 
-std::vector<Uri> FileUtilv2::getFilesWithWildcard(std::string & filePathWithWildCard) {
-	Path pathWithWildCard = Path(filePathWithWildCard, false);
+// Listings are round trips to the file system, the folders of a level are listed by several threads
+static const int MAX_LISTING_THREADS = 16;
+
+// Lists every folder with listFolder, in parallel, and concatenates the results in the order of the folders
+static std::vector<Uri> listInParallel(
+	const std::vector<Uri> & folders, const std::function<std::vector<Uri>(const Uri & folder)> & listFolder) {
+	std::vector<std::vector<Uri>> listings(folders.size());
+	std::atomic<size_t> nextFolder(0);
+	std::mutex errorMutex;
+	std::exception_ptr error;
+
+	auto listFolders = [&folders, &listFolder, &listings, &nextFolder, &errorMutex, &error]() {
+		for(size_t i = nextFolder++; i < folders.size(); i = nextFolder++) {
+			try {
+				listings[i] = listFolder(folders[i]);
+			} catch(...) {
+				std::lock_guard<std::mutex> lock(errorMutex);
+				if(!error) {
+					error = std::current_exception();
+				}
+			}
+		}
+	};
+
+	const size_t numThreads = std::min<size_t>(MAX_LISTING_THREADS, folders.size());
+	if(numThreads <= 1) {
+		listFolders();
+	} else {
+		std::vector<BlazingThread> threads;
+		for(size_t j = 0; j < numThreads; ++j) {
+			threads.emplace_back(listFolders);
+		}
+		for(auto & thread : threads) {
+			thread.join();
+		}
+	}
+	if(error) {
+		std::rethrow_exception(error);
+	}
+
+	std::vector<Uri> uris;
+	for(const std::vector<Uri> & listing : listings) {
+		uris.insert(uris.end(), listing.begin(), listing.end());
+	}
+	return uris;
+}
 
-	std::string pattern = pathWithWildCard.getResourceName();
+std::vector<Uri> FileUtilv2::getFilesWithWildcard(std::string & filePathWithWildCard) {
+	return FileUtilv2::getFilesWithWildcard(Uri(filePathWithWildCard));
+}
 
-	Path path = pathWithWildCard.getParentPath();
-	std::string pathStr = path.toString();
+std::vector<Uri> FileUtilv2::getFilesWithWildcard(const Uri & uriWithWildcard) {
+	auto fileSystemManager = BlazingContext::getInstance()->getFileSystemManager();
+	const std::string scheme = uriWithWildcard.getScheme();
+	const std::string authority = uriWithWildcard.getAuthority();
 
-	if(FileUtilv2::filePathContainsWildcards(pathStr)) {
-		std::vector<Uri> folders = FileUtilv2::getFilesWithWildcard(pathStr);
+	std::vector<std::string> levels;
+	for(const std::string & level : StringUtil::split(uriWithWildcard.getPath().toString(true), "/")) {
+		if(!level.empty()) {
+			levels.push_back(level);
+		}
+	}
 
-		std::vector<Uri> urisToReturn;
-		for(Uri folder : folders) {
-			std::vector<Uri> urisFound = BlazingContext::getInstance()->getFileSystemManager()->list(folder, pattern);
-			urisToReturn.insert(urisToReturn.end(), urisFound.begin(), urisFound.end());
+	// the levels before the first wildcard are one folder
+	std::string base = "/";
+	size_t level = 0;
+	for(; level < levels.size() && !GlobPattern(levels[level]).hasWildcards(); level++) {
+		base += GlobPattern(levels[level]).getLiteralPrefix() + "/";
+	}
+	if(level == levels.size()) {
+		if(fileSystemManager->exists(uriWithWildcard)) {
+			return {uriWithWildcard};
 		}
-		return urisToReturn;
-	} else {
-		Uri folder = Uri(path.toString());
-		return BlazingContext::getInstance()->getFileSystemManager()->list(folder, pattern);
+		return {};
+	}
+	std::vector<Uri> uris = {Uri(scheme, authority, Path(base, true))};
+
+	if(uriWithWildcard.getFileSystemType() == FileSystemType::GOOGLE_CLOUD_STORAGE) {
+		// GCS listings are not split by folders, one listing matches the remaining levels
+		const std::vector<std::string> remainingLevels(levels.begin() + level, levels.end());
+		return fileSystemManager->list(uris.front(), StringUtil::join(remainingLevels, "/"));
+	}
+
+	// the others expand one level at a time, listing only the folders that matched the levels before
+	for(; level < levels.size(); level++) {
+		const GlobPattern pattern(levels[level]);
+		const bool lastLevel = (level + 1 == levels.size());
+		uris = listInParallel(uris, [&](const Uri & folder) {
+			std::vector<Uri> found;
+			if(pattern.hasWildcards() == false) {
+				const Uri child(scheme, authority, folder.getPath() + pattern.getLiteralPrefix());
+				if(fileSystemManager->exists(child)) {
+					found.push_back(child);
+				}
+			} else if(lastLevel) {
+				found = fileSystemManager->list(folder, pattern.getPattern());
+			} else {
+				for(const std::string & name :
+					fileSystemManager->listResourceNames(folder, FileType::DIRECTORY, pattern.getPattern())) {
+					found.push_back(Uri(scheme, authority, folder.getPath() + name));
+				}
+			}
+			return found;
+		});
 	}
+	return uris;
 }
 
 std::vector<Uri> FileUtilv2::listFolders(Uri & baseFolder) {
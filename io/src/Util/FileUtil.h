@@ -22,6 +22,9 @@ public:
 	static bool filePathContainsWildcards(std::string & filePath);
 
 	static std::vector<Uri> getFilesWithWildcard(std::string & filePathWithWildCard);
+	// Wildcards can be in any level, e.g. /data/year=*/month=*/*.parquet. The levels are expanded one at a time, the
+	// folders of a level in parallel, and object store listings are narrowed to the literal prefix of each level
+	static std::vector<Uri> getFilesWithWildcard(const Uri & uriWithWildcard);
 	static std::vector<Uri> listFolders(Uri & baseFolder);
 
 	static bool moveAndReplace(const Uri & src, const Uri & dest);
@@ -0,0 +1,194 @@
+/*
+ * Copyright 2017 BlazingDB, Inc.
+ */
+
+#include "GlobPattern.h"
+
+#include <algorithm>
+#include <cstring>
+#include <fnmatch.h>
+
+namespace {
+
+// The constructs fnmatch accepts with FNM_EXTMATCH: ?(..), *(..), +(..), @(..) and !(..)
+bool isExtendedPattern(const std::string & pattern) {
+	for(size_t i = 0; i + 1 < pattern.size(); i++) {
+		if(pattern[i] == '\\') {
+			i++;
+		} else if(pattern[i + 1] == '(' && std::strchr("?*+@!", pattern[i]) != nullptr) {
+			return true;
+		}
+	}
+	return false;
+}
+
+}  // namespace
+
+GlobPattern::GlobPattern(const std::string & pattern) : pattern(pattern), wildcards(false), useFnmatch(false) {
+	this->useFnmatch = isExtendedPattern(pattern);
+
+	this->segments.push_back(Segment());
+	for(size_t position = 0; position < pattern.size() && !this->useFnmatch; position++) {
+		Segment & segment = this->segments.back();
+		CharSet chars;
+		const char c = pattern[position];
+		if(c == '*') {
+			this->wildcards = true;
+			// consecutive stars are one
+			if(!segment.chars.empty() || this->segments.size() == 1) {
+				this->segments.push_back(Segment());
+			}
+			continue;
+		} else if(c == '?') {
+			this->wildcards = true;
+			chars.set();
+		} else if(c == '[' && this->parseClass(&position, &segment)) {
+			this->wildcards = true;
+			continue;
+		} else if(c == '\\' && position + 1 < pattern.size()) {
+			position++;
+			chars.set(static_cast<unsigned char>(pattern[position]));
+		} else {
+			chars.set(static_cast<unsigned char>(c));
+		}
+
+		if(chars.count() == 1) {
+			segment.literal += pattern[position];
+		} else {
+			segment.isLiteral = false;
+		}
+		segment.chars.push_back(chars);
+	}
+
+	if(this->useFnmatch) {
+		this->wildcards = true;
+		this->segments.clear();
+		const size_t end = pattern.find_first_of("*?[\\+@!(");
+		this->literalPrefix = pattern.substr(0, end);
+		return;
+	}
+
+	// the literal start of the first segment
+	const Segment & first = this->segments.front();
+	for(size_t i = 0; i < first.size() && first.chars[i].count() == 1; i++) {
+		for(int value = 0; value < 256; value++) {
+			if(first.chars[i].test(value)) {
+				this->literalPrefix += static_cast<char>(value);
+				break;
+			}
+		}
+	}
+}
+
+bool GlobPattern::parseClass(size_t * position, Segment * segment) {
+	size_t i = *position + 1;
+	bool negated = false;
+	if(i < this->pattern.size() && (this->pattern[i] == '!' || this->pattern[i] == '^')) {
+		negated = true;
+		i++;
+	}
+
+	CharSet chars;
+	bool first = true;
+	for(; i < this->pattern.size(); i++) {
+		char c = this->pattern[i];
+		if(c == ']' && !first) {
+			break;
+		}
+		first = false;
+		if(c == '[' && i + 1 < this->pattern.size() &&
+			(this->pattern[i + 1] == ':' || this->pattern[i + 1] == '=' || this->pattern[i + 1] == '.')) {
+			this->useFnmatch = true;  // [:alpha:], [=a=] and [.a.]
+			return false;
+		}
+		if(c == '\\' && i + 1 < this->pattern.size()) {
+			c = this->pattern[++i];
+		}
+
+		unsigned char low = static_cast<unsigned char>(c);
+		unsigned char high = low;
+		if(i + 2 < this->pattern.size() && this->pattern[i + 1] == '-' && this->pattern[i + 2] != ']') {
+			i += 2;
+			if(this->pattern[i] == '[' && i + 1 < this->pattern.size() &&
+				(this->pattern[i + 1] == ':' || this->pattern[i + 1] == '=' || this->pattern[i + 1] == '.')) {
+				this->useFnmatch = true;  // a range ending in a collating element
+				return false;
+			}
+			if(this->pattern[i] == '\\' && i + 1 < this->pattern.size()) {
+				i++;
+			}
+			high = static_cast<unsigned char>(this->pattern[i]);
+		}
+		for(int value = low; value <= high; value++) {
+			chars.set(value);
+		}
+	}
+	if(i >= this->pattern.size()) {
+		return false;  // no closing ], the [ is a literal
+	}
+
+	if(negated) {
+		chars.flip();
+	}
+	segment->chars.push_back(chars);
+	segment->isLiteral = false;
+	*position = i;
+	return true;
+}
+
+bool GlobPattern::matchesAt(const Segment & segment, const char * input) {
+	if(segment.isLiteral) {
+		return std::memcmp(input, segment.literal.data(), segment.literal.size()) == 0;
+	}
+	for(size_t i = 0; i < segment.size(); i++) {
+		if(!segment.chars[i].test(static_cast<unsigned char>(input[i]))) {
+			return false;
+		}
+	}
+	return true;
+}
+
+const char * GlobPattern::find(const Segment & segment, const char * begin, const char * end) {
+	if(static_cast<size_t>(end - begin) < segment.size()) {
+		return end;
+	}
+	if(segment.isLiteral) {
+		return std::search(begin, end, segment.literal.begin(), segment.literal.end());
+	}
+	for(const char * candidate = begin; candidate + segment.size() <= end; candidate++) {
+		if(matchesAt(segment, candidate)) {
+			return candidate;
+		}
+	}
+	return end;
+}
+
+bool GlobPattern::matches(const char * input, size_t size) const {
+	if(this->useFnmatch) {
+		return fnmatch(this->pattern.c_str(), std::string(input, size).c_str(), FNM_EXTMATCH) == 0;
+	}
+
+	const Segment & first = this->segments.front();
+	if(this->segments.size() == 1) {
+		return size == first.size() && matchesAt(first, input);
+	}
+
+	const Segment & last = this->segments.back();
+	if(size < first.size() + last.size() || !matchesAt(first, input) ||
+		!matchesAt(last, input + size - last.size())) {
+		return false;
+	}
+
+	// the middle segments go at their leftmost place, which leaves the most room to the ones after them
+	const char * position = input + first.size();
+	const char * end = input + size - last.size();
+	for(size_t i = 1; i + 1 < this->segments.size(); i++) {
+		const Segment & segment = this->segments[i];
+		const char * found = find(segment, position, end);
+		if(found == end && segment.size() > 0) {
+			return false;
+		}
+		position = found + segment.size();
+	}
+	return true;
+}
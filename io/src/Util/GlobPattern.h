@@ -0,0 +1,65 @@
+/*
+ * Copyright 2017 BlazingDB, Inc.
+ */
+
+#ifndef SRC_UTIL_GLOBPATTERN_H_
+#define SRC_UTIL_GLOBPATTERN_H_
+
+#include <bitset>
+#include <cstddef>
+#include <string>
+#include <vector>
+
+/**
+ * A shell wildcard (*, ?, [...] classes and \ escapes) compiled once and then matched against many names.
+ *
+ * The pattern is split at its stars. The text before the first star must match at the start of the input, the text
+ * after the last star at its end, and every piece in between is matched at its leftmost position after the previous
+ * one. Nothing is backtracked across a star, so a match costs at most input size times pattern size, where the
+ * recursive matchers take exponential time on patterns like *a*a*a*b.
+ *
+ * Matches like fnmatch without flags: a star also matches '/'. Patterns using the extended syntax of FNM_EXTMATCH
+ * (e.g. +(a|b)) or POSIX classes (e.g. [[:digit:]]) are matched with fnmatch.
+ */
+class GlobPattern {
+public:
+	explicit GlobPattern(const std::string & pattern);
+
+	bool matches(const std::string & input) const { return matches(input.data(), input.size()); }
+	bool matches(const char * input, size_t size) const;
+
+	const std::string & getPattern() const { return pattern; }
+
+	// False when the pattern only matches itself (after removing its escapes)
+	bool hasWildcards() const { return wildcards; }
+
+	// Longest text every match starts with, e.g. /data/year= for /data/year=*/*.parquet. Object store listings are
+	// narrowed to it
+	const std::string & getLiteralPrefix() const { return literalPrefix; }
+
+private:
+	using CharSet = std::bitset<256>;  // characters a position of the pattern accepts
+
+	// The part of the pattern between two stars
+	struct Segment {
+		std::vector<CharSet> chars;
+		std::string literal;  // same as chars, when every position accepts one character
+		bool isLiteral = true;
+
+		size_t size() const { return chars.size(); }
+	};
+
+	// Adds the class starting at pattern[position] == '[' to segment, returns false when it is not a valid class
+	bool parseClass(size_t * position, Segment * segment);
+	static bool matchesAt(const Segment & segment, const char * input);
+	// Leftmost position in [begin, end) where segment matches, or end
+	static const char * find(const Segment & segment, const char * begin, const char * end);
+
+	std::string pattern;
+	std::vector<Segment> segments;  // one more than the stars
+	std::string literalPrefix;
+	bool wildcards;
+	bool useFnmatch;
+};
+
+#endif /* SRC_UTIL_GLOBPATTERN_H_ */
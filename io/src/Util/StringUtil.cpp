@@ -7,6 +7,8 @@
 
 #include "StringUtil.h"
 
+#include "GlobPattern.h"
+
 #include <algorithm>
 #include <cstring>
 #include <limits.h>
@@ -17,19 +19,7 @@
  * Used to do wild card matches between two strings p and c shoudl be 0 when this is first called
  */
 bool match(const char * pattern, const char * candidate, int p, int c) {
-	if(pattern[p] == '\0') {
-		return candidate[c] == '\0';
-	} else if(pattern[p] == '*') {
-		for(; candidate[c] != '\0'; c++) {
-			if(match(pattern, candidate, p + 1, c))
-				return true;
-		}
-		return match(pattern, candidate, p + 1, c);
-	} else if(pattern[p] != '?' && pattern[p] != candidate[c]) {
-		return false;
-	} else {
-		return match(pattern, candidate, p + 1, c + 1);
-	}
+	return GlobPattern(pattern + p).matches(candidate + c, std::strlen(candidate + c));
 }
 
 
@@ -608,27 +598,16 @@ std::string StringUtil::toUpper(const std::string & input) {
 
 // matches a string including widcards
 bool StringUtil::match(char const * needle, char const * haystack) {
-	for(; *needle != '\0'; ++needle) {
-		switch(*needle) {
-		case '?':
-			if(*haystack == '\0')
-				return false;
-			++haystack;
-			break;
-		case '*': {
-			if(needle[1] == '\0')
-				return true;
-			int max = strlen(haystack);
-			for(int i = 0; i < max; i++)
-				if(match(needle + 1, haystack + i))
-					return true;
-			return false;
-		}
-		default:
-			if(*haystack != *needle)
-				return false;
-			++haystack;
+	return GlobPattern(needle).matches(haystack, std::strlen(haystack));
+}
+
+std::string StringUtil::makeCacheKey(const std::vector<std::string> & parts) {
+	std::string key;
+	for(size_t i = 0; i < parts.size(); i++) {
+		if(i > 0) {
+			key += '\n';
 		}
+		key += parts[i];
 	}
-	return *haystack == '\0';
+	return key;
 }
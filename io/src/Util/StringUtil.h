@@ -81,6 +81,9 @@ public:
 	static bool match(std::string & needle, std::string & haystack) { return match(needle.c_str(), haystack.c_str()); }
 	static bool match(char const * needle, char const * haystack);
 	static void findAndReplaceAll(std::string & data, std::string toSearch, std::string replaceStr);
+	// Joins the parts of a cache key whose first part is a uri, e.g. {uri, size, mtime}. '\n' can not be part of a
+	// uri, so two different part lists never make the same key
+	static std::string makeCacheKey(const std::vector<std::string> & parts);
 };
 
 /**
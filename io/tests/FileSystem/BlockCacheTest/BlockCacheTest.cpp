@@ -0,0 +1,204 @@
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <cstdlib>
+#include <fstream>
+#include <thread>
+#include <vector>
+
+#include <dirent.h>
+#include <unistd.h>
+
+#include "gtest/gtest.h"
+
+#include "FileSystem/BlockCache.h"
+#include "FileSystem/BlockCachedReadableFile.h"
+
+#include "../../utilities/MockRemoteFile.h"
+
+class BlockCacheTest : public ::testing::Test {
+protected:
+	void SetUp() override {
+		char directory[] = "/tmp/BlockCacheTest.XXXXXX";
+		ASSERT_NE(mkdtemp(directory), nullptr);
+		this->directory = directory;
+	}
+
+	void TearDown() override { system(("rm -rf " + this->directory).c_str()); }
+
+	BlockCacheOptions makeOptions(int64_t capacityBytes = 1 << 30) const {
+		BlockCacheOptions options;
+		options.directory = this->directory + "/cache";
+		options.capacityBytes = capacityBytes;
+		options.blockSize = 64 * 1024;
+		return options;
+	}
+
+	std::shared_ptr<BlockCachedReadableFile> open(std::shared_ptr<BlockCache> cache,
+		std::shared_ptr<MockRemoteFile> remote,
+		const std::string & uri = "s3://bucket/file",
+		const std::string & version = "etag1") {
+		return std::make_shared<BlockCachedReadableFile>(
+			remote, cache, "s3", uri, int64_t(remote->object.size()), version);
+	}
+
+	std::string directory;
+};
+
+bool readMatches(arrow::io::RandomAccessFile & file, const MockRemoteFile & remote, int64_t position, int64_t nbytes) {
+	std::shared_ptr<arrow::Buffer> buffer;
+	if(!file.ReadAt(position, nbytes, &buffer).ok()) {
+		return false;
+	}
+	const int64_t expected = std::max<int64_t>(0, std::min<int64_t>(nbytes, remote.object.size() - position));
+	return buffer->size() == expected &&
+		   std::equal(buffer->data(), buffer->data() + buffer->size(), remote.object.begin() + position);
+}
+
+TEST_F(BlockCacheTest, MissesThenHits) {
+	auto cache = BlockCache::open(this->makeOptions());
+	ASSERT_NE(cache, nullptr);
+	auto remote = std::make_shared<MockRemoteFile>(300 * 1024);
+	auto file = this->open(cache, remote);
+
+	EXPECT_TRUE(readMatches(*file, *remote, 1000, 1000));
+	EXPECT_EQ(remote->requests, 1);
+	EXPECT_TRUE(readMatches(*file, *remote, 60000, 80000));  // spans blocks 0 to 2
+	EXPECT_EQ(remote->requests, 3);
+	EXPECT_TRUE(readMatches(*file, *remote, 290 * 1024, 20000));  // the last block is shorter
+	EXPECT_TRUE(readMatches(*file, *remote, 0, 300 * 1024));
+	EXPECT_EQ(remote->requests, 5);
+	EXPECT_EQ(cache->getNumBlocks(), 5);
+
+	// a second file of the same version reads from disk
+	auto again = this->open(cache, remote);
+	EXPECT_TRUE(readMatches(*again, *remote, 0, 300 * 1024));
+	EXPECT_EQ(remote->requests, 5);
+	ASSERT_TRUE(again->Seek(70000).ok());
+	std::vector<uint8_t> out(1000);
+	int64_t bytesRead = 0;
+	ASSERT_TRUE(again->Read(out.size(), &bytesRead, out.data()).ok());
+	EXPECT_EQ(bytesRead, 1000);
+	EXPECT_TRUE(std::equal(out.begin(), out.end(), remote->object.begin() + 70000));
+
+	std::shared_ptr<BlockCacheStats> stats = cache->getStats("s3");
+	ASSERT_NE(stats, nullptr);
+	EXPECT_EQ(stats->misses, 5);
+	EXPECT_GT(stats->hits, 5);
+	EXPECT_EQ(stats->missBytes, 300 * 1024);
+	EXPECT_GT(stats->hitRatio(), 0.5);
+	EXPECT_EQ(cache->getStats("gcs"), nullptr);
+}
+
+TEST_F(BlockCacheTest, NewVersionsAreFetchedAgain) {
+	auto cache = BlockCache::open(this->makeOptions());
+	auto remote = std::make_shared<MockRemoteFile>(100 * 1024);
+	EXPECT_TRUE(readMatches(*this->open(cache, remote), *remote, 0, 1000));
+
+	auto rewritten = std::make_shared<MockRemoteFile>(100 * 1024);
+	rewritten->object[10] ^= 0xff;
+	EXPECT_TRUE(readMatches(*this->open(cache, rewritten, "s3://bucket/file", "etag2"), *rewritten, 0, 1000));
+	EXPECT_EQ(rewritten->requests, 1);
+
+	cache->invalidate("s3://bucket/file");
+	EXPECT_EQ(cache->getNumBlocks(), 0);
+	EXPECT_EQ(cache->getUsedBytes(), 0);
+}
+
+TEST_F(BlockCacheTest, EvictsLeastRecentlyUsedOverBudget) {
+	// room for 3 blocks and their headers
+	auto cache = BlockCache::open(this->makeOptions(3 * (64 * 1024 + 4096)));
+	auto remote = std::make_shared<MockRemoteFile>(64 * 1024 * 4);
+	auto file = this->open(cache, remote);
+
+	EXPECT_TRUE(readMatches(*file, *remote, 0, 10));
+	EXPECT_TRUE(readMatches(*file, *remote, 64 * 1024, 10));
+	EXPECT_TRUE(readMatches(*file, *remote, 2 * 64 * 1024, 10));
+	EXPECT_TRUE(readMatches(*file, *remote, 0, 10));  // block 1 is now the least recently used
+	EXPECT_TRUE(readMatches(*file, *remote, 3 * 64 * 1024, 10));
+	EXPECT_EQ(remote->requests, 4);
+	EXPECT_EQ(cache->getNumBlocks(), 3);
+	EXPECT_EQ(cache->getEvictions(), 1);
+	EXPECT_LE(cache->getUsedBytes(), cache->getOptions().capacityBytes);
+
+	EXPECT_TRUE(readMatches(*file, *remote, 0, 10));
+	EXPECT_EQ(remote->requests, 4);
+	EXPECT_TRUE(readMatches(*file, *remote, 64 * 1024, 10));
+	EXPECT_EQ(remote->requests, 5);
+}
+
+TEST_F(BlockCacheTest, RebuildsTheIndexOnRestart) {
+	auto remote = std::make_shared<MockRemoteFile>(64 * 1024 * 3);
+	{
+		auto cache = BlockCache::open(this->makeOptions());
+		EXPECT_TRUE(readMatches(*this->open(cache, remote), *remote, 0, 64 * 1024 * 3));
+		// the directory is locked while in use
+		EXPECT_EQ(BlockCache::open(this->makeOptions()), nullptr);
+	}
+
+	// leftovers of a crash: an interrupted fill and a torn block
+	const std::string subdirectory = this->directory + "/cache/00";
+	system(("mkdir -p " + subdirectory).c_str());
+	std::ofstream(subdirectory + "/0000000000000000ffffffffffffffff.blk.tmp.1") << "partial";
+	std::ofstream(subdirectory + "/00000000000000000000000000000000.blk") << "BZBLOCK1 torn";
+
+	auto cache = BlockCache::open(this->makeOptions());
+	ASSERT_NE(cache, nullptr);
+	EXPECT_EQ(cache->getNumBlocks(), 3);
+	EXPECT_TRUE(readMatches(*this->open(cache, remote), *remote, 0, 64 * 1024 * 3));
+	EXPECT_EQ(remote->requests, 3);
+
+	DIR * leftovers = opendir(subdirectory.c_str());
+	int files = 0;
+	for(dirent * item = readdir(leftovers); item != nullptr; item = readdir(leftovers)) {
+		files += item->d_name[0] != '.';
+	}
+	closedir(leftovers);
+	EXPECT_EQ(files, 0);
+
+	// a smaller budget evicts on open, the least recently used first
+	EXPECT_TRUE(readMatches(*this->open(cache, remote), *remote, 64 * 1024, 10));
+	cache.reset();
+	cache = BlockCache::open(this->makeOptions(64 * 1024 + 4096));
+	EXPECT_EQ(cache->getNumBlocks(), 1);
+	EXPECT_TRUE(readMatches(*this->open(cache, remote), *remote, 64 * 1024, 10));
+	EXPECT_EQ(remote->requests, 3);
+}
+
+TEST_F(BlockCacheTest, ConcurrentMissesFetchOnce) {
+	auto cache = BlockCache::open(this->makeOptions());
+	auto remote = std::make_shared<MockRemoteFile>(64 * 1024 * 2, std::chrono::milliseconds(20));
+
+	std::vector<std::thread> readers;
+	std::atomic<int> matches{0};
+	for(int i = 0; i < 16; i++) {
+		readers.emplace_back([&, i]() {
+			auto file = this->open(cache, remote);
+			matches += readMatches(*file, *remote, i * 1000, 64 * 1024);
+		});
+	}
+	for(auto & reader : readers) {
+		reader.join();
+	}
+	EXPECT_EQ(matches, 16);
+	EXPECT_EQ(remote->requests, 2);
+	EXPECT_EQ(cache->getStats("s3")->misses, 2);
+	EXPECT_EQ(cache->getStats("s3")->hits, 29);
+}
+
+TEST_F(BlockCacheTest, FetchesTheMissingBlocksOfAReadConcurrently) {
+	auto cache = BlockCache::open(this->makeOptions());
+	auto remote = std::make_shared<MockRemoteFile>(64 * 1024 * 8, std::chrono::milliseconds(20));
+	auto file = this->open(cache, remote);
+
+	EXPECT_TRUE(readMatches(*file, *remote, 64 * 1024 * 2, 10));
+	EXPECT_TRUE(readMatches(*file, *remote, 100, 64 * 1024 * 8));
+	EXPECT_EQ(remote->requests, 8);
+	EXPECT_GT(remote->maxInFlight, 1);
+	EXPECT_EQ(cache->getStats("s3")->hits, 1);
+}
+
+TEST(BlockCacheOptionsTest, DisabledWithoutDirectory) {
+	unsetenv("BLAZING_BLOCK_CACHE_DIR");
+	EXPECT_EQ(BlockCache::open(BlockCacheOptions::fromEnvironment()), nullptr);
+}
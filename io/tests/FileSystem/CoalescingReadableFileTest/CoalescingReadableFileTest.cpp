@@ -0,0 +1,212 @@
+#include <algorithm>
+#include <chrono>
+#include <thread>
+#include <vector>
+
+#include "gtest/gtest.h"
+
+#include "FileSystem/CoalescingReadableFile.h"
+
+#include "../../utilities/MockRemoteFile.h"
+
+CoalescingOptions makeOptions(int64_t holeSizeLimit, int64_t rangeSizeLimit) {
+	CoalescingOptions options;
+	options.holeSizeLimit = holeSizeLimit;
+	options.rangeSizeLimit = rangeSizeLimit;
+	return options;
+}
+
+bool readMatches(CoalescingReadableFile & file, const MockRemoteFile & remote, int64_t position, int64_t nbytes) {
+	std::shared_ptr<arrow::Buffer> buffer;
+	if(!file.ReadAt(position, nbytes, &buffer).ok()) {
+		return false;
+	}
+	const int64_t expected = std::max<int64_t>(0, std::min<int64_t>(nbytes, remote.object.size() - position));
+	return buffer->size() == expected &&
+		   std::equal(buffer->data(), buffer->data() + buffer->size(), remote.object.begin() + position);
+}
+
+TEST(CoalescingReadableFileTest, CoalesceReadRanges) {
+	std::vector<ReadRange> ranges = {{500, 100}, {0, 100}, {150, 50}, {180, 100}, {1000, 0}, {2000, 10}};
+	std::vector<ReadRange> coalesced = coalesceReadRanges(ranges, 50, 1000);
+	ASSERT_EQ(coalesced.size(), 3u);
+	EXPECT_EQ(coalesced[0].offset, 0);
+	EXPECT_EQ(coalesced[0].length, 280);
+	EXPECT_EQ(coalesced[1].offset, 500);
+	EXPECT_EQ(coalesced[1].length, 100);
+	EXPECT_EQ(coalesced[2].offset, 2000);
+
+	// the range size limit stops the merging of holes but not of overlaps
+	coalesced = coalesceReadRanges(ranges, 10000, 150);
+	ASSERT_EQ(coalesced.size(), 4u);
+	EXPECT_EQ(coalesced[0].length, 100);
+	EXPECT_EQ(coalesced[1].offset, 150);
+	EXPECT_EQ(coalesced[1].length, 130);
+}
+
+TEST(CoalescingReadableFileTest, ServesPlannedReadsFromOneRequest) {
+	auto remote = std::make_shared<MockRemoteFile>(1 << 20, std::chrono::microseconds(0));
+	CoalescingReadableFile file(remote, makeOptions(1024, 1 << 20));
+
+	std::vector<ReadRange> ranges;
+	for(int64_t offset = 0; offset < 100 * 1100; offset += 1100) {
+		ranges.push_back(ReadRange{offset, 1000});
+	}
+	ASSERT_TRUE(file.WillNeed(ranges).ok());
+	for(const ReadRange & range : ranges) {
+		EXPECT_TRUE(readMatches(file, *remote, range.offset, range.length));
+	}
+
+	EXPECT_EQ(remote->requests, 1);
+	EXPECT_EQ(file.getFetchRequests(), 1);
+	EXPECT_EQ(file.getHits(), 100);
+	EXPECT_EQ(file.getMisses(), 0);
+	EXPECT_EQ(file.getPlannedBytes(), 100 * 1000);
+	// the 99 holes
+	EXPECT_EQ(file.getFetchedBytes() - file.getPlannedBytes(), 99 * 100);
+
+	// fully read buffers are released, reading again is a request
+	EXPECT_TRUE(readMatches(file, *remote, 0, 1000));
+	EXPECT_EQ(remote->requests, 2);
+	EXPECT_EQ(file.getMisses(), 1);
+}
+
+TEST(CoalescingReadableFileTest, OtherReadsGoToTheWrappedFile) {
+	auto remote = std::make_shared<MockRemoteFile>(10000, std::chrono::microseconds(0));
+	CoalescingReadableFile file(remote, makeOptions(0, 1 << 20));
+
+	ASSERT_TRUE(file.WillNeed({{1000, 1000}, {9500, 1000}}).ok());
+	EXPECT_TRUE(readMatches(file, *remote, 1500, 600));  // crosses the end of a planned range
+	EXPECT_TRUE(readMatches(file, *remote, 0, 10));
+	EXPECT_EQ(file.getMisses(), 2);
+
+	// the file ends inside the second range
+	EXPECT_TRUE(readMatches(file, *remote, 9900, 100));
+	EXPECT_TRUE(readMatches(file, *remote, 9950, 500));
+	EXPECT_TRUE(readMatches(file, *remote, 1000, 500));
+	EXPECT_EQ(file.getHits(), 3);
+	EXPECT_EQ(remote->requests, 4);
+
+	// sequential reads go through ReadAt too
+	ASSERT_TRUE(file.Seek(1500).ok());
+	std::vector<uint8_t> out(300);
+	int64_t bytesRead = 0;
+	ASSERT_TRUE(file.Read(out.size(), &bytesRead, out.data()).ok());
+	EXPECT_EQ(bytesRead, 300);
+	EXPECT_TRUE(std::equal(out.begin(), out.end(), remote->object.begin() + 1500));
+	int64_t position = 0;
+	file.Tell(&position);
+	EXPECT_EQ(position, 1800);
+	EXPECT_EQ(file.getHits(), 4);
+}
+
+TEST(CoalescingReadableFileTest, KnownSizeIsNotAskedToTheWrappedFile) {
+	auto remote = std::make_shared<MockRemoteFile>(10000, std::chrono::microseconds(0));
+	int64_t size = 0;
+	ASSERT_TRUE(CoalescingReadableFile(remote, makeOptions(0, 1 << 20), 1234).GetSize(&size).ok());
+	EXPECT_EQ(size, 1234);
+	ASSERT_TRUE(CoalescingReadableFile(remote, makeOptions(0, 1 << 20)).GetSize(&size).ok());
+	EXPECT_EQ(size, 10000);
+}
+
+TEST(CoalescingReadableFileTest, OverlappingPlansFetchEveryByteOnce) {
+	auto remote = std::make_shared<MockRemoteFile>(100000, std::chrono::microseconds(100));
+	CoalescingReadableFile file(remote, makeOptions(0, 1 << 20));
+
+	ASSERT_TRUE(file.WillNeed({{10000, 10000}}).ok());
+	ASSERT_TRUE(file.WillNeed({{5000, 20000}, {15000, 1000}}).ok());
+	EXPECT_TRUE(readMatches(file, *remote, 5000, 5000));
+	EXPECT_TRUE(readMatches(file, *remote, 10000, 10000));
+	EXPECT_TRUE(readMatches(file, *remote, 20000, 5000));
+	EXPECT_EQ(remote->bytesRead, 20000);
+	EXPECT_EQ(remote->requests, 3);
+	EXPECT_EQ(file.getMisses(), 0);
+}
+
+TEST(CoalescingReadableFileTest, LimitsTheBytesFetchedAhead) {
+	auto remote = std::make_shared<MockRemoteFile>(100000, std::chrono::microseconds(0));
+	CoalescingOptions options = makeOptions(0, 1 << 20);
+	options.bufferSizeLimit = 3000;
+	CoalescingReadableFile file(remote, options);
+
+	std::vector<ReadRange> ranges;
+	for(int64_t offset = 0; offset < 10 * 2000; offset += 2000) {
+		ranges.push_back(ReadRange{offset, 1000});
+	}
+	ASSERT_TRUE(file.WillNeed(ranges).ok());
+	while(remote->requests < 3) {
+		std::this_thread::yield();
+	}
+	std::this_thread::sleep_for(std::chrono::milliseconds(20));
+	EXPECT_EQ(remote->requests, 3);
+
+	// reading a range that does not fit yet fetches it right away
+	EXPECT_TRUE(readMatches(file, *remote, ranges[9].offset, ranges[9].length));
+	EXPECT_EQ(remote->requests, 4);
+
+	// every released buffer lets the next range start
+	for(int i = 0; i < 9; i++) {
+		EXPECT_TRUE(readMatches(file, *remote, ranges[i].offset, ranges[i].length));
+	}
+	EXPECT_EQ(remote->requests, 10);
+	EXPECT_EQ(file.getHits(), 10);
+	EXPECT_EQ(file.getMisses(), 0);
+}
+
+TEST(CoalescingReadableFileTest, CloseCancelsTheRangesNotFetchedYet) {
+	auto remote = std::make_shared<MockRemoteFile>(100000, std::chrono::microseconds(0));
+	CoalescingOptions options = makeOptions(0, 1 << 20);
+	options.bufferSizeLimit = 1000;
+	CoalescingReadableFile file(remote, options);
+
+	ASSERT_TRUE(file.WillNeed({{0, 1000}, {2000, 1000}, {4000, 1000}}).ok());
+	while(remote->requests < 1) {
+		std::this_thread::yield();
+	}
+	ASSERT_TRUE(file.Close().ok());
+	EXPECT_EQ(remote->requests, 1);
+	EXPECT_EQ(file.getFetchRequests(), 1);
+}
+
+// Reading 4 of 16 columns of a parquet-like file with 32 row groups, with 2ms of latency and 100 MiB/s per request,
+// recorded as test properties. Disabled, run it with --gtest_also_run_disabled_tests
+TEST(CoalescingReadableFileTest, DISABLED_BenchmarkRequestsAndOverReadByHoleSize) {
+	const int numRowGroups = 32;
+	const int numColumns = 16;
+	std::vector<ReadRange> chunks;
+	int64_t offset = 4;
+	for(int rowGroup = 0; rowGroup < numRowGroups; rowGroup++) {
+		for(int column = 0; column < numColumns; column++) {
+			const int64_t size = (16 << 10) + ((column * 7919 + rowGroup * 104729) % (240 << 10));
+			if(column % 4 == 0) {
+				chunks.push_back(ReadRange{offset, size});
+			}
+			offset += size;
+		}
+	}
+	auto remote = std::make_shared<MockRemoteFile>(offset, std::chrono::milliseconds(2), 100 << 20);
+
+	for(int64_t holeSizeLimit : {int64_t(-1), int64_t(0), int64_t(64 << 10), int64_t(1 << 20), int64_t(8 << 20)}) {
+		CoalescingReadableFile file(remote, makeOptions(std::max<int64_t>(0, holeSizeLimit), 8 << 20));
+		remote->requests = 0;
+		remote->bytesRead = 0;
+
+		const auto start = std::chrono::steady_clock::now();
+		if(holeSizeLimit >= 0) {
+			ASSERT_TRUE(file.WillNeed(chunks).ok());
+		}
+		int64_t plannedBytes = 0;
+		for(const ReadRange & chunk : chunks) {
+			ASSERT_TRUE(readMatches(file, *remote, chunk.offset, chunk.length));
+			plannedBytes += chunk.length;
+		}
+		const double milliseconds =
+			std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - start).count();
+
+		const std::string prefix =
+			holeSizeLimit < 0 ? "unplanned_" : "hole_size_" + std::to_string(holeSizeLimit >> 10) + "KiB_";
+		RecordProperty(prefix + "requests", std::to_string(remote->requests));
+		RecordProperty(prefix + "over_read_bytes", std::to_string(remote->bytesRead - plannedBytes));
+		RecordProperty(prefix + "ms", std::to_string(milliseconds));
+	}
+}
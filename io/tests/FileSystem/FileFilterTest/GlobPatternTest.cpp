@@ -0,0 +1,101 @@
+#include <chrono>
+#include <fnmatch.h>
+#include <random>
+#include <string>
+
+#include "gtest/gtest.h"
+
+#include "Util/GlobPattern.h"
+#include "Util/StringUtil.h"
+
+TEST(GlobPatternTest, Matches) {
+	EXPECT_TRUE(GlobPattern("/data/*.parquet").matches("/data/part-0.parquet"));
+	EXPECT_TRUE(GlobPattern("/data/*.parquet").matches("/data/year=2019/part-0.parquet"));  // like fnmatch
+	EXPECT_FALSE(GlobPattern("/data/*.parquet").matches("/data/part-0.parquet.crc"));
+	EXPECT_TRUE(GlobPattern("/data/part-?.csv").matches("/data/part-7.csv"));
+	EXPECT_FALSE(GlobPattern("/data/part-?.csv").matches("/data/part-17.csv"));
+	EXPECT_TRUE(GlobPattern("/data/part-[0-4].csv").matches("/data/part-3.csv"));
+	EXPECT_FALSE(GlobPattern("/data/part-[0-4].csv").matches("/data/part-5.csv"));
+	EXPECT_TRUE(GlobPattern("/data/part-[!0-4].csv").matches("/data/part-5.csv"));
+	EXPECT_TRUE(GlobPattern("/data/a\\*b").matches("/data/a*b"));
+	EXPECT_FALSE(GlobPattern("/data/a\\*b").matches("/data/axb"));
+	EXPECT_TRUE(GlobPattern("/data/[").matches("/data/["));
+	EXPECT_TRUE(GlobPattern("*").matches(""));
+	EXPECT_TRUE(GlobPattern("").matches(""));
+	EXPECT_FALSE(GlobPattern("").matches("a"));
+	EXPECT_TRUE(GlobPattern("a**b").matches("ab"));
+	EXPECT_FALSE(GlobPattern("*ab*ab").matches("ab"));
+	EXPECT_TRUE(GlobPattern("*ab*ab").matches("abab"));
+
+	// the extended syntax and the POSIX classes go to fnmatch
+	EXPECT_TRUE(GlobPattern("/data/*.+(csv|psv)").matches("/data/a.psv"));
+	EXPECT_FALSE(GlobPattern("/data/*.+(csv|psv)").matches("/data/a.tsv"));
+	EXPECT_TRUE(GlobPattern("/data/part-[[:digit:]]").matches("/data/part-1"));
+}
+
+TEST(GlobPatternTest, LiteralPrefix) {
+	EXPECT_EQ("/data/year=", GlobPattern("/data/year=*/month=*/*.parquet").getLiteralPrefix());
+	EXPECT_EQ("/data/part-", GlobPattern("/data/part-?.csv").getLiteralPrefix());
+	EXPECT_EQ("/data/a*b", GlobPattern("/data/a\\*b").getLiteralPrefix());
+	EXPECT_EQ("", GlobPattern("*.csv").getLiteralPrefix());
+	EXPECT_EQ("/data/", GlobPattern("/data/*.+(csv|psv)").getLiteralPrefix());
+
+	EXPECT_FALSE(GlobPattern("/data/a\\*b").hasWildcards());
+	EXPECT_FALSE(GlobPattern("year=2019").hasWildcards());
+	EXPECT_TRUE(GlobPattern("year=*").hasWildcards());
+	EXPECT_TRUE(GlobPattern("part-[0-4]").hasWildcards());
+}
+
+// Random patterns over a small alphabet so that stars, classes and literals overlap a lot
+TEST(GlobPatternTest, SameAsFnmatch) {
+	std::mt19937 generator(42);
+	const std::string alphabet = "ab/.";
+	const std::string patternAlphabet = "ab/.*?[]!-\\";
+	auto randomString = [&generator](const std::string & characters, int maxSize) {
+		std::string result(generator() % (maxSize + 1), ' ');
+		for(char & c : result) {
+			c = characters[generator() % characters.size()];
+		}
+		return result;
+	};
+
+	for(int i = 0; i < 20000; i++) {
+		const std::string pattern = randomString(patternAlphabet, 8);
+		const std::string input = randomString(alphabet, 10);
+		const bool expected = fnmatch(pattern.c_str(), input.c_str(), 0) == 0;
+		ASSERT_EQ(expected, GlobPattern(pattern).matches(input)) << "pattern " << pattern << " input " << input;
+	}
+}
+
+// A matcher that backtracks across stars takes exponential time on *a*a...*a*b, this test would not finish
+TEST(GlobPatternTest, NoExponentialBacktracking) {
+	std::string pattern;
+	for(int i = 0; i < 30; i++) {
+		pattern += "*a";
+	}
+	pattern += "*b";
+	const std::string input(2000, 'a');
+
+	EXPECT_FALSE(GlobPattern(pattern).matches(input));
+	EXPECT_FALSE(StringUtil::match(pattern.c_str(), input.c_str()));
+	EXPECT_TRUE(GlobPattern(pattern).matches(input + "b"));
+}
+
+// Time to reject *a*a...*a*b* by input size, recorded as test properties. The trailing star makes every input
+// scanned to its end. Disabled, run it with --gtest_also_run_disabled_tests
+TEST(GlobPatternTest, DISABLED_BenchmarkPathologicalPattern) {
+	std::string pattern;
+	for(int i = 0; i < 30; i++) {
+		pattern += "*a";
+	}
+	pattern += "*b*";
+	const GlobPattern glob(pattern);
+
+	for(const size_t size : {1000, 10000, 100000}) {
+		const std::string input(size, 'a');
+		const auto start = std::chrono::steady_clock::now();
+		EXPECT_FALSE(glob.matches(input));
+		const std::chrono::duration<double, std::micro> elapsed = std::chrono::steady_clock::now() - start;
+		RecordProperty("input_" + std::to_string(size) + "_us", std::to_string(elapsed.count()));
+	}
+}
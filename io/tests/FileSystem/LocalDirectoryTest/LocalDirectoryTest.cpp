@@ -0,0 +1,137 @@
+#include <algorithm>
+#include <chrono>
+#include <cstdlib>
+#include <fstream>
+#include <map>
+#include <string>
+#include <vector>
+
+#include <dirent.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+#include "gtest/gtest.h"
+
+#include "FileSystem/private/LocalDirectory.h"
+
+class LocalDirectoryTest : public testing::Test {
+protected:
+	void SetUp() override {
+		char directory[] = "/tmp/LocalDirectoryTest.XXXXXX";
+		ASSERT_NE(mkdtemp(directory), nullptr);
+		this->directory = directory;
+	}
+
+	void TearDown() override { system(("rm -rf " + this->directory).c_str()); }
+
+	void makeFile(const std::string & name, int64_t size = 0) {
+		std::ofstream(this->directory + "/" + name) << std::string(size, 'x');
+	}
+
+	void makeDirectory(const std::string & name) { mkdir((this->directory + "/" + name).c_str(), 0755); }
+
+	std::string directory;
+};
+
+std::map<std::string, LocalDirectoryEntry> byName(const std::vector<LocalDirectoryEntry> & entries) {
+	std::map<std::string, LocalDirectoryEntry> result;
+	for(const LocalDirectoryEntry & entry : entries) {
+		result[entry.name] = entry;
+	}
+	return result;
+}
+
+TEST_F(LocalDirectoryTest, TypesComeWithoutStatus) {
+	this->makeFile("a.parquet", 10);
+	this->makeFile("b.csv", 20);
+	this->makeDirectory("dir");
+	symlink((this->directory + "/a.parquet").c_str(), (this->directory + "/link").c_str());
+	symlink((this->directory + "/missing").c_str(), (this->directory + "/broken").c_str());
+
+	std::vector<LocalDirectoryEntry> entries;
+	ASSERT_TRUE(readLocalDirectory(this->directory, nullptr, &entries));
+	auto entryByName = byName(entries);
+	ASSERT_EQ(entryByName.size(), 5u);
+	EXPECT_EQ(entryByName["a.parquet"].fileType, FileType::FILE);
+	EXPECT_FALSE(entryByName["a.parquet"].hasStatus);
+	EXPECT_EQ(entryByName["dir"].fileType, FileType::DIRECTORY);
+
+	// symlinks are followed
+	EXPECT_TRUE(entryByName["link"].isSymlink);
+	EXPECT_EQ(entryByName["link"].fileType, FileType::FILE);
+	EXPECT_EQ(entryByName["link"].fileSize, 10u);
+	EXPECT_FALSE(entryByName["broken"].hasStatus);
+	EXPECT_EQ(entryByName["broken"].fileType, FileType::UNDEFINED);
+}
+
+TEST_F(LocalDirectoryTest, StatusOnlyForTheSelectedEntries) {
+	this->makeFile("a.parquet", 10);
+	this->makeFile("b.csv", 20);
+
+	std::vector<LocalDirectoryEntry> entries;
+	auto parquetFiles = [](const LocalDirectoryEntry & entry) {
+		return entry.name.size() > 8 && entry.name.compare(entry.name.size() - 8, 8, ".parquet") == 0;
+	};
+	ASSERT_TRUE(readLocalDirectory(this->directory, parquetFiles, &entries));
+	auto entryByName = byName(entries);
+	EXPECT_TRUE(entryByName["a.parquet"].hasStatus);
+	EXPECT_EQ(entryByName["a.parquet"].fileSize, 10u);
+	EXPECT_GT(entryByName["a.parquet"].modificationTime, 0u);
+	EXPECT_FALSE(entryByName["b.csv"].hasStatus);
+
+	EXPECT_FALSE(readLocalDirectory(this->directory + "/missing", nullptr, &entries));
+	EXPECT_EQ(errno, ENOENT);
+	EXPECT_FALSE(readLocalDirectory(this->directory + "/a.parquet", nullptr, &entries));
+	EXPECT_EQ(errno, ENOTDIR);
+}
+
+// Lists a directory of 100k files the way LocalFileSystem did (readdir and a stat by path per entry) and with
+// readLocalDirectory, recorded as test properties. Disabled, run it with --gtest_also_run_disabled_tests
+TEST_F(LocalDirectoryTest, DISABLED_BenchmarkListing) {
+	const int numFiles = 100000;
+	this->makeDirectory("flat");
+	for(int i = 0; i < numFiles; i++) {
+		this->makeFile("flat/part-" + std::to_string(i) + ".parquet");
+	}
+	const std::string flat = this->directory + "/flat";
+
+	auto time = [](const std::string & name, const std::function<size_t()> & list) {
+		const auto start = std::chrono::steady_clock::now();
+		const size_t found = list();
+		const double milliseconds =
+			std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - start).count();
+		RecordProperty(name + "_entries", std::to_string(found));
+		RecordProperty(name + "_ms", std::to_string(milliseconds));
+		return found;
+	};
+
+	EXPECT_EQ(time("readdir_and_stat",
+				  [&flat]() {
+					  size_t found = 0;
+					  DIR * dir = opendir(flat.c_str());
+					  for(dirent * entry = readdir(dir); entry != nullptr; entry = readdir(dir)) {
+						  const std::string name = entry->d_name;
+						  struct stat status;
+						  if(name != "." && name != ".." && stat((flat + "/" + name).c_str(), &status) == 0) {
+							  found++;
+						  }
+					  }
+					  closedir(dir);
+					  return found;
+				  }),
+		size_t(numFiles));
+	EXPECT_EQ(time("getdents_types_only",
+				  [&flat]() {
+					  std::vector<LocalDirectoryEntry> entries;
+					  readLocalDirectory(flat, nullptr, &entries);
+					  return entries.size();
+				  }),
+		size_t(numFiles));
+	EXPECT_EQ(time("getdents_with_status",
+				  [&flat]() {
+					  std::vector<LocalDirectoryEntry> entries;
+					  readLocalDirectory(flat, [](const LocalDirectoryEntry &) { return true; }, &entries);
+					  return entries.size();
+				  }),
+		size_t(numFiles));
+}
@@ -1,5 +1,9 @@
+#include <algorithm>
+#include <fstream>
 #include <iostream>
 #include <limits.h>
+#include <set>
+#include <sys/stat.h>
 #include <time.h>
 
 #include "gtest/gtest.h"
@@ -79,3 +83,30 @@ TEST_F(LocalFileSystemTest, CheckIgnoreDotAnd2DotsWhenListLinuxRoot) {
 		EXPECT_FALSE(found1DotOr2Dots);
 	}
 }
+
+TEST_F(LocalFileSystemTest, ListByTypeAndWildcard) {
+	char directory[] = "/tmp/LocalFileSystemTest.XXXXXX";
+	ASSERT_NE(mkdtemp(directory), nullptr);
+	const std::string base = directory;
+	mkdir((base + "/year=2019").c_str(), 0755);
+	mkdir((base + "/year=2020").c_str(), 0755);
+	std::ofstream(base + "/a.parquet") << "12345";
+	std::ofstream(base + "/b.csv") << "1";
+	std::ofstream(base + "/year=2019/part-0.parquet") << "1";
+	std::ofstream(base + "/year=2020/part-0.parquet") << "1";
+
+	const std::vector<FileStatus> parquetFiles = localFileSystem->list(Uri(base), FileType::FILE, "*.parquet");
+	ASSERT_EQ(parquetFiles.size(), 1);
+	EXPECT_EQ(parquetFiles[0].getUri().getPath().toString(true), base + "/a.parquet");
+	EXPECT_EQ(parquetFiles[0].getFileSize(), 5);
+	EXPECT_GT(parquetFiles[0].getModificationTime(), 0);
+
+	std::vector<std::string> partitions = localFileSystem->listResourceNames(Uri(base), FileType::DIRECTORY);
+	std::sort(partitions.begin(), partitions.end());
+	EXPECT_EQ(partitions, std::vector<std::string>({"year=2019", "year=2020"}));
+
+	EXPECT_EQ(localFileSystem->list(Uri(base), "*.csv").size(), 1);
+	EXPECT_EQ(localFileSystem->listResourceNames(Uri(base)).size(), 4);
+
+	system(("rm -rf " + base).c_str());
+}
@@ -0,0 +1,276 @@
+#include <algorithm>
+#include <atomic>
+#include <cctype>
+#include <chrono>
+#include <cstdlib>
+#include <fstream>
+#include <random>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include <fcntl.h>
+#include <unistd.h>
+
+#include "gtest/gtest.h"
+
+#include "ExceptionHandling/BlazingException.h"
+#include "FileSystem/LocalFileSystem.h"
+#include "FileSystem/private/IoUringReadableFile.h"
+
+using namespace LocalFileSystemConnection;
+
+struct ReadModeCase {
+	std::string name;
+	FileSystemConnection connection;
+};
+
+std::vector<ReadModeCase> readModeCases() {
+	return {{"pread", FileSystemConnection(ReadMode::PREAD)},
+		{"mmap", FileSystemConnection(ReadMode::MMAP, MmapAdvice::WILLNEED)},
+		{"io_uring qd=1", FileSystemConnection(ReadMode::IO_URING, MmapAdvice::WILLNEED, 1)},
+		{"io_uring qd=32", FileSystemConnection(ReadMode::IO_URING, MmapAdvice::WILLNEED, 32)},
+		{"io_uring qd=32 direct", FileSystemConnection(ReadMode::IO_URING, MmapAdvice::WILLNEED, 32, true)}};
+}
+
+// The name of a test property from a description, e.g. "io_uring qd=32" becomes "io_uring_qd_32"
+std::string propertyName(std::string description) {
+	std::replace_if(
+		description.begin(), description.end(), [](char c) { return !std::isalnum(c) && c != '_'; }, '_');
+	return description;
+}
+
+class LocalReadModeTest : public testing::Test {
+protected:
+	void SetUp() override {
+		char directory[] = "/tmp/LocalReadModeTest.XXXXXX";
+		ASSERT_NE(mkdtemp(directory), nullptr);
+		this->directory = directory;
+	}
+
+	void TearDown() override { system(("rm -rf " + this->directory).c_str()); }
+
+	// Lines of a CSV file, synced so that the benchmark can drop them from the page cache
+	std::string makeCsvFile(const std::string & name, int64_t size) {
+		const std::string path = this->directory + "/" + name;
+		std::string content;
+		content.reserve(size);
+		for(int64_t row = 0; static_cast<int64_t>(content.size()) < size; row++) {
+			content += std::to_string(row) + "," + std::to_string(row * 7919 % 100003) + ",name_" +
+					   std::to_string(row % 977) + "\n";
+		}
+		content.resize(size);
+		std::ofstream(path) << content;
+		const int fd = open(path.c_str(), O_RDONLY);
+		fdatasync(fd);
+		close(fd);
+		this->expected = content;
+		return path;
+	}
+
+	bool readMatches(arrow::io::RandomAccessFile & file, int64_t position, int64_t nbytes) {
+		std::shared_ptr<arrow::Buffer> buffer;
+		if(!file.ReadAt(position, nbytes, &buffer).ok()) {
+			return false;
+		}
+		const int64_t available =
+			std::max<int64_t>(0, std::min<int64_t>(nbytes, this->expected.size() - position));
+		if(buffer->size() != available) {
+			return false;
+		}
+
+		// and into memory not aligned for O_DIRECT
+		std::vector<uint8_t> out(nbytes + 1);
+		int64_t bytesRead = 0;
+		if(!file.ReadAt(position, nbytes, &bytesRead, out.data() + 1).ok() || bytesRead != available) {
+			return false;
+		}
+		return std::equal(buffer->data(), buffer->data() + available, this->expected.begin() + position) &&
+			   std::equal(out.begin() + 1, out.begin() + 1 + available, this->expected.begin() + position);
+	}
+
+	std::string directory;
+	std::string expected;
+};
+
+TEST_F(LocalReadModeTest, ConnectionSelectsTheReadMode) {
+	const FileSystemConnection ioUring(ReadMode::IO_URING, MmapAdvice::RANDOM, 64, true);
+	ASSERT_TRUE(ioUring.isValid());
+	EXPECT_EQ(ioUring.getFileSystemType(), FileSystemType::LOCAL);
+	EXPECT_EQ(ioUring.getConnectionProperty(ConnectionProperty::READ_MODE), "io_uring");
+	EXPECT_EQ(ioUring.getConnectionProperty(ConnectionProperty::MMAP_ADVICE), "random");
+	EXPECT_EQ(ioUring.getConnectionProperty(ConnectionProperty::IO_URING_QUEUE_DEPTH), "64");
+	EXPECT_EQ(ioUring.getConnectionProperty(ConnectionProperty::DIRECT_IO), "true");
+	EXPECT_EQ(connectionPropertyEnvName(ConnectionProperty::READ_MODE), "BLAZING_LOCAL_READ_MODE");
+
+	// file systems of other modes are other registrations
+	EXPECT_NE(ioUring, FileSystemConnection(ReadMode::MMAP));
+	EXPECT_NE(FileSystemConnection(FileSystemType::LOCAL), FileSystemConnection(ReadMode::PREAD));
+	EXPECT_EQ(FileSystemConnection(FileSystemType::LOCAL).getConnectionProperty(ConnectionProperty::READ_MODE), "");
+	EXPECT_EQ(LocalFileSystem(ioUring).getFileSystemConnection(), ioUring);
+
+	EXPECT_FALSE(FileSystemConnection(ReadMode::UNDEFINED).isValid());
+	EXPECT_FALSE(FileSystemConnection(ReadMode::IO_URING, MmapAdvice::WILLNEED, 0).isValid());
+	EXPECT_EQ(readModeFromName(readModeName(ReadMode::MMAP)), ReadMode::MMAP);
+	EXPECT_EQ(mmapAdviceFromName("sequential"), MmapAdvice::SEQUENTIAL);
+}
+
+TEST_F(LocalReadModeTest, EveryModeReadsTheSameBytes) {
+	const std::string path = this->makeCsvFile("data.csv", 3 * 1024 * 1024 + 12345);
+
+	for(const ReadModeCase & readMode : readModeCases()) {
+		SCOPED_TRACE(readMode.name);
+		LocalFileSystem fileSystem(readMode.connection);
+		std::shared_ptr<arrow::io::RandomAccessFile> file = fileSystem.openReadable(Uri(path));
+		ASSERT_NE(file, nullptr);
+
+		int64_t size = 0;
+		ASSERT_TRUE(file->GetSize(&size).ok());
+		EXPECT_EQ(size, static_cast<int64_t>(this->expected.size()));
+
+		EXPECT_TRUE(this->readMatches(*file, 0, size));
+		EXPECT_TRUE(this->readMatches(*file, 0, 4096));
+		EXPECT_TRUE(this->readMatches(*file, 4095, 2));
+		EXPECT_TRUE(this->readMatches(*file, 1000003, 2 * 1024 * 1024 + 17));
+		EXPECT_TRUE(this->readMatches(*file, size - 100, 1000));  // crosses the end of the file
+		EXPECT_TRUE(this->readMatches(*file, size + 10, 10));
+
+		// sequential reads
+		ASSERT_TRUE(file->Seek(100).ok());
+		std::shared_ptr<arrow::Buffer> buffer;
+		ASSERT_TRUE(file->Read(50, &buffer).ok());
+		ASSERT_TRUE(file->Read(50, &buffer).ok());
+		EXPECT_TRUE(std::equal(buffer->data(), buffer->data() + 50, this->expected.begin() + 150));
+		int64_t position = 0;
+		file->Tell(&position);
+		EXPECT_EQ(position, 200);
+		EXPECT_TRUE(file->Close().ok());
+	}
+
+	LocalFileSystem ioUringFileSystem(FileSystemConnection(ReadMode::IO_URING));
+	EXPECT_THROW(ioUringFileSystem.openReadable(Uri(this->directory + "/none")), BlazingFileSystemException);
+}
+
+TEST_F(LocalReadModeTest, IoUringSplitsReadsInBatches) {
+	const std::string path = this->makeCsvFile("data.csv", 1024 * 1024 + 123);
+	RecordProperty("io_uring_supported", IoUringReadableFile::isSupported());
+
+	for(bool directIo : {false, true}) {
+		IoUringOptions options;
+		options.queueDepth = 4;
+		options.requestSize = 4096;
+		options.directIo = directIo;
+		std::shared_ptr<IoUringReadableFile> file;
+		ASSERT_TRUE(IoUringReadableFile::Open(path, options, &file).ok());
+
+		// 257 requests, 4 in flight at a time
+		EXPECT_TRUE(this->readMatches(*file, 0, this->expected.size()));
+		EXPECT_TRUE(this->readMatches(*file, 5000, 300000));
+
+		// concurrent readers use their own rings
+		std::atomic<int> mismatches(0);
+		std::vector<std::thread> readers;
+		for(int thread = 0; thread < 4; thread++) {
+			readers.emplace_back([this, &file, &mismatches, thread]() {
+				for(int64_t position = thread * 1000; position < 1024 * 1024; position += 100000) {
+					if(!this->readMatches(*file, position, 70000)) {
+						mismatches++;
+					}
+				}
+			});
+		}
+		for(std::thread & reader : readers) {
+			reader.join();
+		}
+		EXPECT_EQ(mismatches, 0);
+	}
+
+	std::shared_ptr<IoUringReadableFile> file;
+	EXPECT_FALSE(IoUringReadableFile::Open(this->directory + "/none", IoUringOptions(), &file).ok());
+}
+
+// fio-style comparison of the modes on a local file: a CSV scan (sequential 1 MiB reads), parquet pages (random
+// 64 KiB reads) and parquet column chunks (random 1 MiB reads from 4 threads). Every job starts with the file out of
+// the page cache, except for the hot runs of mmap. BLAZING_READ_MODE_BENCHMARK_FILE benchmarks an existing file
+// instead (e.g. a large parquet file on the NVMe drive), BLAZING_READ_MODE_BENCHMARK_BYTES sizes the generated one.
+// The results are recorded as test properties. Disabled, run it with --gtest_also_run_disabled_tests
+TEST_F(LocalReadModeTest, DISABLED_BenchmarkReadModes) {
+	const char * benchmarkFile = std::getenv("BLAZING_READ_MODE_BENCHMARK_FILE");
+	const char * benchmarkBytes = std::getenv("BLAZING_READ_MODE_BENCHMARK_BYTES");
+	const std::string path = (benchmarkFile != nullptr)
+								 ? std::string(benchmarkFile)
+								 : this->makeCsvFile("lineitem.csv",
+									   (benchmarkBytes != nullptr) ? std::stoll(benchmarkBytes) : 64LL * 1024 * 1024);
+
+	struct Job {
+		std::string name;
+		int64_t blockSize;
+		bool random;
+		int threads;
+	};
+	const std::vector<Job> jobs = {{"seqread bs=1M", 1 << 20, false, 1},
+		{"randread bs=64K", 64 << 10, true, 1},
+		{"randread bs=1M jobs=4", 1 << 20, true, 4}};
+
+	auto dropFromPageCache = [&path]() {
+		const int fd = open(path.c_str(), O_RDONLY);
+		posix_fadvise(fd, 0, 0, POSIX_FADV_DONTNEED);
+		close(fd);
+	};
+
+	for(const ReadModeCase & readMode : readModeCases()) {
+		LocalFileSystem fileSystem(readMode.connection);
+		for(const Job & job : jobs) {
+			for(bool hot : {false, true}) {
+				if(hot && readMode.name != "mmap") {
+					continue;
+				}
+				if(!hot) {
+					dropFromPageCache();
+				}
+				std::shared_ptr<arrow::io::RandomAccessFile> file = fileSystem.openReadable(Uri(path));
+				int64_t size = 0;
+				ASSERT_TRUE(file->GetSize(&size).ok());
+				const int64_t blocks = std::max<int64_t>(1, size / job.blockSize);
+				const int64_t reads = job.random ? std::min<int64_t>(blocks, 2048) : blocks;
+
+				std::atomic<int64_t> bytesRead(0);
+				std::atomic<int64_t> checksum(0);
+				std::atomic<int> failures(0);
+				const auto start = std::chrono::steady_clock::now();
+				std::vector<std::thread> threads;
+				for(int thread = 0; thread < job.threads; thread++) {
+					threads.emplace_back([&, thread]() {
+						std::mt19937_64 random(thread);
+						for(int64_t read = thread; read < reads; read += job.threads) {
+							const int64_t block = job.random ? static_cast<int64_t>(random() % blocks) : read;
+							std::shared_ptr<arrow::Buffer> buffer;
+							if(!file->ReadAt(block * job.blockSize, job.blockSize, &buffer).ok()) {
+								failures++;
+								continue;
+							}
+							// touch the data, mapped pages are only read when used
+							int64_t sum = 0;
+							for(int64_t i = 0; i < buffer->size(); i += 4096) {
+								sum += buffer->data()[i];
+							}
+							checksum += sum;
+							bytesRead += buffer->size();
+						}
+					});
+				}
+				for(std::thread & thread : threads) {
+					thread.join();
+				}
+				const double seconds =
+					std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+				EXPECT_EQ(failures, 0);
+
+				const std::string prefix = propertyName(readMode.name + (hot ? " hot " : " ") + job.name) + "_";
+				RecordProperty(prefix + "MiB_per_s", std::to_string(bytesRead / seconds / (1 << 20)));
+				RecordProperty(prefix + "IOPS", std::to_string(reads / seconds));
+				RecordProperty(prefix + "ms", std::to_string(seconds * 1000));
+			}
+		}
+	}
+}
@@ -0,0 +1,66 @@
+#include <chrono>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include "gtest/gtest.h"
+
+#include "FileSystem/private/MetadataCache.h"
+
+MetadataCacheOptions makeOptions(int64_t ttlMs, size_t maxEntries = 1000) {
+	MetadataCacheOptions options;
+	options.ttlMs = ttlMs;
+	options.maxEntries = maxEntries;
+	return options;
+}
+
+TEST(MetadataCacheTest, ValuesExpire) {
+	MetadataCache<std::vector<std::string>> cache(makeOptions(50));
+	std::vector<std::string> names;
+	EXPECT_FALSE(cache.get("s3://bucket/dir", &names));
+
+	cache.put("s3://bucket/dir", {"a.parquet", "b.parquet"});
+	ASSERT_TRUE(cache.get("s3://bucket/dir", &names));
+	EXPECT_EQ(names.size(), 2u);
+	EXPECT_EQ(cache.getHits(), 1);
+	EXPECT_EQ(cache.getMisses(), 1);
+
+	std::this_thread::sleep_for(std::chrono::milliseconds(60));
+	EXPECT_FALSE(cache.get("s3://bucket/dir", &names));
+}
+
+TEST(MetadataCacheTest, ZeroTtlDisablesTheCache) {
+	MetadataCache<int64_t> cache(makeOptions(0));
+	cache.put("s3://bucket/file", 1);
+	int64_t value = 0;
+	EXPECT_FALSE(cache.get("s3://bucket/file", &value));
+	EXPECT_EQ(cache.size(), 0u);
+}
+
+TEST(MetadataCacheTest, ErasesByPrefixAndPredicate) {
+	MetadataCache<int64_t> cache(makeOptions(60000));
+	for(const std::string & key : {"s3://bucket/a", "s3://bucket/dir/x", "s3://bucket/dir/y", "s3://bucket/z"}) {
+		cache.put(key, 1);
+	}
+	cache.erasePrefix("s3://bucket/dir");
+	EXPECT_EQ(cache.size(), 2u);
+	int64_t value = 0;
+	EXPECT_TRUE(cache.get("s3://bucket/a", &value));
+	EXPECT_FALSE(cache.get("s3://bucket/dir/x", &value));
+
+	cache.eraseIf([](const std::string & key) { return key.back() == 'z'; });
+	EXPECT_EQ(cache.size(), 1u);
+	cache.clear();
+	EXPECT_EQ(cache.size(), 0u);
+}
+
+TEST(MetadataCacheTest, StaysUnderMaxEntries) {
+	MetadataCache<int64_t> cache(makeOptions(60000, 100));
+	for(int i = 0; i < 1000; i++) {
+		cache.put("gs://bucket/file" + std::to_string(i), i);
+		ASSERT_LE(cache.size(), 100u);
+	}
+	int64_t value = 0;
+	ASSERT_TRUE(cache.get("gs://bucket/file999", &value));
+	EXPECT_EQ(value, 999);
+}
@@ -0,0 +1,276 @@
+#include <atomic>
+#include <chrono>
+#include <cstring>
+#include <map>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include "gtest/gtest.h"
+
+#include "FileSystem/private/MultipartUploader.h"
+
+// Multipart endpoint: uploading a part takes latency and may fail as the per part script says. Completion assembles
+// the object from the part tags it is given
+struct MockMultipartEndpoint {
+	enum class Outcome { OK, TRANSIENT_ERROR, PERMANENT_ERROR };
+
+	std::chrono::milliseconds latency{0};
+	std::map<int, std::vector<Outcome>> script;  // outcome of each attempt of a part, OK once its script is over
+
+	std::mutex mutex;
+	std::map<std::string, std::string> parts;  // by tag
+	std::map<int, int> attempts;			   // by part number
+	std::string object;
+	bool completed = false;
+	bool aborted = false;
+	std::atomic<int> inFlight{0};
+	std::atomic<int> peakInFlight{0};
+
+	MultipartUploader::UploadPartFunction uploadPartFunction() {
+		return [this](int partNumber, const std::shared_ptr<arrow::Buffer> & data, std::string * partTag,
+				   bool * retryable) {
+			const int current = ++this->inFlight;
+			int peak = this->peakInFlight.load();
+			while(current > peak && !this->peakInFlight.compare_exchange_weak(peak, current)) {
+			}
+			std::this_thread::sleep_for(this->latency);
+			--this->inFlight;
+
+			std::lock_guard<std::mutex> lock(this->mutex);
+			const int attempt = this->attempts[partNumber]++;
+			const std::vector<Outcome> & outcomes = this->script[partNumber];
+			const Outcome outcome = attempt < int(outcomes.size()) ? outcomes[attempt] : Outcome::OK;
+			if(outcome != Outcome::OK) {
+				*retryable = outcome == Outcome::TRANSIENT_ERROR;
+				return arrow::Status::IOError("part " + std::to_string(partNumber) + " failed");
+			}
+			*partTag = "etag-" + std::to_string(partNumber);
+			this->parts[*partTag] = std::string(reinterpret_cast<const char *>(data->data()), data->size());
+			return arrow::Status::OK();
+		};
+	}
+
+	MultipartUploader::CompleteFunction completeFunction() {
+		return [this](const std::vector<std::string> & partTags) {
+			std::lock_guard<std::mutex> lock(this->mutex);
+			for(const std::string & partTag : partTags) {
+				this->object += this->parts.at(partTag);
+			}
+			this->completed = true;
+			return arrow::Status::OK();
+		};
+	}
+
+	MultipartUploader::AbortFunction abortFunction() {
+		return [this](const std::vector<std::string> & partTags) {
+			std::lock_guard<std::mutex> lock(this->mutex);
+			for(const std::string & partTag : partTags) {
+				this->parts.erase(partTag);
+			}
+			this->aborted = true;
+		};
+	}
+
+	std::unique_ptr<MultipartUploader> newUploader(const MultipartUploadOptions & options) {
+		RetryOptions retryOptions;
+		retryOptions.maxAttempts = 3;
+		retryOptions.initialBackoffMs = 1;
+		retryOptions.maxBackoffMs = 2;
+		return std::unique_ptr<MultipartUploader>(new MultipartUploader(
+			this->uploadPartFunction(), this->completeFunction(), this->abortFunction(), options, retryOptions));
+	}
+};
+
+static std::string makeData(int64_t size) {
+	std::string data(size, '\0');
+	for(int64_t i = 0; i < size; i++) {
+		data[i] = static_cast<char>((i * 31) ^ (i >> 8));
+	}
+	return data;
+}
+
+static MultipartUploadOptions smallParts(int maxInFlightParts, int64_t maxBufferedBytes) {
+	MultipartUploadOptions options;
+	options.partSize = 1000;
+	options.maxInFlightParts = maxInFlightParts;
+	options.maxBufferedBytes = maxBufferedBytes;
+	return options;
+}
+
+TEST(MultipartUploaderTest, AssemblesThePartsInOrder) {
+	MockMultipartEndpoint endpoint;
+	endpoint.latency = std::chrono::milliseconds(2);
+	std::unique_ptr<MultipartUploader> uploader = endpoint.newUploader(smallParts(4, 100000));
+
+	// writes of odd sizes, smaller and larger than a part
+	const std::string data = makeData(25500);
+	const int64_t sizes[] = {1, 999, 1, 2500, 7, 333, 10000};
+	int64_t position = 0;
+	for(int i = 0; position < int64_t(data.size()); i++) {
+		const int64_t nbytes = std::min<int64_t>(sizes[i % 7], data.size() - position);
+		ASSERT_TRUE(uploader->Write(data.data() + position, nbytes).ok());
+		position += nbytes;
+	}
+	int64_t told = 0;
+	ASSERT_TRUE(uploader->Tell(&told).ok());
+	EXPECT_EQ(int64_t(data.size()), told);
+
+	ASSERT_TRUE(uploader->Close().ok());
+	EXPECT_TRUE(uploader->closed());
+	EXPECT_TRUE(endpoint.completed);
+	EXPECT_FALSE(endpoint.aborted);
+	EXPECT_EQ(26, uploader->getUploadedParts());
+	EXPECT_EQ(data, endpoint.object);
+	EXPECT_FALSE(uploader->Write(data.data(), 1).ok());
+}
+
+TEST(MultipartUploaderTest, CapsThePartsInFlight) {
+	MockMultipartEndpoint endpoint;
+	endpoint.latency = std::chrono::milliseconds(5);
+	std::unique_ptr<MultipartUploader> uploader = endpoint.newUploader(smallParts(3, 100000));
+
+	const std::string data = makeData(40000);
+	ASSERT_TRUE(uploader->Write(data.data(), data.size()).ok());
+	ASSERT_TRUE(uploader->Close().ok());
+
+	EXPECT_EQ(data, endpoint.object);
+	EXPECT_LE(endpoint.peakInFlight.load(), 3);
+	EXPECT_LE(uploader->getPeakInFlightParts(), 3);
+	// the writer got ahead of the uploads, so they overlapped
+	EXPECT_GT(endpoint.peakInFlight.load(), 1);
+}
+
+TEST(MultipartUploaderTest, WriteBlocksWhileTooManyBytesAreBuffered) {
+	MockMultipartEndpoint endpoint;
+	endpoint.latency = std::chrono::milliseconds(5);
+	std::unique_ptr<MultipartUploader> uploader = endpoint.newUploader(smallParts(2, 3000));
+
+	const std::string data = makeData(30000);
+	const auto start = std::chrono::steady_clock::now();
+	ASSERT_TRUE(uploader->Write(data.data(), data.size()).ok());
+	const auto elapsed = std::chrono::steady_clock::now() - start;
+
+	// 30 parts, 2 at a time: the writer waited for most of them
+	EXPECT_GE(elapsed, std::chrono::milliseconds(5 * 12));
+	EXPECT_LE(uploader->getPeakBufferedBytes(), 3000);
+
+	// Flush waits for the full parts
+	ASSERT_TRUE(uploader->Flush().ok());
+	EXPECT_EQ(30, uploader->getUploadedParts());
+	ASSERT_TRUE(uploader->Close().ok());
+	EXPECT_EQ(data, endpoint.object);
+}
+
+TEST(MultipartUploaderTest, RetriesTransientFailures) {
+	using Outcome = MockMultipartEndpoint::Outcome;
+	MockMultipartEndpoint endpoint;
+	endpoint.script[2] = {Outcome::TRANSIENT_ERROR, Outcome::TRANSIENT_ERROR};
+	endpoint.script[5] = {Outcome::TRANSIENT_ERROR};
+	std::unique_ptr<MultipartUploader> uploader = endpoint.newUploader(smallParts(4, 100000));
+
+	const std::string data = makeData(5500);
+	ASSERT_TRUE(uploader->Write(data.data(), data.size()).ok());
+	ASSERT_TRUE(uploader->Close().ok());
+
+	EXPECT_EQ(data, endpoint.object);
+	EXPECT_EQ(3, endpoint.attempts[2]);
+	EXPECT_EQ(2, endpoint.attempts[5]);
+	EXPECT_EQ(1, endpoint.attempts[6]);
+}
+
+TEST(MultipartUploaderTest, AbortsOnPermanentFailures) {
+	using Outcome = MockMultipartEndpoint::Outcome;
+	MockMultipartEndpoint endpoint;
+	endpoint.latency = std::chrono::milliseconds(1);
+	endpoint.script[3] = {Outcome::PERMANENT_ERROR};
+	std::unique_ptr<MultipartUploader> uploader = endpoint.newUploader(smallParts(2, 100000));
+
+	const std::string data = makeData(20000);
+	arrow::Status status;
+	for(int64_t position = 0; status.ok() && position < int64_t(data.size()); position += 500) {
+		status = uploader->Write(data.data() + position, 500);
+	}
+	if(status.ok()) {
+		status = uploader->Close();
+	} else {
+		EXPECT_FALSE(uploader->Close().ok());
+	}
+
+	EXPECT_FALSE(status.ok());
+	EXPECT_EQ(1, endpoint.attempts[3]);
+	EXPECT_FALSE(endpoint.completed);
+	EXPECT_TRUE(endpoint.aborted);
+	EXPECT_TRUE(endpoint.parts.empty());
+}
+
+TEST(MultipartUploaderTest, GivesUpAfterTheAttemptCap) {
+	using Outcome = MockMultipartEndpoint::Outcome;
+	MockMultipartEndpoint endpoint;
+	endpoint.script[1] = {Outcome::TRANSIENT_ERROR, Outcome::TRANSIENT_ERROR, Outcome::TRANSIENT_ERROR};
+	std::unique_ptr<MultipartUploader> uploader = endpoint.newUploader(smallParts(1, 100000));
+
+	const std::string data = makeData(1500);
+	ASSERT_TRUE(uploader->Write(data.data(), data.size()).ok());
+	EXPECT_FALSE(uploader->Close().ok());
+	EXPECT_EQ(3, endpoint.attempts[1]);
+	EXPECT_TRUE(endpoint.aborted);
+}
+
+TEST(MultipartUploaderTest, EmptyObject) {
+	MockMultipartEndpoint endpoint;
+	std::unique_ptr<MultipartUploader> uploader = endpoint.newUploader(smallParts(4, 100000));
+
+	ASSERT_TRUE(uploader->Close().ok());
+	EXPECT_TRUE(endpoint.completed);
+	EXPECT_EQ(1, uploader->getUploadedParts());
+	EXPECT_EQ("", endpoint.object);
+	// closing again is a no op
+	ASSERT_TRUE(uploader->Close().ok());
+}
+
+TEST(MultipartUploaderTest, AbortsAnUploadNotClosed) {
+	MockMultipartEndpoint endpoint;
+	endpoint.latency = std::chrono::milliseconds(2);
+	{
+		std::unique_ptr<MultipartUploader> uploader = endpoint.newUploader(smallParts(2, 100000));
+		const std::string data = makeData(10500);
+		ASSERT_TRUE(uploader->Write(data.data(), data.size()).ok());
+	}
+	EXPECT_FALSE(endpoint.completed);
+	EXPECT_TRUE(endpoint.aborted);
+	EXPECT_TRUE(endpoint.parts.empty());
+}
+
+TEST(MultipartUploaderTest, OptionsFromEnvironment) {
+	setenv("BLAZING_TEST_UPLOAD_PART_SIZE", "8388608", 1);
+	setenv("BLAZING_TEST_UPLOAD_MAX_IN_FLIGHT_PARTS", "0", 1);
+	const MultipartUploadOptions options = MultipartUploadOptions::fromEnvironment("BLAZING_TEST");
+	EXPECT_EQ(8388608, options.partSize);
+	EXPECT_EQ(1, options.maxInFlightParts);
+	EXPECT_EQ(MultipartUploadOptions().maxBufferedBytes, options.maxBufferedBytes);
+	unsetenv("BLAZING_TEST_UPLOAD_PART_SIZE");
+	unsetenv("BLAZING_TEST_UPLOAD_MAX_IN_FLIGHT_PARTS");
+}
+
+// Sequential uploads (one part at a time, as the stream did before) against parallel ones, with a latency per part,
+// recorded as test properties. Disabled, run it with --gtest_also_run_disabled_tests
+TEST(MultipartUploaderTest, DISABLED_BenchmarkSequentialAndParallelParts) {
+	const std::string data = makeData(64 * 1000);
+	for(const int maxInFlightParts : {1, 4, 8}) {
+		MockMultipartEndpoint endpoint;
+		endpoint.latency = std::chrono::milliseconds(10);
+		std::unique_ptr<MultipartUploader> uploader = endpoint.newUploader(smallParts(maxInFlightParts, 100000));
+
+		const auto start = std::chrono::steady_clock::now();
+		ASSERT_TRUE(uploader->Write(data.data(), data.size()).ok());
+		ASSERT_TRUE(uploader->Close().ok());
+		const auto elapsed =
+			std::chrono::duration_cast<std::chrono::milliseconds>(std::chrono::steady_clock::now() - start);
+
+		EXPECT_EQ(data, endpoint.object);
+		RecordProperty("parts_in_flight_" + std::to_string(maxInFlightParts) + "_ms", std::to_string(elapsed.count()));
+	}
+}
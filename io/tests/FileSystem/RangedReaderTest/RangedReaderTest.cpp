@@ -0,0 +1,155 @@
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <cstring>
+#include <thread>
+#include <vector>
+
+#include "gtest/gtest.h"
+
+#include "FileSystem/private/RangedReader.h"
+
+// Ranged GETs against an S3 compatible store: each one waits for the first byte latency, then streams at a fixed
+// bandwidth like a single HTTP connection
+class FakeObjectStore {
+public:
+	FakeObjectStore(int64_t size, std::chrono::microseconds latency, double bytesPerSecond)
+		: object(size), latency(latency), bytesPerSecond(bytesPerSecond), requests(0) {
+		for(int64_t i = 0; i < size; i++) {
+			object[i] = static_cast<uint8_t>(i * 7 + i / 251);
+		}
+	}
+
+	RangedReader::FetchFunction fetchFunction() {
+		return [this](int64_t position, int64_t nbytes, int64_t * bytesRead, uint8_t * out) {
+			this->requests++;
+			const int64_t size = this->object.size();
+			*bytesRead = std::max<int64_t>(0, std::min(nbytes, size - position));
+			if(this->bytesPerSecond > 0) {
+				std::this_thread::sleep_for(
+					this->latency + std::chrono::microseconds(int64_t(*bytesRead / this->bytesPerSecond * 1e6)));
+			}
+			if(*bytesRead > 0) {
+				std::memcpy(out, this->object.data() + position, *bytesRead);
+			}
+			return arrow::Status::OK();
+		};
+	}
+
+	std::vector<uint8_t> object;
+	std::chrono::microseconds latency;
+	double bytesPerSecond;
+	std::atomic<int> requests;
+};
+
+RangedReadOptions makeOptions(int64_t partSize, int concurrency, int64_t readAheadSize) {
+	RangedReadOptions options;
+	options.partSize = partSize;
+	options.concurrency = concurrency;
+	options.readAheadSize = readAheadSize;
+	return options;
+}
+
+TEST(RangedReaderTest, ReadAtReturnsTheRequestedRange) {
+	FakeObjectStore store(100000, std::chrono::microseconds(0), 0);
+	RangedReader reader(store.fetchFunction(), makeOptions(1000, 4, 0));
+
+	for(int64_t position : {0, 1, 999, 1000, 54321, 99000, 99999, 100000, 150000}) {
+		for(int64_t nbytes : {0, 1, 999, 1000, 1001, 7777, 100000}) {
+			std::vector<uint8_t> out(nbytes);
+			int64_t bytesRead = -1;
+			ASSERT_TRUE(reader.ReadAt(position, nbytes, &bytesRead, out.data()).ok());
+
+			const int64_t expected = std::max<int64_t>(0, std::min<int64_t>(nbytes, 100000 - position));
+			ASSERT_EQ(bytesRead, expected) << position << " " << nbytes;
+			EXPECT_TRUE(std::equal(out.begin(), out.begin() + bytesRead, store.object.begin() + position));
+		}
+	}
+	int64_t position = -1;
+	reader.Tell(&position);
+	EXPECT_EQ(position, 0);
+}
+
+TEST(RangedReaderTest, ConcurrentReadAt) {
+	FakeObjectStore store(1 << 20, std::chrono::microseconds(50), 1e9);
+	RangedReader reader(store.fetchFunction(), makeOptions(16 << 10, 4, 0));
+
+	std::atomic<int> mismatches(0);
+	std::vector<std::thread> threads;
+	for(int t = 0; t < 8; t++) {
+		threads.emplace_back([&, t]() {
+			for(int i = 0; i < 20; i++) {
+				const int64_t position = (t * 131071 + i * 4099) % (1 << 20);
+				std::vector<uint8_t> out(50000);
+				int64_t bytesRead = 0;
+				reader.ReadAt(position, out.size(), &bytesRead, out.data());
+				if(!std::equal(out.begin(), out.begin() + bytesRead, store.object.begin() + position) ||
+					bytesRead != std::min<int64_t>(out.size(), (1 << 20) - position)) {
+					mismatches++;
+				}
+			}
+		});
+	}
+	for(auto & thread : threads) {
+		thread.join();
+	}
+	EXPECT_EQ(mismatches, 0);
+}
+
+TEST(RangedReaderTest, SequentialReadsAreServedFromTheReadAhead) {
+	FakeObjectStore store(1 << 20, std::chrono::microseconds(0), 0);
+	RangedReader reader(store.fetchFunction(), makeOptions(64 << 10, 4, 64 << 10));
+
+	std::vector<uint8_t> content;
+	std::vector<uint8_t> out(1000);
+	int64_t bytesRead = 0;
+	do {
+		ASSERT_TRUE(reader.Read(out.size(), &bytesRead, out.data()).ok());
+		content.insert(content.end(), out.begin(), out.begin() + bytesRead);
+	} while(bytesRead > 0);
+
+	EXPECT_EQ(content, store.object);
+	// 16 buffer fills, then the last two reads find the end of the object
+	EXPECT_EQ(store.requests, 18);
+
+	reader.Seek(10);
+	ASSERT_TRUE(reader.Read(5, &bytesRead, out.data()).ok());
+	EXPECT_TRUE(std::equal(out.begin(), out.begin() + 5, store.object.begin() + 10));
+	int64_t position = 0;
+	reader.Tell(&position);
+	EXPECT_EQ(position, 15);
+
+	// large reads skip the buffer and are split in parts
+	const int requests = store.requests;
+	std::vector<uint8_t> large(300 << 10);
+	reader.Seek(1000);
+	ASSERT_TRUE(reader.Read(large.size(), &bytesRead, large.data()).ok());
+	EXPECT_EQ(bytesRead, static_cast<int64_t>(large.size()));
+	EXPECT_TRUE(std::equal(large.begin(), large.end(), store.object.begin() + 1000));
+	// the rest of the read-ahead buffer, then 4 parts
+	EXPECT_EQ(store.requests - requests, 4);
+}
+
+// Throughput of one large read against a store with 2ms first byte latency and 100 MiB/s per connection, recorded as
+// test properties. Disabled, run it with --gtest_also_run_disabled_tests
+TEST(RangedReaderTest, DISABLED_BenchmarkThroughputByPartSizeAndConcurrency) {
+	const int64_t size = 64 << 20;
+	FakeObjectStore store(size, std::chrono::milliseconds(2), 100 << 20);
+	std::vector<uint8_t> out(size);
+
+	for(int64_t partSize : {1 << 20, 4 << 20, 8 << 20, 16 << 20}) {
+		for(int concurrency : {1, 4, 8, 16}) {
+			RangedReader reader(store.fetchFunction(), makeOptions(partSize, concurrency, 0));
+			int64_t bytesRead = 0;
+			auto start = std::chrono::steady_clock::now();
+			ASSERT_TRUE(reader.ReadAt(0, size, &bytesRead, out.data()).ok());
+			const double seconds =
+				std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+			ASSERT_EQ(bytesRead, size);
+
+			RecordProperty("part_size_" + std::to_string(partSize >> 20) + "MiB_concurrency_" +
+							   std::to_string(concurrency) + "_MiB_per_s",
+				std::to_string((size >> 20) / seconds));
+		}
+	}
+}
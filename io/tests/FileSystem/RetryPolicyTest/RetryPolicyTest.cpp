@@ -0,0 +1,258 @@
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <cstring>
+#include <memory>
+#include <random>
+#include <thread>
+#include <vector>
+
+#include "gtest/gtest.h"
+
+#include "FileSystem/private/RetryPolicy.h"
+
+// Each request fails or stalls as its entry in the script says. Hedged requests can finish after the test that
+// started them, so the state lives in a shared_ptr
+struct FlakyObjectStore {
+	enum class Outcome { OK, TRANSIENT_ERROR, PERMANENT_ERROR, SLOW };
+
+	struct State {
+		std::vector<uint8_t> object;
+		std::vector<Outcome> script;  // outcome of each request, OK once the script is over
+		std::chrono::milliseconds slowLatency{0};
+		std::atomic<int> requests{0};
+		std::atomic<int> finished{0};
+		std::atomic<int> denied{0};  // requests that found the range answered by another one
+	};
+
+	explicit FlakyObjectStore(int64_t size) : state(std::make_shared<State>()) {
+		for(int64_t i = 0; i < size; i++) {
+			this->state->object.push_back(static_cast<uint8_t>(i * 13));
+		}
+	}
+
+	AttemptFunction attemptFunction() {
+		std::shared_ptr<State> state = this->state;
+		return [state](int64_t position,
+				   int64_t nbytes,
+				   int64_t * bytesRead,
+				   const OutputFunction & output,
+				   bool * retryable) {
+			const int request = state->requests++;
+			const Outcome outcome = request < int(state->script.size()) ? state->script[request] : Outcome::OK;
+			*bytesRead = 0;
+			arrow::Status status = arrow::Status::OK();
+			if(outcome == Outcome::TRANSIENT_ERROR || outcome == Outcome::PERMANENT_ERROR) {
+				*retryable = outcome == Outcome::TRANSIENT_ERROR;
+				status = arrow::Status::IOError("request " + std::to_string(request) + " failed");
+			} else {
+				if(outcome == Outcome::SLOW) {
+					std::this_thread::sleep_for(state->slowLatency);
+				}
+				uint8_t * out = output();
+				if(out == nullptr) {
+					state->denied++;
+				} else {
+					const int64_t size = state->object.size();
+					*bytesRead = std::max<int64_t>(0, std::min(nbytes, size - position));
+					std::memcpy(out, state->object.data() + position, *bytesRead);
+				}
+			}
+			state->finished++;
+			return status;
+		};
+	}
+
+	std::shared_ptr<State> state;
+};
+
+RetryOptions fastRetries(int maxAttempts) {
+	RetryOptions options;
+	options.maxAttempts = maxAttempts;
+	options.initialBackoffMs = 1;
+	options.maxBackoffMs = 4;
+	options.hedgePercentile = 0;
+	return options;
+}
+
+TEST(RetryPolicyTest, RetriesTransientFailures) {
+	FlakyObjectStore store(1000);
+	using Outcome = FlakyObjectStore::Outcome;
+	store.state->script = {Outcome::TRANSIENT_ERROR, Outcome::TRANSIENT_ERROR};
+	RequestLatencyStats stats;
+	auto fetch = makeRetryingFetch(store.attemptFunction(), fastRetries(5), stats);
+
+	std::vector<uint8_t> out(100);
+	int64_t bytesRead = 0;
+	ASSERT_TRUE(fetch(10, 100, &bytesRead, out.data()).ok());
+	EXPECT_EQ(bytesRead, 100);
+	EXPECT_TRUE(std::equal(out.begin(), out.end(), store.state->object.begin() + 10));
+	EXPECT_EQ(store.state->requests, 3);
+	EXPECT_EQ(stats.retries, 2);
+	EXPECT_EQ(stats.failures, 0);
+	EXPECT_EQ(stats.getSamples(100), 1);
+}
+
+TEST(RetryPolicyTest, StopsAtPermanentFailuresAndAttemptCap) {
+	using Outcome = FlakyObjectStore::Outcome;
+	std::vector<uint8_t> out(100);
+	int64_t bytesRead = -1;
+
+	FlakyObjectStore permanent(1000);
+	permanent.state->script = {Outcome::PERMANENT_ERROR};
+	RequestLatencyStats stats;
+	EXPECT_FALSE(makeRetryingFetch(permanent.attemptFunction(), fastRetries(5), stats)(0, 100, &bytesRead, out.data())
+					 .ok());
+	EXPECT_EQ(permanent.state->requests, 1);
+	EXPECT_EQ(bytesRead, 0);
+
+	FlakyObjectStore throttled(1000);
+	throttled.state->script = std::vector<Outcome>(10, Outcome::TRANSIENT_ERROR);
+	EXPECT_FALSE(makeRetryingFetch(throttled.attemptFunction(), fastRetries(4), stats)(0, 100, &bytesRead, out.data())
+					 .ok());
+	EXPECT_EQ(throttled.state->requests, 4);
+	EXPECT_EQ(stats.retries, 3);
+	EXPECT_EQ(stats.failures, 2);
+}
+
+TEST(RetryPolicyTest, StopsAtTheDeadline) {
+	using Outcome = FlakyObjectStore::Outcome;
+	FlakyObjectStore store(1000);
+	store.state->script = std::vector<Outcome>(100, Outcome::TRANSIENT_ERROR);
+	RetryOptions options = fastRetries(100);
+	options.initialBackoffMs = 20;
+	options.maxBackoffMs = 20;
+	options.deadlineMs = 100;
+	RequestLatencyStats stats;
+
+	std::vector<uint8_t> out(100);
+	int64_t bytesRead = 0;
+	const auto start = std::chrono::steady_clock::now();
+	EXPECT_FALSE(makeRetryingFetch(store.attemptFunction(), options, stats)(0, 100, &bytesRead, out.data()).ok());
+	EXPECT_LT(std::chrono::steady_clock::now() - start, std::chrono::milliseconds(500));
+	EXPECT_LT(store.state->requests, 100);
+}
+
+TEST(RetryPolicyTest, LatencyPercentiles) {
+	RequestLatencyStats stats;
+	EXPECT_EQ(stats.latencyPercentile(0.5), -1);
+	for(int64_t micros = 1; micros <= 10000; micros++) {
+		stats.recordLatency(1000, micros);
+	}
+	stats.recordLatency(8 << 20, 1000000);
+
+	// buckets are within 12.5%
+	EXPECT_GE(stats.latencyPercentile(0.5, 1000), 5000);
+	EXPECT_LE(stats.latencyPercentile(0.5, 1000), 5625);
+	EXPECT_GE(stats.latencyPercentile(0.99, 1000), 9900);
+	EXPECT_LE(stats.latencyPercentile(0.99, 1000), 11250);
+	EXPECT_GE(stats.latencyPercentile(0.5, 8 << 20), 1000000);
+	EXPECT_LE(stats.latencyPercentile(1, 8 << 20), 1125000);
+	EXPECT_EQ(stats.getSamples(1000), 10000);
+	EXPECT_EQ(stats.getSamples(8 << 20), 1);
+	EXPECT_GE(stats.latencyPercentile(1), 1000000);
+}
+
+TEST(RetryPolicyTest, HedgesSlowRequests) {
+	using Outcome = FlakyObjectStore::Outcome;
+	FlakyObjectStore store(1000);
+	store.state->slowLatency = std::chrono::milliseconds(2000);
+	RetryOptions options = fastRetries(1);
+	options.hedgePercentile = 0.95;
+	options.hedgeMinDelayMs = 5;
+	// the stalled request outlives the test
+	RequestLatencyStats & stats = RequestLatencyStats::forFileSystem("RetryPolicyTest.HedgesSlowRequests");
+	auto fetch = makeRetryingFetch(store.attemptFunction(), options, stats);
+
+	std::vector<uint8_t> out(100);
+	int64_t bytesRead = 0;
+	for(int i = 0; i < options.hedgeMinSamples; i++) {
+		ASSERT_TRUE(fetch(0, 100, &bytesRead, out.data()).ok());
+	}
+	EXPECT_EQ(stats.hedges, 0);
+
+	// the next request stalls, its duplicate answers
+	store.state->script = std::vector<Outcome>(store.state->requests, Outcome::OK);
+	store.state->script.push_back(Outcome::SLOW);
+	const auto start = std::chrono::steady_clock::now();
+	ASSERT_TRUE(fetch(500, 100, &bytesRead, out.data()).ok());
+	EXPECT_LT(std::chrono::steady_clock::now() - start, std::chrono::milliseconds(500));
+	EXPECT_EQ(bytesRead, 100);
+	EXPECT_TRUE(std::equal(out.begin(), out.end(), store.state->object.begin() + 500));
+	EXPECT_EQ(stats.hedges, 1);
+	EXPECT_EQ(stats.hedgeWins, 1);
+}
+
+TEST(RetryPolicyTest, SlowAttemptsDoNotWriteAfterTheHedgeAnswered) {
+	using Outcome = FlakyObjectStore::Outcome;
+	FlakyObjectStore store(1000);
+	store.state->slowLatency = std::chrono::milliseconds(50);
+	RetryOptions options = fastRetries(1);
+	options.hedgePercentile = 0.95;
+	options.hedgeMinDelayMs = 5;
+	RequestLatencyStats & stats =
+		RequestLatencyStats::forFileSystem("RetryPolicyTest.SlowAttemptsDoNotWriteAfterTheHedgeAnswered");
+	auto fetch = makeRetryingFetch(store.attemptFunction(), options, stats);
+
+	std::vector<uint8_t> out(100);
+	int64_t bytesRead = 0;
+	for(int i = 0; i < options.hedgeMinSamples; i++) {
+		ASSERT_TRUE(fetch(0, 100, &bytesRead, out.data()).ok());
+	}
+	EXPECT_EQ(store.state->denied, 0);
+
+	store.state->script = std::vector<Outcome>(store.state->requests, Outcome::OK);
+	store.state->script.push_back(Outcome::SLOW);
+	ASSERT_TRUE(fetch(500, 100, &bytesRead, out.data()).ok());
+	EXPECT_TRUE(std::equal(out.begin(), out.end(), store.state->object.begin() + 500));
+	EXPECT_EQ(stats.hedgeWins, 1);
+
+	// the stalled request finds the range answered and leaves the buffer alone
+	std::fill(out.begin(), out.end(), 0xff);
+	while(store.state->finished < store.state->requests) {
+		std::this_thread::sleep_for(std::chrono::milliseconds(1));
+	}
+	EXPECT_EQ(store.state->denied, 1);
+	EXPECT_TRUE(std::all_of(out.begin(), out.end(), [](uint8_t value) { return value == 0xff; }));
+}
+
+// p50 and p99 of 2000 reads against a store where 2% of the requests stall for 50ms instead of taking 1ms, recorded as
+// test properties. Disabled, run it with --gtest_also_run_disabled_tests
+TEST(RetryPolicyTest, DISABLED_BenchmarkTailLatencyWithAndWithoutHedging) {
+	for(double hedgePercentile : {0.0, 0.95}) {
+		auto attempt = [](int64_t, int64_t nbytes, int64_t * bytesRead, const OutputFunction & output, bool *) {
+			thread_local std::mt19937 generator(std::random_device{}());
+			const bool stall = std::uniform_int_distribution<int>(0, 99)(generator) < 2;
+			std::this_thread::sleep_for(std::chrono::milliseconds(stall ? 50 : 1));
+			uint8_t * out = output();
+			*bytesRead = out == nullptr ? 0 : nbytes;
+			if(out != nullptr) {
+				std::memset(out, 0, nbytes);
+			}
+			return arrow::Status::OK();
+		};
+		RetryOptions options = fastRetries(1);
+		options.hedgePercentile = hedgePercentile;
+		options.hedgeMinDelayMs = 1;
+		RequestLatencyStats & stats =
+			RequestLatencyStats::forFileSystem("RetryPolicyTest.Benchmark" + std::to_string(hedgePercentile));
+		RequestLatencyStats observed;
+		auto fetch = makeRetryingFetch(attempt, options, stats);
+
+		std::vector<uint8_t> out(4096);
+		for(int i = 0; i < 2000; i++) {
+			int64_t bytesRead = 0;
+			const auto start = std::chrono::steady_clock::now();
+			ASSERT_TRUE(fetch(0, out.size(), &bytesRead, out.data()).ok());
+			observed.recordLatency(out.size(),
+				std::chrono::duration_cast<std::chrono::microseconds>(std::chrono::steady_clock::now() - start)
+					.count());
+		}
+		const std::string prefix = "hedge_percentile_" + std::to_string(int(hedgePercentile * 100)) + "_";
+		RecordProperty(prefix + "p50_us", std::to_string(observed.latencyPercentile(0.5)));
+		RecordProperty(prefix + "p99_us", std::to_string(observed.latencyPercentile(0.99)));
+		RecordProperty(prefix + "requests", std::to_string(stats.requests));
+		RecordProperty(prefix + "hedges", std::to_string(stats.hedges));
+		RecordProperty(prefix + "hedge_wins", std::to_string(stats.hedgeWins));
+	}
+}
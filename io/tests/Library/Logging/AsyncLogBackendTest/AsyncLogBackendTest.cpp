@@ -0,0 +1,246 @@
+#include "Library/Logging/AsyncLogBackend.h"
+#include "Library/Logging/FileOutput.h"
+#include "Library/Logging/GenericOutput.h"
+#include "Library/Logging/LogRingBuffer.h"
+
+#include "../../../utilities/CaptureOutput.h"
+
+#include <gtest/gtest.h>
+
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <cstdio>
+#include <ctime>
+#include <functional>
+#include <mutex>
+#include <sstream>
+#include <string>
+#include <thread>
+#include <vector>
+
+using namespace Library::Logging;
+
+// a sink that is slow enough to fill the queue
+class SlowOutput : public CaptureOutput {
+public:
+	void write(const std::string & lines) override {
+		std::this_thread::sleep_for(std::chrono::milliseconds(5));
+		CaptureOutput::write(lines);
+	}
+};
+
+static LogRecord makeRecord(const std::string & message, const char * level = "INFO") {
+	LogRecord record;
+	record.time = AsyncLogBackend::coarseNow();
+	record.nodeInd = 7;
+	record.level = level;
+	record.message = message;
+	return record;
+}
+
+TEST(LogRingBufferTest, PushesAndPopsInOrderUpToTheCapacity) {
+	LogRingBuffer ring(5);
+	ASSERT_EQ(ring.getCapacity(), 8);
+
+	for(int i = 0; i < 8; i++) {
+		ASSERT_TRUE(ring.tryPush(makeRecord(std::to_string(i))));
+	}
+	LogRecord full = makeRecord("full");
+	EXPECT_FALSE(ring.tryPush(std::move(full)));
+	EXPECT_EQ(full.message, "full");
+
+	LogRecord record;
+	for(int lap = 0; lap < 3; lap++) {
+		for(int i = 0; i < 8; i++) {
+			ASSERT_TRUE(ring.tryPop(record));
+			EXPECT_EQ(record.message, std::to_string(lap * 8 + i));
+			ASSERT_TRUE(ring.tryPush(makeRecord(std::to_string((lap + 1) * 8 + i))));
+		}
+	}
+	EXPECT_EQ(ring.getPushed() - ring.getPopped(), 8);
+}
+
+TEST(AsyncLogBackendTest, FormatsTheRecords) {
+	CaptureOutput * output = new CaptureOutput();
+	AsyncLogBackend backend(output);
+
+	LogRecord raw;
+	raw.message = "as it is";
+	backend.push(std::move(raw));
+
+	LogRecord formatted = makeRecord("already formatted", "WARN");
+	formatted.datetime = "2019-01-01T00:00:00Z";
+	backend.push(std::move(formatted));
+
+	LogRecord record = makeRecord("timestamped by the writer", "ERROR");
+	record.time = 0;
+	backend.push(std::move(record));
+	backend.flush();
+
+	std::vector<std::string> lines = output->getLines();
+	ASSERT_EQ(lines.size(), 3);
+	EXPECT_EQ(lines[0], "as it is");
+	EXPECT_EQ(lines[1], "2019-01-01T00:00:00Z|7|WARN|already formatted");
+
+	std::time_t epoch = 0;
+	struct tm local;
+	char datetime[32];
+	localtime_r(&epoch, &local);
+	std::strftime(datetime, sizeof(datetime), "%FT%TZ", &local);
+	EXPECT_EQ(lines[2], std::string(datetime) + "|7|ERROR|timestamped by the writer");
+}
+
+TEST(AsyncLogBackendTest, BlockingKeepsEveryRecordInOrderPerThread) {
+	AsyncLogOptions options;
+	options.capacity = 64;
+	options.overflowPolicy = LogOverflowPolicy::BLOCK;
+	CaptureOutput * output = new CaptureOutput();
+	AsyncLogBackend backend(output, options);
+
+	const int threadCount = 32;
+	const int recordsPerThread = 2000;
+	std::vector<std::thread> threads;
+	for(int thread = 0; thread < threadCount; thread++) {
+		threads.emplace_back([&backend, thread]() {
+			for(int i = 0; i < recordsPerThread; i++) {
+				backend.push(makeRecord(std::to_string(thread) + " " + std::to_string(i)));
+			}
+		});
+	}
+	for(auto & thread : threads) {
+		thread.join();
+	}
+	backend.flush();
+
+	std::vector<std::string> lines = output->getLines();
+	ASSERT_EQ(lines.size(), threadCount * recordsPerThread);
+	EXPECT_EQ(backend.getDroppedRecords(), 0);
+	EXPECT_LT(output->getWrites(), lines.size());
+
+	std::vector<int> next(threadCount, 0);
+	for(const std::string & line : lines) {
+		std::istringstream message(line.substr(line.rfind('|') + 1));
+		int thread, i;
+		message >> thread >> i;
+		ASSERT_EQ(i, next[thread]);
+		next[thread]++;
+	}
+}
+
+TEST(AsyncLogBackendTest, DroppingCountsAndReportsTheRecords) {
+	AsyncLogOptions options;
+	options.capacity = 4;
+	options.maxBatchBytes = 1;
+	SlowOutput * output = new SlowOutput();
+	AsyncLogBackend backend(output, options);
+
+	const int records = 1000;
+	for(int i = 0; i < records; i++) {
+		backend.push(makeRecord(std::to_string(i)));
+	}
+	backend.flush();
+	// the report of the last drops is written with the next batch
+	backend.push(makeRecord("last"));
+	backend.flush();
+
+	const uint64_t dropped = backend.getDroppedRecords();
+	EXPECT_GT(dropped, 0);
+
+	uint64_t reported = 0;
+	size_t written = 0;
+	for(const std::string & line : output->getLines()) {
+		if(line.find("|WARN|AsyncLogBackend: ") != std::string::npos) {
+			reported += std::stoull(line.substr(line.find("AsyncLogBackend: ") + 17));
+		} else {
+			written++;
+		}
+	}
+	EXPECT_EQ(reported, dropped);
+	EXPECT_EQ(written + dropped, records + 1);
+}
+
+// counts the lines it wrote in a counter that outlives it
+class CountingOutput : public CaptureOutput {
+public:
+	CountingOutput(std::atomic<size_t> & count) : count(count) {}
+
+	void write(const std::string & lines) override {
+		CaptureOutput::write(lines);
+		count += std::count(lines.begin(), lines.end(), '\n');
+	}
+
+private:
+	std::atomic<size_t> & count;
+};
+
+TEST(AsyncLogBackendTest, ReplacingTheSinkWritesTheQueuedRecordsFirst) {
+	std::atomic<size_t> firstCount(0);
+	AsyncLogBackend backend(new CountingOutput(firstCount));
+	for(int i = 0; i < 100; i++) {
+		backend.push(makeRecord(std::to_string(i)));
+	}
+
+	CaptureOutput * second = new CaptureOutput();
+	backend.setSink(second);
+	EXPECT_EQ(firstCount.load(), 100);
+
+	backend.push(makeRecord("to the second"));
+	backend.flush();
+	std::vector<std::string> lines = second->getLines();
+	ASSERT_EQ(lines.size(), 1);
+	EXPECT_EQ(lines[0], lines[0].substr(0, lines[0].rfind('|') + 1) + "to the second");
+}
+
+// Log calls per second of 32 threads writing synchronously and through the backend, recorded as test properties.
+// Disabled, run it with --gtest_also_run_disabled_tests
+TEST(AsyncLogBackendTest, DISABLED_Benchmark) {
+	const int threadCount = 32;
+	const int recordsPerThread = 10000;
+	const std::string message = "a log message of a typical length, with a number " + std::to_string(123456789);
+	const std::string path = "/tmp/AsyncLogBackendTest.log";
+
+	auto run = [&](const std::function<void(int)> & log) {
+		auto start = std::chrono::steady_clock::now();
+		std::vector<std::thread> threads;
+		for(int thread = 0; thread < threadCount; thread++) {
+			threads.emplace_back([&log, thread]() {
+				for(int i = 0; i < recordsPerThread; i++) {
+					log(thread);
+				}
+			});
+		}
+		for(auto & thread : threads) {
+			thread.join();
+		}
+		return std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+	};
+
+	double synchronousSeconds;
+	{
+		// what every log call used to do: format the time, then write and flush the line under the sink lock
+		FileOutput output(path, true);
+		synchronousSeconds = run([&output, &message](int) {
+			std::time_t now = std::time(nullptr);
+			struct tm local;
+			char datetime[32];
+			localtime_r(&now, &local);
+			std::strftime(datetime, sizeof(datetime), "%FT%TZ", &local);
+			output.flush(0, datetime, "INFO", message);
+		});
+	}
+
+	double asynchronousSeconds;
+	{
+		AsyncLogOptions options;
+		options.overflowPolicy = LogOverflowPolicy::BLOCK;
+		AsyncLogBackend backend(new FileOutput(path, true), options);
+		asynchronousSeconds = run([&backend, &message](int) { backend.push(makeRecord(message)); });
+		backend.flush();
+	}
+	std::remove(path.c_str());
+
+	const double records = threadCount * recordsPerThread;
+	RecordProperty("synchronous_calls_per_s", std::to_string(static_cast<long long>(records / synchronousSeconds)));
+	RecordProperty("asynchronous_calls_per_s", std::to_string(static_cast<long long>(records / asynchronousSeconds)));
+}
@@ -0,0 +1,109 @@
+#include "Library/Logging/Logger.h"
+#include "Library/Logging/LoggingLevel.h"
+#include "Library/Logging/ServiceLogging.h"
+
+#include "../../../utilities/CaptureOutput.h"
+
+#include <gtest/gtest.h>
+
+#include <chrono>
+#include <string>
+#include <vector>
+
+using namespace Library::Logging;
+
+struct LoggingLevelTest : public ::testing::Test {
+	void SetUp() override {
+		previousLevel = getLoggingLevel();
+		output = new CaptureOutput();
+		ServiceLogging::getInstance().setLogOutput(output);
+	}
+
+	void TearDown() override {
+		setLoggingLevel(previousLevel);
+		ServiceLogging::getInstance().setLogOutput(nullptr);
+	}
+
+	std::vector<std::string> written() {
+		ServiceLogging::getInstance().flush();
+		return output->getMessages();
+	}
+
+	LoggingLevel previousLevel;
+	// owned by ServiceLogging
+	CaptureOutput * output;
+};
+
+static std::string expensiveMessage(int & calls) {
+	calls++;
+	return "message " + std::to_string(calls);
+}
+
+TEST_F(LoggingLevelTest, LevelsBelowTheThresholdAreNotBuilt) {
+	setLoggingLevel(LoggingLevel::WARN);
+	EXPECT_EQ(getLoggingLevel(), LoggingLevel::WARN);
+	EXPECT_FALSE(isLoggingLevelEnabled(LoggingLevel::TRACE));
+	EXPECT_FALSE(isLoggingLevelEnabled(LoggingLevel::INFO));
+	EXPECT_TRUE(isLoggingLevelEnabled(LoggingLevel::WARN));
+	EXPECT_TRUE(isLoggingLevelEnabled(LoggingLevel::FATAL));
+
+	int calls = 0;
+	BLAZING_LOG_TRACE(expensiveMessage(calls));
+	BLAZING_LOG_DEBUG(expensiveMessage(calls));
+	BLAZING_LOG_INFO(expensiveMessage(calls));
+	EXPECT_EQ(calls, 0);
+
+	BLAZING_LOG_WARN(expensiveMessage(calls));
+	BLAZING_LOG_ERROR(expensiveMessage(calls));
+	EXPECT_EQ(calls, 2);
+
+	// the direct calls are filtered too, but their message is already built
+	Logger().logInfo("discarded");
+	Logger().logError("kept");
+	EXPECT_EQ(written(), std::vector<std::string>({"message 1", "message 2", "kept"}));
+}
+
+TEST_F(LoggingLevelTest, TraceEnablesEverything) {
+	setLoggingLevel(LoggingLevel::TRACE);
+
+	int calls = 0;
+	BLAZING_LOG_DEBUG(expensiveMessage(calls));
+	BLAZING_LOG_INFO(expensiveMessage(calls));
+#ifdef BLAZING_LOG_STRIP_TRACE_DEBUG
+	EXPECT_EQ(written(), std::vector<std::string>({"message 1"}));
+#else
+	EXPECT_EQ(written(), std::vector<std::string>({"message 1", "message 2"}));
+#endif
+}
+
+// Cost of a disabled trace statement against building and discarding its message, recorded as test properties.
+// Disabled, run it with --gtest_also_run_disabled_tests
+TEST_F(LoggingLevelTest, DISABLED_BenchmarkDisabledStatement) {
+	setLoggingLevel(LoggingLevel::INFO);
+
+	const int iterations = 10000000;
+	const std::string token = "1234";
+	int calls = 0;
+
+	auto start = std::chrono::steady_clock::now();
+	for(int i = 0; i < iterations; i++) {
+		BLAZING_LOG_TRACE(token + "|" + std::to_string(i) + "|" + expensiveMessage(calls));
+	}
+	double disabledNanoseconds =
+		std::chrono::duration<double, std::nano>(std::chrono::steady_clock::now() - start).count() / iterations;
+	EXPECT_EQ(calls, 0);
+
+	// what the statement cost before, when the message was built and then discarded
+	const int builtIterations = 1000000;
+	start = std::chrono::steady_clock::now();
+	for(int i = 0; i < builtIterations; i++) {
+		Logger().logTrace(token + "|" + std::to_string(i) + "|" + expensiveMessage(calls));
+	}
+	double builtNanoseconds =
+		std::chrono::duration<double, std::nano>(std::chrono::steady_clock::now() - start).count() / builtIterations;
+	EXPECT_EQ(calls, builtIterations);
+	EXPECT_TRUE(written().empty());
+
+	RecordProperty("disabled_ns_per_call", std::to_string(disabledNanoseconds));
+	RecordProperty("built_and_discarded_ns_per_call", std::to_string(builtNanoseconds));
+}
@@ -0,0 +1,172 @@
+#include "Library/Metrics/MetricsRegistry.h"
+#include "Library/Metrics/PrometheusExporter.h"
+
+#include <gtest/gtest.h>
+
+#include <arpa/inet.h>
+#include <cstdio>
+#include <fstream>
+#include <limits>
+#include <netinet/in.h>
+#include <sstream>
+#include <string>
+#include <sys/socket.h>
+#include <thread>
+#include <unistd.h>
+#include <vector>
+
+using namespace Library::Metrics;
+
+// the whole HTTP response of a request to the local port
+static std::string httpGet(int port, const std::string & target) {
+	int connection = ::socket(AF_INET, SOCK_STREAM, 0);
+	sockaddr_in address{};
+	address.sin_family = AF_INET;
+	address.sin_port = htons(port);
+	inet_pton(AF_INET, "127.0.0.1", &address.sin_addr);
+	if(::connect(connection, reinterpret_cast<sockaddr *>(&address), sizeof(address)) != 0) {
+		::close(connection);
+		return "";
+	}
+	const std::string request = "GET " + target + " HTTP/1.1\r\nHost: localhost\r\n\r\n";
+	::send(connection, request.data(), request.size(), 0);
+
+	std::string response;
+	char buffer[4096];
+	ssize_t received;
+	while((received = ::recv(connection, buffer, sizeof(buffer), 0)) > 0) {
+		response.append(buffer, received);
+	}
+	::close(connection);
+	return response;
+}
+
+static bool hasLine(const std::string & text, const std::string & line) {
+	std::istringstream lines(text);
+	std::string current;
+	while(std::getline(lines, current)) {
+		if(current == line) {
+			return true;
+		}
+	}
+	return false;
+}
+
+TEST(MetricsTest, CounterSumsTheShardsOfAllThreads) {
+	Counter counter;
+	std::vector<std::thread> threads;
+	for(int thread = 0; thread < 8; thread++) {
+		threads.emplace_back([&counter]() {
+			for(int i = 0; i < 100000; i++) {
+				counter.increment();
+			}
+			counter.increment(5);
+		});
+	}
+	for(auto & thread : threads) {
+		thread.join();
+	}
+	EXPECT_EQ(8 * 100005u, counter.getValue());
+}
+
+TEST(MetricsTest, HistogramBucketsAreWithinAnEighth) {
+	for(int64_t value : {0L, 1L, 7L, 8L, 9L, 15L, 16L, 17L, 1000L, 1024L, 1025L, 123456789L, int64_t(1) << 62,
+			 std::numeric_limits<int64_t>::max()}) {
+		const int bucket = Histogram::getBucket(value);
+		ASSERT_LE(Histogram::getBucketLowerBound(bucket), value);
+		if(bucket + 1 < Histogram::NUM_BUCKETS) {
+			ASSERT_GT(Histogram::getBucketLowerBound(bucket + 1), value);
+			ASSERT_LE(Histogram::getBucketLowerBound(bucket + 1) - Histogram::getBucketLowerBound(bucket),
+				std::max<int64_t>(1, value / 8));
+		}
+	}
+
+	Histogram histogram;
+	EXPECT_EQ(-1, histogram.getPercentile(0.5));
+	for(int64_t value = 1; value <= 1000; value++) {
+		histogram.record(value);
+	}
+	EXPECT_EQ(1000u, histogram.getCount());
+	EXPECT_EQ(500500, histogram.getSum());
+	EXPECT_NEAR(500, histogram.getPercentile(0.5), 500 / 8);
+	EXPECT_NEAR(990, histogram.getPercentile(0.99), 990 / 8);
+
+	auto counts = histogram.getCumulativeCounts();
+	ASSERT_EQ(12u, counts.size());  // up to 1, 2, 4 ... 1024 and +Inf
+	EXPECT_EQ(std::make_pair(int64_t(1), uint64_t(1)), counts[0]);
+	EXPECT_EQ(std::make_pair(int64_t(16), uint64_t(16)), counts[4]);
+	EXPECT_EQ(std::make_pair(int64_t(512), uint64_t(512)), counts[9]);
+	EXPECT_EQ(std::make_pair(int64_t(1024), uint64_t(1000)), counts[10]);
+	EXPECT_EQ(1000u, counts.back().second);
+}
+
+TEST(MetricsTest, RendersThePrometheusTextFormat) {
+	MetricsRegistry registry;
+	registry.counter("test_requests_total", "Requests served", {{"path", "/a\"b"}}).increment(3);
+	EXPECT_EQ(&registry.counter("test_requests_total", "Requests served", {{"path", "/a\"b"}}),
+		&registry.counter("test_requests_total", "Requests served", {{"path", "/a\"b"}}));
+	registry.gauge("test_queue_messages", "Messages queued").add(7);
+	registry.gaugeFunction("test_pool_buffers", "Buffers in the pool", {}, []() { return 2.5; });
+	Histogram & latency = registry.histogram("test_latency_seconds", "Latency", {{"op", "read"}}, 1e-6);
+	latency.record(3);
+	latency.record(4);  // on a bound
+	latency.record(1500000);
+
+	EXPECT_THROW(registry.gauge("test_requests_total", "Requests served"), std::logic_error);
+
+	const std::string text = registry.toPrometheusText();
+	EXPECT_TRUE(hasLine(text, "# HELP test_requests_total Requests served"));
+	EXPECT_TRUE(hasLine(text, "# TYPE test_requests_total counter"));
+	EXPECT_TRUE(hasLine(text, "test_requests_total{path=\"/a\\\"b\"} 3"));
+	EXPECT_TRUE(hasLine(text, "# TYPE test_queue_messages gauge"));
+	EXPECT_TRUE(hasLine(text, "test_queue_messages 7"));
+	EXPECT_TRUE(hasLine(text, "test_pool_buffers 2.5"));
+	EXPECT_TRUE(hasLine(text, "# TYPE test_latency_seconds histogram"));
+	EXPECT_TRUE(hasLine(text, "test_latency_seconds_bucket{op=\"read\",le=\"2e-06\"} 0"));
+	EXPECT_TRUE(hasLine(text, "test_latency_seconds_bucket{op=\"read\",le=\"4e-06\"} 2"));
+	EXPECT_TRUE(hasLine(text, "test_latency_seconds_bucket{op=\"read\",le=\"2.097152\"} 3"));
+	EXPECT_TRUE(hasLine(text, "test_latency_seconds_bucket{op=\"read\",le=\"+Inf\"} 3"));
+	EXPECT_TRUE(hasLine(text, "test_latency_seconds_sum{op=\"read\"} 1.500007"));
+	EXPECT_TRUE(hasLine(text, "test_latency_seconds_count{op=\"read\"} 3"));
+}
+
+TEST(MetricsTest, ScrapesTheLocalEndpoint) {
+	MetricsRegistry registry;
+	Counter & sentBytes = registry.counter("test_sent_bytes_total", "Bytes sent");
+	PrometheusExporter exporter(registry);
+	const int port = exporter.startServer(0);
+	ASSERT_GT(port, 0);
+	EXPECT_EQ(port, exporter.getPort());
+
+	sentBytes.increment(1024);
+	std::string response = httpGet(port, "/metrics");
+	EXPECT_EQ(0u, response.find("HTTP/1.1 200 OK\r\n"));
+	EXPECT_NE(std::string::npos, response.find("Content-Type: text/plain; version=0.0.4"));
+	EXPECT_TRUE(hasLine(response, "test_sent_bytes_total 1024"));
+
+	sentBytes.increment(1024);
+	EXPECT_TRUE(hasLine(httpGet(port, "/metrics"), "test_sent_bytes_total 2048"));
+	EXPECT_EQ(0u, httpGet(port, "/").find("HTTP/1.1 404 Not Found\r\n"));
+
+	exporter.stop();
+	EXPECT_EQ(0, exporter.getPort());
+	EXPECT_EQ("", httpGet(port, "/metrics"));
+}
+
+TEST(MetricsTest, RewritesTheFile) {
+	MetricsRegistry registry;
+	Gauge & queued = registry.gauge("test_queued", "Queued");
+	queued.set(4);
+
+	const std::string path = "/tmp/blazing_metrics_test_" + std::to_string(getpid()) + ".prom";
+	PrometheusExporter exporter(registry);
+	exporter.startFileWriter(path, std::chrono::milliseconds(10));
+	queued.set(5);
+	exporter.stop();
+
+	std::ifstream file(path);
+	std::stringstream text;
+	text << file.rdbuf();
+	EXPECT_TRUE(hasLine(text.str(), "test_queued 5"));
+	std::remove(path.c_str());
+}
@@ -0,0 +1,31 @@
+#include <cstdlib>
+
+#include "gtest/gtest.h"
+
+#include "Util/EnvUtil.h"
+
+TEST(EnvUtilTest, ReadsNumbers) {
+	setenv("BLAZING_ENV_UTIL_TEST", "8388608", 1);
+	EXPECT_EQ(EnvUtil::getInt("BLAZING_ENV_UTIL_TEST", 1), 8388608);
+	setenv("BLAZING_ENV_UTIL_TEST", "-3", 1);
+	EXPECT_EQ(EnvUtil::getInt("BLAZING_ENV_UTIL_TEST", 1), -3);
+	setenv("BLAZING_ENV_UTIL_TEST", "0.95", 1);
+	EXPECT_DOUBLE_EQ(EnvUtil::getDouble("BLAZING_ENV_UTIL_TEST", 0.5), 0.95);
+	unsetenv("BLAZING_ENV_UTIL_TEST");
+}
+
+TEST(EnvUtilTest, FallsBackToTheDefault) {
+	unsetenv("BLAZING_ENV_UTIL_TEST");
+	EXPECT_EQ(EnvUtil::getInt("BLAZING_ENV_UTIL_TEST", 7), 7);
+	EXPECT_DOUBLE_EQ(EnvUtil::getDouble("BLAZING_ENV_UTIL_TEST", 0.5), 0.5);
+
+	for(const char * malformed : {"8M", "", "abc", " 1 2", "99999999999999999999"}) {
+		setenv("BLAZING_ENV_UTIL_TEST", malformed, 1);
+		EXPECT_EQ(EnvUtil::getInt("BLAZING_ENV_UTIL_TEST", 7), 7) << malformed;
+	}
+	setenv("BLAZING_ENV_UTIL_TEST", "0.9x", 1);
+	EXPECT_DOUBLE_EQ(EnvUtil::getDouble("BLAZING_ENV_UTIL_TEST", 0.5), 0.5);
+	setenv("BLAZING_ENV_UTIL_TEST", "1.5", 1);
+	EXPECT_EQ(EnvUtil::getInt("BLAZING_ENV_UTIL_TEST", 7), 7);
+	unsetenv("BLAZING_ENV_UTIL_TEST");
+}
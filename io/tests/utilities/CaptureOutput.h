@@ -0,0 +1,62 @@
+/*
+ * Copyright 2017 BlazingDB, Inc.
+ */
+
+#ifndef _BZ_TESTS_CAPTURE_OUTPUT_H_
+#define _BZ_TESTS_CAPTURE_OUTPUT_H_
+
+#include <mutex>
+#include <sstream>
+#include <string>
+#include <vector>
+
+#include "Library/Logging/GenericOutput.h"
+
+// Log output that keeps the lines written, as "datetime|node|level|message" when the logger formats them
+class CaptureOutput : public Library::Logging::GenericOutput {
+public:
+	void flush(std::string && log) override { this->write(log + "\n"); }
+
+	void flush(const std::string & log) override { this->write(log + "\n"); }
+
+	void flush(
+		const int nodeInd, const std::string & datetime, const std::string & level, const std::string & log) override {
+		this->write(datetime + "|" + std::to_string(nodeInd) + "|" + level + "|" + log + "\n");
+	}
+
+	void write(const std::string & lines) override {
+		std::unique_lock<std::mutex> lock(mutex);
+		std::istringstream stream(lines);
+		std::string line;
+		while(std::getline(stream, line)) {
+			this->lines.push_back(line);
+		}
+		this->writes++;
+	}
+
+	std::vector<std::string> getLines() {
+		std::unique_lock<std::mutex> lock(mutex);
+		return lines;
+	}
+
+	// the lines without the time, node and level
+	std::vector<std::string> getMessages() {
+		std::vector<std::string> messages;
+		for(const std::string & line : this->getLines()) {
+			messages.push_back(line.substr(line.rfind('|') + 1));
+		}
+		return messages;
+	}
+
+	size_t getWrites() {
+		std::unique_lock<std::mutex> lock(mutex);
+		return writes;
+	}
+
+private:
+	std::mutex mutex;
+	std::vector<std::string> lines;
+	size_t writes = 0;
+};
+
+#endif /* _BZ_TESTS_CAPTURE_OUTPUT_H_ */
@@ -0,0 +1,87 @@
+/*
+ * Copyright 2017 BlazingDB, Inc.
+ */
+
+#ifndef _BZ_TESTS_MOCK_REMOTE_FILE_H_
+#define _BZ_TESTS_MOCK_REMOTE_FILE_H_
+
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <cstring>
+#include <memory>
+#include <thread>
+#include <vector>
+
+#include "arrow/buffer.h"
+#include "arrow/io/interfaces.h"
+#include "arrow/memory_pool.h"
+#include "arrow/status.h"
+
+// Remote file held in memory. Each ReadAt is one request: it sleeps for the first byte latency, then for the
+// transfer time at bytesPerSecond (0 for unlimited). Counts the requests, the bytes read and the most requests
+// seen in flight at once.
+class MockRemoteFile : public arrow::io::RandomAccessFile {
+public:
+	MockRemoteFile(int64_t size,
+		std::chrono::microseconds latency = std::chrono::microseconds(0),
+		double bytesPerSecond = 0)
+		: object(size), latency(latency), bytesPerSecond(bytesPerSecond) {
+		for(int64_t i = 0; i < size; i++) {
+			object[i] = static_cast<uint8_t>(i * 31 + i / 4093);
+		}
+	}
+
+	arrow::Status ReadAt(int64_t position, int64_t nbytes, int64_t * bytesRead, void * out) override {
+		this->requests++;
+		const int inFlight = ++this->inFlight;
+		for(int max = this->maxInFlight; inFlight > max && !this->maxInFlight.compare_exchange_weak(max, inFlight);) {
+		}
+		*bytesRead = std::max<int64_t>(0, std::min<int64_t>(nbytes, this->object.size() - position));
+		std::this_thread::sleep_for(this->latency);
+		if(this->bytesPerSecond > 0) {
+			std::this_thread::sleep_for(std::chrono::microseconds(int64_t(*bytesRead / this->bytesPerSecond * 1e6)));
+		}
+		this->inFlight--;
+		this->bytesRead += *bytesRead;
+		std::memcpy(out, this->object.data() + position, *bytesRead);
+		return arrow::Status::OK();
+	}
+
+	arrow::Status ReadAt(int64_t position, int64_t nbytes, std::shared_ptr<arrow::Buffer> * out) override {
+		std::shared_ptr<arrow::ResizableBuffer> buffer;
+		ARROW_RETURN_NOT_OK(AllocateResizableBuffer(arrow::default_memory_pool(), nbytes, &buffer));
+		int64_t bytesRead = 0;
+		ARROW_RETURN_NOT_OK(this->ReadAt(position, nbytes, &bytesRead, buffer->mutable_data()));
+		ARROW_RETURN_NOT_OK(buffer->Resize(bytesRead));
+		*out = buffer;
+		return arrow::Status::OK();
+	}
+
+	arrow::Status Read(int64_t, int64_t *, void *) override { return arrow::Status::IOError("not used"); }
+	arrow::Status Read(int64_t, std::shared_ptr<arrow::Buffer> *) override {
+		return arrow::Status::IOError("not used");
+	}
+	arrow::Status Seek(int64_t) override { return arrow::Status::OK(); }
+	arrow::Status Tell(int64_t * position) const override {
+		*position = 0;
+		return arrow::Status::OK();
+	}
+	arrow::Status GetSize(int64_t * size) override {
+		*size = this->object.size();
+		return arrow::Status::OK();
+	}
+	arrow::Status Close() override { return arrow::Status::OK(); }
+	bool closed() const override { return false; }
+	bool supports_zero_copy() const override { return false; }
+
+	std::vector<uint8_t> object;
+	std::chrono::microseconds latency;
+	double bytesPerSecond;
+	std::atomic<int> requests{0};
+	std::atomic<int64_t> bytesRead{0};
+	std::atomic<int> inFlight{0};
+	std::atomic<int> maxInFlight{0};
+};
+
+#endif /* _BZ_TESTS_MOCK_REMOTE_FILE_H_ */
@@ -10,6 +10,7 @@ from threading import Lock
 from weakref import ref
 from pyblazing.apiv2.filesystem import FileSystem
 from pyblazing.apiv2 import DataType
+from pyblazing.apiv2.profile import QueryProfile
 
 
 from .hive import *
@@ -186,6 +187,24 @@ def collectPartitionsRunQuery(
         algebra,
         accessToken)
 
+# runs the query on this node keeping its spans, returns them instead of the result
+def runQueryProfile(
+        masterIndex,
+        nodes,
+        tables,
+        fileTypes,
+        ctxToken,
+        algebra,
+        accessToken,
+        onDaskWorker):
+    cio.startQueryProfileCaller(ctxToken)
+    try:
+        runQuery = collectPartitionsRunQuery if onDaskWorker else cio.runQueryCaller
+        runQuery(masterIndex, nodes, tables, fileTypes, ctxToken, algebra, accessToken)
+    finally:
+        spans = cio.getQueryProfileCaller(ctxToken)
+    return spans
+
 # returns a map of table names to the indices of the columns needed. If there are more than one table scan for one table, it merged the needed columns
 # if the column list is empty, it means we want all columns
 def mergeTableScans(tableScanInfo):
@@ -498,8 +517,13 @@ class BlazingContext(object):
 
     # BEGIN SQL interface
 
-    def explain(self, sql):
-        return str(self.generator.getRelationalAlgebraString(sql))
+    def explain(self, sql, analyze=False):
+        """The relational algebra of the query. With analyze, runs the query and returns a QueryProfile instead: the
+        plan annotated with the rows, bytes and time of each step, and the wall time, shuffle volume and row groups
+        kept by skip data of each node. Its text is printed with print()."""
+        if not analyze:
+            return str(self.generator.getRelationalAlgebraString(sql))
+        return self._run_query(sql, None, profile=True)
 
     def add_remove_table(self, tableName, addTable, table=None):
         self.lock.acquire()
@@ -649,12 +673,18 @@ class BlazingContext(object):
             return cio.parseMetadataCaller(
                 input, currentTableNodes[0].offset, schema, file_format_hint, kwargs, extra_columns)
 
+    # returns the row groups kept and the row groups of the table, by node
     def _optimize_with_skip_data(self, masterIndex, table_name, table_files, nodeTableList, scan_table_query, fileTypes):
+            row_groups = []
             if self.dask_client is None:
                 current_table = nodeTableList[0][table_name]
                 table_tuple = (table_name, current_table) 
                 file_indices_and_rowgroup_indices = cio.runSkipDataCaller(masterIndex, self.nodes, table_tuple, fileTypes, 0, scan_table_query, 0)
-                if not file_indices_and_rowgroup_indices.empty:
+                num_row_groups = len(current_table.metadata)
+                if file_indices_and_rowgroup_indices.empty:
+                    row_groups.append((num_row_groups, num_row_groups))
+                else:
+                    row_groups.append((len(file_indices_and_rowgroup_indices), num_row_groups))
                     file_and_rowgroup_indices = file_indices_and_rowgroup_indices.to_pandas()
                     files = file_and_rowgroup_indices['file_handle_index'].values.tolist()
                     grouped = file_and_rowgroup_indices.groupby('file_handle_index')
@@ -682,9 +712,13 @@ class BlazingContext(object):
                     i = i + 1
                 result = dask.dataframe.from_delayed(dask_futures)
                 for index in range(len(self.nodes)):
+                    current_table = nodeTableList[index][table_name]
                     file_indices_and_rowgroup_indices = result.get_partition(index).compute()
+                    num_row_groups = len(current_table.metadata)
                     if file_indices_and_rowgroup_indices.empty :
+                        row_groups.append((num_row_groups, num_row_groups))
                         continue
+                    row_groups.append((len(file_indices_and_rowgroup_indices), num_row_groups))
                     file_and_rowgroup_indices = file_indices_and_rowgroup_indices.to_pandas()
                     files = file_and_rowgroup_indices['file_handle_index'].values.tolist()
                     grouped = file_and_rowgroup_indices.groupby('file_handle_index')
@@ -697,12 +731,20 @@ class BlazingContext(object):
                         row_group_ids = [row_groups_col[i] for i in row_indices]
                         current_table.row_groups_ids.append(row_group_ids)
                     current_table.files = actual_files
+            return row_groups
 
 
     def sql(self, sql, table_list=[], algebra=None):
+        if (len(table_list) > 0):
+            print("NOTE: You no longer need to send a table list to the .sql() funtion")
+        return self._run_query(sql, algebra)
+
+    # runs the query, or profiles it returning a QueryProfile
+    def _run_query(self, sql, algebra, profile=False):
         # TODO: remove hardcoding
         masterIndex = 0
         nodeTableList = [{} for _ in range(len(self.nodes))]
+        nodeRowGroups = [OrderedDict() for _ in range(len(self.nodes))]
         fileTypes = []
 
         if (algebra is None):
@@ -740,12 +782,35 @@ class BlazingContext(object):
                 j = j + 1
             if new_tables[table].has_metadata():
                 scan_table_query = relational_algebra_steps[table]['table_scans'][0]
-                self._optimize_with_skip_data(masterIndex, table, new_tables[table].files, nodeTableList, scan_table_query, fileTypes)
+                table_row_groups = self._optimize_with_skip_data(masterIndex, table, new_tables[table].files, nodeTableList, scan_table_query, fileTypes)
+                for node_index, kept_and_total in enumerate(table_row_groups):
+                    nodeRowGroups[node_index][table] = kept_and_total
 
         ctxToken = random.randint(0, 64000)
         accessToken = 0
-        if (len(table_list) > 0):
-            print("NOTE: You no longer need to send a table list to the .sql() funtion")
+
+        if profile:
+            start = time.time()
+            if self.dask_client is None:
+                node_spans = [runQueryProfile(masterIndex, self.nodes, nodeTableList[0], fileTypes, ctxToken, algebra, accessToken, False)]
+            else:
+                dask_futures = []
+                for i, node in enumerate(self.nodes):
+                    dask_futures.append(
+                        self.dask_client.submit(
+                            runQueryProfile,
+                            masterIndex,
+                            self.nodes,
+                            nodeTableList[i],
+                            fileTypes,
+                            ctxToken,
+                            algebra,
+                            accessToken,
+                            True,
+                            workers=[node['worker']]))
+                node_spans = self.dask_client.gather(dask_futures)
+            wall_time_ms = (time.time() - start) * 1000.0
+            return QueryProfile(algebra, wall_time_ms, node_spans, nodeRowGroups)
 
         if self.dask_client is None:
             result = cio.runQueryCaller(
@@ -58,8 +58,19 @@ class FileSystem(object):
         self._verify_prefix(prefix)
         root = kwargs.get('root', '/')
 
+        # '' keeps the mode of the BLAZING_LOCAL_READ_MODE env var (pread by
+        # default), 'mmap' suits hot datasets and 'io_uring' fast NVMe drives
+        read_mode = kwargs.get('read_mode', '')
+        mmap_advice = kwargs.get('mmap_advice', 'willneed')
+        io_uring_queue_depth = kwargs.get('io_uring_queue_depth', 32)
+        direct_io = kwargs.get('direct_io', False)
+
         fs = OrderedDict()
         fs['type'] = 'local'
+        fs['read_mode'] = read_mode
+        fs['mmap_advice'] = mmap_advice
+        fs['io_uring_queue_depth'] = io_uring_queue_depth
+        fs['direct_io'] = direct_io
         return registerFileSystem(client, fs, root, prefix)
 
     def hdfs(self, client, prefix, **kwargs):
@@ -0,0 +1,165 @@
+from collections import OrderedDict
+
+
+# EXPLAIN ANALYZE: the relational algebra of a query annotated with what each node measured running it. The engine
+# keeps the spans of a profiled query (see cio.startQueryProfileCaller), the spans of a relational step carry its
+# line of the plan in their relational_step argument.
+
+
+def _get_depth(plan_line):
+    return (len(plan_line) - len(plan_line.lstrip(' '))) // 2
+
+
+def _format_bytes(num_bytes):
+    if num_bytes < 0:
+        return '?'
+    for unit in ['B', 'KB', 'MB', 'GB']:
+        if num_bytes < 1024:
+            return ('%d %s' if unit == 'B' else '%.1f %s') % (num_bytes, unit)
+        num_bytes = num_bytes / 1024.0
+    return '%.1f TB' % num_bytes
+
+
+def _format_rows(rows):
+    return '?' if rows < 0 else str(rows)
+
+
+def _match_plan_lines(plan_lines, spans):
+    """The spans of each line of the plan. The lines that are the same text (e.g. the scans of a self join) are at the
+    same depth, so they ran in the order of the plan and split the spans of that text in that order."""
+    spans_by_text = {}
+    for span in sorted(spans, key=lambda span: span['start_us']):
+        text = span['args'].get('relational_step')
+        if text is not None:
+            spans_by_text.setdefault(text, []).append(span)
+
+    occurrences = {}
+    for line in plan_lines:
+        occurrences[line] = occurrences.get(line, 0) + 1
+
+    line_spans = []
+    seen = {}
+    for line in plan_lines:
+        text_spans = spans_by_text.get(line, [])
+        per_occurrence = len(text_spans) // occurrences[line]
+        occurrence = seen.get(line, 0)
+        seen[line] = occurrence + 1
+        line_spans.append(text_spans[occurrence * per_occurrence:(occurrence + 1) * per_occurrence])
+    return line_spans
+
+
+class StepProfile(object):
+    """What a node measured running one relational step: the rows it took and output, the bytes it output, its time
+    and the bytes it shuffled. A scan with filters is timed with its filter. -1 when not known."""
+
+    def __init__(self, spans, shuffle_spans):
+        self.query_steps = sorted(set(span['query_step'] for span in spans))
+        self.time_ms = sum(span['duration_us'] for span in spans) / 1000.0
+        # a scan takes no rows, unless it filters the rows it loaded
+        self.rows_in = next((span['rows_in'] for span in spans if span['rows_in'] >= 0), -1)
+        self.rows = spans[-1]['rows'] if len(spans) > 0 else -1
+        self.bytes = spans[-1]['bytes'] if len(spans) > 0 else -1
+        self.shuffle_bytes = sum(max(span['bytes'], 0) for span in shuffle_spans
+                                 if span['query_step'] in self.query_steps)
+
+    def to_dict(self):
+        return OrderedDict([('query_steps', self.query_steps), ('rows_in', self.rows_in), ('rows', self.rows),
+                            ('bytes', self.bytes), ('time_ms', self.time_ms),
+                            ('shuffle_bytes', self.shuffle_bytes)])
+
+
+class NodeProfile(object):
+    """What a node measured running the query: its wall time, the rows of its result, the bytes it shuffled, the
+    row groups it kept of each table after skip data and a StepProfile by line of the plan."""
+
+    def __init__(self, node_index, plan_lines, spans, row_groups):
+        self.node_index = node_index
+        query_spans = [span for span in spans if span['category'] == 'query']
+        self.wall_time_ms = query_spans[0]['duration_us'] / 1000.0 if len(query_spans) > 0 else -1
+        self.rows = query_spans[0]['rows'] if len(query_spans) > 0 else -1
+        self.error = query_spans[0]['args'].get('error') if len(query_spans) > 0 else None
+
+        shuffle_spans = [span for span in spans if span['category'] == 'shuffle']
+        self.shuffle_bytes_sent = sum(max(span['bytes'], 0) for span in shuffle_spans if 'to' in span['args'])
+        self.shuffle_bytes_received = sum(max(span['bytes'], 0) for span in shuffle_spans if 'from' in span['args'])
+        self.row_groups = row_groups
+
+        self.steps = [StepProfile(line_spans, shuffle_spans)
+                      for line_spans in _match_plan_lines(plan_lines, spans)]
+
+    def to_dict(self):
+        return OrderedDict([('node_index', self.node_index), ('wall_time_ms', self.wall_time_ms),
+                            ('rows', self.rows), ('error', self.error),
+                            ('shuffle_bytes_sent', self.shuffle_bytes_sent),
+                            ('shuffle_bytes_received', self.shuffle_bytes_received),
+                            ('row_groups', OrderedDict((table, OrderedDict([('kept', kept), ('total', total)]))
+                                                       for table, (kept, total) in self.row_groups.items())),
+                            ('steps', [step.to_dict() for step in self.steps])])
+
+
+class QueryProfile(object):
+    """The result of BlazingContext.explain(sql, analyze=True): the plan executed and a NodeProfile by node. Its text
+    is the plan with each step annotated with the rows and bytes summed over the nodes and the time of the slowest
+    node, followed by the wall time, shuffle volume and skip data pruning of each node."""
+
+    def __init__(self, plan, wall_time_ms, node_spans, node_row_groups):
+        self.plan = plan
+        self.plan_lines = [line for line in plan.split('\n') if len(line.strip()) > 0]
+        self.wall_time_ms = wall_time_ms
+        self.nodes = [NodeProfile(node_index, self.plan_lines, spans, node_row_groups[node_index])
+                      for node_index, spans in enumerate(node_spans)]
+
+    @property
+    def rows(self):
+        return sum(max(node.rows, 0) for node in self.nodes)
+
+    def get_step(self, line_index):
+        """The StepProfile of a line of the plan summed over the nodes, its time is the one of the slowest node."""
+        steps = [node.steps[line_index] for node in self.nodes]
+        total = StepProfile([], [])
+        total.query_steps = sorted(set(step for node_step in steps for step in node_step.query_steps))
+        total.time_ms = max([step.time_ms for step in steps] + [0])
+        for field in ['rows_in', 'rows', 'bytes']:
+            values = [getattr(step, field) for step in steps]
+            setattr(total, field, -1 if any(value < 0 for value in values) else sum(values))
+        total.shuffle_bytes = sum(step.shuffle_bytes for step in steps)
+        return total
+
+    def to_dict(self):
+        return OrderedDict([('plan', self.plan), ('wall_time_ms', self.wall_time_ms), ('rows', self.rows),
+                            ('steps', [OrderedDict([('relational_step', line.strip()),
+                                                    ('depth', _get_depth(line))] +
+                                                   list(self.get_step(index).to_dict().items()))
+                                       for index, line in enumerate(self.plan_lines)]),
+                            ('nodes', [node.to_dict() for node in self.nodes])])
+
+    def to_text(self):
+        lines = []
+        for index, line in enumerate(self.plan_lines):
+            step = self.get_step(index)
+            annotation = 'rows=%s' % _format_rows(step.rows)
+            if step.rows_in >= 0:
+                annotation = 'rows_in=%s %s' % (_format_rows(step.rows_in), annotation)
+            annotation += ' bytes=%s time=%.3f ms' % (_format_bytes(step.bytes), step.time_ms)
+            if step.shuffle_bytes > 0:
+                annotation += ' shuffled=%s' % _format_bytes(step.shuffle_bytes)
+            lines.append('%s  (%s)' % (line, annotation))
+
+        lines.append('')
+        lines.append('Result: %d rows in %.3f ms' % (self.rows, self.wall_time_ms))
+        for node in self.nodes:
+            node_line = 'Node %d: wall time=%.3f ms rows=%s shuffle sent=%s received=%s' % (
+                node.node_index, node.wall_time_ms, _format_rows(node.rows),
+                _format_bytes(node.shuffle_bytes_sent), _format_bytes(node.shuffle_bytes_received))
+            for table, (kept, total) in node.row_groups.items():
+                node_line += ' %s row groups=%d/%d' % (table, kept, total)
+            if node.error is not None:
+                node_line += ' error=%s' % node.error
+            lines.append(node_line)
+        return '\n'.join(lines)
+
+    def __str__(self):
+        return self.to_text()
+
+    def __repr__(self):
+        return self.to_text()
@@ -0,0 +1,78 @@
+import unittest
+
+from pyblazing.apiv2.profile import QueryProfile
+
+
+PLAN = '\n'.join([
+    'LogicalProject(a=[$0], b=[$2])',
+    '  LogicalJoin(condition=[=($0, $1)], joinType=[inner])',
+    '    BindableTableScan(table=[[main, t]], filters=[[>($0, 5)]], projects=[[0]], aliases=[[a]])',
+    '    BindableTableScan(table=[[main, t]], filters=[[>($0, 5)]], projects=[[0]], aliases=[[a]])',
+    ''])
+
+SCAN = PLAN.split('\n')[2]
+
+
+def span(name, category, query_step, start_us, duration_us, rows_in=-1, rows=-1, bytes=-1, **args):
+    return {'name': name, 'category': category, 'query_step': query_step, 'query_substep': 0,
+            'start_us': start_us, 'duration_us': duration_us, 'rows_in': rows_in, 'rows': rows, 'bytes': bytes,
+            'args': args}
+
+
+def node_spans(scale):
+    return [
+        span('query', 'query', 0, 0, 10000, rows=5 * scale),
+        span('load_data t', 'scan', 0, 10, 1000, rows=100 * scale, bytes=800 * scale, relational_step=SCAN),
+        span('filter', 'operator', 0, 1100, 500, rows_in=100 * scale, rows=40 * scale, bytes=320 * scale,
+             relational_step=SCAN),
+        span('load_data t', 'scan', 1, 2000, 1000, rows=100 * scale, bytes=800 * scale, relational_step=SCAN),
+        span('filter', 'operator', 1, 3100, 500, rows_in=100 * scale, rows=30 * scale, bytes=240 * scale,
+             relational_step=SCAN),
+        span('send partitions', 'shuffle', 2, 4000, 300, rows=10, bytes=1024, to='0,1'),
+        span('receive partition', 'shuffle', 2, 4400, 100, rows=10, bytes=2048, **{'from': '1'}),
+        span('join', 'operator', 2, 4000, 2000, rows_in=70 * scale, rows=5 * scale, bytes=60 * scale,
+             relational_step=PLAN.split('\n')[1], left_rows='40', right_rows='30'),
+        span('project', 'operator', 3, 6100, 100 * scale, rows_in=5 * scale, rows=5 * scale, bytes=40 * scale,
+             relational_step=PLAN.split('\n')[0]),
+    ]
+
+
+class TestQueryProfile(unittest.TestCase):
+
+    def setUp(self):
+        self.profile = QueryProfile(PLAN, 12.5, [node_spans(1), node_spans(2)],
+                                    [{'t': (3, 8)}, {'t': (8, 8)}])
+
+    def test_matches_the_spans_to_the_plan(self):
+        node = self.profile.nodes[0]
+        self.assertEqual(len(node.steps), 4)
+        project, join, left_scan, right_scan = node.steps
+        self.assertEqual((project.rows_in, project.rows, project.bytes), (5, 5, 40))
+        self.assertEqual((join.rows_in, join.rows, join.shuffle_bytes), (70, 5, 3072))
+        # the same scan twice, in the order they ran
+        self.assertEqual((left_scan.rows_in, left_scan.rows, left_scan.bytes), (100, 40, 320))
+        self.assertEqual((right_scan.rows, right_scan.query_steps), (30, [1]))
+        self.assertEqual(left_scan.time_ms, 1.5)
+
+    def test_sums_the_nodes(self):
+        self.assertEqual(self.profile.rows, 15)
+        project = self.profile.get_step(0)
+        self.assertEqual((project.rows, project.bytes, project.time_ms), (15, 120, 0.2))
+
+        node = self.profile.nodes[1]
+        self.assertEqual(node.wall_time_ms, 10.0)
+        self.assertEqual((node.shuffle_bytes_sent, node.shuffle_bytes_received), (1024, 2048))
+        self.assertEqual(self.profile.to_dict()['nodes'][0]['row_groups']['t'], {'kept': 3, 'total': 8})
+
+    def test_renders_the_annotated_plan(self):
+        text = str(self.profile)
+        lines = text.split('\n')
+        self.assertEqual(lines[0], PLAN.split('\n')[0] + '  (rows_in=15 rows=15 bytes=120 B time=0.200 ms)')
+        self.assertTrue(lines[1].endswith('(rows_in=210 rows=15 bytes=180 B time=2.000 ms shuffled=6.0 KB)'))
+        self.assertIn('Result: 15 rows in 12.500 ms', lines)
+        self.assertIn('Node 0: wall time=10.000 ms rows=5 shuffle sent=1.0 KB received=2.0 KB t row groups=3/8',
+                      lines)
+
+
+if __name__ == '__main__':
+    unittest.main()
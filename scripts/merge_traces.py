@@ -0,0 +1,174 @@
+#!/usr/bin/env python3
+"""Merges the per node Chrome traces of a query into one trace.
+
+Every RAL started with BLAZING_TRACE_DIR writes query_<context token>_node_<node index>.json for each query it runs.
+This puts the traces of one query on a shared timeline, each node as its own process, and writes a file that
+chrome://tracing and https://ui.perfetto.dev open.
+
+The spans are timestamped with the wall clock of each node. Clocks drift, so the nodes are aligned on the reference
+node through the shuffle spans: a receive of a message can not end before its send started. Each node is shifted by
+the smallest offset that keeps that true for the messages it exchanged with an aligned node, bounded by the messages
+going the other way. --no-align keeps the wall clock timestamps.
+
+    python scripts/merge_traces.py /tmp/traces --token 123 -o query_123.json
+"""
+
+import argparse
+import collections
+import glob
+import json
+import os
+import sys
+
+
+def load_traces(paths):
+    """Returns {context token: {node index: trace}} of the trace files in paths (files or directories)."""
+    files = []
+    for path in paths:
+        if os.path.isdir(path):
+            files.extend(sorted(glob.glob(os.path.join(path, "query_*_node_*.json"))))
+        else:
+            files.append(path)
+
+    traces = collections.defaultdict(dict)
+    for file_path in files:
+        with open(file_path) as trace_file:
+            trace = json.load(trace_file)
+        other_data = trace.get("otherData", {})
+        traces[other_data["context_token"]][other_data["node_index"]] = trace
+    return traces
+
+
+def shuffle_spans(trace, kind):
+    """The send or receive spans of a trace, in time order."""
+    spans = []
+    for event in trace["traceEvents"]:
+        args = event.get("args", {})
+        if event.get("ph") == "X" and "message_id" in args and kind in args:
+            spans.append(event)
+    return sorted(spans, key=lambda event: event["ts"])
+
+
+def receivers(send, nodes):
+    to = send["args"]["to"]
+    if to == "all":
+        return nodes
+    return [int(node) for node in to.split(",") if node != ""]
+
+
+def lower_bounds(traces):
+    """For the nodes a and b that exchanged messages, the lowest offset(b) - offset(a) that keeps the messages a
+    sent to b causal."""
+    nodes = list(traces.keys())
+    bounds = {}
+    for sender, trace in traces.items():
+        sends = collections.defaultdict(list)
+        for send in shuffle_spans(trace, "to"):
+            for receiver in receivers(send, nodes):
+                if receiver != sender:
+                    sends[(send["args"]["message_id"], receiver)].append(send)
+
+        for receiver, receiver_trace in traces.items():
+            if receiver == sender:
+                continue
+            receives = collections.defaultdict(list)
+            for receive in shuffle_spans(receiver_trace, "from"):
+                if int(receive["args"]["from"]) == sender:
+                    receives[receive["args"]["message_id"]].append(receive)
+
+            # the k-th send of a message to a node pairs with the k-th receive of that message from the sender
+            for message_id, message_receives in receives.items():
+                for send, receive in zip(sends[(message_id, receiver)], message_receives):
+                    bound = send["ts"] - (receive["ts"] + receive["dur"])
+                    bounds[(sender, receiver)] = max(bound, bounds.get((sender, receiver), bound))
+    return bounds
+
+
+def clock_offsets(traces, reference):
+    """The microseconds to add to the timestamps of each node."""
+    bounds = lower_bounds(traces)
+    offsets = {reference: 0}
+    pending = collections.deque([reference])
+    while pending:
+        aligned = pending.popleft()
+        for node in sorted(traces.keys()):
+            if node in offsets:
+                continue
+            lower = bounds.get((aligned, node))
+            upper = -bounds[(node, aligned)] if (node, aligned) in bounds else None
+            if lower is None and upper is None:
+                continue
+            if lower is not None and upper is not None and lower > upper:
+                # the latencies are larger than the drift, split the difference
+                delta = (lower + upper) / 2
+            else:
+                delta = 0
+                if lower is not None:
+                    delta = max(delta, lower)
+                if upper is not None:
+                    delta = min(delta, upper)
+            offsets[node] = offsets[aligned] + delta
+            pending.append(node)
+
+    for node in traces.keys():
+        offsets.setdefault(node, 0)  # no message exchanged with the aligned nodes
+    return offsets
+
+
+def merge(traces, reference, align):
+    offsets = clock_offsets(traces, reference) if align else {node: 0 for node in traces}
+
+    events = []
+    for node, trace in sorted(traces.items()):
+        for event in trace["traceEvents"]:
+            event = dict(event)
+            if "ts" in event:
+                event["ts"] = event["ts"] + offsets[node]
+            events.append(event)
+
+    # starts the timeline at 0
+    start = min([event["ts"] for event in events if "ts" in event] or [0])
+    for event in events:
+        if "ts" in event:
+            event["ts"] -= start
+
+    return {
+        "traceEvents": events,
+        "displayTimeUnit": "ms",
+        "otherData": {
+            "reference_node": reference,
+            "clock_offsets_us": {str(node): offset for node, offset in sorted(offsets.items())},
+            "start_us": start,
+        },
+    }
+
+
+def main():
+    parser = argparse.ArgumentParser(description=__doc__.split("\n")[0])
+    parser.add_argument("paths", nargs="+", help="trace files or directories holding them")
+    parser.add_argument("--token", type=int, help="context token of the query, needed when there are several")
+    parser.add_argument("--reference", type=int, default=0, help="node whose clock the others are aligned on")
+    parser.add_argument("--no-align", action="store_true", help="keep the wall clock timestamps of each node")
+    parser.add_argument("-o", "--output", default="merged_trace.json")
+    args = parser.parse_args()
+
+    traces = load_traces(args.paths)
+    if args.token is None:
+        if len(traces) != 1:
+            sys.exit("found the queries {}, choose one with --token".format(sorted(traces.keys())))
+        args.token = next(iter(traces))
+    if args.token not in traces:
+        sys.exit("no trace of the query {}".format(args.token))
+
+    query_traces = traces[args.token]
+    reference = args.reference if args.reference in query_traces else min(query_traces)
+    merged = merge(query_traces, reference, not args.no_align)
+    with open(args.output, "w") as output:
+        json.dump(merged, output)
+
+    print("merged {} nodes of query {} into {}, clock offsets (us): {}".format(
+        len(query_traces), args.token, args.output, merged["otherData"]["clock_offsets_us"]))
+
+
+if __name__ == "__main__":
+    main()